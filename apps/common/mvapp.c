@@ -102,11 +102,13 @@
 #include <termios.h>
 #include <fcntl.h>
 #include <stdarg.h>
+#include <time.h>
 
 #include "mvapp_std.h"
 #include "utils.h"
 #include "cli.h"
 #include "mvapp.h"
+#include "mv_ring.h"
 
 #define MAX_NUM_CORES		32
 #define CTRL_TRD_DEFAULT_THRESH	100
@@ -116,6 +118,8 @@
 #define CLI_FILE_MAX_FILE_NAME	32
 #define CLI_BUFSIZE		0x1000
 
+#define PIPE_DEF_RING_SIZE	1024
+
 #define cpuset_t	cpu_set_t
 
 struct trd_desc {
@@ -125,6 +129,33 @@ struct trd_desc {
 	struct mvapp	*mvapp;
 };
 
+struct pipe_stage;
+
+struct pipe_worker {
+	struct pipe_stage	*stage;
+	int			 idx;		/* worker index within the stage */
+	struct mv_ring		*ring;		/* input ring; NULL for stage 0 */
+	int			 next_rr;	/* next round-robin target in the next stage */
+	int			 next_victim;	/* next sibling to steal from */
+	struct mvapp_pipe_stats	 stats;
+} __attribute__((aligned(64)));
+
+struct pipe_stage {
+	struct mvapp_pipe_stage_params	 params;
+	int				 id;
+	struct pipe_worker		*workers;
+};
+
+struct mvapp_pipe {
+	int			 num_stages;
+	int			 num_workers;
+	u16			 burst_size;
+	void			 (*drop_cb)(void *arg, void **objs, u16 num);
+	void			*drop_arg;
+	struct pipe_stage	 stages[MVAPP_PIPE_MAX_STAGES];
+	struct pipe_worker	*by_id[MAX_NUM_CORES];
+};
+
 struct mvapp {
 	int			 num_cores;
 	u64			 cores_mask;
@@ -144,6 +175,7 @@ struct mvapp {
 	int			 (*main_loop_cb)(void *, int *);
 	int			 (*ctrl_cb)(void *);
 	void			 (*deinit_local_cb)(void *);
+	struct mvapp_pipe	*pipe;
 
 	pthread_mutex_t		 trd_lock;
 	volatile u64		 bar_mask;
@@ -285,7 +317,10 @@ static int run_local(struct mvapp *mvapp, int id)
 	/* wait until all threads will complete initialization stage */
 	mvapp_barrier();
 
-	if (mvapp->main_loop_cb)
+	if (mvapp->pipe)
+		while (mvapp->running)
+			mvapp_pipe_poll(mvapp->pipe, id);
+	else if (mvapp->main_loop_cb)
 		while (mvapp->running && !err)
 			err = mvapp->main_loop_cb(local_arg, &mvapp->running);
 
@@ -370,6 +405,9 @@ static void *ctrl_thr_cb(void *arg)
 		err = mvapp->ctrl_cb(mvapp->global_arg);
 	}
 
+	/* mark all other threads to exit in case there was an error */
+	mvapp->running = 0;
+
 	pthread_exit(&err);
 	return NULL;
 }
@@ -428,6 +466,12 @@ int mvapp_go(struct mvapp_params *mvapp_params)
 		       mvapp->num_cores, system_ncpus());
 		return -EINVAL;
 	}
+	if (mvapp_params->pipe && mvapp_pipe_num_workers(mvapp_params->pipe) != mvapp->num_cores) {
+		pr_err("Pipeline has %d workers, vs %d cores!\n",
+		       mvapp_pipe_num_workers(mvapp_params->pipe), mvapp->num_cores);
+		free(mvapp);
+		return -EINVAL;
+	}
 	mvapp->cores_mask = mvapp_params->cores_mask;
 	if (!mvapp->cores_mask) {
 		mask = 1;
@@ -541,6 +585,7 @@ int mvapp_go(struct mvapp_params *mvapp_params)
 	mvapp->main_loop_cb	= mvapp_params->main_loop_cb;
 	mvapp->ctrl_cb		= mvapp_params->ctrl_cb;
 	mvapp->deinit_local_cb	= mvapp_params->deinit_local_cb;
+	mvapp->pipe		= mvapp_params->pipe;
 
 	j = 0;
 	for (i = 0; i < mvapp->num_cores; i++) {
@@ -665,3 +710,288 @@ int mvapp_print(const char *fmt, ...)
 
 	return print_cb("%s", buf);
 }
+
+static inline u64 pipe_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int mvapp_pipe_init(struct mvapp_pipe_params *params, struct mvapp_pipe **pipe)
+{
+	struct mvapp_pipe	*p;
+	struct pipe_stage	*st;
+	int			 i, j, err;
+
+	if (!params || params->num_stages < 1 || params->num_stages > MVAPP_PIPE_MAX_STAGES ||
+	    params->burst_size > MVAPP_PIPE_MAX_BURST) {
+		pr_err("Invalid pipeline params!\n");
+		return -EINVAL;
+	}
+
+	p = (struct mvapp_pipe *)malloc(sizeof(struct mvapp_pipe));
+	if (!p) {
+		pr_err("no mem for pipeline obj!\n");
+		return -ENOMEM;
+	}
+	memset(p, 0, sizeof(struct mvapp_pipe));
+	p->num_stages = params->num_stages;
+	p->burst_size = params->burst_size ? params->burst_size : MVAPP_PIPE_MAX_BURST;
+	p->drop_cb = params->drop_cb;
+	p->drop_arg = params->drop_arg;
+
+	for (i = 0; i < p->num_stages; i++) {
+		st = &p->stages[i];
+		st->params = params->stages[i];
+		st->id = i;
+		if (!st->params.burst_cb || st->params.num_workers < 1 ||
+		    p->num_workers + st->params.num_workers > MAX_NUM_CORES) {
+			pr_err("Invalid params for pipeline stage %d!\n", i);
+			err = -EINVAL;
+			goto err_out;
+		}
+		if (!st->params.ring_size)
+			st->params.ring_size = PIPE_DEF_RING_SIZE;
+
+		if (posix_memalign((void **)&st->workers, 64,
+				   st->params.num_workers * sizeof(struct pipe_worker))) {
+			pr_err("no mem for pipeline stage %d workers!\n", i);
+			err = -ENOMEM;
+			goto err_out;
+		}
+		memset(st->workers, 0, st->params.num_workers * sizeof(struct pipe_worker));
+		for (j = 0; j < st->params.num_workers; j++) {
+			st->workers[j].stage = st;
+			st->workers[j].idx = j;
+			st->workers[j].next_victim = j;
+			p->by_id[p->num_workers++] = &st->workers[j];
+			/* stage 0 is the source; it has no input ring */
+			if (!i)
+				continue;
+			err = mv_ring_create(st->params.ring_size, &st->workers[j].ring);
+			if (err)
+				goto err_out;
+		}
+	}
+
+	*pipe = p;
+	return 0;
+
+err_out:
+	mvapp_pipe_deinit(p);
+	return err;
+}
+
+void mvapp_pipe_deinit(struct mvapp_pipe *pipe)
+{
+	struct pipe_stage	*st;
+	int			 i, j;
+
+	if (!pipe)
+		return;
+
+	for (i = 0; i < pipe->num_stages; i++) {
+		st = &pipe->stages[i];
+		if (!st->workers)
+			continue;
+		for (j = 0; j < st->params.num_workers; j++)
+			if (st->workers[j].ring)
+				mv_ring_delete(st->workers[j].ring);
+		free(st->workers);
+	}
+	free(pipe);
+}
+
+int mvapp_pipe_num_workers(struct mvapp_pipe *pipe)
+{
+	return pipe->num_workers;
+}
+
+/* Take up to half of the backlog of the first non-empty sibling ring */
+static u16 pipe_steal(struct pipe_worker *w, void **objs, u16 num)
+{
+	struct pipe_stage	*st = w->stage;
+	struct pipe_worker	*victim;
+	int			 i, num_workers = st->params.num_workers;
+	u32			 cnt;
+	u16			 n;
+
+	for (i = 1; i < num_workers; i++) {
+		if (++w->next_victim >= num_workers)
+			w->next_victim = 0;
+		if (w->next_victim == w->idx)
+			continue;
+		victim = &st->workers[w->next_victim];
+		cnt = mv_ring_count(victim->ring);
+		if (!cnt)
+			continue;
+		cnt = (cnt + 1) / 2;
+		n = mv_ring_dequeue_burst(victim->ring, objs, min_t(u32, cnt, num));
+		if (n) {
+			w->stats.stolen += n;
+			return n;
+		}
+	}
+	return 0;
+}
+
+static void pipe_forward(struct mvapp_pipe *pipe, struct pipe_worker *w, void **objs, u16 num)
+{
+	struct pipe_stage	*next = w->stage + 1;
+	int			 i, t, num_workers = next->params.num_workers;
+	void			*tmp[MVAPP_PIPE_MAX_BURST];
+	u8			 tgt[MVAPP_PIPE_MAX_BURST];
+	u16			 sent = 0, n;
+
+	if (!next->params.dist_cb) {
+		/* whole burst to one worker; move on to the next one if its ring is full */
+		for (i = 0; i < num_workers && sent < num; i++) {
+			sent += mv_ring_enqueue_burst(next->workers[w->next_rr].ring, objs + sent, num - sent);
+			if (++w->next_rr >= num_workers)
+				w->next_rr = 0;
+		}
+		w->stats.objs_out += sent;
+		if (sent < num) {
+			w->stats.drops += num - sent;
+			if (pipe->drop_cb)
+				pipe->drop_cb(pipe->drop_arg, objs + sent, num - sent);
+		}
+		return;
+	}
+
+	for (i = 0; i < num; i++) {
+		t = next->params.dist_cb(next->params.arg, objs[i]);
+		tgt[i] = (t >= 0 && t < num_workers) ? t : 0;
+	}
+	for (t = 0; t < num_workers && sent < num; t++) {
+		for (i = 0, n = 0; i < num; i++)
+			if (tgt[i] == t)
+				tmp[n++] = objs[i];
+		if (!n)
+			continue;
+		sent += n;
+		i = mv_ring_enqueue_burst(next->workers[t].ring, tmp, n);
+		w->stats.objs_out += i;
+		/* the target is fixed by the flow; drop the rest to keep the objects order */
+		if (i < n) {
+			w->stats.drops += n - i;
+			if (pipe->drop_cb)
+				pipe->drop_cb(pipe->drop_arg, tmp + i, n - i);
+		}
+	}
+}
+
+int mvapp_pipe_poll(struct mvapp_pipe *pipe, int id)
+{
+	struct pipe_worker	*w = pipe->by_id[id];
+	struct pipe_stage	*st = w->stage;
+	void			*objs[MVAPP_PIPE_MAX_BURST];
+	u64			 start, t;
+	u32			 occ;
+	u16			 num, fwd;
+
+	if (!st->id) {
+		start = pipe_now_ns();
+		num = st->params.burst_cb(st->params.arg, w->idx, objs, pipe->burst_size);
+		if (!num) {
+			w->stats.idle_polls++;
+			return 0;
+		}
+		fwd = num;
+	} else {
+		occ = mv_ring_count(w->ring);
+		w->stats.occ_sum += occ;
+		w->stats.occ_samples++;
+		if (occ > w->stats.occ_max)
+			w->stats.occ_max = occ;
+
+		num = mv_ring_dequeue_burst(w->ring, objs, pipe->burst_size);
+		if (!num && st->params.steal && st->params.num_workers > 1)
+			num = pipe_steal(w, objs, pipe->burst_size);
+		if (!num) {
+			w->stats.idle_polls++;
+			return 0;
+		}
+		start = pipe_now_ns();
+		fwd = st->params.burst_cb(st->params.arg, w->idx, objs, num);
+	}
+	t = pipe_now_ns() - start;
+	w->stats.busy_ns += t;
+	if (t > w->stats.max_burst_ns)
+		w->stats.max_burst_ns = t;
+	w->stats.bursts++;
+	w->stats.objs_in += num;
+
+	if (st->id + 1 < pipe->num_stages && fwd)
+		pipe_forward(pipe, w, objs, fwd);
+
+	return num;
+}
+
+int mvapp_pipe_get_stats(struct mvapp_pipe *pipe, int stage, int worker,
+			 struct mvapp_pipe_stats *stats, int reset)
+{
+	struct pipe_stage	*st;
+	struct mvapp_pipe_stats	*ws;
+	int			 i;
+
+	if (stage < 0 || stage >= pipe->num_stages)
+		return -EINVAL;
+	st = &pipe->stages[stage];
+	if (worker >= st->params.num_workers)
+		return -EINVAL;
+
+	memset(stats, 0, sizeof(*stats));
+	/* a negative worker gives the totals of the stage */
+	for (i = 0; i < st->params.num_workers; i++) {
+		if (worker >= 0 && i != worker)
+			continue;
+		ws = &st->workers[i].stats;
+		stats->bursts += ws->bursts;
+		stats->objs_in += ws->objs_in;
+		stats->objs_out += ws->objs_out;
+		stats->drops += ws->drops;
+		stats->stolen += ws->stolen;
+		stats->idle_polls += ws->idle_polls;
+		stats->occ_sum += ws->occ_sum;
+		stats->occ_samples += ws->occ_samples;
+		stats->busy_ns += ws->busy_ns;
+		if (ws->occ_max > stats->occ_max)
+			stats->occ_max = ws->occ_max;
+		if (ws->max_burst_ns > stats->max_burst_ns)
+			stats->max_burst_ns = ws->max_burst_ns;
+		if (reset)
+			memset(ws, 0, sizeof(*ws));
+	}
+	return 0;
+}
+
+void mvapp_pipe_dump_stats(struct mvapp_pipe *pipe)
+{
+	struct pipe_stage	*st;
+	struct mvapp_pipe_stats	 stats;
+	int			 i, j;
+
+	printf("%-12s %3s %12s %12s %10s %10s %8s %8s %10s %10s\n",
+	       "stage", "wrk", "in", "out", "drops", "stolen", "avg-occ", "max-occ",
+	       "ns/obj", "max-burst");
+	for (i = 0; i < pipe->num_stages; i++) {
+		st = &pipe->stages[i];
+		for (j = 0; j < st->params.num_workers; j++) {
+			mvapp_pipe_get_stats(pipe, i, j, &stats, 0);
+			printf("%-12s %3d %12llu %12llu %10llu %10llu %8llu %8llu %10llu %10llu\n",
+			       st->params.name ? st->params.name : "-", j,
+			       (unsigned long long)stats.objs_in,
+			       (unsigned long long)stats.objs_out,
+			       (unsigned long long)stats.drops,
+			       (unsigned long long)stats.stolen,
+			       (unsigned long long)(stats.occ_samples ?
+						    stats.occ_sum / stats.occ_samples : 0),
+			       (unsigned long long)stats.occ_max,
+			       (unsigned long long)(stats.objs_in ? stats.busy_ns / stats.objs_in : 0),
+			       (unsigned long long)stats.max_burst_ns);
+		}
+	}
+}
@@ -0,0 +1,402 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <string.h>
+#include "mv_std.h"
+#include "mv_net.h"
+#include "utils.h"
+#include "pkt_parse.h"
+
+#define PKT_PARSE_ETH_P_IP		0x0800
+#define PKT_PARSE_ETH_P_ARP		0x0806
+#define PKT_PARSE_ETH_P_8021Q		0x8100
+#define PKT_PARSE_ETH_P_8021AD		0x88a8
+#define PKT_PARSE_ETH_P_QINQ		0x9100
+#define PKT_PARSE_ETH_P_IPV6		0x86dd
+
+#define PKT_PARSE_IPV4_HLEN		20
+#define PKT_PARSE_IPV6_HLEN		40
+#define PKT_PARSE_IPV4_FRAG_OFF_MASK	0x1fff
+
+#define PKT_PARSE_IPPROTO_HOPOPTS	0
+#define PKT_PARSE_IPPROTO_TCP		6
+#define PKT_PARSE_IPPROTO_UDP		17
+#define PKT_PARSE_IPPROTO_ROUTING	43
+#define PKT_PARSE_IPPROTO_FRAGMENT	44
+#define PKT_PARSE_IPPROTO_DSTOPTS	60
+
+#define PKT_PARSE_HASH_SEED		0x9e3779b9
+
+/* Headers are read byte-wise, as they are not guaranteed to be aligned */
+static inline u16 pkt_parse_get_be16(const u8 *p)
+{
+	return ((u16)p[0] << 8) | p[1];
+}
+
+static inline u32 pkt_parse_get_be32(const u8 *p)
+{
+	return ((u32)p[0] << 24) | ((u32)p[1] << 16) | ((u32)p[2] << 8) | p[3];
+}
+
+static inline u32 pkt_parse_rol32(u32 word, unsigned int shift)
+{
+	return (word << shift) | (word >> (32 - shift));
+}
+
+/* murmur3 32-bit block and finalization steps */
+static inline u32 pkt_parse_hash_add(u32 h, u32 k)
+{
+	k *= 0xcc9e2d51;
+	k = pkt_parse_rol32(k, 15);
+	k *= 0x1b873593;
+	h ^= k;
+	h = pkt_parse_rol32(h, 13);
+	return h * 5 + 0xe6546b64;
+}
+
+static inline u32 pkt_parse_hash_fin(u32 h, u32 len)
+{
+	h ^= len;
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35;
+	h ^= h >> 16;
+	return h;
+}
+
+u32 pkt_parse_tuple_hash(const struct pkt_5tuple *tuple)
+{
+	u32 h = PKT_PARSE_HASH_SEED;
+	u32 w;
+	int i;
+
+	if (tuple->ip_ver == 6) {
+		for (i = 0; i < 16; i += 4) {
+			memcpy(&w, &tuple->src.v6[i], sizeof(w));
+			h = pkt_parse_hash_add(h, w);
+		}
+		for (i = 0; i < 16; i += 4) {
+			memcpy(&w, &tuple->dst.v6[i], sizeof(w));
+			h = pkt_parse_hash_add(h, w);
+		}
+	} else {
+		h = pkt_parse_hash_add(h, tuple->src.v4);
+		h = pkt_parse_hash_add(h, tuple->dst.v4);
+	}
+	h = pkt_parse_hash_add(h, ((u32)tuple->sport << 16) | tuple->dport);
+	h = pkt_parse_hash_add(h, ((u32)tuple->ip_ver << 8) | tuple->proto);
+
+	return pkt_parse_hash_fin(h, tuple->ip_ver);
+}
+
+static inline void pkt_parse_l4(struct pkt_parse_info *info, const u8 *buf, u16 off)
+{
+	info->l4_offset = off;
+	switch (info->tuple.proto) {
+	case PKT_PARSE_IPPROTO_TCP:
+		info->l4_type = PKT_PARSE_L4_TYPE_TCP;
+		break;
+	case PKT_PARSE_IPPROTO_UDP:
+		info->l4_type = PKT_PARSE_L4_TYPE_UDP;
+		break;
+	default:
+		info->l4_type = PKT_PARSE_L4_TYPE_OTHER;
+		return;
+	}
+	/* Both TCP and UDP start with the source and destination ports */
+	if (unlikely(off + 4 > info->len)) {
+		info->l4_type = PKT_PARSE_L4_TYPE_NA;
+		return;
+	}
+	info->tuple.sport = pkt_parse_get_be16(&buf[off]);
+	info->tuple.dport = pkt_parse_get_be16(&buf[off + 2]);
+}
+
+static inline int pkt_parse_ipv4(struct pkt_parse_info *info, const u8 *buf, u16 off)
+{
+	u16 ihl;
+
+	if (unlikely(off + PKT_PARSE_IPV4_HLEN > info->len))
+		return -EINVAL;
+
+	ihl = (buf[off] & 0xf) * 4;
+	if (unlikely((buf[off] >> 4) != 4 || ihl < PKT_PARSE_IPV4_HLEN || off + ihl > info->len))
+		return -EINVAL;
+
+	info->l3_type = PKT_PARSE_L3_TYPE_IPV4;
+	info->tuple.ip_ver = 4;
+	info->tuple.proto = buf[off + 9];
+	info->tuple.src.v4 = pkt_parse_get_be32(&buf[off + 12]);
+	info->tuple.dst.v4 = pkt_parse_get_be32(&buf[off + 16]);
+
+	/* Only the first fragment carries the L4 header */
+	if (pkt_parse_get_be16(&buf[off + 6]) & PKT_PARSE_IPV4_FRAG_OFF_MASK)
+		return 0;
+
+	pkt_parse_l4(info, buf, off + ihl);
+	return 0;
+}
+
+static inline int pkt_parse_ipv6(struct pkt_parse_info *info, const u8 *buf, u16 off)
+{
+	u8 nexthdr;
+	int i;
+
+	if (unlikely(off + PKT_PARSE_IPV6_HLEN > info->len || (buf[off] >> 4) != 6))
+		return -EINVAL;
+
+	info->l3_type = PKT_PARSE_L3_TYPE_IPV6;
+	info->tuple.ip_ver = 6;
+	memcpy(info->tuple.src.v6, &buf[off + 8], 16);
+	memcpy(info->tuple.dst.v6, &buf[off + 24], 16);
+	nexthdr = buf[off + 6];
+	off += PKT_PARSE_IPV6_HLEN;
+
+	for (i = 0; i < PKT_PARSE_MAX_IPV6_EXTS; i++) {
+		if (nexthdr != PKT_PARSE_IPPROTO_HOPOPTS &&
+		    nexthdr != PKT_PARSE_IPPROTO_ROUTING &&
+		    nexthdr != PKT_PARSE_IPPROTO_DSTOPTS &&
+		    nexthdr != PKT_PARSE_IPPROTO_FRAGMENT)
+			break;
+		if (unlikely(off + 8 > info->len)) {
+			info->tuple.proto = nexthdr;
+			return 0;
+		}
+		if (nexthdr == PKT_PARSE_IPPROTO_FRAGMENT) {
+			/* Only the first fragment carries the L4 header */
+			if (pkt_parse_get_be16(&buf[off + 2]) & ~0x7) {
+				info->tuple.proto = buf[off];
+				return 0;
+			}
+			nexthdr = buf[off];
+			off += 8;
+		} else {
+			nexthdr = buf[off];
+			off += (buf[off + 1] + 1) * 8;
+		}
+	}
+	info->tuple.proto = nexthdr;
+	if (unlikely(off > info->len))
+		return 0;
+
+	pkt_parse_l4(info, buf, off);
+	return 0;
+}
+
+int pkt_parse_one(struct pkt_parse_info *info, u32 flags)
+{
+	const u8 *buf = (const u8 *)info->data;
+	u16 off = MV_ETH_HLEN;
+	u16 eth_type;
+	int err;
+
+	info->num_vlans = 0;
+	info->vlan_id = 0;
+	info->l3_type = PKT_PARSE_L3_TYPE_NA;
+	info->l4_type = PKT_PARSE_L4_TYPE_NA;
+	info->l3_offset = 0;
+	info->l4_offset = 0;
+	info->hash = 0;
+	memset(&info->tuple, 0, sizeof(info->tuple));
+
+	if (unlikely(info->len < MV_ETH_HLEN)) {
+		info->eth_type = 0;
+		return -EINVAL;
+	}
+
+	eth_type = pkt_parse_get_be16(&buf[off - MV_ETH_ETYPE_LEN]);
+	while ((eth_type == PKT_PARSE_ETH_P_8021Q ||
+		eth_type == PKT_PARSE_ETH_P_8021AD ||
+		eth_type == PKT_PARSE_ETH_P_QINQ) &&
+	       info->num_vlans < PKT_PARSE_MAX_VLANS) {
+		if (unlikely(off + MV_VLAN_TAG_LEN > info->len))
+			break;
+		if (!info->num_vlans)
+			info->vlan_id = pkt_parse_get_be16(&buf[off]) & MV_VLAN_VID_MASK;
+		eth_type = pkt_parse_get_be16(&buf[off + MV_ETH_ETYPE_LEN]);
+		off += MV_VLAN_TAG_LEN;
+		info->num_vlans++;
+	}
+	info->eth_type = eth_type;
+	info->l3_offset = off;
+
+	switch (eth_type) {
+	case PKT_PARSE_ETH_P_IP:
+		err = pkt_parse_ipv4(info, buf, off);
+		break;
+	case PKT_PARSE_ETH_P_IPV6:
+		err = pkt_parse_ipv6(info, buf, off);
+		break;
+	case PKT_PARSE_ETH_P_ARP:
+		info->l3_type = PKT_PARSE_L3_TYPE_ARP;
+		return -EINVAL;
+	default:
+		info->l3_type = PKT_PARSE_L3_TYPE_OTHER;
+		return -EINVAL;
+	}
+	if (unlikely(err))
+		return err;
+
+	if (flags & PKT_PARSE_F_HASH)
+		info->hash = pkt_parse_tuple_hash(&info->tuple);
+
+	return 0;
+}
+
+int pkt_parse_burst(struct pkt_parse_info *info, u16 num, int prefetch_shift, u32 flags)
+{
+	int i, cnt = 0;
+
+	if (prefetch_shift < 0)
+		prefetch_shift = 0;
+
+	/* Warm up the pipeline: issue the prefetches of the first packets */
+	for (i = 0; i < prefetch_shift && i < num; i++)
+		prefetch(info[i].data);
+
+	/* Parse packet i while packet i + prefetch_shift is being fetched */
+	for (i = 0; i < num; i++) {
+		if (prefetch_shift && i + prefetch_shift < num)
+			prefetch(info[i + prefetch_shift].data);
+		if (!pkt_parse_one(&info[i], flags))
+			cnt++;
+	}
+
+	return cnt;
+}
+
+int pkt_parse_pp2_burst(struct pp2_ppio_desc *descs, u16 num, uintptr_t high_addr, u16 pkt_offset,
+			struct pkt_parse_info *info, int prefetch_shift, u32 flags)
+{
+	int i;
+
+	for (i = 0; i < num; i++) {
+		info[i].data = (char *)(high_addr | (uintptr_t)pp2_ppio_inq_desc_get_cookie(&descs[i])) +
+			       pkt_offset;
+		info[i].len = pp2_ppio_inq_desc_get_pkt_len(&descs[i]);
+	}
+
+	return pkt_parse_burst(info, num, prefetch_shift, flags);
+}
+
+int pkt_parse_neta_burst(struct neta_ppio_desc *descs, u16 num, uintptr_t high_addr, u16 pkt_offset,
+			 struct pkt_parse_info *info, int prefetch_shift, u32 flags)
+{
+	int i;
+
+	for (i = 0; i < num; i++) {
+		info[i].data = (char *)(high_addr | (uintptr_t)neta_ppio_inq_desc_get_cookie(&descs[i])) +
+			       pkt_offset;
+		info[i].len = neta_ppio_inq_desc_get_pkt_len(&descs[i]);
+	}
+
+	return pkt_parse_burst(info, num, prefetch_shift, flags);
+}
+
+int pkt_parse_giu_burst(struct giu_gpio_desc *descs, u16 num, uintptr_t high_addr, u16 pkt_offset,
+			struct pkt_parse_info *info, int prefetch_shift, u32 flags)
+{
+	int i;
+
+	for (i = 0; i < num; i++) {
+		info[i].data = (char *)(high_addr | (uintptr_t)giu_gpio_inq_desc_get_cookie(&descs[i])) +
+			       pkt_offset;
+		info[i].len = giu_gpio_inq_desc_get_pkt_len(&descs[i]);
+	}
+
+	return pkt_parse_burst(info, num, prefetch_shift, flags);
+}
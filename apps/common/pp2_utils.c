@@ -1830,6 +1830,7 @@ int app_port_shared_shadowq_create(struct app_shadowqs	**app_shadow_q, u32 thr_m
 		app_q->shadow_qs[i].read_ind = 0;
 		app_q->shadow_qs[i].write_ind = 0;
 		app_q->shadow_qs[i].send_ind = 0;
+		app_q->shadow_qs[i].done_pending = 0;
 		app_q->shadow_qs[i].size = shadow_q_size;
 		app_q->shadow_qs[i].shared_q = true;
 		app_q->shadow_qs[i].ents =
@@ -1887,6 +1888,7 @@ static void app_port_shadowq_init(int lcl_id, struct lcl_port_desc *lcl_port, st
 		lcl_port->shadow_qs[i].read_ind = 0;
 		lcl_port->shadow_qs[i].write_ind = 0;
 		lcl_port->shadow_qs[i].send_ind = 0;
+		lcl_port->shadow_qs[i].done_pending = 0;
 		lcl_port->shadow_qs[i].shared_q = false;
 		lcl_port->shadow_qs[i].size = lcl_port->shadow_q_size;
 		lcl_port->shadow_qs[i].ents =
@@ -1947,6 +1949,7 @@ static void app_shadowqs_deinit(struct tx_shadow_q *shadow_q, int num_shadow_qs,
 		shadow_q->read_ind = 0;
 		shadow_q->write_ind = 0;
 		shadow_q->send_ind = 0;
+		shadow_q->done_pending = 0;
 		free(shadow_q->ents);
 		shadow_q++;
 	}
@@ -2153,6 +2156,109 @@ int app_pp2_sysfs_param_get(char *if_name, char *file)
 }
 
 
+int app_tlm_init(struct glb_common_args *glb_args, const char *name)
+{
+	struct pp2_glb_common_args *pp2_args = (struct pp2_glb_common_args *)glb_args->plat;
+	struct mv_tlm_params	tlm_params;
+	struct pp2_bpool_capabilities capa;
+	struct mv_tlm_bpool	*bp;
+	int			i, j, err;
+
+	memset(&tlm_params, 0, sizeof(tlm_params));
+	tlm_params.name = name;
+	tlm_params.num_queues = glb_args->cpus * glb_args->num_ports * APP_TLM_PORT_RECS;
+	tlm_params.num_bpools = pp2_args->pp2_num_inst * pp2_args->num_pools;
+
+	err = mv_tlm_create(&tlm_params, &pp2_args->tlm);
+	if (err) {
+		pr_err("failed to create telemetry segment %s\n", name);
+		return err;
+	}
+
+	for (i = 0; i < glb_args->num_ports; i++) {
+		struct port_desc *port = &pp2_args->ports_desc[i];
+		struct app_tlm_port *tlm_port = &pp2_args->tlm_ports[i];
+		u16 first_inq = 0;
+
+		for (j = 0; j < port->num_tcs; j++) {
+			tlm_port->first_inq[j] = first_inq;
+			first_inq += port->num_inqs[j];
+		}
+		tlm_port->inq_size = port->inq_size;
+	}
+
+	for (i = 0; i < pp2_args->pp2_num_inst; i++)
+		for (j = 0; j < pp2_args->num_pools; j++) {
+			struct bpool_desc *pool = &pp2_args->pools_desc[i][j];
+
+			memset(&capa, 0, sizeof(capa));
+			pp2_bpool_get_capabilities(pool->pool, &capa);
+			bp = mv_tlm_get_bpool(pp2_args->tlm, i * pp2_args->num_pools + j);
+			mv_tlm_bpool_register(bp, pool->pool->pp2_id, pool->pool->id, pool->num_buffs,
+					      capa.buff_len);
+		}
+	app_tlm_update(glb_args);
+
+	pr_info("telemetry exported to %s%s%s\n", MV_TLM_SHM_DIR, MV_TLM_SHM_PREFIX, name);
+	return 0;
+}
+
+void app_tlm_local_init(struct glb_common_args *glb_args, int id, struct pp2_lcl_common_args *lcl_pp2_args)
+{
+	struct pp2_glb_common_args *pp2_args = (struct pp2_glb_common_args *)glb_args->plat;
+
+	if (!pp2_args->tlm)
+		return;
+	lcl_pp2_args->tlm_qs = mv_tlm_get_queue(pp2_args->tlm, id * glb_args->num_ports * APP_TLM_PORT_RECS);
+	lcl_pp2_args->tlm_ports = pp2_args->tlm_ports;
+}
+
+/*
+ * Sample the levels that are only visible through the driver: in-Q occupancy and bpool fill.
+ * Called from the control thread; these are plain stores, so they don't race with the
+ * counters updated by the data-path threads.
+ */
+void app_tlm_update(struct glb_common_args *glb_args)
+{
+	struct pp2_glb_common_args *pp2_args = (struct pp2_glb_common_args *)glb_args->plat;
+	struct mv_tlm_hdr *hdr;
+	struct mv_tlm_queue *q;
+	u32 num_buffs;
+	u16 num_descs;
+	u32 k;
+	int i, j;
+
+	if (!pp2_args->tlm)
+		return;
+
+	hdr = mv_tlm_get_hdr(pp2_args->tlm);
+	for (k = 0; k < hdr->num_queues; k++) {
+		q = mv_tlm_get_queue(pp2_args->tlm, k);
+		if (!__atomic_load_n(&q->in_use, __ATOMIC_ACQUIRE) || q->dir != MV_TLM_Q_DIR_RX)
+			continue;
+		if (!pp2_ppio_get_num_inq_descs(pp2_args->ports_desc[q->port].ppio, q->tc, q->qid, &num_descs))
+			mv_tlm_queue_set_occupancy(q, num_descs);
+	}
+
+	for (i = 0; i < pp2_args->pp2_num_inst; i++)
+		for (j = 0; j < pp2_args->num_pools; j++) {
+			if (pp2_bpool_get_num_buffs(pp2_args->pools_desc[i][j].pool, &num_buffs))
+				continue;
+			mv_tlm_bpool_set_fill(mv_tlm_get_bpool(pp2_args->tlm, i * pp2_args->num_pools + j),
+					      num_buffs);
+		}
+}
+
+void app_tlm_deinit(struct glb_common_args *glb_args)
+{
+	struct pp2_glb_common_args *pp2_args = (struct pp2_glb_common_args *)glb_args->plat;
+
+	if (!pp2_args->tlm)
+		return;
+	mv_tlm_destroy(pp2_args->tlm);
+	pp2_args->tlm = NULL;
+}
+
 void apps_pp2_deinit_local(void *arg)
 {
 	struct local_common_args *common_arg = (struct local_common_args *)arg;
@@ -2233,8 +2339,10 @@ void apps_pp2_deinit_global(void *arg)
 	apps_pp2_destroy_local_modules(common_arg);
 	apps_pp2_destroy_all_modules();
 
-	if (common_arg->plat)
+	if (common_arg->plat) {
+		app_tlm_deinit(common_arg);
 		free(common_arg->plat);
+	}
 
 	pthread_mutex_destroy(&common_arg->thread_lock);
 
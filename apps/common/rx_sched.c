@@ -0,0 +1,261 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "mv_std.h"
+#include "rx_sched.h"
+
+/* Average poll fill, in 1/16 of a descriptor, with a weight of 1/8 */
+#define RX_SCHED_AVG_SHIFT		4
+#define RX_SCHED_AVG_WEIGHT_SHIFT	3
+
+struct rx_sched_src {
+	struct rx_sched_src_params	params;
+	u16				burst;
+	u16				interval;
+	u16				skip;	/* Visits left to skip */
+	u32				avg;	/* Average poll fill */
+	struct rx_sched_src_stats	stats;
+};
+
+struct rx_sched {
+	u16			 max_srcs;
+	u16			 max_interval;
+	u16			 num_srcs;
+	u16			 next;		/* Next source to visit */
+	struct rx_sched_src	*srcs;
+};
+
+int rx_sched_create(struct rx_sched_params *params, struct rx_sched **sched)
+{
+	struct rx_sched *s;
+
+	if (!params->max_srcs) {
+		pr_err("[%s] no sources\n", __func__);
+		return -EINVAL;
+	}
+
+	s = (struct rx_sched *)calloc(1, sizeof(struct rx_sched));
+	if (!s)
+		return -ENOMEM;
+	s->srcs = (struct rx_sched_src *)calloc(params->max_srcs, sizeof(struct rx_sched_src));
+	if (!s->srcs) {
+		free(s);
+		return -ENOMEM;
+	}
+	s->max_srcs = params->max_srcs;
+	s->max_interval = params->max_interval ? params->max_interval : RX_SCHED_DEF_MAX_INTERVAL;
+
+	*sched = s;
+	return 0;
+}
+
+void rx_sched_destroy(struct rx_sched *sched)
+{
+	free(sched->srcs);
+	free(sched);
+}
+
+int rx_sched_add_src(struct rx_sched *sched, struct rx_sched_src_params *params)
+{
+	struct rx_sched_src *src;
+
+	if (sched->num_srcs == sched->max_srcs) {
+		pr_err("[%s] all %u sources are in use\n", __func__, sched->max_srcs);
+		return -ENOSPC;
+	}
+	if (!params->recv || !params->max_burst) {
+		pr_err("[%s] no receive callback or burst\n", __func__);
+		return -EINVAL;
+	}
+
+	src = &sched->srcs[sched->num_srcs];
+	memset(src, 0, sizeof(*src));
+	src->params = *params;
+	if (!src->params.min_burst)
+		src->params.min_burst = RX_SCHED_DEF_MIN_BURST;
+	if (src->params.min_burst > src->params.max_burst)
+		src->params.min_burst = src->params.max_burst;
+	src->burst = src->params.max_burst;
+	src->interval = 1;
+	src->avg = (u32)src->burst << RX_SCHED_AVG_SHIFT;
+
+	return sched->num_srcs++;
+}
+
+static inline void rx_sched_src_update(struct rx_sched *sched, struct rx_sched_src *src, u16 num)
+{
+	u32 sample = (u32)num << RX_SCHED_AVG_SHIFT;
+
+	src->stats.polls++;
+	src->stats.pkts += num;
+	if (sample >= src->avg)
+		src->avg += (sample - src->avg) >> RX_SCHED_AVG_WEIGHT_SHIFT;
+	else
+		src->avg -= (src->avg - sample) >> RX_SCHED_AVG_WEIGHT_SHIFT;
+
+	if (!num) {
+		src->stats.empty_polls++;
+		if (src->interval > sched->max_interval / 2)
+			src->interval = sched->max_interval;
+		else
+			src->interval *= 2;
+		src->skip = src->interval - 1;
+	} else {
+		src->interval = 1;
+	}
+
+	if (num == src->burst) {
+		src->stats.full_polls++;
+		if (src->burst > src->params.max_burst / 2)
+			src->burst = src->params.max_burst;
+		else
+			src->burst *= 2;
+	} else if (num < src->burst / 4 &&
+		   (src->avg >> RX_SCHED_AVG_SHIFT) < src->burst / 4) {
+		src->burst = max((u16)(src->burst / 2), src->params.min_burst);
+	}
+}
+
+int rx_sched_recv(struct rx_sched *sched, void *descs, u16 *num)
+{
+	struct rx_sched_src *src;
+	u16 i, idx;
+	int err;
+
+	*num = 0;
+	for (i = 0; i < sched->num_srcs; i++) {
+		idx = sched->next;
+		src = &sched->srcs[idx];
+		if (++sched->next == sched->num_srcs)
+			sched->next = 0;
+
+		if (src->skip) {
+			src->skip--;
+			src->stats.skips++;
+			continue;
+		}
+
+		*num = src->burst;
+		err = src->params.recv(src->params.port, src->params.tc, src->params.qid, descs, num);
+		if (unlikely(err)) {
+			*num = 0;
+			return err;
+		}
+		rx_sched_src_update(sched, src, *num);
+		if (*num)
+			return idx;
+	}
+
+	return -EAGAIN;
+}
+
+int rx_sched_get_src_stats(struct rx_sched *sched, int src, struct rx_sched_src_stats *stats, int reset)
+{
+	struct rx_sched_src *s;
+
+	if (src < 0 || src >= sched->num_srcs)
+		return -EINVAL;
+
+	s = &sched->srcs[src];
+	*stats = s->stats;
+	stats->burst = s->burst;
+	stats->interval = s->interval;
+	if (reset)
+		memset(&s->stats, 0, sizeof(s->stats));
+	return 0;
+}
@@ -0,0 +1,300 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "mv_std.h"
+#include "env/mv_btrace.h"
+
+#include "utils.h"
+
+struct btrc_event {
+	struct mv_btrc_rec	rec;
+	u32			tid;
+};
+
+static const char *btrc_cat_names[MV_BTRC_CAT_LAST] = {"gie", "sam", "pp2", "app"};
+
+static void usage(char *progname)
+{
+	printf("\n"
+	       "MUSDK binary trace decoder.\n"
+	       "Decodes a trace file written by mv_btrc_dump() into text or Chrome trace JSON\n"
+	       "(load the JSON output in chrome://tracing or Perfetto).\n"
+	       "\n"
+	       "Usage: %s OPTIONS\n"
+	       "  E.g. %s -f /tmp/musdk.btrc -j -o trace.json\n"
+	       "\n"
+	       "Mandatory OPTIONS:\n"
+	       "\t-f <file>        Binary trace file\n"
+	       "\n"
+	       "Optional OPTIONS:\n"
+	       "\t-j               Chrome trace JSON output (default is text)\n"
+	       "\t-o <file>        Output file (default is stdout)\n"
+	       "\t-h, --help       Display help and exit.\n\n"
+	       "\n", MVAPPS_NO_PATH(progname), MVAPPS_NO_PATH(progname));
+}
+
+static int btrc_event_cmp(const void *a, const void *b)
+{
+	const struct btrc_event *ea = a, *eb = b;
+
+	if (ea->rec.ts != eb->rec.ts)
+		return (ea->rec.ts < eb->rec.ts) ? -1 : 1;
+	return 0;
+}
+
+static const char *btrc_cat_name(struct mv_btrc_tp *tp)
+{
+	return (tp->cat < MV_BTRC_CAT_LAST) ? btrc_cat_names[tp->cat] : "unknown";
+}
+
+static void btrc_print_text(FILE *out, struct btrc_event *ev, u32 num, struct mv_btrc_tp *tps, u64 freq)
+{
+	static const char *type_str[] = {"", " begin", " end"};
+	struct mv_btrc_tp *tp;
+	u64 t0 = num ? ev[0].rec.ts : 0;
+	u32 i, j;
+
+	for (i = 0; i < num; i++) {
+		tp = &tps[ev[i].rec.id];
+		fprintf(out, "%16.3f tid %-6u %s:%s%s", (double)(ev[i].rec.ts - t0) * 1000000 / freq,
+			ev[i].tid, btrc_cat_name(tp), tp->name[0] ? tp->name : "unknown",
+			type_str[tp->type % ARRAY_SIZE(type_str)]);
+		for (j = 0; j < tp->nargs && j < MV_BTRC_MAX_ARGS; j++)
+			fprintf(out, " %s=0x%" PRIx64, tp->arg_names[j], ev[i].rec.args[j]);
+		fprintf(out, "\n");
+	}
+}
+
+static void btrc_print_json(FILE *out, struct btrc_event *ev, u32 num, struct mv_btrc_tp *tps, u64 freq)
+{
+	static const char *phase[] = {"i", "B", "E"};
+	struct mv_btrc_tp *tp;
+	u64 t0 = num ? ev[0].rec.ts : 0;
+	u32 i, j;
+
+	fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	for (i = 0; i < num; i++) {
+		tp = &tps[ev[i].rec.id];
+		fprintf(out, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":0,\"tid\":%u,",
+			tp->name[0] ? tp->name : "unknown", btrc_cat_name(tp),
+			phase[tp->type % ARRAY_SIZE(phase)],
+			(double)(ev[i].rec.ts - t0) * 1000000 / freq, ev[i].tid);
+		if (tp->type == MV_BTRC_TYPE_INSTANT)
+			fprintf(out, "\"s\":\"t\",");
+		fprintf(out, "\"args\":{");
+		for (j = 0; j < tp->nargs && j < MV_BTRC_MAX_ARGS; j++)
+			fprintf(out, "%s\"%s\":%" PRIu64, j ? "," : "", tp->arg_names[j], ev[i].rec.args[j]);
+		fprintf(out, "}}%s\n", (i + 1 < num) ? "," : "");
+	}
+	fprintf(out, "]}\n");
+}
+
+int main(int argc, char *argv[])
+{
+	struct mv_btrc_file_hdr	 hdr;
+	struct mv_btrc_ring_hdr	 rhdr;
+	struct mv_btrc_tp	*tps = NULL;
+	struct btrc_event	*ev = NULL, *tmp;
+	FILE			*f = NULL, *out = stdout;
+	char			*in_file = NULL, *out_file = NULL;
+	int			 json = 0, i = 1, err = -EINVAL;
+	u32			 r, j, num = 0;
+	u64			 lost = 0;
+
+	while (i < argc) {
+		if ((strcmp(argv[i], "-h") == 0) || (strcmp(argv[i], "--help") == 0)) {
+			usage(argv[0]);
+			return 0;
+		}
+		if (strcmp(argv[i], "-j") == 0) {
+			json = 1;
+			i++;
+			continue;
+		}
+		if (argc < (i + 2)) {
+			pr_err("Invalid number of arguments!\n");
+			return -EINVAL;
+		}
+		if (strcmp(argv[i], "-f") == 0) {
+			in_file = argv[i + 1];
+		} else if (strcmp(argv[i], "-o") == 0) {
+			out_file = argv[i + 1];
+		} else {
+			pr_err("argument (%s) not supported!\n", argv[i]);
+			usage(argv[0]);
+			return -EINVAL;
+		}
+		i += 2;
+	}
+	if (!in_file) {
+		usage(argv[0]);
+		return -EINVAL;
+	}
+
+	f = fopen(in_file, "r");
+	if (!f) {
+		pr_err("failed to open %s\n", in_file);
+		return -EIO;
+	}
+	if (fread(&hdr, sizeof(hdr), 1, f) != 1 || hdr.magic != MV_BTRC_MAGIC ||
+	    hdr.version != MV_BTRC_VERSION || hdr.num_tps != MV_BTRC_MAX_TPS || !hdr.ts_freq) {
+		pr_err("%s is not a valid binary trace file\n", in_file);
+		goto decode_exit;
+	}
+
+	tps = calloc(hdr.num_tps, sizeof(*tps));
+	if (!tps || fread(tps, sizeof(*tps), hdr.num_tps, f) != hdr.num_tps) {
+		pr_err("failed to read tracepoint table\n");
+		goto decode_exit;
+	}
+
+	for (r = 0; r < hdr.num_rings; r++) {
+		if (fread(&rhdr, sizeof(rhdr), 1, f) != 1) {
+			pr_err("truncated trace file (ring %u)\n", r);
+			goto decode_exit;
+		}
+		tmp = realloc(ev, (num + rhdr.num_recs) * sizeof(*ev));
+		if (!tmp && (num + rhdr.num_recs)) {
+			err = -ENOMEM;
+			goto decode_exit;
+		}
+		ev = tmp;
+		for (j = 0; j < rhdr.num_recs; j++, num++) {
+			if (fread(&ev[num].rec, sizeof(struct mv_btrc_rec), 1, f) != 1) {
+				pr_err("truncated trace file (ring %u)\n", r);
+				goto decode_exit;
+			}
+			if (ev[num].rec.id >= MV_BTRC_MAX_TPS)
+				ev[num].rec.id = MV_BTRC_MAX_TPS - 1;
+			ev[num].tid = rhdr.tid;
+		}
+		lost += rhdr.lost;
+	}
+
+	if (num)
+		qsort(ev, num, sizeof(*ev), btrc_event_cmp);
+
+	if (out_file) {
+		out = fopen(out_file, "w");
+		if (!out) {
+			pr_err("failed to open %s\n", out_file);
+			out = stdout;
+			err = -EIO;
+			goto decode_exit;
+		}
+	}
+
+	if (json)
+		btrc_print_json(out, ev, num, tps, hdr.ts_freq);
+	else
+		btrc_print_text(out, ev, num, tps, hdr.ts_freq);
+
+	fprintf(stderr, "%u records from %u threads, %" PRIu64 " overwritten\n", num, hdr.num_rings, lost);
+	err = 0;
+
+decode_exit:
+	if (out != stdout)
+		fclose(out);
+	fclose(f);
+	free(ev);
+	free(tps);
+	return err;
+}
@@ -0,0 +1,446 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <time.h>
+
+#include "mv_std.h"
+#include "mvapp.h"
+#include "mv_ring.h"
+#include "utils.h"
+
+#define PIPE_DEMO_NUM_FLOWS		1024
+#define PIPE_DEMO_POOL_SIZE		8192
+#define PIPE_DEMO_DFLT_WORKERS		2
+#define PIPE_DEMO_DFLT_ITERS		2000
+#define PIPE_DEMO_DFLT_ELEPHANT		90
+#define PIPE_DEMO_DFLT_TIME		5
+
+/* Synthetic packet */
+struct pipe_demo_pkt {
+	u32	flow;
+	u32	seq;		/* per-flow sequence number */
+	u64	ts;		/* time of generation, in ns */
+	u32	digest;		/* result of the per-packet "crypto" work */
+};
+
+struct pipe_demo_garg {
+	int			 num_workers;
+	int			 iters;
+	int			 elephant_pct;
+	int			 steal;
+	int			 time_sec;
+	u16			 burst_size;
+
+	struct pipe_demo_pkt	*pkts;
+	struct mv_ring		*pool;
+	struct mvapp_pipe	*pipe;
+	u64			 start_ns;
+
+	/* generator state (stage 0 has a single worker) */
+	u32			 rand_state;
+	u32			 gen_seq[PIPE_DEMO_NUM_FLOWS];
+
+	/* sink state (the last stage has a single worker) */
+	u32			 sink_seq[PIPE_DEMO_NUM_FLOWS];
+	u64			 sunk;
+	u64			 reordered;
+	u64			 bad_digest;
+	u64			 lat_sum_ns;
+	u64			 lat_max_ns;
+};
+
+static struct pipe_demo_garg garg;
+
+static inline u64 pipe_demo_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline u32 pipe_demo_rand(void)
+{
+	/* xorshift32 */
+	garg.rand_state ^= garg.rand_state << 13;
+	garg.rand_state ^= garg.rand_state >> 17;
+	garg.rand_state ^= garg.rand_state << 5;
+	return garg.rand_state;
+}
+
+/* Stands for a heavy per-packet crypto setup */
+static u32 pipe_demo_digest(struct pipe_demo_pkt *pkt, int iters)
+{
+	u32 h = pkt->flow * 0x9e3779b9 + pkt->seq;
+	int i;
+
+	for (i = 0; i < iters; i++) {
+		h ^= h >> 15;
+		h *= 0x2c1b3c6d;
+		h ^= h >> 12;
+	}
+	return h | 1;
+}
+
+static u16 gen_burst_cb(void *arg, int worker, void **objs, u16 num)
+{
+	struct pipe_demo_pkt	*pkt;
+	u64			 now;
+	u16			 i;
+
+	num = mv_ring_dequeue_burst(garg.pool, objs, num);
+	now = pipe_demo_now_ns();
+	for (i = 0; i < num; i++) {
+		pkt = objs[i];
+		if ((int)(pipe_demo_rand() % 100) < garg.elephant_pct)
+			pkt->flow = 0;
+		else
+			pkt->flow = 1 + pipe_demo_rand() % (PIPE_DEMO_NUM_FLOWS - 1);
+		pkt->seq = ++garg.gen_seq[pkt->flow];
+		pkt->ts = now;
+		pkt->digest = 0;
+	}
+	return num;
+}
+
+static int work_dist_cb(void *arg, void *obj)
+{
+	return ((struct pipe_demo_pkt *)obj)->flow % garg.num_workers;
+}
+
+static u16 work_burst_cb(void *arg, int worker, void **objs, u16 num)
+{
+	u16 i;
+
+	for (i = 0; i < num; i++)
+		((struct pipe_demo_pkt *)objs[i])->digest = pipe_demo_digest(objs[i], garg.iters);
+	return num;
+}
+
+static u16 sink_burst_cb(void *arg, int worker, void **objs, u16 num)
+{
+	struct pipe_demo_pkt	*pkt;
+	u64			 now = pipe_demo_now_ns(), lat;
+	u16			 i;
+
+	for (i = 0; i < num; i++) {
+		pkt = objs[i];
+		if (!pkt->digest)
+			garg.bad_digest++;
+		if (pkt->seq < garg.sink_seq[pkt->flow])
+			garg.reordered++;
+		else
+			garg.sink_seq[pkt->flow] = pkt->seq;
+		lat = now - pkt->ts;
+		garg.lat_sum_ns += lat;
+		if (lat > garg.lat_max_ns)
+			garg.lat_max_ns = lat;
+	}
+	garg.sunk += num;
+	mv_ring_enqueue_burst(garg.pool, objs, num);
+	return 0;
+}
+
+static void drop_cb(void *arg, void **objs, u16 num)
+{
+	mv_ring_enqueue_burst(garg.pool, objs, num);
+}
+
+static int ctrl_cb(void *arg)
+{
+	/* a non-zero return value stops the application */
+	return (pipe_demo_now_ns() - garg.start_ns) >= (u64)garg.time_sec * 1000000000ULL;
+}
+
+static int init_all(void)
+{
+	struct mvapp_pipe_params	params;
+	void				*pkt;
+	int				i, err;
+
+	garg.pkts = calloc(PIPE_DEMO_POOL_SIZE, sizeof(struct pipe_demo_pkt));
+	if (!garg.pkts) {
+		pr_err("no mem for packets!\n");
+		return -ENOMEM;
+	}
+	err = mv_ring_create(PIPE_DEMO_POOL_SIZE, &garg.pool);
+	if (err)
+		return err;
+	for (i = 0; i < PIPE_DEMO_POOL_SIZE; i++) {
+		pkt = &garg.pkts[i];
+		mv_ring_enqueue_burst(garg.pool, &pkt, 1);
+	}
+
+	memset(&params, 0, sizeof(params));
+	params.num_stages = 3;
+	params.burst_size = garg.burst_size;
+	params.drop_cb = drop_cb;
+
+	params.stages[0].name = "gen";
+	params.stages[0].num_workers = 1;
+	params.stages[0].burst_cb = gen_burst_cb;
+
+	params.stages[1].name = "work";
+	params.stages[1].num_workers = garg.num_workers;
+	params.stages[1].burst_cb = work_burst_cb;
+	params.stages[1].dist_cb = work_dist_cb;
+	params.stages[1].steal = garg.steal;
+
+	params.stages[2].name = "sink";
+	params.stages[2].num_workers = 1;
+	params.stages[2].burst_cb = sink_burst_cb;
+
+	return mvapp_pipe_init(&params, &garg.pipe);
+}
+
+/* Every packet is either in the pool or in flight between two stages */
+static int check_conservation(void)
+{
+	struct mvapp_pipe_stats	prev, stats;
+	u64			in_flight = 0;
+	int			i;
+
+	mvapp_pipe_get_stats(garg.pipe, 0, -1, &prev, 0);
+	if (prev.objs_in != prev.objs_out + prev.drops) {
+		pr_err("gen: %llu produced, %llu forwarded, %llu dropped\n",
+		       (unsigned long long)prev.objs_in, (unsigned long long)prev.objs_out,
+		       (unsigned long long)prev.drops);
+		return -EINVAL;
+	}
+	for (i = 1; i < 3; i++) {
+		mvapp_pipe_get_stats(garg.pipe, i, -1, &stats, 0);
+		if (stats.objs_in > prev.objs_out) {
+			pr_err("stage %d got more packets than sent to it\n", i);
+			return -EINVAL;
+		}
+		in_flight += prev.objs_out - stats.objs_in;
+		prev = stats;
+	}
+	if (mv_ring_count(garg.pool) + in_flight != PIPE_DEMO_POOL_SIZE) {
+		pr_err("lost packets: %u in pool, %llu in flight\n", mv_ring_count(garg.pool),
+		       (unsigned long long)in_flight);
+		return -EINVAL;
+	}
+	return 0;
+}
+
+static void usage(char *progname)
+{
+	printf("\n"
+	       "MUSDK pipeline mode demo.\n"
+	       "Runs a gen -> work -> sink pipeline on software rings; most of the generated\n"
+	       "packets belong to one flow, which is pinned to one 'work' worker unless\n"
+	       "work stealing is enabled.\n"
+	       "\n"
+	       "Usage: %s OPTIONS\n"
+	       "  E.g. %s -w 2 -s\n"
+	       "\n"
+	       "Optional OPTIONS:\n"
+	       "\t-w <num>         Number of 'work' workers (default is %d); %d cores are used in total\n"
+	       "\t-i <num>         Per-packet work iterations (default is %d)\n"
+	       "\t-e <pct>         Percentage of packets of the elephant flow (default is %d)\n"
+	       "\t-b <size>        Burst size (default is %d)\n"
+	       "\t-t <sec>         Run time (default is %d)\n"
+	       "\t-s               Enable work stealing between the 'work' workers\n"
+	       "\t-h, --help       Display help and exit.\n\n"
+	       "\n", MVAPPS_NO_PATH(progname), MVAPPS_NO_PATH(progname), PIPE_DEMO_DFLT_WORKERS,
+	       PIPE_DEMO_DFLT_WORKERS + 2, PIPE_DEMO_DFLT_ITERS, PIPE_DEMO_DFLT_ELEPHANT,
+	       MVAPP_PIPE_MAX_BURST, PIPE_DEMO_DFLT_TIME);
+}
+
+static int parse_args(int argc, char *argv[])
+{
+	int opt;
+
+	garg.num_workers = PIPE_DEMO_DFLT_WORKERS;
+	garg.iters = PIPE_DEMO_DFLT_ITERS;
+	garg.elephant_pct = PIPE_DEMO_DFLT_ELEPHANT;
+	garg.time_sec = PIPE_DEMO_DFLT_TIME;
+	garg.burst_size = MVAPP_PIPE_MAX_BURST;
+
+	while ((opt = getopt(argc, argv, "w:i:e:b:t:sh")) != -1) {
+		switch (opt) {
+		case 'w':
+			garg.num_workers = atoi(optarg);
+			break;
+		case 'i':
+			garg.iters = atoi(optarg);
+			break;
+		case 'e':
+			garg.elephant_pct = atoi(optarg);
+			break;
+		case 'b':
+			garg.burst_size = atoi(optarg);
+			break;
+		case 't':
+			garg.time_sec = atoi(optarg);
+			break;
+		case 's':
+			garg.steal = 1;
+			break;
+		case 'h':
+		default:
+			usage(argv[0]);
+			return -EINVAL;
+		}
+	}
+
+	if (garg.num_workers < 1 || garg.num_workers + 2 > system_ncpus() ||
+	    garg.iters < 0 || garg.elephant_pct < 0 || garg.elephant_pct > 100 ||
+	    garg.burst_size < 1 || garg.burst_size > MVAPP_PIPE_MAX_BURST || garg.time_sec < 1) {
+		pr_err("Invalid arguments (need %d cores, have %d)!\n", garg.num_workers + 2, system_ncpus());
+		usage(argv[0]);
+		return -EINVAL;
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct mvapp_params	mvapp_params;
+	u64			elapsed;
+	int			err;
+
+	memset(&garg, 0, sizeof(garg));
+	garg.rand_state = 2463534242U;
+
+	err = parse_args(argc, argv);
+	if (err)
+		return err;
+
+	err = init_all();
+	if (err)
+		return err;
+
+	memset(&mvapp_params, 0, sizeof(mvapp_params));
+	mvapp_params.use_cli = MVAPP_CLI_MODE_NONE;
+	mvapp_params.num_cores = garg.num_workers + 2;
+	mvapp_params.global_arg = &garg;
+	mvapp_params.ctrl_cb = ctrl_cb;
+	mvapp_params.pipe = garg.pipe;
+
+	garg.start_ns = pipe_demo_now_ns();
+	err = mvapp_go(&mvapp_params);
+	elapsed = pipe_demo_now_ns() - garg.start_ns;
+
+	mvapp_pipe_dump_stats(garg.pipe);
+	printf("work stealing %s: %.3f Mpps, latency avg %llu ns max %llu ns, %llu reordered\n",
+	       garg.steal ? "on" : "off", (double)garg.sunk * 1000 / elapsed,
+	       (unsigned long long)(garg.sunk ? garg.lat_sum_ns / garg.sunk : 0),
+	       (unsigned long long)garg.lat_max_ns, (unsigned long long)garg.reordered);
+
+	if (!err && garg.bad_digest) {
+		pr_err("%llu packets skipped the work stage\n", (unsigned long long)garg.bad_digest);
+		err = -EINVAL;
+	}
+	if (!err)
+		err = check_conservation();
+	/* without stealing every flow is handled by a single worker, so its order must hold */
+	if (!err && !garg.steal && garg.reordered) {
+		pr_err("flow order broken without work stealing\n");
+		err = -EINVAL;
+	}
+
+	mvapp_pipe_deinit(garg.pipe);
+	mv_ring_delete(garg.pool);
+	free(garg.pkts);
+
+	return err;
+}
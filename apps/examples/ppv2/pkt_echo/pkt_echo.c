@@ -220,6 +220,8 @@ struct glob_arg {
 	int				port_num_inqs[MVAPPS_PP2_MULTI_PORT_MAX_NUM_PORTS];
 	/* Parameters for the local_threads */
 	struct local_thr_params		*lcl_params;
+	/* Telemetry segment name, empty if telemetry is disabled */
+	char				tlm_name[MV_TLM_NAME_MAX];
 };
 
 struct local_arg {
@@ -789,6 +791,14 @@ static int register_cli_cmds(struct glob_arg *garg)
 	return 0;
 }
 
+static int ctrl_cb(void *arg)
+{
+	struct glob_arg *garg = (struct glob_arg *)arg;
+
+	app_tlm_update(&garg->cmn_args);
+	return app_ctrl_cb(arg);
+}
+
 static int unregister_cli_cmds(struct glob_arg *garg)
 {
 	/* TODO: unregister cli cmds */
@@ -823,6 +833,12 @@ static int init_global(void *arg)
 	if (err)
 		return err;
 
+	if (garg->tlm_name[0]) {
+		err = app_tlm_init(&garg->cmn_args, garg->tlm_name);
+		if (err)
+			return err;
+	}
+
 	if (garg->cmn_args.cli) {
 		err = register_cli_cmds(garg);
 		if (err)
@@ -902,6 +918,7 @@ static int init_local(void *arg, int id, void **_larg)
 
 	lcl_pp2_args->pools_desc	= glb_pp2_args->pools_desc;
 	lcl_pp2_args->multi_buffer_release = glb_pp2_args->multi_buffer_release;
+	app_tlm_local_init(&garg->cmn_args, id, lcl_pp2_args);
 	larg->cmn_args.garg             = garg;
 
 	larg->cmn_args.qs_map = garg->cmn_args.qs_map << (garg->cmn_args.qs_map_shift * id);
@@ -948,13 +965,15 @@ static void usage(char *progname)
 	       "\t--pkt-offset <size>      Packet offset in buffer, must be multiple of 32-byte (default is %d)\n"
 	       "\t--mem-regions <number>   Number of mv_sys_dma_mem_regions (default=0)\n"
 	       "\t--old-tx-desc-release    Use pp2_bpool_put_buff(), instead of NEW pp2_bpool_put_buffs() API\n"
+	       "\t--no-burst-tx-release    Release Tx-done buffers on every poll, instead of in bursts of %d or more\n"
 	       "\t--no-echo                Don't perform 'pkt_echo', N/A w/o define APP_PKT_ECHO_SUPPORT\n"
 	       "\t--bm <number>            Number of Buffers in BM pool (for short packets only) (default=4096)\n"
+	       "\t--telemetry <name>       Export per-queue telemetry to shared memory (read by musdk_tlm_reader)\n"
 	       "\t--cli                    Use CLI\n"
 	       "\t?, -h, --help            Display help and exit.\n\n"
 	       "\n", MVAPPS_NO_PATH(progname), MVAPPS_NO_PATH(progname),
 	       MVAPPS_PP2_MAX_I_OPTION_PORTS, PKT_ECHO_APP_DFLT_BURST_SIZE, DEFAULT_MTU, PKT_ECHO_APP_RX_Q_SIZE,
-	       PKT_ECHO_APP_TX_Q_SIZE, MVAPPS_PP2_PKT_DEF_OFFS);
+	       PKT_ECHO_APP_TX_Q_SIZE, MVAPPS_PP2_PKT_DEF_OFFS, MVAPPS_PP2_BUFF_RELEASE_THRESH);
 }
 
 static int parse_args(struct glob_arg *garg, int argc, char *argv[])
@@ -981,7 +1000,7 @@ static int parse_args(struct glob_arg *garg, int argc, char *argv[])
 	garg->cmn_args.num_mem_regions = MVAPPS_INVALID_MEMREGIONS;
 	garg->maintain_stats = 0;
 
-	pp2_args->multi_buffer_release = 1;
+	pp2_args->multi_buffer_release = MVAPPS_PP2_BUFF_RELEASE_BURST;
 
 	while (i < argc) {
 		if ((strcmp(argv[i], "?") == 0) ||
@@ -1126,7 +1145,10 @@ static int parse_args(struct glob_arg *garg, int argc, char *argv[])
 			garg->cmn_args.pkt_offset = atoi(argv[i + 1]);
 			i += 2;
 		} else if (strcmp(argv[i], "--old-tx-desc-release") == 0) {
-			pp2_args->multi_buffer_release = 0;
+			pp2_args->multi_buffer_release = MVAPPS_PP2_BUFF_RELEASE_SINGLE;
+			i += 1;
+		} else if (strcmp(argv[i], "--no-burst-tx-release") == 0) {
+			pp2_args->multi_buffer_release = MVAPPS_PP2_BUFF_RELEASE_MULTI;
 			i += 1;
 		} else if (strcmp(argv[i], "-m") == 0) {
 			int rv;
@@ -1155,6 +1177,13 @@ static int parse_args(struct glob_arg *garg, int argc, char *argv[])
 		} else if (strcmp(argv[i], "--cli") == 0) {
 			garg->cmn_args.cli = 1;
 			i += 1;
+		} else if (strcmp(argv[i], "--telemetry") == 0) {
+			if (argc < (i + 2)) {
+				pr_err("Invalid number of arguments!\n");
+				return -EINVAL;
+			}
+			snprintf(garg->tlm_name, sizeof(garg->tlm_name), "%s", argv[i + 1]);
+			i += 2;
 		} else if (strcmp(argv[i], "--mem-regions") == 0) {
 			garg->cmn_args.num_mem_regions = atoi(argv[i + 1]);
 			i += 2;
@@ -1271,7 +1300,7 @@ int main(int argc, char *argv[])
 	mvapp_params.deinit_local_cb	= apps_pp2_deinit_local;
 	mvapp_params.main_loop_cb	= main_loop;
 	if (!mvapp_params.use_cli)
-		mvapp_params.ctrl_cb	= app_ctrl_cb;
+		mvapp_params.ctrl_cb	= ctrl_cb;
 
 	return mvapp_go(&mvapp_params);
 }
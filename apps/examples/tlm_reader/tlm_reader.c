@@ -0,0 +1,232 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "mv_std.h"
+#include "lib/mv_telemetry.h"
+
+#include "utils.h"
+
+#define TLM_READER_DFLT_INTERVAL_MS	1000
+
+static void usage(char *progname)
+{
+	printf("\n"
+	       "MUSDK telemetry reader.\n"
+	       "Samples a telemetry segment exported by a MUSDK application (e.g. musdk_pp2_pkt_echo --telemetry)\n"
+	       "without interacting with its data-path threads.\n"
+	       "\n"
+	       "Usage: %s OPTIONS\n"
+	       "  E.g. %s -n echo0 -t 500\n"
+	       "\n"
+	       "Mandatory OPTIONS:\n"
+	       "\t-n <name>        Telemetry segment name\n"
+	       "\n"
+	       "Optional OPTIONS:\n"
+	       "\t-t <msec>        Sampling interval (default is %d)\n"
+	       "\t-c <count>       Number of samples, 0 for endless (default is 0)\n"
+	       "\t-h, --help       Display help and exit.\n\n"
+	       "\n", MVAPPS_NO_PATH(progname), MVAPPS_NO_PATH(progname), TLM_READER_DFLT_INTERVAL_MS);
+}
+
+static void tlm_sample(struct mv_tlm *tlm, struct mv_tlm_queue *prev, u64 interval_us)
+{
+	struct mv_tlm_hdr	*hdr = mv_tlm_get_hdr(tlm);
+	struct mv_tlm_queue	 snap;
+	struct mv_tlm_bpool	*bp;
+	u32			 i;
+
+	printf("%-6s %-4s %-4s %-3s %-4s %10s %10s %10s %8s %14s\n",
+	       "thread", "port", "dir", "tc", "qid", "Kpps", "Mbps", "drops", "occup", "total-pkts");
+	for (i = 0; i < hdr->num_queues; i++) {
+		struct mv_tlm_queue *q = mv_tlm_get_queue(tlm, i);
+
+		if (!__atomic_load_n(&q->in_use, __ATOMIC_ACQUIRE))
+			continue;
+		mv_tlm_queue_read(q, &snap);
+		printf("%-6u %-4u %-4s %-3u %-4u %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %4u/%-4u %14" PRIu64 "\n",
+		       snap.thread, snap.port, (snap.dir == MV_TLM_Q_DIR_RX) ? "rx" : "tx", snap.tc, snap.qid,
+		       (snap.pkts - prev[i].pkts) * 1000 / interval_us,
+		       (snap.bytes - prev[i].bytes) * 8 / interval_us,
+		       snap.drops - prev[i].drops, snap.occupancy, snap.size, snap.pkts);
+		prev[i] = snap;
+	}
+
+	for (i = 0; i < hdr->num_bpools; i++) {
+		bp = mv_tlm_get_bpool(tlm, i);
+		if (!__atomic_load_n(&bp->in_use, __ATOMIC_ACQUIRE))
+			continue;
+		printf("pool-%u:%u: buff_len %u, fill %u/%u\n", bp->pp_id, bp->pool_id, bp->buff_len,
+		       __atomic_load_n(&bp->fill, __ATOMIC_RELAXED), bp->size);
+	}
+	printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+	struct mv_tlm		*tlm;
+	struct mv_tlm_hdr	*hdr;
+	struct mv_tlm_queue	*prev;
+	struct timeval		 t_last, t_curr;
+	char			*name = NULL;
+	int			 interval_ms = TLM_READER_DFLT_INTERVAL_MS;
+	int			 count = 0, i = 1, n, err;
+	u64			 interval_us;
+
+	setbuf(stdout, NULL);
+
+	while (i < argc) {
+		if ((strcmp(argv[i], "-h") == 0) || (strcmp(argv[i], "--help") == 0)) {
+			usage(argv[0]);
+			return 0;
+		}
+		if (argc < (i + 2)) {
+			pr_err("Invalid number of arguments!\n");
+			return -EINVAL;
+		}
+		if (strcmp(argv[i], "-n") == 0) {
+			name = argv[i + 1];
+		} else if (strcmp(argv[i], "-t") == 0) {
+			interval_ms = atoi(argv[i + 1]);
+		} else if (strcmp(argv[i], "-c") == 0) {
+			count = atoi(argv[i + 1]);
+		} else {
+			pr_err("argument (%s) not supported!\n", argv[i]);
+			usage(argv[0]);
+			return -EINVAL;
+		}
+		i += 2;
+	}
+	if (!name || interval_ms <= 0) {
+		usage(argv[0]);
+		return -EINVAL;
+	}
+
+	err = mv_tlm_attach(name, &tlm);
+	if (err)
+		return err;
+	hdr = mv_tlm_get_hdr(tlm);
+	printf("telemetry %s: pid %u, %u queue records, %u bpool records\n",
+	       hdr->name, hdr->pid, hdr->num_queues, hdr->num_bpools);
+
+	prev = calloc(hdr->num_queues ? hdr->num_queues : 1, sizeof(struct mv_tlm_queue));
+	if (!prev) {
+		mv_tlm_detach(tlm);
+		return -ENOMEM;
+	}
+	for (i = 0; i < hdr->num_queues; i++)
+		mv_tlm_queue_read(mv_tlm_get_queue(tlm, i), &prev[i]);
+
+	gettimeofday(&t_last, NULL);
+	for (n = 0; !count || n < count; n++) {
+		usleep(interval_ms * 1000);
+		gettimeofday(&t_curr, NULL);
+		interval_us = (t_curr.tv_sec - t_last.tv_sec) * 1000000 + (t_curr.tv_usec - t_last.tv_usec);
+		t_last = t_curr;
+		if (!interval_us)
+			interval_us = 1;
+		tlm_sample(tlm, prev, interval_us);
+	}
+
+	free(prev);
+	mv_tlm_detach(tlm);
+	return 0;
+}
@@ -0,0 +1,259 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#ifndef __mv_ring_h__
+#define __mv_ring_h__
+
+/* includes */
+#include <stdlib.h>
+#include <string.h>
+
+#include "mv_std.h"
+#include "env/spinlock.h"	/* spin_relax */
+
+/* Lock-free multi-producer/multi-consumer FIFO ring of object pointers.
+ *
+ * Producers (and consumers) reserve a contiguous range of slots by moving
+ * the 'head' index with a CAS, copy the objects, and then publish the range
+ * by moving the 'tail' index in reservation order. A thread that was
+ * preempted between the two steps delays the publication of the later
+ * reservations, so the ring is meant for threads that are pinned to cores.
+ */
+
+struct mv_ring_headtail {
+	u32	head;	/**< next slot to reserve */
+	u32	tail;	/**< all slots below it are published */
+} __attribute__((aligned(64)));
+
+/**
+ * Ring instance structure
+ */
+struct mv_ring {
+	u32			size;	/**< number of slots, power of 2 */
+	u32			mask;
+	struct mv_ring_headtail	prod;
+	struct mv_ring_headtail	cons;
+	void			*objs[0];
+};
+
+/* Reserve up to 'num' slots in 'ht', bounded by 'capacity' ahead of the opposite tail */
+static inline u32 mv_ring_move_head(struct mv_ring_headtail *ht, struct mv_ring_headtail *other,
+				    u32 capacity, u32 num, u32 *old)
+{
+	u32 avail;
+
+	*old = __atomic_load_n(&ht->head, __ATOMIC_RELAXED);
+	do {
+		avail = capacity + __atomic_load_n(&other->tail, __ATOMIC_ACQUIRE) - *old;
+		if (num > avail)
+			num = avail;
+		if (!num)
+			return 0;
+	} while (!__atomic_compare_exchange_n(&ht->head, old, *old + num, 0,
+					      __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+	return num;
+}
+
+/* Publish the slots [old, old + num) once the earlier reservations are published.
+ * The wait is an acquire, so that the release below publishes the slots of the
+ * earlier reservations as well.
+ */
+static inline void mv_ring_update_tail(struct mv_ring_headtail *ht, u32 old, u32 num)
+{
+	while (__atomic_load_n(&ht->tail, __ATOMIC_ACQUIRE) != old)
+		spin_relax();
+	__atomic_store_n(&ht->tail, old + num, __ATOMIC_RELEASE);
+}
+
+/**
+ *  Enqueue up to 'num' objects to the ring
+ *
+ * @param[in]	ring	- ring handler.
+ * @param[in]	objs	- array of objects.
+ * @param[in]	num	- number of objects in 'objs'.
+ *
+ * @retval	number of objects enqueued (the first ones of 'objs'); less than 'num' if the ring is full
+ */
+static inline u16 mv_ring_enqueue_burst(struct mv_ring *ring, void **objs, u16 num)
+{
+	u32 old, i, n;
+
+	n = mv_ring_move_head(&ring->prod, &ring->cons, ring->size, num, &old);
+	for (i = 0; i < n; i++)
+		ring->objs[(old + i) & ring->mask] = objs[i];
+	if (n)
+		mv_ring_update_tail(&ring->prod, old, n);
+	return n;
+}
+
+/**
+ *  Dequeue up to 'num' objects from the ring
+ *
+ * @param[in]	ring	- ring handler.
+ * @param[out]	objs	- array to fill with the dequeued objects.
+ * @param[in]	num	- size of 'objs'.
+ *
+ * @retval	number of objects dequeued
+ */
+static inline u16 mv_ring_dequeue_burst(struct mv_ring *ring, void **objs, u16 num)
+{
+	u32 old, i, n;
+
+	n = mv_ring_move_head(&ring->cons, &ring->prod, 0, num, &old);
+	for (i = 0; i < n; i++)
+		objs[i] = ring->objs[(old + i) & ring->mask];
+	if (n)
+		mv_ring_update_tail(&ring->cons, old, n);
+	return n;
+}
+
+/**
+ *  Get number of objects in the ring
+ *
+ * The value is a snapshot; it may be stale by the time it is used.
+ *
+ * @param[in]	ring	- ring handler.
+ *
+ * @retval	number of objects in the ring
+ */
+static inline u32 mv_ring_count(struct mv_ring *ring)
+{
+	/* consumer first: the producer tail read after it is never behind it */
+	u32 cons = __atomic_load_n(&ring->cons.tail, __ATOMIC_ACQUIRE);
+	u32 cnt = __atomic_load_n(&ring->prod.tail, __ATOMIC_ACQUIRE) - cons;
+
+	return (cnt > ring->size) ? ring->size : cnt;
+}
+
+/**
+ *  Create new ring instance
+ *
+ * @param[in]	size	- number of slots; must be a power of 2.
+ * @param[out]	ring	- address of place to save handler of new created ring instance.
+ *
+ * @retval	0         - success
+ * @retval	Negative  - failure
+ */
+static inline int mv_ring_create(u32 size, struct mv_ring **ring)
+{
+	struct mv_ring *r;
+
+	if (!size || (size & (size - 1))) {
+		pr_err("%s: ring size (%u) must be a power of 2\n", __func__, size);
+		return -EINVAL;
+	}
+	if (posix_memalign((void **)&r, 64, sizeof(*r) + size * sizeof(void *))) {
+		pr_err("%s: no mem for ring\n", __func__);
+		return -ENOMEM;
+	}
+	memset(r, 0, sizeof(*r));
+	r->size = size;
+	r->mask = size - 1;
+	*ring = r;
+	return 0;
+}
+
+/**
+ *  Delete ring instance
+ *
+ * @param[in]	ring	- ring handler.
+ */
+static inline void mv_ring_delete(struct mv_ring *ring)
+{
+	free(ring);
+}
+
+#endif /* __mv_ring_h__ */
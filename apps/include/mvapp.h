@@ -100,6 +100,11 @@
 #include "mvapp_std.h"
 #include "cli.h"
 
+#define MVAPP_PIPE_MAX_STAGES		8
+#define MVAPP_PIPE_MAX_BURST		64
+
+struct mvapp_pipe;
+
 enum mvapp_cli_mode {
 	MVAPP_CLI_MODE_NONE = 0,
 	MVAPP_CLI_MODE_ENABLED,
@@ -124,14 +129,89 @@ struct mvapp_params {
 	int			 (*main_loop_cb)(void *, int *);
 	/** Application control thread callback; application may use this callback in order to run
 	 *  some control operations. Note that app must not run "forever" loop within this callback.
+	 *  A non-zero return value stops the application.
 	 */
 	int			 (*ctrl_cb)(void *);
 	/** Threshold that will be used between the calls for 'ctrl_cb' in m-secs.
 	 *  '0' value means to use the default; By default, the threshold is 100mSecs.
 	 */
 	int			 ctrl_cb_threshold;
+	/** Optional pipeline (see mvapp_pipe_init()); when given, every thread runs the pipeline
+	 *  stage it is assigned to instead of 'main_loop_cb'. The pipeline must have exactly
+	 *  'num_cores' workers.
+	 */
+	struct mvapp_pipe	*pipe;
+};
+
+/*
+ * Pipeline mode
+ *
+ * Instead of running the same loop on every core (run-to-completion), the
+ * work is split into stages. Every stage has one or more workers (one per
+ * thread) and every worker of stage N>0 has its own lock-free input ring,
+ * fed by the workers of stage N-1. A worker whose ring is empty may steal
+ * a burst from the ring of another worker of the same stage, so one heavy
+ * flow can be spread over all the workers of a stage (at the price of its
+ * packet order).
+ *
+ * Threads are assigned to the workers in stage order: the workers of stage
+ * 0 get the first thread ids, then the workers of stage 1, and so on.
+ */
+struct mvapp_pipe_stage_params {
+	const char		*name;
+	int			 num_workers;
+	/** Burst callback.
+	 *  For stage 0 (the source), 'num' is the room in 'objs'; the callback fills 'objs' and
+	 *  returns the number of objects it produced.
+	 *  For the other stages, the callback processes the 'num' objects in 'objs', moves the
+	 *  objects to forward to the next stage to the start of 'objs' and returns their number.
+	 *  Objects that are not forwarded are owned by the callback; the last stage must
+	 *  consume all of them.
+	 */
+	u16			 (*burst_cb)(void *arg, int worker, void **objs, u16 num);
+	void			*arg;
+	/** Optional; returns the worker of this stage that should get 'obj' (e.g. by its flow
+	 *  hash). By default every burst is sent to the next worker in round-robin order.
+	 */
+	int			 (*dist_cb)(void *arg, void *obj);
+	/** Let idle workers steal from the input rings of the other workers of the stage */
+	int			 steal;
+	/** Size of the input ring of every worker (power of 2); '0' means 1024 */
+	u32			 ring_size;
+};
+
+struct mvapp_pipe_params {
+	int				num_stages;
+	struct mvapp_pipe_stage_params	stages[MVAPP_PIPE_MAX_STAGES];
+	/** Burst size; '0' means MVAPP_PIPE_MAX_BURST */
+	u16				burst_size;
+	/** Called with the objects that could not be passed to the next stage (rings full) */
+	void				(*drop_cb)(void *arg, void **objs, u16 num);
+	void				*drop_arg;
 };
 
+struct mvapp_pipe_stats {
+	u64	bursts;		/**< non-empty bursts processed */
+	u64	objs_in;	/**< objects processed (produced, for stage 0) */
+	u64	objs_out;	/**< objects passed to the next stage */
+	u64	drops;		/**< objects dropped because the next stage was full */
+	u64	stolen;		/**< objects stolen from other workers' rings */
+	u64	idle_polls;	/**< polls that found no work */
+	u64	occ_sum;	/**< sum of the input ring occupancy, sampled at every poll */
+	u64	occ_samples;
+	u64	occ_max;
+	u64	busy_ns;	/**< time spent in the burst callback */
+	u64	max_burst_ns;	/**< longest burst callback */
+};
+
+int mvapp_pipe_init(struct mvapp_pipe_params *params, struct mvapp_pipe **pipe);
+void mvapp_pipe_deinit(struct mvapp_pipe *pipe);
+int mvapp_pipe_num_workers(struct mvapp_pipe *pipe);
+int mvapp_pipe_poll(struct mvapp_pipe *pipe, int id);
+int mvapp_pipe_get_stats(struct mvapp_pipe *pipe, int stage, int worker,
+			 struct mvapp_pipe_stats *stats, int reset);
+void mvapp_pipe_dump_stats(struct mvapp_pipe *pipe);
+
 int mvapp_go(struct mvapp_params *mvapp_params);
 
 void mvapp_barrier(void);
@@ -0,0 +1,259 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#ifndef __PKT_PARSE_H__
+#define __PKT_PARSE_H__
+
+#include "mv_std.h"
+#include "drivers/mv_pp2_ppio.h"
+#include "drivers/mv_neta_ppio.h"
+#include "drivers/mv_giu_gpio.h"
+
+/*
+ * Burst packet parsing helpers.
+ *
+ * The helpers walk the L2/L3/L4 headers of a burst of received packets in
+ * software and return the header offsets, the 5-tuple and a flow hash of
+ * every packet. Packet headers are prefetched 'prefetch_shift' packets ahead
+ * of the one being parsed, so that the memory latency of a packet is hidden
+ * behind the parsing of the packets preceding it in the burst.
+ *
+ * The driver adapters only read the descriptors (which are already in cache
+ * after the receive call) in order to locate the packets, and then hand the
+ * burst to the generic parser.
+ */
+
+/* Maximum number of VLAN tags walked by the parser */
+#define PKT_PARSE_MAX_VLANS		2
+/* Maximum number of IPv6 extension headers walked by the parser */
+#define PKT_PARSE_MAX_IPV6_EXTS		4
+/* Default prefetch distance, in packets */
+#define PKT_PARSE_DEF_PREFETCH_SHIFT	4
+
+/* Parse flags */
+#define PKT_PARSE_F_HASH		BIT(0)	/* Calculate the 5-tuple hash */
+
+enum pkt_parse_l3_type {
+	PKT_PARSE_L3_TYPE_NA = 0,	/* Unknown or truncated L3 header */
+	PKT_PARSE_L3_TYPE_IPV4,
+	PKT_PARSE_L3_TYPE_IPV6,
+	PKT_PARSE_L3_TYPE_ARP,
+	PKT_PARSE_L3_TYPE_OTHER
+};
+
+enum pkt_parse_l4_type {
+	PKT_PARSE_L4_TYPE_NA = 0,	/* No L4 header, truncated, or non-first fragment */
+	PKT_PARSE_L4_TYPE_TCP,
+	PKT_PARSE_L4_TYPE_UDP,
+	PKT_PARSE_L4_TYPE_OTHER
+};
+
+union pkt_parse_ip_addr {
+	u32	v4;		/* IPv4 address, host byte order */
+	u8	v6[16];		/* IPv6 address, network byte order */
+};
+
+struct pkt_5tuple {
+	union pkt_parse_ip_addr	src;
+	union pkt_parse_ip_addr	dst;
+	u16			sport;	/* host byte order; zero if not TCP/UDP */
+	u16			dport;	/* host byte order; zero if not TCP/UDP */
+	u8			proto;	/* IP protocol (last IPv6 next-header) */
+	u8			ip_ver;	/* 4, 6 or zero if not IP */
+};
+
+struct pkt_parse_info {
+	/* Input: start of the ethernet header and length of the frame */
+	char			*data;
+	u16			 len;
+
+	/* Output */
+	u8			 num_vlans;
+	u16			 vlan_id;	/* Outer VLAN id, valid if num_vlans != 0 */
+	u16			 eth_type;	/* Ethertype following the VLAN tags */
+	enum pkt_parse_l3_type	 l3_type;
+	enum pkt_parse_l4_type	 l4_type;
+	u16			 l3_offset;	/* Relative to 'data' */
+	u16			 l4_offset;	/* Relative to 'data'; valid if l4_type != NA */
+	u32			 hash;		/* 5-tuple hash, valid with PKT_PARSE_F_HASH */
+	struct pkt_5tuple	 tuple;
+};
+
+/**
+ * Parse a single packet.
+ *
+ * @param[in,out]	info	Parse info. 'data' and 'len' must be set by the caller.
+ * @param[in]		flags	PKT_PARSE_F_xxx flags.
+ *
+ * @retval	0 if an IPv4/IPv6 header was found
+ * @retval	<0 otherwise (the parse info is still filled as far as it got)
+ */
+int pkt_parse_one(struct pkt_parse_info *info, u32 flags);
+
+/**
+ * Parse a burst of packets.
+ *
+ * @param[in,out]	info		Array of 'num' parse info entries. 'data' and 'len'
+ *					must be set by the caller.
+ * @param[in]		num		Number of packets.
+ * @param[in]		prefetch_shift	Prefetch distance, in packets. Zero disables prefetching.
+ * @param[in]		flags		PKT_PARSE_F_xxx flags.
+ *
+ * @retval	Number of IPv4/IPv6 packets in the burst
+ */
+int pkt_parse_burst(struct pkt_parse_info *info, u16 num, int prefetch_shift, u32 flags);
+
+/**
+ * Calculate the hash of a 5-tuple.
+ *
+ * The same tuple always gives the same hash, regardless of which packet
+ * or driver it came from.
+ *
+ * @param[in]	tuple	A pointer to the 5-tuple.
+ *
+ * @retval	The hash value
+ */
+u32 pkt_parse_tuple_hash(const struct pkt_5tuple *tuple);
+
+/**
+ * Parse a burst of packets received from a PPv2 port.
+ *
+ * @param[in]	descs		Array of 'num' inq descriptors returned by pp2_ppio_recv().
+ * @param[in]	num		Number of descriptors.
+ * @param[in]	high_addr	High bits of the buffers virtual address (OR-ed with the cookie).
+ * @param[in]	pkt_offset	Offset of the ethernet header in the buffer (including MH).
+ * @param[out]	info		Array of 'num' parse info entries.
+ * @param[in]	prefetch_shift	Prefetch distance, in packets.
+ * @param[in]	flags		PKT_PARSE_F_xxx flags.
+ *
+ * @retval	Number of IPv4/IPv6 packets in the burst
+ */
+int pkt_parse_pp2_burst(struct pp2_ppio_desc *descs, u16 num, uintptr_t high_addr, u16 pkt_offset,
+			struct pkt_parse_info *info, int prefetch_shift, u32 flags);
+
+/**
+ * Parse a burst of packets received from a NETA port.
+ *
+ * @param[in]	descs		Array of 'num' inq descriptors returned by neta_ppio_recv().
+ * @param[in]	num		Number of descriptors.
+ * @param[in]	high_addr	High bits of the buffers virtual address (OR-ed with the cookie).
+ * @param[in]	pkt_offset	Offset of the ethernet header in the buffer (including MH).
+ * @param[out]	info		Array of 'num' parse info entries.
+ * @param[in]	prefetch_shift	Prefetch distance, in packets.
+ * @param[in]	flags		PKT_PARSE_F_xxx flags.
+ *
+ * @retval	Number of IPv4/IPv6 packets in the burst
+ */
+int pkt_parse_neta_burst(struct neta_ppio_desc *descs, u16 num, uintptr_t high_addr, u16 pkt_offset,
+			 struct pkt_parse_info *info, int prefetch_shift, u32 flags);
+
+/**
+ * Parse a burst of packets received from a GIU GPIO port.
+ *
+ * @param[in]	descs		Array of 'num' inq descriptors returned by giu_gpio_recv().
+ * @param[in]	num		Number of descriptors.
+ * @param[in]	high_addr	High bits of the buffers virtual address (OR-ed with the cookie).
+ * @param[in]	pkt_offset	Offset of the ethernet header in the buffer.
+ * @param[out]	info		Array of 'num' parse info entries.
+ * @param[in]	prefetch_shift	Prefetch distance, in packets.
+ * @param[in]	flags		PKT_PARSE_F_xxx flags.
+ *
+ * @retval	Number of IPv4/IPv6 packets in the burst
+ */
+int pkt_parse_giu_burst(struct giu_gpio_desc *descs, u16 num, uintptr_t high_addr, u16 pkt_offset,
+			struct pkt_parse_info *info, int prefetch_shift, u32 flags);
+
+#endif /* __PKT_PARSE_H__ */
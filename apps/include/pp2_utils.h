@@ -104,6 +104,7 @@
 #include "mv_pp2_ppio.h"
 #include "mv_pp2_bpool.h"
 #include "env/spinlock.h"
+#include "lib/mv_telemetry.h"
 
 
 
@@ -150,6 +151,26 @@
 
 #define PP2_MAX_BUF_STR_LEN		MV_MAX_BUF_STR_LEN
 
+/* Tx-done buffer release modes (see free_sent_buffers()) */
+enum mvapps_pp2_buff_release {
+	MVAPPS_PP2_BUFF_RELEASE_SINGLE = 0,	/* pp2_bpool_put_buff() per buffer */
+	MVAPPS_PP2_BUFF_RELEASE_MULTI,		/* pp2_bpool_put_buffs() per contiguous shadow_q part */
+	MVAPPS_PP2_BUFF_RELEASE_BURST		/* deferred, one pp2_bpool_put_buffs() per burst */
+};
+
+/* In burst release mode, Tx-done buffers are released once at least this many are pending */
+#define MVAPPS_PP2_BUFF_RELEASE_THRESH	32
+/* Maximum number of buffers released by a single pp2_bpool_put_buffs() call in burst release mode */
+#define MVAPPS_PP2_BUFF_RELEASE_MAX_BURST	256
+
+/* BM release and Tx-done calls used by the shadow_q helpers; may be overridden by unit tests */
+#ifndef app_pp2_bpool_put_buffs
+#define app_pp2_bpool_put_buffs		pp2_bpool_put_buffs
+#endif
+#ifndef app_pp2_get_num_outq_done
+#define app_pp2_get_num_outq_done	pp2_ppio_get_num_outq_done
+#endif
+
 
 /* Macroes to handle PP2 counters */
 #define INC_RX_COUNT(lcl_port_desc, cnt)	((lcl_port_desc)->cntrs.rx_buf_cnt += cnt)
@@ -189,6 +210,7 @@ struct tx_shadow_q {
 	u16				read_ind;	/* read index */
 	u16				write_ind;	/* write index */
 	u16				send_ind;	/* send index */
+	u16				done_pending;	/* Tx-done entries not released yet (burst mode) */
 	bool				shared_q;
 	spinlock_t			read_lock;
 	spinlock_t			write_lock;
@@ -295,12 +317,25 @@ struct bpool_desc {
 };
 
 
+/*
+ * Telemetry records of a thread: per port, one per in-Q (grouped by TC) and then one per out-Q
+ */
+#define APP_TLM_PORT_RXQS	PP2_PPIO_MAX_NUM_INQS
+#define APP_TLM_PORT_RECS	(PP2_PPIO_MAX_NUM_INQS + PP2_PPIO_MAX_NUM_OUTQS)
+
+struct app_tlm_port {
+	u16			first_inq[PP2_PPIO_MAX_NUM_TCS];	/* Record of the first in-Q of each TC */
+	u32			inq_size;
+};
+
 struct pp2_lcl_common_args {
 	struct pp2_hif		*hif;
 	bool			shared_hif;
 	struct lcl_port_desc	*lcl_ports_desc;
 	struct bpool_desc	**pools_desc;
 	int			multi_buffer_release;
+	struct mv_tlm_queue	*tlm_qs;	/* Telemetry records of this thread, or NULL */
+	struct app_tlm_port	*tlm_ports;	/* Telemetry record layout of the ports */
 };
 
 struct pp2_app_hif {
@@ -325,6 +360,8 @@ struct pp2_glb_common_args {
 	int			multi_buffer_release;
 	struct pp2_app_hif	*app_hif[MVAPPS_PP2_TOTAL_NUM_HIFS]; /* hifs for all local_threads */
 	struct bpool_inf_set	*bpool_set[PP2_APP_NUM_BPOOL_SETS];
+	struct mv_tlm		*tlm;	/* Telemetry segment, or NULL if disabled */
+	struct app_tlm_port	tlm_ports[MVAPPS_PP2_MAX_NUM_PORTS];
 };
 
 
@@ -348,6 +385,33 @@ static inline enum pp2_outq_l4_type pp2_l4_type_inq_to_outq(enum pp2_inq_l4_type
 }
 
 
+/*
+ * Get the telemetry record of a thread's in-Q or out-Q on a port.
+ * Records are registered on first use, as the queues a thread serves are only known
+ * once it runs its flows.
+ */
+static inline struct mv_tlm_queue *app_tlm_rxq_get(struct local_common_args *larg_cmn, u8 port, u8 tc, u8 qid)
+{
+	struct pp2_lcl_common_args *pp2_args = (struct pp2_lcl_common_args *)larg_cmn->plat;
+	struct app_tlm_port *tlm_port = &pp2_args->tlm_ports[port];
+	struct mv_tlm_queue *q = &pp2_args->tlm_qs[port * APP_TLM_PORT_RECS + tlm_port->first_inq[tc] + qid];
+
+	if (unlikely(!q->in_use))
+		mv_tlm_queue_register(q, MV_TLM_Q_DIR_RX, port, tc, qid, larg_cmn->id, tlm_port->inq_size);
+	return q;
+}
+
+/* Out-Qs are the egress traffic classes, so an out-Q record has tc == qid */
+static inline struct mv_tlm_queue *app_tlm_txq_get(struct local_common_args *larg_cmn, u8 port, u8 qid, u32 size)
+{
+	struct pp2_lcl_common_args *pp2_args = (struct pp2_lcl_common_args *)larg_cmn->plat;
+	struct mv_tlm_queue *q = &pp2_args->tlm_qs[port * APP_TLM_PORT_RECS + APP_TLM_PORT_RXQS + qid];
+
+	if (unlikely(!q->in_use))
+		mv_tlm_queue_register(q, MV_TLM_Q_DIR_TX, port, qid, qid, larg_cmn->id, size);
+	return q;
+}
+
 #ifndef HW_BUFF_RECYLCE
 static inline u16 free_buffers(struct lcl_port_desc	*rx_port,
 			       struct lcl_port_desc	*tx_port,
@@ -399,16 +463,16 @@ static inline u16 free_multi_buffers(struct lcl_port_desc	*rx_port,
 
 	if (num <= cont_in_shadow) {
 		req_num = num;
-		pp2_bpool_put_buffs(hif, (struct buff_release_entry *)&shadow_q->ents[idx], &req_num);
+		app_pp2_bpool_put_buffs(hif, (struct buff_release_entry *)&shadow_q->ents[idx], &req_num);
 		idx = idx + num;
 		if (idx == tx_port->shadow_q_size)
 			idx = 0;
 	} else {
 		req_num = cont_in_shadow;
-		pp2_bpool_put_buffs(hif, (struct buff_release_entry *)&shadow_q->ents[idx], &req_num);
+		app_pp2_bpool_put_buffs(hif, (struct buff_release_entry *)&shadow_q->ents[idx], &req_num);
 
 		req_num = num - cont_in_shadow;
-		pp2_bpool_put_buffs(hif, (struct buff_release_entry *)&shadow_q->ents[0], &req_num);
+		app_pp2_bpool_put_buffs(hif, (struct buff_release_entry *)&shadow_q->ents[0], &req_num);
 		idx = num - cont_in_shadow;
 	}
 
@@ -417,6 +481,47 @@ static inline u16 free_multi_buffers(struct lcl_port_desc	*rx_port,
 	return idx;
 }
 
+/*
+ * Release 'num' shadow_q entries starting at 'start_idx' with as few pp2_bpool_put_buffs() calls as
+ * possible: a contiguous range is released in place, and a range that wraps around the end of the
+ * shadow_q is gathered into one array first. Entries may belong to different bpools (and PP2
+ * instances); pp2_bpool_put_buffs() sorts them out.
+ */
+static inline u16 free_burst_buffers(struct lcl_port_desc	*rx_port,
+				     struct lcl_port_desc	*tx_port,
+				     struct pp2_hif		*hif,
+				     u16			 start_idx,
+				     u16			 num,
+				     u8				 tc)
+{
+	struct buff_release_entry	rel[MVAPPS_PP2_BUFF_RELEASE_MAX_BURST];
+	struct tx_shadow_q		*shadow_q = &tx_port->shadow_qs[tc];
+	u16				idx = start_idx, left = num, cnt, req_num;
+
+	while (left) {
+		cnt = min_t(u16, left, MVAPPS_PP2_BUFF_RELEASE_MAX_BURST);
+		req_num = cnt;
+		if (idx + cnt <= tx_port->shadow_q_size) {
+			app_pp2_bpool_put_buffs(hif, (struct buff_release_entry *)&shadow_q->ents[idx], &req_num);
+		} else {
+			u16 cont_in_shadow = tx_port->shadow_q_size - idx;
+
+			memcpy(rel, &shadow_q->ents[idx], cont_in_shadow * sizeof(struct buff_release_entry));
+			memcpy(&rel[cont_in_shadow], &shadow_q->ents[0],
+			       (cnt - cont_in_shadow) * sizeof(struct buff_release_entry));
+			app_pp2_bpool_put_buffs(hif, rel, &req_num);
+		}
+		idx += cnt;
+		if (idx >= tx_port->shadow_q_size)
+			idx -= tx_port->shadow_q_size;
+		left -= cnt;
+	}
+
+	INC_FREE_COUNT(rx_port, num);
+
+	return idx;
+}
+
 static inline void free_sent_buffers(struct lcl_port_desc	*rx_port,
 				     struct lcl_port_desc	*tx_port,
 				     struct pp2_hif		*hif,
@@ -430,12 +535,21 @@ static inline void free_sent_buffers(struct lcl_port_desc	*rx_port,
 	if (shadow_q->shared_q && !spin_trylock(&shadow_q->read_lock))
 		return;
 
-	pp2_ppio_get_num_outq_done(tx_port->ppio, hif, tc, &tx_num);
+	app_pp2_get_num_outq_done(tx_port->ppio, hif, tc, &tx_num);
 
-	if (multi_buffer_release)
+	if (multi_buffer_release == MVAPPS_PP2_BUFF_RELEASE_BURST) {
+		/* the Tx-done counter is cleared on read, so keep the count until there is enough to release */
+		shadow_q->done_pending += tx_num;
+		if (shadow_q->done_pending >= MVAPPS_PP2_BUFF_RELEASE_THRESH) {
+			shadow_q->read_ind = free_burst_buffers(rx_port, tx_port, hif, shadow_q->read_ind,
+								shadow_q->done_pending, tc);
+			shadow_q->done_pending = 0;
+		}
+	} else if (multi_buffer_release) {
 		shadow_q->read_ind = free_multi_buffers(rx_port, tx_port, hif, shadow_q->read_ind, tx_num, tc);
-	else
+	} else {
 		shadow_q->read_ind = free_buffers(rx_port, tx_port, hif, shadow_q->read_ind, tx_num, tc);
+	}
 
 	if (shadow_q->shared_q)
 		spin_unlock(&shadow_q->read_lock);
@@ -460,6 +574,7 @@ static inline int loop_sw_recycle(struct local_common_args *larg_cmn,
 	struct lcl_port_desc	*tx_lcl_port_desc = &(pp2_args->lcl_ports_desc[tx_ppio_id]);
 	u16			i, tx_num, write_ind, write_start_ind, read_ind;
 	int			mycyc, max_write;
+	u32			rx_bytes = 0;
 #ifdef APP_TX_RETRY
 	u16			desc_idx = 0, cnt = 0;
 	int			orig_num;
@@ -522,6 +637,8 @@ static inline int loop_sw_recycle(struct local_common_args *larg_cmn,
 		u16 len = pp2_ppio_inq_desc_get_pkt_len(&descs[i]);
 		struct pp2_bpool *bpool = pp2_ppio_inq_desc_get_bpool(&descs[i], rx_lcl_port_desc->ppio);
 
+		rx_bytes += len;
+
 #ifdef APP_PKT_ECHO_SUPPORT
 		if (likely(larg_cmn->echo)) {
 			char *tmp_buff;
@@ -572,6 +689,9 @@ static inline int loop_sw_recycle(struct local_common_args *larg_cmn,
 	}
 	SET_MAX_BURST(rx_lcl_port_desc, num);
 
+	if (pp2_args->tlm_qs && num)
+		mv_tlm_queue_inc(app_tlm_rxq_get(larg_cmn, rx_ppio_id, tc, tc_qid), num, rx_bytes);
+
 	for (mycyc = 0; mycyc < larg_cmn->busy_wait; mycyc++)
 		asm volatile("");
 
@@ -614,9 +734,22 @@ static inline int loop_sw_recycle(struct local_common_args *larg_cmn,
 	free_sent_buffers(rx_lcl_port_desc, tx_lcl_port_desc, pp2_args->hif,
 			  tx_qid, pp2_args->multi_buffer_release);
 
+	if (pp2_args->tlm_qs) {
+		struct mv_tlm_queue *tx_tlm = app_tlm_txq_get(larg_cmn, tx_ppio_id, tx_qid, shadow_q_size);
+
+		if (orig_num)
+			mv_tlm_queue_inc(tx_tlm, orig_num, rx_bytes);
+		mv_tlm_queue_set_occupancy(tx_tlm, (shadow_q->write_ind - shadow_q->read_ind +
+					   shadow_q_size) % shadow_q_size);
+	}
+
 	SET_MAX_RESENT(rx_lcl_port_desc, cnt);
 #else
 	if (num) {
+		struct mv_tlm_queue *tx_tlm = NULL;
+
+		if (pp2_args->tlm_qs)
+			tx_tlm = app_tlm_txq_get(larg_cmn, tx_ppio_id, tx_qid, shadow_q_size);
 		if (shadow_q->shared_q)
 			spin_lock(&shadow_q->send_lock);
 		tx_num = num;
@@ -629,7 +762,10 @@ static inline int loop_sw_recycle(struct local_common_args *larg_cmn,
 			shadow_q->write_ind = (shadow_q->write_ind < not_sent) ?
 						(shadow_q_size - not_sent + shadow_q->write_ind) :
 						shadow_q->write_ind - not_sent;
-			if (pp2_args->multi_buffer_release)
+			if (pp2_args->multi_buffer_release == MVAPPS_PP2_BUFF_RELEASE_BURST)
+				free_burst_buffers(rx_lcl_port_desc, tx_lcl_port_desc,
+						   pp2_args->hif, shadow_q->write_ind, not_sent, tx_qid);
+			else if (pp2_args->multi_buffer_release)
 				free_multi_buffers(rx_lcl_port_desc, tx_lcl_port_desc,
 						   pp2_args->hif, write_ind, not_sent, tx_qid);
 			else
@@ -638,9 +774,16 @@ static inline int loop_sw_recycle(struct local_common_args *larg_cmn,
 
 			INC_TX_DROP_COUNT(rx_lcl_port_desc, not_sent);
 			perf_cntrs->drop_cnt += not_sent;
+			if (tx_tlm) {
+				mv_tlm_queue_inc_drops(tx_tlm, not_sent);
+				for (i = tx_num; i < num; i++)
+					rx_bytes -= pp2_ppio_outq_desc_get_pkt_len(&descs[i]);
+			}
 		}
 		INC_TX_COUNT(rx_lcl_port_desc, tx_num);
 		perf_cntrs->tx_cnt += tx_num;
+		if (tx_tlm)
+			mv_tlm_queue_inc(tx_tlm, tx_num, rx_bytes);
 	}
 
 	/* Unlock only after shadow_q->write_ind has been finalized, and buffers have been free */
@@ -649,6 +792,11 @@ static inline int loop_sw_recycle(struct local_common_args *larg_cmn,
 
 	free_sent_buffers(rx_lcl_port_desc, tx_lcl_port_desc, pp2_args->hif,
 			  tx_qid, pp2_args->multi_buffer_release);
+
+	if (pp2_args->tlm_qs)
+		mv_tlm_queue_set_occupancy(app_tlm_txq_get(larg_cmn, tx_ppio_id, tx_qid, shadow_q_size),
+					   (shadow_q->write_ind - shadow_q->read_ind + shadow_q_size) %
+					   shadow_q_size);
 #endif /* APP_TX_RETRY */
 
 	return 0;
@@ -793,6 +941,15 @@ void apps_pp2_deinit_global(void *arg);
 
 int apps_pp2_stat_cmd_cb(void *arg, int argc, char *argv[]);
 
+/*
+ * Telemetry: create the shared-memory segment (rx/tx records per thread and port, one record
+ * per bpool), attach a local thread to it, refresh the bpool fill levels and destroy it.
+ */
+int app_tlm_init(struct glb_common_args *glb_args, const char *name);
+void app_tlm_local_init(struct glb_common_args *glb_args, int id, struct pp2_lcl_common_args *lcl_pp2_args);
+void app_tlm_update(struct glb_common_args *glb_args);
+void app_tlm_deinit(struct glb_common_args *glb_args);
+
 int find_free_bpool(u32 pp_id);
 
 int find_free_hif(void);
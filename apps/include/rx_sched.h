@@ -0,0 +1,260 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#ifndef __RX_SCHED_H__
+#define __RX_SCHED_H__
+
+#include "mv_std.h"
+#include "drivers/mv_pp2_ppio.h"
+#include "drivers/mv_neta_ppio.h"
+#include "drivers/mv_giu_gpio.h"
+
+/*
+ * Multi-queue RX polling scheduler.
+ *
+ * A data path thread that serves several inqueues registers them as sources
+ * and calls rx_sched_recv() instead of walking them in a fixed loop. Every
+ * call visits the sources round-robin and returns the first non-empty burst.
+ * Each source adapts to its own occupancy:
+ *	- Poll interval: a source that returned nothing is skipped on the next
+ *	  1, 3, 7, ... visits (the interval doubles up to 'max_interval' visits),
+ *	  so idle queues cost a counter decrement instead of a descriptor read.
+ *	  The first packet of a source resets it to be polled on every visit.
+ *	- Burst size: a poll that returned a full burst doubles the burst of the
+ *	  source (up to 'max_burst'), so a backlogged queue is drained in fewer
+ *	  visits. The burst is halved again (down to 'min_burst') once both the
+ *	  last poll and the average poll fill drop below a quarter of it.
+ *
+ * The latency added to a queue that wakes up is bounded by 'max_interval'
+ * visits of the scheduler.
+ *
+ * Sources are polled through a receive callback, so any driver can be used;
+ * rx_sched_{pp2,neta,giu}_recv() are provided for the MUSDK drivers, with the
+ * port handle (ppio/gpio) as the callback port.
+ *
+ * Usage:
+ *	for (;;) {
+ *		i = rx_sched_recv(sched, descs, &num);
+ *		if (i < 0)
+ *			continue;
+ *		<process 'num' descriptors received from source 'i'>
+ *	}
+ */
+
+/* Default maximum poll interval of an idle source, in scheduler visits */
+#define RX_SCHED_DEF_MAX_INTERVAL	16
+/* Default minimal burst of a source */
+#define RX_SCHED_DEF_MIN_BURST		4
+
+/**
+ * Receive callback of a source
+ *
+ * @param[in]		port	Source port handle.
+ * @param[in]		tc	Source traffic class.
+ * @param[in]		qid	Source queue id.
+ * @param[out]		descs	Array of (at least) 'num' descriptors of the source driver.
+ * @param[in,out]	num	Input: maximum number of descriptors; output: number received.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+typedef int (*rx_sched_recv_f)(void *port, u8 tc, u8 qid, void *descs, u16 *num);
+
+struct rx_sched_params {
+	u16	max_srcs;	/* Maximum number of sources */
+	u16	max_interval;	/* Maximum poll interval of an idle source; 0 - default */
+};
+
+struct rx_sched_src_params {
+	rx_sched_recv_f	 recv;		/* Receive callback; mandatory */
+	void		*port;		/* Port handle passed to the callback */
+	u8		 tc;
+	u8		 qid;
+	u16		 min_burst;	/* 0 - default (or 'max_burst' if lower) */
+	u16		 max_burst;	/* Maximum burst; mandatory */
+};
+
+struct rx_sched_src_stats {
+	u64	polls;		/* Calls to the receive callback */
+	u64	empty_polls;	/* Polls that returned no packets */
+	u64	full_polls;	/* Polls that returned a full burst */
+	u64	skips;		/* Visits skipped as the source was idle */
+	u64	pkts;		/* Packets received */
+	u16	burst;		/* Current burst */
+	u16	interval;	/* Current poll interval */
+};
+
+struct rx_sched;
+
+/**
+ * Create a polling scheduler
+ *
+ * @param[in]	params	Scheduler parameters.
+ * @param[out]	sched	Address of place to save the scheduler handle.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int rx_sched_create(struct rx_sched_params *params, struct rx_sched **sched);
+
+/**
+ * Destroy a polling scheduler
+ *
+ * @param[in]	sched	Scheduler handle.
+ */
+void rx_sched_destroy(struct rx_sched *sched);
+
+/**
+ * Add a source to a polling scheduler
+ *
+ * The source starts at its maximum burst and is polled on every visit.
+ *
+ * @param[in]	sched	Scheduler handle.
+ * @param[in]	params	Source parameters.
+ *
+ * @retval	>=0 index of the source
+ * @retval	<0 on failure
+ */
+int rx_sched_add_src(struct rx_sched *sched, struct rx_sched_src_params *params);
+
+/**
+ * Receive the next burst
+ *
+ * Visits the sources, starting after the one visited last, until one of them
+ * returns packets, or each of them was visited once.
+ *
+ * @param[in]		sched	Scheduler handle.
+ * @param[out]		descs	Array of descriptors, large enough for the 'max_burst'
+ *				of any source (of the driver of that source).
+ * @param[out]		num	Number of received descriptors.
+ *
+ * @retval	>=0 index of the source the descriptors were received from
+ * @retval	-EAGAIN if no source had packets
+ * @retval	<0 on receive failure (of the source visited last)
+ */
+int rx_sched_recv(struct rx_sched *sched, void *descs, u16 *num);
+
+/**
+ * Get the statistics of a source
+ *
+ * @param[in]	sched	Scheduler handle.
+ * @param[in]	src	Source index.
+ * @param[out]	stats	Statistics.
+ * @param[in]	reset	1 - reset the counters after reading.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int rx_sched_get_src_stats(struct rx_sched *sched, int src, struct rx_sched_src_stats *stats, int reset);
+
+/* Receive callbacks of the MUSDK drivers */
+static inline int rx_sched_pp2_recv(void *port, u8 tc, u8 qid, void *descs, u16 *num)
+{
+	return pp2_ppio_recv((struct pp2_ppio *)port, tc, qid, (struct pp2_ppio_desc *)descs, num);
+}
+
+/* NETA has no traffic classes; 'tc' is ignored */
+static inline int rx_sched_neta_recv(void *port, u8 tc, u8 qid, void *descs, u16 *num)
+{
+	return neta_ppio_recv((struct neta_ppio *)port, qid, (struct neta_ppio_desc *)descs, num);
+}
+
+static inline int rx_sched_giu_recv(void *port, u8 tc, u8 qid, void *descs, u16 *num)
+{
+	return giu_gpio_recv((struct giu_gpio *)port, tc, qid, (struct giu_gpio_desc *)descs, num);
+}
+
+#endif /* __RX_SCHED_H__ */
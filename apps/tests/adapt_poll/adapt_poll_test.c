@@ -0,0 +1,311 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mv_std.h"
+#include "lib/mv_adapt_poll.h"
+
+/* Simulated queue and poller */
+#define SIM_QSIZE		512
+#define SIM_BURST		32
+#define SIM_POLL_NS		100	/* cost of an empty poll */
+#define SIM_PKT_NS		20	/* extra cost per received packet */
+#define SIM_WAKEUP_NS		5000	/* interrupt to thread wakeup latency */
+#define SIM_USEC_COAL		100
+
+struct sim_phase {
+	const char	*name;
+	u32		 ms;
+	u32		 pps;
+	u32		 max_cpu_pct;	/* max allowed CPU load */
+	int		 may_sleep;
+};
+
+static struct sim_phase sim_phases[] = {
+	{"idle",     20,       0,   2, 1},
+	{"low",      20,    2000,  10, 1},
+	{"high",     20, 2000000, 100, 0},
+	{"medium",   20,  100000,  40, 1},
+	{"idle",     20,       0,   2, 1},
+};
+
+struct sim {
+	u64	now;
+	u64	next_arrival;
+	u64	arrivals[SIM_QSIZE];	/* arrival times of the queued packets */
+	u32	head;
+	u32	tail;
+	int	armed;
+	u32	pkt_coal;
+	u32	usec_coal;
+	/* per phase results */
+	u64	busy_ns;
+	u64	drops;
+	u64	max_lat_ns;
+	u64	pkts;
+	u64	sleeps;
+};
+
+static int sim_set_event(void *arg, struct mv_sys_event *ev, int en)
+{
+	struct sim *sim = arg;
+
+	sim->armed = en;
+	return 0;
+}
+
+static int sim_set_coal(void *arg, u32 pkt_coal, u32 usec_coal)
+{
+	struct sim *sim = arg;
+
+	sim->pkt_coal = pkt_coal;
+	sim->usec_coal = usec_coal;
+	return 0;
+}
+
+/* Generate the arrivals up to the current time */
+static void sim_arrivals(struct sim *sim, u32 pps)
+{
+	u64 gap;
+
+	if (!pps) {
+		sim->next_arrival = ~0ULL;
+		return;
+	}
+	gap = 1000000000ULL / pps;
+	if (sim->next_arrival == ~0ULL)
+		sim->next_arrival = sim->now + gap;
+	while (sim->next_arrival <= sim->now) {
+		if (sim->tail - sim->head == SIM_QSIZE)
+			sim->drops++;
+		else
+			sim->arrivals[sim->tail++ % SIM_QSIZE] = sim->next_arrival;
+		/* +-50% jitter */
+		sim->next_arrival += gap / 2 + rand() % (gap + 1);
+	}
+}
+
+static u32 sim_poll(struct sim *sim)
+{
+	u32 n = 0;
+	u64 lat;
+
+	while (n < SIM_BURST && sim->head != sim->tail) {
+		lat = sim->now - sim->arrivals[sim->head++ % SIM_QSIZE];
+		if (lat > sim->max_lat_ns)
+			sim->max_lat_ns = lat;
+		n++;
+	}
+	sim->pkts += n;
+	return n;
+}
+
+/* Advance time while sleeping until the (coalesced) interrupt fires */
+static void sim_sleep(struct sim *sim, u32 pps, u64 end)
+{
+	u64 fire;
+
+	for (;;) {
+		if (sim->tail - sim->head >= sim->pkt_coal) {
+			fire = sim->now;
+			break;
+		}
+		if (sim->head != sim->tail) {
+			fire = sim->arrivals[sim->head % SIM_QSIZE] + sim->usec_coal * 1000ULL;
+			if (fire <= sim->next_arrival)
+				break;
+		}
+		if (sim->next_arrival >= end) {
+			/* wait timeout at the end of the phase */
+			sim->now = end;
+			return;
+		}
+		sim->now = sim->next_arrival;
+		sim_arrivals(sim, pps);
+	}
+	if (fire > sim->now)
+		sim->now = fire;
+	sim->now += SIM_WAKEUP_NS;
+	sim_arrivals(sim, pps);
+}
+
+static int sim_run(void)
+{
+	struct mv_apoll_params params;
+	struct mv_apoll *ap;
+	struct mv_apoll_stats stats;
+	struct sim sim;
+	struct sim_phase *ph;
+	u64 end, start, cost, lat_bound;
+	u32 n, cpu_pct;
+	int i, err = 0;
+
+	memset(&sim, 0, sizeof(sim));
+	sim.next_arrival = ~0ULL;
+	memset(&params, 0, sizeof(params));
+	params.arg = &sim;
+	params.set_event = sim_set_event;
+	params.set_coal = sim_set_coal;
+		params.max_usec_coal = SIM_USEC_COAL;
+	if (mv_apoll_create(&params, &ap)) {
+		printf("create failed\n");
+		return -1;
+	}
+
+	printf("%-8s %9s %8s %8s %10s %8s %8s\n", "phase", "pps", "cpu %", "drops", "max lat us", "sleeps", "pkt coal");
+	for (i = 0; i < ARRAY_SIZE(sim_phases); i++) {
+		ph = &sim_phases[i];
+		start = sim.now;
+		end = start + ph->ms * 1000000ULL;
+		sim.busy_ns = sim.drops = sim.max_lat_ns = sim.pkts = 0;
+		mv_apoll_get_stats(ap, &stats, 1);
+		sim.next_arrival = ~0ULL;
+
+		while (sim.now < end) {
+			sim_arrivals(&sim, ph->pps);
+			n = sim_poll(&sim);
+			cost = SIM_POLL_NS + n * SIM_PKT_NS;
+			sim.now += cost;
+			sim.busy_ns += cost;
+			mv_apoll_update(ap, n, sim.now);
+			if (mv_apoll_should_sleep(&ap, 1)) {
+				mv_apoll_arm(&ap, 1, sim.now);
+				sim_sleep(&sim, ph->pps, end);
+				mv_apoll_disarm(&ap, 1, sim.now);
+			}
+		}
+		mv_apoll_get_stats(ap, &stats, 0);
+		cpu_pct = sim.busy_ns * 100 / (sim.now - start);
+		printf("%-8s %9u %8u %8llu %10llu %8llu %8u\n", ph->name, ph->pps, cpu_pct,
+		       (unsigned long long)sim.drops, (unsigned long long)sim.max_lat_ns / 1000,
+		       (unsigned long long)stats.sleeps, sim.pkt_coal);
+
+		/* a sleeping queue is served within the coalescing time plus the
+		 * wakeup; a polled one within a few polls of a full ring
+		 */
+		lat_bound = (SIM_USEC_COAL * 1000ULL + SIM_WAKEUP_NS) * 2;
+		if (sim.drops || cpu_pct > ph->max_cpu_pct || sim.max_lat_ns > lat_bound ||
+		    (!ph->may_sleep && stats.sleeps) || (ph->pps && !sim.pkts)) {
+			printf("phase %s failed\n", ph->name);
+			err = -1;
+		}
+		if (!ph->may_sleep && mv_apoll_get_mode(ap) != MV_APOLL_MODE_BUSY) {
+			printf("phase %s did not reach BUSY mode\n", ph->name);
+			err = -1;
+		}
+	}
+	mv_apoll_destroy(ap);
+	return err;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int seed = (argc > 1) ? atoi(argv[1]) : 1;
+
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	printf("Adaptive interrupt/poll simulation (seed %u):\n", seed);
+	srand(seed);
+
+	if (sim_run()) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
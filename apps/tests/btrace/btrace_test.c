@@ -0,0 +1,217 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "mv_std.h"
+#include "env/mv_btrace.h"
+
+#define BT_RING_SIZE		64
+#define BT_NUM_RECS		10
+#define BT_CAT			MV_BTRC_CAT_SAM
+#define BT_DUMP_FILE		"/tmp/musdk_btrace_test.bin"
+
+#define BT_CHECK(cond, ...)			\
+	do {					\
+		if (!(cond)) {			\
+			printf(__VA_ARGS__);	\
+			return -1;		\
+		}				\
+	} while (0)
+
+static int bt_step;
+
+static void bt_wait_step(int step)
+{
+	while (__atomic_load_n(&bt_step, __ATOMIC_ACQUIRE) != step)
+		usleep(100);
+}
+
+static void bt_set_step(int step)
+{
+	__atomic_store_n(&bt_step, step, __ATOMIC_RELEASE);
+}
+
+/* Records a burst, waits for a deinit/init cycle, then records another one
+ * through the ring pointer it cached in the first burst.
+ */
+static void *bt_thread(void *arg)
+{
+	int i;
+
+	for (i = 0; i < BT_NUM_RECS; i++)
+		mv_btrc_record(BT_CAT, MV_BTRC_ID_SAM_ENQ_START, i, 0, 0, 0);
+	bt_set_step(1);
+
+	bt_wait_step(2);
+	for (i = 0; i < BT_NUM_RECS; i++)
+		mv_btrc_record(BT_CAT, MV_BTRC_ID_SAM_ENQ_END, i, 0, 0, 0);
+	bt_set_step(3);
+	return NULL;
+}
+
+/* Check a dump holds a single ring with BT_NUM_RECS records of tracepoint 'id' */
+static int bt_check_dump(u16 id)
+{
+	struct mv_btrc_file_hdr hdr;
+	struct mv_btrc_ring_hdr rhdr;
+	struct mv_btrc_rec rec;
+	FILE *f;
+	u32 i;
+
+	f = fopen(BT_DUMP_FILE, "r");
+	BT_CHECK(f, "failed to open %s\n", BT_DUMP_FILE);
+	if (fread(&hdr, sizeof(hdr), 1, f) != 1 || hdr.magic != MV_BTRC_MAGIC || hdr.num_rings != 1 ||
+	    fseek(f, hdr.num_tps * sizeof(struct mv_btrc_tp), SEEK_CUR) ||
+	    fread(&rhdr, sizeof(rhdr), 1, f) != 1 || rhdr.num_recs != BT_NUM_RECS) {
+		fclose(f);
+		printf("unexpected dump layout\n");
+		return -1;
+	}
+	for (i = 0; i < rhdr.num_recs; i++)
+		if (fread(&rec, sizeof(rec), 1, f) != 1 || rec.id != id || rec.args[0] != i) {
+			fclose(f);
+			printf("unexpected record %u\n", i);
+			return -1;
+		}
+	fclose(f);
+	return 0;
+}
+
+static int test_reinit(void)
+{
+	pthread_t thread;
+
+	printf("  deinit/init with a cached ring\n");
+	BT_CHECK(!mv_btrc_init(BT_RING_SIZE), "init failed\n");
+	mv_btrc_enable(BIT(BT_CAT), 1);
+	BT_CHECK(!pthread_create(&thread, NULL, bt_thread, NULL), "failed to create thread\n");
+
+	bt_wait_step(1);
+	BT_CHECK(!mv_btrc_dump(BT_DUMP_FILE), "first dump failed\n");
+	BT_CHECK(!bt_check_dump(MV_BTRC_ID_SAM_ENQ_START), "first dump mismatch\n");
+	mv_btrc_deinit();
+
+	/* the thread must attach a new ring, not write into the freed one */
+	BT_CHECK(!mv_btrc_init(BT_RING_SIZE), "re-init failed\n");
+	mv_btrc_enable(BIT(BT_CAT), 1);
+	bt_set_step(2);
+	bt_wait_step(3);
+	pthread_join(thread, NULL);
+
+	BT_CHECK(!mv_btrc_dump(BT_DUMP_FILE), "second dump failed\n");
+	BT_CHECK(!bt_check_dump(MV_BTRC_ID_SAM_ENQ_END), "second dump mismatch\n");
+	mv_btrc_deinit();
+	unlink(BT_DUMP_FILE);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+
+	if (test_reinit()) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
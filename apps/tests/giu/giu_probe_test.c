@@ -0,0 +1,418 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+/*
+ * GIU guest probe test: builds the probe string of a giu bpool and a gpio
+ * exactly as giu_bpool_serialize()/giu_gpio_serialize() write it - in the
+ * current layout and in the one of older NMP versions (in-queues without an
+ * "inq-x" section) - probes both objects from it, and checks that the probed
+ * queues use the advertised rings through the guest datapath.
+ *
+ * The serializers themselves need a GIU/GIE instance (NMP on the target), so
+ * the NMP side of the round trip is written here.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mv_std.h"
+#include "env/mv_sys_dma.h"
+#include "env/sys_iomem.h"
+#include "lib/lib_misc.h"
+#include "mv_giu_bpool.h"
+#include "mv_giu_gpio.h"
+
+#define TEST_DMA_SIZE		(4 * 1024 * 1024)
+#define TEST_POOL_MATCH		"giu_pool-0:2"
+#define TEST_GPIO_MATCH		"gpio-0:1"
+#define TEST_GIU_ID		0
+#define TEST_POOL_ID		2
+#define TEST_GPIO_ID		1
+#define TEST_NUM_INQS		2
+#define TEST_NUM_OUTQS		2
+#define TEST_NUM_QS		(1 + TEST_NUM_INQS + TEST_NUM_OUTQS)	/* bpool queue first */
+#define TEST_Q_LEN		32
+#define TEST_PKT_OFFS		64
+#define TEST_BUFF_LEN		2048
+#define TEST_NUM_DESCS		3
+#define TEST_SER_SIZE		(8 * 1024)
+
+#define GIU_CHECK(cond, msg)						\
+	do {								\
+		if (!(cond)) {						\
+			pr_err("%s: %s\n", __func__, msg);		\
+			return -1;					\
+		}							\
+	} while (0)
+
+struct test_q {
+	u32	qid;
+	u32	base_offs;
+	u32	prod_offs;
+	u32	cons_offs;
+};
+
+static struct test_q		 qs[TEST_NUM_QS];
+static struct mv_sys_dma_mem_info mem_info;
+static char			 dev_name[100];
+static void			*rings;
+static struct sys_iomem		*iomem;
+static u8			*shm_va;
+static char			 prb_str[TEST_SER_SIZE];
+
+static int test_init(void)
+{
+	struct sys_iomem_params iomem_params;
+	size_t ring_size = TEST_Q_LEN * sizeof(struct giu_gpio_desc);
+	phys_addr_t paddr, rings_pa;
+	void *va;
+	int i;
+
+	mem_info.name = dev_name;
+	GIU_CHECK(!mv_sys_dma_mem_get_info(&mem_info), "mv_sys_dma_mem_get_info failed");
+
+	/* The queues as NMP lays them out: rings, then the prod/cons indices */
+	rings = mv_sys_dma_mem_alloc(TEST_NUM_QS * (ring_size + 2 * sizeof(u32)), 64);
+	GIU_CHECK(rings, "no mem for rings");
+	rings_pa = mv_sys_dma_mem_virt2phys(rings);
+	for (i = 0; i < TEST_NUM_QS; i++) {
+		qs[i].qid = 10 + i;
+		qs[i].base_offs = rings_pa - mem_info.paddr + i * ring_size;
+		qs[i].prod_offs = rings_pa - mem_info.paddr + TEST_NUM_QS * ring_size + 2 * i * sizeof(u32);
+		qs[i].cons_offs = qs[i].prod_offs + sizeof(u32);
+	}
+
+	/* Map the DMA memory the way nmp_guest_probe does */
+	memset(&iomem_params, 0, sizeof(iomem_params));
+	iomem_params.type = SYS_IOMEM_T_SHMEM;
+	iomem_params.devname = dev_name;
+	iomem_params.index = 1;
+	iomem_params.size = mem_info.size;
+	GIU_CHECK(!sys_iomem_init(&iomem_params, &iomem), "sys_iomem_init failed");
+	paddr = mem_info.paddr;
+	GIU_CHECK(!sys_iomem_map(iomem, NULL, &paddr, &va), "sys_iomem_map failed");
+	shm_va = va;
+
+	printf("  ok\n");
+	return 0;
+}
+
+static void test_serialize_queue(char *buff, u32 size, size_t *ppos, u8 depth, struct test_q *q)
+{
+	size_t pos = *ppos;
+
+	json_print_to_buffer(buff, size, depth, "\"qid\": %u,\n", q->qid);
+	json_print_to_buffer(buff, size, depth, "\"qlen\": %u,\n", TEST_Q_LEN);
+	json_print_to_buffer(buff, size, depth, "\"phy_base_offset\": %#x,\n", q->base_offs);
+	json_print_to_buffer(buff, size, depth, "\"prod_offset\": %#x,\n", q->prod_offs);
+	json_print_to_buffer(buff, size, depth, "\"cons_offset\": %#x,\n", q->cons_offs);
+	*ppos = pos;
+}
+
+/* The objects section of a probe string, as written by nmnicpf_serialize_giu() */
+static void test_serialize(char *buff, u32 size, int legacy)
+{
+	size_t pos = 0;
+	u8 depth = 1;
+	int i;
+
+	memset(buff, 0, size);
+
+	json_print_to_buffer(buff, size, depth, "\"giu-bpools\": {\n");
+	json_print_to_buffer(buff, size, depth + 1, "\"giu_pool-%d:%d\": {\n", TEST_GIU_ID, TEST_POOL_ID);
+	json_print_to_buffer(buff, size, depth + 2, "\"giu_id\": %d,\n", TEST_GIU_ID);
+	json_print_to_buffer(buff, size, depth + 2, "\"id\": %d,\n", TEST_POOL_ID);
+	json_print_to_buffer(buff, size, depth + 2, "\"dma_dev_name\": \"%s\",\n", mem_info.name);
+	json_print_to_buffer(buff, size, depth + 2, "\"num_buffs\": %u,\n", TEST_Q_LEN);
+	json_print_to_buffer(buff, size, depth + 2, "\"buff_len\": %u,\n", TEST_BUFF_LEN);
+	json_print_to_buffer(buff, size, depth + 2, "\"phy_base_offset\": %#x,\n", qs[0].base_offs);
+	json_print_to_buffer(buff, size, depth + 2, "\"prod_offset\": %#x,\n", qs[0].prod_offs);
+	json_print_to_buffer(buff, size, depth + 2, "\"cons_offset\": %#x,\n", qs[0].cons_offs);
+	json_print_to_buffer(buff, size, depth + 1, "},\n");
+	json_print_to_buffer(buff, size, depth, "},\n");
+
+	json_print_to_buffer(buff, size, depth, "\"giu-gpio\": {\n");
+	json_print_to_buffer(buff, size, depth + 1, "\"gpio-%d:%d\": {\n", TEST_GIU_ID, TEST_GPIO_ID);
+	json_print_to_buffer(buff, size, depth + 2, "\"giu_id\": %d,\n", TEST_GIU_ID);
+	json_print_to_buffer(buff, size, depth + 2, "\"id\": %d,\n", TEST_GPIO_ID);
+	json_print_to_buffer(buff, size, depth + 2, "\"sg_en\": %d,\n", 0);
+	json_print_to_buffer(buff, size, depth + 2, "\"dma_dev_name\": \"%s\",\n", mem_info.name);
+	json_print_to_buffer(buff, size, depth + 2, "\"num_intcs\": %u,\n", 1);
+	json_print_to_buffer(buff, size, depth + 2, "\"intc-%u\": {\n", 0);
+	json_print_to_buffer(buff, size, depth + 3, "\"pkt-offs\": %u,\n", TEST_PKT_OFFS);
+	json_print_to_buffer(buff, size, depth + 3, "\"rss-type\": %u,\n", 0);
+	json_print_to_buffer(buff, size, depth + 3, "\"num_inqs\": %u,\n", TEST_NUM_INQS);
+	for (i = 0; i < TEST_NUM_INQS; i++) {
+		/* Older NMP versions did not open a section per in-queue, but did close one */
+		if (!legacy)
+			json_print_to_buffer(buff, size, depth + 3, "\"inq-%u\": {\n", i);
+		test_serialize_queue(buff, size, &pos, depth + 4, &qs[1 + i]);
+		json_print_to_buffer(buff, size, depth + 3, "},\n");
+	}
+	json_print_to_buffer(buff, size, depth + 3, "\"num_inpools\": %u,\n", 1);
+	json_print_to_buffer(buff, size, depth + 3, "\"bpid\": %u,\n", TEST_POOL_ID);
+	json_print_to_buffer(buff, size, depth + 2, "},\n");
+	json_print_to_buffer(buff, size, depth + 2, "\"num_outtcs\": %u,\n", 1);
+	json_print_to_buffer(buff, size, depth + 2, "\"outtc-%u\": {\n", 0);
+	json_print_to_buffer(buff, size, depth + 3, "\"num_outqs\": %u,\n", TEST_NUM_OUTQS);
+	for (i = 0; i < TEST_NUM_OUTQS; i++) {
+		json_print_to_buffer(buff, size, depth + 3, "\"outq-%u\": {\n", i);
+		test_serialize_queue(buff, size, &pos, depth + 4, &qs[1 + TEST_NUM_INQS + i]);
+		json_print_to_buffer(buff, size, depth + 3, "},\n");
+	}
+	json_print_to_buffer(buff, size, depth + 2, "},\n");
+	json_print_to_buffer(buff, size, depth + 1, "},\n");
+	json_print_to_buffer(buff, size, depth, "},\n");
+}
+
+static u32 *test_q_idx(u32 offs)
+{
+	return (u32 *)(shm_va + offs);
+}
+
+/* Frames placed on an in-queue ring by the host must be received from it */
+static int test_inq(struct giu_gpio *gpio, int q_idx, struct test_q *q)
+{
+	struct giu_gpio_desc *ring = (struct giu_gpio_desc *)(shm_va + q->base_offs);
+	struct giu_gpio_desc descs[TEST_NUM_DESCS];
+	u16 num = TEST_NUM_DESCS;
+	int i;
+
+	memset(ring, 0, TEST_Q_LEN * sizeof(*ring));
+	for (i = 0; i < TEST_NUM_DESCS; i++)
+		ring[i].cmds[6] = q->qid * 100 + i;
+	*test_q_idx(q->cons_offs) = 0;
+	*test_q_idx(q->prod_offs) = TEST_NUM_DESCS;
+
+	GIU_CHECK(!giu_gpio_recv(gpio, 0, q_idx, descs, &num), "giu_gpio_recv failed");
+	GIU_CHECK(num == TEST_NUM_DESCS, "bad number of frames received");
+	for (i = 0; i < TEST_NUM_DESCS; i++)
+		GIU_CHECK(giu_gpio_inq_desc_get_cookie(&descs[i]) == q->qid * 100 + i, "frame read from a wrong ring");
+	GIU_CHECK(*test_q_idx(q->cons_offs) == TEST_NUM_DESCS, "consumer index not updated");
+
+	return 0;
+}
+
+/* Frames sent on an out-queue must land on its ring */
+static int test_outq(struct giu_gpio *gpio, int q_idx, struct test_q *q)
+{
+	struct giu_gpio_desc *ring = (struct giu_gpio_desc *)(shm_va + q->base_offs);
+	struct giu_gpio_desc descs[TEST_NUM_DESCS];
+	u16 num = TEST_NUM_DESCS;
+	int i;
+
+	memset(ring, 0, TEST_Q_LEN * sizeof(*ring));
+	for (i = 0; i < TEST_NUM_DESCS; i++) {
+		giu_gpio_outq_desc_reset(&descs[i]);
+		descs[i].cmds[6] = q->qid * 100 + i;
+	}
+	*test_q_idx(q->cons_offs) = 0;
+	*test_q_idx(q->prod_offs) = 0;
+
+	GIU_CHECK(!giu_gpio_send(gpio, 0, q_idx, descs, &num), "giu_gpio_send failed");
+	GIU_CHECK(num == TEST_NUM_DESCS, "bad number of frames sent");
+	for (i = 0; i < TEST_NUM_DESCS; i++)
+		GIU_CHECK(ring[i].cmds[6] == q->qid * 100 + i, "frame written to a wrong ring");
+	GIU_CHECK(*test_q_idx(q->prod_offs) == TEST_NUM_DESCS, "producer index not updated");
+
+	return 0;
+}
+
+static int test_probe(int legacy)
+{
+	struct giu_bpool *bpool = NULL;
+	struct giu_gpio *gpio = NULL;
+	struct giu_bpool_capabilities bp_capa;
+	struct giu_gpio_capabilities capa;
+	int i, err = -1;
+
+	test_serialize(prb_str, sizeof(prb_str), legacy);
+
+	if (giu_bpool_probe(TEST_POOL_MATCH, prb_str, &bpool)) {
+		pr_err("%s: giu_bpool_probe failed\n", __func__);
+		return -1;
+	}
+	if (giu_gpio_probe(TEST_GPIO_MATCH, prb_str, &gpio)) {
+		pr_err("%s: giu_gpio_probe failed\n", __func__);
+		goto probe_exit;
+	}
+
+	if (giu_bpool_get_capabilities(bpool, &bp_capa) ||
+	    bp_capa.buff_len != TEST_BUFF_LEN || bp_capa.max_num_buffs != TEST_Q_LEN - 1) {
+		pr_err("%s: bad bpool capabilities\n", __func__);
+		goto probe_exit;
+	}
+
+	memset(&capa, 0, sizeof(capa));
+	if (giu_gpio_get_capabilities(gpio, &capa) ||
+	    capa.intcs_inf.num_intcs != 1 || capa.intcs_inf.intcs_inf[0].num_inqs != TEST_NUM_INQS ||
+	    capa.outtcs_inf.num_outtcs != 1 || capa.outtcs_inf.outtcs_inf[0].num_outqs != TEST_NUM_OUTQS) {
+		pr_err("%s: bad gpio capabilities\n", __func__);
+		goto probe_exit;
+	}
+	for (i = 0; i < TEST_NUM_INQS; i++)
+		if (capa.intcs_inf.intcs_inf[0].inqs_inf[i].size != TEST_Q_LEN - 1 ||
+		    capa.intcs_inf.intcs_inf[0].inqs_inf[i].offset != TEST_PKT_OFFS) {
+			pr_err("%s: bad inq-%d capabilities\n", __func__, i);
+			goto probe_exit;
+		}
+	for (i = 0; i < TEST_NUM_OUTQS; i++)
+		if (capa.outtcs_inf.outtcs_inf[0].outqs_inf[i].size != TEST_Q_LEN - 1) {
+			pr_err("%s: bad outq-%d capabilities\n", __func__, i);
+			goto probe_exit;
+		}
+
+	for (i = 0; i < TEST_NUM_INQS; i++)
+		if (test_inq(gpio, i, &qs[1 + i]))
+			goto probe_exit;
+	for (i = 0; i < TEST_NUM_OUTQS; i++)
+		if (test_outq(gpio, i, &qs[1 + TEST_NUM_INQS + i]))
+			goto probe_exit;
+
+	err = 0;
+	printf("  ok\n");
+
+probe_exit:
+	if (gpio)
+		giu_gpio_remove(gpio);
+	giu_bpool_remove(bpool);
+	return err;
+}
+
+static void test_deinit(void)
+{
+	if (iomem) {
+		sys_iomem_unmap(iomem, NULL);
+		sys_iomem_deinit(iomem);
+	}
+	if (rings)
+		mv_sys_dma_mem_free(rings);
+}
+
+int main(int argc, char *argv[])
+{
+	int err;
+
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	printf("GIU guest probe test\n");
+
+	err = mv_sys_dma_mem_init(TEST_DMA_SIZE);
+	if (err) {
+		pr_err("DMA mem init failed (%d)\n", err);
+		return err;
+	}
+
+	printf("init:\n");
+	err = test_init();
+	if (!err) {
+		printf("probe:\n");
+		err = test_probe(0);
+	}
+	if (!err) {
+		printf("probe (old gpio layout):\n");
+		err = test_probe(1);
+	}
+	test_deinit();
+	mv_sys_dma_mem_destroy();
+
+	if (err) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
@@ -0,0 +1,453 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <netinet/in.h>
+
+#include "mv_std.h"
+#include "lib/mv_gso.h"
+
+#define GSO_TEST_MAX_FRAME	(64 * 1024)
+#define GSO_TEST_MAX_SEGS	256
+#define GSO_TEST_MAX_FRAGS	(GSO_TEST_MAX_SEGS * MV_GSO_MAX_SEG_FRAGS)
+#define GSO_TEST_MAX_IN		32
+#define GSO_TEST_ITERATIONS	2000
+#define GSO_TEST_L3_OFFS	14	/* Ethernet header */
+
+struct gso_test_case {
+	int	ipv6;
+	int	udp;
+	int	ip_opts;	/* IPv4 options length in bytes */
+	int	tcp_opts;	/* TCP options length in bytes */
+	int	hw_csum;
+};
+
+static u8 frame[GSO_TEST_MAX_FRAME];
+static u8 ref[GSO_TEST_MAX_FRAME + GSO_TEST_MAX_SEGS * MV_GSO_MAX_HDR_LEN];
+static u8 out[GSO_TEST_MAX_FRAME + GSO_TEST_MAX_SEGS * MV_GSO_MAX_HDR_LEN];
+static u8 hdr_area[GSO_TEST_MAX_SEGS * 256];
+static struct mv_gso_frag frags[GSO_TEST_MAX_FRAGS];
+static u8 seg_frags[GSO_TEST_MAX_SEGS];
+
+static void put16(u8 *p, u16 v)
+{
+	p[0] = v >> 8;
+	p[1] = v & 0xff;
+}
+
+static u16 get16(const u8 *p)
+{
+	return (p[0] << 8) | p[1];
+}
+
+static void put32(u8 *p, u32 v)
+{
+	put16(p, v >> 16);
+	put16(p + 2, v & 0xffff);
+}
+
+static u32 get32(const u8 *p)
+{
+	return ((u32)get16(p) << 16) | get16(p + 2);
+}
+
+/* Straightforward byte-wise big-endian one's complement sum */
+static u32 ref_sum(const u8 *p, u32 len, u32 sum)
+{
+	u32 i;
+
+	for (i = 0; i + 1 < len; i += 2)
+		sum += get16(p + i);
+	if (len & 1)
+		sum += p[len - 1] << 8;
+	return sum;
+}
+
+static u16 ref_fold(u32 sum)
+{
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return (u16)~sum;
+}
+
+static int build_frame(struct gso_test_case *tc, u32 payload, u16 *hdr_len, u16 *l4_offs)
+{
+	u8 *l3 = frame + GSO_TEST_L3_OFFS;
+	u8 *l4;
+	u16 l3_len, l4_len;
+	u32 i;
+
+	memset(frame, 0, 128);
+	for (i = 0; i < 12; i++)
+		frame[i] = rand();
+	put16(frame + 12, tc->ipv6 ? 0x86dd : 0x0800);
+
+	if (tc->ipv6) {
+		l3_len = 40;
+		l3[0] = 0x60;
+		l3[6] = tc->udp ? IPPROTO_UDP : IPPROTO_TCP;
+		l3[7] = 64;
+		for (i = 8; i < 40; i++)
+			l3[i] = rand();
+	} else {
+		l3_len = 20 + tc->ip_opts;
+		l3[0] = 0x40 | (l3_len / 4);
+		put16(l3 + 4, rand());
+		put16(l3 + 6, 0x4000);	/* DF */
+		l3[8] = 64;
+		l3[9] = tc->udp ? IPPROTO_UDP : IPPROTO_TCP;
+		for (i = 12; i < l3_len; i++)
+			l3[i] = rand();
+		put16(l3 + 10, rand());	/* garbage checksum must be ignored */
+	}
+
+	l4 = l3 + l3_len;
+	if (tc->udp) {
+		l4_len = 8;
+		put32(l4, rand());
+		put16(l4 + 6, rand());
+	} else {
+		l4_len = 20 + tc->tcp_opts;
+		for (i = 0; i < l4_len; i++)
+			l4[i] = rand();
+		l4[12] = (l4_len / 4) << 4;
+		l4[13] = 0x80 | 0x10 | 0x08 | 0x01;	/* CWR, ACK, PSH, FIN */
+	}
+
+	*l4_offs = GSO_TEST_L3_OFFS + l3_len;
+	*hdr_len = *l4_offs + l4_len;
+	for (i = 0; i < payload; i++)
+		frame[*hdr_len + i] = rand();
+	return 0;
+}
+
+/* Reference segmenter: every segment is built linearly and its checksums are
+ * calculated from scratch.
+ */
+static u32 ref_segment(struct gso_test_case *tc, u32 payload, u16 mss, u16 hdr_len, u16 l4_offs,
+		       u32 *seg_lens, u16 *num_segs)
+{
+	u32 offs = 0, total = 0, pay, sum;
+	u16 seg = 0, l3_offs = GSO_TEST_L3_OFFS;
+	u8 *p, *l3, *l4;
+
+	while (offs < payload) {
+		pay = (payload - offs < mss) ? payload - offs : mss;
+		p = ref + total;
+		memcpy(p, frame, hdr_len);
+		memcpy(p + hdr_len, frame + hdr_len + offs, pay);
+		l3 = p + l3_offs;
+		l4 = p + l4_offs;
+
+		if (tc->ipv6) {
+			put16(l3 + 4, hdr_len - l3_offs - 40 + pay);
+			sum = ref_sum(l3 + 8, 32, 0);
+		} else {
+			put16(l3 + 2, hdr_len - l3_offs + pay);
+			put16(l3 + 4, get16(frame + l3_offs + 4) + seg);
+			put16(l3 + 10, 0);
+			put16(l3 + 10, ref_fold(ref_sum(l3, l4_offs - l3_offs, 0)));
+			sum = ref_sum(l3 + 12, 8, 0);
+		}
+		sum += tc->udp ? IPPROTO_UDP : IPPROTO_TCP;
+		sum += hdr_len - l4_offs + pay;
+
+		if (tc->udp) {
+			put16(l4 + 4, hdr_len - l4_offs + pay);
+			put16(l4 + 6, 0);
+		} else {
+			put32(l4 + 4, get32(frame + l4_offs + 4) + offs);
+			if (offs + pay < payload)
+				l4[13] &= ~(0x08 | 0x01);
+			if (seg)
+				l4[13] &= ~0x80;
+			put16(l4 + 16, 0);
+		}
+		if (!tc->hw_csum) {
+			sum = ref_fold(ref_sum(l4, hdr_len - l4_offs + pay, sum));
+			if (tc->udp && !sum)
+				sum = 0xffff;
+			put16(l4 + (tc->udp ? 6 : 16), sum);
+		}
+
+		seg_lens[seg++] = hdr_len + pay;
+		total += hdr_len + pay;
+		offs += pay;
+	}
+	*num_segs = seg;
+	return total;
+}
+
+static int run_case(struct gso_test_case *tc, u32 payload, u16 mss)
+{
+	struct mv_gso_params params;
+	struct mv_gso_buf in[GSO_TEST_MAX_IN];
+	struct mv_gso_info info;
+	u32 seg_lens[GSO_TEST_MAX_SEGS];
+	u32 frame_len, offs, ref_len, out_len = 0, len;
+	u16 hdr_len, l4_offs, num_in = 0, ref_segs, i, j, f = 0;
+	int err;
+
+	build_frame(tc, payload, &hdr_len, &l4_offs);
+	frame_len = hdr_len + payload;
+
+	/* Split the frame into a random buffer chain; the first holds all headers */
+	offs = 0;
+	while (offs < frame_len) {
+		if (num_in == GSO_TEST_MAX_IN - 1)
+			len = frame_len - offs;
+		else
+			len = 1 + rand() % 3000;
+		if (!num_in && len < hdr_len)
+			len = hdr_len + rand() % 64;
+		if (len > frame_len - offs)
+			len = frame_len - offs;
+		in[num_in].vaddr = frame + offs;
+		in[num_in].paddr = (dma_addr_t)(uintptr_t)(frame + offs);
+		in[num_in].len = len;
+		num_in++;
+		offs += len;
+	}
+
+	memset(&params, 0, sizeof(params));
+	params.mss = mss;
+	params.l3_offset = GSO_TEST_L3_OFFS;
+	params.max_frags = MV_GSO_MAX_SEG_FRAGS;
+	params.l4_csum = tc->hw_csum ? MV_GSO_L4_CSUM_HW : MV_GSO_L4_CSUM_SW;
+	params.hdr_area.vaddr = hdr_area;
+	params.hdr_area.paddr = (dma_addr_t)(uintptr_t)hdr_area;
+	params.hdr_area.len = sizeof(hdr_area);
+
+	err = mv_gso_segment(&params, in, num_in, frags, GSO_TEST_MAX_FRAGS, seg_frags,
+			     GSO_TEST_MAX_SEGS, &info);
+	if (err == -E2BIG)
+		return 1;	/* buffer chain too fragmented for one segment; skip */
+	if (err) {
+		printf("mv_gso_segment failed (%d)\n", err);
+		return -1;
+	}
+
+	ref_len = ref_segment(tc, payload, mss, hdr_len, l4_offs, seg_lens, &ref_segs);
+	if (info.num_segs != ref_segs || info.hdr_len != hdr_len || info.l4_offset != l4_offs) {
+		printf("segs %u/%u, hdr_len %u/%u\n", info.num_segs, ref_segs, info.hdr_len, hdr_len);
+		return -1;
+	}
+
+	for (i = 0; i < info.num_segs; i++) {
+		len = 0;
+		for (j = 0; j < seg_frags[i]; j++, f++) {
+			u8 exp = (j == 0 ? MV_GSO_FRAG_FIRST : 0) |
+				 (j == seg_frags[i] - 1 ? MV_GSO_FRAG_LAST : 0);
+
+			if (frags[f].flags != exp ||
+			    frags[f].paddr != (dma_addr_t)(uintptr_t)frags[f].vaddr) {
+				printf("seg %u frag %u: bad flags/address\n", i, j);
+				return -1;
+			}
+			memcpy(out + out_len, frags[f].vaddr, frags[f].len);
+			out_len += frags[f].len;
+			len += frags[f].len;
+		}
+		if (len != seg_lens[i]) {
+			printf("seg %u: len %u, expected %u\n", i, len, seg_lens[i]);
+			return -1;
+		}
+	}
+	if (f != info.num_frags || out_len != ref_len || memcmp(out, ref, ref_len)) {
+		for (offs = 0; offs < ref_len && out[offs] == ref[offs]; offs++)
+			;
+		printf("output mismatch at offset %u (frags %u/%u, len %u/%u)\n",
+		       offs, f, info.num_frags, out_len, ref_len);
+		return -1;
+	}
+	return 0;
+}
+
+static int negative_tests(void)
+{
+	struct gso_test_case tc = {0};
+	struct mv_gso_params params;
+	struct mv_gso_buf in[GSO_TEST_MAX_IN];
+	struct mv_gso_info info;
+	u16 hdr_len, l4_offs, i;
+
+	build_frame(&tc, 8000, &hdr_len, &l4_offs);
+	memset(&params, 0, sizeof(params));
+	params.mss = 1000;
+	params.l3_offset = GSO_TEST_L3_OFFS;
+	params.hdr_area.vaddr = hdr_area;
+	params.hdr_area.len = sizeof(hdr_area);
+
+	/* header area too small */
+	in[0].vaddr = frame;
+	in[0].len = hdr_len + 8000;
+	params.hdr_area.len = 7 * mv_gso_hdr_stride(hdr_len);
+	if (mv_gso_segment(&params, in, 1, frags, GSO_TEST_MAX_FRAGS, seg_frags, GSO_TEST_MAX_SEGS, &info) != -ENOSPC)
+		return -1;
+	params.hdr_area.len = sizeof(hdr_area);
+
+	/* too many fragments per segment */
+	in[0].len = hdr_len;
+	for (i = 1; i <= 20; i++) {
+		in[i].vaddr = frame + hdr_len + (i - 1) * 400;
+		in[i].len = 400;
+	}
+	params.max_frags = 2;
+	if (mv_gso_segment(&params, in, 21, frags, GSO_TEST_MAX_FRAGS, seg_frags, GSO_TEST_MAX_SEGS, &info) != -E2BIG)
+		return -1;
+	params.max_frags = 0;
+
+	/* IPv4 fragment */
+	in[0].len = hdr_len + 8000;
+	frame[GSO_TEST_L3_OFFS + 6] |= 0x20;
+	if (mv_gso_segment(&params, in, 1, frags, GSO_TEST_MAX_FRAGS, seg_frags, GSO_TEST_MAX_SEGS, &info) != -EINVAL)
+		return -1;
+	frame[GSO_TEST_L3_OFFS + 6] &= ~0x20;
+
+	/* headers not in the first buffer */
+	in[0].len = hdr_len - 1;
+	in[1].vaddr = frame + hdr_len - 1;
+	in[1].len = 8001;
+	if (mv_gso_segment(&params, in, 2, frags, GSO_TEST_MAX_FRAGS, seg_frags, GSO_TEST_MAX_SEGS, &info) != -EINVAL)
+		return -1;
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct gso_test_case tc;
+	u32 payload, skipped = 0;
+	u16 mss;
+	int i, err;
+
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	printf("SW GSO test:\n");
+
+	srand(argc > 1 ? atoi(argv[1]) : 1);
+
+	for (i = 0; i < GSO_TEST_ITERATIONS; i++) {
+		memset(&tc, 0, sizeof(tc));
+		tc.ipv6 = rand() & 1;
+		tc.udp = rand() & 1;
+		tc.ip_opts = tc.ipv6 ? 0 : (rand() % 11) * 4;
+		tc.tcp_opts = tc.udp ? 0 : (rand() % 11) * 4;
+		tc.hw_csum = !(rand() % 4);
+		mss = 1 + rand() % 9000;
+		payload = 1 + rand() % (GSO_TEST_MAX_FRAME - 256);
+		if ((payload + mss - 1) / mss > GSO_TEST_MAX_SEGS)
+			mss = (payload + GSO_TEST_MAX_SEGS - 1) / GSO_TEST_MAX_SEGS;
+
+		err = run_case(&tc, payload, mss);
+		if (err < 0) {
+			printf("FAILED iteration %d: ipv%d %s ip_opts %d tcp_opts %d hw %d payload %u mss %u\n",
+			       i, tc.ipv6 ? 6 : 4, tc.udp ? "udp" : "tcp", tc.ip_opts, tc.tcp_opts,
+			       tc.hw_csum, payload, mss);
+			return -1;
+		}
+		skipped += err;
+	}
+
+	if (negative_tests()) {
+		printf("FAILED negative tests\n");
+		return -1;
+	}
+
+	printf("%d iterations passed (%u skipped, too fragmented)\n", GSO_TEST_ITERATIONS, skipped);
+	return 0;
+}
@@ -0,0 +1,363 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mv_std.h"
+#include "lib/mv_hsched.h"
+
+#define HS_BURST		32
+#define HS_PKT_LEN		1000
+#define HS_STEP_NS		10000		/* simulated time step */
+#define HS_SIM_NS		1000000000ULL	/* simulated run time */
+
+#define HS_CHECK(cond, ...)			\
+	do {					\
+		if (!(cond)) {			\
+			printf(__VA_ARGS__);	\
+			return -1;		\
+		}				\
+	} while (0)
+
+static struct mv_hsched *hs_create(u32 num_subs, u8 num_tcs, u8 num_queues, u16 qsize, u64 port_rate)
+{
+	struct mv_hsched_params params;
+	struct mv_hsched *sched;
+
+	memset(&params, 0, sizeof(params));
+	params.num_subs = num_subs;
+	params.num_tcs = num_tcs;
+	params.num_queues = num_queues;
+	params.qsize = qsize;
+	params.port_rate = port_rate;
+	params.port_burst = port_rate ? 16 * HS_PKT_LEN : 0;
+	if (mv_hsched_create(&params, &sched))
+		return NULL;
+	return sched;
+}
+
+/* Keep every given queue backlogged and run the scheduler over simulated time;
+ * returns the bytes sent per queue in 'bytes' (indexed as the 'cls' array).
+ */
+static int hs_run(struct mv_hsched *sched, struct mv_hsched_pkt *cls, int num_cls, u64 sim_ns, u64 *bytes)
+{
+	struct mv_hsched_pkt pkts[HS_BURST];
+	u64 now;
+	u16 num;
+	int i, j;
+
+	memset(bytes, 0, num_cls * sizeof(u64));
+	for (now = HS_STEP_NS; now <= sim_ns; now += HS_STEP_NS) {
+		for (i = 0; i < num_cls; i++) {
+			for (j = 0; j < 4; j++)
+				pkts[j] = cls[i];
+			num = 4;
+			mv_hsched_enqueue(sched, pkts, &num);
+		}
+		/* drain slower than the queues are fed to keep them backlogged */
+		num = 4;
+		mv_hsched_dequeue(sched, now, pkts, &num);
+		for (j = 0; j < num; j++)
+			for (i = 0; i < num_cls; i++)
+				if (pkts[j].sub == cls[i].sub && pkts[j].tc == cls[i].tc && pkts[j].queue == cls[i].queue)
+					bytes[i] += pkts[j].len;
+	}
+	return 0;
+}
+
+static int hs_near(u64 val, u64 exp, int pct)
+{
+	return (val * 100 >= exp * (100 - pct)) && (val * 100 <= exp * (100 + pct));
+}
+
+static int test_priority_and_fifo(void)
+{
+	struct mv_hsched *sched = hs_create(1, 2, 1, 256, 0);
+	struct mv_hsched_pkt pkts[HS_BURST];
+	u16 num, i, got = 0;
+	u64 next[2] = {0, 0};
+
+	HS_CHECK(sched, "create failed\n");
+	for (i = 0; i < 200; i++) {
+		memset(&pkts[0], 0, sizeof(pkts[0]));
+		pkts[0].tc = i & 1;
+		pkts[0].cookie = i / 2;
+		pkts[0].len = 64 + i;
+		num = 1;
+		mv_hsched_enqueue(sched, pkts, &num);
+		HS_CHECK(num == 1, "enqueue failed\n");
+	}
+	while (got < 200) {
+		num = HS_BURST;
+		mv_hsched_dequeue(sched, 1, pkts, &num);
+		HS_CHECK(num, "dequeue stalled after %u\n", got);
+		for (i = 0; i < num; i++, got++) {
+			HS_CHECK(pkts[i].tc == (got < 100 ? 0 : 1), "priority violated at %u\n", got);
+			HS_CHECK(pkts[i].cookie == next[pkts[i].tc]++, "FIFO order violated\n");
+		}
+	}
+	mv_hsched_destroy(sched);
+	return 0;
+}
+
+static int test_queue_wrr(void)
+{
+	struct mv_hsched *sched = hs_create(1, 1, 2, 64, 0);
+	struct mv_hsched_sub_params sp;
+	struct mv_hsched_pkt cls[2];
+	u64 bytes[2];
+
+	HS_CHECK(sched, "create failed\n");
+	memset(&sp, 0, sizeof(sp));
+	sp.q_weight[0][0] = 1;
+	sp.q_weight[0][1] = 3;
+	mv_hsched_sub_config(sched, 0, &sp);
+	memset(cls, 0, sizeof(cls));
+	cls[0].len = cls[1].len = HS_PKT_LEN;
+	cls[1].queue = 1;
+	hs_run(sched, cls, 2, HS_SIM_NS / 100, bytes);
+	HS_CHECK(hs_near(bytes[1], 3 * bytes[0], 2), "queue WRR: %llu vs %llu\n",
+		 (unsigned long long)bytes[1], (unsigned long long)bytes[0]);
+	mv_hsched_destroy(sched);
+	return 0;
+}
+
+static int test_sub_wrr_and_port_shaper(void)
+{
+	u64 port_rate = 100000000;	/* 100 MB/s */
+	struct mv_hsched *sched = hs_create(3, 1, 1, 64, port_rate);
+	struct mv_hsched_sub_params sp;
+	struct mv_hsched_pkt cls[3];
+	u64 bytes[3], total;
+	int i;
+
+	HS_CHECK(sched, "create failed\n");
+	memset(cls, 0, sizeof(cls));
+	for (i = 0; i < 3; i++) {
+		memset(&sp, 0, sizeof(sp));
+		sp.weight = i + 1;
+		mv_hsched_sub_config(sched, i, &sp);
+		cls[i].sub = i;
+		cls[i].len = HS_PKT_LEN;
+	}
+	hs_run(sched, cls, 3, HS_SIM_NS / 10, bytes);
+	total = bytes[0] + bytes[1] + bytes[2];
+	HS_CHECK(hs_near(total, port_rate / 10, 2), "port shaper: %llu bytes\n", (unsigned long long)total);
+	for (i = 1; i < 3; i++)
+		HS_CHECK(hs_near(bytes[i], (i + 1) * bytes[0], 3), "sub WRR: sub%d %llu vs sub0 %llu\n",
+			 i, (unsigned long long)bytes[i], (unsigned long long)bytes[0]);
+	mv_hsched_destroy(sched);
+	return 0;
+}
+
+static int test_shapers(void)
+{
+	struct mv_hsched *sched = hs_create(2, 2, 1, 64, 0);
+	struct mv_hsched_sub_params sp;
+	struct mv_hsched_pkt cls[3];
+	u64 bytes[3];
+
+	HS_CHECK(sched, "create failed\n");
+	/* sub0: 10 MB/s with TC0 limited to 2 MB/s; sub1: 5 MB/s */
+	memset(&sp, 0, sizeof(sp));
+	sp.rate = 10000000;
+	sp.burst = 4 * HS_PKT_LEN;
+	sp.tc_rate[0] = 2000000;
+	sp.tc_burst[0] = 2 * HS_PKT_LEN;
+	mv_hsched_sub_config(sched, 0, &sp);
+	memset(&sp, 0, sizeof(sp));
+	sp.rate = 5000000;
+	sp.burst = 4 * HS_PKT_LEN;
+	mv_hsched_sub_config(sched, 1, &sp);
+
+	memset(cls, 0, sizeof(cls));
+	cls[0].len = cls[1].len = cls[2].len = HS_PKT_LEN;
+	cls[1].tc = 1;
+	cls[2].sub = 1;
+	hs_run(sched, cls, 3, HS_SIM_NS, bytes);
+	HS_CHECK(hs_near(bytes[0], 2000000, 2), "TC shaper: %llu\n", (unsigned long long)bytes[0]);
+	HS_CHECK(hs_near(bytes[0] + bytes[1], 10000000, 2), "sub shaper: %llu\n",
+		 (unsigned long long)(bytes[0] + bytes[1]));
+	HS_CHECK(hs_near(bytes[2], 5000000, 2), "sub1 shaper: %llu\n", (unsigned long long)bytes[2]);
+	mv_hsched_destroy(sched);
+	return 0;
+}
+
+static int test_drops(void)
+{
+	struct mv_hsched *sched = hs_create(2, 1, 1, 4, 0);
+	struct mv_hsched_pkt pkts[8];
+	struct mv_hsched_queue_stats stats;
+	u16 num, i;
+
+	HS_CHECK(sched, "create failed\n");
+	memset(pkts, 0, sizeof(pkts));
+	for (i = 0; i < 8; i++) {
+		pkts[i].cookie = i;
+		pkts[i].len = 64;
+	}
+	pkts[2].sub = 7;	/* invalid */
+	num = 8;
+	mv_hsched_enqueue(sched, pkts, &num);
+	HS_CHECK(num == 4, "enqueued %u\n", num);
+	HS_CHECK(pkts[0].cookie == 2 && pkts[1].cookie == 5 && pkts[2].cookie == 6 && pkts[3].cookie == 7,
+		 "dropped packets not returned in order\n");
+	mv_hsched_queue_get_stats(sched, 0, 0, 0, &stats, 0);
+	HS_CHECK(stats.drops == 3 && stats.occupancy == 4, "bad queue stats\n");
+	mv_hsched_destroy(sched);
+	return 0;
+}
+
+/* Thousands of subscribers, random classification, unshaped */
+static int bench(u32 num_subs, u32 num_pkts)
+{
+	struct mv_hsched *sched = hs_create(num_subs, 4, 1, 64, 0);
+	struct mv_hsched_pkt pkts[HS_BURST];
+	struct timespec t0, t1;
+	u32 enq = 0, deq = 0, i;
+	u16 num;
+	double sec;
+
+	HS_CHECK(sched, "create failed\n");
+	srand(1);
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	while (deq < num_pkts) {
+		for (i = 0; i < HS_BURST; i++) {
+			pkts[i].cookie = enq + i;
+			pkts[i].len = 64 + (rand() & 1023);
+			pkts[i].sub = rand() % num_subs;
+			pkts[i].tc = rand() & 3;
+			pkts[i].queue = 0;
+		}
+		num = HS_BURST;
+		mv_hsched_enqueue(sched, pkts, &num);
+		enq += num;
+		num = HS_BURST;
+		mv_hsched_dequeue(sched, deq, pkts, &num);
+		deq += num;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	sec = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+	printf("bench: %u subscribers x 4 TCs, %u packets: %.2f Mpps (enqueue + dequeue)\n",
+	       num_subs, deq, deq / sec / 1e6);
+	mv_hsched_destroy(sched);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int err = 0;
+
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	printf("Hierarchical scheduler test:\n");
+
+	err |= test_priority_and_fifo();
+	err |= test_queue_wrr();
+	err |= test_sub_wrr_and_port_shaper();
+	err |= test_shapers();
+	err |= test_drops();
+	if (err) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+
+	bench(argc > 1 ? atoi(argv[1]) : 4096, 10000000);
+	return 0;
+}
@@ -0,0 +1,554 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <netinet/in.h>
+
+#include "mv_std.h"
+#include "lib/mv_ip_frag.h"
+
+#define IPF_TEST_L3_OFFS	14	/* Ethernet header */
+#define IPF_TEST_MAX_PKT	9000
+#define IPF_TEST_MAX_FRAGS	MV_IP_REASS_MAX_FRAGS
+#define IPF_TEST_BUF_SIZE	2048
+#define IPF_TEST_NUM_BUFS	256
+#define IPF_TEST_ITERATIONS	2000
+#define IPF_TEST_TIMEOUT_MS	100
+
+/* Fake application buffer pool; the cookie is the buffer index + 1 */
+static u8 bufs[IPF_TEST_NUM_BUFS][IPF_TEST_BUF_SIZE];
+static int buf_used[IPF_TEST_NUM_BUFS];
+
+static u8 pkt[IPF_TEST_MAX_PKT];
+static u8 lin[IPF_TEST_MAX_PKT];
+static u8 hdr_area[IPF_TEST_MAX_FRAGS * 128];
+static struct mv_gso_frag frags[IPF_TEST_MAX_FRAGS * MV_GSO_MAX_SEG_FRAGS];
+static u8 pkt_frags[IPF_TEST_MAX_FRAGS];
+
+struct ipf_rx_frag {
+	int	buf;
+	u16	len;
+};
+
+static int buf_get(void)
+{
+	int i;
+
+	for (i = 0; i < IPF_TEST_NUM_BUFS; i++)
+		if (!buf_used[i]) {
+			buf_used[i] = 1;
+			return i;
+		}
+	return -1;
+}
+
+static int buf_put(void *cookie)
+{
+	int i = (int)(uintptr_t)cookie - 1;
+
+	if (i < 0 || i >= IPF_TEST_NUM_BUFS || !buf_used[i]) {
+		printf("bad or double buffer release %d\n", i);
+		return -1;
+	}
+	buf_used[i] = 0;
+	return 0;
+}
+
+static int bufs_in_use(void)
+{
+	int i, cnt = 0;
+
+	for (i = 0; i < IPF_TEST_NUM_BUFS; i++)
+		cnt += buf_used[i];
+	return cnt;
+}
+
+static int death_row_drain(struct mv_ip_reass *reass)
+{
+	void *cookies[8];
+	u32 i, n;
+	int cnt = 0;
+
+	while ((n = mv_ip_reass_death_row_get(reass, cookies, 8)) > 0)
+		for (i = 0; i < n; i++, cnt++)
+			if (buf_put(cookies[i]))
+				return -1;
+	return cnt;
+}
+
+static void put16(u8 *p, u16 v)
+{
+	p[0] = v >> 8;
+	p[1] = v & 0xff;
+}
+
+static u16 ip4_csum(const u8 *p, u16 len)
+{
+	u32 sum = 0;
+	u16 i;
+
+	for (i = 0; i < len; i += 2)
+		sum += (p[i] << 8) | p[i + 1];
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return (u16)~sum;
+}
+
+/* Build a packet; IPv4 packets get a copied (0x83, LSRR) and a non-copied (0x07, RR) option */
+static u16 build_pkt(int ipv6, u32 id, u16 pay_len, int ip4_opts)
+{
+	u8 *l3 = pkt + IPF_TEST_L3_OFFS;
+	u16 l3_hdr_len, i;
+
+	for (i = 0; i < 12; i++)
+		pkt[i] = rand();
+	put16(pkt + 12, ipv6 ? 0x86dd : 0x0800);
+
+	if (ipv6) {
+		l3_hdr_len = 40;
+		memset(l3, 0, l3_hdr_len);
+		l3[0] = 0x60;
+		put16(l3 + 4, pay_len);
+		l3[6] = IPPROTO_UDP;
+		l3[7] = 64;
+		for (i = 8; i < 40; i++)
+			l3[i] = rand();
+	} else {
+		l3_hdr_len = 20 + (ip4_opts ? 16 : 0);
+		memset(l3, 0, l3_hdr_len);
+		l3[0] = 0x40 | (l3_hdr_len / 4);
+		put16(l3 + 2, l3_hdr_len + pay_len);
+		put16(l3 + 4, id);
+		l3[8] = 64;
+		l3[9] = IPPROTO_UDP;
+		for (i = 12; i < 20; i++)
+			l3[i] = rand();
+		if (ip4_opts) {
+			/* LSRR (copied), len 7 + NOP, RR (not copied), len 7 + EOL */
+			u8 opts[16] = {0x83, 7, 4, 1, 2, 3, 4, 1, 0x07, 7, 4, 0, 0, 0, 0, 0};
+
+			memcpy(l3 + 20, opts, sizeof(opts));
+		}
+		put16(l3 + 10, ip4_csum(l3, l3_hdr_len));
+	}
+	for (i = 0; i < pay_len; i++)
+		l3[l3_hdr_len + i] = rand();
+	return IPF_TEST_L3_OFFS + l3_hdr_len + pay_len;
+}
+
+/* Fragment 'pkt' and copy every fragment into a pool buffer (as if received) */
+static int fragment_to_bufs(u16 len, u16 mtu, u32 ip6_id, struct ipf_rx_frag *rx, u16 *num)
+{
+	struct mv_ip_frag_params params;
+	struct mv_gso_buf in[3];
+	u16 num_pkts, p, j, f = 0, split1, split2;
+	int err, b;
+
+	/* split into a random 3 buffers chain; the first holds the headers */
+	split1 = IPF_TEST_L3_OFFS + 60 + rand() % (len - IPF_TEST_L3_OFFS - 59);
+	split2 = split1 + rand() % (len - split1 + 1);
+	in[0].vaddr = pkt;
+	in[0].len = split1;
+	in[1].vaddr = pkt + split1;
+	in[1].len = split2 - split1;
+	in[2].vaddr = pkt + split2;
+	in[2].len = len - split2;
+	for (j = 0; j < 3; j++)
+		in[j].paddr = (dma_addr_t)(uintptr_t)in[j].vaddr;
+
+	memset(&params, 0, sizeof(params));
+	params.mtu = mtu;
+	params.l3_offset = IPF_TEST_L3_OFFS;
+	params.ip6_id = ip6_id;
+	params.hdr_area.vaddr = hdr_area;
+	params.hdr_area.paddr = (dma_addr_t)(uintptr_t)hdr_area;
+	params.hdr_area.len = sizeof(hdr_area);
+
+	err = mv_ip_fragment(&params, in, 3, frags, ARRAY_SIZE(frags), pkt_frags, IPF_TEST_MAX_FRAGS, &num_pkts);
+	if (err)
+		return err;
+
+	for (p = 0; p < num_pkts; p++) {
+		b = buf_get();
+		if (b < 0)
+			return -ENOMEM;
+		rx[p].buf = b;
+		rx[p].len = 0;
+		for (j = 0; j < pkt_frags[p]; j++, f++) {
+			if ((j == 0) != !!(frags[f].flags & MV_GSO_FRAG_FIRST) ||
+			    (j == pkt_frags[p] - 1) != !!(frags[f].flags & MV_GSO_FRAG_LAST)) {
+				printf("bad first/last flags\n");
+				return -EINVAL;
+			}
+			memcpy(bufs[b] + rx[p].len, frags[f].vaddr, frags[f].len);
+			rx[p].len += frags[f].len;
+		}
+		if (rx[p].len - IPF_TEST_L3_OFFS > mtu) {
+			printf("fragment %u exceeds the MTU (%u > %u)\n", p, rx[p].len - IPF_TEST_L3_OFFS, mtu);
+			return -EINVAL;
+		}
+		if (pkt[IPF_TEST_L3_OFFS] >> 4 == 4 &&
+		    ip4_csum(bufs[b] + IPF_TEST_L3_OFFS, (bufs[b][IPF_TEST_L3_OFFS] & 0xf) * 4)) {
+			printf("fragment %u: bad IPv4 checksum\n", p);
+			return -EINVAL;
+		}
+	}
+	*num = num_pkts;
+	return 0;
+}
+
+static int feed(struct mv_ip_reass *reass, struct ipf_rx_frag *rx, u64 now, struct mv_ip_reass_pkt *out)
+{
+	return mv_ip_reass_process(reass, (void *)(uintptr_t)(rx->buf + 1), bufs[rx->buf], rx->len,
+				   IPF_TEST_L3_OFFS, now, out);
+}
+
+static int release_pkt(struct mv_ip_reass_pkt *out)
+{
+	u16 i;
+
+	for (i = 0; i < out->num_frags; i++)
+		if (buf_put(out->frags[i].cookie))
+			return -1;
+	return 0;
+}
+
+/* Fragment random packets, deliver the fragments shuffled (some duplicated)
+ * and compare the reassembled packet with the original.
+ */
+static int roundtrip_test(struct mv_ip_reass *reass)
+{
+	struct ipf_rx_frag rx[IPF_TEST_MAX_FRAGS * 2], tmp;
+	struct mv_ip_reass_pkt out;
+	u16 len, num, mtu, n, i, j;
+	int it, ipv6, err, done;
+
+	for (it = 0; it < IPF_TEST_ITERATIONS; it++) {
+		ipv6 = rand() & 1;
+		mtu = 576 + rand() % 1000;
+		len = build_pkt(ipv6, it, 64 + rand() % 8000, rand() & 1);
+		if ((len - IPF_TEST_L3_OFFS) / ((mtu - 80) & ~7) + 1 > IPF_TEST_MAX_FRAGS)
+			mtu = 1500;
+
+		err = fragment_to_bufs(len, mtu, it, rx, &num);
+		if (err) {
+			printf("it %d: fragmentation failed (%d)\n", it, err);
+			return -1;
+		}
+
+		/* one duplicate */
+		n = num;
+		if (num > 1 && (rand() & 1)) {
+			rx[n].buf = buf_get();
+			rx[n].len = rx[0].len;
+			memcpy(bufs[rx[n].buf], bufs[rx[0].buf], rx[0].len);
+			n++;
+		}
+		for (i = n - 1; i > 0; i--) {
+			j = rand() % (i + 1);
+			tmp = rx[i];
+			rx[i] = rx[j];
+			rx[j] = tmp;
+		}
+
+		done = 0;
+		for (i = 0; i < n; i++) {
+			err = feed(reass, &rx[i], it, &out);
+			if (err < 0) {
+				printf("it %d: process failed (%d)\n", it, err);
+				return -1;
+			}
+			if (err == 1) {
+				if (done++) {
+					printf("it %d: reassembled twice\n", it);
+					return -1;
+				}
+				if (mv_ip_reass_linearize(&out, lin, sizeof(lin)) != len || memcmp(lin, pkt, len)) {
+					printf("it %d: ipv%d len %u mtu %u: reassembled packet mismatch\n",
+					       it, ipv6 ? 6 : 4, len, mtu);
+					return -1;
+				}
+				if (release_pkt(&out))
+					return -1;
+			}
+		}
+		if (!done && num > 0) {
+			/* the duplicate may only be late (after completion) */
+			printf("it %d: not reassembled (%u fragments)\n", it, num);
+			return -1;
+		}
+		if (death_row_drain(reass) < 0)
+			return -1;
+		if (bufs_in_use()) {
+			/* a late duplicate starts a new flow; let it time out */
+			mv_ip_reass_expire(reass, it + IPF_TEST_TIMEOUT_MS);
+			if (death_row_drain(reass) < 0 || bufs_in_use()) {
+				printf("it %d: buffers leaked\n", it);
+				return -1;
+			}
+		}
+	}
+	return 0;
+}
+
+static int overlap_timeout_test(struct mv_ip_reass *reass)
+{
+	struct ipf_rx_frag rx[IPF_TEST_MAX_FRAGS];
+	struct mv_ip_reass_pkt out;
+	struct mv_ip_reass_stats stats;
+	u16 len, num;
+	u8 *l3;
+	int b;
+
+	mv_ip_reass_get_stats(reass, &stats, 1);
+
+	/* overlap: the 2nd fragment is moved back by 8 bytes */
+	len = build_pkt(0, 1000, 3000, 0);
+	if (fragment_to_bufs(len, 1000, 0, rx, &num) || num != 4)
+		return -1;
+	l3 = bufs[rx[1].buf] + IPF_TEST_L3_OFFS;
+	put16(l3 + 6, ((l3[6] << 8 | l3[7]) & 0xe000) | (((l3[6] << 8 | l3[7]) & 0x1fff) - 1));
+	put16(l3 + 10, 0);
+	put16(l3 + 10, ip4_csum(l3, 20));
+	if (feed(reass, &rx[0], 0, &out) || feed(reass, &rx[2], 0, &out) ||
+	    feed(reass, &rx[1], 0, &out) || feed(reass, &rx[3], 0, &out))
+		return -1;
+	mv_ip_reass_get_stats(reass, &stats, 1);
+	if (stats.overlaps != 1 || stats.reassembled) {
+		printf("overlap not detected\n");
+		return -1;
+	}
+	/* the 4th fragment opened a new flow; time it out */
+	if (mv_ip_reass_expire(reass, IPF_TEST_TIMEOUT_MS) != 1 || death_row_drain(reass) != 4 || bufs_in_use()) {
+		printf("overlap/timeout: wrong buffer release\n");
+		return -1;
+	}
+
+	/* non-fragmented packets pass through */
+	len = build_pkt(1, 0, 100, 0);
+	b = buf_get();
+	memcpy(bufs[b], pkt, len);
+	rx[0].buf = b;
+	rx[0].len = len;
+	if (feed(reass, &rx[0], 0, &out) != 1 || out.num_frags != 1 || out.len != len)
+		return -1;
+	return release_pkt(&out);
+}
+
+/* Copy 'pkt' into a pool buffer as an IPv4 fragment carrying 'pay_len' bytes at 'offs' */
+static void ip4_frag_to_buf(u16 offs, u16 pay_len, int more, struct ipf_rx_frag *rx)
+{
+	u8 *l3;
+	int b = buf_get();
+
+	rx->buf = b;
+	rx->len = IPF_TEST_L3_OFFS + 20 + pay_len;
+	memcpy(bufs[b], pkt, rx->len);
+	l3 = bufs[b] + IPF_TEST_L3_OFFS;
+	put16(l3 + 2, 20 + pay_len);
+	put16(l3 + 6, (more ? 0x2000 : 0) | (offs / 8));
+	put16(l3 + 10, 0);
+	put16(l3 + 10, ip4_csum(l3, 20));
+}
+
+static int oversize_test(struct mv_ip_reass *reass)
+{
+	struct ipf_rx_frag rx[2];
+	struct mv_ip_reass_pkt out;
+	struct mv_ip_reass_stats stats;
+
+	mv_ip_reass_get_stats(reass, &stats, 1);
+
+	/* the payload ends at 0xffff, so total_len (incl. the header) would wrap */
+	build_pkt(0, 3000, 16, 0);
+	ip4_frag_to_buf(0, 8, 1, &rx[0]);
+	ip4_frag_to_buf(0xfff8, 7, 0, &rx[1]);
+	if (feed(reass, &rx[0], 0, &out) || feed(reass, &rx[1], 0, &out))
+		return -1;
+	mv_ip_reass_get_stats(reass, &stats, 1);
+	if (stats.errors != 1 || stats.reassembled || death_row_drain(reass) != 2 || bufs_in_use()) {
+		printf("oversized datagram not dropped\n");
+		return -1;
+	}
+
+	/* same, with the last fragment first */
+	build_pkt(0, 3001, 16, 0);
+	ip4_frag_to_buf(0xfff8, 7, 0, &rx[1]);
+	ip4_frag_to_buf(0, 8, 1, &rx[0]);
+	if (feed(reass, &rx[1], 0, &out) || feed(reass, &rx[0], 0, &out))
+		return -1;
+	mv_ip_reass_get_stats(reass, &stats, 1);
+	if (stats.errors != 1 || stats.reassembled || death_row_drain(reass) != 2 || bufs_in_use()) {
+		printf("oversized datagram not dropped (last fragment first)\n");
+		return -1;
+	}
+	return 0;
+}
+
+static int table_full_test(void)
+{
+	struct mv_ip_reass_params params = {.max_flows = 2, .timeout_ms = IPF_TEST_TIMEOUT_MS,
+					    .death_row_size = 64};
+	struct mv_ip_reass_stats stats;
+	struct mv_ip_reass *reass;
+	struct ipf_rx_frag rx[IPF_TEST_MAX_FRAGS];
+	struct mv_ip_reass_pkt out;
+	u16 len, num, i;
+
+	if (mv_ip_reass_create(&params, &reass))
+		return -1;
+	for (i = 0; i < 3; i++) {
+		len = build_pkt(i & 1, 2000 + i, 3000, 0);
+		if (fragment_to_bufs(len, 1500, i, rx, &num) || num < 2)
+			return -1;
+		if (feed(reass, &rx[0], 10 * i, &out))
+			return -1;
+		buf_put((void *)(uintptr_t)(rx[1].buf + 1));
+		if (num > 2)
+			buf_put((void *)(uintptr_t)(rx[2].buf + 1));
+	}
+	mv_ip_reass_get_stats(reass, &stats, 0);
+	if (stats.no_flow != 1 || death_row_drain(reass) != 1) {
+		printf("table full: wrong result\n");
+		return -1;
+	}
+	mv_ip_reass_expire(reass, ~0ULL);
+	if (death_row_drain(reass) != 2 || bufs_in_use()) {
+		printf("table full: buffers leaked\n");
+		return -1;
+	}
+	mv_ip_reass_destroy(reass);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct mv_ip_reass_params params = {.max_flows = 64, .timeout_ms = IPF_TEST_TIMEOUT_MS,
+					    .death_row_size = 128};
+	struct mv_ip_reass_stats stats;
+	struct mv_ip_reass *reass;
+	int err;
+
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	printf("IP fragmentation/reassembly test:\n");
+
+	srand(argc > 1 ? atoi(argv[1]) : 1);
+
+	err = mv_ip_reass_create(&params, &reass);
+	if (err)
+		return err;
+
+	err = roundtrip_test(reass);
+	mv_ip_reass_get_stats(reass, &stats, 0);
+	if (!err)
+		err = overlap_timeout_test(reass);
+	if (!err)
+		err = oversize_test(reass);
+	if (!err)
+		err = table_full_test();
+	mv_ip_reass_destroy(reass);
+
+	if (err) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("%d datagrams reassembled, %" PRIu64 " duplicates, %" PRIu64 " timeouts\n",
+	       IPF_TEST_ITERATIONS, stats.duplicates, stats.timeouts);
+	printf("PASSED\n");
+	return 0;
+}
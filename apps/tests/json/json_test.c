@@ -0,0 +1,341 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mv_std.h"
+#include "lib/mv_json.h"
+
+#define JSON_TEST_MAX_TOKS	256
+#define JSON_TEST_FUZZ_ITERS	20000
+#define JSON_TEST_BUF_SIZE	1024
+
+#define JSON_CHECK(cond, ...)					\
+	do {							\
+		if (!(cond)) {					\
+			printf("  line %d: ", __LINE__);	\
+			printf(__VA_ARGS__);			\
+			printf("\n");				\
+			err = -1;				\
+		}						\
+	} while (0)
+
+/* NMP config in the json_print_to_buffer() flavour */
+static const char cfg[] =
+	"{\n"
+	"\t\"nmp_params\": {\n"
+	"\t\t\"pp2_en\": 1\n"
+	"\t\t\"bm_pool_reserved_map\": 0x7,\n"
+	"\t\t\"mac\": \"00:50:43:aa:0b:fe\",\n"
+	"\t\t\"name\": \"pf-0\",\n"
+	"\t\t\"bpid\": 3, \"bpid\": 4, \"bpid\": 5,\n"
+	"\t\t\"nested\": {\"bpid\": 9, \"list\": [1, [2, 3], {\"x\": 4},],},\n"
+	"\t\t\"big\": 18446744073709551615,\n"
+	"\t\t\"huge\": 18446744073709551616,\n"
+	"\t\t\"neg\": -1,\n"
+	"\t\t\"on\": true,\n"
+	"\t\t\"esc\": \"a\\\"b\",\n"
+	"\t}\n"
+	"}\n";
+
+/* probe string: starts in the middle of a section and ends with a closer */
+static const char frag[] =
+	"5,\n\t},\n\t\"giu-bpools\": {\n\t\t\"num_pools\": 2,\n\t},\n\t\"pool-0\": 7,\n},\n\"ignored\": 1";
+
+static int test_cfg(void)
+{
+	struct mv_json	json;
+	char		str[8];
+	u8		mac[6];
+	u64		v;
+	u16		u16v;
+	u8		u8v;
+	int		sec, t, n, err = 0;
+
+	if (mv_json_init(&json, cfg)) {
+		printf("  config not parsed\n");
+		return -1;
+	}
+
+	sec = mv_json_find(&json, MV_JSON_ROOT, "nmp_params");
+	JSON_CHECK(sec > 0 && json.toks[sec].type == MV_JSON_T_OBJECT, "nmp_params not found");
+	JSON_CHECK(mv_json_find(&json, MV_JSON_ROOT, "pp2_en") == -ENOENT, "member found in the wrong object");
+	JSON_CHECK(mv_json_lookup(&json, MV_JSON_ROOT, "pp2_en") > 0, "lookup failed");
+
+	JSON_CHECK(!mv_json_obj_get_u64(&json, sec, "pp2_en", &v) && v == 1, "pp2_en");
+	JSON_CHECK(!mv_json_obj_get_u64(&json, sec, "bm_pool_reserved_map", &v) && v == 7, "hex value");
+	JSON_CHECK(!mv_json_obj_get_u64(&json, sec, "big", &v) && v == ~0ULL, "u64 max");
+	JSON_CHECK(mv_json_obj_get_u64(&json, sec, "huge", &v) == -ERANGE, "u64 overflow accepted");
+	JSON_CHECK(mv_json_obj_get_u64(&json, sec, "neg", &v) == -EINVAL, "negative accepted");
+	JSON_CHECK(mv_json_obj_get_u64(&json, sec, "name", &v) == -EINVAL, "string read as number");
+	JSON_CHECK(!mv_json_obj_get_u64(&json, sec, "on", &v) && v == 1, "true");
+	JSON_CHECK(mv_json_obj_get_u64(&json, sec, "missing", &v) == -ENOENT, "missing member");
+
+	u8v = 0x55;
+	JSON_CHECK(mv_json_obj_get_num(&json, sec, "bm_pool_reserved_map", u16v) == 0 && u16v == 7, "u16");
+	JSON_CHECK(mv_json_obj_get_num(&json, sec, "big", u8v) == -ERANGE && u8v == 0x55, "u8 overflow");
+
+	JSON_CHECK(!mv_json_obj_get_str(&json, sec, "name", str, sizeof(str)) && !strcmp(str, "pf-0"), "string");
+	JSON_CHECK(mv_json_obj_get_str(&json, sec, "name", str, 4) == -ENOSPC, "short buffer");
+	JSON_CHECK(!mv_json_obj_get_str(&json, sec, "esc", str, sizeof(str)) && !strcmp(str, "a\\\"b"), "escape");
+	JSON_CHECK(!mv_json_obj_get_mac(&json, sec, "mac", mac) && mac[0] == 0 && mac[5] == 0xfe, "mac");
+	JSON_CHECK(mv_json_obj_get_mac(&json, sec, "name", mac) == -EINVAL, "bad mac accepted");
+
+	/* repeated keys, in document order, without the nested one */
+	n = 0;
+	for (t = mv_json_find_next(&json, sec, "bpid", -1); t >= 0; t = mv_json_find_next(&json, sec, "bpid", t)) {
+		JSON_CHECK(!mv_json_get_u64(&json, t, &v) && v == (u64)(3 + n), "bpid %d", n);
+		n++;
+	}
+	JSON_CHECK(n == 3, "%d bpids found", n);
+
+	/* repeated keys at any depth, in document order */
+	n = 0;
+	for (t = mv_json_lookup_next(&json, sec, "bpid", -1); t >= 0; t = mv_json_lookup_next(&json, sec, "bpid", t))
+		n++;
+	JSON_CHECK(n == 4, "%d bpids looked up", n);
+	JSON_CHECK(!mv_json_get_u64(&json, mv_json_lookup_next(&json, sec, "bpid", mv_json_find(&json, sec, "bpid")),
+				    &v) && v == 4, "lookup resumed at the wrong token");
+
+	t = mv_json_lookup(&json, sec, "list");
+	JSON_CHECK(t > 0 && json.toks[t].type == MV_JSON_T_ARRAY && json.toks[t].size == 3, "array");
+	t = mv_json_lookup(&json, sec, "x");
+	JSON_CHECK(t > 0 && !mv_json_get_u64(&json, t, &v) && v == 4, "object in array");
+
+	mv_json_deinit(&json);
+	return err;
+}
+
+static int test_frag(void)
+{
+	struct mv_json	json;
+	u64		v;
+	int		t, err = 0;
+
+	if (mv_json_init(&json, frag)) {
+		printf("  fragment not parsed\n");
+		return -1;
+	}
+	t = mv_json_lookup(&json, MV_JSON_ROOT, "giu-bpools");
+	JSON_CHECK(t > 0 && !mv_json_obj_get_u64(&json, t, "num_pools", &v) && v == 2, "fragment section");
+	JSON_CHECK(!mv_json_obj_get_u64(&json, MV_JSON_ROOT, "pool-0", &v) && v == 7, "fragment member");
+	JSON_CHECK(mv_json_lookup(&json, MV_JSON_ROOT, "ignored") == -ENOENT, "parsed past the closer");
+	mv_json_deinit(&json);
+	return err;
+}
+
+static int test_errors(void)
+{
+	struct mv_json		json;
+	struct mv_json_tok	toks[4];
+	char			buf[2 * MV_JSON_MAX_DEPTH + 8];
+	int			i, err = 0;
+
+	JSON_CHECK(mv_json_parse(&json, "{\n  \"a\": 1,\n  \"b\" 2\n}", 22, NULL, 0) == -EINVAL &&
+		   json.err_line == 3, "error line %u", json.err_line);
+	JSON_CHECK(mv_json_parse(&json, "{\"a\": \"open", 11, NULL, 0) == -EINVAL, "unterminated string");
+	JSON_CHECK(mv_json_parse(&json, "{\"a\": [1, 2}", 12, NULL, 0) == -EINVAL, "mismatched closer");
+	JSON_CHECK(mv_json_parse(&json, "{\"a\": 1} x", 10, NULL, 0) == -EINVAL, "trailing data");
+	JSON_CHECK(mv_json_parse(&json, "{\"a\": 1, \"b\": 2}", 16, toks, 4) == -ENOMEM, "token overflow");
+	JSON_CHECK(mv_json_parse(&json, "{\"a\": 1}", 8, toks, 4) == 0 && json.num_toks == 3, "exact fit");
+
+	/* nesting limit */
+	for (i = 0; i < MV_JSON_MAX_DEPTH; i++)
+		buf[i] = '[';
+	for (i = 0; i < MV_JSON_MAX_DEPTH; i++)
+		buf[MV_JSON_MAX_DEPTH + i] = ']';
+	buf[2 * MV_JSON_MAX_DEPTH] = 0;
+	JSON_CHECK(mv_json_parse(&json, buf, strlen(buf), NULL, 0) == 0, "max depth rejected");
+	memmove(buf + 1, buf, strlen(buf) + 1);
+	buf[0] = '[';
+	strcat(buf, "]");
+	JSON_CHECK(mv_json_parse(&json, buf, strlen(buf), NULL, 0) == -EINVAL, "depth limit not enforced");
+	return err;
+}
+
+/* the tokens of a successful parse must stay inside the buffer and the tree */
+static int check_toks(const struct mv_json *json)
+{
+	u32 i;
+
+	for (i = 0; i < json->num_toks; i++) {
+		const struct mv_json_tok *tok = &json->toks[i];
+
+		if (tok->type == MV_JSON_T_NONE || tok->start + tok->len > json->len ||
+		    tok->skip <= i || tok->skip > json->num_toks)
+			return -1;
+	}
+	return 0;
+}
+
+static int test_fuzz(void)
+{
+	const char		*seeds[] = {cfg, frag};
+	struct mv_json_tok	toks[JSON_TEST_MAX_TOKS];
+	struct mv_json		json;
+	char			buf[JSON_TEST_BUF_SIZE];
+	unsigned int		seed = 1;
+	u32			len, cnt;
+	int			i, j, rc, ok = 0, err = 0;
+
+	for (i = 0; i < JSON_TEST_FUZZ_ITERS; i++) {
+		const char *s = seeds[i % ARRAY_SIZE(seeds)];
+
+		len = strlen(s);
+		memcpy(buf, s, len);
+		for (j = 1 + rand_r(&seed) % 4; j; j--) {
+			u32 pos = rand_r(&seed) % len;
+
+			switch (rand_r(&seed) % 4) {
+			case 0:
+				buf[pos] ^= 1 << (rand_r(&seed) % 8);
+				break;
+			case 1:
+				len = pos + 1;
+				break;
+			case 2:
+				if (len < sizeof(buf)) {
+					memmove(buf + pos + 1, buf + pos, len - pos);
+					buf[pos] = "{}[]\",:"[rand_r(&seed) % 7];
+					len++;
+				}
+				break;
+			default:
+				buf[pos] = rand_r(&seed) & 0xff;
+			}
+		}
+
+		/* the count pass must agree with the real one */
+		rc = mv_json_parse(&json, buf, len, NULL, 0);
+		cnt = json.num_toks;
+		if (mv_json_parse(&json, buf, len, toks, JSON_TEST_MAX_TOKS) != rc ||
+		    (!rc && json.num_toks != cnt)) {
+			printf("  iteration %d: count pass mismatch\n", i);
+			return -1;
+		}
+		if (rc)
+			continue;
+		ok++;
+		JSON_CHECK(!check_toks(&json), "iteration %d: bad token", i);
+		mv_json_lookup(&json, MV_JSON_ROOT, "bpid");
+		if (err)
+			return err;
+	}
+	printf("  fuzz: %d inputs, %d parsed\n", JSON_TEST_FUZZ_ITERS, ok);
+	return err;
+}
+
+int main(int argc, char *argv[])
+{
+	int err = 0;
+
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	printf("JSON parser test:\n");
+
+	err |= test_cfg();
+	err |= test_frag();
+	err |= test_errors();
+	err |= test_fuzz();
+
+	if (err) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
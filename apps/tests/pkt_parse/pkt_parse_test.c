@@ -0,0 +1,500 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "mv_std.h"
+#include "pkt_parse.h"
+
+#define PP_BUF_SIZE		256
+#define PP_NUM_BUFS		64
+#define PP_PKT_OFFS		(64 + MV_MH_SIZE)	/* Buffer offset used for the adapters */
+#define PP_COOKIE_MASK		0xffffffffffULL		/* 40-bit cookies (pp2/giu) */
+
+#define PP_CHECK(cond, ...)			\
+	do {					\
+		if (!(cond)) {			\
+			printf(__VA_ARGS__);	\
+			return -1;		\
+		}				\
+	} while (0)
+
+static u8 pp_pool[PP_NUM_BUFS][PP_BUF_SIZE] __attribute__((aligned(64)));
+
+static const u8 pp_v6_src[16] = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01};
+static const u8 pp_v6_dst[16] = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02};
+
+static u8 *pp_put16(u8 *p, u16 v)
+{
+	p[0] = v >> 8;
+	p[1] = v & 0xff;
+	return p + 2;
+}
+
+static u8 *pp_put32(u8 *p, u32 v)
+{
+	p = pp_put16(p, v >> 16);
+	return pp_put16(p, v & 0xffff);
+}
+
+/* Ethernet header followed by 'num_vlans' tags; returns the L3 header */
+static u8 *pp_build_l2(u8 *p, int num_vlans, u16 eth_type)
+{
+	memset(p, 0x11, MV_ETH_ALEN * 2);
+	p += MV_ETH_ALEN * 2;
+	if (num_vlans == 2) {
+		p = pp_put16(p, 0x88a8);
+		p = pp_put16(p, 100);
+	}
+	if (num_vlans >= 1) {
+		p = pp_put16(p, 0x8100);
+		p = pp_put16(p, num_vlans == 2 ? 200 : 100);
+	}
+	return pp_put16(p, eth_type);
+}
+
+static u8 *pp_build_ipv4(u8 *p, u8 proto, u8 ihl, u16 frag_off, u32 sip, u32 dip)
+{
+	memset(p, 0, ihl * 4);
+	p[0] = 0x40 | ihl;
+	p[8] = 64;
+	p[9] = proto;
+	pp_put16(&p[6], frag_off);
+	pp_put32(&p[12], sip);
+	pp_put32(&p[16], dip);
+	return p + ihl * 4;
+}
+
+static u8 *pp_build_ipv6(u8 *p, u8 nexthdr)
+{
+	memset(p, 0, 40);
+	p[0] = 0x60;
+	p[6] = nexthdr;
+	p[7] = 64;
+	memcpy(&p[8], pp_v6_src, 16);
+	memcpy(&p[24], pp_v6_dst, 16);
+	return p + 40;
+}
+
+static u8 *pp_build_ports(u8 *p, u16 sport, u16 dport)
+{
+	p = pp_put16(p, sport);
+	p = pp_put16(p, dport);
+	memset(p, 0, 16);
+	return p + 16;
+}
+
+static int pp_parse(u8 *buf, u8 *end, struct pkt_parse_info *info)
+{
+	info->data = (char *)buf;
+	info->len = end - buf;
+	return pkt_parse_one(info, PKT_PARSE_F_HASH);
+}
+
+static int test_ipv4(void)
+{
+	struct pkt_parse_info info;
+	u8 *buf = pp_pool[0], *p;
+	int vlans;
+
+	for (vlans = 0; vlans <= 2; vlans++) {
+		p = pp_build_l2(buf, vlans, 0x0800);
+		p = pp_build_ipv4(p, 6, 5, 0x4000, 0x0a000001, 0xc0a80102);
+		p = pp_build_ports(p, 1234, 80);
+		PP_CHECK(!pp_parse(buf, p, &info), "ipv4/tcp (%d vlans) not parsed\n", vlans);
+		PP_CHECK(info.num_vlans == vlans, "bad num_vlans %d\n", info.num_vlans);
+		PP_CHECK(!vlans || info.vlan_id == 100, "bad vlan id %d\n", info.vlan_id);
+		PP_CHECK(info.l3_type == PKT_PARSE_L3_TYPE_IPV4 && info.l4_type == PKT_PARSE_L4_TYPE_TCP,
+			 "bad types %d/%d\n", info.l3_type, info.l4_type);
+		PP_CHECK(info.l3_offset == MV_ETH_HLEN + vlans * MV_VLAN_TAG_LEN, "bad l3 offset %d\n",
+			 info.l3_offset);
+		PP_CHECK(info.l4_offset == info.l3_offset + 20, "bad l4 offset %d\n", info.l4_offset);
+		PP_CHECK(info.tuple.ip_ver == 4 && info.tuple.proto == 6 &&
+			 info.tuple.src.v4 == 0x0a000001 && info.tuple.dst.v4 == 0xc0a80102 &&
+			 info.tuple.sport == 1234 && info.tuple.dport == 80, "bad ipv4 tuple\n");
+		PP_CHECK(info.hash == pkt_parse_tuple_hash(&info.tuple), "bad hash\n");
+	}
+
+	/* IPv4 with options, UDP */
+	p = pp_build_l2(buf, 0, 0x0800);
+	p = pp_build_ipv4(p, 17, 7, 0, 0x01020304, 0x05060708);
+	p = pp_build_ports(p, 53, 5353);
+	PP_CHECK(!pp_parse(buf, p, &info), "ipv4 options not parsed\n");
+	PP_CHECK(info.l4_type == PKT_PARSE_L4_TYPE_UDP && info.l4_offset == MV_ETH_HLEN + 28,
+		 "bad l4 with ipv4 options: %d/%d\n", info.l4_type, info.l4_offset);
+	PP_CHECK(info.tuple.sport == 53 && info.tuple.dport == 5353, "bad udp ports\n");
+
+	/* Non-first fragment has no L4 header */
+	p = pp_build_l2(buf, 0, 0x0800);
+	p = pp_build_ipv4(p, 17, 5, 0x20 | 0x2000, 0x01020304, 0x05060708);
+	p = pp_build_ports(p, 53, 5353);
+	PP_CHECK(!pp_parse(buf, p, &info), "ipv4 fragment not parsed\n");
+	PP_CHECK(info.l4_type == PKT_PARSE_L4_TYPE_NA && !info.tuple.sport && !info.tuple.dport,
+		 "ports taken from a non-first fragment\n");
+
+	/* ICMP */
+	p = pp_build_l2(buf, 0, 0x0800);
+	p = pp_build_ipv4(p, 1, 5, 0, 0x01020304, 0x05060708);
+	p = pp_build_ports(p, 0x0800, 0);
+	PP_CHECK(!pp_parse(buf, p, &info), "icmp not parsed\n");
+	PP_CHECK(info.l4_type == PKT_PARSE_L4_TYPE_OTHER && !info.tuple.sport, "bad icmp parse\n");
+	return 0;
+}
+
+static int test_ipv6(void)
+{
+	struct pkt_parse_info info;
+	u8 *buf = pp_pool[0], *p, *ext;
+
+	p = pp_build_l2(buf, 1, 0x86dd);
+	p = pp_build_ipv6(p, 17);
+	p = pp_build_ports(p, 4000, 4001);
+	PP_CHECK(!pp_parse(buf, p, &info), "ipv6/udp not parsed\n");
+	PP_CHECK(info.l3_type == PKT_PARSE_L3_TYPE_IPV6 && info.l4_type == PKT_PARSE_L4_TYPE_UDP,
+		 "bad ipv6 types\n");
+	PP_CHECK(info.l3_offset == 18 && info.l4_offset == 58, "bad ipv6 offsets %d/%d\n",
+		 info.l3_offset, info.l4_offset);
+	PP_CHECK(!memcmp(info.tuple.src.v6, pp_v6_src, 16) && !memcmp(info.tuple.dst.v6, pp_v6_dst, 16) &&
+		 info.tuple.sport == 4000 && info.tuple.dport == 4001 && info.tuple.ip_ver == 6,
+		 "bad ipv6 tuple\n");
+
+	/* Hop-by-hop (16 bytes) followed by TCP */
+	p = pp_build_l2(buf, 0, 0x86dd);
+	ext = pp_build_ipv6(p, 0);
+	memset(ext, 0, 16);
+	ext[0] = 6;
+	ext[1] = 1;
+	p = pp_build_ports(ext + 16, 22, 2222);
+	PP_CHECK(!pp_parse(buf, p, &info), "ipv6 with ext not parsed\n");
+	PP_CHECK(info.l4_type == PKT_PARSE_L4_TYPE_TCP && info.l4_offset == MV_ETH_HLEN + 56 &&
+		 info.tuple.proto == 6 && info.tuple.sport == 22, "bad ipv6 ext parse\n");
+
+	/* Non-first fragment */
+	p = pp_build_l2(buf, 0, 0x86dd);
+	ext = pp_build_ipv6(p, 44);
+	memset(ext, 0, 8);
+	ext[0] = 17;
+	pp_put16(&ext[2], 0x100);
+	p = pp_build_ports(ext + 8, 1, 2);
+	PP_CHECK(!pp_parse(buf, p, &info), "ipv6 fragment not parsed\n");
+	PP_CHECK(info.l4_type == PKT_PARSE_L4_TYPE_NA && info.tuple.proto == 17 && !info.tuple.sport,
+		 "ports taken from a non-first ipv6 fragment\n");
+	return 0;
+}
+
+static int test_other(void)
+{
+	struct pkt_parse_info info;
+	u8 *buf = pp_pool[0], *p, *l3;
+
+	/* ARP */
+	p = pp_build_l2(buf, 0, 0x0806);
+	memset(p, 0, 28);
+	PP_CHECK(pp_parse(buf, p + 28, &info) && info.l3_type == PKT_PARSE_L3_TYPE_ARP &&
+		 info.eth_type == 0x0806, "bad arp parse\n");
+
+	/* Unknown ethertype */
+	p = pp_build_l2(buf, 1, 0x88cc);
+	PP_CHECK(pp_parse(buf, p + 32, &info) && info.l3_type == PKT_PARSE_L3_TYPE_OTHER &&
+		 info.num_vlans == 1, "bad lldp parse\n");
+
+	/* Bad IP version */
+	p = pp_build_l2(buf, 0, 0x0800);
+	l3 = p;
+	p = pp_build_ipv4(p, 6, 5, 0, 1, 2);
+	l3[0] = 0x65;
+	PP_CHECK(pp_parse(buf, p + 20, &info) && info.l3_type == PKT_PARSE_L3_TYPE_NA,
+		 "bad ip version accepted\n");
+
+	/* IHL smaller than 5 */
+	l3[0] = 0x44;
+	PP_CHECK(pp_parse(buf, p + 20, &info), "short ihl accepted\n");
+
+	/* Truncations: every prefix of a valid packet must be handled */
+	p = pp_build_l2(buf, 2, 0x0800);
+	p = pp_build_ipv4(p, 6, 6, 0, 1, 2);
+	p = pp_build_ports(p, 10, 20);
+	for (l3 = buf; l3 < p; l3++) {
+		int err = pp_parse(buf, l3, &info);
+
+		if (l3 - buf < 22 + 24)
+			PP_CHECK(err && info.l3_type != PKT_PARSE_L3_TYPE_IPV4,
+				 "truncated ipv4 (%d) accepted\n", (int)(l3 - buf));
+		else if (l3 - buf < 22 + 24 + 4)
+			PP_CHECK(!err && info.l4_type == PKT_PARSE_L4_TYPE_NA && !info.tuple.sport,
+				 "truncated tcp (%d) parsed\n", (int)(l3 - buf));
+		else
+			PP_CHECK(!err && info.tuple.dport == 20, "full packet (%d) not parsed\n",
+				 (int)(l3 - buf));
+	}
+
+	p = pp_build_l2(buf, 0, 0x86dd);
+	p = pp_build_ipv6(p, 60);
+	memset(p, 0, 8);
+	p[0] = 17;
+	p[1] = 2;	/* 24 bytes, but only 8 are present */
+	PP_CHECK(!pp_parse(buf, p + 8, &info) && info.l4_type == PKT_PARSE_L4_TYPE_NA,
+		 "truncated ipv6 ext header parsed\n");
+	return 0;
+}
+
+static int test_hash(void)
+{
+	struct pkt_parse_info a, b;
+	u8 *buf = pp_pool[0], *p;
+
+	p = pp_build_l2(buf, 0, 0x0800);
+	p = pp_build_ipv4(p, 17, 5, 0, 0x0a000001, 0x0a000002);
+	p = pp_build_ports(p, 1000, 2000);
+	PP_CHECK(!pp_parse(buf, p, &a), "parse failed\n");
+
+	/* Same flow behind a VLAN tag */
+	p = pp_build_l2(buf, 1, 0x0800);
+	p = pp_build_ipv4(p, 17, 5, 0, 0x0a000001, 0x0a000002);
+	p = pp_build_ports(p, 1000, 2000);
+	PP_CHECK(!pp_parse(buf, p, &b), "parse failed\n");
+	PP_CHECK(a.hash == b.hash, "vlan changed the flow hash\n");
+
+	/* Swapped ports are a different flow */
+	p = pp_build_l2(buf, 0, 0x0800);
+	p = pp_build_ipv4(p, 17, 5, 0, 0x0a000001, 0x0a000002);
+	p = pp_build_ports(p, 2000, 1000);
+	PP_CHECK(!pp_parse(buf, p, &b), "parse failed\n");
+	PP_CHECK(a.hash != b.hash, "hash ignores the ports order\n");
+	return 0;
+}
+
+/* Build a mix of packets in the pool; returns the expected result of packet i */
+static u16 pp_build_mix(int i, u16 offs, int *is_ip)
+{
+	u8 *buf = pp_pool[i] + offs, *p;
+
+	switch (i % 4) {
+	case 0:
+		p = pp_build_l2(buf, 0, 0x0800);
+		p = pp_build_ipv4(p, 6, 5, 0, 0x0a000000 + i, 0x0b000000);
+		p = pp_build_ports(p, i, 80);
+		break;
+	case 1:
+		p = pp_build_l2(buf, 1, 0x86dd);
+		p = pp_build_ipv6(p, 17);
+		p = pp_build_ports(p, i, 53);
+		break;
+	case 2:
+		p = pp_build_l2(buf, 2, 0x0800);
+		p = pp_build_ipv4(p, 17, 5, 0, 0x0a000000 + i, 0x0b000000);
+		p = pp_build_ports(p, i, 4789);
+		break;
+	default:
+		p = pp_build_l2(buf, 0, 0x0806);
+		memset(p, 0, 28);
+		p += 28;
+		*is_ip = 0;
+		return p - buf;
+	}
+	*is_ip = 1;
+	return p - buf;
+}
+
+static int pp_check_mix(struct pkt_parse_info *info, int num, u16 offs)
+{
+	struct pkt_parse_info ref;
+	int i, is_ip;
+
+	for (i = 0; i < num; i++) {
+		ref.len = pp_build_mix(i, offs, &is_ip);
+		ref.data = (char *)pp_pool[i] + offs;
+		pkt_parse_one(&ref, PKT_PARSE_F_HASH);
+		PP_CHECK(info[i].data == ref.data && info[i].len == ref.len,
+			 "packet %d: bad buffer %p/%d\n", i, info[i].data, info[i].len);
+		PP_CHECK(info[i].l3_type == ref.l3_type && info[i].l4_type == ref.l4_type &&
+			 info[i].l3_offset == ref.l3_offset && info[i].l4_offset == ref.l4_offset &&
+			 info[i].hash == ref.hash && !memcmp(&info[i].tuple, &ref.tuple, sizeof(ref.tuple)),
+			 "packet %d: burst and single parse differ\n", i);
+		PP_CHECK(!is_ip || info[i].tuple.sport == i, "packet %d: bad sport\n", i);
+	}
+	return 0;
+}
+
+static int test_burst(void)
+{
+	struct pkt_parse_info info[PP_NUM_BUFS];
+	struct pp2_ppio_desc pp2_descs[PP_NUM_BUFS];
+	struct neta_ppio_desc neta_descs[PP_NUM_BUFS];
+	struct giu_gpio_desc giu_descs[PP_NUM_BUFS];
+	uintptr_t high = (uintptr_t)pp_pool & ~(uintptr_t)PP_COOKIE_MASK;
+	uintptr_t neta_high = (uintptr_t)pp_pool & ~(uintptr_t)0xffffffff;
+	int shifts[] = {0, 1, 4, PP_NUM_BUFS + 1};
+	int i, s, num, cnt, is_ip, exp_ip = 0;
+	u16 len;
+
+	memset(info, 0, sizeof(info));
+	for (i = 0; i < PP_NUM_BUFS; i++) {
+		uintptr_t addr = (uintptr_t)pp_pool[i];
+
+		len = pp_build_mix(i, PP_PKT_OFFS, &is_ip);
+		exp_ip += is_ip;
+
+		memset(&pp2_descs[i], 0, sizeof(pp2_descs[i]));
+		pp2_descs[i].cmds[1] = (u32)(len + MV_MH_SIZE) << 16;
+		pp2_descs[i].cmds[6] = (u32)addr;
+		pp2_descs[i].cmds[7] = (u32)((u64)addr >> 32) & 0xff;
+
+		memset(&neta_descs[i], 0, sizeof(neta_descs[i]));
+		neta_descs[i].cmds[1] = (u32)(len + MV_MH_SIZE + NETA_ETH_FCS_LEN) << 16;
+		neta_descs[i].cmds[4] = (u32)addr;
+
+		memset(&giu_descs[i], 0, sizeof(giu_descs[i]));
+		giu_descs[i].cmds[1] = (u32)len << 16;
+		giu_descs[i].cmds[6] = (u32)addr;
+		giu_descs[i].cmds[7] = (u32)((u64)addr >> 32) & 0xff;
+	}
+
+	for (s = 0; s < ARRAY_SIZE(shifts); s++) {
+		for (num = 0; num <= PP_NUM_BUFS; num += 7) {
+			int n_ip = 0;
+
+			for (i = 0; i < num; i++)
+				n_ip += (i % 4) != 3;
+
+			cnt = pkt_parse_pp2_burst(pp2_descs, num, high, PP_PKT_OFFS, info, shifts[s],
+						  PKT_PARSE_F_HASH);
+			PP_CHECK(cnt == n_ip, "pp2 burst of %d: %d IP packets\n", num, cnt);
+			if (pp_check_mix(info, num, PP_PKT_OFFS))
+				return -1;
+
+			cnt = pkt_parse_giu_burst(giu_descs, num, high, PP_PKT_OFFS, info, shifts[s],
+						  PKT_PARSE_F_HASH);
+			PP_CHECK(cnt == n_ip, "giu burst of %d: %d IP packets\n", num, cnt);
+			if (pp_check_mix(info, num, PP_PKT_OFFS))
+				return -1;
+
+			/* neta cookies are 32-bit; skip if the pool crosses a 4GB boundary */
+			if ((((uintptr_t)pp_pool + sizeof(pp_pool) - 1) & ~(uintptr_t)0xffffffff) != neta_high)
+				continue;
+			cnt = pkt_parse_neta_burst(neta_descs, num, neta_high, PP_PKT_OFFS, info, shifts[s],
+						   PKT_PARSE_F_HASH);
+			PP_CHECK(cnt == n_ip, "neta burst of %d: %d IP packets\n", num, cnt);
+			if (pp_check_mix(info, num, PP_PKT_OFFS))
+				return -1;
+		}
+	}
+	PP_CHECK(exp_ip == PP_NUM_BUFS - PP_NUM_BUFS / 4, "bad packet mix\n");
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int err = 0;
+
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	printf("Burst packet parsing test:\n");
+
+	err |= test_ipv4();
+	err |= test_ipv6();
+	err |= test_other();
+	err |= test_hash();
+	err |= test_burst();
+	if (err) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
@@ -0,0 +1,394 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+/*
+ * Unit test of the per-HIF bpool buffer cache, against a fake BM that
+ * counts the register accesses the buffers would have cost.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mv_std.h"
+#include "drivers/mv_pp2_bpool.h"
+
+/* fake BM backend */
+static int fake_bm_get(struct pp2_hif *hif, struct pp2_bpool *pool, struct pp2_buff_inf *buff);
+static int fake_bm_put(struct pp2_hif *hif, struct buff_release_entry entries[], u16 *num);
+#define pp2_bpool_cache_hw_get(hif, pool, buff)		fake_bm_get(hif, pool, buff)
+#define pp2_bpool_cache_hw_put(hif, entries, num)	fake_bm_put(hif, entries, num)
+
+#include "pp2_bpool_cache.h"
+
+#define TEST_NUM_BUFFS		1024
+#define TEST_BUFF_SIZE		2048
+#define TEST_PHYS_BASE		0x40000000
+/* Register accesses of a direct pp2_bpool_get_buff() / pp2_bpool_put_buff() */
+#define TEST_DIRECT_GET_REGS	3
+#define TEST_DIRECT_PUT_REGS	3
+
+struct fake_bm {
+	u64	cookies[TEST_NUM_BUFFS];
+	u32	num;
+	u64	regs;		/* register accesses */
+	int	err;
+};
+
+static struct fake_bm bm;
+static struct pp2_bpool test_pool = { .pp2_id = 0, .id = 3 };
+static struct pp2_hif *test_hif = (struct pp2_hif *)&bm;
+/* Buffers held by the test "application" */
+static u8 owned[TEST_NUM_BUFFS];
+
+static int fake_bm_get(struct pp2_hif *hif, struct pp2_bpool *pool, struct pp2_buff_inf *buff)
+{
+	if (hif != test_hif || pool != &test_pool) {
+		pr_err("bad hif/pool on get\n");
+		bm.err = 1;
+	}
+	bm.regs++;
+	if (!bm.num)
+		return -ENOBUFS;
+	bm.regs += 2;
+	buff->cookie = bm.cookies[--bm.num];
+	buff->addr = TEST_PHYS_BASE + buff->cookie * TEST_BUFF_SIZE;
+	return 0;
+}
+
+static int fake_bm_put(struct pp2_hif *hif, struct buff_release_entry entries[], u16 *num)
+{
+	u16 i;
+
+	if (hif != test_hif || !*num || *num > PP2_MAX_NUM_PUT_BUFFS) {
+		pr_err("bad release burst of %u\n", *num);
+		bm.err = 1;
+		return -EINVAL;
+	}
+	/* One loopback TXQ update per burst */
+	bm.regs++;
+	for (i = 0; i < *num; i++) {
+		if (entries[i].bpool != &test_pool ||
+		    entries[i].buff.addr != TEST_PHYS_BASE + entries[i].buff.cookie * TEST_BUFF_SIZE ||
+		    bm.num == TEST_NUM_BUFFS) {
+			pr_err("bad released buffer %llu\n", (unsigned long long)entries[i].buff.cookie);
+			bm.err = 1;
+			return -EINVAL;
+		}
+		bm.cookies[bm.num++] = entries[i].buff.cookie;
+	}
+	return 0;
+}
+
+static void fake_bm_init(u32 num)
+{
+	u32 i;
+
+	memset(&bm, 0, sizeof(bm));
+	memset(owned, 0, sizeof(owned));
+	for (i = 0; i < num; i++)
+		bm.cookies[bm.num++] = i;
+}
+
+static int cache_init(struct pp2_bpool_cache *cache, u16 low_wm, u16 high_wm)
+{
+	memset(cache, 0, sizeof(*cache));
+	cache->hif = test_hif;
+	cache->pool = &test_pool;
+	cache->low_wm = low_wm;
+	cache->high_wm = high_wm;
+	cache->entries = calloc(high_wm, sizeof(struct buff_release_entry));
+	return cache->entries ? 0 : -ENOMEM;
+}
+
+static int app_get(struct pp2_bpool_cache *cache, u64 *cookie)
+{
+	struct pp2_buff_inf buff;
+	int err;
+
+	err = pp2_bpool_cache_get(cache, &buff);
+	if (err)
+		return err;
+	if (buff.cookie >= TEST_NUM_BUFFS || owned[buff.cookie] ||
+	    buff.addr != TEST_PHYS_BASE + buff.cookie * TEST_BUFF_SIZE) {
+		pr_err("bad or duplicate buffer %llu\n", (unsigned long long)buff.cookie);
+		return -EFAULT;
+	}
+	owned[buff.cookie] = 1;
+	*cookie = buff.cookie;
+	return 0;
+}
+
+static void app_put(struct pp2_bpool_cache *cache, u64 cookie)
+{
+	struct pp2_buff_inf buff;
+
+	owned[cookie] = 0;
+	buff.cookie = cookie;
+	buff.addr = TEST_PHYS_BASE + cookie * TEST_BUFF_SIZE;
+	pp2_bpool_cache_put(cache, &buff);
+}
+
+/* All the buffers are in the BM, the cache or owned by the application */
+static int check_conservation(struct pp2_bpool_cache *cache, u32 total)
+{
+	u32 i, num_owned = 0;
+
+	for (i = 0; i < TEST_NUM_BUFFS; i++)
+		num_owned += owned[i];
+	if (bm.err || bm.num + cache->num + num_owned != total || cache->num > cache->high_wm) {
+		pr_err("buffers lost: BM %u, cache %u, owned %u, total %u\n", bm.num, cache->num, num_owned, total);
+		return -1;
+	}
+	return 0;
+}
+
+static int test_recycle(void)
+{
+	struct pp2_bpool_cache cache;
+	u64 cookies[32], regs;
+	int i, j;
+
+	fake_bm_init(TEST_NUM_BUFFS);
+	if (cache_init(&cache, 32, 128))
+		return -1;
+
+	/* Bursts of 32 buffers allocated and freed in software */
+	for (i = 0; i < 10000; i++) {
+		for (j = 0; j < 32; j++)
+			if (app_get(&cache, &cookies[j]))
+				return -1;
+		for (j = 0; j < 32; j++)
+			app_put(&cache, cookies[j]);
+		if (i == 0)
+			regs = bm.regs;
+	}
+	if (check_conservation(&cache, TEST_NUM_BUFFS))
+		return -1;
+	if (bm.regs != regs) {
+		pr_err("recycled buffers reached the BM (%llu register accesses)\n",
+		       (unsigned long long)(bm.regs - regs));
+		return -1;
+	}
+	printf("  recycle loop: %llu register accesses instead of %u (hits %llu of %llu)\n",
+	       (unsigned long long)bm.regs, 10000 * 32 * (TEST_DIRECT_GET_REGS + TEST_DIRECT_PUT_REGS),
+	       (unsigned long long)cache.stats.hits, (unsigned long long)cache.stats.gets);
+	free(cache.entries);
+	return 0;
+}
+
+static int test_watermarks(void)
+{
+	struct pp2_bpool_cache cache;
+	u64 cookies[300];
+	int i;
+
+	fake_bm_init(TEST_NUM_BUFFS);
+	if (cache_init(&cache, 32, 128))
+		return -1;
+
+	for (i = 0; i < 300; i++)
+		if (app_get(&cache, &cookies[i]))
+			return -1;
+	/* Filled up to the low watermark on each empty get */
+	if (cache.stats.fills != 10 || cache.stats.filled_buffs != 320 || cache.num != 20) {
+		pr_err("bad fills: %llu fills, %llu buffers, %u cached\n", (unsigned long long)cache.stats.fills,
+		       (unsigned long long)cache.stats.filled_buffs, cache.num);
+		return -1;
+	}
+	for (i = 0; i < 300; i++) {
+		app_put(&cache, cookies[i]);
+		if (cache.num > cache.high_wm)
+			return -1;
+	}
+	/* 20 cached + 300 puts: spilled down to 32 on each put to a full cache */
+	if (cache.stats.spills != 2 || cache.stats.spilled_buffs != 192 || cache.num != 128) {
+		pr_err("bad spills: %llu spills, %llu buffers, %u cached\n", (unsigned long long)cache.stats.spills,
+		       (unsigned long long)cache.stats.spilled_buffs, cache.num);
+		return -1;
+	}
+	if (check_conservation(&cache, TEST_NUM_BUFFS))
+		return -1;
+
+	/* Flush on shutdown */
+	pp2_bpool_cache_spill(&cache, 0);
+	if (cache.num || bm.num != TEST_NUM_BUFFS) {
+		pr_err("flush left %u buffers in the cache\n", cache.num);
+		return -1;
+	}
+	printf("  watermarks: %llu fills, %llu spills of %llu buffers\n", (unsigned long long)cache.stats.fills,
+	       (unsigned long long)cache.stats.spills, (unsigned long long)cache.stats.spilled_buffs);
+	free(cache.entries);
+	return 0;
+}
+
+static int test_empty_bm(void)
+{
+	struct pp2_bpool_cache cache;
+	u64 cookies[8];
+	int i;
+
+	fake_bm_init(5);
+	if (cache_init(&cache, 4, 16))
+		return -1;
+
+	for (i = 0; i < 5; i++)
+		if (app_get(&cache, &cookies[i]))
+			return -1;
+	if (app_get(&cache, &cookies[5]) != -ENOBUFS || cache.stats.empty != 1) {
+		pr_err("empty pool not reported\n");
+		return -1;
+	}
+	/* A partial fill is used */
+	app_put(&cache, cookies[0]);
+	if (app_get(&cache, &cookies[0]) || check_conservation(&cache, 5))
+		return -1;
+	printf("  empty pool\n");
+	free(cache.entries);
+	return 0;
+}
+
+/* Random gets/puts; checks no buffer is lost or handed out twice */
+static int test_random(void)
+{
+	struct pp2_bpool_cache cache;
+	u64 cookies[TEST_NUM_BUFFS];
+	u32 held = 0, i;
+	int err;
+
+	fake_bm_init(TEST_NUM_BUFFS);
+	if (cache_init(&cache, 16, 256))
+		return -1;
+
+	for (i = 0; i < 200000; i++) {
+		if (held && (rand() % 2)) {
+			u32 idx = rand() % held;
+
+			app_put(&cache, cookies[idx]);
+			cookies[idx] = cookies[--held];
+		} else {
+			err = app_get(&cache, &cookies[held]);
+			if (err == -ENOBUFS)
+				continue;
+			if (err)
+				return -1;
+			held++;
+		}
+		if (!(i % 1000) && check_conservation(&cache, TEST_NUM_BUFFS))
+			return -1;
+	}
+	while (held)
+		app_put(&cache, cookies[--held]);
+	pp2_bpool_cache_spill(&cache, 0);
+	if (check_conservation(&cache, TEST_NUM_BUFFS) || bm.num != TEST_NUM_BUFFS)
+		return -1;
+	printf("  random: hit rate %llu%%\n", (unsigned long long)(cache.stats.hits * 100 / cache.stats.gets));
+	free(cache.entries);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	srand(1);
+
+	if (test_recycle() || test_watermarks() || test_empty_bm() || test_random()) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
@@ -0,0 +1,318 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+/*
+ * Unit test of the burst Tx-done buffer recycle path of the apps' Tx shadow
+ * queues (free_sent_buffers() in MVAPPS_PP2_BUFF_RELEASE_BURST mode), with
+ * fake BM release and Tx-done counter backends.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mv_std.h"
+#include "mv_pp2_hif.h"
+#include "mv_pp2_ppio.h"
+#include "mv_pp2_bpool.h"
+
+/* fake backends, see below */
+static int fake_put_buffs(struct pp2_hif *hif, struct buff_release_entry buff_entry[], u16 *num);
+static int fake_get_num_outq_done(struct pp2_ppio *ppio, struct pp2_hif *hif, u8 tc, u16 *num);
+#define app_pp2_bpool_put_buffs		fake_put_buffs
+#define app_pp2_get_num_outq_done	fake_get_num_outq_done
+
+#include "mvapp.h"
+#include "pp2_utils.h"
+
+#define TEST_NUM_POOLS		3
+#define TEST_MAX_BUFFS		(64 * 1024)
+#define TEST_ROUNDS		20000
+
+#define RCL_CHECK(cond, ...)			\
+	do {					\
+		if (!(cond)) {			\
+			printf(__VA_ARGS__);	\
+			return -1;		\
+		}				\
+	} while (0)
+
+struct fake_bm {
+	struct pp2_bpool	pools[TEST_NUM_POOLS];
+	u8			pool_of[TEST_MAX_BUFFS];	/* pool each buffer was taken from */
+	u8			in_flight[TEST_MAX_BUFFS];
+	u64			next_release;			/* buffers must come back in Tx order */
+	u32			calls;
+	u32			returned[TEST_NUM_POOLS];
+	u16			done;				/* Tx-done counter, cleared on read */
+	int			err;
+};
+
+static struct fake_bm bm;
+
+static int fake_put_buffs(struct pp2_hif *hif, struct buff_release_entry buff_entry[], u16 *num)
+{
+	u16 i;
+
+	bm.calls++;
+	if (!*num || *num > MVAPPS_PP2_BUFF_RELEASE_MAX_BURST) {
+		printf("bad release burst of %u\n", *num);
+		bm.err = 1;
+		return -EINVAL;
+	}
+	for (i = 0; i < *num; i++) {
+		u64 id = buff_entry[i].buff.cookie;
+		int pool = buff_entry[i].bpool - bm.pools;
+
+		if (id >= TEST_MAX_BUFFS || !bm.in_flight[id] || id != bm.next_release ||
+		    buff_entry[i].buff.addr != (dma_addr_t)(id << 12) || pool != bm.pool_of[id]) {
+			printf("bad release of buffer %llu (pool %d, expected buffer %llu)\n",
+			       (unsigned long long)id, pool, (unsigned long long)bm.next_release);
+			bm.err = 1;
+			return -EINVAL;
+		}
+		bm.in_flight[id] = 0;
+		bm.returned[pool]++;
+		bm.next_release++;
+	}
+	return 0;
+}
+
+static int fake_get_num_outq_done(struct pp2_ppio *ppio, struct pp2_hif *hif, u8 tc, u16 *num)
+{
+	*num = bm.done;
+	bm.done = 0;
+	return 0;
+}
+
+static struct tx_shadow_q_entry	ents[4096];
+static struct lcl_port_desc	rx_port, tx_port;
+static struct tx_shadow_q	shadow_q;
+
+static void test_init(int shadow_q_size)
+{
+	memset(&bm, 0, sizeof(bm));
+	memset(&rx_port, 0, sizeof(rx_port));
+	memset(&tx_port, 0, sizeof(tx_port));
+	memset(&shadow_q, 0, sizeof(shadow_q));
+	memset(ents, 0, sizeof(ents));
+	shadow_q.ents = ents;
+	shadow_q.size = shadow_q_size;
+	spin_lock_init(&shadow_q.read_lock);
+	tx_port.num_shadow_qs = 1;
+	tx_port.shadow_q_size = shadow_q_size;
+	tx_port.shadow_qs = &shadow_q;
+}
+
+/* queue 'num' buffers for Tx, taken from random pools; returns the next buffer id */
+static u64 tx_buffs(u64 id, u16 num)
+{
+	u16 i;
+
+	for (i = 0; i < num; i++, id++) {
+		struct tx_shadow_q_entry *ent = &shadow_q.ents[shadow_q.write_ind];
+
+		bm.pool_of[id] = rand() % TEST_NUM_POOLS;
+		bm.in_flight[id] = 1;
+		ent->buff_ptr.cookie = id;
+		ent->buff_ptr.addr = (dma_addr_t)(id << 12);
+		ent->bpool = &bm.pools[bm.pool_of[id]];
+		if (++shadow_q.write_ind == tx_port.shadow_q_size)
+			shadow_q.write_ind = 0;
+	}
+	return id;
+}
+
+/* random Tx bursts and completions; every buffer must be released exactly once, in order, to its pool */
+static int test_recycle(int shadow_q_size, bool shared_q)
+{
+	u64 id = 0, done = 0;
+	u32 i, in_q = 0, releases = 0;
+	u16 num;
+
+	test_init(shadow_q_size);
+	shadow_q.shared_q = shared_q;
+
+	for (i = 0; i < TEST_ROUNDS && id < TEST_MAX_BUFFS - 64; i++) {
+		num = rand() % 64;
+		if (num > shadow_q_size - 1 - in_q)
+			num = shadow_q_size - 1 - in_q;
+		id = tx_buffs(id, num);
+		in_q += num;
+
+		/* the HW completes part of what was not completed yet */
+		num = rand() % (id - done + 1);
+		bm.done = num;
+		done += num;
+
+		free_sent_buffers(&rx_port, &tx_port, NULL, 0, MVAPPS_PP2_BUFF_RELEASE_BURST);
+		RCL_CHECK(!bm.err, "round %u failed\n", i);
+		RCL_CHECK(bm.next_release + shadow_q.done_pending == done,
+			  "round %u: %llu released, %u pending, %llu done\n", i,
+			  (unsigned long long)bm.next_release, shadow_q.done_pending, (unsigned long long)done);
+		RCL_CHECK(shadow_q.done_pending < MVAPPS_PP2_BUFF_RELEASE_THRESH,
+			  "round %u: %u buffers left pending\n", i, shadow_q.done_pending);
+		in_q = id - bm.next_release;
+		if (shared_q) {
+			RCL_CHECK(spin_trylock(&shadow_q.read_lock), "round %u: read_lock left taken\n", i);
+			spin_unlock(&shadow_q.read_lock);
+		}
+	}
+	releases = bm.calls;
+	RCL_CHECK(rx_port.cntrs.free_buf_cnt == bm.next_release, "free count %llu, released %llu\n",
+		  (unsigned long long)rx_port.cntrs.free_buf_cnt, (unsigned long long)bm.next_release);
+	RCL_CHECK(shadow_q.read_ind == bm.next_release % shadow_q_size, "read_ind %u after %llu releases\n",
+		  shadow_q.read_ind, (unsigned long long)bm.next_release);
+	for (i = 0; i < TEST_NUM_POOLS; i++)
+		RCL_CHECK(bm.returned[i], "nothing returned to pool %u\n", i);
+	printf("  shadow_q of %4d%s: %llu buffers in %u releases\n", shadow_q_size, shared_q ? " (shared)" : "",
+	       (unsigned long long)bm.next_release, releases);
+	return 0;
+}
+
+/* releases that wrap around the shadow_q end, or exceed the release burst, are split as little as possible */
+static int test_wrap_and_chunks(void)
+{
+	u64 id;
+
+	/* 40 buffers wrapping around the end: one release */
+	test_init(64);
+	shadow_q.read_ind = shadow_q.write_ind = 50;
+	bm.next_release = 0;
+	id = tx_buffs(0, 40);
+	bm.done = 40;
+	free_sent_buffers(&rx_port, &tx_port, NULL, 0, MVAPPS_PP2_BUFF_RELEASE_BURST);
+	RCL_CHECK(!bm.err && bm.next_release == id && bm.calls == 1 && shadow_q.read_ind == 26,
+		  "wrapped release: %llu released in %u calls, read_ind %u\n",
+		  (unsigned long long)bm.next_release, bm.calls, shadow_q.read_ind);
+
+	/* less than the threshold is kept pending, across polls */
+	id = tx_buffs(id, MVAPPS_PP2_BUFF_RELEASE_THRESH);
+	bm.done = MVAPPS_PP2_BUFF_RELEASE_THRESH - 1;
+	free_sent_buffers(&rx_port, &tx_port, NULL, 0, MVAPPS_PP2_BUFF_RELEASE_BURST);
+	RCL_CHECK(bm.calls == 1 && shadow_q.done_pending == MVAPPS_PP2_BUFF_RELEASE_THRESH - 1,
+		  "release below threshold (%u pending)\n", shadow_q.done_pending);
+	bm.done = 1;
+	free_sent_buffers(&rx_port, &tx_port, NULL, 0, MVAPPS_PP2_BUFF_RELEASE_BURST);
+	RCL_CHECK(!bm.err && bm.calls == 2 && !shadow_q.done_pending && bm.next_release == id,
+		  "pending buffers not released (%u pending)\n", shadow_q.done_pending);
+
+	/* 600 buffers wrapping around the end: split in releases of MVAPPS_PP2_BUFF_RELEASE_MAX_BURST */
+	test_init(1024);
+	shadow_q.read_ind = shadow_q.write_ind = 900;
+	id = tx_buffs(0, 600);
+	bm.done = 600;
+	free_sent_buffers(&rx_port, &tx_port, NULL, 0, MVAPPS_PP2_BUFF_RELEASE_BURST);
+	RCL_CHECK(!bm.err && bm.next_release == id && bm.calls == 3 && shadow_q.read_ind == (900 + 600) % 1024,
+		  "large release: %llu released in %u calls, read_ind %u\n",
+		  (unsigned long long)bm.next_release, bm.calls, shadow_q.read_ind);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	printf("Tx shadow queue burst recycle test\n");
+	srand(1);
+
+	if (test_wrap_and_chunks() || test_recycle(64, false) || test_recycle(1024, false) ||
+	    test_recycle(2048, true)) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
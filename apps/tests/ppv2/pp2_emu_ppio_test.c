@@ -0,0 +1,344 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+/*
+ * End-to-end test of the driver over the PPv2 emulator: initializes the
+ * packet processor with 'emulate' set, then a hif, a bpool and a ppio through
+ * the public API, sends frames and receives them back through the
+ * emulator's port loopback.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mv_std.h"
+#include "env/mv_sys_dma.h"
+#include "mv_pp2.h"
+#include "mv_pp2_hif.h"
+#include "mv_pp2_bpool.h"
+#include "mv_pp2_ppio.h"
+
+#define TEST_DMA_SIZE		(4 * 1024 * 1024)
+#define TEST_POOL_MATCH		"pool-0:3"
+#define TEST_PPIO_MATCH		"ppio-0:0"
+#define TEST_HIF_MATCH		"hif-1"
+#define TEST_POOL_BUFS		32
+#define TEST_BUF_SIZE		2048
+#define TEST_Q_SIZE		64
+#define TEST_PKT_OFFS		64
+#define TEST_NUM_PKTS		8
+#define TEST_PKT_LEN		100
+#define TEST_RX_TIMEOUT_MS	1000
+
+#define EMU_CHECK(cond, msg)						\
+	do {								\
+		if (!(cond)) {						\
+			pr_err("%s: %s\n", __func__, msg);		\
+			return -1;					\
+		}							\
+	} while (0)
+
+static int			pp2_up;
+static struct pp2_hif		*hif;
+static struct pp2_bpool		*bpool;
+static struct pp2_ppio		*ppio;
+static u8			*bufs;
+static u8			*tx_bufs;
+
+static int test_init(void)
+{
+	struct pp2_init_params init_params;
+	struct pp2_hif_params hif_params;
+	struct pp2_bpool_params bpool_params;
+	struct pp2_ppio_params ppio_params;
+	struct pp2_ppio_inq_params inq_params;
+	struct pp2_buff_inf buff;
+	int i, err;
+
+	memset(&init_params, 0, sizeof(init_params));
+	init_params.emulate = 1;
+	/* The kernel owns hif 0 and the first bpools on the HW */
+	init_params.hif_reserved_map = 0x1;
+	init_params.bm_pool_reserved_map = 0x7;
+	init_params.rss_tbl_reserved_map = 0x1;
+	err = pp2_init(&init_params);
+	EMU_CHECK(!err, "pp2_init failed");
+	pp2_up = 1;
+
+	memset(&hif_params, 0, sizeof(hif_params));
+	hif_params.match = TEST_HIF_MATCH;
+	hif_params.out_size = TEST_Q_SIZE;
+	err = pp2_hif_init(&hif_params, &hif);
+	EMU_CHECK(!err, "pp2_hif_init failed");
+
+	memset(&bpool_params, 0, sizeof(bpool_params));
+	bpool_params.match = TEST_POOL_MATCH;
+	bpool_params.buff_len = TEST_BUF_SIZE;
+	err = pp2_bpool_init(&bpool_params, &bpool);
+	EMU_CHECK(!err, "pp2_bpool_init failed");
+
+	/* The cookie is the buffer index: host virtual addresses may not fit
+	 * the 40 bits a descriptor carries
+	 */
+	bufs = mv_sys_dma_mem_alloc(TEST_POOL_BUFS * TEST_BUF_SIZE, TEST_BUF_SIZE);
+	EMU_CHECK(bufs, "no mem for buffers");
+	for (i = 0; i < TEST_POOL_BUFS; i++) {
+		buff.addr = mv_sys_dma_mem_virt2phys(bufs + i * TEST_BUF_SIZE);
+		buff.cookie = i;
+		err = pp2_bpool_put_buff(hif, bpool, &buff);
+		EMU_CHECK(!err, "pp2_bpool_put_buff failed");
+	}
+
+	memset(&ppio_params, 0, sizeof(ppio_params));
+	memset(&inq_params, 0, sizeof(inq_params));
+	ppio_params.match = TEST_PPIO_MATCH;
+	ppio_params.type = PP2_PPIO_T_NIC;
+	ppio_params.inqs_params.num_tcs = 1;
+	ppio_params.inqs_params.tcs_params[0].pkt_offset = TEST_PKT_OFFS;
+	ppio_params.inqs_params.tcs_params[0].num_in_qs = 1;
+	inq_params.size = TEST_Q_SIZE;
+	ppio_params.inqs_params.tcs_params[0].inqs_params = &inq_params;
+	ppio_params.inqs_params.tcs_params[0].pools[0][0] = bpool;
+	ppio_params.outqs_params.num_outqs = 1;
+	ppio_params.outqs_params.outqs_params[0].size = TEST_Q_SIZE;
+	err = pp2_ppio_init(&ppio_params, &ppio);
+	EMU_CHECK(!err && ppio, "pp2_ppio_init failed");
+	err = pp2_ppio_enable(ppio);
+	EMU_CHECK(!err, "pp2_ppio_enable failed");
+
+	printf("  ok\n");
+	return 0;
+}
+
+static void test_fill_pkt(u8 *data, int seq)
+{
+	static const u8 hdr[] = {
+		0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x00, 0x66, 0x77, 0x88, 0x99, 0xaa, 0x08, 0x00,
+		0x45, 0x00, 0x00, 0x56, 0x00, 0x00, 0x00, 0x00, 0x40, 0x11
+	};
+	int i;
+
+	memcpy(data, hdr, sizeof(hdr));
+	for (i = sizeof(hdr); i < TEST_PKT_LEN; i++)
+		data[i] = (u8)(i + seq);
+}
+
+static int test_send_recv(void)
+{
+	struct pp2_ppio_desc descs[TEST_NUM_PKTS];
+	u16 num, done, total = 0, sent_done = 0;
+	u32 num_buffs;
+	int i, ms;
+
+	tx_bufs = mv_sys_dma_mem_alloc(TEST_NUM_PKTS * TEST_BUF_SIZE, TEST_BUF_SIZE);
+	EMU_CHECK(tx_bufs, "no mem for TX buffers");
+	for (i = 0; i < TEST_NUM_PKTS; i++) {
+		u8 *data = tx_bufs + i * TEST_BUF_SIZE;
+
+		test_fill_pkt(data, i);
+		pp2_ppio_outq_desc_reset(&descs[i]);
+		pp2_ppio_outq_desc_set_phys_addr(&descs[i], mv_sys_dma_mem_virt2phys(data));
+		pp2_ppio_outq_desc_set_pkt_offset(&descs[i], 0);
+		pp2_ppio_outq_desc_set_pkt_len(&descs[i], TEST_PKT_LEN);
+	}
+	num = TEST_NUM_PKTS;
+	EMU_CHECK(!pp2_ppio_send(ppio, hif, 0, descs, &num), "pp2_ppio_send failed");
+	EMU_CHECK(num == TEST_NUM_PKTS, "not all frames sent");
+
+	for (ms = 0; total < TEST_NUM_PKTS && ms < TEST_RX_TIMEOUT_MS; ms++) {
+		num = TEST_NUM_PKTS - total;
+		EMU_CHECK(!pp2_ppio_recv(ppio, 0, 0, &descs[total], &num), "pp2_ppio_recv failed");
+		total += num;
+		if (total < TEST_NUM_PKTS)
+			usleep(1000);
+	}
+	EMU_CHECK(total == TEST_NUM_PKTS, "frames not received");
+
+	/* Frames come back in order, into the port's pool */
+	for (i = 0; i < TEST_NUM_PKTS; i++) {
+		u64 cookie = pp2_ppio_inq_desc_get_cookie(&descs[i]);
+		u8 *data;
+
+		EMU_CHECK(pp2_ppio_inq_desc_get_pkt_len(&descs[i]) == TEST_PKT_LEN, "bad RX length");
+		EMU_CHECK(pp2_ppio_inq_desc_get_bpool(&descs[i], ppio) == bpool, "bad RX pool");
+		EMU_CHECK(cookie < TEST_POOL_BUFS, "bad RX cookie");
+		data = bufs + cookie * TEST_BUF_SIZE;
+		EMU_CHECK(mv_sys_dma_mem_phys2virt(pp2_ppio_inq_desc_get_phys_addr(&descs[i])) == data,
+			  "cookie does not match the RX buffer");
+		EMU_CHECK(!memcmp(data + TEST_PKT_OFFS + MV_MH_SIZE, tx_bufs + i * TEST_BUF_SIZE, TEST_PKT_LEN),
+			  "bad RX data");
+	}
+
+	for (ms = 0; sent_done < TEST_NUM_PKTS && ms < TEST_RX_TIMEOUT_MS; ms++) {
+		EMU_CHECK(!pp2_ppio_get_num_outq_done(ppio, hif, 0, &done), "pp2_ppio_get_num_outq_done failed");
+		sent_done += done;
+		if (sent_done < TEST_NUM_PKTS)
+			usleep(1000);
+	}
+	EMU_CHECK(sent_done == TEST_NUM_PKTS, "frames not transmitted");
+
+	/* Give the RX buffers back */
+	for (i = 0; i < TEST_NUM_PKTS; i++) {
+		struct pp2_buff_inf buff;
+
+		buff.cookie = pp2_ppio_inq_desc_get_cookie(&descs[i]);
+		buff.addr = pp2_ppio_inq_desc_get_phys_addr(&descs[i]);
+		EMU_CHECK(!pp2_bpool_put_buff(hif, bpool, &buff), "pp2_bpool_put_buff failed");
+	}
+	EMU_CHECK(!pp2_bpool_get_num_buffs(bpool, &num_buffs) && num_buffs == TEST_POOL_BUFS,
+		  "buffers lost");
+
+	printf("  ok\n");
+	return 0;
+}
+
+static void test_deinit(void)
+{
+	if (ppio) {
+		pp2_ppio_disable(ppio);
+		pp2_ppio_deinit(ppio);
+	}
+	if (bpool) {
+		struct pp2_buff_inf buff;
+		u32 num_buffs;
+
+		/* The pool must be empty before it is destroyed */
+		while (!pp2_bpool_get_num_buffs(bpool, &num_buffs) && num_buffs)
+			if (pp2_bpool_get_buff(hif, bpool, &buff))
+				break;
+		pp2_bpool_deinit(bpool);
+	}
+	if (hif)
+		pp2_hif_deinit(hif);
+	if (pp2_up)
+		pp2_deinit();
+	if (tx_bufs)
+		mv_sys_dma_mem_free(tx_bufs);
+	if (bufs)
+		mv_sys_dma_mem_free(bufs);
+}
+
+int main(int argc, char *argv[])
+{
+	int err;
+
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	printf("PPv2 driver over emulator test\n");
+
+	err = mv_sys_dma_mem_init(TEST_DMA_SIZE);
+	if (err) {
+		pr_err("DMA mem init failed (%d)\n", err);
+		return err;
+	}
+
+	printf("init:\n");
+	err = test_init();
+	if (!err) {
+		printf("send/recv:\n");
+		err = test_send_recv();
+	}
+	test_deinit();
+	mv_sys_dma_mem_destroy();
+
+	if (err) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
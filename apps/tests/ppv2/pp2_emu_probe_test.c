@@ -0,0 +1,321 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+/*
+ * Serialize/probe round-trip test over the PPv2 emulator: a master instance
+ * creates bpools and a ppio and serializes them, as NMP does for its guests;
+ * a guest instance (skip_hw_init) then probes them from that string and must
+ * serialize them back to the very same string.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mv_std.h"
+#include "env/mv_sys_dma.h"
+#include "env/sys_iomem.h"
+#include "mv_pp2.h"
+#include "mv_pp2_bpool.h"
+#include "mv_pp2_ppio.h"
+
+#define TEST_DMA_SIZE		(4 * 1024 * 1024)
+#define TEST_NUM_POOLS		2
+#define TEST_PPIO_MATCH		"ppio-0:0"
+#define TEST_BUF_SIZE		2048
+#define TEST_NUM_INQS		2
+#define TEST_NUM_OUTQS		2
+#define TEST_Q_SIZE		64
+#define TEST_PKT_OFFS		64
+#define TEST_SER_SIZE		(32 * 1024)
+
+#define EMU_CHECK(cond, msg)						\
+	do {								\
+		if (!(cond)) {						\
+			pr_err("%s: %s\n", __func__, msg);		\
+			return -1;					\
+		}							\
+	} while (0)
+
+static const char		*pool_match[TEST_NUM_POOLS] = {"pool-0:3", "pool-0:4"};
+static int			 pp2_up;
+static struct pp2_bpool		*bpools[TEST_NUM_POOLS];
+static struct pp2_ppio		*ppio;
+static struct sys_iomem		*iomem;
+static char			 master_str[TEST_SER_SIZE];
+static char			 guest_str[TEST_SER_SIZE];
+
+static int test_pp2_init(int guest)
+{
+	struct pp2_init_params init_params;
+
+	memset(&init_params, 0, sizeof(init_params));
+	init_params.emulate = 1;
+	init_params.skip_hw_init = guest;
+	init_params.hif_reserved_map = 0x1;
+	init_params.bm_pool_reserved_map = 0x7;
+	init_params.rss_tbl_reserved_map = 0x1;
+	EMU_CHECK(!pp2_init(&init_params), "pp2_init failed");
+	pp2_up = 1;
+
+	return 0;
+}
+
+static int test_serialize(char *buff)
+{
+	size_t pos;
+	int i;
+
+	/* Same order NMP uses: the port's pools first, then the port */
+	for (i = 0; i < TEST_NUM_POOLS; i++) {
+		pos = strlen(buff);
+		EMU_CHECK(pp2_bpool_serialize(bpools[i], &buff[pos], TEST_SER_SIZE - pos) >= 0,
+			  "pp2_bpool_serialize failed");
+	}
+	pos = strlen(buff);
+	EMU_CHECK(pp2_ppio_serialize(ppio, &buff[pos], TEST_SER_SIZE - pos) >= 0,
+		  "pp2_ppio_serialize failed");
+	EMU_CHECK(strlen(buff) < TEST_SER_SIZE - 1, "serialization truncated");
+
+	return 0;
+}
+
+static int test_master(void)
+{
+	struct pp2_bpool_params bpool_params;
+	struct pp2_ppio_params ppio_params;
+	struct pp2_ppio_inq_params inq_params[TEST_NUM_INQS];
+	int i;
+
+	if (test_pp2_init(0))
+		return -1;
+
+	for (i = 0; i < TEST_NUM_POOLS; i++) {
+		memset(&bpool_params, 0, sizeof(bpool_params));
+		bpool_params.match = pool_match[i];
+		bpool_params.buff_len = TEST_BUF_SIZE;
+		EMU_CHECK(!pp2_bpool_init(&bpool_params, &bpools[i]), "pp2_bpool_init failed");
+	}
+
+	memset(&ppio_params, 0, sizeof(ppio_params));
+	memset(inq_params, 0, sizeof(inq_params));
+	ppio_params.match = TEST_PPIO_MATCH;
+	ppio_params.type = PP2_PPIO_T_NIC;
+	ppio_params.inqs_params.num_tcs = 1;
+	ppio_params.inqs_params.tcs_params[0].pkt_offset = TEST_PKT_OFFS;
+	ppio_params.inqs_params.tcs_params[0].num_in_qs = TEST_NUM_INQS;
+	for (i = 0; i < TEST_NUM_INQS; i++)
+		inq_params[i].size = TEST_Q_SIZE;
+	ppio_params.inqs_params.tcs_params[0].inqs_params = inq_params;
+	for (i = 0; i < TEST_NUM_POOLS; i++)
+		ppio_params.inqs_params.tcs_params[0].pools[0][i] = bpools[i];
+	ppio_params.outqs_params.num_outqs = TEST_NUM_OUTQS;
+	for (i = 0; i < TEST_NUM_OUTQS; i++)
+		ppio_params.outqs_params.outqs_params[i].size = TEST_Q_SIZE;
+	EMU_CHECK(!pp2_ppio_init(&ppio_params, &ppio) && ppio, "pp2_ppio_init failed");
+
+	if (test_serialize(master_str))
+		return -1;
+
+	printf("  ok\n");
+	return 0;
+}
+
+static void test_master_deinit(void)
+{
+	int i;
+
+	if (ppio)
+		pp2_ppio_deinit(ppio);
+	ppio = NULL;
+	for (i = 0; i < TEST_NUM_POOLS; i++) {
+		if (bpools[i])
+			pp2_bpool_deinit(bpools[i]);
+		bpools[i] = NULL;
+	}
+	if (pp2_up)
+		pp2_deinit();
+	pp2_up = 0;
+}
+
+static int test_guest(void)
+{
+	struct mv_sys_dma_mem_info mem_info;
+	struct sys_iomem_params iomem_params;
+	char dev_name[100];
+	phys_addr_t paddr;
+	void *va;
+	int i;
+
+	if (test_pp2_init(1))
+		return -1;
+
+	/* Map the master's DMA memory the way nmp_guest_probe does */
+	mem_info.name = dev_name;
+	EMU_CHECK(!mv_sys_dma_mem_get_info(&mem_info), "mv_sys_dma_mem_get_info failed");
+	memset(&iomem_params, 0, sizeof(iomem_params));
+	iomem_params.type = SYS_IOMEM_T_SHMEM;
+	iomem_params.devname = dev_name;
+	iomem_params.index = 1;
+	iomem_params.size = mem_info.size;
+	EMU_CHECK(!sys_iomem_init(&iomem_params, &iomem), "sys_iomem_init failed");
+	paddr = mem_info.paddr;
+	EMU_CHECK(!sys_iomem_map(iomem, NULL, &paddr, &va), "sys_iomem_map failed");
+
+	for (i = 0; i < TEST_NUM_POOLS; i++)
+		EMU_CHECK(!pp2_bpool_probe((char *)pool_match[i], master_str, &bpools[i]),
+			  "pp2_bpool_probe failed");
+	EMU_CHECK(!pp2_ppio_probe(TEST_PPIO_MATCH, master_str, &ppio) && ppio,
+		  "pp2_ppio_probe failed");
+
+	if (test_serialize(guest_str))
+		return -1;
+	if (strcmp(master_str, guest_str)) {
+		pr_err("master:\n%s\nguest:\n%s\n", master_str, guest_str);
+		EMU_CHECK(0, "probed objects serialize differently");
+	}
+
+	printf("  ok\n");
+	return 0;
+}
+
+static void test_guest_deinit(void)
+{
+	int i;
+
+	if (ppio)
+		pp2_ppio_remove(ppio);
+	for (i = 0; i < TEST_NUM_POOLS; i++)
+		if (bpools[i])
+			pp2_bpool_remove(bpools[i]);
+	if (iomem) {
+		sys_iomem_unmap(iomem, NULL);
+		sys_iomem_deinit(iomem);
+	}
+	if (pp2_up)
+		pp2_deinit();
+}
+
+int main(int argc, char *argv[])
+{
+	int err;
+
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	printf("PPv2 serialize/probe round-trip test\n");
+
+	err = mv_sys_dma_mem_init(TEST_DMA_SIZE);
+	if (err) {
+		pr_err("DMA mem init failed (%d)\n", err);
+		return err;
+	}
+
+	printf("master init/serialize:\n");
+	err = test_master();
+	test_master_deinit();
+	if (!err) {
+		printf("guest probe/serialize:\n");
+		err = test_guest();
+		test_guest_deinit();
+	}
+	mv_sys_dma_mem_destroy();
+
+	if (err) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
@@ -0,0 +1,422 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+/*
+ * Unit test of the PPv2 emulator: drives the BM, RXQ/TXQ and aggregation
+ * queue register sequences used by the driver through pp2_reg_write()/read()
+ * and checks the descriptor rings and buffers the emulated HW produces.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mv_std.h"
+#include "pp2.h"
+#include "pp2_dm.h"
+#include "pp2_emu.h"
+
+#define TEST_DMA_SIZE		(1024 * 1024)
+/* Fake physical base of the DMA region; must be non-zero */
+#define TEST_DMA_PHYS		0x80000000ULL
+
+#define TEST_POOL		3
+#define TEST_POOL_BUFS		8
+#define TEST_BUF_SIZE		2048
+#define TEST_PORT		0
+#define TEST_RXQ		5
+#define TEST_RXQ_SIZE		16
+#define TEST_TXQ		((MVPP2_MAX_TCONT + TEST_PORT) * MVPP2_MAX_TXQ)
+#define TEST_TXQ_SIZE		32
+#define TEST_AGGR_SIZE		16
+#define TEST_HIF		1
+#define TEST_PKT_OFFS		64	/* RXQ packet offset, in units of 32 */
+
+/* DMA region layout */
+#define TEST_RXQ_DESCS_OFFS	0x0000
+#define TEST_TXQ_DESCS_OFFS	0x1000
+#define TEST_AGGR_DESCS_OFFS	0x2000
+#define TEST_BUFS_OFFS		0x10000
+
+#define EMU_CHECK(cond, msg)						\
+	do {								\
+		if (!(cond)) {						\
+			pr_err("%s: %s\n", __func__, msg);		\
+			return -1;					\
+		}							\
+	} while (0)
+
+static u8 *dma_mem;
+static uintptr_t slots[PP2_NUM_REGSPACES];
+
+static void *test_phys2virt(phys_addr_t pa)
+{
+	if (pa < TEST_DMA_PHYS || pa >= TEST_DMA_PHYS + TEST_DMA_SIZE)
+		return NULL;
+	return dma_mem + (pa - TEST_DMA_PHYS);
+}
+
+static inline u64 test_phys(u32 offs)
+{
+	return TEST_DMA_PHYS + offs;
+}
+
+static inline u64 test_buf_phys(int i)
+{
+	return test_phys(TEST_BUFS_OFFS + i * TEST_BUF_SIZE);
+}
+
+static u32 test_pool_num_buffs(void)
+{
+	u32 num;
+
+	num = pp2_reg_read(slots[0], MVPP2_BM_POOL_PTRS_NUM_REG(TEST_POOL)) & MVPP22_BM_POOL_PTRS_NUM_MASK;
+	num += pp2_reg_read(slots[0], MVPP2_BM_BPPI_PTRS_NUM_REG(TEST_POOL)) & MVPP2_BM_BPPI_PTR_NUM_MASK;
+	return num ? num + 1 : 0;
+}
+
+static void test_bm_put(u64 phys, u64 virt)
+{
+	pp2_reg_write(slots[TEST_HIF], MVPP22_BM_PHY_VIRT_HIGH_RLS_REG,
+		      (u32)(phys >> 32) | ((u32)(virt >> 32) << MVPP22_BM_VIRT_HIGH_RLS_OFFST));
+	pp2_reg_write(slots[TEST_HIF], MVPP2_BM_VIRT_RLS_REG, (u32)virt);
+	pp2_reg_write(slots[TEST_HIF], MVPP2_BM_PHY_RLS_REG(TEST_POOL), (u32)phys);
+}
+
+static int test_bm(void)
+{
+	u32 phys_lo, virt_lo, high, i;
+
+	pp2_reg_write(slots[0], MVPP2_BM_POOL_SIZE_REG(TEST_POOL), TEST_POOL_BUFS);
+	pp2_reg_write(slots[0], MVPP2_BM_POOL_CTRL_REG(TEST_POOL), MVPP2_BM_START_MASK);
+	EMU_CHECK(pp2_reg_read(slots[0], MVPP2_BM_POOL_CTRL_REG(TEST_POOL)) & MVPP2_BM_STATE_MASK,
+		  "pool not started");
+	pp2_reg_write(slots[0], MVPP2_POOL_BUF_SIZE_REG(TEST_POOL), TEST_BUF_SIZE);
+
+	/* Cookie carries a high part to check the virtual high bits */
+	for (i = 0; i < TEST_POOL_BUFS; i++)
+		test_bm_put(test_buf_phys(i), 0x1200000000ULL | i);
+	EMU_CHECK(test_pool_num_buffs() == TEST_POOL_BUFS, "bad number of buffers");
+
+	/* Full pool drops the release */
+	test_bm_put(test_buf_phys(0), 0);
+	EMU_CHECK(test_pool_num_buffs() == TEST_POOL_BUFS, "release to a full pool");
+
+	/* LIFO allocation of the last released buffer */
+	phys_lo = pp2_reg_read(slots[TEST_HIF], MVPP2_BM_PHY_ALLOC_REG(TEST_POOL));
+	virt_lo = pp2_reg_read(slots[TEST_HIF], MVPP2_BM_VIRT_ALLOC_REG);
+	high = pp2_reg_read(slots[TEST_HIF], MVPP22_BM_PHY_VIRT_HIGH_ALLOC_REG);
+	EMU_CHECK(phys_lo == (u32)test_buf_phys(TEST_POOL_BUFS - 1), "bad allocated phys");
+	EMU_CHECK(virt_lo == TEST_POOL_BUFS - 1, "bad allocated virt");
+	EMU_CHECK(((high & MVPP22_BM_VIRT_HIGH_ALLOC_MASK) >> MVPP22_BM_VIRT_HIGH_ALLOC_OFFSET) == 0x12,
+		  "bad allocated virt high bits");
+	EMU_CHECK(test_pool_num_buffs() == TEST_POOL_BUFS - 1, "allocation not accounted");
+	test_bm_put(test_buf_phys(TEST_POOL_BUFS - 1), TEST_POOL_BUFS - 1);
+
+	printf("  ok\n");
+	return 0;
+}
+
+static int test_queues_init(void)
+{
+	u32 cfg;
+
+	/* RXQ, as pp2_port_rxq_hw_init() and the default classification do */
+	pp2_reg_write(slots[0], MVPP2_CLS_OVERSIZE_RXQ_LOW_REG(TEST_PORT), TEST_RXQ);
+	pp2_reg_write(slots[0], MVPP2_RXQ_NUM_REG, TEST_RXQ);
+	pp2_reg_write(slots[0], MVPP2_RXQ_DESC_ADDR_REG, test_phys(TEST_RXQ_DESCS_OFFS) >> MVPP22_DESC_ADDR_SHIFT);
+	pp2_reg_write(slots[0], MVPP2_RXQ_DESC_SIZE_REG, TEST_RXQ_SIZE);
+	pp2_reg_write(slots[0], MVPP2_RXQ_INDEX_REG, 0);
+	cfg = ((TEST_PKT_OFFS / 32) << MVPP2_RXQ_PACKET_OFFSET_OFFS) |
+	      (TEST_POOL << MVPP22_RXQ_POOL_SHORT_OFFS) | (TEST_POOL << MVPP22_RXQ_POOL_LONG_OFFS);
+	pp2_reg_write(slots[0], MVPP2_RXQ_CONFIG_REG(TEST_RXQ), cfg);
+	pp2_reg_write(slots[0], MVPP2_RXQ_STATUS_UPDATE_REG(TEST_RXQ), TEST_RXQ_SIZE << MVPP2_RXQ_NUM_NEW_OFFSET);
+
+	/* Physical TXQ of the port */
+	pp2_reg_write(slots[0], MVPP2_TXQ_NUM_REG, TEST_TXQ);
+	pp2_reg_write(slots[0], MVPP2_TXQ_DESC_ADDR_LOW_REG, (u32)test_phys(TEST_TXQ_DESCS_OFFS));
+	pp2_reg_write(slots[0], MVPP22_TXQ_DESC_ADDR_HIGH_REG, test_phys(TEST_TXQ_DESCS_OFFS) >> 32);
+	pp2_reg_write(slots[0], MVPP2_TXQ_DESC_SIZE_REG, TEST_TXQ_SIZE);
+
+	/* Aggregation queue of the hif */
+	pp2_reg_write(slots[TEST_HIF], MVPP2_AGGR_TXQ_DESC_ADDR_REG(TEST_HIF),
+		      test_phys(TEST_AGGR_DESCS_OFFS) >> MVPP22_DESC_ADDR_SHIFT);
+	pp2_reg_write(slots[TEST_HIF], MVPP2_AGGR_TXQ_DESC_SIZE_REG(TEST_HIF), TEST_AGGR_SIZE);
+	EMU_CHECK(!pp2_reg_read(slots[TEST_HIF], MVPP2_AGGR_TXQ_INDEX_REG(TEST_HIF)), "aggr index not reset");
+	EMU_CHECK((pp2_reg_read(slots[0], MVPP2_RXQ_STATUS_REG(TEST_RXQ)) & MVPP2_RXQ_NON_OCCUPIED_MASK) ==
+		  TEST_RXQ_SIZE << MVPP2_RXQ_NON_OCCUPIED_OFFSET, "RXQ not filled with free descriptors");
+
+	printf("  ok\n");
+	return 0;
+}
+
+static int test_txq_reserve(void)
+{
+	u32 rsvd;
+
+	pp2_reg_write(slots[TEST_HIF], MVPP2_TXQ_RSVD_REQ_REG, (TEST_TXQ << MVPP2_TXQ_RSVD_REQ_Q_OFFSET) | 8);
+	rsvd = pp2_reg_read(slots[TEST_HIF], MVPP2_TXQ_RSVD_RSLT_REG) & MVPP2_TXQ_RSVD_RSLT_MASK;
+	EMU_CHECK(rsvd == 8, "reservation not granted");
+
+	/* The TXQ is shared between the hifs: only what is left is granted */
+	pp2_reg_write(slots[2], MVPP2_TXQ_RSVD_REQ_REG, (TEST_TXQ << MVPP2_TXQ_RSVD_REQ_Q_OFFSET) | TEST_TXQ_SIZE);
+	rsvd = pp2_reg_read(slots[2], MVPP2_TXQ_RSVD_RSLT_REG) & MVPP2_TXQ_RSVD_RSLT_MASK;
+	EMU_CHECK(rsvd == TEST_TXQ_SIZE - 8, "overcommitted reservation");
+
+	pp2_reg_write(slots[2], MVPP2_TXQ_RSVD_CLR_REG, TEST_TXQ << MVPP2_TXQ_RSVD_CLR_OFFSET);
+	pp2_reg_write(slots[2], MVPP2_TXQ_RSVD_REQ_REG, (TEST_TXQ << MVPP2_TXQ_RSVD_REQ_Q_OFFSET) | 8);
+	rsvd = pp2_reg_read(slots[2], MVPP2_TXQ_RSVD_RSLT_REG) & MVPP2_TXQ_RSVD_RSLT_MASK;
+	EMU_CHECK(rsvd == 8, "reservations not cleared");
+
+	printf("  ok\n");
+	return 0;
+}
+
+/* Allocates a buffer from the pool, as the application does */
+static u32 test_bm_get(void)
+{
+	pp2_reg_read(slots[TEST_HIF], MVPP2_BM_PHY_ALLOC_REG(TEST_POOL));
+	return pp2_reg_read(slots[TEST_HIF], MVPP2_BM_VIRT_ALLOC_REG);
+}
+
+/* Puts an UDP/IPv4 frame in TX buffer 'buf' and enqueues it to the hif's
+ * aggregation queue, with the buffer released to the pool after transmission
+ */
+static u16 test_send(u32 buf, u16 len, int err_sum)
+{
+	static const u8 hdr[] = {
+		0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x00, 0x66, 0x77, 0x88, 0x99, 0xaa, 0x08, 0x00,
+		0x45, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x11
+	};
+	struct pp2_ppio_desc *desc;
+	u8 *data = dma_mem + TEST_BUFS_OFFS + buf * TEST_BUF_SIZE;
+	u32 idx, i;
+
+	memcpy(data, hdr, sizeof(hdr));
+	for (i = sizeof(hdr); i < len; i++)
+		data[i] = (u8)(i + buf);
+
+	idx = pp2_reg_read(slots[TEST_HIF], MVPP2_AGGR_TXQ_INDEX_REG(TEST_HIF));
+	desc = (struct pp2_ppio_desc *)(dma_mem + TEST_AGGR_DESCS_OFFS) + idx;
+	pp2_ppio_outq_desc_reset(desc);
+	pp2_ppio_outq_desc_set_phys_addr(desc, test_buf_phys(buf));
+	pp2_ppio_outq_desc_set_cookie(desc, buf);
+	pp2_ppio_outq_desc_set_pkt_len(desc, len);
+	DM_TXD_SET_DEST_QID(desc, TEST_TXQ);
+	DM_TXD_SET_BUFMODE(desc, TXD_RLS_BM);
+	DM_TXD_SET_POOL_ID(desc, TEST_POOL);
+	if (err_sum)
+		DM_TXD_SET_ERR_SUM(desc, 1);
+	pp2_reg_write(slots[TEST_HIF], MVPP2_AGGR_TXQ_UPDATE_REG, 1);
+	return len;
+}
+
+static int test_tx_rx(struct pp2_emu *emu)
+{
+	struct pp2_ppio_desc *desc = (struct pp2_ppio_desc *)(dma_mem + TEST_RXQ_DESCS_OFFS);
+	struct pp2_emu_stats stats;
+	enum pp2_inq_l3_type l3_type;
+	enum pp2_inq_l4_type l4_type;
+	u8 tx_data[128], *rx_data;
+	u8 l3_offs, l4_offs;
+	u32 buf, num_buffs = test_pool_num_buffs();
+	u16 len;
+
+	/* The TX buffer may be reused for RX once released: keep the frame */
+	buf = test_bm_get();
+	len = test_send(buf, 100, 0);
+	memcpy(tx_data, dma_mem + TEST_BUFS_OFFS + buf * TEST_BUF_SIZE, len);
+	EMU_CHECK(pp2_reg_read(slots[TEST_HIF], MVPP2_AGGR_TXQ_STATUS_REG(TEST_HIF)) == 1, "aggr not pending");
+	EMU_CHECK(pp2_emu_process(emu, 64) == 1, "descriptor not processed");
+	EMU_CHECK(!pp2_reg_read(slots[TEST_HIF], MVPP2_AGGR_TXQ_STATUS_REG(TEST_HIF)), "aggr still pending");
+
+	EMU_CHECK((pp2_reg_read(slots[0], MVPP2_RXQ_STATUS_REG(TEST_RXQ)) & MVPP2_RXQ_OCCUPIED_MASK) == 1,
+		  "packet not received");
+	EMU_CHECK(pp2_ppio_inq_desc_get_pkt_len(desc) == len, "bad RX length");
+	EMU_CHECK(DM_RXD_GET_POOL_ID(desc) == TEST_POOL, "bad RX pool");
+	EMU_CHECK(DM_RXD_GET_PORT_NUM(desc) == TEST_PORT, "bad RX port");
+	pp2_ppio_inq_desc_get_l3_info(desc, &l3_type, &l3_offs);
+	pp2_ppio_inq_desc_get_l4_info(desc, &l4_type, &l4_offs);
+	EMU_CHECK(l3_type == PP2_INQ_L3_TYPE_IPV4_NO_OPTS && l3_offs == 14, "bad L3 info");
+	EMU_CHECK(l4_type == PP2_INQ_L4_TYPE_UDP && l4_offs == l3_offs + 20, "bad L4 info");
+
+	rx_data = test_phys2virt(pp2_ppio_inq_desc_get_phys_addr(desc));
+	EMU_CHECK(rx_data, "bad RX buffer address");
+	EMU_CHECK(!memcmp(rx_data + TEST_PKT_OFFS + MV_MH_SIZE, tx_data, len), "bad RX data");
+
+	/* TX buffer went back to the pool, one buffer was taken by RX */
+	EMU_CHECK(test_pool_num_buffs() == num_buffs - 1, "bad pool accounting");
+
+	/* Sent counter is per hif and read-clear */
+	EMU_CHECK(pp2_reg_read(slots[TEST_HIF], MVPP22_TXQ_SENT_REG(TEST_TXQ)) ==
+		  1 << MVPP22_TRANSMITTED_COUNT_OFFSET, "bad sent counter");
+	EMU_CHECK(!pp2_reg_read(slots[TEST_HIF], MVPP22_TXQ_SENT_REG(TEST_TXQ)), "sent counter not cleared");
+
+	/* Frame with an error summary is only released */
+	pp2_reg_write(slots[0], MVPP2_RXQ_STATUS_UPDATE_REG(TEST_RXQ), 1 | (1 << MVPP2_RXQ_NUM_NEW_OFFSET));
+	test_send(test_bm_get(), 64, 1);
+	EMU_CHECK(pp2_emu_process(emu, 64) == 1, "descriptor not processed");
+	pp2_emu_get_stats(emu, &stats, 1);
+	EMU_CHECK(stats.rx_pkts == 1 && stats.tx_drops == 1 && stats.tx_descs == 2, "bad stats");
+	EMU_CHECK(!(pp2_reg_read(slots[0], MVPP2_RXQ_STATUS_REG(TEST_RXQ)) & MVPP2_RXQ_OCCUPIED_MASK),
+		  "dropped frame received");
+
+	/* No free descriptors in the RXQ */
+	pp2_reg_write(slots[0], MVPP2_RXQ_STATUS_REG(TEST_RXQ), 0);
+	test_send(test_bm_get(), 64, 0);
+	pp2_emu_process(emu, 64);
+	pp2_emu_get_stats(emu, &stats, 1);
+	EMU_CHECK(stats.rx_fullq_drops == 1 && !stats.rx_pkts, "full RXQ not dropping");
+
+	printf("  ok\n");
+	return 0;
+}
+
+static int test_txp_qmap(void)
+{
+	pp2_reg_write(slots[0], MVPP2_TXP_SCHED_PORT_INDEX_REG, TEST_PORT);
+	pp2_reg_write(slots[0], MVPP2_TXP_SCHED_Q_CMD_REG, 0x3);
+	EMU_CHECK((pp2_reg_read(slots[0], MVPP2_TXP_SCHED_Q_CMD_REG) & MVPP2_TXP_SCHED_ENQ_MASK) == 0x3,
+		  "queues not enabled");
+	pp2_reg_write(slots[0], MVPP2_TXP_SCHED_Q_CMD_REG, 0x1 << MVPP2_TXP_SCHED_DISQ_OFFSET);
+	EMU_CHECK((pp2_reg_read(slots[0], MVPP2_TXP_SCHED_Q_CMD_REG) & MVPP2_TXP_SCHED_ENQ_MASK) == 0x2,
+		  "queue not disabled");
+
+	printf("  ok\n");
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct pp2_emu_params params;
+	struct pp2_emu *emu;
+	phys_addr_t pa;
+	uintptr_t va;
+	int i, err;
+
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	printf("PPv2 emulator test\n");
+
+	dma_mem = calloc(1, TEST_DMA_SIZE);
+	if (!dma_mem) {
+		pr_err("no mem for DMA region\n");
+		return -ENOMEM;
+	}
+
+	memset(&params, 0, sizeof(params));
+	params.phys2virt = test_phys2virt;
+	params.no_thread = 1;
+	err = pp2_emu_create(&params, &emu);
+	if (err) {
+		free(dma_mem);
+		return err;
+	}
+	pp2_emu_map(emu, "pp", &pa, &va);
+	for (i = 0; i < PP2_NUM_REGSPACES; i++)
+		slots[i] = va + i * PP2_REGSPACE_SIZE;
+
+	err = test_bm() || test_queues_init() || test_txq_reserve() || test_tx_rx(emu) || test_txp_qmap();
+
+	pp2_emu_destroy(emu);
+	free(dma_mem);
+
+	if (err) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
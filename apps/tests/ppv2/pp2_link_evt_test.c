@@ -0,0 +1,294 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+/*
+ * Unit test of the link change notification debounce, with link flaps
+ * simulated through a fake GMAC port status register.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mv_std.h"
+#include "pp2_gop_def.h"
+
+/* fake register backend: the link is sampled from a fake GMAC status register */
+struct pp2_port;
+static u32 fake_gmac_status;
+static u32 fake_reads;
+static int fake_link_get(struct pp2_port *port);
+#define pp2_link_evt_hw_get(port)	fake_link_get(port)
+
+#include "pp2_link_evt.h"
+
+#define TEST_DEBOUNCE_MS	100
+
+static struct pp2_link_evt evt;
+static u32 notifs;
+static int notif_link;
+
+static int fake_link_get(struct pp2_port *port)
+{
+	fake_reads++;
+	return !!(fake_gmac_status & PP2_GMAC_PORT_STATUS0_LINKUP_MASK);
+}
+
+static void fake_link_set(int up)
+{
+	if (up)
+		fake_gmac_status |= PP2_GMAC_PORT_STATUS0_LINKUP_MASK;
+	else
+		fake_gmac_status &= ~PP2_GMAC_PORT_STATUS0_LINKUP_MASK;
+}
+
+static void link_cb(void *arg, struct pp2_ppio *ppio, int link_up)
+{
+	notifs++;
+	notif_link = link_up;
+}
+
+static void evt_init(u32 debounce_ms, int link)
+{
+	memset(&evt, 0, sizeof(evt));
+	evt.cb = link_cb;
+	evt.fd = -1;
+	notifs = 0;
+	notif_link = -1;
+	fake_reads = 0;
+	fake_link_set(link);
+	pp2_link_dbnc_init(&evt.dbnc, debounce_ms, link, 0);
+}
+
+/* Sample the fake register at time 'now'; returns the timeout hint */
+static int evt_poll(u64 now)
+{
+	int timeout;
+
+	pp2_link_evt_poll_hw(&evt, NULL, now, &timeout);
+	return timeout;
+}
+
+static int test_no_debounce(void)
+{
+	evt_init(0, 1);
+	fake_link_set(0);
+	if (evt_poll(10) != -1 || notifs != 1 || notif_link != 0) {
+		pr_err("link down not reported at once (%u notifications)\n", notifs);
+		return -1;
+	}
+	fake_link_set(1);
+	evt_poll(11);
+	evt_poll(12);
+	if (notifs != 2 || notif_link != 1) {
+		pr_err("link up not reported once (%u notifications)\n", notifs);
+		return -1;
+	}
+	printf("  no debounce: every change reported\n");
+	return 0;
+}
+
+static int test_short_flap(void)
+{
+	evt_init(TEST_DEBOUNCE_MS, 1);
+	fake_link_set(0);
+	if (evt_poll(1000) != TEST_DEBOUNCE_MS) {
+		pr_err("bad timeout hint for a pending change\n");
+		return -1;
+	}
+	if (evt_poll(1030) != TEST_DEBOUNCE_MS - 30) {
+		pr_err("bad timeout hint after 30 ms\n");
+		return -1;
+	}
+	fake_link_set(1);
+	if (evt_poll(1050) != -1 || notifs || evt.dbnc.flaps != 1) {
+		pr_err("short flap not filtered (%u notifications, %u flaps)\n", notifs, evt.dbnc.flaps);
+		return -1;
+	}
+	/* Way after the flap: still nothing to report */
+	if (evt_poll(5000) != -1 || notifs) {
+		pr_err("filtered flap reported later\n");
+		return -1;
+	}
+	printf("  short flap filtered\n");
+	return 0;
+}
+
+static int test_link_down(void)
+{
+	int timeout;
+
+	evt_init(TEST_DEBOUNCE_MS, 1);
+	fake_link_set(0);
+	evt_poll(2000);
+	evt_poll(2000 + TEST_DEBOUNCE_MS - 1);
+	if (notifs) {
+		pr_err("link down reported before the debounce period\n");
+		return -1;
+	}
+	/* Reported on the first call after the period, no new sample needed */
+	pp2_link_evt_update(&evt, 0, 0, 2000 + TEST_DEBOUNCE_MS, &timeout);
+	if (notifs != 1 || notif_link != 0 || timeout != -1) {
+		pr_err("link down not reported after the debounce period\n");
+		return -1;
+	}
+	printf("  link down reported after %u ms\n", TEST_DEBOUNCE_MS);
+	return 0;
+}
+
+/* The link bounces every 'period' ms for 'duration' ms, then settles down */
+static int test_flap_train(u32 period, u32 duration)
+{
+	u64 now;
+	int link = 1;
+
+	evt_init(TEST_DEBOUNCE_MS, 1);
+	for (now = 0; now < duration; now += period) {
+		link = !link;
+		fake_link_set(link);
+		evt_poll(now);
+	}
+	if (notifs) {
+		pr_err("%u notifications while flapping every %u ms\n", notifs, period);
+		return -1;
+	}
+	fake_link_set(0);
+	for (; now < duration + 2 * TEST_DEBOUNCE_MS; now += period)
+		evt_poll(now);
+	if (notifs != 1 || notif_link != 0) {
+		pr_err("settled link not reported once (%u notifications)\n", notifs);
+		return -1;
+	}
+	printf("  flapping every %2u ms for %u ms: %u flaps filtered, %u notification, %u register reads\n",
+	       period, duration, evt.dbnc.flaps, notifs, fake_reads);
+	return 0;
+}
+
+/* Several notifications drained at once: only the final state counts */
+static int test_batch(void)
+{
+	int timeout;
+
+	evt_init(TEST_DEBOUNCE_MS, 1);
+	pp2_link_dbnc_sample(&evt.dbnc, 0, 100);
+	pp2_link_dbnc_sample(&evt.dbnc, 1, 100);
+	pp2_link_dbnc_sample(&evt.dbnc, 0, 100);
+	pp2_link_evt_update(&evt, 0, 0, 100, &timeout);
+	if (notifs || timeout != TEST_DEBOUNCE_MS || evt.dbnc.flaps != 1) {
+		pr_err("bad batch handling (%u notifications, timeout %d)\n", notifs, timeout);
+		return -1;
+	}
+	pp2_link_evt_update(&evt, 0, 0, 100 + TEST_DEBOUNCE_MS, &timeout);
+	if (notifs != 1 || notif_link != 0 || timeout != -1) {
+		pr_err("batched link down not reported\n");
+		return -1;
+	}
+	printf("  batched samples\n");
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+
+	if (test_no_debounce() || test_short_flap() || test_link_down() ||
+	    test_flap_train(10, 1000) || test_flap_train(60, 3000) || test_batch()) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
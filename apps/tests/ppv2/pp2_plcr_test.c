@@ -0,0 +1,336 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+/*
+ * Policer model test: the srTCM/trTCM semantics of the software policer, and
+ * a sweep of CIRs through the PPv2 policer programming
+ * (pp2_cls_plcr_get_hw_info()) checked against the software policer run with
+ * the resulting HW parameters. No HW access is needed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mv_std.h"
+#include "mv_pp2_cls.h"
+#include "lib/mv_policer.h"
+
+#define PLCR_NSEC_PER_SEC	1000000000ULL
+#define PLCR_SWEEP_STEP_PCT	7	/* CIR sweep geometric step */
+#define PLCR_SWEEP_UPDATES	400	/* HW token updates simulated per CIR */
+#define PLCR_SWEEP_WORST	3	/* worst deviations reported per unit */
+#define PLCR_KB			1024
+#define PLCR_MIN_KB		64
+#define PLCR_MIN_PKTS		1024
+
+#define PLCR_CHECK(cond, ...)					\
+	do {							\
+		if (!(cond)) {					\
+			printf("  line %d: ", __LINE__);	\
+			printf(__VA_ARGS__);			\
+			printf("\n");				\
+			err = -1;				\
+		}						\
+	} while (0)
+
+static int test_srtcm(void)
+{
+	struct mv_plcr_params	params;
+	struct mv_plcr_stats	stats;
+	struct mv_plcr		*plcr;
+	int			err = 0;
+
+	memset(&params, 0, sizeof(params));
+	params.mode = MV_PLCR_MODE_SRTCM;
+	params.cir = 1000;
+	params.cbs = 1500;
+	params.ebs = 1500;
+	if (mv_plcr_create(&params, 0, &plcr))
+		return -1;
+
+	PLCR_CHECK(mv_plcr_meter(plcr, 1000, MV_PLCR_COLOR_GREEN, 0) == MV_PLCR_COLOR_GREEN, "green");
+	PLCR_CHECK(mv_plcr_meter(plcr, 1000, MV_PLCR_COLOR_GREEN, 0) == MV_PLCR_COLOR_YELLOW, "yellow");
+	PLCR_CHECK(mv_plcr_meter(plcr, 1000, MV_PLCR_COLOR_GREEN, 0) == MV_PLCR_COLOR_RED, "red");
+	/* color blind: the input color is ignored */
+	PLCR_CHECK(mv_plcr_meter(plcr, 100, MV_PLCR_COLOR_RED, 0) == MV_PLCR_COLOR_GREEN, "blind");
+	/* 2 sec: 2000 tokens fill the committed bucket (1500) and overflow into the excess one */
+	PLCR_CHECK(mv_plcr_meter(plcr, 1600, MV_PLCR_COLOR_GREEN, 2 * PLCR_NSEC_PER_SEC) == MV_PLCR_COLOR_RED,
+		   "buckets overfilled");
+	PLCR_CHECK(mv_plcr_meter(plcr, 1500, MV_PLCR_COLOR_GREEN, 2 * PLCR_NSEC_PER_SEC) == MV_PLCR_COLOR_GREEN,
+		   "committed bucket not filled");
+	PLCR_CHECK(mv_plcr_meter(plcr, 1400, MV_PLCR_COLOR_GREEN, 2 * PLCR_NSEC_PER_SEC) == MV_PLCR_COLOR_YELLOW,
+		   "excess bucket not filled");
+	PLCR_CHECK(mv_plcr_meter(plcr, 1, MV_PLCR_COLOR_GREEN, 2 * PLCR_NSEC_PER_SEC) == MV_PLCR_COLOR_RED,
+		   "buckets not empty");
+	mv_plcr_get_stats(plcr, &stats, 1);
+	PLCR_CHECK(stats.pkts[MV_PLCR_COLOR_GREEN] == 3 && stats.pkts[MV_PLCR_COLOR_YELLOW] == 2 &&
+		   stats.pkts[MV_PLCR_COLOR_RED] == 3 && stats.tokens[MV_PLCR_COLOR_GREEN] == 2600, "stats");
+	mv_plcr_destroy(plcr);
+
+	/* color aware: yellow is never promoted, even with committed tokens */
+	params.color_aware = 1;
+	if (mv_plcr_create(&params, 0, &plcr))
+		return -1;
+	PLCR_CHECK(mv_plcr_meter(plcr, 100, MV_PLCR_COLOR_YELLOW, 0) == MV_PLCR_COLOR_YELLOW, "aware yellow");
+	PLCR_CHECK(mv_plcr_meter(plcr, 100, MV_PLCR_COLOR_RED, 0) == MV_PLCR_COLOR_RED, "aware red");
+	PLCR_CHECK(mv_plcr_meter(plcr, 100, MV_PLCR_COLOR_GREEN, 0) == MV_PLCR_COLOR_GREEN, "aware green");
+	mv_plcr_destroy(plcr);
+
+	/* discrete updates: nothing is credited until the period ends */
+	params.color_aware = 0;
+	params.cir = 1000000;
+	params.cbs = 1000;
+	params.ebs = 0;
+	params.update_period_ns = 1000000;
+	if (mv_plcr_create(&params, 0, &plcr))
+		return -1;
+	PLCR_CHECK(mv_plcr_meter(plcr, 1000, MV_PLCR_COLOR_GREEN, 0) == MV_PLCR_COLOR_GREEN, "period green");
+	PLCR_CHECK(mv_plcr_meter(plcr, 1, MV_PLCR_COLOR_GREEN, 999999) == MV_PLCR_COLOR_RED, "early credit");
+	PLCR_CHECK(mv_plcr_meter(plcr, 1000, MV_PLCR_COLOR_GREEN, 1000000) == MV_PLCR_COLOR_GREEN, "period credit");
+	mv_plcr_destroy(plcr);
+
+	params.cir = 0;
+	PLCR_CHECK(mv_plcr_create(&params, 0, &plcr) == -EINVAL, "cir 0 accepted");
+	return err;
+}
+
+static int test_trtcm(void)
+{
+	struct mv_plcr_params	params;
+	struct mv_plcr		*plcr;
+	int			err = 0;
+
+	memset(&params, 0, sizeof(params));
+	params.mode = MV_PLCR_MODE_TRTCM;
+	params.cir = 1000;
+	params.pir = 2000;
+	params.cbs = 1000;
+	params.ebs = 2000;
+	if (mv_plcr_create(&params, 0, &plcr))
+		return -1;
+
+	PLCR_CHECK(mv_plcr_meter(plcr, 1000, MV_PLCR_COLOR_GREEN, 0) == MV_PLCR_COLOR_GREEN, "green");
+	PLCR_CHECK(mv_plcr_meter(plcr, 1000, MV_PLCR_COLOR_GREEN, 0) == MV_PLCR_COLOR_YELLOW, "yellow");
+	PLCR_CHECK(mv_plcr_meter(plcr, 1, MV_PLCR_COLOR_GREEN, 0) == MV_PLCR_COLOR_RED, "red");
+	/* 0.5 sec: 500 committed and 1000 peak tokens */
+	PLCR_CHECK(mv_plcr_meter(plcr, 600, MV_PLCR_COLOR_GREEN, PLCR_NSEC_PER_SEC / 2) == MV_PLCR_COLOR_YELLOW,
+		   "committed rate");
+	PLCR_CHECK(mv_plcr_meter(plcr, 400, MV_PLCR_COLOR_GREEN, PLCR_NSEC_PER_SEC / 2) == MV_PLCR_COLOR_GREEN,
+		   "committed tokens");
+	PLCR_CHECK(mv_plcr_meter(plcr, 1, MV_PLCR_COLOR_GREEN, PLCR_NSEC_PER_SEC / 2) == MV_PLCR_COLOR_RED,
+		   "peak rate");
+	mv_plcr_destroy(plcr);
+
+	params.pir = 500;
+	PLCR_CHECK(mv_plcr_create(&params, 0, &plcr) == -EINVAL, "pir < cir accepted");
+	return err;
+}
+
+/* run a greedy source through the policer modeling the HW and measure its green rate */
+static u64 sweep_measure(struct pp2_cls_plcr_hw_info *info, int bytes)
+{
+	struct mv_plcr_params	params;
+	struct mv_plcr_stats	stats;
+	struct mv_plcr		*plcr;
+	u32			len = bytes ? 64 : 1;
+	u64			t = 0;
+	int			i;
+
+	memset(&params, 0, sizeof(params));
+	params.mode = MV_PLCR_MODE_SRTCM;
+	params.cir = info->rate;
+	params.cbs = bytes ? info->cbs * PLCR_KB : info->cbs;
+	params.update_period_ns = info->update_period_ns;
+	if (mv_plcr_create(&params, 0, &plcr))
+		return 0;
+
+	for (i = 0; i <= PLCR_SWEEP_UPDATES; i++, t += info->update_period_ns) {
+		/* the first round drains the initial burst */
+		if (i == 1)
+			mv_plcr_get_stats(plcr, NULL, 1);
+		while (mv_plcr_meter(plcr, len, MV_PLCR_COLOR_GREEN, t) == MV_PLCR_COLOR_GREEN)
+			;
+	}
+	mv_plcr_get_stats(plcr, &stats, 0);
+	mv_plcr_destroy(plcr);
+
+	return stats.tokens[MV_PLCR_COLOR_GREEN] * PLCR_NSEC_PER_SEC /
+	       (PLCR_SWEEP_UPDATES * info->update_period_ns);
+}
+
+static int test_hw_sweep(enum pp2_cls_plcr_token_unit unit, u32 min_cir, u32 max_cir)
+{
+	struct pp2_cls_plcr_params	params;
+	struct pp2_cls_plcr_hw_info	info, worst[PLCR_SWEEP_WORST];
+	u32				worst_cir[PLCR_SWEEP_WORST];
+	int				bytes = (unit == PP2_CLS_PLCR_BYTES_TOKEN_UNIT);
+	const char			*units = bytes ? "Kbps" : "pps";
+	u64				cir, measured, diff;
+	u32				points = 0, i, j;
+	int				err = 0;
+
+	memset(worst, 0, sizeof(worst));
+	memset(&params, 0, sizeof(params));
+	params.token_unit = unit;
+	params.color_mode = PP2_CLS_PLCR_COLOR_BLIND_MODE;
+	/* the smallest bursts, valid for all the token types */
+	params.cbs = bytes ? PLCR_MIN_KB : PLCR_MIN_PKTS;
+	params.ebs = params.cbs;
+
+	for (cir = min_cir; cir <= max_cir; cir = cir * (100 + PLCR_SWEEP_STEP_PCT) / 100, points++) {
+		params.cir = cir;
+		if (pp2_cls_plcr_get_hw_info(&params, &info)) {
+			PLCR_CHECK(0, "CIR %llu %s rejected", (unsigned long long)cir, units);
+			continue;
+		}
+		PLCR_CHECK(info.token_value && info.token_value < 1024 && info.token_type <= 4,
+			   "CIR %llu: token type %u value %u", (unsigned long long)cir, info.token_type,
+			   info.token_value);
+		PLCR_CHECK(info.rate == (u64)min(info.update_tokens, bytes ? info.cbs * PLCR_KB : info.cbs) *
+				PLCR_NSEC_PER_SEC / info.update_period_ns,
+			   "CIR %llu: rate %llu", (unsigned long long)cir, (unsigned long long)info.rate);
+
+		/* the software model enforces the rate reported for the HW */
+		measured = sweep_measure(&info, bytes);
+		diff = (measured > info.rate) ? measured - info.rate : info.rate - measured;
+		PLCR_CHECK(diff * 100 <= info.rate, "CIR %llu: model rate %llu, HW rate %llu",
+			   (unsigned long long)cir, (unsigned long long)measured, (unsigned long long)info.rate);
+
+		for (i = 0; i < PLCR_SWEEP_WORST; i++)
+			if (abs(info.rate_err_ppm) > abs(worst[i].rate_err_ppm))
+				break;
+		if (i < PLCR_SWEEP_WORST) {
+			for (j = PLCR_SWEEP_WORST - 1; j > i; j--) {
+				worst[j] = worst[j - 1];
+				worst_cir[j] = worst_cir[j - 1];
+			}
+			worst[i] = info;
+			worst_cir[i] = cir;
+		}
+	}
+
+	printf("  %s: %u CIRs from %u to %u, worst deviations:\n", units, points, min_cir, max_cir);
+	for (i = 0; i < PLCR_SWEEP_WORST; i++)
+		printf("    %10u %s enforced as %10u (%+.2f%%, token type %u value %u)\n",
+		       worst_cir[i], units, worst[i].cir, worst[i].rate_err_ppm / 10000.0,
+		       worst[i].token_type, worst[i].token_value);
+
+	/* out of range CIRs are rejected */
+	params.cir = min_cir / 2;
+	PLCR_CHECK(pp2_cls_plcr_get_hw_info(&params, &info), "CIR %u %s accepted", params.cir, units);
+	return err;
+}
+
+int main(int argc, char *argv[])
+{
+	int err = 0;
+
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	printf("Policer model test:\n");
+
+	err |= test_srtcm();
+	err |= test_trtcm();
+	err |= test_hw_sweep(PP2_CLS_PLCR_BYTES_TOKEN_UNIT, 104, 10000000);
+	err |= test_hw_sweep(PP2_CLS_PLCR_PACKETS_TOKEN_UNIT, 125, 1000000000);
+
+	if (err) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
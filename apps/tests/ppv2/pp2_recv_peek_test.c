@@ -0,0 +1,283 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+/*
+ * Unit test of pp2_ppio_recv_peek()/pp2_ppio_recv_release() over a memory
+ * backed fake in-Q: the port register slot and the RXQ descriptor ring are
+ * plain memory, so the test plays the HW by writing the RXQ occupancy register
+ * and descriptors and checks what the driver writes back.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "std_internal.h"
+#include "pp2.h"
+#include "pp2_port.h"
+#include "drivers/mv_pp2_ppio.h"
+
+#define TEST_RING_SIZE		16
+#define TEST_RXQ_ID		5
+#define TEST_REGS_SIZE		0x10000
+
+static u32 test_regs[TEST_REGS_SIZE / sizeof(u32)];
+static struct pp2_desc test_ring[TEST_RING_SIZE] __attribute__((aligned(32)));
+static struct pp2_rx_queue test_rxq;
+static struct pp2_rx_queue *test_rxqs[1] = {&test_rxq};
+static struct pp2_port test_port;
+static struct pp2_ppio test_ppio;
+static u32 test_seq;	/* next descriptor value 'written by the HW' */
+
+static u32 *test_reg(u32 offset)
+{
+	return &test_regs[offset / sizeof(u32)];
+}
+
+/* the HW receives 'num' packets: fill descriptors and raise the occupancy */
+static void hw_receive(u32 num)
+{
+	static u32 hw_idx;
+	struct pp2_ppio_desc *desc;
+	u32 i;
+
+	for (i = 0; i < num; i++) {
+		desc = (struct pp2_ppio_desc *)&test_ring[hw_idx];
+		memset(desc, 0, sizeof(*desc));
+		/* packet length and cookie, as the accessors read them */
+		desc->cmds[1] = (64 + MV_MH_SIZE + test_seq) << 16;
+		desc->cmds[6] = 0x1000 + test_seq;
+		test_seq++;
+		hw_idx = (hw_idx + 1) % TEST_RING_SIZE;
+	}
+	*test_reg(MVPP2_RXQ_STATUS_REG(TEST_RXQ_ID)) += num;
+}
+
+/* the driver's RXQ status update, applied as the HW would */
+static int hw_check_update(u32 expected)
+{
+	u32 *upd = test_reg(MVPP2_RXQ_STATUS_UPDATE_REG(TEST_RXQ_ID));
+	u32 used = *upd & 0xffff, new = *upd >> MVPP2_RXQ_NUM_NEW_OFFSET;
+
+	if (used != expected || new != expected) {
+		pr_err("RXQ update: used %u, new %u, expected %u\n", used, new, expected);
+		return -1;
+	}
+	*test_reg(MVPP2_RXQ_STATUS_REG(TEST_RXQ_ID)) -= used;
+	*upd = 0;
+	return 0;
+}
+
+static void test_init(void)
+{
+	memset(test_regs, 0, sizeof(test_regs));
+	memset(&test_rxq, 0, sizeof(test_rxq));
+	memset(&test_port, 0, sizeof(test_port));
+	test_rxq.id = TEST_RXQ_ID;
+	test_rxq.desc_total = TEST_RING_SIZE;
+	test_rxq.desc_virt_arr = test_ring;
+	test_port.cpu_slot = (uintptr_t)test_regs;
+	test_port.rxqs = test_rxqs;
+	test_port.tc[0].first_log_rxq = 0;
+	test_ppio.internal_param = &test_port;
+}
+
+/* peek up to 'max', expect 'exp' descriptors starting at ring index 'idx'
+ * carrying sequence numbers from 'seq'
+ */
+static int peek_check(u16 max, u16 exp, u32 idx, u32 seq)
+{
+	struct pp2_ppio_desc *descs;
+	u16 num = max, i;
+
+	if (pp2_ppio_recv_peek(&test_ppio, 0, 0, &descs, &num)) {
+		pr_err("peek failed\n");
+		return -1;
+	}
+	if (num != exp || (num && descs != (struct pp2_ppio_desc *)&test_ring[idx])) {
+		pr_err("peek: got %u at %ld, expected %u at %u\n", num,
+		       (long)((struct pp2_desc *)descs - test_ring), exp, idx);
+		return -1;
+	}
+	for (i = 0; i < num; i++) {
+		if (pp2_ppio_inq_desc_get_pkt_len(&descs[i]) != 64 + seq + i ||
+		    pp2_ppio_inq_desc_get_cookie(&descs[i]) != 0x1000 + seq + i) {
+			pr_err("desc %u: len %u cookie 0x%llx, expected seq %u\n", i,
+			       pp2_ppio_inq_desc_get_pkt_len(&descs[i]),
+			       (unsigned long long)pp2_ppio_inq_desc_get_cookie(&descs[i]), seq + i);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static int release_check(u16 num)
+{
+	if (pp2_ppio_recv_release(&test_ppio, 0, 0, num))
+		return -1;
+	return num ? hw_check_update(num) : 0;
+}
+
+static int test_basic(void)
+{
+	test_init();
+
+	/* empty queue */
+	if (peek_check(8, 0, 0, 0))
+		return -1;
+
+	hw_receive(5);
+	/* peeking twice gives the same descriptors; 'num' limits the result */
+	if (peek_check(32, 5, 0, 0) || peek_check(3, 3, 0, 0))
+		return -1;
+	if (release_check(3) || test_rxq.desc_next_idx != 3)
+		return -1;
+	if (peek_check(32, 2, 3, 3) || release_check(2))
+		return -1;
+
+	/* releasing more than received is refused */
+	if (!pp2_ppio_recv_release(&test_ppio, 0, 0, 1)) {
+		pr_err("over-release accepted\n");
+		return -1;
+	}
+	return 0;
+}
+
+static int test_wrap(void)
+{
+	/* continue from index 5: fill up to the ring end and wrap by 4 */
+	hw_receive(TEST_RING_SIZE - 5 + 4);
+	if (peek_check(32, TEST_RING_SIZE - 5, 5, 5))
+		return -1;
+	if (release_check(TEST_RING_SIZE - 5) || test_rxq.desc_next_idx != 0)
+		return -1;
+	if (peek_check(32, 4, 0, TEST_RING_SIZE) || release_check(4))
+		return -1;
+	return 0;
+}
+
+/* peek/release and pp2_ppio_recv() see the same packets and may be mixed */
+static int test_mixed(void)
+{
+	struct pp2_ppio_desc descs[TEST_RING_SIZE];
+	u32 seq = test_seq, i;
+	u16 num;
+
+	hw_receive(10);
+	num = 4;
+	if (pp2_ppio_recv(&test_ppio, 0, 0, descs, &num) || num != 4 || hw_check_update(4))
+		return -1;
+	for (i = 0; i < num; i++)
+		if (pp2_ppio_inq_desc_get_cookie(&descs[i]) != 0x1000 + seq + i) {
+			pr_err("recv: bad desc %u\n", i);
+			return -1;
+		}
+	if (peek_check(32, 6, (seq + 4) % TEST_RING_SIZE, seq + 4) || release_check(6))
+		return -1;
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+
+	if (test_basic() || test_wrap() || test_mixed()) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
@@ -0,0 +1,302 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+/*
+ * Unit test of the physical TXQ descriptor reservation cache used by
+ * pp2_port_enqueue(), against a fake register backend that models the HW
+ * reservation accounting of one physical TXQ shared by several hifs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mv_std.h"
+
+/* fake register backend; 'cpu_slot' carries the hif index */
+static u32 fake_txq_rsrv_request(uintptr_t cpu_slot, u32 txq_id, u32 num);
+#define pp2_txq_rsrv_hw_request	fake_txq_rsrv_request
+
+#include "pp2_txq_rsrv.h"
+
+#define TEST_MAX_HIFS		4
+#define TEST_TXQ_ID		10
+#define TEST_BURSTS		100000
+
+struct fake_txq {
+	u32	size;
+	u32	pending;			/* descriptors waiting for transmission */
+	u32	rsvd[TEST_MAX_HIFS];		/* reserved per hif */
+	u32	reqs;
+	int	err;
+};
+
+static struct fake_txq fake;
+
+static u32 fake_txq_rsrv_request(uintptr_t cpu_slot, u32 txq_id, u32 num)
+{
+	u32 i, used = fake.pending, grant;
+
+	fake.reqs++;
+	if (cpu_slot >= TEST_MAX_HIFS || txq_id != TEST_TXQ_ID || !num || num > MVPP2_TXQ_RSVD_RSLT_MASK) {
+		pr_err("bad reservation request: hif %lu, txq %u, num %u\n", (unsigned long)cpu_slot, txq_id, num);
+		fake.err = 1;
+		return 0;
+	}
+	for (i = 0; i < TEST_MAX_HIFS; i++)
+		used += fake.rsvd[i];
+	grant = min(num, fake.size - used);
+	fake.rsvd[cpu_slot] += grant;
+	return grant;
+}
+
+/* the hif sent 'num' descriptors into the TXQ */
+static int fake_txq_send(int hif, u32 num)
+{
+	if (fake.rsvd[hif] < num) {
+		pr_err("hif %d sent %u descriptors with only %u reserved\n", hif, num, fake.rsvd[hif]);
+		return -1;
+	}
+	fake.rsvd[hif] -= num;
+	fake.pending += num;
+	return 0;
+}
+
+static void fake_txq_xmit(u32 num)
+{
+	fake.pending -= min(num, fake.pending);
+}
+
+static void fake_txq_init(u32 size)
+{
+	memset(&fake, 0, sizeof(fake));
+	fake.size = size;
+}
+
+/* Runs 'num_hifs' hifs sending random bursts through one TXQ and checks that
+ * the cache always matches the HW accounting and that at least 'min_pct'
+ * percent of the descriptors got sent. Returns the number of reservation
+ * round-trips per 1000 bursts, or <0 on error.
+ */
+static int run(int num_hifs, u32 txq_size, u16 chunk, u16 max_burst, u32 xmit_per_burst, u32 min_pct)
+{
+	struct pp2_txq_dm_if cache[TEST_MAX_HIFS];
+	u64 sent = 0, wanted = 0;
+	u32 reqs = 0;
+	int i, hif;
+	u16 num, got;
+
+	memset(cache, 0, sizeof(cache));
+	fake_txq_init(txq_size);
+
+	for (i = 0; i < TEST_BURSTS; i++) {
+		hif = rand() % num_hifs;
+		num = 1 + rand() % max_burst;
+
+		got = pp2_txq_dm_if_reserve(&cache[hif], hif, TEST_TXQ_ID, num, chunk);
+		if (got > num || got > cache[hif].desc_rsrvd) {
+			pr_err("reserve returned %u of %u (cached %u)\n", got, num, cache[hif].desc_rsrvd);
+			return -1;
+		}
+		if (fake_txq_send(hif, got))
+			return -1;
+		pp2_txq_dm_if_consume(&cache[hif], got);
+		if (cache[hif].desc_rsrvd != fake.rsvd[hif]) {
+			pr_err("hif %d: cached %u, HW reserved %u\n", hif, cache[hif].desc_rsrvd, fake.rsvd[hif]);
+			return -1;
+		}
+		sent += got;
+		wanted += num;
+		fake_txq_xmit(xmit_per_burst);
+		if (fake.err)
+			return -1;
+	}
+
+	if (sent * 100 < wanted * min_pct) {
+		pr_err("too little sent: %llu of %llu\n", (unsigned long long)sent, (unsigned long long)wanted);
+		return -1;
+	}
+	for (i = 0; i < num_hifs; i++)
+		reqs += cache[i].rsrv_reqs;
+	if (reqs != fake.reqs) {
+		pr_err("round-trips: counted %u, HW saw %u\n", reqs, fake.reqs);
+		return -1;
+	}
+	return (int)((u64)fake.reqs * 1000 / TEST_BURSTS);
+}
+
+static int test_chunks(void)
+{
+	static const u16 chunks[] = {MVPP2_CPU_DESC_CHUNK, 256, 1024};
+	int i, rt, prev = -1;
+
+	for (i = 0; i < ARRAY_SIZE(chunks); i++) {
+		rt = run(1, 2048, chunks[i], 64, 64, 95);
+		if (rt < 0)
+			return -1;
+		printf("  1 hif, chunk %4u: %4d round-trips per 1000 bursts\n", chunks[i], rt);
+		if (prev >= 0 && rt >= prev) {
+			pr_err("larger chunk did not save round-trips\n");
+			return -1;
+		}
+		prev = rt;
+	}
+	return 0;
+}
+
+static int test_shared_txq(void)
+{
+	int rt;
+
+	/* 4 hifs, chunks covering the whole TXQ: partial grants, no overcommit */
+	rt = run(4, 1024, 512, 32, 32, 90);
+	if (rt < 0)
+		return -1;
+	printf("  4 hifs, chunk  512: %4d round-trips per 1000 bursts (TXQ of 1024)\n", rt);
+
+	/* slow transmission (8 of ~16 descriptors per burst): the TXQ fills
+	 * up, reservations are partial and sending is limited by the TXQ
+	 */
+	rt = run(4, 1024, 64, 32, 8, 45);
+	if (rt < 0)
+		return -1;
+	printf("  4 hifs, chunk   64: %4d round-trips per 1000 bursts (congested TXQ)\n", rt);
+	return 0;
+}
+
+static int test_limits(void)
+{
+	struct pp2_txq_dm_if cache;
+
+	memset(&cache, 0, sizeof(cache));
+	fake_txq_init(0xffff);
+
+	/* requests are clamped to what the result register can report */
+	if (pp2_txq_dm_if_reserve(&cache, 0, TEST_TXQ_ID, 16, 0xffff) != 16 || fake.err ||
+	    cache.desc_rsrvd != MVPP2_TXQ_RSVD_RSLT_MASK) {
+		pr_err("chunk not clamped (reserved %u)\n", cache.desc_rsrvd);
+		return -1;
+	}
+
+	/* cached reservation is used without a HW round-trip */
+	fake.reqs = 0;
+	if (pp2_txq_dm_if_reserve(&cache, 0, TEST_TXQ_ID, 32, 64) != 32 || fake.reqs) {
+		pr_err("cached reservation not used\n");
+		return -1;
+	}
+
+	/* empty TXQ: nothing granted */
+	memset(&cache, 0, sizeof(cache));
+	fake_txq_init(0);
+	if (pp2_txq_dm_if_reserve(&cache, 1, TEST_TXQ_ID, 8, 64) != 0 || cache.desc_rsrvd) {
+		pr_err("reserved from a full TXQ\n");
+		return -1;
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	srand(1);
+
+	if (test_limits() || test_chunks() || test_shared_txq()) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
@@ -0,0 +1,294 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "mv_std.h"
+#include "lib/mv_replay_win.h"
+
+#define RW_REF_SPAN		(1 << 16)	/* sequence range tracked by the reference model */
+
+#define RW_CHECK(cond, ...)			\
+	do {					\
+		if (!(cond)) {			\
+			printf(__VA_ARGS__);	\
+			return -1;		\
+		}				\
+	} while (0)
+
+static const u32 rw_sizes[] = {64, 128, 1024, 4096};
+
+/* check + commit as done by the SAM driver; returns the commit status */
+static int rw_recv(struct mv_replay_win *win, u64 full)
+{
+	u64 seq;
+	int err;
+
+	err = mv_replay_win_check(win, lower_32_bits(full), &seq);
+	if (err)
+		return err;
+	if (seq != full)
+		return -EINVAL;
+	return mv_replay_win_commit(win, seq);
+}
+
+static int test_edges(u32 size)
+{
+	struct mv_replay_win *win;
+	u64 seq;
+
+	RW_CHECK(!mv_replay_win_create(size, 0, 0, &win), "create failed\n");
+	RW_CHECK(rw_recv(win, 0) == -ERANGE, "seq 0 accepted\n");
+	RW_CHECK(!rw_recv(win, 1), "first packet rejected\n");
+	RW_CHECK(rw_recv(win, 1) == -EEXIST, "duplicate accepted\n");
+	/* jump ahead by exactly the window size: seq 1 leaves the window */
+	RW_CHECK(!rw_recv(win, size + 1), "jump rejected\n");
+	RW_CHECK(rw_recv(win, 1) == -ERANGE, "seq left of the window accepted\n");
+	RW_CHECK(!rw_recv(win, 2), "left edge of the window rejected\n");
+	RW_CHECK(rw_recv(win, 2) == -EEXIST, "left edge duplicate accepted\n");
+	RW_CHECK(!rw_recv(win, size), "right part of the window rejected\n");
+	/* a pre-checked packet whose duplicate was committed in the meantime */
+	RW_CHECK(!mv_replay_win_check(win, size + 2, &seq), "check failed\n");
+	RW_CHECK(!mv_replay_win_commit(win, seq), "commit failed\n");
+	RW_CHECK(mv_replay_win_commit(win, seq) == -EEXIST, "double commit accepted\n");
+	/* check must not move the window */
+	RW_CHECK(!mv_replay_win_check(win, 100000, NULL), "check failed\n");
+	RW_CHECK(mv_replay_win_top(win) == size + 2, "check moved the window\n");
+	/* huge jump clears everything */
+	RW_CHECK(!rw_recv(win, 0xfffffff0ULL), "big jump rejected\n");
+	RW_CHECK(rw_recv(win, 0xfffffff0ULL - size) == -ERANGE, "old seq accepted after jump\n");
+	RW_CHECK(!rw_recv(win, 0xfffffff0ULL - size + 1), "window after jump not empty\n");
+	RW_CHECK(!rw_recv(win, 0xffffffffULL), "last 32-bit seq rejected\n");
+	mv_replay_win_destroy(win);
+	return 0;
+}
+
+static int test_esn(u32 size)
+{
+	struct mv_replay_win *win;
+	u64 top = 0xffffffffULL - size / 2;
+	u64 seq;
+
+	/* window straddles the 2^32 boundary after the wrap */
+	RW_CHECK(!mv_replay_win_create(size, top, 1, &win), "create failed\n");
+	RW_CHECK(!rw_recv(win, top - 1), "in-window seq rejected\n");
+	RW_CHECK(!rw_recv(win, 0x100000003ULL), "wrapped seq rejected\n");
+	RW_CHECK(mv_replay_win_top(win) == 0x100000003ULL, "bad top after wrap\n");
+	/* low part 0xffffff.. now infers the previous subspace */
+	RW_CHECK(!mv_replay_win_check(win, 0xfffffffeU, &seq) && seq == 0xfffffffeULL,
+		 "bad inference below the wrap\n");
+	RW_CHECK(!rw_recv(win, 0xfffffffeULL), "seq below the wrap rejected\n");
+	RW_CHECK(rw_recv(win, top - 1) == -EEXIST, "duplicate across the wrap accepted\n");
+	RW_CHECK(!rw_recv(win, 0x100000000ULL), "seq with low part 0 rejected\n");
+	/* far ahead in the same subspace */
+	RW_CHECK(!mv_replay_win_check(win, 0x80000000U, &seq) && seq == 0x180000000ULL,
+		 "bad inference ahead\n");
+	/* new SA: numbers in the top of the 32-bit space would be subspace -1 */
+	mv_replay_win_destroy(win);
+	RW_CHECK(!mv_replay_win_create(size, 0, 1, &win), "create failed\n");
+	RW_CHECK(mv_replay_win_check(win, 0xffffffffU, NULL) == -ERANGE, "negative subspace accepted\n");
+	RW_CHECK(!rw_recv(win, 1), "first packet rejected\n");
+	mv_replay_win_destroy(win);
+
+	/* non-ESN windows never wrap */
+	RW_CHECK(mv_replay_win_create(size, 0x100000000ULL, 0, &win), "64-bit seq accepted without ESN\n");
+	return 0;
+}
+
+/* Random arrival order checked against a plain per-sequence-number model */
+static int test_random(u32 size, int esn)
+{
+	struct mv_replay_win *win;
+	u8 *seen;
+	u64 base = esn ? 0xffff8000ULL : 0, top = base, seq, full;
+	int i, err, exp;
+
+	seen = calloc(RW_REF_SPAN, 1);
+	RW_CHECK(seen, "no mem\n");
+	RW_CHECK(!mv_replay_win_create(size, base, esn, &win), "create failed\n");
+	for (i = 0; i < 200000; i++) {
+		/* mostly in order with reordering, duplicates and old packets */
+		full = top + 1 + (rand() % (size / 4 + 1));
+		if (rand() & 1)
+			full = top - (rand() % (2 * size));
+		if (full <= base || full - base >= RW_REF_SPAN)
+			continue;
+		if (!esn && full > 0xffffffffULL)
+			continue;
+
+		if (full > top)
+			exp = 0;
+		else if (top - full >= size)
+			exp = -ERANGE;
+		else
+			exp = seen[full - base] ? -EEXIST : 0;
+
+		err = mv_replay_win_check(win, lower_32_bits(full), &seq);
+		if (esn && exp == -ERANGE) {
+			/* the high bits of a packet far behind the window can't be
+			 * inferred; it is mapped to another number and fails ICV
+			 */
+			RW_CHECK(err || seq != full, "old seq %llx accepted\n", (unsigned long long)full);
+			continue;
+		}
+		RW_CHECK(err == exp, "check %llx: %d expected %d\n", (unsigned long long)full, err, exp);
+		if (err)
+			continue;
+		RW_CHECK(seq == full, "inferred %llx for %llx\n", (unsigned long long)seq,
+			 (unsigned long long)full);
+		RW_CHECK(!mv_replay_win_commit(win, seq), "commit %llx failed\n", (unsigned long long)seq);
+		seen[full - base] = 1;
+		if (full > top)
+			top = full;
+		if (top - base > RW_REF_SPAN - 2 * size)
+			break;
+	}
+	free(seen);
+	mv_replay_win_destroy(win);
+	return 0;
+}
+
+static int test_burst(void)
+{
+	struct mv_replay_win *win;
+	struct mv_replay_win_stats stats;
+	u32 lo[6] = {5, 3, 5, 70, 0, 200};
+	u64 seq[6];
+	u16 passed;
+
+	RW_CHECK(!mv_replay_win_create(64, 0, 0, &win), "create failed\n");
+	RW_CHECK(!rw_recv(win, 3) && !rw_recv(win, 40), "setup failed\n");
+	passed = mv_replay_win_check_burst(win, lo, seq, 6);
+	RW_CHECK(passed == 4, "burst passed %u\n", passed);
+	RW_CHECK(seq[0] == 5 && !seq[1] && seq[2] == 5 && seq[3] == 70 && !seq[4] && seq[5] == 200,
+		 "bad burst results\n");
+	/* the second copy of 5 in the burst fails on commit */
+	RW_CHECK(!mv_replay_win_commit(win, seq[0]), "commit failed\n");
+	RW_CHECK(mv_replay_win_commit(win, seq[2]) == -EEXIST, "in-burst duplicate accepted\n");
+	mv_replay_win_get_stats(win, &stats, 1);
+	RW_CHECK(stats.accepted == 3 && stats.duplicates == 2 && stats.too_old == 1,
+		 "bad stats %llu/%llu/%llu\n", (unsigned long long)stats.accepted,
+		 (unsigned long long)stats.duplicates, (unsigned long long)stats.too_old);
+	mv_replay_win_destroy(win);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int seed = (argc > 1) ? atoi(argv[1]) : 1;
+	int i, err = 0;
+
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	printf("Anti-replay window test (seed %u):\n", seed);
+	srand(seed);
+
+	for (i = 0; i < ARRAY_SIZE(rw_sizes); i++) {
+		err |= test_edges(rw_sizes[i]);
+		err |= test_esn(rw_sizes[i]);
+		err |= test_random(rw_sizes[i], 0);
+		err |= test_random(rw_sizes[i], 1);
+	}
+	err |= test_burst();
+	if (err) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
@@ -0,0 +1,279 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "mv_std.h"
+#include "mv_ring.h"
+
+#define RING_TEST_SIZE		256
+#define RING_TEST_MAX_THREADS	8
+#define RING_TEST_PER_PROD	50000
+#define RING_TEST_MAX_BURST	32
+
+/* Objects are (producer << 24 | seq + 1) cast to pointers */
+#define RING_TEST_OBJ(p, s)	((void *)(uintptr_t)(((p) << 24) | ((s) + 1)))
+#define RING_TEST_PROD(o)	((int)((uintptr_t)(o) >> 24))
+#define RING_TEST_SEQ(o)	((int)((uintptr_t)(o) & 0xffffff) - 1)
+
+struct ring_test_thread {
+	pthread_t	 trd;
+	int		 id;
+	unsigned int	 seed;
+	u64		 consumed;
+	int		 err;
+};
+
+static struct mv_ring	*ring;
+static int		 num_prods;
+static int		 prods_done;
+static u8		*seen[RING_TEST_MAX_THREADS];
+
+static void *prod_cb(void *arg)
+{
+	struct ring_test_thread	*t = arg;
+	void			*objs[RING_TEST_MAX_BURST];
+	int			 seq = 0, i, n;
+
+	while (seq < RING_TEST_PER_PROD) {
+		n = 1 + rand_r(&t->seed) % RING_TEST_MAX_BURST;
+		if (n > RING_TEST_PER_PROD - seq)
+			n = RING_TEST_PER_PROD - seq;
+		for (i = 0; i < n; i++)
+			objs[i] = RING_TEST_OBJ(t->id, seq + i);
+		n = mv_ring_enqueue_burst(ring, objs, n);
+		/* let the consumers run when the threads outnumber the cores */
+		if (!n)
+			sched_yield();
+		seq += n;
+	}
+	__atomic_add_fetch(&prods_done, 1, __ATOMIC_RELEASE);
+	return NULL;
+}
+
+static void *cons_cb(void *arg)
+{
+	struct ring_test_thread	*t = arg;
+	void			*objs[RING_TEST_MAX_BURST];
+	int			 last[RING_TEST_MAX_THREADS];
+	int			 i, n, p, s, done;
+
+	for (i = 0; i < num_prods; i++)
+		last[i] = -1;
+
+	do {
+		done = __atomic_load_n(&prods_done, __ATOMIC_ACQUIRE) == num_prods;
+		n = mv_ring_dequeue_burst(ring, objs, 1 + rand_r(&t->seed) % RING_TEST_MAX_BURST);
+		if (!n)
+			sched_yield();
+		for (i = 0; i < n; i++) {
+			p = RING_TEST_PROD(objs[i]);
+			s = RING_TEST_SEQ(objs[i]);
+			if (p >= num_prods || s < 0 || s >= RING_TEST_PER_PROD) {
+				printf("consumer %d: bad object %p\n", t->id, objs[i]);
+				t->err = -1;
+				return NULL;
+			}
+			/* FIFO: a consumer sees the objects of a producer in order */
+			if (s <= last[p]) {
+				printf("consumer %d: producer %d seq %d after %d\n", t->id, p, s, last[p]);
+				t->err = -1;
+			}
+			last[p] = s;
+			__atomic_add_fetch(&seen[p][s], 1, __ATOMIC_RELAXED);
+		}
+		t->consumed += n;
+	} while (n || !done);
+
+	return NULL;
+}
+
+static int run_test(int prods, int cons)
+{
+	struct ring_test_thread	pt[RING_TEST_MAX_THREADS], ct[RING_TEST_MAX_THREADS];
+	u64			total = 0;
+	int			i, s, err = 0;
+
+	num_prods = prods;
+	prods_done = 0;
+	for (i = 0; i < prods; i++) {
+		seen[i] = calloc(RING_TEST_PER_PROD, 1);
+		if (!seen[i])
+			return -ENOMEM;
+	}
+
+	memset(pt, 0, sizeof(pt));
+	memset(ct, 0, sizeof(ct));
+	for (i = 0; i < cons; i++) {
+		ct[i].id = i;
+		ct[i].seed = 1000 + i;
+		pthread_create(&ct[i].trd, NULL, cons_cb, &ct[i]);
+	}
+	for (i = 0; i < prods; i++) {
+		pt[i].id = i;
+		pt[i].seed = i;
+		pthread_create(&pt[i].trd, NULL, prod_cb, &pt[i]);
+	}
+	for (i = 0; i < prods; i++)
+		pthread_join(pt[i].trd, NULL);
+	for (i = 0; i < cons; i++) {
+		pthread_join(ct[i].trd, NULL);
+		err |= ct[i].err;
+		total += ct[i].consumed;
+	}
+
+	/* every object is delivered exactly once */
+	for (i = 0; i < prods; i++) {
+		for (s = 0; s < RING_TEST_PER_PROD; s++)
+			if (seen[i][s] != 1 && !err) {
+				printf("producer %d seq %d delivered %d times\n", i, s, seen[i][s]);
+				err = -1;
+			}
+		free(seen[i]);
+	}
+	if (total != (u64)prods * RING_TEST_PER_PROD || mv_ring_count(ring)) {
+		printf("%llu objects consumed, %u left\n", (unsigned long long)total, mv_ring_count(ring));
+		err = -1;
+	}
+	printf("  %d producers, %d consumers: %s\n", prods, cons, err ? "failed" : "ok");
+	return err;
+}
+
+int main(int argc, char *argv[])
+{
+	void	*obj = RING_TEST_OBJ(0, 0);
+	int	 err = 0;
+
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	printf("Lock-free ring test:\n");
+
+	if (mv_ring_create(100, &ring) != -EINVAL) {
+		printf("non power of 2 size accepted\n");
+		err = -1;
+	}
+	if (mv_ring_create(RING_TEST_SIZE, &ring)) {
+		printf("FAILED!\n");
+		return -1;
+	}
+
+	/* full and empty */
+	while (mv_ring_enqueue_burst(ring, &obj, 1))
+		;
+	if (mv_ring_count(ring) != RING_TEST_SIZE)
+		err = -1;
+	while (mv_ring_dequeue_burst(ring, &obj, 1))
+		;
+	if (mv_ring_count(ring))
+		err = -1;
+
+	err |= run_test(1, 1);
+	err |= run_test(2, 2);
+	err |= run_test(4, 1);
+	err |= run_test(1, 4);
+	err |= run_test(4, 4);
+
+	mv_ring_delete(ring);
+	if (err) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
@@ -0,0 +1,407 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "mv_std.h"
+#include "lib/mv_rl_reorder.h"
+
+/*
+ * Simulation of a first-match table: 6 specific rules of priority 0 over
+ * 16 port-range rules of priority 1 over a default rule of priority 2.
+ * The stub table checks every key after each write and clear.
+ */
+#define RR_NUM_KEYS		1024
+#define RR_NUM_SPEC		6
+#define RR_NUM_RANGE		16
+#define RR_NUM_RULES		(RR_NUM_SPEC + RR_NUM_RANGE + 1)
+#define RR_DEF_RULE		(RR_NUM_RULES - 1)
+#define RR_NUM_SLOTS		28
+#define RR_MAX_MOVES		4
+#define RR_PKTS_PER_RUN		2000
+#define RR_FREE			(-1)
+
+#define RR_CHECK(cond, ...)			\
+	do {					\
+		if (!(cond)) {			\
+			printf(__VA_ARGS__);	\
+			return -1;		\
+		}				\
+	} while (0)
+
+struct rr_rule {
+	u32	lo;
+	u32	hi;
+	u32	prio;
+};
+
+static struct rr_rule rr_rules[RR_NUM_RULES];
+static int rr_hw[RR_NUM_SLOTS];
+static u32 rr_num_slots;
+static u64 rr_writes, rr_clears, rr_errors;
+static int rr_fail_clear;
+static int rr_verify;
+
+static int rr_rule_match(u32 rule, u32 key)
+{
+	return key >= rr_rules[rule].lo && key <= rr_rules[rule].hi;
+}
+
+/* Reference: the highest priority rule that matches, unique by construction */
+static int rr_ref_lookup(u32 key)
+{
+	u32 i, best = RR_DEF_RULE;
+
+	for (i = 0; i < RR_NUM_RULES; i++)
+		if (rr_rule_match(i, key) && rr_rules[i].prio < rr_rules[best].prio)
+			best = i;
+	return best;
+}
+
+/* Table lookup; returns the rule and the number of valid entries checked */
+static int rr_hw_lookup(u32 key, u32 *cost)
+{
+	u32 s;
+
+	*cost = 0;
+	for (s = 0; s < rr_num_slots; s++) {
+		if (rr_hw[s] == RR_FREE)
+			continue;
+		(*cost)++;
+		if (rr_rule_match(rr_hw[s], key))
+			return rr_hw[s];
+	}
+	return RR_FREE;
+}
+
+static void rr_hw_verify(void)
+{
+	u32 key, cost;
+
+	if (!rr_verify)
+		return;
+	for (key = 0; key < RR_NUM_KEYS; key++)
+		if (rr_hw_lookup(key, &cost) != rr_ref_lookup(key)) {
+			printf("key %u misclassified\n", key);
+			rr_errors++;
+			return;
+		}
+}
+
+static int rr_hw_write(void *arg, u32 slot, u32 rule)
+{
+	if (slot >= rr_num_slots || rr_hw[slot] != RR_FREE) {
+		printf("write to busy slot %u\n", slot);
+		rr_errors++;
+	}
+	rr_hw[slot] = rule;
+	rr_writes++;
+	rr_hw_verify();
+	return 0;
+}
+
+static int rr_hw_clear(void *arg, u32 slot)
+{
+	if (rr_fail_clear) {
+		rr_fail_clear--;
+		return -EIO;
+	}
+	rr_hw[slot] = RR_FREE;
+	rr_clears++;
+	rr_hw_verify();
+	return 0;
+}
+
+static int rr_init(struct mv_rl_reorder **rr, u32 num_slots)
+{
+	struct mv_rl_reorder_params params;
+	u32 i;
+
+	for (i = 0; i < RR_NUM_SPEC; i++) {
+		rr_rules[i].lo = i * 100 + 10;
+		rr_rules[i].hi = i * 100 + 19;
+		rr_rules[i].prio = 0;
+	}
+	for (i = 0; i < RR_NUM_RANGE; i++) {
+		rr_rules[RR_NUM_SPEC + i].lo = i * 64;
+		rr_rules[RR_NUM_SPEC + i].hi = i * 64 + 63;
+		rr_rules[RR_NUM_SPEC + i].prio = 1;
+	}
+	rr_rules[RR_DEF_RULE].lo = 0;
+	rr_rules[RR_DEF_RULE].hi = ~0;
+	rr_rules[RR_DEF_RULE].prio = 2;
+
+	for (i = 0; i < RR_NUM_SLOTS; i++)
+		rr_hw[i] = RR_FREE;
+	rr_num_slots = num_slots;
+	rr_writes = 0;
+	rr_clears = 0;
+	rr_errors = 0;
+	/* The table is only complete once all the rules are added */
+	rr_verify = 0;
+
+	memset(&params, 0, sizeof(params));
+	params.num_slots = num_slots;
+	params.max_rules = RR_NUM_RULES;
+	params.max_moves = RR_MAX_MOVES;
+	params.write = rr_hw_write;
+	params.clear = rr_hw_clear;
+	if (mv_rl_reorder_create(&params, rr))
+		return -1;
+	/* The default rule first, to check the priority ranges */
+	if (mv_rl_reorder_add(*rr, RR_DEF_RULE, rr_rules[RR_DEF_RULE].prio))
+		return -1;
+	for (i = 0; i < RR_NUM_RULES - 1; i++)
+		if (mv_rl_reorder_add(*rr, i, rr_rules[i].prio))
+			return -1;
+	rr_verify = 1;
+	rr_hw_verify();
+	return rr_errors ? -1 : 0;
+}
+
+/* Send packets, 'hot_pct' of them to [hot_lo, hot_hi]; returns the average lookup cost x 100 */
+static u64 rr_traffic(struct mv_rl_reorder *rr, u32 hot_lo, u32 hot_hi, u32 hot_pct)
+{
+	u32 i, key, cost;
+	u64 total = 0;
+	int rule;
+
+	for (i = 0; i < RR_PKTS_PER_RUN; i++) {
+		if ((u32)(rand() % 100) < hot_pct)
+			key = hot_lo + rand() % (hot_hi - hot_lo + 1);
+		else
+			key = rand() % RR_NUM_KEYS;
+		rule = rr_hw_lookup(key, &cost);
+		mv_rl_reorder_hit(rr, rule, 1);
+		total += cost;
+	}
+	return total * 100 / RR_PKTS_PER_RUN;
+}
+
+/* Whether 'rule' is checked before all the other rules of its priority */
+static int rr_is_first(struct mv_rl_reorder *rr, u32 rule)
+{
+	u32 i;
+
+	for (i = 0; i < RR_NUM_RULES; i++)
+		if (i != rule && rr_rules[i].prio == rr_rules[rule].prio &&
+		    mv_rl_reorder_get_slot(rr, i) < mv_rl_reorder_get_slot(rr, rule))
+			return 0;
+	return 1;
+}
+
+static int rr_run(struct mv_rl_reorder *rr, u32 hot_lo, u32 hot_hi, u32 hot_pct, int runs, u64 *cost)
+{
+	u64 w;
+	int i, moves;
+
+	for (i = 0; i < runs; i++) {
+		*cost = rr_traffic(rr, hot_lo, hot_hi, hot_pct);
+		w = rr_writes;
+		moves = mv_rl_reorder_run(rr);
+		RR_CHECK(moves >= 0 && moves <= RR_MAX_MOVES && rr_writes - w == (u64)moves,
+			 "run moved %d rules with %llu writes\n", moves, (unsigned long long)(rr_writes - w));
+		RR_CHECK(!rr_errors, "lookup errors during the reorder\n");
+	}
+	return 0;
+}
+
+static int test_reorder(void)
+{
+	struct mv_rl_reorder *rr;
+	struct mv_rl_reorder_stats stats;
+	u32 hot = RR_NUM_SPEC + RR_NUM_RANGE - 1, hot2 = RR_NUM_SPEC + 3;
+	u64 cost0, cost;
+
+	RR_CHECK(!rr_init(&rr, RR_NUM_SLOTS), "init failed\n");
+
+	/* Most of the traffic to the last port range */
+	cost0 = rr_traffic(rr, rr_rules[hot].lo, rr_rules[hot].hi, 90);
+	if (rr_run(rr, rr_rules[hot].lo, rr_rules[hot].hi, 90, 50, &cost))
+		return -1;
+	RR_CHECK(rr_is_first(rr, hot), "hot rule not first\n");
+	RR_CHECK(cost < cost0, "lookup cost did not improve (%llu -> %llu)\n",
+		 (unsigned long long)cost0, (unsigned long long)cost);
+	printf("  hot range: lookup cost %llu.%02llu -> %llu.%02llu entries\n",
+	       (unsigned long long)cost0 / 100, (unsigned long long)cost0 % 100,
+	       (unsigned long long)cost / 100, (unsigned long long)cost % 100);
+
+	/* The traffic moves; the old hot rule decays */
+	if (rr_run(rr, rr_rules[hot2].lo, rr_rules[hot2].hi, 90, 50, &cost))
+		return -1;
+	RR_CHECK(rr_is_first(rr, hot2) && !rr_is_first(rr, hot), "order did not follow the traffic\n");
+
+	/* A specific rule gets hot */
+	if (rr_run(rr, rr_rules[RR_NUM_SPEC - 1].lo, rr_rules[RR_NUM_SPEC - 1].hi, 50, 50, &cost))
+		return -1;
+	RR_CHECK(rr_is_first(rr, RR_NUM_SPEC - 1), "hot specific rule not first\n");
+
+	/* Steady traffic: no more moves */
+	if (rr_run(rr, rr_rules[RR_NUM_SPEC - 1].lo, rr_rules[RR_NUM_SPEC - 1].hi, 50, 20, &cost))
+		return -1;
+	mv_rl_reorder_get_stats(rr, &stats, 1);
+	if (rr_run(rr, rr_rules[RR_NUM_SPEC - 1].lo, rr_rules[RR_NUM_SPEC - 1].hi, 50, 20, &cost))
+		return -1;
+	mv_rl_reorder_get_stats(rr, &stats, 0);
+	RR_CHECK(stats.moves < 4, "%llu moves with steady traffic\n", (unsigned long long)stats.moves);
+
+	printf("  %llu writes, %llu clears, no lookup errors\n",
+	       (unsigned long long)rr_writes, (unsigned long long)rr_clears);
+	mv_rl_reorder_destroy(rr);
+	return 0;
+}
+
+static int test_full_table(void)
+{
+	struct mv_rl_reorder *rr;
+	struct mv_rl_reorder_stats stats;
+	u64 cost;
+
+	RR_CHECK(!rr_init(&rr, RR_NUM_RULES), "init failed\n");
+	/* The reference classification does not follow removals */
+	rr_verify = 0;
+	RR_CHECK(mv_rl_reorder_remove(rr, 0) == 0 && mv_rl_reorder_add(rr, 0, 0) == 0, "re-add failed\n");
+	rr_verify = 1;
+	mv_rl_reorder_get_stats(rr, &stats, 1);
+	if (rr_run(rr, rr_rules[RR_NUM_SPEC].lo, rr_rules[RR_NUM_SPEC + 9].hi, 90, 10, &cost))
+		return -1;
+	mv_rl_reorder_get_stats(rr, &stats, 0);
+	RR_CHECK(!stats.moves && stats.blocked, "full table reordered\n");
+
+	printf("  full table: blocked\n");
+	mv_rl_reorder_destroy(rr);
+	return 0;
+}
+
+static int test_clear_failure(void)
+{
+	struct mv_rl_reorder *rr;
+	struct mv_rl_reorder_stats stats;
+	u32 hot = RR_NUM_SPEC + RR_NUM_RANGE - 1, i;
+	int ret = 0;
+
+	RR_CHECK(!rr_init(&rr, RR_NUM_SLOTS), "init failed\n");
+	rr_traffic(rr, rr_rules[hot].lo, rr_rules[hot].hi, 100);
+	rr_fail_clear = 1;
+	for (i = 0; i < 10 && !ret; i++)
+		ret = mv_rl_reorder_run(rr);
+	RR_CHECK(ret == -EIO && !rr_errors, "clear failure not reported\n");
+	RR_CHECK(mv_rl_reorder_run(rr) >= 0 && !rr_errors, "run after a clear failure\n");
+	mv_rl_reorder_get_stats(rr, &stats, 0);
+	for (i = 0; i < RR_NUM_SLOTS; i++)
+		RR_CHECK(rr_hw[i] == RR_FREE || mv_rl_reorder_get_slot(rr, rr_hw[i]) == (int)i,
+			 "stale duplicate left in slot %u\n", i);
+
+	printf("  clear failure: %llu errors\n", (unsigned long long)stats.errors);
+	mv_rl_reorder_destroy(rr);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	srand(1);
+
+	if (test_reorder() || test_full_table() || test_clear_failure()) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
@@ -0,0 +1,345 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mv_std.h"
+#include "lib/mv_rss_bal.h"
+
+#define RB_NUM_QUEUES		8
+#define RB_NUM_BUCKETS		32	/* PP2_PPIO_RSS_TBL_SIZE */
+#define RB_NUM_FLOWS		4096
+#define RB_TOTAL_PPS		8000000ULL
+#define RB_STEP_NS		10000000ULL	/* 10 msec update period */
+#define RB_NSEC_PER_SEC		1000000000ULL
+/* per-queue (core) capacity: 25% above the mean load */
+#define RB_QUEUE_CAP_PPS	(RB_TOTAL_PPS * 5 / 4 / RB_NUM_QUEUES)
+
+#define RB_CHECK(cond, ...)					\
+	do {							\
+		if (!(cond)) {					\
+			printf("  line %d: ", __LINE__);	\
+			printf(__VA_ARGS__);			\
+			printf("\n");				\
+			err = -1;				\
+		}						\
+	} while (0)
+
+struct rb_sim {
+	u8	tbl[RB_NUM_BUCKETS];		/* the "HW" indirection table */
+	u64	bucket_pps[RB_NUM_BUCKETS];	/* offered load of the buckets */
+	u64	bucket_cnt[RB_NUM_BUCKETS];
+	u64	queue_cnt[RB_NUM_QUEUES];
+	u64	last_move_ns[RB_NUM_BUCKETS];
+	u64	now_ns;
+	u32	moves;
+	u32	early_moves;			/* moves within the hold time */
+	u64	hold_ns;
+	int	fail_set;
+};
+
+/* Zipf (s = 1) flow rates, flows hashed to buckets by a multiplicative hash */
+static void rb_sim_load(struct rb_sim *sim, unsigned int seed, int uniform)
+{
+	u64	w[RB_NUM_FLOWS], sum = 0;
+	u32	f, h;
+
+	memset(sim->bucket_pps, 0, sizeof(sim->bucket_pps));
+	for (f = 0; f < RB_NUM_FLOWS; f++) {
+		w[f] = uniform ? 1 : 1000000 / (f + 1);
+		sum += w[f];
+	}
+	for (f = 0; f < RB_NUM_FLOWS; f++) {
+		h = (f * 2654435761U + seed * 40503U) >> 16;
+		sim->bucket_pps[h % RB_NUM_BUCKETS] += RB_TOTAL_PPS * w[f] / sum;
+	}
+}
+
+static int rb_set_entry(void *arg, u32 bucket, u32 queue)
+{
+	struct rb_sim *sim = arg;
+
+	if (sim->fail_set)
+		return -EIO;
+	if (sim->last_move_ns[bucket] && sim->now_ns - sim->last_move_ns[bucket] < sim->hold_ns)
+		sim->early_moves++;
+	sim->last_move_ns[bucket] = sim->now_ns;
+	sim->tbl[bucket] = queue;
+	sim->moves++;
+	return 0;
+}
+
+static void rb_sim_step(struct rb_sim *sim, u64 *qpps)
+{
+	u32 b, q;
+
+	for (q = 0; q < RB_NUM_QUEUES; q++)
+		qpps[q] = 0;
+	for (b = 0; b < RB_NUM_BUCKETS; b++) {
+		u64 pkts = sim->bucket_pps[b] * RB_STEP_NS / RB_NSEC_PER_SEC;
+
+		qpps[sim->tbl[b]] += sim->bucket_pps[b];
+		sim->bucket_cnt[b] += pkts;
+		sim->queue_cnt[sim->tbl[b]] += pkts;
+	}
+	sim->now_ns += RB_STEP_NS;
+}
+
+/* fraction (in 1/1000) of the offered load the cores can serve */
+static u32 rb_served(u64 *qpps)
+{
+	u64	served = 0, offered = 0;
+	u32	q;
+
+	for (q = 0; q < RB_NUM_QUEUES; q++) {
+		offered += qpps[q];
+		served += min(qpps[q], (u64)RB_QUEUE_CAP_PPS);
+	}
+	return (u32)(served * 1000 / offered);
+}
+
+static u32 rb_imbalance(u64 *qpps)
+{
+	u64	sum = 0, peak = 0;
+	u32	q;
+
+	for (q = 0; q < RB_NUM_QUEUES; q++) {
+		sum += qpps[q];
+		peak = max(peak, qpps[q]);
+	}
+	return (u32)(peak * 100 * RB_NUM_QUEUES / sum);
+}
+
+static void rb_sim_init(struct rb_sim *sim, struct mv_rss_bal_params *params)
+{
+	u32 b;
+
+	memset(sim, 0, sizeof(*sim));
+	sim->now_ns = RB_NSEC_PER_SEC;
+	sim->hold_ns = 1000ULL * RB_NSEC_PER_SEC / 1000;
+	for (b = 0; b < RB_NUM_BUCKETS; b++)
+		sim->tbl[b] = b % RB_NUM_QUEUES;
+
+	memset(params, 0, sizeof(*params));
+	params->num_queues = RB_NUM_QUEUES;
+	params->num_buckets = RB_NUM_BUCKETS;
+	params->tbl = sim->tbl;
+	params->arg = sim;
+	params->set_entry = rb_set_entry;
+	params->hold_usecs = sim->hold_ns / 1000;
+}
+
+/* run 'secs' of simulated time; returns the load served at the end */
+static int rb_sim_run(struct rb_sim *sim, struct mv_rss_bal *bal, int counters, u32 secs, u32 *served, u32 *imb)
+{
+	u64	qpps[RB_NUM_QUEUES];
+	u32	i, b;
+	int	rc;
+
+	for (i = 0; i < secs * (RB_NSEC_PER_SEC / RB_STEP_NS); i++) {
+		rb_sim_step(sim, qpps);
+		rc = mv_rss_bal_update(bal, sim->queue_cnt, counters ? sim->bucket_cnt : NULL, sim->now_ns);
+		if (rc < 0)
+			return rc;
+	}
+	for (b = 0; b < RB_NUM_BUCKETS; b++)
+		if (mv_rss_bal_get_queue(bal, b) != sim->tbl[b])
+			return -EFAULT;
+	rb_sim_step(sim, qpps);
+	*served = rb_served(qpps);
+	*imb = rb_imbalance(qpps);
+	return 0;
+}
+
+static int rb_test_skew(int counters)
+{
+	struct mv_rss_bal_params	params;
+	struct mv_rss_bal		*bal;
+	struct rb_sim			sim;
+	u64				qpps[RB_NUM_QUEUES];
+	u32				static_served, static_imb, served, imb, moves;
+	int				err = 0;
+
+	rb_sim_init(&sim, &params);
+	rb_sim_load(&sim, 1, 0);
+	rb_sim_step(&sim, qpps);
+	static_served = rb_served(qpps);
+	static_imb = rb_imbalance(qpps);
+
+	if (mv_rss_bal_create(&params, &bal))
+		return -1;
+
+	RB_CHECK(!rb_sim_run(&sim, bal, counters, 20, &served, &imb), "run failed");
+	printf("  %s: static %u.%u%% served (max/mean %u%%), rebalanced %u.%u%% (%u%%), %u moves\n",
+	       counters ? "bucket counters" : "queue counters ", static_served / 10, static_served % 10,
+	       static_imb, served / 10, served % 10, imb, sim.moves);
+	RB_CHECK(served > static_served && served >= 990, "served %u (static %u)", served, static_served);
+	RB_CHECK(imb <= 125, "imbalance %u%%", imb);
+	RB_CHECK(!sim.early_moves, "%u buckets moved within the hold time", sim.early_moves);
+
+	/* converged: no more moves */
+	moves = sim.moves;
+	RB_CHECK(!rb_sim_run(&sim, bal, counters, 10, &served, &imb), "run failed");
+	RB_CHECK(sim.moves == moves, "%u moves after convergence", sim.moves - moves);
+
+	/* the hot flows change */
+	rb_sim_load(&sim, 7, 0);
+	rb_sim_step(&sim, qpps);
+	static_served = rb_served(qpps);
+	RB_CHECK(!rb_sim_run(&sim, bal, counters, 20, &served, &imb), "run failed");
+	printf("  %s: new hot flows: %u.%u%% served before, %u.%u%% after (%u%%)\n",
+	       counters ? "bucket counters" : "queue counters ", static_served / 10, static_served % 10,
+	       served / 10, served % 10, imb);
+	RB_CHECK(served >= 990, "served %u after the shift", served);
+	RB_CHECK(!sim.early_moves, "%u buckets moved within the hold time", sim.early_moves);
+
+	mv_rss_bal_destroy(bal);
+	return err;
+}
+
+static int rb_test_balanced(void)
+{
+	struct mv_rss_bal_params	params;
+	struct mv_rss_bal_stats		stats;
+	struct mv_rss_bal		*bal;
+	struct rb_sim			sim;
+	u32				served, imb;
+	int				err = 0;
+
+	rb_sim_init(&sim, &params);
+	rb_sim_load(&sim, 1, 1);
+	if (mv_rss_bal_create(&params, &bal))
+		return -1;
+	RB_CHECK(!rb_sim_run(&sim, bal, 0, 10, &served, &imb), "run failed");
+	RB_CHECK(!sim.moves, "%u moves on a balanced load", sim.moves);
+	mv_rss_bal_get_stats(bal, &stats, 0);
+	RB_CHECK(stats.updates && !stats.moves && stats.imbalance_pct <= 110, "stats");
+
+	/* set_entry failures are reported and leave the map as is */
+	rb_sim_load(&sim, 1, 0);
+	sim.fail_set = 1;
+	RB_CHECK(rb_sim_run(&sim, bal, 1, 1, &served, &imb) == -EIO, "failure not reported");
+	mv_rss_bal_get_stats(bal, &stats, 1);
+	RB_CHECK(stats.move_errs == 1 && !stats.moves, "move errors %llu", (unsigned long long)stats.move_errs);
+	mv_rss_bal_destroy(bal);
+
+	params.num_queues = 1;
+	RB_CHECK(mv_rss_bal_create(&params, &bal) == -EINVAL, "1 queue accepted");
+	params.num_queues = 4;
+	RB_CHECK(mv_rss_bal_create(&params, &bal) == -EINVAL, "invalid table accepted");
+	return err;
+}
+
+int main(int argc, char *argv[])
+{
+	int err = 0;
+
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	printf("RSS rebalancer simulation test:\n");
+
+	err |= rb_test_skew(1);
+	err |= rb_test_skew(0);
+	err |= rb_test_balanced();
+
+	if (err) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
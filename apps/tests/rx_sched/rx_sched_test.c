@@ -0,0 +1,327 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "mv_std.h"
+#include "rx_sched.h"
+
+#define RS_MAX_SRCS		8
+#define RS_MAX_BURST		256
+
+#define RS_CHECK(cond, ...)			\
+	do {					\
+		if (!(cond)) {			\
+			printf(__VA_ARGS__);	\
+			return -1;		\
+		}				\
+	} while (0)
+
+/* Fake inqueue: descriptors carry the queue index and a sequence number */
+struct rs_desc {
+	u16	q;
+	u32	seq;
+};
+
+struct rs_queue {
+	u16	idx;
+	u32	backlog;
+	u32	seq;
+	u64	polls;
+	int	fail;
+};
+
+static struct rs_queue rs_queues[RS_MAX_SRCS];
+static struct rs_desc rs_descs[RS_MAX_BURST];
+
+static int rs_recv(void *port, u8 tc, u8 qid, void *descs, u16 *num)
+{
+	struct rs_queue *q = (struct rs_queue *)port;
+	struct rs_desc *d = (struct rs_desc *)descs;
+	u16 i, n;
+
+	q->polls++;
+	if (q->fail)
+		return -EIO;
+	if (tc != 0 || qid != q->idx)
+		return -EINVAL;
+	n = min(*num, (u16)min(q->backlog, (u32)RS_MAX_BURST));
+	for (i = 0; i < n; i++) {
+		d[i].q = q->idx;
+		d[i].seq = q->seq++;
+	}
+	q->backlog -= n;
+	*num = n;
+	return 0;
+}
+
+static int rs_init(struct rx_sched **sched, int num, u16 max_interval)
+{
+	struct rx_sched_params params;
+	struct rx_sched_src_params src_params;
+	int i;
+
+	memset(rs_queues, 0, sizeof(rs_queues));
+	memset(&params, 0, sizeof(params));
+	params.max_srcs = num;
+	params.max_interval = max_interval;
+	if (rx_sched_create(&params, sched))
+		return -1;
+
+	memset(&src_params, 0, sizeof(src_params));
+	src_params.recv = rs_recv;
+	src_params.max_burst = RS_MAX_BURST;
+	for (i = 0; i < num; i++) {
+		rs_queues[i].idx = i;
+		src_params.port = &rs_queues[i];
+		src_params.qid = i;
+		if (rx_sched_add_src(*sched, &src_params) != i)
+			return -1;
+	}
+	return 0;
+}
+
+/* Receive a burst and check it comes in order from the reported source */
+static int rs_recv_check(struct rx_sched *sched, u32 *expected_seq)
+{
+	u16 i, num;
+	int src;
+
+	src = rx_sched_recv(sched, rs_descs, &num);
+	if (src < 0)
+		return src;
+	for (i = 0; i < num; i++)
+		if (rs_descs[i].q != src || rs_descs[i].seq != expected_seq[src]++) {
+			printf("bad descriptor %u from source %d\n", i, src);
+			return -EFAULT;
+		}
+	return src;
+}
+
+/* One busy queue among idle ones: the idle ones are hardly polled */
+static int test_idle_queues(void)
+{
+	struct rx_sched *sched;
+	struct rx_sched_src_stats stats;
+	u32 seq[RS_MAX_SRCS] = {0};
+	u64 idle_polls = 0, pkts = 0;
+	int i, rounds = 10000;
+
+	RS_CHECK(!rs_init(&sched, RS_MAX_SRCS, 16), "init failed\n");
+	for (i = 0; i < rounds; i++) {
+		rs_queues[0].backlog += 64;
+		RS_CHECK(rs_recv_check(sched, seq) >= 0, "busy queue not served\n");
+	}
+	for (i = 1; i < RS_MAX_SRCS; i++)
+		idle_polls += rs_queues[i].polls;
+	/* Each idle queue is visited on every call, and polled every 16 visits once warm */
+	RS_CHECK(idle_polls <= (RS_MAX_SRCS - 1) * (rounds / 16 + 5),
+		 "idle queues polled %llu times\n", (unsigned long long)idle_polls);
+	for (i = 0; i < RS_MAX_SRCS; i++) {
+		RS_CHECK(!rx_sched_get_src_stats(sched, i, &stats, 0), "no stats\n");
+		RS_CHECK(stats.polls == rs_queues[i].polls, "bad poll stats of %d\n", i);
+		pkts += stats.pkts;
+	}
+	RS_CHECK(pkts == 64ULL * rounds && !rs_queues[0].backlog, "lost packets\n");
+
+	printf("  idle queues: %llu empty polls instead of %u\n",
+	       (unsigned long long)idle_polls, (RS_MAX_SRCS - 1) * rounds);
+	rx_sched_destroy(sched);
+	return 0;
+}
+
+/* Bursts follow the queue occupancy */
+static int test_burst(void)
+{
+	struct rx_sched *sched;
+	struct rx_sched_src_stats stats;
+	u32 seq[1] = {0};
+	int i;
+
+	RS_CHECK(!rs_init(&sched, 1, 16), "init failed\n");
+
+	/* Light load: the burst shrinks to a few times the fill */
+	for (i = 0; i < 100; i++) {
+		rs_queues[0].backlog += 2;
+		RS_CHECK(rs_recv_check(sched, seq) == 0, "light queue not served\n");
+	}
+	rx_sched_get_src_stats(sched, 0, &stats, 1);
+	RS_CHECK(stats.burst == 8, "light load burst %u\n", stats.burst);
+
+	/* Backlog: the burst doubles on every full poll */
+	rs_queues[0].backlog = 10000;
+	for (i = 0; i < 5; i++)
+		RS_CHECK(rs_recv_check(sched, seq) == 0, "backlogged queue not served\n");
+	rx_sched_get_src_stats(sched, 0, &stats, 0);
+	RS_CHECK(stats.burst == RS_MAX_BURST && stats.full_polls == 5 && stats.pkts == 8 + 16 + 32 + 64 + 128,
+		 "backlog burst %u after %llu packets\n", stats.burst, (unsigned long long)stats.pkts);
+	while (rs_queues[0].backlog)
+		RS_CHECK(rs_recv_check(sched, seq) == 0, "backlogged queue not served\n");
+
+	printf("  burst adaptation\n");
+	rx_sched_destroy(sched);
+	return 0;
+}
+
+/* A queue that wakes up is served within 'max_interval' calls */
+static int test_wakeup(void)
+{
+	struct rx_sched *sched;
+	struct rx_sched_src_stats stats;
+	u32 seq[4] = {0};
+	int i, src;
+
+	RS_CHECK(!rs_init(&sched, 4, 16), "init failed\n");
+	for (i = 0; i < 1000; i++)
+		RS_CHECK(rs_recv_check(sched, seq) == -EAGAIN, "idle queues returned packets\n");
+	rx_sched_get_src_stats(sched, 3, &stats, 0);
+	RS_CHECK(stats.interval == 16 && stats.skips > stats.polls * 14,
+		 "idle interval %u, %llu skips\n", stats.interval, (unsigned long long)stats.skips);
+
+	rs_queues[3].backlog = 1;
+	for (i = 0; i < 16; i++) {
+		src = rs_recv_check(sched, seq);
+		if (src >= 0)
+			break;
+	}
+	RS_CHECK(src == 3, "woken queue not served after %d calls\n", i);
+	rx_sched_get_src_stats(sched, 3, &stats, 0);
+	RS_CHECK(stats.interval == 1, "woken queue interval %u\n", stats.interval);
+
+	printf("  wakeup within %d calls\n", i + 1);
+	rx_sched_destroy(sched);
+	return 0;
+}
+
+static int test_errors(void)
+{
+	struct rx_sched *sched;
+	struct rx_sched_src_params src_params;
+	struct rx_sched_src_stats stats;
+	u32 seq[2] = {0};
+
+	RS_CHECK(!rs_init(&sched, 2, 0), "init failed\n");
+	memset(&src_params, 0, sizeof(src_params));
+	src_params.recv = rs_recv;
+	src_params.max_burst = 1;
+	RS_CHECK(rx_sched_add_src(sched, &src_params) == -ENOSPC, "source over the maximum added\n");
+	RS_CHECK(rx_sched_get_src_stats(sched, 2, &stats, 0) == -EINVAL, "stats of a bad source\n");
+
+	rs_queues[1].fail = 1;
+	rs_queues[1].backlog = 1;
+	RS_CHECK(rs_recv_check(sched, seq) == -EIO, "receive error not returned\n");
+	rs_queues[1].fail = 0;
+	RS_CHECK(rs_recv_check(sched, seq) == 1, "queue not served after an error\n");
+	rx_sched_destroy(sched);
+
+	printf("  errors\n");
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+
+	if (test_idle_queues() || test_burst() || test_wakeup() || test_errors()) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
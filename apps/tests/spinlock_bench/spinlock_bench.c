@@ -0,0 +1,392 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "mv_std.h"
+#include "env/spinlock.h"
+
+/*
+ * Spinlock contention benchmark
+ *
+ * N threads repeatedly take one shared lock, touch a few shared cache lines
+ * in the critical section and do some private work outside it. Reports the
+ * aggregate throughput, the per-thread share (fairness) and the acquisition
+ * latency distribution of the build-time selected spinlock flavour.
+ */
+
+#define SLB_MAX_THREADS		64
+#define SLB_DEF_THREADS		2
+#define SLB_DEF_MS		1000
+#define SLB_DEF_CS_LINES	2
+#define SLB_DEF_OUT_LOOPS	100
+#define SLB_MAX_CS_LINES	16
+
+/* latency histogram: 8ns linear buckets up to 8us, then log2 buckets */
+#define SLB_LIN_SHIFT		3
+#define SLB_LIN_BUCKETS		1024
+#define SLB_LOG_BASE		13	/* log2(SLB_LIN_BUCKETS << SLB_LIN_SHIFT) */
+#define SLB_BUCKETS		(SLB_LIN_BUCKETS + 64 - SLB_LOG_BASE)
+
+#if defined(MVCONF_SPINLOCK_TICKET)
+#define SLB_FLAVOUR		"ticket"
+#elif defined(MVCONF_SPINLOCK_MCS)
+#define SLB_FLAVOUR		"mcs"
+#else
+#define SLB_FLAVOUR		"tas"
+#endif
+
+struct slb_thread {
+	pthread_t	 tid;
+	int		 id;
+	u64		 ops;
+	u64		 max_ns;
+	u64		 hist[SLB_BUCKETS];
+} __attribute__((aligned(64)));
+
+static struct {
+	spinlock_t	 lock __attribute__((aligned(64)));
+	u64		 counter __attribute__((aligned(64)));
+	u64		 lines[SLB_MAX_CS_LINES][8] __attribute__((aligned(64)));
+} slb_shared;
+
+static struct slb_thread slb_threads[SLB_MAX_THREADS];
+static volatile int slb_start, slb_stop;
+static int slb_cs_lines = SLB_DEF_CS_LINES;
+static int slb_out_loops = SLB_DEF_OUT_LOOPS;
+static int slb_affinity;
+
+static inline u64 slb_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline int slb_bucket(u64 ns)
+{
+	if (ns < (SLB_LIN_BUCKETS << SLB_LIN_SHIFT))
+		return ns >> SLB_LIN_SHIFT;
+	return SLB_LIN_BUCKETS + (63 - __builtin_clzll(ns)) - SLB_LOG_BASE;
+}
+
+/* upper bound of a bucket, in nsec */
+static u64 slb_bucket_ns(int b)
+{
+	if (b < SLB_LIN_BUCKETS)
+		return (u64)(b + 1) << SLB_LIN_SHIFT;
+	return 1ULL << (b - SLB_LIN_BUCKETS + SLB_LOG_BASE + 1);
+}
+
+static void *slb_thread_fn(void *arg)
+{
+	struct slb_thread *t = arg;
+	u64 t0, ns, priv = t->id;
+	int i;
+
+	if (slb_affinity) {
+		cpu_set_t set;
+
+		CPU_ZERO(&set);
+		CPU_SET(t->id, &set);
+		if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set))
+			pr_warn("thread %d: can't bind to cpu %d\n", t->id, t->id);
+	}
+
+	while (!slb_start)
+		;
+
+	while (!slb_stop) {
+		t0 = slb_now_ns();
+		spin_lock(&slb_shared.lock);
+		ns = slb_now_ns() - t0;
+
+		slb_shared.counter++;
+		for (i = 0; i < slb_cs_lines; i++)
+			slb_shared.lines[i][0] += priv;
+		spin_unlock(&slb_shared.lock);
+
+		t->ops++;
+		t->hist[slb_bucket(ns)]++;
+		if (ns > t->max_ns)
+			t->max_ns = ns;
+
+		for (i = 0; i < slb_out_loops; i++)
+			priv = priv * 6364136223846793005ULL + 1442695040888963407ULL;
+	}
+
+	return NULL;
+}
+
+static u64 slb_percentile(u64 *hist, u64 total, double pct)
+{
+	u64 acc = 0, target = (u64)(total * pct / 100.0);
+	int b;
+
+	for (b = 0; b < SLB_BUCKETS; b++) {
+		acc += hist[b];
+		if (acc > target)
+			return slb_bucket_ns(b);
+	}
+	return slb_bucket_ns(SLB_BUCKETS - 1);
+}
+
+static int slb_report(int num_threads, u64 elapsed_ns)
+{
+	static u64 hist[SLB_BUCKETS];
+	struct spin_lock_stats stats;
+	u64 total = 0, min_ops = ~0ULL, max_ops = 0, max_ns = 0;
+	double sum_sq = 0, jain;
+	int i, b;
+
+	for (i = 0; i < num_threads; i++)
+		total += slb_threads[i].ops;
+	if (!total) {
+		pr_err("no lock acquisitions\n");
+		return -1;
+	}
+
+	for (i = 0; i < num_threads; i++) {
+		struct slb_thread *t = &slb_threads[i];
+
+		printf("  thread %2d: %10llu ops (%5.1f%%), max wait %llu ns\n", i,
+		       (unsigned long long)t->ops, t->ops * 100.0 / total,
+		       (unsigned long long)t->max_ns);
+		sum_sq += (double)t->ops * t->ops;
+		if (t->ops < min_ops)
+			min_ops = t->ops;
+		if (t->ops > max_ops)
+			max_ops = t->ops;
+		if (t->max_ns > max_ns)
+			max_ns = t->max_ns;
+		for (b = 0; b < SLB_BUCKETS; b++)
+			hist[b] += t->hist[b];
+	}
+	/* Jain's fairness index: 1.0 when all threads got the same share */
+	jain = (double)total * total / (num_threads * sum_sq);
+
+	printf("\nflavour %s, %d threads, %d cs lines, %d outside loops\n",
+	       SLB_FLAVOUR, num_threads, slb_cs_lines, slb_out_loops);
+	printf("throughput:  %.3f Mops\n", total * 1000.0 / elapsed_ns);
+	printf("fairness:    jain %.3f, min/max share %.3f\n", jain, (double)min_ops / max_ops);
+	printf("wait (ns):   p50 %llu, p99 %llu, p99.9 %llu, max %llu\n",
+	       (unsigned long long)slb_percentile(hist, total, 50),
+	       (unsigned long long)slb_percentile(hist, total, 99),
+	       (unsigned long long)slb_percentile(hist, total, 99.9),
+	       (unsigned long long)max_ns);
+
+	spin_lock_get_stats(&slb_shared.lock, &stats, 0);
+#ifdef MVCONF_SPINLOCK_STAT
+	printf("lock stats:  acquired %llu, contended %llu, spins %llu\n",
+	       (unsigned long long)stats.acquired, (unsigned long long)stats.contended,
+	       (unsigned long long)stats.spins);
+	if (stats.acquired != total) {
+		pr_err("lock stats mismatch (%llu != %llu)\n",
+		       (unsigned long long)stats.acquired, (unsigned long long)total);
+		return -1;
+	}
+#endif
+
+	if (slb_shared.counter != total) {
+		pr_err("mutual exclusion broken: counter %llu != %llu ops\n",
+		       (unsigned long long)slb_shared.counter, (unsigned long long)total);
+		return -1;
+	}
+	return 0;
+}
+
+static void usage(char *progname)
+{
+	printf("\n"
+	       "MUSDK spinlock contention benchmark\n"
+	       "\n"
+	       "Usage: %s [OPTIONS]\n"
+	       "\n"
+	       "Optional OPTIONS:\n"
+	       "\t-n, --threads <num>   number of threads (default: %d, max %d)\n"
+	       "\t-t, --time <ms>       run time (default: %d)\n"
+	       "\t-c, --cs <num>        shared cache lines written in the critical section (default: %d, max %d)\n"
+	       "\t-w, --work <num>      private work loops between acquisitions (default: %d)\n"
+	       "\t-a, --affinity        bind thread i to cpu i\n"
+	       "\n", progname, SLB_DEF_THREADS, SLB_MAX_THREADS, SLB_DEF_MS,
+	       SLB_DEF_CS_LINES, SLB_MAX_CS_LINES, SLB_DEF_OUT_LOOPS);
+}
+
+int main(int argc, char *argv[])
+{
+	struct option long_options[] = {
+		{"threads", required_argument, 0, 'n'},
+		{"time", required_argument, 0, 't'},
+		{"cs", required_argument, 0, 'c'},
+		{"work", required_argument, 0, 'w'},
+		{"affinity", no_argument, 0, 'a'},
+		{"help", no_argument, 0, 'h'},
+		{0, 0, 0, 0}
+	};
+	int num_threads = SLB_DEF_THREADS, ms = SLB_DEF_MS, opt, i, err = 0;
+	struct timespec ts;
+	u64 t0, elapsed;
+
+	while ((opt = getopt_long(argc, argv, "n:t:c:w:ah", long_options, NULL)) != -1) {
+		switch (opt) {
+		case 'n':
+			num_threads = atoi(optarg);
+			break;
+		case 't':
+			ms = atoi(optarg);
+			break;
+		case 'c':
+			slb_cs_lines = atoi(optarg);
+			break;
+		case 'w':
+			slb_out_loops = atoi(optarg);
+			break;
+		case 'a':
+			slb_affinity = 1;
+			break;
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : -1;
+		}
+	}
+	if (num_threads < 1 || num_threads > SLB_MAX_THREADS || ms < 1 ||
+	    slb_cs_lines < 0 || slb_cs_lines > SLB_MAX_CS_LINES || slb_out_loops < 0) {
+		usage(argv[0]);
+		return -1;
+	}
+
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+
+	spin_lock_init(&slb_shared.lock);
+	for (i = 0; i < num_threads; i++) {
+		slb_threads[i].id = i;
+		err = pthread_create(&slb_threads[i].tid, NULL, slb_thread_fn, &slb_threads[i]);
+		if (err) {
+			pr_err("can't create thread %d (%d)\n", i, err);
+			slb_stop = 1;
+			slb_start = 1;
+			num_threads = i;
+			break;
+		}
+	}
+
+	t0 = slb_now_ns();
+	slb_start = 1;
+	ts.tv_sec = ms / 1000;
+	ts.tv_nsec = (ms % 1000) * 1000000L;
+	nanosleep(&ts, NULL);
+	slb_stop = 1;
+	for (i = 0; i < num_threads; i++)
+		pthread_join(slb_threads[i].tid, NULL);
+	elapsed = slb_now_ns() - t0;
+
+	if (err || slb_report(num_threads, elapsed)) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
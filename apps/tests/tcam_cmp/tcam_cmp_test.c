@@ -0,0 +1,410 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "mv_std.h"
+#include "lib/mv_tcam_cmp.h"
+
+#define TC_MAX_ENTRIES		4096
+#define TC_MAX_PREDS		6
+
+#define TC_CHECK(cond, ...)			\
+	do {					\
+		if (!(cond)) {			\
+			printf(__VA_ARGS__);	\
+			return -1;		\
+		}				\
+	} while (0)
+
+static struct mv_tcam_entry tc_entries[TC_MAX_ENTRIES];
+
+static u64 tc_rand64(void)
+{
+	return ((u64)rand() << 42) ^ ((u64)rand() << 21) ^ (u64)rand();
+}
+
+static u64 tc_wmask(u8 width)
+{
+	return (width == 64) ? ~0ULL : ((1ULL << width) - 1);
+}
+
+/* Reference: evaluate the predicates directly */
+static int tc_pred_match(const struct mv_tcam_rule *rule, const u64 *values)
+{
+	const struct mv_tcam_pred *p;
+	u64 v, m;
+	u16 i;
+
+	for (i = 0; i < rule->num_preds; i++) {
+		p = &rule->preds[i];
+		v = values[p->field];
+		switch (p->type) {
+		case MV_TCAM_PRED_EXACT:
+			if (v != p->u.value)
+				return 0;
+			break;
+		case MV_TCAM_PRED_PREFIX:
+			m = tc_wmask(rule->widths[p->field]) & ~tc_wmask(rule->widths[p->field] - p->u.prefix.len);
+			if ((v ^ p->u.prefix.value) & m)
+				return 0;
+			break;
+		case MV_TCAM_PRED_RANGE:
+			if (v < p->u.range.lo || v > p->u.range.hi)
+				return 0;
+			break;
+		case MV_TCAM_PRED_MASK:
+			if ((v ^ p->u.mask.value) & p->u.mask.mask)
+				return 0;
+			break;
+		}
+	}
+	return 1;
+}
+
+static int tc_entries_match(const struct mv_tcam_rule *rule, u32 num, const u64 *values)
+{
+	u32 i;
+
+	for (i = 0; i < num; i++)
+		if (mv_tcam_entry_match(&tc_entries[i], rule->num_fields, values))
+			return 1;
+	return 0;
+}
+
+static void tc_rand_pred(struct mv_tcam_pred *p, u8 field, u8 width)
+{
+	u64 wmask = tc_wmask(width), a, b;
+
+	memset(p, 0, sizeof(*p));
+	p->field = field;
+	p->type = rand() % 4;
+	switch (p->type) {
+	case MV_TCAM_PRED_EXACT:
+		p->u.value = tc_rand64() & wmask;
+		break;
+	case MV_TCAM_PRED_PREFIX:
+		p->u.prefix.value = tc_rand64() & wmask;
+		p->u.prefix.len = rand() % (width + 1);
+		break;
+	case MV_TCAM_PRED_RANGE:
+		a = tc_rand64() & wmask;
+		b = tc_rand64() & wmask;
+		p->u.range.lo = min(a, b);
+		p->u.range.hi = max(a, b);
+		break;
+	case MV_TCAM_PRED_MASK:
+		p->u.mask.mask = tc_rand64() & tc_rand64() & wmask;
+		p->u.mask.value = tc_rand64() & p->u.mask.mask;
+		break;
+	}
+}
+
+/* Compare the compiled entries with the predicates over the whole key space */
+static int tc_check_rule(const struct mv_tcam_rule *rule, u64 *entries, u64 *prefix_entries)
+{
+	struct mv_tcam_estimate est;
+	u64 values[MV_TCAM_MAX_FIELDS] = {0};
+	u32 num = TC_MAX_ENTRIES, i;
+	int err;
+
+	err = mv_tcam_rule_compile(rule, tc_entries, &num);
+	TC_CHECK(!err, "compile failed (%d)\n", err);
+	TC_CHECK(!mv_tcam_rule_estimate(rule, &est) && est.entries == num && num <= est.prefix_entries,
+		 "bad estimate %llu/%llu of %u entries\n", (unsigned long long)est.entries,
+		 (unsigned long long)est.prefix_entries, num);
+	for (;;) {
+		if (tc_pred_match(rule, values) != tc_entries_match(rule, num, values)) {
+			printf("mismatch at");
+			for (i = 0; i < rule->num_fields; i++)
+				printf(" 0x%llx", (unsigned long long)values[i]);
+			printf("\n");
+			return -1;
+		}
+		/* Next key */
+		for (i = 0; i < rule->num_fields; i++) {
+			if (++values[i] <= tc_wmask(rule->widths[i]))
+				break;
+			values[i] = 0;
+		}
+		if (i == rule->num_fields)
+			break;
+	}
+	*entries += num;
+	*prefix_entries += est.prefix_entries;
+	return 0;
+}
+
+static int test_brute_force(void)
+{
+	struct mv_tcam_pred preds[TC_MAX_PREDS];
+	struct mv_tcam_rule rule;
+	u64 entries = 0, prefix_entries = 0;
+	int i, j;
+
+	/* Single field, up to 12 bits */
+	for (i = 0; i < 600; i++) {
+		memset(&rule, 0, sizeof(rule));
+		rule.num_fields = 1;
+		rule.widths[0] = 1 + rand() % 12;
+		rule.num_preds = 1 + rand() % 3;
+		rule.preds = preds;
+		for (j = 0; j < rule.num_preds; j++)
+			tc_rand_pred(&preds[j], 0, rule.widths[0]);
+		if (tc_check_rule(&rule, &entries, &prefix_entries))
+			return -1;
+	}
+
+	/* Three fields of 5, 4 and 3 bits */
+	for (i = 0; i < 200; i++) {
+		memset(&rule, 0, sizeof(rule));
+		rule.num_fields = 3;
+		rule.widths[0] = 5;
+		rule.widths[1] = 4;
+		rule.widths[2] = 3;
+		rule.num_preds = rand() % (TC_MAX_PREDS + 1);
+		rule.preds = preds;
+		for (j = 0; j < rule.num_preds; j++) {
+			u8 f = rand() % rule.num_fields;
+
+			tc_rand_pred(&preds[j], f, rule.widths[f]);
+		}
+		if (tc_check_rule(&rule, &entries, &prefix_entries))
+			return -1;
+	}
+
+	printf("  brute force: %llu entries, %llu with prefix expansion only\n",
+	       (unsigned long long)entries, (unsigned long long)prefix_entries);
+	return 0;
+}
+
+static u32 tc_range_entries(u8 width, u64 lo, u64 hi)
+{
+	struct mv_tcam_pred pred;
+	struct mv_tcam_rule rule;
+	u32 num = TC_MAX_ENTRIES;
+
+	memset(&rule, 0, sizeof(rule));
+	memset(&pred, 0, sizeof(pred));
+	rule.num_fields = 1;
+	rule.widths[0] = width;
+	rule.num_preds = 1;
+	rule.preds = &pred;
+	pred.type = MV_TCAM_PRED_RANGE;
+	pred.u.range.lo = lo;
+	pred.u.range.hi = hi;
+	if (mv_tcam_rule_compile(&rule, tc_entries, &num))
+		return 0;
+	return num;
+}
+
+static int test_known(void)
+{
+	struct mv_tcam_pred preds[2];
+	struct mv_tcam_rule rule;
+	struct mv_tcam_estimate est;
+	u32 num;
+
+	TC_CHECK(tc_range_entries(16, 1024, 65535) == 6, "[1024, 65535] not 6 entries\n");
+	TC_CHECK(tc_range_entries(16, 1, 65534) == 30, "[1, 65534] not 30 entries\n");
+	TC_CHECK(tc_range_entries(16, 0, 65535) == 1 && !tc_entries[0].mask[0], "full range not a wildcard\n");
+	TC_CHECK(tc_range_entries(64, 0, ~0ULL) == 1 && !tc_entries[0].mask[0], "full 64-bit range\n");
+	TC_CHECK(tc_range_entries(64, 1, ~0ULL) == 64, "[1, 2^64 - 1] not 64 entries\n");
+	TC_CHECK(tc_range_entries(32, 0x0a000005, 0x0a000005) == 1 && tc_entries[0].mask[0] == 0xffffffff,
+		 "single address not exact\n");
+
+	/* Odd values of [1, 6]: x10 and 100, merged from 010, 100 and 110 */
+	memset(&rule, 0, sizeof(rule));
+	memset(preds, 0, sizeof(preds));
+	rule.num_fields = 1;
+	rule.widths[0] = 3;
+	rule.num_preds = 2;
+	rule.preds = preds;
+	preds[0].type = MV_TCAM_PRED_RANGE;
+	preds[0].u.range.lo = 1;
+	preds[0].u.range.hi = 6;
+	preds[1].type = MV_TCAM_PRED_MASK;
+	preds[1].u.mask.value = 0;
+	preds[1].u.mask.mask = 1;
+	TC_CHECK(!mv_tcam_rule_estimate(&rule, &est) && est.entries == 2 && est.prefix_entries == 3,
+		 "even values of [1, 6]: %llu entries\n", (unsigned long long)est.entries);
+
+	/* Disjoint ranges never match */
+	preds[1].type = MV_TCAM_PRED_RANGE;
+	preds[1].u.range.lo = 7;
+	preds[1].u.range.hi = 7;
+	num = TC_MAX_ENTRIES;
+	TC_CHECK(!mv_tcam_rule_compile(&rule, tc_entries, &num) && !num, "disjoint ranges matched\n");
+
+	/* Too small output */
+	rule.num_preds = 1;
+	num = 2;
+	TC_CHECK(mv_tcam_rule_compile(&rule, tc_entries, &num) == -ENOSPC && num == 4, "no -ENOSPC\n");
+
+	/* Invalid rules */
+	preds[0].u.range.lo = 8;
+	preds[0].u.range.hi = 8;
+	TC_CHECK(mv_tcam_rule_estimate(&rule, &est) == -EINVAL, "value over width accepted\n");
+	preds[0].type = MV_TCAM_PRED_PREFIX;
+	preds[0].u.prefix.value = 0;
+	preds[0].u.prefix.len = 4;
+	TC_CHECK(mv_tcam_rule_estimate(&rule, &est) == -EINVAL, "prefix over width accepted\n");
+	preds[0].field = 1;
+	preds[0].u.prefix.len = 1;
+	TC_CHECK(mv_tcam_rule_estimate(&rule, &est) == -EINVAL, "bad field accepted\n");
+
+	printf("  known expansions\n");
+	return 0;
+}
+
+/* An ACL of (proto, sport range, dport range) rules against a 256 entries TCAM */
+static int test_policy(void)
+{
+	static const u16 ranges[][4] = {
+		{1024, 65535, 80, 80},
+		{1024, 65535, 6000, 6063},
+		{1, 1023, 20, 21},
+		{5000, 5999, 1024, 65535},
+		{49152, 65535, 3478, 3497},
+	};
+	struct mv_tcam_pred preds[ARRAY_SIZE(ranges)][3];
+	struct mv_tcam_rule rules[ARRAY_SIZE(ranges)];
+	struct mv_tcam_estimate est;
+	u32 i;
+
+	memset(rules, 0, sizeof(rules));
+	memset(preds, 0, sizeof(preds));
+	for (i = 0; i < ARRAY_SIZE(ranges); i++) {
+		rules[i].num_fields = 3;
+		rules[i].widths[0] = 8;
+		rules[i].widths[1] = 16;
+		rules[i].widths[2] = 16;
+		rules[i].num_preds = 3;
+		rules[i].preds = preds[i];
+		preds[i][0].type = MV_TCAM_PRED_EXACT;
+		preds[i][0].u.value = 6;
+		preds[i][1].field = 1;
+		preds[i][1].type = MV_TCAM_PRED_RANGE;
+		preds[i][1].u.range.lo = ranges[i][0];
+		preds[i][1].u.range.hi = ranges[i][1];
+		preds[i][2].field = 2;
+		preds[i][2].type = MV_TCAM_PRED_RANGE;
+		preds[i][2].u.range.lo = ranges[i][2];
+		preds[i][2].u.range.hi = ranges[i][3];
+	}
+	TC_CHECK(!mv_tcam_policy_estimate(rules, ARRAY_SIZE(ranges), 256, &est), "policy does not fit\n");
+	TC_CHECK(mv_tcam_policy_estimate(rules, ARRAY_SIZE(ranges), est.entries - 1, &est) == -ENOSPC,
+		 "policy over capacity fits\n");
+
+	printf("  policy: %llu entries\n", (unsigned long long)est.entries);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	srand(1);
+
+	if (test_known() || test_brute_force() || test_policy()) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
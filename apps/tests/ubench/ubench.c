@@ -0,0 +1,610 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mv_std.h"
+#include "env/io.h"
+#include "env/spinlock.h"
+#include "lib/mem_mng.h"
+#include "lib/net.h"
+#include "drivers/mv_mqa_queue.h"
+#include "xxhash.h"
+#include "l3fwd_db.h"
+#include "l3fwd_lpm.h"
+#include "crc.h"
+#ifdef MVCONF_SAM_BUILT
+#include "mv_aes.h"
+#include "mv_md5.h"
+#include "mv_sha1.h"
+#include "mv_sha2.h"
+#endif /* MVCONF_SAM_BUILT */
+
+/*
+ * Microbenchmarks of data path primitives
+ *
+ * Every benchmark is calibrated to run at least 'min_ms' and is then repeated
+ * 'repeat' times; min/median/max nsec per operation are reported as JSON so
+ * that results of different releases can be compared by scripts. Diagnostics
+ * go to stderr.
+ */
+
+#define UB_DEF_REPEAT		5
+#define UB_DEF_MIN_MS		50
+#define UB_MAX_REPEAT		32
+#define UB_KEYS			4096	/* power of 2 */
+#define UB_BUF_SIZE		2048
+
+struct ubench {
+	const char	*name;
+	const char	*group;
+	u32		 bytes;			/* bytes per op, for throughput; 0 if n/a */
+	int		(*setup)(void);		/* optional; <0 skips the benchmark */
+	u64		(*run)(u64 iters);	/* returns a value to defeat dead code elimination */
+	void		(*teardown)(void);	/* optional */
+};
+
+static u8 ub_buf[UB_BUF_SIZE] __attribute__((aligned(64)));
+static u32 ub_keys[UB_KEYS];
+static volatile u64 ub_sink;
+
+static u64 ub_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void ub_fill_random(void)
+{
+	int i;
+
+	for (i = 0; i < UB_BUF_SIZE; i++)
+		ub_buf[i] = rand();
+	for (i = 0; i < UB_KEYS; i++)
+		ub_keys[i] = ((u32)rand() << 16) ^ rand();
+}
+
+/* mem_mng */
+static struct mem_mng *ub_mm;
+
+static int ub_mem_mng_setup(void)
+{
+	return mem_mng_init(0x100000000ULL, 64 * 1024 * 1024, &ub_mm);
+}
+
+static u64 ub_mem_mng_run(u64 iters)
+{
+	u64 i, sum = 0, pa;
+
+	for (i = 0; i < iters; i++) {
+		pa = mem_mng_get(ub_mm, 2048, 64, "ubench");
+		sum += pa;
+		mem_mng_put(ub_mm, pa);
+	}
+	return sum;
+}
+
+static void ub_mem_mng_teardown(void)
+{
+	mem_mng_free(ub_mm);
+}
+
+/* DMA memory; needs the musdk CMA/hugepages backend */
+static int ub_dma_mem_setup(void)
+{
+	return mv_sys_dma_mem_init(16 * 1024 * 1024);
+}
+
+static u64 ub_dma_mem_run(u64 iters)
+{
+	u64 i, sum = 0;
+	void *va;
+
+	for (i = 0; i < iters; i++) {
+		va = mv_sys_dma_mem_alloc(2048, 64);
+		sum += (uintptr_t)va;
+		mv_sys_dma_mem_free(va);
+	}
+	return sum;
+}
+
+static void ub_dma_mem_teardown(void)
+{
+	mv_sys_dma_mem_destroy();
+}
+
+/* MQA producer/consumer helpers over a host memory ring */
+#define UB_MQA_LEN		1024
+#define UB_MQA_ELEM		64
+#define UB_MQA_BURST		32
+
+static struct mqa_queue_info ub_mqa;
+static u32 ub_mqa_prod, ub_mqa_cons;
+
+static int ub_mqa_setup(void)
+{
+	memset(&ub_mqa, 0, sizeof(ub_mqa));
+	ub_mqa.len = UB_MQA_LEN;
+	ub_mqa.virt_base_addr = calloc(UB_MQA_LEN, UB_MQA_ELEM);
+	ub_mqa.prod_virt = &ub_mqa_prod;
+	ub_mqa.cons_virt = &ub_mqa_cons;
+	ub_mqa_prod = ub_mqa_cons = 0;
+	return ub_mqa.virt_base_addr ? 0 : -ENOMEM;
+}
+
+/* one op = one element produced and consumed, in bursts */
+static u64 ub_mqa_run(u64 iters)
+{
+	u8 *ring = ub_mqa.virt_base_addr;
+	u32 prod, cons, n, j;
+	u64 i, sum = 0;
+
+	for (i = 0; i < iters; i += UB_MQA_BURST) {
+		prod = mqa_queue_rd_prod(&ub_mqa);
+		cons = mqa_queue_rd_cons(&ub_mqa);
+		n = min(mqa_queue_space(&ub_mqa, prod, cons), (u32)UB_MQA_BURST);
+		for (j = 0; j < n; j++) {
+			memcpy(ring + prod * UB_MQA_ELEM, ub_buf + j * UB_MQA_ELEM, UB_MQA_ELEM);
+			prod = mqa_queue_inc_idx_val(&ub_mqa, prod, 1);
+		}
+		mqa_queue_wr_prod(&ub_mqa, prod);
+
+		prod = mqa_queue_rd_prod(&ub_mqa);
+		cons = mqa_queue_rd_cons(&ub_mqa);
+		n = mqa_queue_occupancy(&ub_mqa, prod, cons);
+		for (j = 0; j < n; j++) {
+			memcpy(ub_buf + UB_BUF_SIZE - UB_MQA_ELEM, ring + cons * UB_MQA_ELEM, UB_MQA_ELEM);
+			sum += ub_buf[UB_BUF_SIZE - 1];
+			cons = mqa_queue_inc_idx_val(&ub_mqa, cons, 1);
+		}
+		mqa_queue_wr_cons(&ub_mqa, cons);
+	}
+	return sum;
+}
+
+static void ub_mqa_teardown(void)
+{
+	free(ub_mqa.virt_base_addr);
+}
+
+/* pkt_l3fwd LPM */
+static int ub_lpm_setup(void)
+{
+	int i, depth;
+
+	/* The example's sub-table pool holds ~512 extensions; 256 routes of
+	 * depth 8..24 need at most two each.
+	 */
+	fib_tbl_init();
+	for (i = 0; i < 256; i++) {
+		depth = 8 + rand() % 17;
+		fib_tbl_insert(ub_keys[i] & ~(u32)((1ULL << (32 - depth)) - 1), i & 7, depth);
+	}
+	return 0;
+}
+
+static u64 ub_lpm_run(u64 iters)
+{
+	u64 i, sum = 0;
+	int port = 0;
+
+	for (i = 0; i < iters; i++) {
+		fib_tbl_lookup(ub_keys[i & (UB_KEYS - 1)], &port);
+		sum += port;
+	}
+	return sum;
+}
+
+/* pkt_l3fwd flow cache (LPM_FRWD build: keyed on dst IP), one warmed-up
+ * /20 route, i.e. 4K flows
+ */
+static struct {
+	tuple5_t key;
+} ub_flows[UB_KEYS];
+
+static int ub_flow_cache_setup(void)
+{
+	char route[] = "10.0.0.0/20,eth0,00:11:22:33:44:55";
+	char *oif;
+	u8 *mac;
+	int i;
+
+	init_fwd_db();
+	if (create_fwd_db_entry(route, &oif, &mac))
+		return -EINVAL;
+	init_fwd_hash_cache();
+
+	for (i = 0; i < UB_KEYS; i++) {
+		memset(&ub_flows[i].key, 0, sizeof(ub_flows[i].key));
+		ub_flows[i].key.u5t.ipv4_5t.dst_ip = 0x0a000000 | (ub_keys[i] & (UB_KEYS - 1));
+	}
+	return find_fwd_db_entry(&ub_flows[0].key) ? 0 : -ENOENT;
+}
+
+static u64 ub_flow_cache_run(u64 iters)
+{
+	u64 i, sum = 0;
+
+	for (i = 0; i < iters; i++)
+		sum += (uintptr_t)find_fwd_db_entry(&ub_flows[i & (UB_KEYS - 1)].key);
+	return sum;
+}
+
+/* hashes */
+#define UB_XXH_RUN(len)							\
+static u64 ub_xxhash_##len##_run(u64 iters)				\
+{									\
+	u64 i, sum = 0;							\
+									\
+	for (i = 0; i < iters; i++)					\
+		sum += XXH_fast32(ub_buf + (i & 15) * 4, len, 0);	\
+	return sum;							\
+}
+UB_XXH_RUN(13)
+UB_XXH_RUN(37)
+UB_XXH_RUN(64)
+
+/* Internet checksum */
+static u64 ub_csum_ip4hdr_run(u64 iters)
+{
+	u64 i, sum = 0;
+
+	for (i = 0; i < iters; i++)
+		sum += mv_calc_csum16((u16 *)(ub_buf + (i & 31) * 2), 10);
+	return sum;
+}
+
+static u64 ub_csum_1500_run(u64 iters)
+{
+	u64 i, sum = 0;
+
+	for (i = 0; i < iters; i++) {
+		ub_buf[0] = i;
+		sum += mv_calc_csum16((u16 *)ub_buf, 750);
+	}
+	return sum;
+}
+
+/* table driven CRC64 (ECMA-182) used by the GIU driver */
+static u64 ub_crc64_1500_run(u64 iters)
+{
+	u64 i, sum = 0;
+
+	for (i = 0; i < iters; i++) {
+		ub_buf[0] = i;
+		sum ^= crc64_compute(ub_buf, 1500, CRC64_DEFAULT_INITVAL);
+	}
+	return sum;
+}
+
+#ifdef MVCONF_SAM_BUILT
+/* software crypto used by the SAM driver (HMAC precomputation, GCM keys) */
+static u64 ub_aes128_run(u64 iters)
+{
+	u64 i;
+
+	for (i = 0; i < iters; i++)
+		mv_aes_ecb_encrypt(ub_buf, ub_buf + 64, ub_buf, 16);
+	return ub_buf[0];
+}
+
+static u64 ub_md5_64_run(u64 iters)
+{
+	u64 i;
+
+	for (i = 0; i < iters; i++)
+		mv_md5(ub_buf, 64, ub_buf + 64);
+	return ub_buf[64];
+}
+
+static u64 ub_sha1_64_run(u64 iters)
+{
+	u64 i;
+
+	for (i = 0; i < iters; i++)
+		mv_sha1(ub_buf, 64, ub_buf + 64);
+	return ub_buf[64];
+}
+
+static u64 ub_sha256_64_run(u64 iters)
+{
+	u64 i;
+
+	for (i = 0; i < iters; i++)
+		mv_sha256(ub_buf, 64, ub_buf + 64);
+	return ub_buf[64];
+}
+
+static u64 ub_sha256_1500_run(u64 iters)
+{
+	u64 i;
+
+	for (i = 0; i < iters; i++) {
+		ub_buf[0] = i;
+		mv_sha256(ub_buf, 1500, ub_buf + 1536);
+	}
+	return ub_buf[1536];
+}
+#endif /* MVCONF_SAM_BUILT */
+
+/* spinlock, uncontended */
+static spinlock_t ub_lock;
+
+static int ub_spinlock_setup(void)
+{
+	spin_lock_init(&ub_lock);
+	return 0;
+}
+
+static u64 ub_spinlock_run(u64 iters)
+{
+	u64 i, sum = 0;
+
+	for (i = 0; i < iters; i++) {
+		spin_lock(&ub_lock);
+		sum += i;
+		spin_unlock(&ub_lock);
+	}
+	return sum;
+}
+
+static struct ubench ubenches[] = {
+	{"mem_mng_get_put",	"mem",	   0, ub_mem_mng_setup, ub_mem_mng_run, ub_mem_mng_teardown},
+	{"dma_mem_alloc_free",	"mem",	   0, ub_dma_mem_setup, ub_dma_mem_run, ub_dma_mem_teardown},
+	{"mqa_prod_cons_64B",	"queue",  UB_MQA_ELEM, ub_mqa_setup, ub_mqa_run, ub_mqa_teardown},
+	{"l3fwd_lpm_lookup",	"lookup",  0, ub_lpm_setup, ub_lpm_run, NULL},
+	{"l3fwd_flow_cache_lookup", "lookup", 0, ub_flow_cache_setup, ub_flow_cache_run, NULL},
+	{"xxhash32_13B",	"hash",	  13, NULL, ub_xxhash_13_run, NULL},
+	{"xxhash32_37B",	"hash",	  37, NULL, ub_xxhash_37_run, NULL},
+	{"xxhash32_64B",	"hash",	  64, NULL, ub_xxhash_64_run, NULL},
+	{"csum16_ipv4_hdr",	"csum",	  20, NULL, ub_csum_ip4hdr_run, NULL},
+	{"csum16_1500B",	"csum",	1500, NULL, ub_csum_1500_run, NULL},
+	{"crc64_1500B",		"crc",	1500, NULL, ub_crc64_1500_run, NULL},
+#ifdef MVCONF_SAM_BUILT
+	{"aes128_ecb_block",	"crypto", 16, NULL, ub_aes128_run, NULL},
+	{"md5_64B",		"crypto", 64, NULL, ub_md5_64_run, NULL},
+	{"sha1_64B",		"crypto", 64, NULL, ub_sha1_64_run, NULL},
+	{"sha256_64B",		"crypto", 64, NULL, ub_sha256_64_run, NULL},
+	{"sha256_1500B",	"crypto", 1500, NULL, ub_sha256_1500_run, NULL},
+#endif /* MVCONF_SAM_BUILT */
+	{"spinlock_uncontended", "lock",   0, ub_spinlock_setup, ub_spinlock_run, NULL},
+};
+
+static int ub_cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+static void ub_run_one(FILE *out, struct ubench *ub, int repeat, u32 min_ms, int first)
+{
+	double ns[UB_MAX_REPEAT];
+	u64 iters, t0, t1;
+	int r;
+
+	fprintf(out, "%s\n    {\"name\": \"%s\", \"group\": \"%s\", ", first ? "" : ",", ub->name, ub->group);
+	if (ub->setup && ub->setup() < 0) {
+		fprintf(stderr, "%-28s skipped (setup failed)\n", ub->name);
+		fprintf(out, "\"status\": \"skipped\"}");
+		return;
+	}
+
+	/* calibrate */
+	for (iters = 1024; ; iters *= 2) {
+		t0 = ub_now_ns();
+		ub_sink += ub->run(iters);
+		t1 = ub_now_ns();
+		if (t1 - t0 >= min_ms * 1000000ULL || iters >= (1ULL << 40))
+			break;
+	}
+	for (r = 0; r < repeat; r++) {
+		t0 = ub_now_ns();
+		ub_sink += ub->run(iters);
+		t1 = ub_now_ns();
+		ns[r] = (double)(t1 - t0) / iters;
+	}
+	if (ub->teardown)
+		ub->teardown();
+
+	qsort(ns, repeat, sizeof(ns[0]), ub_cmp_double);
+	fprintf(stderr, "%-28s %10.2f ns/op (min %.2f, max %.2f)\n", ub->name, ns[repeat / 2], ns[0], ns[repeat - 1]);
+	fprintf(out, "\"status\": \"ok\", \"iters\": %llu, \"ns_per_op_min\": %.3f, \"ns_per_op_median\": %.3f, "
+		"\"ns_per_op_max\": %.3f, \"mops\": %.3f",
+		(unsigned long long)iters, ns[0], ns[repeat / 2], ns[repeat - 1], 1000.0 / ns[repeat / 2]);
+	if (ub->bytes)
+		fprintf(out, ", \"mbytes_per_sec\": %.1f", ub->bytes * 1000.0 / ns[repeat / 2]);
+	fprintf(out, "}");
+}
+
+static void usage(char *progname)
+{
+	printf("\n"
+	       "MUSDK data path microbenchmarks\n"
+	       "\n"
+	       "Usage: %s [OPTIONS]\n"
+	       "\n"
+	       "Optional OPTIONS:\n"
+	       "\t-o, --output <file>   JSON output file (default: stdout)\n"
+	       "\t-f, --filter <str>    run only benchmarks whose name or group contains <str>\n"
+	       "\t-r, --repeat <num>    repetitions per benchmark (default: %d, max %d)\n"
+	       "\t-t, --time <ms>       min time per repetition (default: %d)\n"
+	       "\t-l, --list            list the benchmarks\n"
+	       "\n", progname, UB_DEF_REPEAT, UB_MAX_REPEAT, UB_DEF_MIN_MS);
+}
+
+int main(int argc, char *argv[])
+{
+	struct option long_options[] = {
+		{"output", required_argument, 0, 'o'},
+		{"filter", required_argument, 0, 'f'},
+		{"repeat", required_argument, 0, 'r'},
+		{"time", required_argument, 0, 't'},
+		{"list", no_argument, 0, 'l'},
+		{"help", no_argument, 0, 'h'},
+		{0, 0, 0, 0}
+	};
+	const char *filter = NULL, *out_name = NULL;
+	int repeat = UB_DEF_REPEAT, opt, i, first = 1;
+	u32 min_ms = UB_DEF_MIN_MS;
+	FILE *out;
+
+	while ((opt = getopt_long(argc, argv, "o:f:r:t:lh", long_options, NULL)) != -1) {
+		switch (opt) {
+		case 'o':
+			out_name = optarg;
+			break;
+		case 'f':
+			filter = optarg;
+			break;
+		case 'r':
+			repeat = atoi(optarg);
+			break;
+		case 't':
+			min_ms = atoi(optarg);
+			break;
+		case 'l':
+			for (i = 0; i < ARRAY_SIZE(ubenches); i++)
+				printf("%-28s %s\n", ubenches[i].name, ubenches[i].group);
+			return 0;
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : -1;
+		}
+	}
+	if (repeat < 1 || repeat > UB_MAX_REPEAT || !min_ms) {
+		usage(argv[0]);
+		return -1;
+	}
+
+	if (out_name) {
+		out = fopen(out_name, "w");
+		if (!out) {
+			fprintf(stderr, "can't open %s\n", out_name);
+			return -1;
+		}
+	} else {
+		/* keep stdout for the JSON; library prints go to stderr */
+		out = fdopen(dup(STDOUT_FILENO), "w");
+		if (!out)
+			return -1;
+		dup2(STDERR_FILENO, STDOUT_FILENO);
+	}
+
+	fprintf(stderr, "Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	srand(1);
+	ub_fill_random();
+
+	fprintf(out, "{\n  \"suite\": \"musdk_ubench\",\n  \"build\": \"%s %s\",\n", __DATE__, __TIME__);
+	fprintf(out, "  \"repeat\": %d,\n  \"min_ms\": %u,\n  \"results\": [", repeat, min_ms);
+	for (i = 0; i < ARRAY_SIZE(ubenches); i++) {
+		if (filter && !strstr(ubenches[i].name, filter) && !strstr(ubenches[i].group, filter))
+			continue;
+		ub_run_one(out, &ubenches[i], repeat, min_ms, first);
+		first = 0;
+	}
+	fprintf(out, "\n  ]\n}\n");
+	fclose(out);
+	return 0;
+}
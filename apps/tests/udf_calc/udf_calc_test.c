@@ -0,0 +1,351 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "mv_std.h"
+#include "lib/mv_udf_calc.h"
+
+#define UC_PKT_SIZE		512
+#define UC_MARK			0xA5
+
+#define UC_CHECK(cond, ...)			\
+	do {					\
+		if (!(cond)) {			\
+			printf(__VA_ARGS__);	\
+			return -1;		\
+		}				\
+	} while (0)
+
+#define UC_ETH		{MV_UDF_HDR_ETH, 0, 0}
+#define UC_VLAN		{MV_UDF_HDR_VLAN, 0, 0}
+#define UC_QINQ		{MV_UDF_HDR_QINQ, 0, 0}
+#define UC_PPPOE	{MV_UDF_HDR_PPPOE, 0, 0}
+#define UC_MPLS		{MV_UDF_HDR_MPLS, 0, 0}
+#define UC_IP4		{MV_UDF_HDR_IP4, 0, 0}
+#define UC_IP6		{MV_UDF_HDR_IP6, 0, 0}
+#define UC_UDP		{MV_UDF_HDR_UDP, 0, 0}
+#define UC_TCP		{MV_UDF_HDR_TCP, 0, 0}
+#define UC_GRE		{MV_UDF_HDR_GRE, 0, 0}
+#define UC_VXLAN	{MV_UDF_HDR_VXLAN, 0, 0}
+
+struct uc_case {
+	const char		*name;
+	struct mv_udf_hdr	path[MV_UDF_MAX_HDRS];
+	u8			num_hdrs;
+	u8			hdr;
+	u16			offs;
+	u8			size;
+	int			rc;
+	u8			offset;	/* expected, if rc is 0 */
+	u16			etype;
+	u8			var_hdrs;
+};
+
+static const struct uc_case uc_cases[] = {
+	{"ipv4 dip", {UC_ETH, UC_IP4}, 2, 1, 16, 4, 0, 18, 0x0800, 0},
+	{"vlan ipv4 proto", {UC_ETH, UC_VLAN, UC_IP4}, 3, 2, 9, 1, 0, 11, 0x0800, 0},
+	{"qinq ipv6 dip", {UC_ETH, UC_QINQ, UC_VLAN, UC_IP6}, 4, 3, 36, 4, 0, 38, 0x86DD, 0},
+	{"triple vlan tcp dport", {UC_ETH, UC_QINQ, UC_VLAN, UC_VLAN, UC_IP4, UC_TCP}, 6, 5, 2, 2,
+	 0, 24, 0x0800, 1},
+	{"edsa vlan ipv4 proto", {UC_ETH, {MV_UDF_HDR_DSA, 8, 0}, UC_VLAN, UC_IP4}, 4, 3, 9, 1,
+	 0, 11, 0x0800, 0},
+	{"ipv4 vxlan vni", {UC_ETH, UC_IP4, UC_UDP, UC_VXLAN}, 4, 3, 4, 3, 0, 34, 0x0800, 1},
+	{"ipv6 vxlan vni", {UC_ETH, UC_IP6, UC_UDP, UC_VXLAN}, 4, 3, 4, 3, 0, 54, 0x86DD, 1},
+	{"vxlan inner ipv4 dip", {UC_ETH, UC_IP4, UC_UDP, UC_VXLAN, UC_ETH, UC_IP4}, 6, 5, 16, 4,
+	 0, 68, 0x0800, 1},
+	{"vlan vxlan inner vlan id", {UC_ETH, UC_VLAN, UC_IP4, UC_UDP, UC_VXLAN, UC_ETH, UC_VLAN, UC_IP4},
+	 8, 6, 0, 2, 0, 52, 0x0800, 1},
+	{"gre key", {UC_ETH, UC_IP4, {MV_UDF_HDR_GRE, 8, 0}}, 3, 2, 4, 4, 0, 26, 0x0800, 1},
+	{"gre inner ipv4 dip", {UC_ETH, UC_IP4, UC_GRE, UC_IP4}, 4, 3, 16, 4, 0, 42, 0x0800, 2},
+	{"nvgre inner da", {UC_ETH, UC_IP4, {MV_UDF_HDR_GRE, 8, 0}, UC_ETH}, 4, 3, 2, 4,
+	 0, 32, 0x0800, 2},
+	{"ipv4 options udp dport", {UC_ETH, {MV_UDF_HDR_IP4, 24, 0}, UC_UDP}, 3, 2, 2, 2, 0, 28, 0x0800, 1},
+	{"mpls stack ipv4 dip", {UC_ETH, UC_MPLS, UC_MPLS, UC_IP4}, 4, 3, 16, 4, 0, 26, 0x8847, 0},
+	{"mpls pw inner da", {UC_ETH, UC_MPLS, UC_ETH}, 3, 2, 0, 4, 0, 6, 0x8847, 0},
+	{"mpls over udp label", {UC_ETH, UC_IP4, UC_UDP, UC_MPLS}, 4, 3, 0, 3, 0, 30, 0x0800, 1},
+	{"pppoe ipv4 dip", {UC_ETH, UC_PPPOE, UC_IP4}, 3, 2, 16, 4, 0, 26, 0x8864, 0},
+	{"raw ethertype", {UC_ETH, {MV_UDF_HDR_RAW, 16, 0x88B5}}, 2, 1, 6, 2, 0, 8, 0x88B5, 0},
+	{"ipv6 ext vxlan vni", {UC_ETH, {MV_UDF_HDR_IP6, 240, 0}, UC_UDP, UC_VXLAN}, 4, 3, 4, 3,
+	 0, 254, 0x86DD, 1},
+	/* unreachable */
+	{"ipv6 ext over range", {UC_ETH, {MV_UDF_HDR_IP6, 248, 0}, UC_UDP, UC_VXLAN}, 4, 3, 4, 3,
+	 -ERANGE},
+	{"vlan id", {UC_ETH, UC_VLAN, UC_IP4}, 3, 1, 0, 2, -ENOTSUP},
+	{"outer da", {UC_ETH, UC_IP4}, 2, 0, 0, 4, -ENOTSUP},
+	{"4 vlan tags", {UC_ETH, UC_QINQ, UC_VLAN, UC_VLAN, UC_VLAN, UC_IP4}, 6, 5, 16, 4, -ENOTSUP},
+	{"l2 only", {UC_ETH, UC_VLAN}, 2, 1, 0, 2, -ENOTSUP},
+	/* invalid */
+	{"udp after eth", {UC_ETH, UC_UDP}, 2, 1, 2, 2, -EINVAL},
+	{"eth after vlan", {UC_ETH, UC_VLAN, UC_ETH}, 3, 2, 0, 4, -EINVAL},
+	{"vxlan after tcp", {UC_ETH, UC_IP4, UC_TCP, UC_VXLAN}, 4, 3, 4, 3, -EINVAL},
+	{"qinq after vlan", {UC_ETH, UC_VLAN, UC_QINQ, UC_IP4}, 4, 3, 16, 4, -EINVAL},
+	{"dsa after vlan", {UC_ETH, UC_VLAN, {MV_UDF_HDR_DSA, 4, 0}, UC_IP4}, 4, 3, 16, 4, -EINVAL},
+	{"raw no ethertype", {UC_ETH, {MV_UDF_HDR_RAW, 16, 0}}, 2, 1, 0, 2, -EINVAL},
+	{"raw no length", {UC_ETH, {MV_UDF_HDR_RAW, 0, 0x88B5}}, 2, 1, 0, 2, -EINVAL},
+	{"bad ipv4 length", {UC_ETH, {MV_UDF_HDR_IP4, 22, 0}}, 2, 1, 16, 4, -EINVAL},
+	{"field over header", {UC_ETH, UC_IP4, UC_UDP}, 3, 2, 6, 4, -EINVAL},
+	{"field size", {UC_ETH, UC_IP4}, 2, 1, 12, 5, -EINVAL},
+	{"no outer eth", {UC_IP4, UC_UDP}, 2, 1, 0, 2, -EINVAL},
+};
+
+static u16 uc_hdr_len(const struct mv_udf_hdr *hdr)
+{
+	static const u16 min_len[MV_UDF_HDR_LAST] = {14, 4, 4, 4, 8, 4, 20, 40, 8, 20, 4, 8, 0};
+
+	return hdr->len ? hdr->len : min_len[hdr->type];
+}
+
+static u16 uc_hdr_etype(const struct mv_udf_hdr *hdr)
+{
+	switch (hdr->type) {
+	case MV_UDF_HDR_VLAN:
+		return 0x8100;
+	case MV_UDF_HDR_QINQ:
+		return 0x88A8;
+	case MV_UDF_HDR_PPPOE:
+		return 0x8864;
+	case MV_UDF_HDR_MPLS:
+		return 0x8847;
+	case MV_UDF_HDR_IP4:
+		return 0x0800;
+	case MV_UDF_HDR_IP6:
+		return 0x86DD;
+	default:
+		return hdr->etype;
+	}
+}
+
+/* Build the frame of a path, with the L2 types set and the field marked */
+static u32 uc_build(const struct uc_case *c, u8 *pkt, u32 *dsa_len)
+{
+	u32 pos = 0, len, i, j;
+	u16 etype;
+
+	memset(pkt, 0, UC_PKT_SIZE);
+	*dsa_len = 0;
+	for (i = 0; i < c->num_hdrs; i++) {
+		len = uc_hdr_len(&c->path[i]);
+		if (c->path[i].type == MV_UDF_HDR_DSA)
+			*dsa_len = len;
+		if (i + 1 < c->num_hdrs && (c->path[i].type == MV_UDF_HDR_ETH ||
+		    c->path[i].type == MV_UDF_HDR_VLAN || c->path[i].type == MV_UDF_HDR_QINQ ||
+		    c->path[i].type == MV_UDF_HDR_DSA)) {
+			etype = uc_hdr_etype(&c->path[i + 1]);
+			pkt[pos + len - 2] = etype >> 8;
+			pkt[pos + len - 1] = etype & 0xff;
+		}
+		if (i == c->hdr)
+			for (j = 0; j < c->size; j++)
+				pkt[pos + c->offs + j] = UC_MARK;
+		pos += len;
+	}
+	return pos;
+}
+
+/* Walk the frame as the parser does up to its L2 lookup, and extract the UDF */
+static int uc_extract(const u8 *pkt, u32 dsa_len, const struct mv_udf_cfg *cfg)
+{
+	u32 pos = 2 * MV_ETH_ALEN + dsa_len;
+	u16 etype;
+	int tags, i;
+
+	for (tags = 0; tags <= MV_UDF_MAX_L2_TAGS; tags++) {
+		etype = (pkt[pos] << 8) | pkt[pos + 1];
+		if (etype != 0x8100 && etype != 0x88A8)
+			break;
+		pos += MV_VLAN_TAG_LEN;
+	}
+	if ((pkt[pos] & cfg->match_mask[0]) != cfg->match_key[0] ||
+	    (pkt[pos + 1] & cfg->match_mask[1]) != cfg->match_key[1])
+		return -1;
+	for (i = 0; i < cfg->size; i++)
+		if (pkt[pos + cfg->offset + i] != UC_MARK)
+			return -1;
+	return 0;
+}
+
+static int test_cases(void)
+{
+	const struct uc_case *c;
+	struct mv_udf_field field;
+	struct mv_udf_cfg cfg;
+	u8 pkt[UC_PKT_SIZE];
+	u32 i, dsa_len, len;
+	int rc;
+
+	printf("  calc: %u cases\n", (u32)ARRAY_SIZE(uc_cases));
+	for (i = 0; i < ARRAY_SIZE(uc_cases); i++) {
+		c = &uc_cases[i];
+		field.path = c->path;
+		field.num_hdrs = c->num_hdrs;
+		field.hdr = c->hdr;
+		field.offs = c->offs;
+		field.size = c->size;
+		rc = mv_udf_calc(&field, &cfg);
+		UC_CHECK(rc == c->rc, "%s: rc %d, expected %d\n", c->name, rc, c->rc);
+		if (rc)
+			continue;
+
+		UC_CHECK(cfg.match_proto == MV_NET_PROTO_ETH && cfg.match_field.eth == MV_NET_ETH_F_TYPE,
+			 "%s: match field\n", c->name);
+		UC_CHECK(cfg.offset == c->offset, "%s: offset %u, expected %u\n", c->name, cfg.offset, c->offset);
+		UC_CHECK(((cfg.match_key[0] << 8) | cfg.match_key[1]) == c->etype &&
+			 cfg.match_mask[0] == 0xff && cfg.match_mask[1] == 0xff,
+			 "%s: ethertype %02x%02x\n", c->name, cfg.match_key[0], cfg.match_key[1]);
+		UC_CHECK(cfg.var_hdrs == c->var_hdrs, "%s: %u variable headers, expected %u\n",
+			 c->name, cfg.var_hdrs, c->var_hdrs);
+		UC_CHECK(cfg.size == c->size, "%s: size\n", c->name);
+
+		len = uc_build(c, pkt, &dsa_len);
+		UC_CHECK(cfg.pkt_offs + cfg.size <= len && pkt[cfg.pkt_offs] == UC_MARK,
+			 "%s: frame offset %u\n", c->name, cfg.pkt_offs);
+		UC_CHECK(!uc_extract(pkt, dsa_len, &cfg), "%s: parser walk mismatch\n", c->name);
+	}
+	return 0;
+}
+
+static int test_set(void)
+{
+	static const struct mv_udf_hdr vxlan[] = {UC_ETH, UC_IP4, UC_UDP, UC_VXLAN};
+	static const struct mv_udf_hdr vxlan6[] = {UC_ETH, UC_VLAN, UC_IP6, UC_UDP, UC_VXLAN};
+	static const struct mv_udf_hdr mpls[] = {UC_ETH, UC_MPLS, UC_IP4};
+	static const struct mv_udf_hdr gre[] = {UC_ETH, UC_VLAN, UC_IP4, {MV_UDF_HDR_GRE, 8, 0}};
+	struct mv_udf_field fields[] = {
+		{vxlan, ARRAY_SIZE(vxlan), 3, 4, 3},
+		{vxlan6, ARRAY_SIZE(vxlan6), 4, 4, 3},
+		{mpls, ARRAY_SIZE(mpls), 1, 0, 3},
+		{gre, ARRAY_SIZE(gre), 3, 4, 4},
+	};
+	struct mv_udf_cfg cfgs[ARRAY_SIZE(fields)];
+	u32 i;
+
+	printf("  set\n");
+	for (i = 0; i < ARRAY_SIZE(fields); i++)
+		UC_CHECK(!mv_udf_calc(&fields[i], &cfgs[i]), "set field %u failed\n", i);
+
+	UC_CHECK(!mv_udf_calc_check(cfgs, 0), "empty set rejected\n");
+	UC_CHECK(!mv_udf_calc_check(cfgs, 3), "vxlan/vxlan6/mpls set rejected\n");
+	UC_CHECK(mv_udf_calc_check(cfgs, 4) == -EINVAL, "4 UDFs accepted\n");
+	/* ipv4 gre after ipv4 vxlan: both match ethertype 0x0800 */
+	cfgs[2] = cfgs[3];
+	UC_CHECK(mv_udf_calc_check(cfgs, 3) == -EEXIST, "shadowed UDF accepted\n");
+	/* a partial mask overlaps too */
+	cfgs[2] = cfgs[1];
+	cfgs[2].match_key[0] = 0x80;
+	cfgs[2].match_mask[0] = 0xf0;
+	cfgs[2].match_key[1] = 0;
+	cfgs[2].match_mask[1] = 0;
+	UC_CHECK(mv_udf_calc_check(cfgs, 3) == -EEXIST, "masked shadowed UDF accepted\n");
+	cfgs[2].match_key[0] = 0x90;
+	UC_CHECK(!mv_udf_calc_check(cfgs, 3), "disjoint masked UDF rejected\n");
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+
+	if (test_cases() || test_set()) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
@@ -0,0 +1,367 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mv_std.h"
+#include "lib/mv_wred.h"
+
+#define WT_AVG(d)		((d) << 8)	/* depth to average units */
+#define WT_TRACE_LEN		100000
+#define WT_PKTS			200000
+
+#define WT_CHECK(cond, ...)					\
+	do {							\
+		if (!(cond)) {					\
+			printf("  line %d: ", __LINE__);	\
+			printf(__VA_ARGS__);			\
+			printf("\n");				\
+			err = -1;				\
+		}						\
+	} while (0)
+
+static void wt_params(struct mv_wred_params *params, int gentle)
+{
+	memset(params, 0, sizeof(*params));
+	params->curve[MV_PLCR_COLOR_GREEN].min_th = 100;
+	params->curve[MV_PLCR_COLOR_GREEN].max_th = 300;
+	params->curve[MV_PLCR_COLOR_GREEN].max_p_pct = 10;
+	params->curve[MV_PLCR_COLOR_YELLOW].min_th = 50;
+	params->curve[MV_PLCR_COLOR_YELLOW].max_th = 200;
+	params->curve[MV_PLCR_COLOR_YELLOW].max_p_pct = 20;
+	params->curve[MV_PLCR_COLOR_RED].min_th = 20;
+	params->curve[MV_PLCR_COLOR_RED].max_th = 100;
+	params->curve[MV_PLCR_COLOR_RED].max_p_pct = 50;
+	params->gentle = gentle;
+}
+
+static int wt_test_curve(void)
+{
+	struct mv_wred_params	 params;
+	struct mv_wred		*wred;
+	u32			 max_p = 10 * MV_WRED_PROB_ONE / 100;
+	u32			 avg, p, prev[MV_PLCR_COLOR_NUM];
+	int			 c, gentle, err = 0;
+
+	printf("drop probability curve:\n");
+	for (gentle = 0; gentle < 2; gentle++) {
+		wt_params(&params, gentle);
+		if (mv_wred_create(&params, &wred)) {
+			printf("  create failed\n");
+			return -1;
+		}
+
+		WT_CHECK(mv_wred_prob(wred, 0, MV_PLCR_COLOR_GREEN) == 0, "p(0) != 0");
+		WT_CHECK(mv_wred_prob(wred, WT_AVG(100) - 1, MV_PLCR_COLOR_GREEN) == 0,
+			 "drop below min_th");
+		WT_CHECK(mv_wred_prob(wred, WT_AVG(100), MV_PLCR_COLOR_GREEN) == 0, "drop at min_th");
+		p = mv_wred_prob(wred, WT_AVG(200), MV_PLCR_COLOR_GREEN);
+		WT_CHECK(p == max_p / 2, "p(mid) %u, expected %u", p, max_p / 2);
+		p = mv_wred_prob(wred, WT_AVG(300) - 1, MV_PLCR_COLOR_GREEN);
+		WT_CHECK(p <= max_p && p >= max_p - 1, "p(max_th-) %u, expected %u", p, max_p);
+		p = mv_wred_prob(wred, WT_AVG(300), MV_PLCR_COLOR_GREEN);
+		if (gentle) {
+			WT_CHECK(p == max_p, "gentle p(max_th) %u, expected %u", p, max_p);
+			p = mv_wred_prob(wred, WT_AVG(450), MV_PLCR_COLOR_GREEN);
+			WT_CHECK(p == (MV_WRED_PROB_ONE + max_p) / 2, "gentle p(1.5 max_th) %u, expected %u",
+				 p, (MV_WRED_PROB_ONE + max_p) / 2);
+			p = mv_wred_prob(wred, WT_AVG(600), MV_PLCR_COLOR_GREEN);
+		}
+		WT_CHECK(p == MV_WRED_PROB_ONE, "p above the curve %u", p);
+
+		/* monotonic in the average, and stricter for the worse colors */
+		memset(prev, 0, sizeof(prev));
+		for (avg = 0; avg <= WT_AVG(700); avg += 37) {
+			for (c = 0; c < MV_PLCR_COLOR_NUM; c++) {
+				p = mv_wred_prob(wred, avg, c);
+				WT_CHECK(p >= prev[c] && p <= MV_WRED_PROB_ONE,
+					 "color %d not monotonic at %u (%u < %u)", c, avg, p, prev[c]);
+				prev[c] = p;
+			}
+			WT_CHECK(prev[MV_PLCR_COLOR_RED] >= prev[MV_PLCR_COLOR_YELLOW] &&
+				 prev[MV_PLCR_COLOR_YELLOW] >= prev[MV_PLCR_COLOR_GREEN],
+				 "colors not ordered at %u", avg);
+		}
+		mv_wred_destroy(wred);
+	}
+
+	/* a zero curve never drops */
+	memset(&params, 0, sizeof(params));
+	if (mv_wred_create(&params, &wred))
+		return -1;
+	for (c = 0; c < 1000; c++)
+		WT_CHECK(!mv_wred_drop(wred, 100000, MV_PLCR_COLOR_RED), "zero curve dropped");
+	mv_wred_destroy(wred);
+
+	printf("  %s\n", err ? "failed" : "ok");
+	return err;
+}
+
+static int wt_test_avg(void)
+{
+	struct mv_wred_params	 params;
+	struct mv_wred		*wred;
+	u32			 avg;
+	int			 i, err = 0;
+
+	printf("average depth:\n");
+	memset(&params, 0, sizeof(params));
+	params.wq_shift = 4;
+	if (mv_wred_create(&params, &wred))
+		return -1;
+
+	for (i = 0; i < 300; i++)
+		mv_wred_drop(wred, 100, MV_PLCR_COLOR_GREEN);
+	avg = mv_wred_get_avg(wred);
+	WT_CHECK(avg == WT_AVG(100), "constant depth: avg %u, expected %u", avg, WT_AVG(100));
+
+	/* 100 * (15/16)^16 = 35.6 */
+	for (i = 0; i < 16; i++)
+		mv_wred_drop(wred, 0, MV_PLCR_COLOR_GREEN);
+	avg = mv_wred_get_avg(wred);
+	WT_CHECK(avg >= WT_AVG(34) && avg <= WT_AVG(37), "decay: avg %u.%02u, expected ~35.6",
+		 avg >> 8, (avg & 0xff) * 100 / 256);
+
+	for (i = 0; i < 1000; i++)
+		mv_wred_drop(wred, 0, MV_PLCR_COLOR_GREEN);
+	WT_CHECK(mv_wred_get_avg(wred) == 0, "avg does not drain to 0");
+	mv_wred_destroy(wred);
+
+	memset(&params, 0, sizeof(params));
+	params.wq_shift = 17;
+	WT_CHECK(mv_wred_create(&params, &wred) < 0, "invalid wq_shift accepted");
+	wt_params(&params, 0);
+	params.curve[MV_PLCR_COLOR_YELLOW].min_th = 300;
+	WT_CHECK(mv_wred_create(&params, &wred) < 0, "min_th > max_th accepted");
+	wt_params(&params, 0);
+	params.curve[MV_PLCR_COLOR_RED].max_p_pct = 101;
+	WT_CHECK(mv_wred_create(&params, &wred) < 0, "max_p > 100%% accepted");
+
+	printf("  %s\n", err ? "failed" : "ok");
+	return err;
+}
+
+static int wt_test_drops(void)
+{
+	struct mv_wred_params	 params;
+	struct mv_wred_stats	 stats;
+	struct mv_wred		*wred;
+	u32			 pb, exp_ppm, ppm, gap = 0, max_gap = 0;
+	int			 i, err = 0;
+
+	printf("drop rate:\n");
+	wt_params(&params, 0);
+	params.wq_shift = 4;
+	if (mv_wred_create(&params, &wred))
+		return -1;
+
+	for (i = 0; i < 1000; i++)
+		mv_wred_drop(wred, 200, MV_PLCR_COLOR_GREEN);
+	mv_wred_get_stats(wred, &stats, 1);
+
+	for (i = 0; i < WT_PKTS; i++) {
+		gap++;
+		if (mv_wred_drop(wred, 200, MV_PLCR_COLOR_GREEN)) {
+			max_gap = max(max_gap, gap);
+			gap = 0;
+		}
+	}
+	mv_wred_get_stats(wred, &stats, 0);
+	WT_CHECK(stats.pkts[MV_PLCR_COLOR_GREEN] == WT_PKTS, "pkts %llu",
+		 (unsigned long long)stats.pkts[MV_PLCR_COLOR_GREEN]);
+
+	/* drops are uniformly 1..1/pb - 1 packets apart: the rate is 2pb */
+	pb = mv_wred_prob(wred, WT_AVG(200), MV_PLCR_COLOR_GREEN);
+	exp_ppm = (u64)2 * pb * 1000000 / MV_WRED_PROB_ONE;
+	ppm = stats.drops[MV_PLCR_COLOR_GREEN] * 1000000 / WT_PKTS;
+	printf("  pb %u ppm, drops %u ppm (expected %u), max gap %u\n",
+	       (u32)((u64)pb * 1000000 / MV_WRED_PROB_ONE), ppm, exp_ppm, max_gap);
+	WT_CHECK(ppm > exp_ppm * 95 / 100 && ppm < exp_ppm * 105 / 100, "drop rate off");
+	WT_CHECK(max_gap <= MV_WRED_PROB_ONE / pb + 1, "drops not spread (gap %u)", max_gap);
+
+	/* above max_th all the packets of the color are dropped, the others not */
+	for (i = 0; i < 1000; i++)
+		mv_wred_drop(wred, 150, MV_PLCR_COLOR_GREEN);
+	mv_wred_get_stats(wred, &stats, 1);
+	for (i = 0; i < 1000; i++) {
+		mv_wred_drop(wred, 150, MV_PLCR_COLOR_RED);
+		mv_wred_drop(wred, 150, MV_PLCR_COLOR_GREEN);
+	}
+	mv_wred_get_stats(wred, &stats, 1);
+	WT_CHECK(stats.drops[MV_PLCR_COLOR_RED] == 1000, "red drops %llu",
+		 (unsigned long long)stats.drops[MV_PLCR_COLOR_RED]);
+	WT_CHECK(stats.drops[MV_PLCR_COLOR_GREEN] < 100, "green drops %llu",
+		 (unsigned long long)stats.drops[MV_PLCR_COLOR_GREEN]);
+	mv_wred_destroy(wred);
+
+	printf("  %s\n", err ? "failed" : "ok");
+	return err;
+}
+
+static int wt_test_sim(void)
+{
+	struct mv_wred_params		 params;
+	struct mv_wred_sim_result	 res;
+	u32				*trace;
+	u32				 i, target;
+	int				 d = 0;
+	int				 err = 0;
+
+	printf("threshold recommendation:\n");
+	trace = malloc(WT_TRACE_LEN * sizeof(*trace));
+	if (!trace)
+		return -1;
+	wt_params(&params, 0);
+
+	/* noisy depth, mostly shallow with congestion episodes */
+	srand(7);
+	for (i = 0; i < WT_TRACE_LEN; i++) {
+		target = ((i / 5000) % 4 == 3) ? 200 : 20;
+		d += ((int)target - d) / 16 + rand() % 41 - 20;
+		d = max(d, 0);
+		trace[i] = d;
+	}
+	WT_CHECK(!mv_wred_sim(&params, trace, NULL, WT_TRACE_LEN, &res), "sim failed");
+	printf("  avg %u, max %u, wred drops %u ppm, thresh %u (drops %u ppm)\n",
+	       res.avg_depth, res.max_depth, res.drop_ppm, res.thresh, res.thresh_drop_ppm);
+	WT_CHECK(res.samples == WT_TRACE_LEN, "samples %u", res.samples);
+	WT_CHECK(res.drop_ppm > 0, "no wred drops on a congested trace");
+	WT_CHECK(res.thresh >= 100 && res.thresh <= 300, "thresh %u out of the curve", res.thresh);
+	WT_CHECK(res.thresh_drop_ppm <= res.drop_ppm, "thresh drops more than wred");
+	WT_CHECK(res.thresh_drop_ppm > res.drop_ppm / 2, "thresh drops far less than wred");
+
+	/* shallow trace: nothing to drop, the threshold goes to the bottom of the curve */
+	for (i = 0; i < WT_TRACE_LEN; i++)
+		trace[i] = i % 50;
+	WT_CHECK(!mv_wred_sim(&params, trace, NULL, WT_TRACE_LEN, &res), "sim failed");
+	WT_CHECK(res.drop_ppm == 0 && res.thresh == 100 && res.thresh_drop_ppm == 0,
+		 "shallow: drops %u ppm, thresh %u", res.drop_ppm, res.thresh);
+
+	/* standing queue above the curve: the threshold goes to its top */
+	for (i = 0; i < WT_TRACE_LEN; i++)
+		trace[i] = 1000;
+	WT_CHECK(!mv_wred_sim(&params, trace, NULL, WT_TRACE_LEN, &res), "sim failed");
+	WT_CHECK(res.drop_ppm > 990000 && res.thresh == 300,
+		 "standing: drops %u ppm, thresh %u", res.drop_ppm, res.thresh);
+
+	WT_CHECK(mv_wred_sim(&params, trace, NULL, 0, &res) < 0, "empty trace accepted");
+	free(trace);
+
+	printf("  %s\n", err ? "failed" : "ok");
+	return err;
+}
+
+int main(int argc, char *argv[])
+{
+	int err = 0;
+
+	printf("Marvell Armada US (Build: %s %s)\n", __DATE__, __TIME__);
+	printf("WRED test:\n");
+
+	err |= wt_test_curve();
+	err |= wt_test_avg();
+	err |= wt_test_drops();
+	err |= wt_test_sim();
+
+	if (err) {
+		printf("FAILED!\n");
+		return -1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
@@ -98,6 +98,7 @@
 
 #include "std_internal.h"
 #include "env/trace/trc_pf.h"
+#include "env/mv_btrace.h"
 #include "drivers/mqa_def.h"
 #include "drivers/mv_dmax2.h"
 
@@ -445,6 +446,7 @@ static int gie_dma_copy_single(struct dma_info *dma, struct dma_job *job)
 	desc.buff_size = job->element_size * job->element_cnt;
 
 	tracepoint(gie, dma, (void *)job->src, (void *)job->dst, desc.buff_size);
+	mv_btrc(MV_BTRC_CAT_GIE, MV_BTRC_ID_GIE_DMA, job->src, job->dst, desc.buff_size, 0);
 
 	/* Copy single is used for copying descriptors, queue pointers
 	 * (indexes), and triggering interrupts.
@@ -547,6 +549,7 @@ static void gie_copy_qes(struct dma_info *dma, struct gie_queue *src_q, struct g
 
 	tracepoint(gie, queue, "QE copy", qes_to_copy, src_q->qid, first_qe, src_q->tail,
 		   dst_q->qid, dst_q->head, dst_q->tail);
+	mv_btrc(MV_BTRC_CAT_GIE, MV_BTRC_ID_GIE_QE_COPY, qes_to_copy, src_q->qid, src_q->tail, dst_q->qid);
 }
 
 static void gie_bpool_fill_shadow(struct dma_info *dma, struct gie_bpool *pool)
@@ -939,6 +942,7 @@ static void gie_produce_q(struct dma_info *dma, struct gie_queue *src_q, struct
 
 	tracepoint(gie, queue, "QE produce", qes_completed, src_q->qid, src_q->head, src_q->tail,
 		   dst_q->qid, dst_q->head, dst_q->tail);
+	mv_btrc(MV_BTRC_CAT_GIE, MV_BTRC_ID_GIE_QE_PRODUCE, qes_completed, src_q->qid, src_q->head, dst_q->qid);
 }
 
 static int gie_clip_batch(struct gie_queue *dst_q, int required_copy)
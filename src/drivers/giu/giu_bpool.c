@@ -100,6 +100,7 @@
 #include "drivers/mv_giu_gpio.h"
 #include "drivers/mv_giu_bpool.h"
 #include "lib/lib_misc.h"
+#include "lib/mv_json.h"
 
 #include "giu_internal.h"
 
@@ -306,10 +307,11 @@ int giu_bpool_probe(char *match, char *buff, struct giu_bpool **bpool)
 	struct giu_bpool_int		*bp_int;
 	struct sys_iomem_params		 iomem_params;
 	struct sys_iomem_info		 sys_iomem_info;
-	char				*lbuff, *sec = NULL;
+	struct mv_json			 json;
+	int				 sec, rc;
 	char				 dev_name[FILE_MAX_LINE_CHARS];
 	u8				 match_params[2];
-	u32				 offs = 0;
+	u32				 phy_base_offs, prod_offs, cons_offs;
 	u8				 giu_id = 0, bpool_id = 0;
 
 	if (!match) {
@@ -317,69 +319,60 @@ int giu_bpool_probe(char *match, char *buff, struct giu_bpool **bpool)
 		return -EFAULT;
 	}
 
-	lbuff = kcalloc(1, strlen(buff), GFP_KERNEL);
-	if (lbuff == NULL)
-		return -ENOMEM;
-
-	memcpy(lbuff, buff, strlen(buff));
-	sec = lbuff;
+	rc = mv_json_init(&json, buff);
+	if (rc)
+		return rc;
 
 	/* Search for match (giu_pool-x:x) */
-	sec = strstr(sec, match);
-	if (!sec) {
+	sec = mv_json_lookup(&json, MV_JSON_ROOT, match);
+	if (sec < 0) {
 		pr_err("match not found %s\n", match);
-		kfree(lbuff);
-		return -ENXIO;
+		rc = -ENXIO;
+		goto probe_exit1;
 	}
 
 	if (mv_sys_match(match, "giu_pool", 2, match_params)) {
-		kfree(lbuff);
-		return -ENXIO;
+		rc = -ENXIO;
+		goto probe_exit1;
 	}
 
 	/* Retireve giu_id and pool-id */
-	json_buffer_to_input(sec, "giu_id", giu_id);
-	json_buffer_to_input(sec, "id", bpool_id);
-
-	if ((giu_id != match_params[0]) || (bpool_id != match_params[1])) {
+	if (mv_json_obj_get_num(&json, sec, "giu_id", giu_id) ||
+	    mv_json_obj_get_num(&json, sec, "id", bpool_id) ||
+	    (giu_id != match_params[0]) || (bpool_id != match_params[1])) {
 		pr_err("IDs mismatch!\n");
-		kfree(lbuff);
-		return -EFAULT;
+		rc = -EFAULT;
+		goto probe_exit1;
 	}
 	if (bpool_id >= GIU_BPOOL_NUM_POOLS) {
 		pr_err("[%s] Cannot allocate Pool. No free BPool\n", __func__);
-		kfree(lbuff);
-		return -ENODEV;
+		rc = -ENODEV;
+		goto probe_exit1;
 	}
 
 	_bpool = &giu_bpools_guest[bpool_id];
 
 	if (_bpool->internal_param) {
 		pr_err("[%s] BPool id %d is already in use\n", __func__, bpool_id);
-		kfree(lbuff);
-		return -EEXIST;
+		rc = -EEXIST;
+		goto probe_exit1;
 	}
 
 	pr_debug("probing bpool %d for giu id: %d.\n", giu_id, bpool_id);
 
-	_bpool->giu_id = giu_id;
-	_bpool->id = bpool_id;
-
 	bp_int = kcalloc(1, sizeof(struct giu_bpool_int), GFP_KERNEL);
 	if (bp_int == NULL) {
-		kfree(lbuff);
-		return -ENOMEM;
+		rc = -ENOMEM;
+		goto probe_exit1;
 	}
 
-	bp_int->giu_id = _bpool->giu_id;
-	bp_int->id = _bpool->id;
+	bp_int->giu_id = giu_id;
+	bp_int->id = bpool_id;
 
-	memset(dev_name, 0, FILE_MAX_LINE_CHARS);
-	json_buffer_to_input_str(sec, "dma_dev_name", dev_name);
-	if (dev_name[0] == 0) {
+	if (mv_json_obj_get_str(&json, sec, "dma_dev_name", dev_name, sizeof(dev_name))) {
 		pr_err("'dma_dev_name' not found\n");
-		kfree(lbuff);
-		return -EFAULT;
+		rc = -EFAULT;
+		goto probe_exit2;
 	}
 
 	iomem_params.type = SYS_IOMEM_T_SHMEM;
@@ -388,37 +381,49 @@ int giu_bpool_probe(char *match, char *buff, struct giu_bpool **bpool)
 
 	if (sys_iomem_get_info(&iomem_params, &sys_iomem_info)) {
 		pr_err("sys_iomem_get_info error\n");
-		kfree(lbuff);
-		return -EFAULT;
+		rc = -EFAULT;
+		goto probe_exit2;
 	}
 
 	/* Retireve BM params */
-	json_buffer_to_input(sec, "num_buffs", bp_int->num_buffs);
+	if (mv_json_obj_get_num(&json, sec, "num_buffs", bp_int->num_buffs) ||
+	    mv_json_obj_get_num(&json, sec, "buff_len", bp_int->buff_len) ||
+	    mv_json_obj_get_num(&json, sec, "phy_base_offset", phy_base_offs) ||
+	    mv_json_obj_get_num(&json, sec, "prod_offset", prod_offs) ||
+	    mv_json_obj_get_num(&json, sec, "cons_offset", cons_offs)) {
+		pr_err("%s: missing or invalid BM queue params\n", match);
+		rc = -EINVAL;
+		goto probe_exit2;
+	}
 	bp_int->queue.desc_total = bp_int->num_buffs;
-	json_buffer_to_input(sec, "buff_len", bp_int->buff_len);
 	bp_int->queue.buff_len = bp_int->buff_len;
-	json_buffer_to_input(sec, "phy_base_offset", offs);
 	bp_int->queue.desc_ring_base =
-		(struct giu_gpio_desc *)((uintptr_t)sys_iomem_info.u.shmem.va + offs);
-	json_buffer_to_input(sec, "prod_offset", offs);
+		(struct giu_gpio_desc *)((uintptr_t)sys_iomem_info.u.shmem.va + phy_base_offs);
 	bp_int->queue.prod_addr =
-		(u32 *)((uintptr_t)sys_iomem_info.u.shmem.va + offs);
-	json_buffer_to_input(sec, "cons_offset", offs);
+		(u32 *)((uintptr_t)sys_iomem_info.u.shmem.va + prod_offs);
 	bp_int->queue.cons_addr =
-		(u32 *)((uintptr_t)sys_iomem_info.u.shmem.va + offs);
+		(u32 *)((uintptr_t)sys_iomem_info.u.shmem.va + cons_offs);
 	bp_int->queue.last_cons_val = 0;
 
 	pr_debug("q_len %d, buff_len %d, desc_ring_base %p, prod_addr %p, cons_addr %p\n",
 		bp_int->num_buffs, bp_int->buff_len, (unsigned int *)bp_int->queue.desc_ring_base,
 		bp_int->queue.prod_addr, bp_int->queue.cons_addr);
 
-	kfree(lbuff);
+	mv_json_deinit(&json);
+	_bpool->giu_id = giu_id;
+	_bpool->id = bpool_id;
 	_bpool->internal_param = bp_int;
 	*bpool = _bpool;
 
 	pr_debug("giu_bpool_probe pool->id %d\n", _bpool->id);
 
 	return 0;
+
+probe_exit2:
+	kfree(bp_int);
+probe_exit1:
+	mv_json_deinit(&json);
+	return rc;
 }
 
 /**
@@ -429,6 +434,7 @@ void giu_bpool_remove(struct giu_bpool *bpool)
 	struct giu_bpool_int	*bp_int = (struct giu_bpool_int *)bpool->internal_param;
 
 	kfree(bp_int);
+	bpool->internal_param = NULL;
 }
 
 /**
@@ -103,6 +103,7 @@
 #include "mng/mv_nmp_guest_giu.h"
 #endif
 #include "lib/lib_misc.h"
+#include "lib/mv_json.h"
 #include "lib/net.h"
 
 #include "giu_internal.h"
@@ -1352,6 +1353,7 @@ int giu_gpio_serialize(struct giu_gpio *gpio, char *buff, u32 size, u8 depth)
 		/* Serialize IN Qs info */
 		json_print_to_buffer(buff, size, depth + 2, "\"num_inqs\": %u,\n", intc->num_interim_qs);
 		for (q_idx = 0; q_idx < intc->num_interim_qs; q_idx++) {
+			json_print_to_buffer(buff, size, depth + 2, "\"inq-%u\": {\n", q_idx);
 			mqa_queue_get_info(intc->interim_qs[q_idx].mqa_q, &queue_info);	/* interim */
 
 			json_print_to_buffer(buff, size, depth + 3, "\"qid\": %u,\n", queue_info.q_id);
@@ -1401,6 +1403,113 @@ int giu_gpio_serialize(struct giu_gpio *gpio, char *buff, u32 size, u8 depth)
 	return pos;
 }
 
+/* Read the parameters of a queue section ("inq-x"/"outq-x") of a serialized gpio */
+static int giu_gpio_probe_queue(struct mv_json *json, int sec, uintptr_t va, struct giu_gpio_lcl_q *q)
+{
+	u32 phy_base_offs, prod_offs, cons_offs;
+
+	if (mv_json_obj_get_num(json, sec, "qid", q->q_id) ||
+	    mv_json_obj_get_num(json, sec, "qlen", q->queue.desc_total) ||
+	    mv_json_obj_get_num(json, sec, "phy_base_offset", phy_base_offs) ||
+	    mv_json_obj_get_num(json, sec, "prod_offset", prod_offs) ||
+	    mv_json_obj_get_num(json, sec, "cons_offset", cons_offs))
+		return -EINVAL;
+
+	q->queue.desc_ring_base = (struct giu_gpio_desc *)(va + phy_base_offs);
+	q->queue.prod_addr = (u32 *)(va + prod_offs);
+	q->queue.cons_addr = (u32 *)(va + cons_offs);
+	q->queue.last_cons_val = 0;
+	return 0;
+}
+
+/* Read the TCs of a gpio serialized by older NMP versions, in write order.
+ * These had the parameters of each in-queue directly in "intc-x", followed by
+ * an unbalanced "}", so they cannot be read as a tree. 'text' starts at the
+ * "intc-0" section.
+ */
+static int giu_gpio_probe_legacy_tcs(struct giu_gpio *gpio, const char *text, uintptr_t va)
+{
+	struct giu_gpio_outtc	*outtc;
+	struct giu_gpio_intc	*intc;
+	struct giu_gpio_lcl_q	*q;
+	char			*lbuff, *sec;
+	u32			 offs = 0;
+	u32			 tc_idx, q_idx, bp_idx;
+	int			 ret = -EINVAL;
+
+	lbuff = kcalloc(1, strlen(text) + 1, GFP_KERNEL);
+	if (lbuff == NULL)
+		return -ENOMEM;
+
+	strcpy(lbuff, text);
+	sec = lbuff;
+
+	for (tc_idx = 0; tc_idx < gpio->num_intcs; tc_idx++) {
+		intc = &(gpio->intcs[tc_idx]);
+
+		json_buffer_to_input(sec, "pkt-offs", intc->pkt_offset);
+		json_buffer_to_input(sec, "rss-type", intc->rss_type);
+		json_buffer_to_input(sec, "num_inqs", intc->num_inqs);
+		if (intc->num_inqs > GIU_GPIO_TC_MAX_NUM_QS)
+			goto legacy_exit;
+		for (q_idx = 0; q_idx < intc->num_inqs; q_idx++) {
+			q = &intc->inqs[q_idx];
+			json_buffer_to_input(sec, "qid", q->q_id);
+			q->queue.payload_offset = intc->pkt_offset;
+			json_buffer_to_input(sec, "qlen", q->queue.desc_total);
+			json_buffer_to_input(sec, "phy_base_offset", offs);
+			q->queue.desc_ring_base = (struct giu_gpio_desc *)(va + offs);
+			json_buffer_to_input(sec, "prod_offset", offs);
+			q->queue.prod_addr = (u32 *)(va + offs);
+			json_buffer_to_input(sec, "cons_offset", offs);
+			q->queue.cons_addr = (u32 *)(va + offs);
+			q->queue.last_cons_val = 0;
+		}
+
+		json_buffer_to_input(sec, "num_inpools", intc->num_inpools);
+		if (intc->num_inpools > GIU_GPIO_TC_MAX_NUM_BPOOLS)
+			goto legacy_exit;
+		for (bp_idx = 0; bp_idx < intc->num_inpools; bp_idx++) {
+			u8 bp_id = GIU_BPOOL_NUM_POOLS;
+
+			json_buffer_to_input(sec, "bpid", bp_id);
+			if (bp_id >= GIU_BPOOL_NUM_POOLS)
+				goto legacy_exit;
+			intc->pools[bp_idx] = &giu_bpools_guest[bp_id];
+		}
+	}
+
+	json_buffer_to_input(sec, "num_outtcs", gpio->num_outtcs);
+	if (gpio->num_outtcs > GIU_GPIO_MAX_NUM_TCS)
+		goto legacy_exit;
+	for (tc_idx = 0; tc_idx < gpio->num_outtcs; tc_idx++) {
+		outtc = &(gpio->outtcs[tc_idx]);
+
+		json_buffer_to_input(sec, "num_outqs", outtc->num_outqs);
+		if (outtc->num_outqs > GIU_GPIO_TC_MAX_NUM_QS)
+			goto legacy_exit;
+		for (q_idx = 0; q_idx < outtc->num_outqs; q_idx++) {
+			q = &outtc->outqs[q_idx];
+			json_buffer_to_input(sec, "qid", q->q_id);
+			json_buffer_to_input(sec, "qlen", q->queue.desc_total);
+			json_buffer_to_input(sec, "phy_base_offset", offs);
+			q->queue.desc_ring_base = (struct giu_gpio_desc *)(va + offs);
+			json_buffer_to_input(sec, "prod_offset", offs);
+			q->queue.prod_addr = (u32 *)(va + offs);
+			json_buffer_to_input(sec, "cons_offset", offs);
+			q->queue.cons_addr = (u32 *)(va + offs);
+			q->queue.last_cons_val = 0;
+		}
+	}
+	ret = 0;
+
+legacy_exit:
+	if (ret)
+		pr_err("gpio-%d:%d: invalid TC parameters\n", gpio->giu_id, gpio->id);
+	kfree(lbuff);
+	return ret;
+}
+
 int giu_gpio_probe(char *match, char *buff, struct giu_gpio **gpio)
 {
 	struct giu_gpio			*_gpio;
@@ -1408,70 +1517,69 @@ int giu_gpio_probe(char *match, char *buff, struct giu_gpio **gpio)
 	struct giu_gpio_intc		*intc;
 	struct sys_iomem_params		 iomem_params;
 	struct sys_iomem_info		 sys_iomem_info;
-	char				*lbuff, *sec = NULL;
+	struct mv_json			 json;
+	int				 sec, tc_sec, q_sec, bp_tok, rc;
 	char				 dev_name[FILE_MAX_LINE_CHARS];
+	char				 tmp_buf[FILE_MAX_LINE_CHARS];
 	u8				 match_params[2];
-	u32				 offs = 0;
 	u32				 tc_idx, q_idx, bp_idx;
 	u8				 giu_id = 0, gpio_id = 0;
+	u64				 bp_id;
+	uintptr_t			 va;
 
 	if (!match) {
 		pr_err("no match string found!\n");
 		return -EFAULT;
 	}
 
-	lbuff = kcalloc(1, strlen(buff), GFP_KERNEL);
-	if (lbuff == NULL)
-		return -ENOMEM;
+	if (mv_sys_match(match, "gpio", 2, match_params))
+		return(-ENXIO);
 
-	memcpy(lbuff, buff, strlen(buff));
-	sec = lbuff;
+	rc = mv_json_init(&json, buff);
+	if (rc)
+		return rc;
 
 	/* Search for match (gpio-x:x) */
-	sec = strstr(sec, match);
-	if (!sec) {
+	sec = mv_json_lookup(&json, MV_JSON_ROOT, match);
+	if (sec < 0) {
 		pr_err("match not found %s\n", match);
-		kfree(lbuff);
-		return -ENXIO;
+		rc = -ENXIO;
+		goto probe_exit1;
 	}
 
-	if (mv_sys_match(match, "gpio", 2, match_params))
-		return(-ENXIO);
-
 	/* Retireve giu_id and pool-id */
-	json_buffer_to_input(sec, "giu_id", giu_id);
-	json_buffer_to_input(sec, "id", gpio_id);
-
-	if ((giu_id != match_params[0]) || (gpio_id != match_params[1])) {
+	if (mv_json_obj_get_num(&json, sec, "giu_id", giu_id) ||
+	    mv_json_obj_get_num(&json, sec, "id", gpio_id) ||
+	    (giu_id != match_params[0]) || (gpio_id != match_params[1])) {
 		pr_err("IDs mismatch!\n");
-		kfree(lbuff);
-		return -EFAULT;
+		rc = -EFAULT;
+		goto probe_exit1;
 	}
 	if (gpio_id >= GIU_MAX_NUM_GPIO) {
 		pr_err("giu_id (%d) exceeds max gpio number (%d)\n", giu_id, GIU_MAX_NUM_GPIO);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto probe_exit1;
 	}
 
 	pr_debug("probing: gpio %d for giu id: %d.\n", gpio_id, giu_id);
 
 	_gpio = kcalloc(1, sizeof(struct giu_gpio), GFP_KERNEL);
-	if (_gpio == NULL)
-		return -ENOMEM;
+	if (_gpio == NULL) {
+		rc = -ENOMEM;
+		goto probe_exit1;
+	}
 
 	_gpio->giu_id = giu_id;
 	_gpio->id = gpio_id;
 	_gpio->is_guest = 1;
 	_gpio->is_enable = 0;
 	strcpy(_gpio->match, match);
-	json_buffer_to_input(sec, "sg_en", _gpio->sg_en);
+	mv_json_obj_get_num(&json, sec, "sg_en", _gpio->sg_en);
 
-	memset(dev_name, 0, FILE_MAX_LINE_CHARS);
-	json_buffer_to_input_str(sec, "dma_dev_name", dev_name);
-	if (dev_name[0] == 0) {
+	if (mv_json_obj_get_str(&json, sec, "dma_dev_name", dev_name, sizeof(dev_name))) {
 		pr_err("'dma_dev_name' not found\n");
-		kfree(_gpio);
-		kfree(lbuff);
-		return -EFAULT;
+		rc = -EFAULT;
+		goto probe_exit2;
 	}
 
 	iomem_params.type = SYS_IOMEM_T_SHMEM;
@@ -1480,71 +1588,116 @@ int giu_gpio_probe(char *match, char *buff, struct giu_gpio **gpio)
 
 	if (sys_iomem_get_info(&iomem_params, &sys_iomem_info)) {
 		pr_err("sys_iomem_get_info error\n");
-		kfree(_gpio);
-		kfree(lbuff);
-		return -EFAULT;
+		rc = -EFAULT;
+		goto probe_exit2;
+	}
+	va = (uintptr_t)sys_iomem_info.u.shmem.va;
+
+	rc = -EINVAL;
+	if (mv_json_obj_get_num(&json, sec, "num_intcs", _gpio->num_intcs) ||
+	    _gpio->num_intcs > GIU_GPIO_MAX_NUM_TCS) {
+		pr_err("%s: invalid num_intcs\n", match);
+		goto probe_exit2;
+	}
+
+	/* An "intc-0" holding a "qid" (rather than "inq-x" sections) was written by an older NMP */
+	tc_sec = mv_json_find(&json, sec, "intc-0");
+	if (tc_sec >= 0 && mv_json_find(&json, tc_sec, "qid") >= 0) {
+		rc = giu_gpio_probe_legacy_tcs(_gpio, buff + json.toks[tc_sec].start, va);
+		if (rc)
+			goto probe_exit2;
+		goto probe_done;
 	}
 
-	json_buffer_to_input(sec, "num_intcs", _gpio->num_intcs);
 	for (tc_idx = 0; tc_idx < _gpio->num_intcs; tc_idx++) {
 		intc = &(_gpio->intcs[tc_idx]);
 
-		json_buffer_to_input(sec, "pkt-offs", intc->pkt_offset);
-		json_buffer_to_input(sec, "rss-type", intc->rss_type);
-		json_buffer_to_input(sec, "num_inqs", intc->num_inqs);
+		snprintf(tmp_buf, sizeof(tmp_buf), "intc-%u", tc_idx);
+		tc_sec = mv_json_find(&json, sec, tmp_buf);
+		if (tc_sec < 0) {
+			pr_err("%s: '%s' not found\n", match, tmp_buf);
+			goto probe_exit2;
+		}
+
+		mv_json_obj_get_num(&json, tc_sec, "pkt-offs", intc->pkt_offset);
+		mv_json_obj_get_num(&json, tc_sec, "rss-type", intc->rss_type);
+		if (mv_json_obj_get_num(&json, tc_sec, "num_inqs", intc->num_inqs) ||
+		    intc->num_inqs > GIU_GPIO_TC_MAX_NUM_QS) {
+			pr_err("%s: %s: invalid num_inqs\n", match, tmp_buf);
+			goto probe_exit2;
+		}
 		for (q_idx = 0; q_idx < intc->num_inqs; q_idx++) {
-			json_buffer_to_input(sec, "qid", intc->inqs[q_idx].q_id);
+			snprintf(tmp_buf, sizeof(tmp_buf), "inq-%u", q_idx);
+			q_sec = mv_json_find(&json, tc_sec, tmp_buf);
+			if (q_sec < 0 || giu_gpio_probe_queue(&json, q_sec, va, &intc->inqs[q_idx])) {
+				pr_err("%s: intc-%u: '%s' missing or invalid\n", match, tc_idx, tmp_buf);
+				goto probe_exit2;
+			}
 			intc->inqs[q_idx].queue.payload_offset = intc->pkt_offset;
-			json_buffer_to_input(sec, "qlen", intc->inqs[q_idx].queue.desc_total);
-			json_buffer_to_input(sec, "phy_base_offset", offs);
-			intc->inqs[q_idx].queue.desc_ring_base =
-				(struct giu_gpio_desc *)((uintptr_t)sys_iomem_info.u.shmem.va + offs);
-			json_buffer_to_input(sec, "prod_offset", offs);
-			intc->inqs[q_idx].queue.prod_addr =
-				(u32 *)((uintptr_t)sys_iomem_info.u.shmem.va + offs);
-			json_buffer_to_input(sec, "cons_offset", offs);
-			intc->inqs[q_idx].queue.cons_addr =
-				(u32 *)((uintptr_t)sys_iomem_info.u.shmem.va + offs);
-			intc->inqs[q_idx].queue.last_cons_val = 0;
 		}
 
-		json_buffer_to_input(sec, "num_inpools", intc->num_inpools);
+		if (mv_json_obj_get_num(&json, tc_sec, "num_inpools", intc->num_inpools) ||
+		    intc->num_inpools > GIU_GPIO_TC_MAX_NUM_BPOOLS) {
+			pr_err("%s: intc-%u: invalid num_inpools\n", match, tc_idx);
+			goto probe_exit2;
+		}
+		bp_tok = -1;
 		for (bp_idx = 0; bp_idx < intc->num_inpools; bp_idx++) {
-			u8 bp_id = 0;
-
-			json_buffer_to_input(sec, "bpid", bp_id);
+			/* "bpid" is repeated, once per pool */
+			bp_tok = mv_json_find_next(&json, tc_sec, "bpid", bp_tok);
+			if (bp_tok < 0 || mv_json_get_u64(&json, bp_tok, &bp_id) ||
+			    bp_id >= GIU_BPOOL_NUM_POOLS) {
+				pr_err("%s: intc-%u: bpid %u missing or invalid\n", match, tc_idx, bp_idx);
+				goto probe_exit2;
+			}
 			intc->pools[bp_idx] = &giu_bpools_guest[bp_id];
 		}
 	}
 
-	json_buffer_to_input(sec, "num_outtcs", _gpio->num_outtcs);
+	if (mv_json_obj_get_num(&json, sec, "num_outtcs", _gpio->num_outtcs) ||
+	    _gpio->num_outtcs > GIU_GPIO_MAX_NUM_TCS) {
+		pr_err("%s: invalid num_outtcs\n", match);
+		goto probe_exit2;
+	}
 	for (tc_idx = 0; tc_idx < _gpio->num_outtcs; tc_idx++) {
 		outtc = &(_gpio->outtcs[tc_idx]);
 
-		json_buffer_to_input(sec, "num_outqs", outtc->num_outqs);
+		snprintf(tmp_buf, sizeof(tmp_buf), "outtc-%u", tc_idx);
+		tc_sec = mv_json_find(&json, sec, tmp_buf);
+		if (tc_sec < 0) {
+			pr_err("%s: '%s' not found\n", match, tmp_buf);
+			goto probe_exit2;
+		}
+
+		if (mv_json_obj_get_num(&json, tc_sec, "num_outqs", outtc->num_outqs) ||
+		    outtc->num_outqs > GIU_GPIO_TC_MAX_NUM_QS) {
+			pr_err("%s: %s: invalid num_outqs\n", match, tmp_buf);
+			goto probe_exit2;
+		}
 		for (q_idx = 0; q_idx < outtc->num_outqs; q_idx++) {
-			json_buffer_to_input(sec, "qid", outtc->outqs[q_idx].q_id);
-			json_buffer_to_input(sec, "qlen", outtc->outqs[q_idx].queue.desc_total);
-			json_buffer_to_input(sec, "phy_base_offset", offs);
-			outtc->outqs[q_idx].queue.desc_ring_base =
-				(struct giu_gpio_desc *)((uintptr_t)sys_iomem_info.u.shmem.va + offs);
-			json_buffer_to_input(sec, "prod_offset", offs);
-			outtc->outqs[q_idx].queue.prod_addr =
-				(u32 *)((uintptr_t)sys_iomem_info.u.shmem.va + offs);
-			json_buffer_to_input(sec, "cons_offset", offs);
-			outtc->outqs[q_idx].queue.cons_addr =
-				(u32 *)((uintptr_t)sys_iomem_info.u.shmem.va + offs);
-			outtc->outqs[q_idx].queue.last_cons_val = 0;
+			snprintf(tmp_buf, sizeof(tmp_buf), "outq-%u", q_idx);
+			q_sec = mv_json_find(&json, tc_sec, tmp_buf);
+			if (q_sec < 0 || giu_gpio_probe_queue(&json, q_sec, va, &outtc->outqs[q_idx])) {
+				pr_err("%s: outtc-%u: '%s' missing or invalid\n", match, tc_idx, tmp_buf);
+				goto probe_exit2;
+			}
 		}
 	}
 
-	kfree(lbuff);
+probe_done:
+	mv_json_deinit(&json);
 	*gpio = _gpio;
 
 	giu_gpio_disable(_gpio);
 	giu_gpio_reset(_gpio);
 
 	return 0;
+
+probe_exit2:
+	kfree(_gpio);
+probe_exit1:
+	mv_json_deinit(&json);
+	return rc;
 }
 
 void giu_gpio_remove(struct giu_gpio *gpio)
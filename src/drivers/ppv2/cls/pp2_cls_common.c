@@ -488,8 +488,7 @@ int pp2_cls_field_bm_to_field_info(u32 field_bm, struct pp2_cls_mng_pkt_key_t *p
 		field_info[i].valid = MVPP2_FIELD_VALID;
 		field_info[i].field_id = L4_SRC_FIELD_ID;
 		field_info[i].filed_value.int_data.parsed_int_val = pp2_cls_pkt_key->pkt_key->l4_src;
-		field_size = pp2_cls_field_size_array[field_info[i].field_id];
-		field_info[i].filed_value.int_data.parsed_int_val_mask = common_mask_gen(field_size);
+		field_info[i].filed_value.int_data.parsed_int_val_mask = pp2_cls_pkt_key->pkt_key->l4_src_mask;
 		pr_debug("field_info[%d] %s val %d mask 0x%x\n", i,
 			 pp2_cls_utils_field_id_str_get(field_info[i].field_id),
 			 field_info[i].filed_value.int_data.parsed_int_val,
@@ -500,8 +499,7 @@ int pp2_cls_field_bm_to_field_info(u32 field_bm, struct pp2_cls_mng_pkt_key_t *p
 		field_info[i].valid = MVPP2_FIELD_VALID;
 		field_info[i].field_id = L4_DST_FIELD_ID;
 		field_info[i].filed_value.int_data.parsed_int_val = pp2_cls_pkt_key->pkt_key->l4_dst;
-		field_size = pp2_cls_field_size_array[field_info[i].field_id];
-		field_info[i].filed_value.int_data.parsed_int_val_mask = common_mask_gen(field_size);
+		field_info[i].filed_value.int_data.parsed_int_val_mask = pp2_cls_pkt_key->pkt_key->l4_dst_mask;
 		pr_debug("field_info[%d] %s val %d mask 0x%x\n", i,
 			 pp2_cls_utils_field_id_str_get(field_info[i].field_id),
 			 field_info[i].filed_value.int_data.parsed_int_val,
@@ -1178,14 +1178,14 @@ int pp2_cls_mng_qos_tbl_init(struct pp2_cls_qos_tbl_params *qos_params,
 	return rc;
 }
 
-static int pp2_cls_mng_qos_tbl_dflt_set(struct pp2_port *port, u16 queue)
+/* Maps all priorities to TC 0, whose first queue is the port first RXQ */
+static int pp2_cls_mng_qos_tbl_dflt_set(struct pp2_port *port)
 {
 	int rc = 0;
-	u32 i;
 	u8 tc_array[MVPP2_QOS_TBL_LINE_NUM_DSCP];
 
-	for (i = 0; i < MV_DSCP_NUM; i++)
-		tc_array[i] = queue;
+	/* The table holds TCs, not queues */
+	memset(tc_array, 0, sizeof(tc_array));
 
 	rc = mv_pp2x_cls_c2_qos_tbl_fill_array(port,
 					  MVPP2_QOS_TBL_SEL_DSCP,
@@ -1216,7 +1216,7 @@ int pp2_cls_mng_qos_tbl_deinit(struct pp2_cls_tbl *tbl)
 	pp2_cls_dscp_flows_set(port, PP2_CLS_QOS_TBL_NONE);
 
 	/*return qos tables to default queues */
-	rc = pp2_cls_mng_qos_tbl_dflt_set(port, port->first_rxq);
+	rc = pp2_cls_mng_qos_tbl_dflt_set(port);
 	if (rc) {
 		pr_err("setting defaults for qos tables failed\n");
 		return -EFAULT;
@@ -1230,6 +1230,32 @@ int pp2_cls_mng_qos_tbl_deinit(struct pp2_cls_tbl *tbl)
 	return 0;
 }
 
+/*
+ * Parse the mask of an L4 port field. A missing mask matches the whole port;
+ * masks wider than the port (e.g. "0xFFFFFFFFFFFFFFFF") are truncated.
+ */
+static int pp2_cls_parse_l4_port_mask(struct pp2_cls_tbl_params *params, u8 *str, u16 *mask)
+{
+	u64 val;
+	int rc;
+
+	*mask = (1 << L4_SRC_FIELD_SIZE) - 1;
+	if (!str || !str[0])
+		return 0;
+
+	rc = kstrtou64((char *)str, 0, &val);
+	if (rc) {
+		pr_err("%s(%d)) Failed to parse L4 port mask.\n", __func__, __LINE__);
+		return rc;
+	}
+	if (params->type == PP2_CLS_TBL_EXACT_MATCH && (val & *mask) != *mask) {
+		pr_err("%s(%d)) L4 port masks are not supported by exact match tables\n", __func__, __LINE__);
+		return -EINVAL;
+	}
+	*mask &= val;
+	return 0;
+}
+
 static int pp2_cls_set_rule_info(struct pp2_cls_mng_pkt_key_t *mng_pkt_key,
 				 struct mv_pp2x_src_port *rule_port,
 				 struct pp2_cls_tbl_params *params,
@@ -1603,8 +1629,13 @@ static int pp2_cls_set_rule_info(struct pp2_cls_mng_pkt_key_t *mng_pkt_key,
 			}
 
 			mng_pkt_key->pkt_key->l4_src = src;
+			rc = pp2_cls_parse_l4_port_mask(params, rule->fields[idx1].mask,
+							&mng_pkt_key->pkt_key->l4_src_mask);
+			if (rc)
+				return rc;
 
-			pr_debug("L4_SRC_FIELD_ID = %d\n", mng_pkt_key->pkt_key->l4_src);
+			pr_debug("L4_SRC_FIELD_ID = %d mask 0x%x\n", mng_pkt_key->pkt_key->l4_src,
+				 mng_pkt_key->pkt_key->l4_src_mask);
 			break;
 		case L4_DST_FIELD_ID:
 			if (rule->fields[idx1].size != (GET_NUM_BYTES(L4_DST_FIELD_SIZE))) {
@@ -1625,8 +1656,13 @@ static int pp2_cls_set_rule_info(struct pp2_cls_mng_pkt_key_t *mng_pkt_key,
 			}
 
 			mng_pkt_key->pkt_key->l4_dst = dst;
+			rc = pp2_cls_parse_l4_port_mask(params, rule->fields[idx1].mask,
+							&mng_pkt_key->pkt_key->l4_dst_mask);
+			if (rc)
+				return rc;
 
-			pr_debug("L4_DST_FIELD_ID = %d\n", mng_pkt_key->pkt_key->l4_dst);
+			pr_debug("L4_DST_FIELD_ID = %d mask 0x%x\n", mng_pkt_key->pkt_key->l4_dst,
+				 mng_pkt_key->pkt_key->l4_dst_mask);
 			break;
 		case CLS_UDF3_FIELD_ID:
 			if ((rule->fields[idx1].size > CLS_UDF_FIELD_SIZE) || (rule->fields[idx1].size == 0)) {
@@ -2185,23 +2221,72 @@ void pp2_cls_mng_config_default_cos_queue(struct pp2_port *port)
 {
 	if (port->type == PP2_PPIO_T_NIC) {
 		pp2_c2_config_default_queue(port, port->first_rxq);
-		pp2_cls_mng_qos_tbl_dflt_set(port, port->first_rxq);
+		/* No TCs (e.g. the TX only loopback port): nothing to map to */
+		if (port->num_tcs)
+			pp2_cls_mng_qos_tbl_dflt_set(port);
 	}
 }
 
-void pp2_cls_mng_init(struct pp2_inst *inst)
+static void pp2_cls_mng_db_free(struct pp2_inst *inst)
 {
+	kfree(inst->cls_db->prs_db.prs_shadow);
+	pp2_cls_db_exit(inst);
+	inst->cls_db = NULL;
+}
+
+int pp2_cls_mng_init(struct pp2_inst *inst)
+{
+	int rc;
+
 	if (inst->cls_db)
-		return;			/*Already initialized*/
-
-	pp2_cls_db_init(inst);
-	pp2_cls_prs_init(inst);
-	pp2_cls_init(inst);
-	pp2_cls_c2_start(inst);
-	pp2_cls_c3_start(inst);
-	pp2_cls_rss_init(inst);
-	pp2_cls_plcr_start(inst);
-	pp2_cls_edrop_start(inst);
+		return 0;		/*Already initialized*/
+
+	rc = pp2_cls_db_init(inst);
+	if (rc)
+		return rc;
+
+	rc = pp2_cls_prs_init(inst);
+	if (rc) {
+		pr_err("parser init failed\n");
+		goto cls_mng_init_err;
+	}
+	rc = pp2_cls_init(inst);
+	if (rc) {
+		pr_err("classifier init failed\n");
+		goto cls_mng_init_err;
+	}
+	rc = pp2_cls_c2_start(inst);
+	if (rc) {
+		pr_err("C2 start failed\n");
+		goto cls_mng_init_err;
+	}
+	rc = pp2_cls_c3_start(inst);
+	if (rc) {
+		pr_err("C3 start failed\n");
+		goto cls_mng_init_err;
+	}
+	rc = pp2_cls_rss_init(inst);
+	if (rc) {
+		pr_err("RSS init failed\n");
+		goto cls_mng_init_err;
+	}
+	rc = pp2_cls_plcr_start(inst);
+	if (rc) {
+		pr_err("policer start failed\n");
+		goto cls_mng_init_err;
+	}
+	rc = pp2_cls_edrop_start(inst);
+	if (rc) {
+		pr_err("early-drop start failed\n");
+		pp2_cls_plcr_finish(inst);
+		goto cls_mng_init_err;
+	}
+
+	return 0;
+
+cls_mng_init_err:
+	pp2_cls_mng_db_free(inst);
+	return rc;
 }
 
 void pp2_cls_mng_deinit(struct pp2_inst *inst)
@@ -2209,5 +2294,6 @@ void pp2_cls_mng_deinit(struct pp2_inst *inst)
 	pp2_cls_prs_deinit(inst);
 	pp2_cls_plcr_finish(inst);
 	pp2_cls_edrop_finish(inst);
+	pp2_cls_mng_db_free(inst);
 }
 
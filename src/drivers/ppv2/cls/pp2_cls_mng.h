@@ -119,7 +119,7 @@
 /******************************************************************************/
 /*                                PROTOTYPE                                   */
 /******************************************************************************/
-void pp2_cls_mng_init(struct pp2_inst *inst);
+int pp2_cls_mng_init(struct pp2_inst *inst);
 void pp2_cls_mng_deinit(struct pp2_inst *inst);
 int pp2_cls_mng_tbl_init(struct pp2_cls_tbl_params *params, struct pp2_cls_tbl **tbl, int lkp_type);
 int pp2_cls_mng_table_deinit(struct pp2_cls_tbl *tbl);
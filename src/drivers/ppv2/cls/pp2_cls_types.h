@@ -439,7 +439,9 @@ struct pp2_cls_pkt_key_t {
 	struct pp2_cls_ipvx_key_t	ipvx_add;	/*IPV4/IPV6 packet key */
 	struct pp2_cls_ipvx_add_key_t	arp_ip_dst;	/* ARP IPV4 dest address */
 	u16				l4_src;		/*UDP/TCP source port */
+	u16				l4_src_mask;	/*UDP/TCP source port mask */
 	u16				l4_dst;		/*UDP/TCP dest port */
+	u16				l4_dst_mask;	/*UDP/TCP dest port mask */
 	struct pp2_cls_udf_key_t	udf3;		/*UDF3 */
 	struct pp2_cls_udf_key_t	udf5;		/*UDF5 */
 	struct pp2_cls_udf_key_t	udf6;		/*UDF6 */
@@ -129,6 +129,8 @@ struct pp2_cls_plcr_token_type_t g_pp2_byte_token_type[] = {
 	{MVPP2_PLCR_TOKEN_RATE_TYPE_10MBPS_4KB,	   10000,	0,	1270000,	4096,	0,	262144},
 };
 
+/* token update period of each token type, in units of the base period */
+static const u64 g_pp2_plcr_update_factor[] = {10000, 1000, 100, 10, 1};
 
 /******************************************************************************
  * Function Definition
@@ -140,7 +142,7 @@ static int pp2_cls_plcr_calc_token_type(const struct pp2_cls_plcr_params *police
 {
 	struct pp2_cls_plcr_token_type_t *token_arr;
 	struct pp2_cls_plcr_token_type_t *token_entry;
-	u64 cir, token_update_period[] = {10000, 1000, 100, 10, 1};
+	u64 cir;
 
 	if (policer_entry->cir == MVPP2_PLCR_CIR_NO_LIMIT) {
 		*token_type = MVPP2_PLCR_TOKEN_RATE_TYPE_10MBPS_4KB;
@@ -179,7 +181,7 @@ static int pp2_cls_plcr_calc_token_type(const struct pp2_cls_plcr_params *police
 		token_entry = &token_arr[*token_type];
 		if (cir % token_entry->rate_resl)
 			cir = roundup(cir, token_entry->rate_resl);
-		*token_value = cir * MVPP2_TOKEN_PERIOD_800_CORE_CLOCK * token_update_period[*token_type];
+		*token_value = cir * MVPP2_TOKEN_PERIOD_800_CORE_CLOCK * g_pp2_plcr_update_factor[*token_type];
 		*token_value /= 1000000;
 		if (policer_entry->token_unit == PP2_CLS_PLCR_PACKETS_TOKEN_UNIT)
 			*token_value /= 1000;
@@ -194,6 +196,28 @@ static int pp2_cls_plcr_calc_token_type(const struct pp2_cls_plcr_params *police
 	return 0;
 }
 
+/* Rate enforced by the HW, in bytes/sec or pps */
+static u64 pp2_cls_plcr_token_rate(enum pp2_cls_plcr_token_update_type_t token_type, u64 token_value)
+{
+	return token_value * 1000000000ULL /
+	       (MVPP2_TOKEN_PERIOD_800_CORE_CLOCK * g_pp2_plcr_update_factor[token_type]);
+}
+
+/* Deviation of the enforced rate from the requested CIR, in ppm */
+static s32 pp2_cls_plcr_rate_err_ppm(const struct pp2_cls_plcr_params *policer_entry, u64 rate)
+{
+	s64 req;
+
+	if (policer_entry->cir == MVPP2_PLCR_CIR_NO_LIMIT)
+		return 0;
+
+	req = policer_entry->cir;
+	if (policer_entry->token_unit == PP2_CLS_PLCR_BYTES_TOKEN_UNIT)
+		req = req * 1000 / 8;
+
+	return (s32)(((s64)rate - req) * 1000000 / req);
+}
+
 /*******************************************************************************
 * pp2_cls_plcr_hw_entry_add()
 *
@@ -320,6 +344,7 @@ static int pp2_cls_plcr_hw_entry_del(struct pp2_inst *inst, u8 policer_id)
 *
 * INPUTS:
 *	input_entry  - inputted policer entry configuration.
+*	verbose      - warn about the adjusted values.
 *
 * OUTPUTS:
 *	output_entry - inputted policer entry configuration.
@@ -330,7 +355,8 @@ static int pp2_cls_plcr_hw_entry_del(struct pp2_inst *inst, u8 policer_id)
 *******************************************************************************/
 static int pp2_cls_plcr_entry_convert(const struct pp2_cls_plcr_params		*input_entry,
 				      struct pp2_cls_plcr_params		*output_entry,
-				      enum pp2_cls_plcr_token_update_type_t	token_type)
+				      enum pp2_cls_plcr_token_update_type_t	token_type,
+				      int					verbose)
 {
 	struct pp2_cls_plcr_token_type_t *token_arr;
 	struct pp2_cls_plcr_token_type_t *token_entry;
@@ -359,10 +385,11 @@ static int pp2_cls_plcr_entry_convert(const struct pp2_cls_plcr_params		*input_e
 	if (output_entry->cir == MVPP2_PLCR_CIR_NO_LIMIT)
 		output_entry->cir = token_entry->max_rate;
 	if (output_entry->cir % token_entry->rate_resl) {
-		pr_warn("CIR(%u) is not multiple times of resolution(%u), will be adjusted to (%u)\n",
-			    output_entry->cir,
-			    token_entry->rate_resl,
-			    roundup(output_entry->cir, token_entry->rate_resl));
+		if (verbose)
+			pr_warn("CIR(%u) is not multiple times of resolution(%u), will be adjusted to (%u)\n",
+				output_entry->cir,
+				token_entry->rate_resl,
+				roundup(output_entry->cir, token_entry->rate_resl));
 		output_entry->cir = roundup(output_entry->cir, token_entry->rate_resl);
 	}
 
@@ -370,10 +397,11 @@ static int pp2_cls_plcr_entry_convert(const struct pp2_cls_plcr_params		*input_e
 	if (output_entry->cbs == MVPP2_PLCR_BURST_SIZE_NO_LIMIT)
 		output_entry->cbs = token_entry->max_burst_size;
 	if (output_entry->cbs % token_entry->burst_size_resl) {
-		pr_warn("CBS(%u) is not multiple times of resolution(%u), will be adjusted to (%u)\n",
-			    output_entry->cbs,
-			    token_entry->burst_size_resl,
-			    roundup(output_entry->cbs, token_entry->burst_size_resl));
+		if (verbose)
+			pr_warn("CBS(%u) is not multiple times of resolution(%u), will be adjusted to (%u)\n",
+				output_entry->cbs,
+				token_entry->burst_size_resl,
+				roundup(output_entry->cbs, token_entry->burst_size_resl));
 		output_entry->cbs = roundup(output_entry->cbs, token_entry->burst_size_resl);
 	}
 
@@ -381,10 +409,11 @@ static int pp2_cls_plcr_entry_convert(const struct pp2_cls_plcr_params		*input_e
 	if (output_entry->ebs == MVPP2_PLCR_BURST_SIZE_NO_LIMIT)
 		output_entry->ebs = token_entry->max_burst_size;
 	if (output_entry->ebs % token_entry->burst_size_resl) {
-		pr_warn("EBS(%u) is not multiple times of resolution(%u), will be adjusted to (%u)\n",
-			    output_entry->ebs,
-			    token_entry->burst_size_resl,
-			    roundup(output_entry->ebs, token_entry->burst_size_resl));
+		if (verbose)
+			pr_warn("EBS(%u) is not multiple times of resolution(%u), will be adjusted to (%u)\n",
+				output_entry->ebs,
+				token_entry->burst_size_resl,
+				roundup(output_entry->ebs, token_entry->burst_size_resl));
 		output_entry->ebs = roundup(output_entry->ebs, token_entry->burst_size_resl);
 	}
 
@@ -520,6 +549,7 @@ int pp2_cls_plcr_entry_add(struct pp2_inst			*inst,
 {
 	struct pp2_cls_db_plcr_entry_t l_plcr_entry;
 	enum pp2_cls_plcr_token_update_type_t token_type;
+	struct pp2_cls_plcr_hw_info hw_info;
 	u64 token_value;
 	int rc = 0;
 
@@ -533,9 +563,16 @@ int pp2_cls_plcr_entry_add(struct pp2_inst			*inst,
 		return rc;
 	}
 
+	/* warn when the HW enforces a rate far from the requested one */
+	if (!pp2_cls_plcr_entry_hw_info_get(policer_entry, &hw_info) &&
+	    abs(hw_info.rate_err_ppm) > MVPP2_PLCR_RATE_ERR_WARN_PPM)
+		pr_warn("policer %d: CIR %u is enforced as %u (%d.%02d%% %s)\n", policer_id, policer_entry->cir,
+			hw_info.cir, abs(hw_info.rate_err_ppm) / 10000, (abs(hw_info.rate_err_ppm) / 100) % 100,
+			(hw_info.rate_err_ppm > 0) ? "higher" : "lower");
+
 	/* Convert CIR and other parameters */
 	MVPP2_MEMSET_ZERO(l_plcr_entry);
-	rc = pp2_cls_plcr_entry_convert(policer_entry, &l_plcr_entry.plcr_entry, token_type);
+	rc = pp2_cls_plcr_entry_convert(policer_entry, &l_plcr_entry.plcr_entry, token_type, 1);
 	if (rc) {
 		pr_err("failed to convert policer entry\n");
 		return rc;
@@ -559,6 +596,63 @@ int pp2_cls_plcr_entry_add(struct pp2_inst			*inst,
 	return rc;
 }
 
+/*******************************************************************************
+* pp2_cls_plcr_entry_hw_info_get()
+*
+* DESCRIPTION: This API computes how a policer entry is programmed to the HW
+*		and the rate the HW enforces, without accessing the HW.
+*
+* INPUTS:
+*	policer_entry - policer entry configuration.
+*
+* OUTPUTS:
+*	info          - HW programming and enforced rates.
+*
+* RETURNS:
+*	On success, the function returns 0. On error different types are returned
+*	according to the case - see pp2_error_code_t.
+*******************************************************************************/
+int pp2_cls_plcr_entry_hw_info_get(const struct pp2_cls_plcr_params	*policer_entry,
+				   struct pp2_cls_plcr_hw_info		*info)
+{
+	struct pp2_cls_plcr_params conv_entry;
+	enum pp2_cls_plcr_token_update_type_t token_type;
+	u64 token_value, cbs_tokens;
+	int rc;
+
+	rc = pp2_cls_plcr_entry_check(policer_entry, &token_type, &token_value);
+	if (rc)
+		return rc;
+
+	rc = pp2_cls_plcr_entry_convert(policer_entry, &conv_entry, token_type, 0);
+	if (rc)
+		return rc;
+
+	memset(info, 0, sizeof(*info));
+	info->token_type = token_type;
+	info->token_value = token_value;
+	/* 'TokenUpdateAddition' tokens every 'TokenUpdatePeriod' (see pp2_cls_plcr_calc_token_type) */
+	info->update_period_ns = g_pp2_plcr_update_factor[token_type] * MVPP2_TOKEN_PERIOD_800_CORE_CLOCK *
+				 MVPP2_PLCR_CLOCK_NS;
+	info->update_tokens = token_value * MVPP2_PLCR_CLOCK_NS;
+	info->rate = pp2_cls_plcr_token_rate(token_type, token_value);
+	/* the committed bucket clips the tokens of an update beyond CBS */
+	cbs_tokens = conv_entry.cbs;
+	if (policer_entry->token_unit == PP2_CLS_PLCR_BYTES_TOKEN_UNIT)
+		cbs_tokens *= 1024;
+	if (info->update_tokens > cbs_tokens)
+		info->rate = cbs_tokens * 1000000000ULL / info->update_period_ns;
+	if (policer_entry->token_unit == PP2_CLS_PLCR_BYTES_TOKEN_UNIT)
+		info->cir = (info->rate * 8 + 500) / 1000;
+	else
+		info->cir = info->rate;
+	info->cbs = conv_entry.cbs;
+	info->ebs = conv_entry.ebs;
+	info->rate_err_ppm = pp2_cls_plcr_rate_err_ppm(policer_entry, info->rate);
+
+	return 0;
+}
+
 /*******************************************************************************
 * pp2_cls_plcr_entry_del()
 *
@@ -123,6 +123,8 @@ struct pp2_cls_plcr {
 #define MVPP2_TOKEN_PERIOD_480_CORE_CLOCK	(480)	/* 480 core clock		*/
 #define MVPP2_TOKEN_PERIOD_600_CORE_CLOCK	(600)	/* 600 core clock		*/
 #define MVPP2_TOKEN_PERIOD_800_CORE_CLOCK	(800)	/* 800 core clock		*/
+#define MVPP2_PLCR_CLOCK_NS		(3)	/* policer clock cycle (333MHz) in nsec	*/
+#define MVPP2_PLCR_RATE_ERR_WARN_PPM	(10000)	/* warn above 1% CIR deviation	*/
 #define MVPP2_PLCR_MIN_PKT_LEN		(0)	/* default min packet length	*/
 #define MVPP2_PLCR_CIR_NO_LIMIT		(0)	/* do not limit CIR		*/
 #define MVPP2_PLCR_BURST_SIZE_NO_LIMIT	(0)	/* maximum burst size		*/
@@ -199,6 +201,8 @@ int pp2_cls_plcr_entry_add(struct pp2_inst *inst,
 			   const struct pp2_cls_plcr_params *policer_entry,
 			   u8 policer_id);
 int pp2_cls_plcr_entry_del(struct pp2_inst *inst, u8 policer_id);
+int pp2_cls_plcr_entry_hw_info_get(const struct pp2_cls_plcr_params *policer_entry,
+				   struct pp2_cls_plcr_hw_info *info);
 int pp2_cls_plcr_ref_cnt_update(struct pp2_inst *inst,
 				u8 policer_id,
 				enum pp2_cls_plcr_ref_cnt_action_t cnt_action,
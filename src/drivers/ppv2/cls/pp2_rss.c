@@ -196,6 +196,59 @@ int pp2_rss_hw_tbl_set(struct pp2_port *port)
 	return 0;
 }
 
+/* pp2_rss_tbl_line_set
+*  -- Rewrite a single line of the RSS table used by a TC
+*/
+int pp2_rss_tbl_line_set(struct pp2_port *port, u8 tc, u8 line, u8 qid)
+{
+	struct mv_pp22_rss_entry rss_entry;
+	struct pp2_inst *inst = port->parent;
+	u16 num_in_qs = port->tc[tc].tc_config.num_in_qs;
+	int hw_tbl;
+
+	hw_tbl = pp2_cls_db_rss_get_hw_tbl_from_in_q(inst, num_in_qs);
+	if (hw_tbl < 0) {
+		pr_err("%s RSS table index not found\n", __func__);
+		return -EFAULT;
+	}
+
+	memset(&rss_entry, 0, sizeof(struct mv_pp22_rss_entry));
+	rss_entry.sel = MVPP22_RSS_ACCESS_TBL;
+	rss_entry.u.entry.tbl_id = hw_tbl;
+	rss_entry.u.entry.tbl_line = line;
+	rss_entry.u.entry.width = mvlog2(roundup_pow_of_two(num_in_qs));
+	rss_entry.u.entry.rxq = qid;
+
+	return mv_pp22_rss_tbl_entry_set(&inst->hw, &rss_entry);
+}
+
+/* pp2_rss_tbl_line_get
+*  -- Read a single line of the RSS table used by a TC
+*/
+int pp2_rss_tbl_line_get(struct pp2_port *port, u8 tc, u8 line, u8 *qid)
+{
+	struct mv_pp22_rss_entry rss_entry;
+	struct pp2_inst *inst = port->parent;
+	int hw_tbl, rc;
+
+	hw_tbl = pp2_cls_db_rss_get_hw_tbl_from_in_q(inst, port->tc[tc].tc_config.num_in_qs);
+	if (hw_tbl < 0) {
+		pr_err("%s RSS table index not found\n", __func__);
+		return -EFAULT;
+	}
+
+	memset(&rss_entry, 0, sizeof(struct mv_pp22_rss_entry));
+	rss_entry.sel = MVPP22_RSS_ACCESS_TBL;
+	rss_entry.u.entry.tbl_id = hw_tbl;
+	rss_entry.u.entry.tbl_line = line;
+	rc = pp2_rss_tbl_entry_get(&inst->hw, &rss_entry);
+	if (rc)
+		return rc;
+
+	*qid = rss_entry.u.entry.rxq;
+	return 0;
+}
+
 /* The function allocate a rss table for each phisical rxq,
  * they have same cos priority
  */
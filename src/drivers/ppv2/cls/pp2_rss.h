@@ -105,6 +105,8 @@
 
 int pp2_rss_enable(struct pp2_port *port, int en);
 int pp2_rss_hw_tbl_set(struct pp2_port *port);
+int pp2_rss_tbl_line_set(struct pp2_port *port, u8 tc, u8 line, u8 qid);
+int pp2_rss_tbl_line_get(struct pp2_port *port, u8 tc, u8 line, u8 *qid);
 int pp22_cls_rss_rxq_set(struct pp2_port *port);
 int pp2_rss_musdk_map_get(struct pp2_port *port);
 int pp2_cls_rss_init(struct pp2_inst *inst);
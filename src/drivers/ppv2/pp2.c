@@ -112,6 +112,9 @@
 #include "cls/pp2_prs.h"
 #include "cls/pp2_hw_cls.h"
 #include "cls/pp2_cls_mng.h"
+#ifdef MVCONF_PP2_EMU
+#include "pp2_emu.h"
+#endif
 
 
 struct pp2 *pp2_ptr;
@@ -314,10 +317,11 @@ static void pp2_bm_flush_pools(uintptr_t cpu_slot, uint16_t bm_pool_reserved_map
 }
 
 /* Initializes a packet processor control handle and its resources */
-void pp2_inst_init(struct pp2_inst *inst)
+int pp2_inst_init(struct pp2_inst *inst)
 {
-		uintptr_t cpu_slot;
+	uintptr_t cpu_slot;
 	struct pp2_hw *hw = &inst->hw;
+	int rc;
 
 	/* Master thread initializes common part of HW.
 	* This will probably get deprecated by KS driver for the initialization
@@ -329,11 +333,70 @@ void pp2_inst_init(struct pp2_inst *inst)
 		/* Clear BM */
 		pp2_bm_flush_pools(cpu_slot, inst->parent->init.bm_pool_reserved_map);
 
-		pp2_cls_mng_init(inst);
+		rc = pp2_cls_mng_init(inst);
+		if (rc) {
+			pr_err("cannot init PP%u classifier\n", inst->id);
+			return rc;
+		}
 	}
 
 	/* GOP early activation */
 	/* TODO: Revise after device tree adaptation */
+	return 0;
+}
+
+/* Register spaces come from the UIO device, or from the emulator when
+ * requested in pp2_init_params.
+ */
+static int pp2_hw_ioinit(struct pp2_inst *inst)
+{
+	struct sys_iomem_params iomem_params;
+
+#ifdef MVCONF_PP2_EMU
+	if (inst->parent->init.emulate) {
+		struct pp2_emu_params emu_params;
+
+		memset(&emu_params, 0, sizeof(emu_params));
+		emu_params.id = inst->id;
+		return pp2_emu_create(&emu_params, &inst->emu);
+	}
+#endif
+	iomem_params.type = SYS_IOMEM_T_UIO;
+	iomem_params.devname = UIO_PP2_STRING;
+	iomem_params.index = inst->id;
+
+	return sys_iomem_init(&iomem_params, &inst->pp2_sys_iomem);
+}
+
+static void pp2_hw_iodeinit(struct pp2_inst *inst)
+{
+#ifdef MVCONF_PP2_EMU
+	if (inst->emu) {
+		pp2_emu_destroy(inst->emu);
+		inst->emu = NULL;
+		return;
+	}
+#endif
+	sys_iomem_deinit(inst->pp2_sys_iomem);
+}
+
+static int pp2_hw_iomap(struct pp2_inst *inst, const char *name, phys_addr_t *pa, uintptr_t *va)
+{
+#ifdef MVCONF_PP2_EMU
+	if (inst->emu)
+		return pp2_emu_map(inst->emu, name, pa, va);
+#endif
+	return sys_iomem_map(inst->pp2_sys_iomem, name, pa, (void **)va);
+}
+
+static void pp2_hw_iounmap(struct pp2_inst *inst, const char *name)
+{
+#ifdef MVCONF_PP2_EMU
+	/* The emulator spaces are released by pp2_hw_iodeinit() */
+	if (inst->emu)
+		return;
+#endif
+	sys_iomem_unmap(inst->pp2_sys_iomem, name);
 }
 
 static int pp2_get_hw_data(struct pp2_inst *inst)
@@ -342,25 +405,19 @@ static int pp2_get_hw_data(struct pp2_inst *inst)
 	u32 i, reg_id;
 	uintptr_t mem_base;
 	struct pp2_hw *hw = &inst->hw;
-	struct sys_iomem_params iomem_params;
-	struct sys_iomem *pp2_sys_iomem;
 
 	hw->tclk = PP2_TCLK_FREQ;
-	iomem_params.type = SYS_IOMEM_T_UIO;
-	iomem_params.devname = UIO_PP2_STRING;
-	iomem_params.index = inst->id;
 
-	err = sys_iomem_init(&iomem_params, &pp2_sys_iomem);
-	inst->pp2_sys_iomem = pp2_sys_iomem;
+	err = pp2_hw_ioinit(inst);
 	if (err) {
 		pr_err(" No device found\n");
 		return err;
 	}
 
 	/* Map the whole physical Packet Processor physical address */
-	err = sys_iomem_map(pp2_sys_iomem, "pp", &hw->phy_address_base, (void **)(&mem_base));
+	err = pp2_hw_iomap(inst, "pp", &hw->phy_address_base, &mem_base);
 	if (err) {
-		sys_iomem_deinit(pp2_sys_iomem);
+		pp2_hw_iodeinit(inst);
 		return err;
 	}
 
@@ -370,16 +427,16 @@ static int pp2_get_hw_data(struct pp2_inst *inst)
 		hw->base[reg_id].va = mem_base + (reg_id * PP2_REGSPACE_SIZE);
 
 
-	err = sys_iomem_map(pp2_sys_iomem, "mspg", &hw->gop.mspg.pa, (void **)(&mem_base));
+	err = pp2_hw_iomap(inst, "mspg", &hw->gop.mspg.pa, &mem_base);
 	if (err) {
-		sys_iomem_unmap(pp2_sys_iomem, "pp");
-		sys_iomem_deinit(pp2_sys_iomem);
+		pp2_hw_iounmap(inst, "pp");
+		pp2_hw_iodeinit(inst);
 		return err;
 	}
 	hw->gop.mspg.va = mem_base;
 
 	/* Map the Cm3 physical address */
-	err = sys_iomem_map(pp2_sys_iomem, "cm3", &hw->cm3_base.pa, (void **)(&mem_base));
+	err = pp2_hw_iomap(inst, "cm3", &hw->cm3_base.pa, &mem_base);
 	if (err) {
 		/* Not all systems support cm3 */
 		pr_warn("tx_pause not supported\n");
@@ -531,9 +588,9 @@ void pp2_destroy(struct pp2_inst *inst)
 {
 	u32 i;
 
-	sys_iomem_unmap(inst->pp2_sys_iomem, "pp");
-	sys_iomem_unmap(inst->pp2_sys_iomem, "mspg");
-	sys_iomem_deinit(inst->pp2_sys_iomem);
+	pp2_hw_iounmap(inst, "pp");
+	pp2_hw_iounmap(inst, "mspg");
+	pp2_hw_iodeinit(inst);
 
 	/* No dangling handles */
 	for (i = 0; i < PP2_NUM_PORTS; i++)
@@ -554,6 +611,9 @@ int pp2_ppio_available(int pp_id, int ppio_id)
 	u32 admin_status;
 	int err;
 
+	/* Emulated ports are not backed by Linux netdevs */
+	if (pp2_ptr && pp2_ptr->init.emulate)
+		return true;
 
 	err = pp2_netdev_if_admin_status_get(pp_id, ppio_id, &admin_status);
 
@@ -662,6 +722,12 @@ int pp2_init(struct pp2_init_params *params)
 	u32 pp2_id, lp_pp2_id, pp2_num_inst, i;
 	int rc;
 
+#ifndef MVCONF_PP2_EMU
+	if (params->emulate) {
+		pr_err("[%s] PPv2 emulator not built in (--enable-pp2-emu)\n", __func__);
+		return -ENOTSUP;
+	}
+#endif
 	pp2_ptr = kcalloc(1, sizeof(struct pp2), GFP_KERNEL);
 	if (unlikely(!pp2_ptr)) {
 		pr_err("%s out of memory pp2 alloc\n", __func__);
@@ -672,7 +738,8 @@ int pp2_init(struct pp2_init_params *params)
 	pp2_ptr->pp2_common.rss_tbl_map = params->rss_tbl_reserved_map;
 	/* TODO: Check first_inq params are valid */
 
-	pp2_num_inst = pp2_get_num_inst();
+	/* The emulator provides a single packet processor */
+	pp2_num_inst = params->emulate ? 1 : pp2_get_num_inst();
 
 	/* Initialize in an opaque manner from client,
 	* depending on HW, one or two packet processors.
@@ -708,7 +775,9 @@ int pp2_init(struct pp2_init_params *params)
 			}
 		}
 
-		pp2_inst_init(inst);
+		rc = pp2_inst_init(inst);
+		if (rc)
+			goto pp2_init_err;
 
 		if (params->prs_udfs.num_udfs > 0) {
 			rc = pp2_prs_udf_init(inst, &params->prs_udfs);
@@ -761,10 +830,12 @@ int pp2_init(struct pp2_init_params *params)
 	return 0;
 
 pp2_init_err:
-	/* Rollback creation of pp2 instances */
-	for (i = 0; i < pp2_id; i++)
-		pp2_destroy(pp2_ptr->pp2_inst[i]);
+	/* Rollback creation of pp2 instances, including the one that failed */
+	for (i = 0; i <= pp2_id && i < pp2_num_inst; i++)
+		if (pp2_ptr->pp2_inst[i])
+			pp2_destroy(pp2_ptr->pp2_inst[i]);
 	kfree(pp2_ptr);
+	pp2_ptr = NULL;
 	return rc;
 }
 
@@ -120,6 +120,7 @@
 #include "pp2_gop.h"
 #include "pp2_plat.h"
 #include "pp2_mem.h"
+#include "pp2_txq_rsrv.h"
 
 #ifndef PP2_MAX_BUF_STR_LEN
 #define PP2_MAX_BUF_STR_LEN	256
@@ -149,19 +150,31 @@
 #define PP2_TX_PAUSE_SUPPORT(port)	(port->parent->hw.cm3_base.va != (uintptr_t)NULL)
 
 #ifdef MVCONF_PP2_LOCK
+	/* No lock is created for a DM-IF of an exclusive (single thread) hif */
 	#ifdef MVCONF_PP2_LOCK_STAT
 		#define dm_spin_lock(dm_lock)						\
 			do {								\
-				int pre_locked = spin_trylock((dm_lock)->lock);		\
+				int pre_locked;						\
+				if (!(dm_lock)->lock)					\
+					break;						\
+				pre_locked = spin_trylock((dm_lock)->lock);		\
 				(dm_lock)->lock_fail_count += !!pre_locked;		\
 				(dm_lock)->lock_success_count += !pre_locked;		\
 				if (pre_locked)						\
 					spin_lock((dm_lock)->lock);			\
 			} while (0)
 	#else
-		#define dm_spin_lock(dm_lock)	spin_lock((dm_lock)->lock)
+		#define dm_spin_lock(dm_lock)				\
+			do {						\
+				if ((dm_lock)->lock)			\
+					spin_lock((dm_lock)->lock);	\
+			} while (0)
 	#endif /* MVCONF_PP2_LOCK_STAT */
-	#define dm_spin_unlock(dm_lock) spin_unlock((dm_lock)->lock)
+	#define dm_spin_unlock(dm_lock)				\
+		do {						\
+			if ((dm_lock)->lock)			\
+				spin_unlock((dm_lock)->lock);	\
+		} while (0)
 #else
 	#define dm_spin_lock(dm_lock)	\
 		do {			\
@@ -233,6 +246,8 @@ struct pp2_dm_if {
 	/* CPU slot address assigned to this DM object */
 	uintptr_t cpu_slot;
 	struct mv_sys_dma_mem_region *mem; /* mem_region used to create the dm. May be NULL. */
+	/* Minimal physical TXQ descriptors reservation request */
+	u16 txq_rsrv_chunk;
 #ifdef MVCONF_PP2_LOCK
 	struct pp2_dm_lock dm_lock;
 #endif
@@ -246,11 +261,6 @@ struct pp2_dm_if {
 #define PP2_TXQ_PREFETCH_64     (64)
 
 
-struct pp2_txq_dm_if {
-	u32 desc_rsrvd;
-};
-
-
 struct pp2_lnx_format {
 	enum musdk_lnx_id ver;
 	char *devtree_path;
@@ -560,6 +570,8 @@ struct pp2_port {
 	int rx_pause_en;
 	/* number of vlan filters */
 	u32 num_vlans;
+	/* Link change notification, NULL if not registered */
+	struct pp2_link_evt *link_evt;
 };
 
 /**
@@ -676,9 +688,21 @@ struct pp2_inst {
 	struct sys_iomem *pp2_sys_iomem;
 	struct pp2_cls_db_t *cls_db;
 	u32 skip_hw_init;
-
+#ifdef MVCONF_PP2_EMU
+	/* Register/ring emulator, when running without the HW */
+	struct pp2_emu *emu;
+#endif
 };
 
+#ifdef MVCONF_PP2_EMU
+#define PP2_INST_EMU(inst)		((inst)->emu != NULL)
+#else
+#define PP2_INST_EMU(inst)		0
+#endif
+
+/* Port owned by a Linux netdev: not the loopback port, and not emulated */
+#define PP2_LNX_PORT(port)		(NOT_LPBK_PORT(port) && !PP2_INST_EMU((port)->parent))
+
 struct pp2_common_cfg {
 	u16 hif_slot_map;
 	u16 rss_tbl_map;
@@ -750,10 +774,17 @@ static inline u16 pp2_rss_map_get(void)
 
 static inline u32 pp2_get_mem_id(u32 pp2_id)
 {
+	u8 num_inst;
+
 	/* TODO: Temporary code to for testing, mechanism required to find this pp2's mem_id.
 	 *       Currently assume two mem_ids, and set mem_id=1, if pp2_id is in second half of pp2_instances.
 	*/
-	if ((pp2_get_num_inst() > 1) && (pp2_id >= (pp2_get_num_inst() >> 1)))
+	/* The emulator provides a single packet processor, with no UIO device */
+	if (pp2_ptr->init.emulate)
+		return 0;
+
+	num_inst = pp2_get_num_inst();
+	if ((num_inst > 1) && (pp2_id >= (num_inst >> 1)))
 		return 1;
 
 	return 0;
@@ -765,6 +796,6 @@ int pp2_netdev_if_admin_status_get(u32 pp_id, u32 ppio_id, u32 *admin_status);
 int pp2_status_check(struct netdev_if_params *netdev_params, struct pp2_init_params *params);
 struct pp2_inst *pp2_inst_create(struct pp2 *pp2, uint32_t pp2_id);
 void pp2_destroy(struct pp2_inst *inst);
-void pp2_inst_init(struct pp2_inst *inst);
+int pp2_inst_init(struct pp2_inst *inst);
 
 #endif /* _PP2_H_ */
@@ -100,8 +100,10 @@
 #include "pp2_bm.h"
 #include "pp2_hif.h"
 #include "pp2_port.h"
+#include "pp2_bpool_cache.h"
 
 #include "lib/lib_misc.h"
+#include "lib/mv_json.h"
 
 #define DUMMY_PKT_OFFS	64
 #define DUMMY_PKT_EFEC_OFFS	(DUMMY_PKT_OFFS + MV_MH_SIZE)
@@ -365,6 +367,80 @@ int pp2_bpool_get_num_buffs(struct pp2_bpool *pool, u32 *num_buffs)
 	return 0;
 }
 
+int pp2_bpool_cache_create(struct pp2_hif *hif, struct pp2_bpool *pool, struct pp2_bpool_cache_params *params,
+			   struct pp2_bpool_cache **cache)
+{
+	struct pp2_bpool_cache *lcache;
+
+	if (!hif || !pool || !params || !cache)
+		return -EINVAL;
+	if (!params->high_wm || params->low_wm >= params->high_wm ||
+	    params->high_wm > PP2_MAX_NUM_PUT_BUFFS) {
+		pr_err("[%s] invalid watermarks (low %u, high %u)!\n", __func__, params->low_wm, params->high_wm);
+		return -EINVAL;
+	}
+
+	lcache = kcalloc(1, sizeof(struct pp2_bpool_cache), GFP_KERNEL);
+	if (!lcache) {
+		pr_err("[%s] no mem for cache obj!\n", __func__);
+		return -ENOMEM;
+	}
+	lcache->entries = kcalloc(params->high_wm, sizeof(struct buff_release_entry), GFP_KERNEL);
+	if (!lcache->entries) {
+		pr_err("[%s] no mem for %u cache entries!\n", __func__, params->high_wm);
+		kfree(lcache);
+		return -ENOMEM;
+	}
+	lcache->hif = hif;
+	lcache->pool = pool;
+	lcache->low_wm = params->low_wm;
+	lcache->high_wm = params->high_wm;
+
+	*cache = lcache;
+	return 0;
+}
+
+void pp2_bpool_cache_destroy(struct pp2_bpool_cache *cache)
+{
+	if (!cache)
+		return;
+
+	pp2_bpool_cache_flush(cache);
+	kfree(cache->entries);
+	kfree(cache);
+}
+
+int pp2_bpool_cache_get_buff(struct pp2_bpool_cache *cache, struct pp2_buff_inf *buff)
+{
+	return pp2_bpool_cache_get(cache, buff);
+}
+
+int pp2_bpool_cache_put_buff(struct pp2_bpool_cache *cache, struct pp2_buff_inf *buff)
+{
+	pp2_bpool_cache_put(cache, buff);
+	return 0;
+}
+
+int pp2_bpool_cache_flush(struct pp2_bpool_cache *cache)
+{
+	pp2_bpool_cache_spill(cache, 0);
+	return 0;
+}
+
+int pp2_bpool_cache_get_num_buffs(struct pp2_bpool_cache *cache, u32 *num_buffs)
+{
+	*num_buffs = cache->num;
+	return 0;
+}
+
+int pp2_bpool_cache_get_stats(struct pp2_bpool_cache *cache, struct pp2_bpool_cache_stats *stats, int reset)
+{
+	*stats = cache->stats;
+	if (reset)
+		memset(&cache->stats, 0, sizeof(cache->stats));
+	return 0;
+}
+
 int pp2_bpool_get_capabilities(struct pp2_bpool *pool, struct pp2_bpool_capabilities *capa)
 {
 	capa->buff_len = pp2_ptr->pp2_inst[pool->pp2_id]->bm_pools[pool->id]->bm_pool_buf_sz;
@@ -420,9 +496,10 @@ int pp2_bpool_serialize(struct pp2_bpool *pool, char buff[], u32 size)
 
 int pp2_bpool_probe(char *match, char *buff, struct pp2_bpool **bpool)
 {
-	char				*sec = NULL;
+	struct mv_json			 json;
+	int				 info_sec, sec;
 	u8				 id_match[2];
-	int				 pool_id = 0, pp2_id = 0, rc;
+	int				 pool_id = -1, pp2_id = -1, rc;
 	phys_addr_t			 paddr;
 	u32				 poffset = 0;
 	struct sys_iomem_params		 iomem_params;
@@ -430,34 +507,23 @@ int pp2_bpool_probe(char *match, char *buff, struct pp2_bpool **bpool)
 	char				 dev_name[FILE_MAX_LINE_CHARS];
 	uintptr_t			 va;
 	struct pp2_bm_pool		*bm_pool;
-	char				*lbuff;
-
-	lbuff = kcalloc(1, strlen(buff), GFP_KERNEL);
-	if (lbuff == NULL)
-		return -ENOMEM;
 
-	memcpy(lbuff, buff, strlen(buff));
-	sec = lbuff;
+	rc = mv_json_init(&json, buff);
+	if (rc)
+		return rc;
 
-	/* Search for the pool-info section */
-	sec = strstr(sec, "pool-info");
-	if (!sec) {
-		pr_err("pool-info section not found\n");
-		rc = -EINVAL;
-		goto bp_probe_exit1;
-	}
-
-	/* Search for match (pool-x:x) */
-	sec = strstr(sec, match);
-	if (!sec) {
+	/* Search for match (pool-x:x); there is a pool-info section per bpool */
+	sec = -ENOENT;
+	for (info_sec = mv_json_lookup(&json, MV_JSON_ROOT, "pool-info"); info_sec >= 0 && sec < 0;
+	     info_sec = mv_json_lookup_next(&json, MV_JSON_ROOT, "pool-info", info_sec))
+		sec = mv_json_find(&json, info_sec, match);
+	if (sec < 0) {
 		pr_err("match not found %s\n", match);
 		rc = -EINVAL;
 		goto bp_probe_exit1;
 	}
 
-	memset(dev_name, 0, FILE_MAX_LINE_CHARS);
-	json_buffer_to_input_str(sec, "dma_dev_name", dev_name);
-	if (dev_name[0] == 0) {
+	if (mv_json_obj_get_str(&json, sec, "dma_dev_name", dev_name, sizeof(dev_name))) {
 		pr_err("'dma_dev_name' not found\n");
 		rc = -EINVAL;
 		goto bp_probe_exit1;
@@ -477,8 +543,12 @@ int pp2_bpool_probe(char *match, char *buff, struct pp2_bpool **bpool)
 	paddr = sys_iomem_info.u.shmem.paddr;
 
 	/* Retireve pp2_id and pool_id */
-	json_buffer_to_input(sec, "pp2_id", pp2_id);
-	json_buffer_to_input(sec, "id", pool_id);
+	if (mv_json_obj_get_num(&json, sec, "pp2_id", pp2_id) ||
+	    mv_json_obj_get_num(&json, sec, "id", pool_id)) {
+		pr_err("[%s] 'pp2_id' or 'id' missing or invalid\n", __func__);
+		rc = -EINVAL;
+		goto bp_probe_exit1;
+	}
 
 	if (mv_sys_match(match, "pool", 2, id_match)) {
 		rc = -ENXIO;
@@ -527,7 +597,11 @@ int pp2_bpool_probe(char *match, char *buff, struct pp2_bpool **bpool)
 	}
 
 	/* get the physical offset address of the bpool descriptor section*/
-	json_buffer_to_input(sec, "phy_offset", poffset);
+	if (mv_json_obj_get_num(&json, sec, "phy_offset", poffset)) {
+		pr_err("bpool phy_offset missing or invalid\n");
+		rc = -EINVAL;
+		goto bp_probe_exit1;
+	}
 
 	/* Allocate space for pool handler */
 	bm_pool = kcalloc(1, sizeof(struct pp2_bm_pool), GFP_KERNEL);
@@ -541,7 +615,7 @@ int pp2_bpool_probe(char *match, char *buff, struct pp2_bpool **bpool)
 	bm_pool->bm_pool_id = pool_id;
 
 	/* get the buffer size*/
-	json_buffer_to_input(sec, "buff_size", bm_pool->bm_pool_buf_sz);
+	mv_json_obj_get_num(&json, sec, "buff_size", bm_pool->bm_pool_buf_sz);
 	if (bm_pool->bm_pool_buf_sz == 0) {
 		pr_err("bpool buf_size is 0\n");
 		rc = -EINVAL;
@@ -549,7 +623,7 @@ int pp2_bpool_probe(char *match, char *buff, struct pp2_bpool **bpool)
 	}
 
 	/* get the maximum number of buffers */
-	json_buffer_to_input(sec, "max_num_buffs", bm_pool->bm_pool_buf_num);
+	mv_json_obj_get_num(&json, sec, "max_num_buffs", bm_pool->bm_pool_buf_num);
 	if (bm_pool->bm_pool_buf_num == 0) {
 		pr_err("bpool max_num_buffs is 0\n");
 		rc = -EINVAL;
@@ -569,13 +643,13 @@ int pp2_bpool_probe(char *match, char *buff, struct pp2_bpool **bpool)
 	SET_HW_BASE(&pp2_bpools[pp2_id][pool_id], &pp2_ptr->pp2_inst[pp2_id]->hw.base[0]);
 	*bpool = &pp2_bpools[pp2_id][pool_id];
 
-	kfree(lbuff);
+	mv_json_deinit(&json);
 	return 0;
 
 bp_probe_exit2:
 	kfree(bm_pool);
 bp_probe_exit1:
-	kfree(lbuff);
+	mv_json_deinit(&json);
 	return rc;
 }
 
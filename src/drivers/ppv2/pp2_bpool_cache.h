@@ -0,0 +1,197 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+/**
+ * @file pp2_bpool_cache.h
+ *
+ * Per-HIF software buffer cache in front of a BM pool
+ *
+ * Buffers put by a HIF are kept in a LIFO cache and handed back on the next
+ * gets, so buffers recycled in software never reach the BM registers. The
+ * cache is refilled from the BM when empty, and spilled (in one release
+ * burst through the loopback port) when reaching its high watermark.
+ * A cache belongs to one HIF and needs no locking.
+ */
+
+#ifndef _PP2_BPOOL_CACHE_H_
+#define _PP2_BPOOL_CACHE_H_
+
+#include "std_internal.h"
+#include "drivers/mv_pp2_bpool.h"
+
+struct pp2_bpool_cache {
+	struct pp2_hif *hif;
+	struct pp2_bpool *pool;
+	/* An empty cache is filled up to 'low_wm' buffers */
+	u16 low_wm;
+	/* A cache reaching 'high_wm' buffers is spilled down to 'low_wm' */
+	u16 high_wm;
+	u16 num;
+	struct pp2_bpool_cache_stats stats;
+	/* LIFO of 'high_wm' entries, ready to be released as is */
+	struct buff_release_entry *entries;
+};
+
+/* BM access; may be overridden (before including this file) by a fake BM in tests */
+#ifndef pp2_bpool_cache_hw_get
+#define pp2_bpool_cache_hw_get(hif, pool, buff)		pp2_bpool_get_buff(hif, pool, buff)
+#define pp2_bpool_cache_hw_put(hif, entries, num)	pp2_bpool_put_buffs(hif, entries, num)
+#endif
+
+/* Release the oldest cached buffers to the BM, leaving 'target' in the cache */
+static inline void pp2_bpool_cache_spill(struct pp2_bpool_cache *cache, u16 target)
+{
+	u16 num;
+
+	if (cache->num <= target)
+		return;
+
+	/* The bottom of the LIFO holds the coldest buffers */
+	num = cache->num - target;
+	pp2_bpool_cache_hw_put(cache->hif, cache->entries, &num);
+	memmove(cache->entries, cache->entries + num, target * sizeof(struct buff_release_entry));
+	cache->num = target;
+	cache->stats.spills++;
+	cache->stats.spilled_buffs += num;
+}
+
+/* Get buffers from the BM until the cache holds 'target' or the BM is empty */
+static inline void pp2_bpool_cache_fill(struct pp2_bpool_cache *cache, u16 target)
+{
+	u16 num = cache->num;
+
+	while (num < target) {
+		if (pp2_bpool_cache_hw_get(cache->hif, cache->pool, &cache->entries[num].buff))
+			break;
+		cache->entries[num].bpool = cache->pool;
+		num++;
+	}
+	if (num != cache->num) {
+		cache->stats.fills++;
+		cache->stats.filled_buffs += num - cache->num;
+		cache->num = num;
+	}
+}
+
+static inline int pp2_bpool_cache_get(struct pp2_bpool_cache *cache, struct pp2_buff_inf *buff)
+{
+	cache->stats.gets++;
+	if (unlikely(!cache->num)) {
+		pp2_bpool_cache_fill(cache, cache->low_wm);
+		if (unlikely(!cache->num)) {
+			cache->stats.empty++;
+			return -ENOBUFS;
+		}
+	} else {
+		cache->stats.hits++;
+	}
+
+	*buff = cache->entries[--cache->num].buff;
+	return 0;
+}
+
+static inline void pp2_bpool_cache_put(struct pp2_bpool_cache *cache, struct pp2_buff_inf *buff)
+{
+	cache->stats.puts++;
+	if (unlikely(cache->num == cache->high_wm))
+		pp2_bpool_cache_spill(cache, cache->low_wm);
+
+	cache->entries[cache->num].buff = *buff;
+	cache->entries[cache->num].bpool = cache->pool;
+	cache->num++;
+}
+
+#endif /* _PP2_BPOOL_CACHE_H_ */
@@ -295,6 +295,14 @@ int pp2_cls_plcr_init(struct pp2_cls_plcr_params *params, struct pp2_cls_plcr **
 	return rc;
 }
 
+int pp2_cls_plcr_get_hw_info(const struct pp2_cls_plcr_params *params, struct pp2_cls_plcr_hw_info *info)
+{
+	if (mv_pp2x_ptr_validate(params) || mv_pp2x_ptr_validate(info))
+		return -EINVAL;
+
+	return pp2_cls_plcr_entry_hw_info_get(params, info);
+}
+
 void pp2_cls_plcr_deinit(struct pp2_cls_plcr *plcr)
 {
 	int rc;
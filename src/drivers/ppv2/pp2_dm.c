@@ -108,17 +108,19 @@
 #include "pp2_port.h"
 
 
-static void dm_lock_create(struct pp2_dm_if *dm_if)
+static void dm_lock_create(struct pp2_dm_if *dm_if, int exclusive)
 {
 #ifdef MVCONF_PP2_LOCK
-	dm_if->dm_lock.lock = spin_lock_create();
+	if (!exclusive)
+		dm_if->dm_lock.lock = spin_lock_create();
 #endif
 }
 
 static void dm_lock_destroy(struct pp2_dm_if *dm_if)
 {
 #ifdef MVCONF_PP2_LOCK
-	spin_lock_destroy(dm_if->dm_lock.lock);
+	if (dm_if->dm_lock.lock)
+		spin_lock_destroy(dm_if->dm_lock.lock);
 #endif
 }
 
@@ -131,7 +133,7 @@ static void pp2_dm_aggr_queue_config(struct pp2_dm_if *dm_if, uintptr_t addr, u3
 
 /* Internal. Creates a DM object */
 int pp2_dm_if_init(struct pp2 *pp2, uint32_t dm_id, uint32_t pp2_id, uint32_t num_desc,
-		   struct mv_sys_dma_mem_region *mem)
+		   struct mv_sys_dma_mem_region *mem, u16 txq_rsrv_chunk, int exclusive)
 {
 	struct pp2_inst *inst;
 	struct pp2_dm_if *dm_if;
@@ -147,6 +149,7 @@ int pp2_dm_if_init(struct pp2 *pp2, uint32_t dm_id, uint32_t pp2_id, uint32_t nu
 	dm_if->id = dm_id;
 	dm_if->desc_total = num_desc;
 	dm_if->mem = mem;
+	dm_if->txq_rsrv_chunk = txq_rsrv_chunk ? txq_rsrv_chunk : MVPP2_CPU_DESC_CHUNK;
 
 	/* Allocate a region via CMA for TXDs and setup their addresses */
 	dm_if->desc_virt_arr = mv_sys_dma_mem_region_alloc(mem, (num_desc * MVPP2_DESC_ALIGNED_SIZE),
@@ -177,7 +180,7 @@ int pp2_dm_if_init(struct pp2 *pp2, uint32_t dm_id, uint32_t pp2_id, uint32_t nu
 	inst->num_dm_ifs++;
 
 	/* Create dm_lock for aggregation_queue locking */
-	dm_lock_create(dm_if);
+	dm_lock_create(dm_if, exclusive);
 	pr_debug("DM:(AQ%u)(PP%u) created\n", dm_id, pp2_id);
 
 	return 0;
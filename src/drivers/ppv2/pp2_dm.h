@@ -241,10 +241,14 @@ struct pp2_dm_if_param {
  *
  * @param param		Parameters for this DM-IF object
  *
+ * @param txq_rsrv_chunk	Minimal physical TXQ reservation request (0 for default)
+ *
+ * @param exclusive	The DM-IF is used by a single thread; no lock is created
+ *
  * @retval		DM-IF object handle on success, NULL otherwise
  */
 int pp2_dm_if_init(struct pp2 *pp2, uint32_t dm_id, uint32_t pp2_id, uint32_t num_desc,
-		   struct mv_sys_dma_mem_region *mem);
+		   struct mv_sys_dma_mem_region *mem, u16 txq_rsrv_chunk, int exclusive);
 
 /**
  * pp2_dm_if_deinit
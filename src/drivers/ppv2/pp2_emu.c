@@ -0,0 +1,887 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+/**
+ * @file pp2_emu.c
+ *
+ * PPv2 register and ring emulator
+ */
+
+#include "std_internal.h"
+#include <sys/stat.h>
+#include <pthread.h>
+
+#include "pp2.h"
+#include "pp2_dm.h"
+#include "pp2_emu.h"
+
+#define EMU_SHM_FILE_FMT	"/dev/shm/musdk_pp2_emu%u"
+/* Fake physical base reported for the emulated register spaces */
+#define EMU_PHYS_BASE		0xf2000000
+
+#define EMU_PP_SIZE		(PP2_NUM_REGSPACES * PP2_REGSPACE_SIZE)
+#define EMU_MSPG_SIZE		0x10000
+#define EMU_CM3_SIZE		0x10000
+#define EMU_SHM_SIZE		(EMU_PP_SIZE + EMU_MSPG_SIZE + EMU_CM3_SIZE)
+
+#define EMU_NUM_RXQS		(PP2_NUM_PORTS * PP2_HW_PORT_NUM_RXQS)
+#define EMU_NUM_TXQS		256
+#define EMU_FIRST_SENT_TXQ	128
+#define EMU_NUM_TXPS		32
+/* The physical address high bits share a register with the virtual ones */
+#define EMU_BM_PHY_HIGH_MASK	0xff
+
+#define EMU_MAX_PKT_SIZE	(16 * 1024)
+#define EMU_THREAD_BUDGET	64
+#define EMU_THREAD_IDLE_USEC	10
+
+/* Plain (side-effect free) registers are kept in the slot-0 image */
+#define EMU_REG(emu, offs)	(*(volatile u32 *)((emu)->pp_va + (offs)))
+
+struct emu_bm_pool {
+	int	 started;
+	u32	 size;		/* stack capacity, from the pool size register */
+	u32	 num;		/* buffers in the stack */
+	u64	*phys;
+	u64	*virt;
+};
+
+struct emu_rxq {
+	u64	base;
+	u32	size;
+	u32	next;		/* next descriptor written by the "HW" */
+	u32	occ;		/* occupied: written, not yet processed by SW */
+	u32	non_occ;	/* descriptors SW returned to the HW */
+};
+
+struct emu_txq {
+	u64	base;
+	u32	size;
+	u32	pending;
+	u32	rsvd[PP2_NUM_REGSPACES];
+	u32	sent[PP2_NUM_REGSPACES];
+};
+
+struct emu_aggr {
+	u64	base;
+	u32	size;
+	u32	head;		/* next descriptor to transmit */
+	u32	pending;
+	/* Packet being gathered from scatter-gather descriptors */
+	u32	pkt_len;
+	int	pkt_drop;
+	u8	pkt[EMU_MAX_PKT_SIZE];
+};
+
+/* Per CPU slot (register space) state of indirect and latched registers */
+struct emu_slot {
+	u32	rxq_sel;
+	u32	txq_sel;
+	u32	rsvd_rslt;
+	u32	rls_virt_lo;
+	u32	rls_high;
+	u32	alloc_virt_lo;
+	u32	alloc_high;
+};
+
+struct pp2_emu {
+	u32			 id;
+	void			*(*phys2virt)(phys_addr_t pa);
+	char			 file_name[64];
+	struct sys_iomem	*iomem;
+	uintptr_t		 pp_va;
+	uintptr_t		 mspg_va;
+	uintptr_t		 cm3_va;
+	spinlock_t		 lock;
+	pthread_t		 thread;
+	int			 thread_run;
+	u32			 next_aggr;
+	struct emu_slot		 slots[PP2_NUM_REGSPACES];
+	struct emu_aggr		 aggrs[PP2_NUM_REGSPACES];
+	struct emu_rxq		 rxqs[EMU_NUM_RXQS];
+	struct emu_txq		 txqs[EMU_NUM_TXQS];
+	struct emu_bm_pool	 pools[PP2_BPOOL_NUM_POOLS];
+	u8			 txp_qmap[EMU_NUM_TXPS];
+	struct pp2_emu_stats	 stats;
+};
+
+int pp2_emu_active;
+static struct pp2_emu *emu_insts[PP2_MAX_NUM_PACKPROCS];
+
+/* Returns true if 'offs' is the register of index *idx in the array of
+ * 'num' 32-bit registers starting at 'base'
+ */
+static inline int emu_reg_idx(u32 offs, u32 base, u32 num, u32 *idx)
+{
+	if (offs < base || offs >= base + 4 * num || (offs & 3))
+		return 0;
+	*idx = (offs - base) / 4;
+	return 1;
+}
+
+static inline void *emu_p2v(struct pp2_emu *emu, u64 pa)
+{
+	return pa ? emu->phys2virt((phys_addr_t)pa) : NULL;
+}
+
+static struct pp2_emu *emu_lookup(uintptr_t addr, u32 *slot, u32 *offs)
+{
+	struct pp2_emu *emu;
+	u32 i;
+
+	for (i = 0; i < PP2_MAX_NUM_PACKPROCS; i++) {
+		emu = emu_insts[i];
+		if (emu && addr >= emu->pp_va && addr < emu->pp_va + EMU_PP_SIZE) {
+			*slot = (addr - emu->pp_va) / PP2_REGSPACE_SIZE;
+			*offs = (addr - emu->pp_va) % PP2_REGSPACE_SIZE;
+			return emu;
+		}
+	}
+	return NULL;
+}
+
+/***************************** BM *****************************/
+
+static void emu_bm_pool_stop(struct emu_bm_pool *pool)
+{
+	kfree(pool->phys);
+	kfree(pool->virt);
+	memset(pool, 0, sizeof(*pool));
+}
+
+static void emu_bm_pool_start(struct pp2_emu *emu, u32 pool_id)
+{
+	struct emu_bm_pool *pool = &emu->pools[pool_id];
+	u32 size;
+
+	if (pool->started)
+		return;
+	size = EMU_REG(emu, MVPP2_BM_POOL_SIZE_REG(pool_id));
+	if (!size || size > MVPP2_BM_POOL_SIZE_MAX)
+		size = MVPP2_BM_POOL_SIZE_MAX;
+	pool->phys = kcalloc(size, sizeof(u64), GFP_KERNEL);
+	pool->virt = kcalloc(size, sizeof(u64), GFP_KERNEL);
+	if (!pool->phys || !pool->virt) {
+		pr_err("[%s] no mem for BM pool %u stack!\n", __func__, pool_id);
+		emu_bm_pool_stop(pool);
+		return;
+	}
+	pool->size = size;
+	pool->started = 1;
+}
+
+static void emu_bm_put(struct pp2_emu *emu, u32 pool_id, u64 phys, u64 virt)
+{
+	struct emu_bm_pool *pool = &emu->pools[pool_id % PP2_BPOOL_NUM_POOLS];
+
+	if (unlikely(!pool->started || pool->num == pool->size)) {
+		emu->stats.bm_rls_drops++;
+		return;
+	}
+	pool->phys[pool->num] = phys;
+	pool->virt[pool->num] = virt;
+	pool->num++;
+	emu->stats.bm_rls++;
+}
+
+static int emu_bm_get(struct pp2_emu *emu, u32 pool_id, u64 *phys, u64 *virt)
+{
+	struct emu_bm_pool *pool = &emu->pools[pool_id % PP2_BPOOL_NUM_POOLS];
+
+	if (!pool->started || !pool->num)
+		return -ENOBUFS;
+	pool->num--;
+	*phys = pool->phys[pool->num];
+	*virt = pool->virt[pool->num];
+	emu->stats.bm_allocs++;
+	return 0;
+}
+
+/* Like the HW, the pointer counters do not account for the buffer already
+ * prefetched for the next allocation; SW adds it back (pp2_bpool_get_num_buffs()).
+ */
+static inline u32 emu_bm_ptrs_num(struct emu_bm_pool *pool)
+{
+	return pool->num ? pool->num - 1 : 0;
+}
+
+/***************************** queues *****************************/
+
+static void emu_txq_reserve(struct pp2_emu *emu, u32 slot, u32 data)
+{
+	struct emu_txq *txq = &emu->txqs[(data >> MVPP2_TXQ_RSVD_REQ_Q_OFFSET) % EMU_NUM_TXQS];
+	u32 num = data & MVPP2_TXQ_RSVD_RSLT_MASK;
+	u32 i, used = txq->pending;
+
+	for (i = 0; i < PP2_NUM_REGSPACES; i++)
+		used += txq->rsvd[i];
+	num = min(num, txq->size > used ? txq->size - used : 0);
+	txq->rsvd[slot] += num;
+	emu->slots[slot].rsvd_rslt = num;
+}
+
+static void emu_aggr_reset(struct emu_aggr *aggr)
+{
+	aggr->head = 0;
+	aggr->pending = 0;
+	aggr->pkt_len = 0;
+	aggr->pkt_drop = 0;
+}
+
+/***************************** registers *****************************/
+
+static int emu_reg_write_special(struct pp2_emu *emu, u32 slot, u32 offs, u32 data)
+{
+	struct emu_slot *s = &emu->slots[slot];
+	struct emu_rxq *rxq = &emu->rxqs[s->rxq_sel];
+	struct emu_txq *txq = &emu->txqs[s->txq_sel];
+	struct emu_aggr *aggr;
+	u32 idx, val;
+
+	switch (offs) {
+	case MVPP2_RXQ_NUM_REG:
+		s->rxq_sel = data % EMU_NUM_RXQS;
+		return 1;
+	case MVPP2_RXQ_DESC_ADDR_REG:
+		rxq->base = (u64)data << MVPP22_DESC_ADDR_SHIFT;
+		return 1;
+	case MVPP2_RXQ_DESC_SIZE_REG:
+		rxq->size = data & MVPP2_RXQ_DESC_SIZE_MASK;
+		rxq->next = 0;
+		return 1;
+	case MVPP2_RXQ_INDEX_REG:
+		rxq->next = rxq->size ? data % rxq->size : 0;
+		return 1;
+	case MVPP2_TXQ_NUM_REG:
+		s->txq_sel = data % EMU_NUM_TXQS;
+		return 1;
+	case MVPP2_TXQ_DESC_ADDR_LOW_REG:
+		txq->base = (txq->base & ~0xffffffffULL) | data;
+		return 1;
+	case MVPP22_TXQ_DESC_ADDR_HIGH_REG:
+		txq->base = (txq->base & 0xffffffffULL) | ((u64)(data & MVPP22_TXQ_DESC_ADDR_HIGH_MASK) << 32);
+		return 1;
+	case MVPP2_TXQ_DESC_SIZE_REG:
+		txq->size = data & MVPP2_TXQ_DESC_SIZE_MASK;
+		if (!txq->size) {
+			txq->pending = 0;
+			memset(txq->rsvd, 0, sizeof(txq->rsvd));
+		}
+		return 1;
+	case MVPP2_TXQ_PENDING_REG:
+		/* Counter owned by the HW */
+		return 1;
+	case MVPP2_TXQ_RSVD_REQ_REG:
+		emu_txq_reserve(emu, slot, data);
+		return 1;
+	case MVPP2_TXQ_RSVD_CLR_REG:
+		txq = &emu->txqs[(data >> MVPP2_TXQ_RSVD_CLR_OFFSET) % EMU_NUM_TXQS];
+		memset(txq->rsvd, 0, sizeof(txq->rsvd));
+		return 1;
+	case MVPP2_AGGR_TXQ_UPDATE_REG:
+		aggr = &emu->aggrs[slot];
+		aggr->pending = min(aggr->pending + data, aggr->size);
+		return 1;
+	case MVPP2_TXP_SCHED_Q_CMD_REG:
+		idx = EMU_REG(emu, MVPP2_TXP_SCHED_PORT_INDEX_REG) % EMU_NUM_TXPS;
+		emu->txp_qmap[idx] |= data & MVPP2_TXP_SCHED_ENQ_MASK;
+		emu->txp_qmap[idx] &= ~((data >> MVPP2_TXP_SCHED_DISQ_OFFSET) & MVPP2_TXP_SCHED_ENQ_MASK);
+		return 1;
+	case MVPP2_BM_VIRT_RLS_REG:
+		s->rls_virt_lo = data;
+		return 1;
+	case MVPP22_BM_PHY_VIRT_HIGH_RLS_REG:
+		s->rls_high = data;
+		return 1;
+	}
+
+	if (emu_reg_idx(offs, MVPP2_RXQ_STATUS_UPDATE_REG(0), EMU_NUM_RXQS, &idx)) {
+		rxq = &emu->rxqs[idx];
+		val = data & MVPP2_RXQ_OCCUPIED_MASK;
+		rxq->occ -= min(val, rxq->occ);
+		val = (data & MVPP2_RXQ_NON_OCCUPIED_MASK) >> MVPP2_RXQ_NON_OCCUPIED_OFFSET;
+		rxq->non_occ = min(rxq->non_occ + val, rxq->size);
+		return 1;
+	}
+	if (emu_reg_idx(offs, MVPP2_RXQ_STATUS_REG(0), EMU_NUM_RXQS, &idx)) {
+		rxq = &emu->rxqs[idx];
+		rxq->occ = data & MVPP2_RXQ_OCCUPIED_MASK;
+		rxq->non_occ = (data & MVPP2_RXQ_NON_OCCUPIED_MASK) >> MVPP2_RXQ_NON_OCCUPIED_OFFSET;
+		return 1;
+	}
+	if (emu_reg_idx(offs, MVPP2_AGGR_TXQ_INIT(0), PP2_NUM_REGSPACES, &idx)) {
+		emu_aggr_reset(&emu->aggrs[idx]);
+		return 1;
+	}
+	if (emu_reg_idx(offs, MVPP2_AGGR_TXQ_DESC_ADDR_REG(0), PP2_NUM_REGSPACES, &idx)) {
+		emu->aggrs[idx].base = (u64)data << MVPP22_DESC_ADDR_SHIFT;
+		emu_aggr_reset(&emu->aggrs[idx]);
+		return 1;
+	}
+	if (emu_reg_idx(offs, MVPP2_AGGR_TXQ_DESC_SIZE_REG(0), PP2_NUM_REGSPACES, &idx)) {
+		emu->aggrs[idx].size = data & MVPP2_AGGR_TXQ_DESC_SIZE_MASK;
+		emu_aggr_reset(&emu->aggrs[idx]);
+		return 1;
+	}
+	if (emu_reg_idx(offs, MVPP2_BM_POOL_CTRL_REG(0), PP2_BPOOL_NUM_POOLS, &idx)) {
+		if (data & MVPP2_BM_START_MASK)
+			emu_bm_pool_start(emu, idx);
+		if (data & MVPP2_BM_STOP_MASK)
+			emu_bm_pool_stop(&emu->pools[idx]);
+		EMU_REG(emu, offs) = data & ~(MVPP2_BM_START_MASK | MVPP2_BM_STOP_MASK | MVPP2_BM_STATE_MASK);
+		return 1;
+	}
+	if (emu_reg_idx(offs, MVPP2_BM_PHY_RLS_REG(0), PP2_BPOOL_NUM_POOLS, &idx)) {
+		emu_bm_put(emu, idx,
+			   ((u64)(s->rls_high & EMU_BM_PHY_HIGH_MASK) << 32) | data,
+			   ((u64)((s->rls_high & MVPP22_BM_VIRT_HIGH_ALLOC_MASK) >>
+				  MVPP22_BM_VIRT_HIGH_ALLOC_OFFSET) << 32) | s->rls_virt_lo);
+		return 1;
+	}
+	return 0;
+}
+
+static int emu_reg_read_special(struct pp2_emu *emu, u32 slot, u32 offs, u32 *val)
+{
+	struct emu_slot *s = &emu->slots[slot];
+	struct emu_bm_pool *pool;
+	struct emu_aggr *aggr;
+	struct emu_txq *txq;
+	u64 phys, virt;
+	u32 idx;
+
+	switch (offs) {
+	case MVPP2_TXQ_PENDING_REG:
+		*val = (EMU_REG(emu, offs) & ~MVPP2_TXQ_PENDING_MASK) | emu->txqs[s->txq_sel].pending;
+		return 1;
+	case MVPP2_TXQ_RSVD_RSLT_REG:
+		*val = s->rsvd_rslt;
+		return 1;
+	case MVPP2_TXP_SCHED_Q_CMD_REG:
+		*val = emu->txp_qmap[EMU_REG(emu, MVPP2_TXP_SCHED_PORT_INDEX_REG) % EMU_NUM_TXPS];
+		return 1;
+	case MVPP2_BM_VIRT_ALLOC_REG:
+		*val = s->alloc_virt_lo;
+		return 1;
+	case MVPP22_BM_PHY_VIRT_HIGH_ALLOC_REG:
+		*val = s->alloc_high;
+		return 1;
+	}
+
+	if (emu_reg_idx(offs, MVPP2_RXQ_STATUS_REG(0), EMU_NUM_RXQS, &idx)) {
+		*val = emu->rxqs[idx].occ | (emu->rxqs[idx].non_occ << MVPP2_RXQ_NON_OCCUPIED_OFFSET);
+		return 1;
+	}
+	if (emu_reg_idx(offs, MVPP22_TXQ_SENT_REG(EMU_FIRST_SENT_TXQ), EMU_NUM_TXQS - EMU_FIRST_SENT_TXQ, &idx)) {
+		/* Read-clear, per slot */
+		txq = &emu->txqs[EMU_FIRST_SENT_TXQ + idx];
+		*val = (txq->sent[slot] << MVPP22_TRANSMITTED_COUNT_OFFSET) & MVPP22_TRANSMITTED_COUNT_MASK;
+		txq->sent[slot] = 0;
+		return 1;
+	}
+	if (emu_reg_idx(offs, MVPP2_AGGR_TXQ_STATUS_REG(0), PP2_NUM_REGSPACES, &idx)) {
+		*val = emu->aggrs[idx].pending;
+		return 1;
+	}
+	if (emu_reg_idx(offs, MVPP2_AGGR_TXQ_INDEX_REG(0), PP2_NUM_REGSPACES, &idx)) {
+		aggr = &emu->aggrs[idx];
+		*val = aggr->size ? (aggr->head + aggr->pending) % aggr->size : 0;
+		return 1;
+	}
+	if (emu_reg_idx(offs, MVPP2_BM_POOL_CTRL_REG(0), PP2_BPOOL_NUM_POOLS, &idx)) {
+		*val = EMU_REG(emu, offs) | (emu->pools[idx].started ? MVPP2_BM_STATE_MASK : 0);
+		return 1;
+	}
+	if (emu_reg_idx(offs, MVPP2_BM_POOL_PTRS_NUM_REG(0), PP2_BPOOL_NUM_POOLS, &idx)) {
+		*val = emu_bm_ptrs_num(&emu->pools[idx]) & MVPP22_BM_POOL_PTRS_NUM_MASK;
+		return 1;
+	}
+	if (emu_reg_idx(offs, MVPP2_BM_BPPI_PTRS_NUM_REG(0), PP2_BPOOL_NUM_POOLS, &idx)) {
+		pool = &emu->pools[idx];
+		*val = emu_bm_ptrs_num(pool) & ~MVPP22_BM_POOL_PTRS_NUM_MASK & MVPP2_BM_BPPI_PTR_NUM_MASK;
+		return 1;
+	}
+	if (emu_reg_idx(offs, MVPP2_BM_PHY_ALLOC_REG(0), PP2_BPOOL_NUM_POOLS, &idx)) {
+		if (emu_bm_get(emu, idx, &phys, &virt)) {
+			phys = 0;
+			virt = 0;
+		}
+		s->alloc_virt_lo = (u32)virt;
+		s->alloc_high = ((phys >> 32) & EMU_BM_PHY_HIGH_MASK) |
+				(((virt >> 32) << MVPP22_BM_VIRT_HIGH_ALLOC_OFFSET) & MVPP22_BM_VIRT_HIGH_ALLOC_MASK);
+		*val = (u32)phys;
+		return 1;
+	}
+	return 0;
+}
+
+void pp2_emu_reg_write(uintptr_t addr, u32 data)
+{
+	struct pp2_emu *emu;
+	u32 slot, offs;
+
+	emu = emu_lookup(addr, &slot, &offs);
+	if (!emu) {
+		writel(data, (void *)addr);
+		return;
+	}
+	spin_lock(&emu->lock);
+	if (!emu_reg_write_special(emu, slot, offs, data))
+		EMU_REG(emu, offs) = data;
+	spin_unlock(&emu->lock);
+}
+
+u32 pp2_emu_reg_read(uintptr_t addr)
+{
+	struct pp2_emu *emu;
+	u32 slot, offs, val;
+
+	emu = emu_lookup(addr, &slot, &offs);
+	if (!emu)
+		return readl((void *)addr);
+	spin_lock(&emu->lock);
+	if (!emu_reg_read_special(emu, slot, offs, &val))
+		val = EMU_REG(emu, offs);
+	spin_unlock(&emu->lock);
+	return val;
+}
+
+/***************************** TX/RX engines *****************************/
+
+/* Minimal parser: fills the L3/L4 info of the RX descriptor */
+static u32 emu_rx_parse(const u8 *pkt, u32 len)
+{
+	u32 l3_off = 2 * ETH_ALEN, l3_type, l4_type = PP2_INQ_L4_TYPE_NA, hdr_len, proto;
+	u16 eth_type;
+
+	do {
+		if (l3_off + 2 > len)
+			return 0;
+		eth_type = (pkt[l3_off] << 8) | pkt[l3_off + 1];
+		l3_off += 2;
+		if (eth_type == ETH_P_8021Q || eth_type == ETH_P_8021AD)
+			l3_off += 2;
+	} while (eth_type == ETH_P_8021Q || eth_type == ETH_P_8021AD);
+
+	if (eth_type == ETH_P_IP && l3_off + 20 <= len) {
+		hdr_len = pkt[l3_off] & 0xf;
+		proto = pkt[l3_off + 9];
+		if (!pkt[l3_off + 8])
+			l3_type = PP2_INQ_L3_TYPE_IPV4_TTL_ZERO;
+		else
+			l3_type = (hdr_len == 5) ? PP2_INQ_L3_TYPE_IPV4_NO_OPTS : PP2_INQ_L3_TYPE_IPV4_OK;
+	} else if (eth_type == ETH_P_IPV6 && l3_off + 40 <= len) {
+		hdr_len = 40 / 4;
+		proto = pkt[l3_off + 6];
+		l3_type = (proto == IPPROTO_TCP || proto == IPPROTO_UDP) ?
+			  PP2_INQ_L3_TYPE_IPV6_NO_EXT : PP2_INQ_L3_TYPE_IPV6_EXT;
+	} else if (eth_type == ETH_P_ARP) {
+		return (PP2_INQ_L3_TYPE_ARP << 28) | ((l3_off + MV_MH_SIZE) & RXD_L3_OFF_MASK);
+	} else {
+		return 0;
+	}
+
+	if (proto == IPPROTO_TCP)
+		l4_type = PP2_INQ_L4_TYPE_TCP;
+	else if (proto == IPPROTO_UDP)
+		l4_type = PP2_INQ_L4_TYPE_UDP;
+	else
+		l4_type = PP2_INQ_L4_TYPE_OTHER;
+
+	return ((l3_type << 28) & RXD_L3_PRS_INFO_MASK) |
+	       ((l4_type << 25) & RXD_L4_PRS_INFO_MASK) |
+	       ((hdr_len << 8) & RXD_IPHDR_LEN_MASK) |
+	       ((l3_off + MV_MH_SIZE) & RXD_L3_OFF_MASK);
+}
+
+/* Write a packet to the default RXQ of 'port', as the HW would with no
+ * classification rule matching
+ */
+static void emu_rx(struct pp2_emu *emu, u32 port, const u8 *pkt, u32 len)
+{
+	struct pp2_ppio_desc *desc;
+	struct emu_rxq *rxq;
+	u32 q, cfg, pkt_offs, pool_id, pool_short, pool_long;
+	u64 phys, virt;
+	u8 *buf;
+
+	q = EMU_REG(emu, MVPP2_CLS_OVERSIZE_RXQ_LOW_REG(port)) % EMU_NUM_RXQS;
+	rxq = &emu->rxqs[q];
+	if (!rxq->size || !rxq->base) {
+		emu->stats.rx_no_q_drops++;
+		return;
+	}
+	if (!rxq->non_occ) {
+		emu->stats.rx_fullq_drops++;
+		return;
+	}
+
+	cfg = EMU_REG(emu, MVPP2_RXQ_CONFIG_REG(q));
+	pkt_offs = ((cfg & MVPP2_RXQ_PACKET_OFFSET_MASK) >> MVPP2_RXQ_PACKET_OFFSET_OFFS) * 32;
+	pool_short = (cfg & MVPP22_RXQ_POOL_SHORT_MASK) >> MVPP22_RXQ_POOL_SHORT_OFFS;
+	pool_long = (cfg & MVPP22_RXQ_POOL_LONG_MASK) >> MVPP22_RXQ_POOL_LONG_OFFS;
+	pool_id = (pkt_offs + MV_MH_SIZE + len <= EMU_REG(emu, MVPP2_POOL_BUF_SIZE_REG(pool_short))) ?
+		  pool_short : pool_long;
+	if (pkt_offs + MV_MH_SIZE + len > EMU_REG(emu, MVPP2_POOL_BUF_SIZE_REG(pool_id)) ||
+	    emu_bm_get(emu, pool_id, &phys, &virt)) {
+		emu->stats.rx_bm_drops++;
+		return;
+	}
+	buf = emu_p2v(emu, phys);
+	desc = emu_p2v(emu, rxq->base + rxq->next * MVPP2_DESC_ALIGNED_SIZE);
+	if (unlikely(!buf || !desc)) {
+		pr_err("[%s] no mapping for RXQ %u buffer/descriptor\n", __func__, q);
+		emu_bm_put(emu, pool_id, phys, virt);
+		emu->stats.rx_bm_drops++;
+		return;
+	}
+
+	/* Zeroed Marvell header, then the frame */
+	memset(buf + pkt_offs, 0, MV_MH_SIZE);
+	memcpy(buf + pkt_offs + MV_MH_SIZE, pkt, len);
+
+	memset(desc, 0, sizeof(*desc));
+	desc->cmds[0] = ((pool_id << 16) & RXD_POOL_ID_MASK) | emu_rx_parse(pkt, len);
+	desc->cmds[1] = ((len + MV_MH_SIZE) << 16) & RXD_BYTE_COUNT_MASK;
+	desc->cmds[4] = (u32)phys;
+	desc->cmds[5] = (phys >> 32) & RXD_BUF_PHYS_HI_MASK;
+	desc->cmds[6] = (u32)virt;
+	desc->cmds[7] = ((virt >> 32) & RXD_BUF_VIRT_HI_MASK) | ((port << 29) & RXD_PORT_NUM_MASK);
+	/* Descriptor contents visible before the occupied counter */
+	wmb();
+
+	rxq->next = (rxq->next + 1) % rxq->size;
+	rxq->occ++;
+	rxq->non_occ--;
+	emu->stats.rx_pkts++;
+}
+
+static void emu_tx_desc(struct pp2_emu *emu, u32 slot, struct emu_aggr *aggr, struct pp2_ppio_desc *desc)
+{
+	u32 qid = DM_TXD_GET_DEST_QID(desc);
+	u32 len = DM_TXD_GET_BYTE_COUNT(desc);
+	u32 port = qid / MVPP2_MAX_TXQ - MVPP2_MAX_TCONT;
+	struct emu_txq *txq = &emu->txqs[qid];
+	u64 phys = DM_TXD_GET_PHYSADDR(desc);
+	u8 *data;
+
+	emu->stats.tx_descs++;
+	if (DM_TXD_GET_F(desc)) {
+		aggr->pkt_len = 0;
+		aggr->pkt_drop = 0;
+	}
+
+	if (DM_TXD_GET_ERR_SUM(desc) || !txq->size || qid < MVPP2_MAX_TCONT * MVPP2_MAX_TXQ ||
+	    port >= PP2_NUM_PORTS || aggr->pkt_len + len > EMU_MAX_PKT_SIZE) {
+		aggr->pkt_drop = 1;
+	} else if (len) {
+		data = emu_p2v(emu, phys + DM_TXD_GET_PKT_OFF(desc) + (DM_TXD_GET_PKT_OFF_EXT(desc) << 8));
+		if (data) {
+			memcpy(aggr->pkt + aggr->pkt_len, data, len);
+			aggr->pkt_len += len;
+		} else {
+			aggr->pkt_drop = 1;
+		}
+	}
+
+	/* The buffer is done with once its data has been read */
+	if (DM_TXD_GET_BUFMODE(desc) == TXD_RLS_BM)
+		emu_bm_put(emu, DM_TXD_GET_POOL_ID(desc), phys, DM_TXD_GET_VIRTADDR(desc));
+
+	/* The descriptor went through the physical TXQ, using its reservation */
+	if (txq->rsvd[slot])
+		txq->rsvd[slot]--;
+	if (txq->sent[slot] < (MVPP22_TRANSMITTED_COUNT_MASK >> MVPP22_TRANSMITTED_COUNT_OFFSET))
+		txq->sent[slot]++;
+
+	if (!DM_TXD_GET_L(desc))
+		return;
+	if (aggr->pkt_drop)
+		emu->stats.tx_drops++;
+	else
+		emu_rx(emu, port, aggr->pkt, aggr->pkt_len);
+	aggr->pkt_len = 0;
+}
+
+int pp2_emu_process(struct pp2_emu *emu, u32 budget)
+{
+	struct pp2_ppio_desc *desc;
+	struct emu_aggr *aggr;
+	u32 i, slot, done = 0;
+
+	spin_lock(&emu->lock);
+	/* Round-robin between the aggregation queues */
+	for (i = 0; i < PP2_NUM_REGSPACES && done < budget; i++) {
+		slot = (emu->next_aggr + i) % PP2_NUM_REGSPACES;
+		aggr = &emu->aggrs[slot];
+		while (aggr->pending && done < budget) {
+			desc = emu_p2v(emu, aggr->base + aggr->head * MVPP2_DESC_ALIGNED_SIZE);
+			if (unlikely(!desc)) {
+				pr_err("[%s] no mapping for aggregation queue %u\n", __func__, slot);
+				emu_aggr_reset(aggr);
+				break;
+			}
+			emu_tx_desc(emu, slot, aggr, desc);
+			aggr->head = (aggr->head + 1) % aggr->size;
+			aggr->pending--;
+			done++;
+		}
+	}
+	emu->next_aggr = (emu->next_aggr + 1) % PP2_NUM_REGSPACES;
+	spin_unlock(&emu->lock);
+
+	return done;
+}
+
+static void *emu_thread(void *arg)
+{
+	struct pp2_emu *emu = arg;
+
+	while (__atomic_load_n(&emu->thread_run, __ATOMIC_ACQUIRE)) {
+		if (!pp2_emu_process(emu, EMU_THREAD_BUDGET))
+			usleep(EMU_THREAD_IDLE_USEC);
+	}
+	return NULL;
+}
+
+/* State the kernel driver leaves the HW in before MUSDK starts: parser and
+ * C2 TCAM enabled. The C3 engine is idle, so its CPU access, counters clear
+ * and scan always read as completed.
+ */
+static void emu_regs_preset(struct pp2_emu *emu)
+{
+	EMU_REG(emu, MVPP2_PRS_TCAM_CTRL_REG) = MVPP2_PRS_TCAM_EN_MASK;
+	EMU_REG(emu, MVPP2_CLS2_TCAM_CTRL_REG) = MVPP2_CLS2_TCAM_CTRL_EN_MASK;
+	EMU_REG(emu, MVPP2_CLS3_STATE_REG) = MVPP2_CLS3_STATE_CPU_DONE_MASK | MVPP2_CLS3_STATE_CLEAR_CTR_DONE_MASK |
+					     MVPP2_CLS3_STATE_SC_DONE_MASK;
+}
+
+/***************************** API *****************************/
+
+int pp2_emu_create(struct pp2_emu_params *params, struct pp2_emu **emu)
+{
+	struct sys_iomem_params iomem_params;
+	struct pp2_emu *lemu;
+	phys_addr_t pa = 0;
+	void *va;
+	int fd, err;
+
+	if (!params || !emu)
+		return -EINVAL;
+	if (params->id >= PP2_MAX_NUM_PACKPROCS || emu_insts[params->id]) {
+		pr_err("[%s] invalid or busy PP id %u!\n", __func__, params->id);
+		return -EINVAL;
+	}
+
+	lemu = kcalloc(1, sizeof(struct pp2_emu), GFP_KERNEL);
+	if (!lemu) {
+		pr_err("[%s] no mem for emulator obj!\n", __func__);
+		return -ENOMEM;
+	}
+	lemu->id = params->id;
+	lemu->phys2virt = params->phys2virt ? params->phys2virt : mv_sys_dma_mem_phys2virt;
+	spin_lock_init(&lemu->lock);
+
+	/* Zeroed register image, shared through /dev/shm so it can be inspected */
+	snprintf(lemu->file_name, sizeof(lemu->file_name), EMU_SHM_FILE_FMT, params->id);
+	fd = open(lemu->file_name, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+	if (fd < 0) {
+		pr_err("[%s] failed to create %s (%d)!\n", __func__, lemu->file_name, errno);
+		err = -EIO;
+		goto emu_create_err1;
+	}
+	err = ftruncate(fd, EMU_SHM_SIZE);
+	close(fd);
+	if (err) {
+		pr_err("[%s] failed to size %s (%d)!\n", __func__, lemu->file_name, errno);
+		err = -EIO;
+		goto emu_create_err2;
+	}
+
+	iomem_params.type = SYS_IOMEM_T_SHMEM;
+	iomem_params.devname = lemu->file_name;
+	iomem_params.index = params->id;
+	iomem_params.size = EMU_SHM_SIZE;
+	err = sys_iomem_init(&iomem_params, &lemu->iomem);
+	if (err)
+		goto emu_create_err2;
+	err = sys_iomem_map(lemu->iomem, "pp", &pa, &va);
+	if (err)
+		goto emu_create_err3;
+	lemu->pp_va = (uintptr_t)va;
+	lemu->mspg_va = lemu->pp_va + EMU_PP_SIZE;
+	lemu->cm3_va = lemu->mspg_va + EMU_MSPG_SIZE;
+	emu_regs_preset(lemu);
+
+	emu_insts[lemu->id] = lemu;
+	__atomic_add_fetch(&pp2_emu_active, 1, __ATOMIC_RELEASE);
+
+	if (!params->no_thread) {
+		lemu->thread_run = 1;
+		err = pthread_create(&lemu->thread, NULL, emu_thread, lemu);
+		if (err) {
+			pr_err("[%s] failed to start emulator thread (%d)!\n", __func__, err);
+			lemu->thread_run = 0;
+			err = -err;
+			goto emu_create_err4;
+		}
+	}
+
+	pr_info("PP%u emulated over %s\n", lemu->id, lemu->file_name);
+	*emu = lemu;
+	return 0;
+
+emu_create_err4:
+	__atomic_sub_fetch(&pp2_emu_active, 1, __ATOMIC_RELEASE);
+	emu_insts[lemu->id] = NULL;
+	sys_iomem_unmap(lemu->iomem, "pp");
+emu_create_err3:
+	sys_iomem_deinit(lemu->iomem);
+emu_create_err2:
+	unlink(lemu->file_name);
+emu_create_err1:
+	kfree(lemu);
+	return err;
+}
+
+void pp2_emu_destroy(struct pp2_emu *emu)
+{
+	u32 i;
+
+	if (!emu)
+		return;
+
+	if (emu->thread_run) {
+		__atomic_store_n(&emu->thread_run, 0, __ATOMIC_RELEASE);
+		pthread_join(emu->thread, NULL);
+	}
+	__atomic_sub_fetch(&pp2_emu_active, 1, __ATOMIC_RELEASE);
+	emu_insts[emu->id] = NULL;
+
+	for (i = 0; i < PP2_BPOOL_NUM_POOLS; i++)
+		emu_bm_pool_stop(&emu->pools[i]);
+	sys_iomem_unmap(emu->iomem, "pp");
+	sys_iomem_deinit(emu->iomem);
+	unlink(emu->file_name);
+	kfree(emu);
+}
+
+int pp2_emu_map(struct pp2_emu *emu, const char *name, phys_addr_t *pa, uintptr_t *va)
+{
+	uintptr_t base;
+
+	if (!strcmp(name, "pp"))
+		base = emu->pp_va;
+	else if (!strcmp(name, "mspg"))
+		base = emu->mspg_va;
+	else if (!strcmp(name, "cm3"))
+		base = emu->cm3_va;
+	else
+		return -ENXIO;
+
+	*va = base;
+	*pa = EMU_PHYS_BASE + (base - emu->pp_va);
+	return 0;
+}
+
+void pp2_emu_get_stats(struct pp2_emu *emu, struct pp2_emu_stats *stats, int reset)
+{
+	spin_lock(&emu->lock);
+	*stats = emu->stats;
+	if (reset)
+		memset(&emu->stats, 0, sizeof(emu->stats));
+	spin_unlock(&emu->lock);
+}
@@ -0,0 +1,219 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+/**
+ * @file pp2_emu.h
+ *
+ * PPv2 register and ring emulator
+ *
+ * Models the parts of the packet processor that the MUSDK data path talks
+ * to, so the driver can be exercised without the HW: BM pools (release and
+ * allocate through the BM registers), aggregation queues, physical TXQs
+ * (reservation, pending and sent counters), RXQ descriptor rings with their
+ * occupied/non-occupied counters, and the TX scheduler queue-enable command.
+ *
+ * The register spaces ("pp" with its 9 CPU slots, "mspg" and "cm3") live in
+ * one /dev/shm file mapped through sys_iomem. Registers with side effects
+ * are intercepted by pp2_reg_read()/pp2_reg_write() (built with
+ * MVCONF_PP2_EMU); all other registers are plain memory.
+ *
+ * A companion thread (or pp2_emu_process() for single threaded tests) plays
+ * the role of the TX/RX engines: each descriptor sent through an
+ * aggregation queue is "transmitted", and looped back into the default RXQ
+ * of the same port (as set by mv_pp2x_cls_oversize_rxq_set()); descriptors
+ * with the error-summary bit set are dropped, which is how
+ * pp2_bpool_put_buffs() releases buffers through the loopback port.
+ * Buffers of transmitted descriptors are released to their BM pool when the
+ * descriptor asks for it.
+ *
+ * Not emulated: parser, classifier, RSS and policers (every packet goes to
+ * the port default RXQ), GOP/MAC, interrupts and HW statistics counters.
+ * Their registers are plain memory, preset to the state the kernel driver
+ * leaves the HW in, so that pp2_init() and pp2_ppio_init() complete.
+ */
+
+#ifndef _PP2_EMU_H_
+#define _PP2_EMU_H_
+
+#include "std_internal.h"
+#include "pp2_mem.h"
+
+struct pp2_emu;
+
+struct pp2_emu_params {
+	/* Packet processor ID; used to name the shared-memory file */
+	u32	id;
+	/* Translates DMA (physical) addresses found in registers and descriptors
+	 * to CPU pointers. NULL selects mv_sys_dma_mem_phys2virt().
+	 */
+	void	*(*phys2virt)(phys_addr_t pa);
+	/* Do not start the companion thread; the caller drives the emulator
+	 * with pp2_emu_process().
+	 */
+	int	no_thread;
+};
+
+struct pp2_emu_stats {
+	u64	tx_descs;	/* descriptors taken from the aggregation queues */
+	u64	tx_drops;	/* packets dropped on TX (error summary, bad TXQ) */
+	u64	rx_pkts;	/* packets written to an RXQ */
+	u64	rx_fullq_drops;	/* no free descriptor in the RXQ */
+	u64	rx_bm_drops;	/* no buffer in the RXQ pools */
+	u64	rx_no_q_drops;	/* no RXQ configured for the port */
+	u64	bm_rls;		/* buffers released to the BM */
+	u64	bm_rls_drops;	/* releases to a stopped or full pool */
+	u64	bm_allocs;	/* buffers allocated from the BM */
+};
+
+/**
+ * Create a PPv2 emulator instance
+ *
+ * The register image starts zeroed, except for the presets of the parser
+ * and classifier engines; register accesses through
+ * pp2_reg_read()/pp2_reg_write() are routed to the emulator from now on.
+ *
+ * @param	params	Emulator parameters.
+ * @param	emu	Returned emulator handle.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int pp2_emu_create(struct pp2_emu_params *params, struct pp2_emu **emu);
+
+/**
+ * Stop the companion thread, unmap and remove the register image
+ *
+ * @param	emu	Emulator handle.
+ */
+void pp2_emu_destroy(struct pp2_emu *emu);
+
+/**
+ * Get one of the emulated register spaces, as sys_iomem_map() would
+ *
+ * @param	emu	Emulator handle.
+ * @param	name	"pp", "mspg" or "cm3".
+ * @param	pa	Returned (fake) physical address of the space.
+ * @param	va	Returned virtual address of the space.
+ *
+ * @retval	0 on success
+ * @retval	-ENXIO for an unknown space
+ */
+int pp2_emu_map(struct pp2_emu *emu, const char *name, phys_addr_t *pa, uintptr_t *va);
+
+/**
+ * Run the TX/RX engines once
+ *
+ * Processes up to 'budget' descriptors pending in the aggregation queues.
+ * Called by the companion thread; may be called directly when the emulator
+ * was created with 'no_thread'.
+ *
+ * @param	emu	Emulator handle.
+ * @param	budget	Maximal number of descriptors to process.
+ *
+ * @retval	number of descriptors processed
+ */
+int pp2_emu_process(struct pp2_emu *emu, u32 budget);
+
+/**
+ * Get the emulator statistics
+ *
+ * @param	emu	Emulator handle.
+ * @param	stats	Returned statistics.
+ * @param	reset	Reset the statistics after reading them.
+ */
+void pp2_emu_get_stats(struct pp2_emu *emu, struct pp2_emu_stats *stats, int reset);
+
+#endif /* _PP2_EMU_H_ */
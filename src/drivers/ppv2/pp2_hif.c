@@ -137,7 +137,8 @@ int pp2_hif_init(struct pp2_hif_params *params, struct pp2_hif **hif)
 
 	/* Create AGGR_TXQ for each of the PPV2 instances. */
 	for (pp2_id = 0; pp2_id < pp2_ptr->num_pp2_inst; pp2_id++) {
-		rc = pp2_dm_if_init(pp2_ptr, hif_slot, pp2_id, params->out_size, params->mem);
+		rc = pp2_dm_if_init(pp2_ptr, hif_slot, pp2_id, params->out_size, params->mem,
+				    params->txq_rsrv_chunk, params->exclusive);
 		/* Rollback created instances */
 		if (rc) {
 			for (i = 0; i < pp2_id; i++)
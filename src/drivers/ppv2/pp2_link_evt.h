@@ -0,0 +1,213 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+/**
+ * @file pp2_link_evt.h
+ *
+ * Link change notification with debounce
+ *
+ * Link samples (from Linux link notifications, or from the GoP link status
+ * register for ports without a Linux netdev) are fed to a debounce filter;
+ * a change is reported once the link held the new state for the debounce
+ * period, so short flaps do not cause failover storms.
+ */
+
+#ifndef _PP2_LINK_EVT_H_
+#define _PP2_LINK_EVT_H_
+
+#include "std_internal.h"
+#include "drivers/mv_pp2_ppio.h"
+
+struct pp2_port;
+
+struct pp2_link_dbnc {
+	/* Time the link must hold a new state before it is reported */
+	u32 debounce_ms;
+	/* Last reported state */
+	int state;
+	/* Last sampled state */
+	int pending;
+	/* Time 'pending' was first sampled */
+	u64 since_ms;
+	/* Changes filtered out by the debounce */
+	u32 flaps;
+};
+
+struct pp2_link_evt {
+	struct pp2_link_dbnc dbnc;
+	struct pp2_ppio *ppio;
+	void (*cb)(void *arg, struct pp2_ppio *ppio, int link_up);
+	void *arg;
+	/* Linux link notification socket, -1 if the port has no netdev */
+	int fd;
+	int ifindex;
+};
+
+/* Sample the link state of a port without a Linux netdev. May be overridden
+ * (before including this file) by a fake register backend in tests.
+ */
+#ifndef pp2_link_evt_hw_get
+int pp2_port_link_status(struct pp2_port *port);
+
+#define pp2_link_evt_hw_get(port)	pp2_port_link_status(port)
+#endif
+
+static inline void pp2_link_dbnc_init(struct pp2_link_dbnc *dbnc, u32 debounce_ms, int link, u64 now_ms)
+{
+	dbnc->debounce_ms = debounce_ms;
+	dbnc->state = !!link;
+	dbnc->pending = dbnc->state;
+	dbnc->since_ms = now_ms;
+	dbnc->flaps = 0;
+}
+
+static inline void pp2_link_dbnc_sample(struct pp2_link_dbnc *dbnc, int link, u64 now_ms)
+{
+	link = !!link;
+	if (link == dbnc->pending)
+		return;
+	/* A change that was not reported yet got reverted */
+	if (dbnc->pending != dbnc->state)
+		dbnc->flaps++;
+	dbnc->pending = link;
+	dbnc->since_ms = now_ms;
+}
+
+/**
+ * Check whether a link change is due for notification
+ *
+ * @param[in]	dbnc		debounce filter.
+ * @param[in]	now_ms		current time.
+ * @param[out]	timeout_ms	time until a pending change is due, -1 if none.
+ *
+ * @retval	1 if the state changed; the new state is dbnc->state
+ * @retval	0 otherwise
+ */
+static inline int pp2_link_dbnc_check(struct pp2_link_dbnc *dbnc, u64 now_ms, int *timeout_ms)
+{
+	u64 elapsed;
+
+	*timeout_ms = -1;
+	if (dbnc->pending == dbnc->state)
+		return 0;
+
+	elapsed = now_ms - dbnc->since_ms;
+	if (elapsed < dbnc->debounce_ms) {
+		*timeout_ms = (int)(dbnc->debounce_ms - elapsed);
+		return 0;
+	}
+	dbnc->state = dbnc->pending;
+	return 1;
+}
+
+/* Feed a link sample and notify the change, if due */
+static inline void pp2_link_evt_update(struct pp2_link_evt *evt, int sampled, int link, u64 now_ms,
+				       int *timeout_ms)
+{
+	if (sampled)
+		pp2_link_dbnc_sample(&evt->dbnc, link, now_ms);
+	if (pp2_link_dbnc_check(&evt->dbnc, now_ms, timeout_ms) && evt->cb)
+		evt->cb(evt->arg, evt->ppio, evt->dbnc.state);
+}
+
+/* Sample the GoP link status of a port without a Linux netdev */
+static inline void pp2_link_evt_poll_hw(struct pp2_link_evt *evt, struct pp2_port *port, u64 now_ms,
+					int *timeout_ms)
+{
+	pp2_link_evt_update(evt, 1, pp2_link_evt_hw_get(port), now_ms, timeout_ms);
+}
+
+#endif /* _PP2_LINK_EVT_H_ */
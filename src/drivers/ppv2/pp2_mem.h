@@ -192,6 +192,16 @@ int pp2_sys_iounmap(pp2_maps_handle_t pp2_maps_hdl, const char *name);
  */
 void pp2_sys_iodestroy(pp2_maps_handle_t pp2_maps_hdl);
 
+#ifdef MVCONF_PP2_EMU
+/* Set while a PPv2 emulator instance exists (see pp2_emu.h); register
+ * accesses are then routed to the emulator, which falls back to plain
+ * memory accesses for addresses it does not own.
+ */
+extern int pp2_emu_active;
+void pp2_emu_reg_write(uintptr_t addr, u32 data);
+u32 pp2_emu_reg_read(uintptr_t addr);
+#endif /* MVCONF_PP2_EMU */
+
 /** Slot specific r/w access routines */
 
 /**
@@ -208,6 +218,12 @@ static inline void pp2_reg_write(uintptr_t cpu_slot, uint32_t offset,
 {
 	uintptr_t addr = cpu_slot + offset;
 
+#ifdef MVCONF_PP2_EMU
+	if (unlikely(pp2_emu_active)) {
+		pp2_emu_reg_write(addr, data);
+		return;
+	}
+#endif
 	writel(data, (void *)addr);
 }
 
@@ -225,6 +241,12 @@ static inline void pp2_relaxed_reg_write(uintptr_t cpu_slot, uint32_t offset,
 {
 	uintptr_t addr = cpu_slot + offset;
 
+#ifdef MVCONF_PP2_EMU
+	if (unlikely(pp2_emu_active)) {
+		pp2_emu_reg_write(addr, data);
+		return;
+	}
+#endif
 	writel_relaxed(data, (void *)addr);
 }
 
@@ -242,6 +264,10 @@ static inline uint32_t pp2_reg_read(uintptr_t cpu_slot, uint32_t offset)
 {
 	uintptr_t addr = cpu_slot + offset;
 
+#ifdef MVCONF_PP2_EMU
+	if (unlikely(pp2_emu_active))
+		return pp2_emu_reg_read(addr);
+#endif
 	return readl((void *)addr);
 }
 
@@ -259,6 +285,10 @@ static inline uint32_t pp2_relaxed_reg_read(uintptr_t cpu_slot, uint32_t offset)
 {
 	uintptr_t addr = cpu_slot + offset;
 
+#ifdef MVCONF_PP2_EMU
+	if (unlikely(pp2_emu_active))
+		return pp2_emu_reg_read(addr);
+#endif
 	return readl_relaxed((void *)addr);
 }
 
@@ -649,10 +649,12 @@ static void pp2_port_rxqs_fc_state_reset(struct pp2_port *port)
 
 	/* Set RXQs Flow control */
 	for (queue = 0; queue < PP2_PPIO_MAX_NUM_INQS; queue++) {
-		struct pp2_rx_queue *rxq = port->rxqs[queue];
+		struct pp2_rx_queue *rxq;
 
 		if (!(BIT(queue) & port->rxq_flow_cntrl_mask))
 			continue;
+		/* port->rxqs holds the port queues only */
+		rxq = port->rxqs[queue];
 
 		/* Clear stop and start Flow control RXQ thresholds */
 		cm3_write(base, MSS_CP_CM3_RXQ_TRESH_REG(rxq->id), 0);
@@ -988,10 +990,11 @@ static void pp2_port_rxqs_fc_state_set(struct pp2_port *port, int en)
 
 	/* Set RXQs Flow control */
 	for (queue = 0; queue < PP2_PPIO_MAX_NUM_INQS; queue++) {
-		struct pp2_rx_queue *rxq = port->rxqs[queue];
+		struct pp2_rx_queue *rxq;
 
 		if (!(BIT(queue) & port->rxq_flow_cntrl_mask))
 			continue;
+		rxq = port->rxqs[queue];
 
 		/* Set stop and start Flow control RXQ thresholds */
 		/* Set host ID */
@@ -1219,7 +1222,7 @@ pp2_port_start(struct pp2_port *port, pp2_traffic_mode t_mode) /* Open from slow
 	port->t_mode = t_mode;
 
 	/* For non-loopback port, admin_up interface in Linux. Takes care of Phy/MAC. */
-	if (NOT_LPBK_PORT(port))
+	if (PP2_LNX_PORT(port))
 		pp2_port_set_enable(port, 1);
 	mdelay(500);
 	pp2_port_start_dev(port);
@@ -1390,7 +1393,10 @@ pp2_port_open(struct pp2 *pp2, struct pp2_ppio_params *param, u8 pp2_id, u8 port
 	INIT_LIST(&port->added_uc_addr);
 
 	/* Assign linux name to port */
-	pp2_netdev_get_ifname(pp2_id, port_id, port->linux_name);
+	if (PP2_INST_EMU(inst))
+		snprintf(port->linux_name, sizeof(port->linux_name), "emu%u-%u", pp2_id, port_id);
+	else
+		pp2_netdev_get_ifname(pp2_id, port_id, port->linux_name);
 	pr_debug("pp2_port_open: pp2_id(%d), port_id(%d), port->linux_name(%s)\n", pp2_id, port_id, port->linux_name);
 
 	/* Setup port based on client params
@@ -1528,7 +1534,7 @@ pp2_port_open(struct pp2 *pp2, struct pp2_ppio_params *param, u8 pp2_id, u8 port
 	port->num_vlans = 0;
 
 	/* For MUSDK Ethernet ports, call uio_open to request port ownership from Linux */
-	if (NOT_LPBK_PORT(port) && port->type == PP2_PPIO_T_NIC) {
+	if (PP2_LNX_PORT(port) && port->type == PP2_PPIO_T_NIC) {
 		if (lnx_is_mainline(lnx_id))
 			rc = pp2_port_set_priv_flags(port, MVPP22_F_IF_MUSDK_PRIV);
 		else
@@ -1545,7 +1551,7 @@ pp2_port_open(struct pp2 *pp2, struct pp2_ppio_params *param, u8 pp2_id, u8 port
 	/* At this point, the port is default allocated and configured */
 	*port_hdl = port;
 
-	if (!(NOT_LPBK_PORT(port) && (param->type == PP2_PPIO_T_NIC)))
+	if (!(PP2_LNX_PORT(port) && (param->type == PP2_PPIO_T_NIC)))
 		return 0;
 
 	pp2_port_initialize_statistics(port);
@@ -1570,7 +1576,7 @@ pp2_port_deinit(struct pp2_port *port)
 	/* Restore rate limits and arbitration to original state */
 	pp2_port_deinit_txsched(port);
 
-	if (NOT_LPBK_PORT(port))
+	if (PP2_LNX_PORT(port))
 		pp2_port_flush_mac_addrs(port, 1, 1);
 
 	/* Reset/disable TXQs/RXQs from hardware */
@@ -1597,7 +1603,7 @@ pp2_port_stop(struct pp2_port *port)
 	pp2_port_stop_dev(port);
 
 	/* For non-loopback port, ifconfig down the interface in Linux */
-	if (NOT_LPBK_PORT(port))
+	if (PP2_LNX_PORT(port))
 		pp2_port_set_enable(port, 0);
 }
 
@@ -1616,7 +1622,7 @@ pp2_port_close(struct pp2_port *port)
 	 inst->num_ports--;
 
 	/* Close uio_device file, returns ownership to Linux */
-	if (NOT_LPBK_PORT(port) && port->type == PP2_PPIO_T_NIC) {
+	if (PP2_LNX_PORT(port) && port->type == PP2_PPIO_T_NIC) {
 		if (lnx_is_mainline(lnx_id))
 			pp2_port_set_priv_flags(port, 0);
 		else
@@ -1727,24 +1733,7 @@ uint16_t pp2_port_enqueue(struct pp2_port *port, struct pp2_dm_if *dm_if, uint8_
 		}
 	}
 	txq_dm_if = &txq->txq_dm_if[dm_if->id];
-	if (unlikely(txq_dm_if->desc_rsrvd < num_txds)) {
-		u32 req_val, result_val, res_req;
-
-		res_req = max((uint32_t)(num_txds - txq_dm_if->desc_rsrvd), (uint32_t)MVPP2_CPU_DESC_CHUNK);
-
-		req_val = ((txq->id << MVPP2_TXQ_RSVD_REQ_Q_OFFSET) | res_req);
-		pp2_relaxed_reg_write(cpu_slot, MVPP2_TXQ_RSVD_REQ_REG, req_val);
-		mb();
-		result_val = pp2_relaxed_reg_read(cpu_slot, MVPP2_TXQ_RSVD_RSLT_REG) & MVPP2_TXQ_RSVD_RSLT_MASK;
-
-		txq_dm_if->desc_rsrvd += result_val;
-
-		if (unlikely(txq_dm_if->desc_rsrvd < num_txds)) {
-			pr_debug("%s prev_desc_rsrvd(%d) desc_rsrvd(%d) res_request(%d) num_txds(%d)\n", __func__,
-				 (txq_dm_if->desc_rsrvd - result_val), txq_dm_if->desc_rsrvd, res_req, num_txds);
-			num_txds = txq_dm_if->desc_rsrvd;
-		}
-	}
+	num_txds = pp2_txq_dm_if_reserve(txq_dm_if, cpu_slot, txq->id, num_txds, dm_if->txq_rsrv_chunk);
 
 	if (pkts && to_send > num_txds) {
 		u16 curr_txds = 0;
@@ -1812,7 +1801,7 @@ uint16_t pp2_port_enqueue(struct pp2_port *port, struct pp2_dm_if *dm_if, uint8_
 
 	/* Sync reserve count with the AGGR_Q and the Physical TXQ */
 	dm_if->free_count -= num_txds;
-	txq_dm_if->desc_rsrvd -= num_txds;
+	pp2_txq_dm_if_consume(txq_dm_if, num_txds);
 
 	dm_spin_unlock(&dm_if->dm_lock);
 	return num_txds;
@@ -2011,6 +2000,37 @@ void pp2_port_set_rss(struct pp2_port *port, uint32_t en)
 	pp2_rss_enable(port, en);
 }
 
+/* Set the in-Q of an RSS table line */
+int pp2_port_set_rss_entry(struct pp2_port *port, u8 tc, u8 line, u8 qid)
+{
+	if (tc >= port->num_tcs || line >= MVPP22_RSS_TBL_LINE_NUM ||
+	    qid >= port->tc[tc].tc_config.num_in_qs) {
+		pr_err("PORT: invalid RSS entry (tc %u, line %u, in-Q %u)\n", tc, line, qid);
+		return -EINVAL;
+	}
+	if (!port->rss_en || port->tc[tc].tc_config.num_in_qs == 1) {
+		pr_err("PORT: RSS is not enabled on port %u tc %u\n", port->id, tc);
+		return -EPERM;
+	}
+
+	return pp2_rss_tbl_line_set(port, tc, line, qid);
+}
+
+/* Get the in-Q of an RSS table line */
+int pp2_port_get_rss_entry(struct pp2_port *port, u8 tc, u8 line, u8 *qid)
+{
+	if (tc >= port->num_tcs || line >= MVPP22_RSS_TBL_LINE_NUM) {
+		pr_err("PORT: invalid RSS entry (tc %u, line %u)\n", tc, line);
+		return -EINVAL;
+	}
+	if (!port->rss_en || port->tc[tc].tc_config.num_in_qs == 1) {
+		pr_err("PORT: RSS is not enabled on port %u tc %u\n", port->id, tc);
+		return -EPERM;
+	}
+
+	return pp2_rss_tbl_line_get(port, tc, line, qid);
+}
+
 /* Get link status */
 int pp2_port_link_status(struct pp2_port *port)
 {
@@ -477,6 +477,12 @@ int pp2_port_get_mac_addr(struct pp2_port *port, uint8_t *addr);
 /* Get Link State */
 int pp2_port_get_link_state(struct pp2_port *port, int  *en);
 
+/* Link change notification */
+int pp2_port_link_event_register(struct pp2_port *port, struct pp2_ppio *ppio,
+				 struct pp2_ppio_link_event_params *params, int *fd);
+int pp2_port_link_event_process(struct pp2_port *port, int *timeout);
+int pp2_port_link_event_deregister(struct pp2_port *port);
+
 /* Get Rx Pause FC status */
 int pp2_port_get_rx_pause(struct pp2_port *port, int *en);
 
@@ -516,6 +522,12 @@ int pp2_port_set_mc_promisc(struct pp2_port *port, uint32_t en);
 /* Check if Multicast promiscuous */
 int pp2_port_get_mc_promisc(struct pp2_port *port, uint32_t *en);
 
+/* Set the in-Q of an RSS table line */
+int pp2_port_set_rss_entry(struct pp2_port *port, u8 tc, u8 line, u8 qid);
+
+/* Get the in-Q of an RSS table line */
+int pp2_port_get_rss_entry(struct pp2_port *port, u8 tc, u8 line, u8 *qid);
+
 /* Set Port enable */
 int pp2_port_set_enable(struct pp2_port *port, uint32_t en);
 
@@ -579,3 +579,20 @@ int pp2_port_set_priv_flags(struct pp2_port *port, u32 val)
 
 	return err;
 }
+
+int pp2_port_link_event_register(struct pp2_port *port, struct pp2_ppio *ppio,
+				 struct pp2_ppio_link_event_params *params, int *fd)
+{
+	/* Kernel users get link changes through netdev notifiers */
+	return -EOPNOTSUPP;
+}
+
+int pp2_port_link_event_process(struct pp2_port *port, int *timeout)
+{
+	return -EOPNOTSUPP;
+}
+
+int pp2_port_link_event_deregister(struct pp2_port *port)
+{
+	return -EOPNOTSUPP;
+}
@@ -100,6 +100,10 @@
  * Port I/O routines - user space specific
  */
 
+#include <time.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
 #include "std_internal.h"
 
 #include "pp2_types.h"
@@ -113,6 +117,7 @@
 #include "cls/pp2_hw_cls.h"
 #include "cls/pp2_prs.h"
 #include "lib/uio_helper.h"
+#include "pp2_link_evt.h"
 
 /* Port Control routines */
 static int parse_hex(char *str, u8 *addr, size_t size)
@@ -191,6 +196,164 @@ int pp2_port_get_link_state(struct pp2_port *port, int  *en)
 	return 0;
 }
 
+static u64 pp2_port_link_event_now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Open a socket receiving the Linux link notifications */
+static int pp2_port_link_event_open(struct pp2_port *port, struct pp2_link_evt *evt)
+{
+	struct sockaddr_nl addr;
+	struct ifreq s;
+	int rc;
+
+	strcpy(s.ifr_name, port->linux_name);
+	rc = mv_netdev_ioctl(SIOCGIFINDEX, &s);
+	if (rc)
+		return rc;
+	evt->ifindex = s.ifr_ifindex;
+
+	evt->fd = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+	if (evt->fd < 0) {
+		pr_err("PORT: can't open netlink socket: errno %d\n", errno);
+		return -EFAULT;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.nl_family = AF_NETLINK;
+	addr.nl_groups = RTMGRP_LINK;
+	if (bind(evt->fd, (struct sockaddr *)&addr, sizeof(addr))) {
+		pr_err("PORT: can't bind netlink socket: errno %d\n", errno);
+		close(evt->fd);
+		evt->fd = -1;
+		return -EFAULT;
+	}
+	return 0;
+}
+
+/* Drain the pending Linux link notifications into the debounce filter */
+static int pp2_port_link_event_read(struct pp2_port *port, struct pp2_link_evt *evt, u64 now_ms)
+{
+	u32 buf[1024];
+	struct nlmsghdr *nlh;
+	struct ifinfomsg *ifi;
+	ssize_t len;
+	int link, rc;
+
+	while ((len = recv(evt->fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+		for (nlh = (struct nlmsghdr *)buf; NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
+			if (nlh->nlmsg_type != RTM_NEWLINK && nlh->nlmsg_type != RTM_DELLINK)
+				continue;
+			ifi = NLMSG_DATA(nlh);
+			if (ifi->ifi_index != evt->ifindex)
+				continue;
+			link = (nlh->nlmsg_type == RTM_NEWLINK) && (ifi->ifi_flags & IFF_RUNNING);
+			pp2_link_dbnc_sample(&evt->dbnc, link, now_ms);
+		}
+	}
+	if (len == 0 || errno == EAGAIN || errno == EWOULDBLOCK)
+		return 0;
+
+	if (errno != ENOBUFS) {
+		pr_err("PORT: netlink receive failed: errno %d\n", errno);
+		return -EFAULT;
+	}
+	/* Notifications were lost: resync with the current state */
+	rc = pp2_port_get_link_state(port, &link);
+	if (rc)
+		return rc;
+	pp2_link_dbnc_sample(&evt->dbnc, link, now_ms);
+	return 0;
+}
+
+int pp2_port_link_event_register(struct pp2_port *port, struct pp2_ppio *ppio,
+				 struct pp2_ppio_link_event_params *params, int *fd)
+{
+	struct pp2_link_evt *evt;
+	int link = 1, rc;
+
+	if (port->link_evt) {
+		pr_err("PORT: link notification already registered on port %u\n", port->id);
+		return -EEXIST;
+	}
+
+	evt = kcalloc(1, sizeof(struct pp2_link_evt), GFP_KERNEL);
+	if (!evt)
+		return -ENOMEM;
+	evt->ppio = ppio;
+	evt->cb = params->cb;
+	evt->arg = params->arg;
+	evt->fd = -1;
+
+	/* The initial state is read once the socket is open, so no change is missed */
+	if (PP2_LNX_PORT(port)) {
+		rc = pp2_port_link_event_open(port, evt);
+		if (!rc)
+			rc = pp2_port_get_link_state(port, &link);
+		if (rc) {
+			if (evt->fd >= 0)
+				close(evt->fd);
+			kfree(evt);
+			return rc;
+		}
+	} else if (NOT_LPBK_PORT(port)) {
+		link = pp2_link_evt_hw_get(port);
+	}
+
+	pp2_link_dbnc_init(&evt->dbnc, params->debounce_ms, link, pp2_port_link_event_now_ms());
+	port->link_evt = evt;
+	*fd = evt->fd;
+	return 0;
+}
+
+int pp2_port_link_event_process(struct pp2_port *port, int *timeout)
+{
+	struct pp2_link_evt *evt = port->link_evt;
+	int ltimeout, rc;
+	u64 now_ms;
+
+	if (!evt) {
+		pr_err("PORT: no link notification registered on port %u\n", port->id);
+		return -EINVAL;
+	}
+	if (!timeout)
+		timeout = &ltimeout;
+
+	now_ms = pp2_port_link_event_now_ms();
+	if (evt->fd >= 0) {
+		rc = pp2_port_link_event_read(port, evt, now_ms);
+		if (rc)
+			return rc;
+		pp2_link_evt_update(evt, 0, 0, now_ms, timeout);
+	} else if (NOT_LPBK_PORT(port)) {
+		pp2_link_evt_poll_hw(evt, port, now_ms, timeout);
+	} else {
+		/* Loopback port link is always up */
+		*timeout = -1;
+	}
+	return 0;
+}
+
+int pp2_port_link_event_deregister(struct pp2_port *port)
+{
+	struct pp2_link_evt *evt = port->link_evt;
+
+	if (!evt)
+		return -EINVAL;
+
+	if (evt->fd >= 0)
+		close(evt->fd);
+	if (evt->dbnc.flaps)
+		pr_debug("PORT: port %u link flaps filtered: %u\n", port->id, evt->dbnc.flaps);
+	kfree(evt);
+	port->link_evt = NULL;
+	return 0;
+}
+
 /* Get Rx Pause FC status */
 int pp2_port_get_rx_pause(struct pp2_port *port, int *en)
 {
@@ -101,6 +101,7 @@
 #include "pp2.h"
 #include "pp2_port.h"
 #include "lib/lib_misc.h"
+#include "lib/mv_json.h"
 #include "cls/pp2_cls_mng.h"
 
 static inline struct pp2_dm_if *pp2_dm_if_get(struct pp2_ppio *ppio, struct pp2_hif *hif)
@@ -200,6 +201,8 @@ void pp2_ppio_deinit(struct pp2_ppio *ppio)
 	port_ptr = GET_PPIO_PORT_PTR(*ppio);
 
 	if (*port_ptr) {
+		if ((*port_ptr)->link_evt)
+			pp2_port_link_event_deregister(*port_ptr);
 		if (pp2_cls_mng_modify_default_flows(ppio, true))
 			pr_err("[%s] ppio deinit failed while default flows\n", __func__);
 
@@ -519,6 +522,83 @@ int pp2_ppio_recv(struct pp2_ppio *ppio, u8 tc, u8 qid, struct pp2_ppio_desc *de
 	return 0;
 }
 
+int pp2_ppio_recv_peek(struct pp2_ppio *ppio, u8 tc, u8 qid, struct pp2_ppio_desc **descs, u16 *num)
+{
+#if __BYTE_ORDER == __BIG_ENDIAN
+	/* in-ring descriptors are little-endian */
+	return -EOPNOTSUPP;
+#else
+	struct pp2_port *port = GET_PPIO_PORT(ppio);
+	struct pp2_rx_queue *rxq;
+	u32 recv_req = *num, to_end;
+
+	rxq = port->rxqs[port->tc[tc].first_log_rxq + qid];
+
+	if (recv_req > rxq->desc_received) {
+		rxq->desc_received = pp2_rxq_received(port, rxq->id);
+		if (unlikely(recv_req > rxq->desc_received))
+			recv_req = rxq->desc_received;
+	}
+
+	/* only return the contiguous part; the rest follows after the release */
+	to_end = rxq->desc_total - rxq->desc_next_idx;
+	if (unlikely(recv_req > to_end))
+		recv_req = to_end;
+
+	*descs = (struct pp2_ppio_desc *)(rxq->desc_virt_arr + rxq->desc_next_idx);
+	*num = recv_req;
+	return 0;
+#endif
+}
+
+int pp2_ppio_recv_release(struct pp2_ppio *ppio, u8 tc, u8 qid, u16 num)
+{
+	struct pp2_port *port = GET_PPIO_PORT(ppio);
+	struct pp2_rx_queue *rxq;
+	u32 next_idx;
+	int log_rxq;
+
+	log_rxq = port->tc[tc].first_log_rxq + qid;
+	rxq = port->rxqs[log_rxq];
+
+	if (unlikely(num > rxq->desc_received)) {
+		pr_err("[%s] releasing %u descriptors, only %u received\n", __func__, num, rxq->desc_received);
+		return -EINVAL;
+	}
+	if (!num)
+		return 0;
+
+	next_idx = rxq->desc_next_idx + num;
+	if (next_idx >= rxq->desc_total)
+		next_idx -= rxq->desc_total;
+	rxq->desc_next_idx = next_idx;
+
+	/*  Update HW */
+	pp2_port_inq_update(port, log_rxq, num, num);
+	rxq->desc_received -= num;
+
+	if (port->maintain_stats) {
+		rxq->threshold_rx_pkts += num;
+		if (unlikely(rxq->threshold_rx_pkts > PP2_STAT_UPDATE_THRESHOLD)) {
+			pp2_ppio_inq_get_statistics(ppio, tc, qid, NULL, 0);
+			rxq->threshold_rx_pkts = 0;
+		}
+	}
+	return 0;
+}
+
+int pp2_ppio_get_num_inq_descs(struct pp2_ppio *ppio, u8 tc, u8 qid, u16 *num)
+{
+	struct pp2_port *port = GET_PPIO_PORT(ppio);
+
+	if (tc >= port->num_tcs || qid >= port->tc[tc].tc_config.num_in_qs) {
+		pr_err("[%s] invalid in-Q (tc %u, qid %u)\n", __func__, tc, qid);
+		return -EINVAL;
+	}
+	*num = pp2_rxq_received(port, port->rxqs[port->tc[tc].first_log_rxq + qid]->id);
+	return 0;
+}
+
 int pp2_ppio_set_mac_addr(struct pp2_ppio *ppio, const eth_addr_t addr)
 {
 	int rc;
@@ -612,6 +692,16 @@ int pp2_ppio_get_mc_promisc(struct pp2_ppio *ppio, int *en)
 	return rc;
 }
 
+int pp2_ppio_set_rss_entry(struct pp2_ppio *ppio, u8 tc, u8 line, u8 qid)
+{
+	return pp2_port_set_rss_entry(GET_PPIO_PORT(ppio), tc, line, qid);
+}
+
+int pp2_ppio_get_rss_entry(struct pp2_ppio *ppio, u8 tc, u8 line, u8 *qid)
+{
+	return pp2_port_get_rss_entry(GET_PPIO_PORT(ppio), tc, line, qid);
+}
+
 int pp2_ppio_add_mac_addr(struct pp2_ppio *ppio, const eth_addr_t addr)
 {
 	int rc;
@@ -665,6 +755,24 @@ int pp2_ppio_get_link_info(struct pp2_ppio *ppio, struct pp2_ppio_link_info *lin
 	return rc;
 }
 
+int pp2_ppio_link_event_register(struct pp2_ppio *ppio, struct pp2_ppio_link_event_params *params, int *fd)
+{
+	if (!params || !params->cb || !fd)
+		return -EINVAL;
+
+	return pp2_port_link_event_register(GET_PPIO_PORT(ppio), ppio, params, fd);
+}
+
+int pp2_ppio_link_event_process(struct pp2_ppio *ppio, int *timeout)
+{
+	return pp2_port_link_event_process(GET_PPIO_PORT(ppio), timeout);
+}
+
+int pp2_ppio_link_event_deregister(struct pp2_ppio *ppio)
+{
+	return pp2_port_link_event_deregister(GET_PPIO_PORT(ppio));
+}
+
 int pp2_ppio_set_rx_pause(struct pp2_ppio *ppio, int en)
 {
 	int rc;
@@ -997,98 +1105,92 @@ int pp2_ppio_serialize(struct pp2_ppio *ppio, char buff[], u32 size)
 	return pos;
 }
 
-static int pp2_ppio_probe_tc_params(char *buff, struct pp2_ppio *ppio)
+/* Read a member whose key carries a queue index (e.g. "log_id-3") */
+#define pp2_ppio_probe_get_idx(json, sec, key, idx, _p)				\
+({										\
+	char __key[PP2_MAX_BUF_STR_LEN];					\
+										\
+	snprintf(__key, sizeof(__key), "%s-%d", key, idx);			\
+	mv_json_obj_get_num(json, sec, __key, _p);				\
+})
+
+static int pp2_ppio_probe_tc_params(const struct mv_json *json, int sec, struct pp2_ppio *ppio)
 {
 	int			 i, j, k, rc;
+	int			 tc_sec, bp_sec;
 	char			 tmp_buf[PP2_MAX_BUF_STR_LEN];
-	u32			 mem_id = 0;
-	u32			 cluster_id = 0;
-	u32			 tmp_pp2_id = 0;
-	u32			 tmp_bpool_id = 0;
 	u32			 num_bps = 0;
 	struct pp2_bpool	*param_pools[MV_SYS_DMA_MAX_NUM_MEM_ID][PP2_PPIO_TC_CLUSTER_MAX_POOLS];
+	struct pp2_bpool	*bpool;
 	struct pp2_port		*port;
 	struct pp2_inst		*inst;
-	char			*lbuff;
-	char			*sec = NULL;
-
-	lbuff = kcalloc(1, strlen(buff), GFP_KERNEL);
-	if (lbuff == NULL)
-		return -ENOMEM;
-
-	memcpy(lbuff, buff, strlen(buff));
-	sec = lbuff;
 
 	inst = pp2_ptr->pp2_inst[ppio->pp2_id];
-	/* extract the loopback info */
-	port = pp2_ptr->pp2_inst[ppio->pp2_id]->ports[ppio->port_id];
+	port = inst->ports[ppio->port_id];
 
+	memset(param_pools, 0, sizeof(param_pools));
 	for (i = 0; i < port->num_tcs; i++) {
-
 		/* Search for the ppio-port-tc section */
-		memset(tmp_buf, 0, sizeof(tmp_buf));
 		snprintf(tmp_buf, sizeof(tmp_buf), "ppio-port-tc-%d", i);
-		sec = strstr(sec, tmp_buf);
-		if (!sec) {
-			pr_err("'ppio-port-tc-%d' not found\n", i);
-			kfree(lbuff);
+		tc_sec = mv_json_find(json, sec, tmp_buf);
+		if (tc_sec < 0) {
+			pr_err("'%s' not found\n", tmp_buf);
 			return -EINVAL;
 		}
 
 		/* get the TC specific parameters */
-		json_buffer_to_input(sec, "first_log_rxq", port->tc[i].first_log_rxq);
-		json_buffer_to_input(sec, "num_in_qs", port->tc[i].tc_config.num_in_qs);
-		if (!port->tc[i].tc_config.num_in_qs || port->tc[i].tc_config.num_in_qs > PP2_PPIO_MAX_NUM_INQS) {
-			pr_err("invalid num_in_qs\n");
-			kfree(lbuff);
+		if (mv_json_obj_get_num(json, tc_sec, "first_log_rxq", port->tc[i].first_log_rxq) ||
+		    mv_json_obj_get_num(json, tc_sec, "num_in_qs", port->tc[i].tc_config.num_in_qs) ||
+		    !port->tc[i].tc_config.num_in_qs || port->tc[i].tc_config.num_in_qs > PP2_PPIO_MAX_NUM_INQS) {
+			pr_err("%s: invalid num_in_qs\n", tmp_buf);
 			return -EINVAL;
 		}
 
 		for (j = 0; j < port->tc[i].tc_config.num_in_qs; j++) {
-			json_buffer_to_input(sec, "ring_size", port->tc[i].rx_qs[j].ring_size);
-			json_buffer_to_input(sec, "tc_pools_mem_id_index", port->tc[i].rx_qs[j].tc_pools_mem_id_index);
-			if (port->tc[i].rx_qs[j].tc_pools_mem_id_index < 0 ||
+			if (pp2_ppio_probe_get_idx(json, tc_sec, "ring_size", j, port->tc[i].rx_qs[j].ring_size) ||
+			    pp2_ppio_probe_get_idx(json, tc_sec, "tc_pools_mem_id_index", j,
+						   port->tc[i].rx_qs[j].tc_pools_mem_id_index) ||
 			    port->tc[i].rx_qs[j].tc_pools_mem_id_index >= MV_SYS_DMA_MAX_NUM_MEM_ID) {
-				pr_err("invalid tc_pools_mem_id_index\n");
-				kfree(lbuff);
+				pr_err("%s: invalid ring_size/tc_pools_mem_id_index of rxq %d\n", tmp_buf, j);
 				return -EINVAL;
 			}
 		}
 
-		json_buffer_to_input(sec, "pkt_offset", port->tc[i].tc_config.pkt_offset);
-		json_buffer_to_input(sec, "first_rxq", port->tc[i].tc_config.first_rxq);
-		json_buffer_to_input(sec, "num_bpools", num_bps);
-
-		memset(param_pools, 0, sizeof(param_pools));
-		for (j = 0; j < num_bps; j++) {
-			/* get the bpool parameters */
-			json_buffer_to_input(sec, "mem_id", mem_id);
-			if (mem_id < 0 || mem_id >= MV_SYS_DMA_MAX_NUM_MEM_ID) {
-				pr_err("invalid mem_id\n");
-				kfree(lbuff);
-				return -EINVAL;
-			}
-
-			json_buffer_to_input(sec, "cluster_id", cluster_id);
-			if (cluster_id < 0 || cluster_id >= PP2_PPIO_TC_CLUSTER_MAX_POOLS) {
-				pr_err("invalid cluster_id\n");
-				kfree(lbuff);
-				return -EINVAL;
-			}
-
-			json_buffer_to_input(sec, "pp2_id", tmp_pp2_id);
-			json_buffer_to_input(sec, "bm_pool_id", tmp_bpool_id);
+		if (mv_json_obj_get_num(json, tc_sec, "pkt_offset", port->tc[i].tc_config.pkt_offset) ||
+		    mv_json_obj_get_num(json, tc_sec, "first_rxq", port->tc[i].tc_config.first_rxq) ||
+		    mv_json_obj_get_num(json, tc_sec, "num_bpools", num_bps)) {
+			pr_err("%s: invalid parameters\n", tmp_buf);
+			return -EINVAL;
+		}
 
-			param_pools[mem_id][cluster_id] = kcalloc(1, sizeof(struct pp2_bpool), GFP_KERNEL);
-			if (unlikely(!port->txqs)) {
-				pr_err("%s out of memory txqs alloc\n", __func__);
-				num_bps = j;
-				rc = -ENOMEM;
-				goto probe_tc_error;
+		/* the bpool sections are named after their slot: "tc-<tc>-bpool-<mem_id>:<cluster_id>" */
+		for (j = 0; j < MV_SYS_DMA_MAX_NUM_MEM_ID; j++) {
+			for (k = 0; k < PP2_PPIO_TC_CLUSTER_MAX_POOLS; k++) {
+				snprintf(tmp_buf, sizeof(tmp_buf), "tc-%d-bpool-%d:%d", i, j, k);
+				bp_sec = mv_json_find(json, tc_sec, tmp_buf);
+				if (bp_sec < 0)
+					continue;
+
+				bpool = kcalloc(1, sizeof(struct pp2_bpool), GFP_KERNEL);
+				if (unlikely(!bpool)) {
+					pr_err("%s out of memory bpool alloc\n", __func__);
+					rc = -ENOMEM;
+					goto probe_tc_error;
+				}
+				param_pools[j][k] = bpool;
+				if (mv_json_obj_get_num(json, bp_sec, "pp2_id", bpool->pp2_id) ||
+				    mv_json_obj_get_num(json, bp_sec, "bm_pool_id", bpool->id)) {
+					pr_err("%s: invalid parameters\n", tmp_buf);
+					rc = -EINVAL;
+					goto probe_tc_error;
+				}
+				num_bps--;
 			}
-			memset(param_pools[mem_id][cluster_id], 0, sizeof(struct pp2_bpool));
-			param_pools[mem_id][cluster_id]->pp2_id = tmp_pp2_id;
-			param_pools[mem_id][cluster_id]->id = tmp_bpool_id;
+		}
+		if (num_bps) {
+			pr_err("ppio-port-tc-%d: bpool sections do not match num_bpools\n", i);
+			rc = -EINVAL;
+			goto probe_tc_error;
 		}
 
 		if (populate_tc_pools(inst, param_pools, port->tc[i].tc_config.pools) != 0) {
@@ -1097,15 +1199,15 @@ static int pp2_ppio_probe_tc_params(char *buff, struct pp2_ppio *ppio)
 			goto probe_tc_error;
 		}
 		for (j = 0; j < MV_SYS_DMA_MAX_NUM_MEM_ID; j++) {
-			for (k = 0; k < PP2_PPIO_TC_CLUSTER_MAX_POOLS; k++)
+			for (k = 0; k < PP2_PPIO_TC_CLUSTER_MAX_POOLS; k++) {
 				kfree(param_pools[j][k]);
+				param_pools[j][k] = NULL;
+			}
 		}
 	}
-	kfree(lbuff);
 	return 0;
 
 probe_tc_error:
-	kfree(lbuff);
 	for (j = 0; j < MV_SYS_DMA_MAX_NUM_MEM_ID; j++) {
 		for (k = 0; k < PP2_PPIO_TC_CLUSTER_MAX_POOLS; k++)
 			kfree(param_pools[j][k]);
@@ -1113,119 +1215,95 @@ probe_tc_error:
 	return rc;
 }
 
-static int pp2_ppio_probe_rxq_params(char *buff, struct pp2_port *port, phys_addr_t paddr, uintptr_t va)
+static int pp2_ppio_probe_rxq_params(const struct mv_json *json, int sec, struct pp2_port *port,
+				     phys_addr_t paddr, uintptr_t va)
 {
-	int		 i;
+	int		 i, q_sec;
 	phys_addr_t	 poffset = 0;
 	char		 tmp_buf[PP2_MAX_BUF_STR_LEN];
-	char		*lbuff;
-	char		*sec = NULL;
-
-	lbuff = kcalloc(1, strlen(buff), GFP_KERNEL);
-	if (lbuff == NULL)
-		return -ENOMEM;
-
-	memcpy(lbuff, buff, strlen(buff));
-	sec = lbuff;
 
 	for (i = 0; i < port->num_rx_queues; i++) {
 		/* Search for the ppio-port-rxq section */
-		memset(tmp_buf, 0, sizeof(tmp_buf));
 		snprintf(tmp_buf, sizeof(tmp_buf), "ppio-port-rxq-%d", i);
-		sec = strstr(sec, tmp_buf);
-		if (!sec) {
-			pr_err("'ppio-port-rxq-%d' not found\n", i);
-			kfree(lbuff);
+		q_sec = mv_json_find(json, sec, tmp_buf);
+		if (q_sec < 0) {
+			pr_err("'%s' not found\n", tmp_buf);
 			return -EINVAL;
 		}
 
 		/* get the rxq parameters */
-		json_buffer_to_input(sec, "id", port->rxqs[i]->id);
-		json_buffer_to_input(sec, "log_id", port->rxqs[i]->log_id);
-		json_buffer_to_input(sec, "desc_total", port->rxqs[i]->desc_total);
-		json_buffer_to_input(sec, "rxq_lock", port->rxqs[i]->rxq_lock);
-		json_buffer_to_input(sec, "threshold_rx_pkts", port->rxqs[i]->threshold_rx_pkts);
-		json_buffer_to_input(sec, "desc_phys_offset", poffset);
+		if (pp2_ppio_probe_get_idx(json, q_sec, "id", i, port->rxqs[i]->id) ||
+		    pp2_ppio_probe_get_idx(json, q_sec, "log_id", i, port->rxqs[i]->log_id) ||
+		    pp2_ppio_probe_get_idx(json, q_sec, "desc_total", i, port->rxqs[i]->desc_total) ||
+		    pp2_ppio_probe_get_idx(json, q_sec, "rxq_lock", i, port->rxqs[i]->rxq_lock) ||
+		    pp2_ppio_probe_get_idx(json, q_sec, "threshold_rx_pkts", i, port->rxqs[i]->threshold_rx_pkts) ||
+		    pp2_ppio_probe_get_idx(json, q_sec, "desc_phys_offset", i, poffset)) {
+			pr_err("%s: invalid parameters\n", tmp_buf);
+			return -EINVAL;
+		}
 
 		port->rxqs[i]->desc_phys_arr = paddr + poffset;
 		port->rxqs[i]->desc_virt_arr = (struct pp2_desc *)(uintptr_t)((phys_addr_t)va + poffset);
 	}
-	kfree(lbuff);
 	return 0;
 }
 
-static int pp2_ppio_probe_txq_params(char *buff, struct pp2_port *port, phys_addr_t paddr, uintptr_t va)
+/* Read the "<prefix>-txq_config-x" and "<prefix>-txq-x" sections of a port */
+static int pp2_ppio_probe_txqs(const struct mv_json *json, int sec, const char *prefix,
+			       struct pp2_port *port, phys_addr_t paddr, uintptr_t va)
 {
-	int		 i;
+	int		 i, q_sec;
 	phys_addr_t	 poffset = 0;
 	char		 tmp_buf[PP2_MAX_BUF_STR_LEN];
-	char		*lbuff;
-	char		*sec = NULL;
-
-	lbuff = kcalloc(1, strlen(buff), GFP_KERNEL);
-	if (lbuff == NULL)
-		return -ENOMEM;
-
-	memcpy(lbuff, buff, strlen(buff));
-	sec = lbuff;
 
 	for (i = 0; i < port->num_tx_queues; i++) {
-		/* Search for the ppio-port-txq_config section */
-		memset(tmp_buf, 0, sizeof(tmp_buf));
-		snprintf(tmp_buf, sizeof(tmp_buf), "ppio-port-txq_config-%d", i);
-		sec = strstr(sec, tmp_buf);
-		if (!sec) {
-			pr_err("'ppio-port-txq_config-%d' not found\n", i);
-			kfree(lbuff);
+		/* Search for the txq_config section */
+		snprintf(tmp_buf, sizeof(tmp_buf), "%s-txq_config-%d", prefix, i);
+		q_sec = mv_json_find(json, sec, tmp_buf);
+		if (q_sec < 0) {
+			pr_err("'%s' not found\n", tmp_buf);
 			return -EINVAL;
 		}
 
 		/* get the txq_config parameters */
-		json_buffer_to_input(sec, "size", port->txq_config[i].size);
-		json_buffer_to_input(sec, "weight", port->txq_config[i].weight);
+		if (mv_json_obj_get_num(json, q_sec, "size", port->txq_config[i].size) ||
+		    mv_json_obj_get_num(json, q_sec, "weight", port->txq_config[i].weight)) {
+			pr_err("%s: invalid parameters\n", tmp_buf);
+			return -EINVAL;
+		}
 	}
 
 	for (i = 0; i < port->num_tx_queues; i++) {
-		/* Search for the ppio-port-txq section */
-		memset(tmp_buf, 0, sizeof(tmp_buf));
-		snprintf(tmp_buf, sizeof(tmp_buf), "ppio-port-txq-%d", i);
-		sec = strstr(sec, tmp_buf);
-		if (!sec) {
-			pr_err("'port-info' not found\n");
-			kfree(lbuff);
+		/* Search for the txq section */
+		snprintf(tmp_buf, sizeof(tmp_buf), "%s-txq-%d", prefix, i);
+		q_sec = mv_json_find(json, sec, tmp_buf);
+		if (q_sec < 0) {
+			pr_err("'%s' not found\n", tmp_buf);
 			return -EINVAL;
 		}
 
 		/* get the txq parameters */
-		json_buffer_to_input(sec, "id", port->txqs[i]->id);
-		json_buffer_to_input(sec, "log_id", port->txqs[i]->log_id);
-		json_buffer_to_input(sec, "desc_total", port->txqs[i]->desc_total);
-		json_buffer_to_input(sec, "threshold_tx_pkts", port->txqs[i]->threshold_tx_pkts);
-		json_buffer_to_input(sec, "desc_phys_offset", poffset);
+		if (pp2_ppio_probe_get_idx(json, q_sec, "id", i, port->txqs[i]->id) ||
+		    pp2_ppio_probe_get_idx(json, q_sec, "log_id", i, port->txqs[i]->log_id) ||
+		    pp2_ppio_probe_get_idx(json, q_sec, "desc_total", i, port->txqs[i]->desc_total) ||
+		    pp2_ppio_probe_get_idx(json, q_sec, "threshold_tx_pkts", i, port->txqs[i]->threshold_tx_pkts) ||
+		    pp2_ppio_probe_get_idx(json, q_sec, "desc_phys_offset", i, poffset)) {
+			pr_err("%s: invalid parameters\n", tmp_buf);
+			return -EINVAL;
+		}
 
 		port->txqs[i]->desc_phys_arr = paddr + poffset;
 		port->txqs[i]->desc_virt_arr = (struct pp2_desc *)(uintptr_t)((phys_addr_t)va + poffset);
 	}
-	kfree(lbuff);
 	return 0;
 }
 
-static int pp2_ppio_probe_loopback_port(char *buff, struct pp2_ppio *ppio, phys_addr_t paddr, uintptr_t va)
+static int pp2_ppio_probe_loopback_port(const struct mv_json *json, int sec, struct pp2_ppio *ppio,
+					phys_addr_t paddr, uintptr_t va)
 {
-	int			i;
-	phys_addr_t		poffset = 0;
 	struct pp2_port		*lb_port = NULL;
 	struct pp2_inst		*inst;
-	char			tmp_buf[PP2_MAX_BUF_STR_LEN];
-	char			*lbuff;
-	char			*sec = NULL;
-
-	lbuff = kcalloc(1, strlen(buff), GFP_KERNEL);
-	if (lbuff == NULL)
-		return -ENOMEM;
-
-	memcpy(lbuff, buff, strlen(buff));
-	sec = lbuff;
+	int			 lb_sec;
 
 	inst = pp2_ptr->pp2_inst[ppio->pp2_id];
 
@@ -1235,25 +1313,22 @@ static int pp2_ppio_probe_loopback_port(char *buff, struct pp2_ppio *ppio, phys_
 	memset(lb_port, 0, sizeof(struct pp2_port));
 	lb_port->parent = inst;
 
-	sec = strstr(sec, "port-lb-info");
-	if (!sec) {
-		pr_err("'port-loopback-info' not found\n");
-		kfree(lbuff);
+	lb_sec = mv_json_find(json, sec, "port-lb-info");
+	if (lb_sec < 0) {
+		pr_err("'port-lb-info' not found\n");
 		return -EINVAL;
 	}
 
-	json_buffer_to_input(sec, "id", lb_port->id);
-	json_buffer_to_input(sec, "type", lb_port->type);
-	if (lb_port->type < PP2_PPIO_T_LOG || lb_port->type > PP2_PPIO_T_NIC) {
+	if (mv_json_obj_get_num(json, lb_sec, "id", lb_port->id) ||
+	    mv_json_obj_get_num(json, lb_sec, "type", lb_port->type) ||
+	    lb_port->type < PP2_PPIO_T_LOG || lb_port->type > PP2_PPIO_T_NIC) {
 		pr_err("invalid port type\n");
-		kfree(lbuff);
 		return -EINVAL;
 	}
 
-	json_buffer_to_input(sec, "num_tx_queues", lb_port->num_tx_queues);
-	if (!lb_port->num_tx_queues || lb_port->num_tx_queues > PP2_PPIO_MAX_NUM_OUTQS) {
+	if (mv_json_obj_get_num(json, lb_sec, "num_tx_queues", lb_port->num_tx_queues) ||
+	    !lb_port->num_tx_queues || lb_port->num_tx_queues > PP2_PPIO_MAX_NUM_OUTQS) {
 		pr_err("invalid num_tx_queues\n");
-		kfree(lbuff);
 		return -EINVAL;
 	}
 
@@ -1261,7 +1336,6 @@ static int pp2_ppio_probe_loopback_port(char *buff, struct pp2_ppio *ppio, phys_
 	lb_port->txqs = kcalloc(1, sizeof(struct pp2_tx_queue *) * lb_port->num_tx_queues, GFP_KERNEL);
 	if (unlikely(!lb_port->txqs)) {
 		pr_err("%s out of memory txqs alloc\n", __func__);
-		kfree(lbuff);
 		return -ENOMEM;
 	}
 	memset(lb_port->txqs, 0, sizeof(struct pp2_tx_queue *) * lb_port->num_tx_queues);
@@ -1269,44 +1343,14 @@ static int pp2_ppio_probe_loopback_port(char *buff, struct pp2_ppio *ppio, phys_
 	/* Allocate and associated TXQs to this port */
 	pp2_port_txqs_create(lb_port);
 
-	for (i = 0; i < lb_port->num_tx_queues; i++) {
-		memset(tmp_buf, 0, sizeof(tmp_buf));
-		snprintf(tmp_buf, sizeof(tmp_buf), "lb-port-txq_config-%d", i);
-		sec = strstr(sec, tmp_buf);
-		if (!sec) {
-			pr_err("'port-info' not found\n");
-			kfree(lbuff);
-			return -EINVAL;
-		}
-		json_buffer_to_input(sec, "size", lb_port->txq_config[i].size);
-		json_buffer_to_input(sec, "weight", lb_port->txq_config[i].weight);
-	}
-	for (i = 0; i < lb_port->num_tx_queues; i++) {
-		memset(tmp_buf, 0, sizeof(tmp_buf));
-		snprintf(tmp_buf, sizeof(tmp_buf), "lb-port-txq-%d", i);
-		sec = strstr(sec, tmp_buf);
-		if (!sec) {
-			pr_err("'port-info' not found\n");
-			kfree(lbuff);
-			return -EINVAL;
-		}
-		json_buffer_to_input(sec, "id", lb_port->txqs[i]->id);
-		json_buffer_to_input(sec, "log_id", lb_port->txqs[i]->log_id);
-		json_buffer_to_input(sec, "desc_total", lb_port->txqs[i]->desc_total);
-		json_buffer_to_input(sec, "threshold_tx_pkts", lb_port->txqs[i]->threshold_tx_pkts);
-		json_buffer_to_input(sec, "desc_phys_offset", poffset);
-
-		lb_port->txqs[i]->desc_phys_arr = paddr + poffset;
-		lb_port->txqs[i]->desc_virt_arr = (struct pp2_desc *)(uintptr_t)((phys_addr_t)va + poffset);
-	}
-	kfree(lbuff);
-	return 0;
+	return pp2_ppio_probe_txqs(json, lb_sec, "lb-port", lb_port, paddr, va);
 }
 
 int pp2_ppio_probe(char *match, char *buff, struct pp2_ppio **ppio_hdl)
 {
 	int				 rc;
-	char				*sec = NULL;
+	int				 info_sec, sec, port_sec, mac_sec;
+	struct mv_json			 json;
 	phys_addr_t			 paddr;
 	struct sys_iomem_params		 iomem_params;
 	struct sys_iomem_info		sys_iomem_info;
@@ -1318,34 +1362,23 @@ int pp2_ppio_probe(char *match, char *buff, struct pp2_ppio **ppio_hdl)
 	struct pp2_port			*port;
 	struct pp2_inst			*inst;
 	struct pp2_ppio			*ppio = NULL;
-	char				*lbuff;
 
-	lbuff = kcalloc(1, strlen(buff), GFP_KERNEL);
-	if (lbuff == NULL)
-		return -ENOMEM;
-
-	memcpy(lbuff, buff, strlen(buff));
-	sec = lbuff;
-
-	/* Search for the ppio-info section */
-	sec = strstr(sec, "ppio-info");
-	if (!sec) {
-		pr_err("ppio-info not found\n");
-		rc = -EINVAL;
-		goto ppio_probe_exit;
-	}
+	rc = mv_json_init(&json, buff);
+	if (rc)
+		return rc;
 
-	/* Search for match (ppio-x:x) */
-	sec = strstr(sec, match);
-	if (!sec) {
-		pr_err("match not found %s %s\n", match, lbuff);
+	/* Search for match (ppio-x:x); there is a ppio-info section per port */
+	sec = -ENOENT;
+	for (info_sec = mv_json_lookup(&json, MV_JSON_ROOT, "ppio-info"); info_sec >= 0 && sec < 0;
+	     info_sec = mv_json_lookup_next(&json, MV_JSON_ROOT, "ppio-info", info_sec))
+		sec = mv_json_find(&json, info_sec, match);
+	if (sec < 0) {
+		pr_err("match not found %s\n", match);
 		rc = -EINVAL;
 		goto ppio_probe_exit;
 	}
 
-	memset(dev_name, 0, FILE_MAX_LINE_CHARS);
-	json_buffer_to_input_str(sec, "dma_dev_name", dev_name);
-	if (dev_name[0] == 0) {
+	if (mv_json_obj_get_str(&json, sec, "dma_dev_name", dev_name, sizeof(dev_name))) {
 		pr_err("'dma_dev_name' not found\n");
 		rc = -EINVAL;
 		goto ppio_probe_exit;
@@ -1364,9 +1397,13 @@ int pp2_ppio_probe(char *match, char *buff, struct pp2_ppio **ppio_hdl)
 	va = (uintptr_t)sys_iomem_info.u.shmem.va;
 	paddr = sys_iomem_info.u.shmem.paddr;
 
-	/* Retireve pp2_id and pool_id */
-	json_buffer_to_input(sec, "pp2_id", pp2_id);
-	json_buffer_to_input(sec, "id", port_id);
+	/* Retireve pp2_id and port_id */
+	if (mv_json_obj_get_num(&json, sec, "pp2_id", pp2_id) ||
+	    mv_json_obj_get_num(&json, sec, "port_id", port_id)) {
+		pr_err("[%s] 'pp2_id'/'port_id' not found\n", __func__);
+		rc = -EINVAL;
+		goto ppio_probe_exit;
+	}
 
 	if (mv_sys_match(match, "ppio", 2, id_match)) {
 		pr_err("[%s] Invalid match string!\n", __func__);
@@ -1433,54 +1470,53 @@ int pp2_ppio_probe(char *match, char *buff, struct pp2_ppio **ppio_hdl)
 	*port_hdl = port;
 
 	/* Search for the port-info section */
-	sec = strstr(sec, "port-info");
-	if (!sec) {
+	port_sec = mv_json_find(&json, sec, "port-info");
+	if (port_sec < 0) {
 		pr_err("'port-info' not found\n");
 		rc = -EINVAL;
 		goto ppio_probe_exit;
 	}
 
 	/* get the port-info parameters */
-	json_buffer_to_input(sec, "id", port->id);
-	json_buffer_to_input(sec, "flags", port->flags);
-	json_buffer_to_input(sec, "port_mru", port->port_mru);
-	json_buffer_to_input(sec, "port_mtu", port->port_mtu);
-	json_buffer_to_input(sec, "first_rxq", port->first_rxq);
-	json_buffer_to_input(sec, "use_mac_lb", port->use_mac_lb);
-	json_buffer_to_input(sec, "t_mode", port->t_mode);
-	json_buffer_to_input(sec, "hash_type", port->hash_type);
-	if (port->hash_type < PP2_PPIO_HASH_T_NONE || port->hash_type >= PP2_PPIO_HASH_T_OUT_OF_RANGE) {
+	rc = -EINVAL;
+	if (mv_json_obj_get_num(&json, port_sec, "id", port->id) ||
+	    mv_json_obj_get_num(&json, port_sec, "flags", port->flags) ||
+	    mv_json_obj_get_num(&json, port_sec, "port_mru", port->port_mru) ||
+	    mv_json_obj_get_num(&json, port_sec, "port_mtu", port->port_mtu) ||
+	    mv_json_obj_get_num(&json, port_sec, "first_rxq", port->first_rxq) ||
+	    mv_json_obj_get_num(&json, port_sec, "use_mac_lb", port->use_mac_lb) ||
+	    mv_json_obj_get_num(&json, port_sec, "t_mode", port->t_mode) ||
+	    mv_json_obj_get_num(&json, port_sec, "tx_fifo_size", port->tx_fifo_size)) {
+		pr_err("'port-info': invalid parameters\n");
+		goto ppio_probe_exit;
+	}
+
+	if (mv_json_obj_get_num(&json, port_sec, "hash_type", port->hash_type) ||
+	    port->hash_type < PP2_PPIO_HASH_T_NONE || port->hash_type >= PP2_PPIO_HASH_T_OUT_OF_RANGE) {
 		pr_err("invalid hash_type\n");
-		rc = -EINVAL;
 		goto ppio_probe_exit;
 	}
 
-	json_buffer_to_input(sec, "rss_en", port->rss_en);
-	if (port->rss_en < 0 || port->rss_en > 1) {
+	if (mv_json_obj_get_num(&json, port_sec, "rss_en", port->rss_en) ||
+	    port->rss_en < 0 || port->rss_en > 1) {
 		pr_err("invalid rss_en\n");
-		rc = -EINVAL;
 		goto ppio_probe_exit;
 	}
 
-	json_buffer_to_input(sec, "tx_fifo_size", port->tx_fifo_size);
-	json_buffer_to_input(sec, "maintain_stats", port->maintain_stats);
-	if (port->maintain_stats < 0 || port->maintain_stats > 1) {
+	if (mv_json_obj_get_num(&json, port_sec, "maintain_stats", port->maintain_stats) ||
+	    port->maintain_stats < 0 || port->maintain_stats > 1) {
 		pr_err("invalid maintain_stats\n");
-		rc = -EINVAL;
 		goto ppio_probe_exit;
 	}
 
-	json_buffer_to_input(sec, "type", port->type);
-	if (port->type < PP2_PPIO_T_LOG || port->type > PP2_PPIO_T_NIC) {
+	if (mv_json_obj_get_num(&json, port_sec, "type", port->type) ||
+	    port->type < PP2_PPIO_T_LOG || port->type > PP2_PPIO_T_NIC) {
 		pr_err("invalid port type\n");
-		rc = -EINVAL;
 		goto ppio_probe_exit;
 	}
 
-	json_buffer_to_input_str(sec, "linux_name", port->linux_name);
-	if (!port->linux_name) {
+	if (mv_json_obj_get_str(&json, port_sec, "linux_name", port->linux_name, sizeof(port->linux_name))) {
 		pr_err("'linux_name' not found\n");
-		rc = -EINVAL;
 		goto ppio_probe_exit;
 	}
 
@@ -1488,43 +1524,41 @@ int pp2_ppio_probe(char *match, char *buff, struct pp2_ppio **ppio_hdl)
 	port->cpu_slot = inst->hw.base[PP2_DEFAULT_REGSPACE].va;
 
 	/* Search for the ppio-port-mac_data section */
-	sec = strstr(sec, "ppio-port-mac_data");
-	if (!sec) {
-		pr_err("'port-info' not found\n");
-		rc = -EINVAL;
+	mac_sec = mv_json_find(&json, port_sec, "ppio-port-mac_data");
+	if (mac_sec < 0) {
+		pr_err("'ppio-port-mac_data' not found\n");
 		goto ppio_probe_exit;
 	}
 
 	/* get the ppio-port-mac_data parameters */
-	json_buffer_to_input(sec, "gop_index", port->mac_data.gop_index);
-	json_buffer_to_input(sec, "flags", port->mac_data.flags);
-	json_buffer_to_input(sec, "phy_addr", port->mac_data.phy_addr);
-	json_buffer_to_input(sec, "phy_mode", port->mac_data.phy_mode);
-	json_buffer_to_input(sec, "force_link", port->mac_data.force_link);
-	json_buffer_to_input(sec, "autoneg", port->mac_data.autoneg);
-	json_buffer_to_input(sec, "link", port->mac_data.link);
-	json_buffer_to_input(sec, "duplex", port->mac_data.duplex);
-	json_buffer_to_input(sec, "speed", port->mac_data.speed);
-	json_buffer_to_input_mac(sec, "mac_address", port->mac_data.mac);
-	if (!port->mac_data.mac) {
+	if (mv_json_obj_get_num(&json, mac_sec, "gop_index", port->mac_data.gop_index) ||
+	    mv_json_obj_get_num(&json, mac_sec, "flags", port->mac_data.flags) ||
+	    mv_json_obj_get_num(&json, mac_sec, "phy_addr", port->mac_data.phy_addr) ||
+	    mv_json_obj_get_num(&json, mac_sec, "phy_mode", port->mac_data.phy_mode) ||
+	    mv_json_obj_get_num(&json, mac_sec, "force_link", port->mac_data.force_link) ||
+	    mv_json_obj_get_num(&json, mac_sec, "autoneg", port->mac_data.autoneg) ||
+	    mv_json_obj_get_num(&json, mac_sec, "link", port->mac_data.link) ||
+	    mv_json_obj_get_num(&json, mac_sec, "duplex", port->mac_data.duplex) ||
+	    mv_json_obj_get_num(&json, mac_sec, "speed", port->mac_data.speed)) {
+		pr_err("'ppio-port-mac_data': invalid parameters\n");
+		goto ppio_probe_exit;
+	}
+	if (mv_json_obj_get_mac(&json, mac_sec, "mac_address", port->mac_data.mac)) {
 		pr_err("'mac_data.mac' not found\n");
-		rc = -EINVAL;
 		goto ppio_probe_exit;
 	}
 
 	/* get the number of TC's */
-	json_buffer_to_input(sec, "num_tcs", port->num_tcs);
-	if (!port->num_tcs || port->num_tcs > PP2_PPIO_MAX_NUM_TCS) {
+	if (mv_json_obj_get_num(&json, port_sec, "num_tcs", port->num_tcs) ||
+	    !port->num_tcs || port->num_tcs > PP2_PPIO_MAX_NUM_TCS) {
 		pr_err("invalid num_tcs\n");
-		rc = -EINVAL;
 		goto ppio_probe_exit;
 	}
 
 	/* get the number of rx queues */
-	json_buffer_to_input(sec, "num_rx_queues", port->num_rx_queues);
-	if (!port->num_rx_queues || port->num_rx_queues > PP2_PPIO_MAX_NUM_INQS) {
+	if (mv_json_obj_get_num(&json, port_sec, "num_rx_queues", port->num_rx_queues) ||
+	    !port->num_rx_queues || port->num_rx_queues > PP2_PPIO_MAX_NUM_INQS) {
 		pr_err("invalid num_rx_queues\n");
-		rc = -EINVAL;
 		goto ppio_probe_exit;
 	}
 
@@ -1538,10 +1572,9 @@ int pp2_ppio_probe(char *match, char *buff, struct pp2_ppio **ppio_hdl)
 	memset(port->rxqs, 0, sizeof(struct pp2_rx_queue *) * port->num_rx_queues);
 
 	/* get the number of tx queues */
-	json_buffer_to_input(sec, "num_tx_queues", port->num_tx_queues);
-	if (!port->num_tx_queues || port->num_tx_queues > PP2_PPIO_MAX_NUM_OUTQS) {
+	if (mv_json_obj_get_num(&json, port_sec, "num_tx_queues", port->num_tx_queues) ||
+	    !port->num_tx_queues || port->num_tx_queues > PP2_PPIO_MAX_NUM_OUTQS) {
 		pr_err("invalid num_tx_queues\n");
-		rc = -EINVAL;
 		goto ppio_probe_exit;
 	}
 
@@ -1554,7 +1587,7 @@ int pp2_ppio_probe(char *match, char *buff, struct pp2_ppio **ppio_hdl)
 	}
 	memset(port->txqs, 0, sizeof(struct pp2_tx_queue *) * port->num_tx_queues);
 
-	rc = pp2_ppio_probe_tc_params(sec, ppio);
+	rc = pp2_ppio_probe_tc_params(&json, port_sec, ppio);
 	if (rc)
 		goto ppio_probe_exit;
 
@@ -1563,11 +1596,11 @@ int pp2_ppio_probe(char *match, char *buff, struct pp2_ppio **ppio_hdl)
 	/* Allocate and associate TXQs to this port */
 	pp2_port_txqs_create(port);
 
-	rc = pp2_ppio_probe_rxq_params(sec, port, paddr, va);
+	rc = pp2_ppio_probe_rxq_params(&json, port_sec, port, paddr, va);
 	if (rc)
 		goto ppio_probe_exit;
 
-	rc = pp2_ppio_probe_txq_params(sec, port, paddr, va);
+	rc = pp2_ppio_probe_txqs(&json, port_sec, "ppio-port", port, paddr, va);
 	if (rc)
 		goto ppio_probe_exit;
 
@@ -1575,7 +1608,7 @@ int pp2_ppio_probe(char *match, char *buff, struct pp2_ppio **ppio_hdl)
 	pp2_ppio_get_statistics(ppio, NULL, true);
 
 	/* extract the loopback info */
-	rc = pp2_ppio_probe_loopback_port(sec, ppio, paddr, va);
+	rc = pp2_ppio_probe_loopback_port(&json, sec, ppio, paddr, va);
 	if (rc)
 		goto ppio_probe_exit;
 
@@ -1584,7 +1617,7 @@ int pp2_ppio_probe(char *match, char *buff, struct pp2_ppio **ppio_hdl)
 
 	rc = 0;
 ppio_probe_exit:
-	kfree(lbuff);
+	mv_json_deinit(&json);
 	if (rc)
 		kfree(ppio);
 	return rc;
@@ -0,0 +1,185 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+/**
+ * @file pp2_txq_rsrv.h
+ *
+ * Physical TXQ descriptor reservation cache
+ *
+ * Before a DM-IF (HIF) moves descriptors from its aggregation queue to a
+ * physical TXQ, it must own enough reserved descriptors in that TXQ. Getting
+ * them is a register write/read round-trip, so they are requested in chunks
+ * and the unused part is cached per TXQ/DM-IF.
+ */
+
+#ifndef _PP2_TXQ_RSRV_H_
+#define _PP2_TXQ_RSRV_H_
+
+#include "std_internal.h"
+#include "pp2_hw_type.h"
+
+struct pp2_txq_dm_if {
+	/* Descriptors reserved in the physical TXQ and not used yet */
+	u32 desc_rsrvd;
+	/* Number of reservation round-trips to the HW */
+	u32 rsrv_reqs;
+};
+
+/* Request 'num' descriptors of physical TXQ 'txq_id'; returns how many were
+ * granted. May be overridden (before including this file) by a fake register
+ * backend in tests.
+ */
+#ifndef pp2_txq_rsrv_hw_request
+#include "pp2_mem.h"
+
+static inline u32 pp2_txq_rsrv_hw_request(uintptr_t cpu_slot, u32 txq_id, u32 num)
+{
+	pp2_relaxed_reg_write(cpu_slot, MVPP2_TXQ_RSVD_REQ_REG, (txq_id << MVPP2_TXQ_RSVD_REQ_Q_OFFSET) | num);
+	mb();
+	return pp2_relaxed_reg_read(cpu_slot, MVPP2_TXQ_RSVD_RSLT_REG) & MVPP2_TXQ_RSVD_RSLT_MASK;
+}
+#endif
+
+/**
+ * Make sure 'num' descriptors of a physical TXQ are reserved for a DM-IF
+ *
+ * Uses the cached reservation if it is big enough; otherwise requests
+ * max(missing, chunk) descriptors from the HW.
+ *
+ * @param	txq_dm_if	TXQ reservation cache of the DM-IF.
+ * @param	cpu_slot	DM-IF register slot.
+ * @param	txq_id		Physical TXQ ID.
+ * @param	num		Number of descriptors about to be sent.
+ * @param	chunk		Minimal reservation request.
+ *
+ * @retval	number of descriptors that may be sent (<= num)
+ */
+static inline u16 pp2_txq_dm_if_reserve(struct pp2_txq_dm_if *txq_dm_if, uintptr_t cpu_slot, u32 txq_id,
+					u16 num, u16 chunk)
+{
+	u32 res_req, result;
+
+	if (likely(txq_dm_if->desc_rsrvd >= num))
+		return num;
+
+	res_req = max((u32)(num - txq_dm_if->desc_rsrvd), (u32)chunk);
+	res_req = min(res_req, (u32)MVPP2_TXQ_RSVD_RSLT_MASK);
+	result = pp2_txq_rsrv_hw_request(cpu_slot, txq_id, res_req);
+
+	txq_dm_if->desc_rsrvd += result;
+	txq_dm_if->rsrv_reqs++;
+
+	if (unlikely(txq_dm_if->desc_rsrvd < num)) {
+		pr_debug("%s prev_desc_rsrvd(%d) desc_rsrvd(%d) res_request(%d) num_txds(%d)\n", __func__,
+			 (txq_dm_if->desc_rsrvd - result), txq_dm_if->desc_rsrvd, res_req, num);
+		num = txq_dm_if->desc_rsrvd;
+	}
+	return num;
+}
+
+/**
+ * Account descriptors sent to the physical TXQ
+ *
+ * @param	txq_dm_if	TXQ reservation cache of the DM-IF.
+ * @param	num		Number of descriptors sent; at most what
+ *				pp2_txq_dm_if_reserve() returned.
+ */
+static inline void pp2_txq_dm_if_consume(struct pp2_txq_dm_if *txq_dm_if, u16 num)
+{
+	txq_dm_if->desc_rsrvd -= num;
+}
+
+#endif /* _PP2_TXQ_RSRV_H_ */
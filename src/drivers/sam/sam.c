@@ -97,6 +97,7 @@
 #include "std_internal.h"
 #include "drivers/mv_sam.h"
 #include "lib/lib_misc.h"
+#include "env/mv_btrace.h"
 
 #include "drivers/mv_sam.h"
 #include "crypto/mv_md5.h"
@@ -170,6 +171,8 @@ static struct sam_sa *sam_session_alloc(void)
 
 static void sam_session_free(struct sam_sa *sa)
 {
+	mv_replay_win_destroy(sa->replay_win);
+	sa->replay_win = NULL;
 	sa->is_valid = false;
 }
 
@@ -325,6 +328,14 @@ static int sam_session_ipsec_init(struct sam_sa *session, SABuilder_Params_IPsec
 		return -EINVAL;
 	}
 
+	if (params->u.ipsec.replay_win_size && params->dir == SAM_DIR_DECRYPT) {
+		if (mv_replay_win_create(params->u.ipsec.replay_win_size, params->u.ipsec.seq,
+					 params->u.ipsec.is_esn, &session->replay_win)) {
+			pr_err("Can't create software anti-replay window\n");
+			return -EINVAL;
+		}
+	}
+
 	ipsec_params->SeqNum = lower_32_bits(params->u.ipsec.seq);
 	ipsec_params->SeqNumHi = upper_32_bits(params->u.ipsec.seq);
 	if (params->u.ipsec.is_tunnel) {
@@ -1012,6 +1023,8 @@ int sam_cio_enq(struct sam_cio *cio, struct sam_cio_op_params *requests, u16 *nu
 	if (unlikely(todo >= cio->params.size))
 		todo = cio->params.size - 1;
 
+	mv_btrc(MV_BTRC_CAT_SAM, MV_BTRC_ID_SAM_ENQ_START, cio->idx, todo, 0, 0);
+
 	for (i = 0; i < todo; i++) {
 
 		request = &requests[i];
@@ -1120,6 +1133,8 @@ int sam_cio_enq(struct sam_cio *cio, struct sam_cio_op_params *requests, u16 *nu
 	}
 	*num = (u16)i;
 
+	mv_btrc(MV_BTRC_CAT_SAM, MV_BTRC_ID_SAM_ENQ_END, cio->idx, i, 0, 0);
+
 	return err;
 }
 
@@ -1140,6 +1155,8 @@ int sam_cio_deq(struct sam_cio *cio, struct sam_cio_op_result *results, u16 *num
 	}
 	todo = *num;
 
+	mv_btrc(MV_BTRC_CAT_SAM, MV_BTRC_ID_SAM_DEQ_START, cio->idx, todo, 0, 0);
+
 	result = results;
 	i = 0;
 	count = 0;
@@ -1170,11 +1187,15 @@ int sam_cio_deq(struct sam_cio *cio, struct sam_cio_op_result *results, u16 *num
 		if (unlikely(!result)) /* Flush cio */
 			continue;
 
-		if (unlikely(sam_hw_res_desc_read(res_desc, result)))
+		if (unlikely(sam_hw_res_desc_read(res_desc, result))) {
+			mv_btrc(MV_BTRC_CAT_SAM, MV_BTRC_ID_SAM_DEQ_END, cio->idx, count, done, 0);
 			return -EINVAL;
+		}
 
 		if (likely(result->status == SAM_CIO_OK)) {
-			if (operation->sa->post_proc_cb)
+			if (unlikely(operation->sa->replay_win) && sam_ipsec_replay_commit(operation))
+				result->status = SAM_CIO_ERR_ANTIREPLAY;
+			else if (operation->sa->post_proc_cb)
 				operation->sa->post_proc_cb(operation, res_desc, result);
 		} else if ((result->status == SAM_CIO_ERR_SEQ_OVER) &&
 			   (operation->sa->params.dir == SAM_DIR_DECRYPT)) {
@@ -1212,6 +1233,8 @@ int sam_cio_deq(struct sam_cio *cio, struct sam_cio_op_result *results, u16 *num
 
 	*num = (u16)count;
 
+	mv_btrc(MV_BTRC_CAT_SAM, MV_BTRC_ID_SAM_DEQ_END, cio->idx, count, done, 0);
+
 	return 0;
 }
 
@@ -1253,9 +1276,11 @@ int sam_cio_delete_event(struct sam_cio *cio, struct mv_sys_event *ev)
 
 int sam_cio_set_event(struct sam_cio *cio, struct mv_sys_event *ev, int en)
 {
-	if (en)
+	if (en) {
+		/* Disable resets the threshold, restore the configured coalescing */
+		sam_hw_ring_prepare_rdr_thresh(&cio->hw_ring, cio->pkt_coal, cio->usec_coal);
 		sam_hw_ring_trigger_irq(&cio->hw_ring);
-	else {
+	} else {
 		/* Untrigger IRQ */
 		sam_hw_ring_prepare_rdr_thresh(&cio->hw_ring, 0, 0);
 		sam_hw_ring_trigger_irq(&cio->hw_ring);
@@ -1265,6 +1290,14 @@ int sam_cio_set_event(struct sam_cio *cio, struct mv_sys_event *ev, int en)
 	return 0;
 }
 
+int sam_cio_set_event_coal(struct sam_cio *cio, u32 pkt_coal, u32 usec_coal)
+{
+	cio->pkt_coal = pkt_coal;
+	cio->usec_coal = usec_coal;
+
+	return 0;
+}
+
 int sam_set_debug_flags(u32 debug_flags)
 {
 #ifdef MVCONF_SAM_DEBUG
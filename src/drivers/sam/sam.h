@@ -107,6 +107,7 @@
 #include "token_builder.h"
 
 #include "sam_hw.h"
+#include "lib/mv_replay_win.h"
 
 /** Maximum number of supported crypto engines */
 #define SAM_HW_DEVICE_NUM	        2
@@ -143,6 +144,7 @@ struct sam_cio_op {
 	u32 token_header_word;
 	u32 token_words;
 	u32 copy_len;
+	u64 seq;	/* inbound IPsec sequence number for the anti-replay commit */
 };
 
 struct sam_cio {
@@ -180,6 +182,7 @@ struct sam_sa {
 	u8				auth_inner[64]; /* authentication inner block */
 	u8				auth_outer[64]; /* authentication outer block */
 	u8				tunnel_header[40]; /* Maximum needed place for tunnel header */
+	struct mv_replay_win		*replay_win; /* software anti-replay window (inbound IPsec) */
 	void	(*post_proc_cb)(struct sam_cio_op *operation, struct sam_hw_res_desc *res_desc,
 				struct sam_cio_op_result *result);
 };
@@ -273,6 +276,13 @@ void sam_ipsec_ip4_tunnel_out_post_proc(struct sam_cio_op *operation,
 			struct sam_hw_res_desc *res_desc, struct sam_cio_op_result *result);
 void sam_ipsec_ip6_tunnel_out_post_proc(struct sam_cio_op *operation,
 			struct sam_hw_res_desc *res_desc, struct sam_cio_op_result *result);
+u64 sam_ipsec_replay_seq_get(struct sam_sa *session, struct sam_cio_ipsec_params *request);
+
+/* Commit the sequence number of an authenticated inbound packet */
+static inline int sam_ipsec_replay_commit(struct sam_cio_op *operation)
+{
+	return mv_replay_win_commit(operation->sa->replay_win, operation->seq);
+}
 
 u16 sam_ssltls_version_convert(enum sam_ssltls_version version);
 void sam_dtls_ip4_post_proc(struct sam_cio_op *operation, struct sam_hw_res_desc *res_desc,
@@ -318,6 +318,85 @@ void sam_ipsec_ip6_tunnel_in_post_proc(struct sam_cio_op *operation, struct sam_
 	pr_info("%s: Not supported yet\n", __func__);
 }
 
+/* Read the ESP sequence number field of an inbound packet; the IP header (and
+ * the NAT-T UDP header) must be in the first source buffer.
+ */
+static inline int sam_ipsec_esp_seq_read(struct sam_sa *session, struct sam_cio_ipsec_params *request,
+					 u32 *seq)
+{
+	u8 *hdr = (u8 *)request->src[0].vaddr + request->l3_offset;
+	u32 len = request->src[0].len;
+	u32 off = request->l3_offset;
+	u8 proto;
+
+	if (unlikely(off + sizeof(struct iphdr) > len))
+		return -EINVAL;
+
+	if ((hdr[0] >> 4) == MV_IP_VER_4) {
+		off += (hdr[0] & 0xf) * 4;
+		proto = hdr[9];
+	} else {
+		/* IPv6 extension headers before ESP are not supported */
+		off += 40;
+		proto = hdr[6];
+	}
+	if (session->params.u.ipsec.is_natt) {
+		if (proto != IPPROTO_UDP)
+			return -EINVAL;
+		off += sizeof(struct mv_udphdr);
+	} else if (proto != IPPROTO_ESP) {
+		return -EINVAL;
+	}
+	/* SPI followed by the sequence number */
+	if (unlikely(off + 8 > len))
+		return -EINVAL;
+
+	*seq = be32toh(*(u32 *)((u8 *)request->src[0].vaddr + off + 4));
+	return 0;
+}
+
+/* Full sequence number of an inbound request for the commit on dequeue; 0
+ * (never accepted) when the packet can't be parsed or fails the check.
+ */
+u64 sam_ipsec_replay_seq_get(struct sam_sa *session, struct sam_cio_ipsec_params *request)
+{
+	u64 seq;
+	u32 seq_lo;
+
+	if (sam_ipsec_esp_seq_read(session, request, &seq_lo))
+		return 0;
+	if (mv_replay_win_check(session->replay_win, seq_lo, &seq))
+		return 0;
+	return seq;
+}
+
+int sam_cio_ipsec_replay_check(struct sam_cio_ipsec_params *requests, u16 *num,
+			       void **rejected, u16 *num_rejected)
+{
+	struct sam_cio_ipsec_params *request;
+	struct sam_sa *session;
+	u16 i, passed = 0, drops = 0;
+	u32 seq_lo;
+
+	for (i = 0; i < *num; i++) {
+		request = &requests[i];
+		session = request->sa;
+		/* malformed packets are left to the engine to reject */
+		if (session->replay_win &&
+		    !sam_ipsec_esp_seq_read(session, request, &seq_lo) &&
+		    mv_replay_win_check(session->replay_win, seq_lo, NULL)) {
+			rejected[drops++] = request->cookie;
+			continue;
+		}
+		if (passed != i)
+			requests[passed] = *request;
+		passed++;
+	}
+	*num = passed;
+	*num_rejected = drops;
+	return 0;
+}
+
 int sam_cio_enq_ipsec(struct sam_cio *cio, struct sam_cio_ipsec_params *requests, u16 *num)
 {
 	struct sam_sa *session;
@@ -359,6 +438,8 @@ int sam_cio_enq_ipsec(struct sam_cio *cio, struct sam_cio_ipsec_params *requests
 		operation->cookie = request->cookie;
 		operation->copy_len = request->pkt_size;
 		operation->num_bufs_in = request->num_bufs;
+		if (unlikely(session->replay_win))
+			operation->seq = sam_ipsec_replay_seq_get(session, request);
 		/* only one destination buffer is supported */
 		operation->num_bufs_out = 1;
 		for (j = 0;  j < operation->num_bufs_out; j++) {
@@ -0,0 +1,332 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include "std_internal.h"
+#include <sys/syscall.h>
+
+#include "env/mv_btrace.h"
+
+u32 mv_btrc_cat_mask;
+u32 mv_btrc_gen;	/* incremented on each deinit, to invalidate the cached rings */
+__thread struct mv_btrc_ring *mv_btrc_local_ring;
+__thread u32 mv_btrc_local_gen;
+
+static struct mv_btrc_ring	*btrc_rings[MV_BTRC_MAX_RINGS];
+static u32			 btrc_num_rings;
+static u32			 btrc_ring_size;
+static struct mv_btrc_tp	 btrc_tps[MV_BTRC_MAX_TPS];
+static spinlock_t		 btrc_lock;
+
+static struct mv_btrc_tp btrc_builtin_tps[] = {
+	{MV_BTRC_ID_GIE_DMA, MV_BTRC_CAT_GIE, MV_BTRC_TYPE_INSTANT, 3, "gie_dma",
+	 {"src", "dst", "size"} },
+	{MV_BTRC_ID_GIE_QE_COPY, MV_BTRC_CAT_GIE, MV_BTRC_TYPE_INSTANT, 4, "gie_qe_copy",
+	 {"qes", "src_qid", "src_tail", "dst_qid"} },
+	{MV_BTRC_ID_GIE_QE_PRODUCE, MV_BTRC_CAT_GIE, MV_BTRC_TYPE_INSTANT, 4, "gie_qe_produce",
+	 {"qes", "src_qid", "src_head", "dst_qid"} },
+	{MV_BTRC_ID_SAM_ENQ_START, MV_BTRC_CAT_SAM, MV_BTRC_TYPE_BEGIN, 2, "sam_enq",
+	 {"cio", "requested"} },
+	{MV_BTRC_ID_SAM_ENQ_END, MV_BTRC_CAT_SAM, MV_BTRC_TYPE_END, 2, "sam_enq",
+	 {"cio", "enqueued"} },
+	{MV_BTRC_ID_SAM_DEQ_START, MV_BTRC_CAT_SAM, MV_BTRC_TYPE_BEGIN, 2, "sam_deq",
+	 {"cio", "requested"} },
+	{MV_BTRC_ID_SAM_DEQ_END, MV_BTRC_CAT_SAM, MV_BTRC_TYPE_END, 3, "sam_deq",
+	 {"cio", "dequeued", "ready"} },
+};
+
+static u64 btrc_ts_freq(void)
+{
+#if defined(__aarch64__)
+	u64 freq;
+
+	asm volatile("mrs %0, cntfrq_el0" : "=r" (freq));
+	return freq;
+#else
+	return 1000000000ULL;
+#endif
+}
+
+int mv_btrc_register(struct mv_btrc_tp *tp)
+{
+	if (!tp || tp->id >= MV_BTRC_MAX_TPS || tp->cat >= MV_BTRC_CAT_LAST ||
+	    tp->nargs > MV_BTRC_MAX_ARGS || !tp->name[0]) {
+		pr_err("[%s] invalid tracepoint\n", __func__);
+		return -EINVAL;
+	}
+	if (btrc_tps[tp->id].name[0]) {
+		pr_err("[%s] tracepoint %d already registered (%s)\n",
+		       __func__, tp->id, btrc_tps[tp->id].name);
+		return -EEXIST;
+	}
+
+	btrc_tps[tp->id] = *tp;
+	return 0;
+}
+
+int mv_btrc_init(u32 ring_size)
+{
+	u32 i;
+	int err;
+
+	if (btrc_ring_size) {
+		pr_err("[%s] binary trace already initialized\n", __func__);
+		return -EEXIST;
+	}
+
+	if (!ring_size)
+		ring_size = MV_BTRC_DEF_RING_SIZE;
+	for (btrc_ring_size = 1; btrc_ring_size < ring_size; btrc_ring_size <<= 1)
+		;
+
+	spin_lock_init(&btrc_lock);
+	memset(btrc_tps, 0, sizeof(btrc_tps));
+	for (i = 0; i < ARRAY_SIZE(btrc_builtin_tps); i++) {
+		err = mv_btrc_register(&btrc_builtin_tps[i]);
+		if (err)
+			return err;
+	}
+
+	return 0;
+}
+
+void mv_btrc_deinit(void)
+{
+	u32 i;
+
+	__atomic_store_n(&mv_btrc_cat_mask, 0, __ATOMIC_RELAXED);
+
+	spin_lock(&btrc_lock);
+	for (i = 0; i < btrc_num_rings; i++) {
+		kfree(btrc_rings[i]);
+		btrc_rings[i] = NULL;
+	}
+	btrc_num_rings = 0;
+	btrc_ring_size = 0;
+	__atomic_store_n(&mv_btrc_gen, mv_btrc_gen + 1, __ATOMIC_RELEASE);
+	spin_unlock(&btrc_lock);
+
+	mv_btrc_local_ring = NULL;
+}
+
+void mv_btrc_enable(u32 cat_mask, int en)
+{
+	if (en)
+		__atomic_or_fetch(&mv_btrc_cat_mask, cat_mask, __ATOMIC_RELAXED);
+	else
+		__atomic_and_fetch(&mv_btrc_cat_mask, ~cat_mask, __ATOMIC_RELAXED);
+}
+
+struct mv_btrc_ring *mv_btrc_ring_attach(void)
+{
+	struct mv_btrc_ring *ring;
+
+	if (!btrc_ring_size)
+		return NULL;
+
+	spin_lock(&btrc_lock);
+	if (btrc_num_rings >= MV_BTRC_MAX_RINGS) {
+		spin_unlock(&btrc_lock);
+		/* The thread stays untraced; note that it retries the attach on
+		 * every tracepoint hit while its categories are enabled.
+		 */
+		return NULL;
+	}
+
+	ring = kcalloc(1, sizeof(*ring) + btrc_ring_size * sizeof(struct mv_btrc_rec), GFP_KERNEL);
+	if (!ring) {
+		spin_unlock(&btrc_lock);
+		pr_err("[%s] no mem for trace ring\n", __func__);
+		return NULL;
+	}
+	ring->size = btrc_ring_size;
+	ring->tid = (u32)syscall(SYS_gettid);
+	btrc_rings[btrc_num_rings++] = ring;
+	mv_btrc_local_gen = mv_btrc_gen;
+	spin_unlock(&btrc_lock);
+
+	mv_btrc_local_ring = ring;
+	return ring;
+}
+
+/* Copy the valid part of a ring, oldest record first.
+ * The owner keeps writing while we copy: the records that may have been
+ * overwritten are the ones older than (head_after_copy - size + 1); they are
+ * dropped, as is any record whose seq does not match its index.
+ */
+static u32 btrc_ring_snapshot(struct mv_btrc_ring *ring, struct mv_btrc_rec *out, u64 *lost)
+{
+	u64 head, first, idx, valid_from;
+	u32 i, cnt = 0;
+
+	head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	first = (head > ring->size) ? head - ring->size : 0;
+
+	for (idx = first, i = 0; idx < head; idx++, i++)
+		out[i] = ring->recs[idx & (ring->size - 1)];
+
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	valid_from = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	valid_from = (valid_from >= ring->size) ? valid_from - ring->size + 1 : 0;
+
+	for (idx = first, i = 0; idx < head; idx++, i++) {
+		if (idx < valid_from || out[i].seq != (u32)idx)
+			continue;
+		out[cnt++] = out[i];
+	}
+
+	*lost = head - cnt;
+	return cnt;
+}
+
+int mv_btrc_dump(const char *file)
+{
+	struct mv_btrc_file_hdr hdr;
+	struct mv_btrc_ring_hdr rhdr;
+	struct mv_btrc_rec *recs;
+	FILE *f;
+	u32 i, num_rings;
+	int err = 0;
+
+	if (!btrc_ring_size) {
+		pr_err("[%s] binary trace not initialized\n", __func__);
+		return -EINVAL;
+	}
+
+	recs = kcalloc(btrc_ring_size, sizeof(struct mv_btrc_rec), GFP_KERNEL);
+	if (!recs)
+		return -ENOMEM;
+
+	f = fopen(file, "w");
+	if (!f) {
+		pr_err("[%s] failed to open %s\n", __func__, file);
+		kfree(recs);
+		return -EIO;
+	}
+
+	num_rings = __atomic_load_n(&btrc_num_rings, __ATOMIC_ACQUIRE);
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = MV_BTRC_MAGIC;
+	hdr.version = MV_BTRC_VERSION;
+	hdr.ts_freq = btrc_ts_freq();
+	hdr.num_tps = MV_BTRC_MAX_TPS;
+	hdr.num_rings = num_rings;
+	hdr.cat_mask = __atomic_load_n(&mv_btrc_cat_mask, __ATOMIC_RELAXED);
+
+	if (fwrite(&hdr, sizeof(hdr), 1, f) != 1 ||
+	    fwrite(btrc_tps, sizeof(btrc_tps), 1, f) != 1) {
+		err = -EIO;
+		goto dump_exit;
+	}
+
+	for (i = 0; i < num_rings; i++) {
+		rhdr.tid = btrc_rings[i]->tid;
+		rhdr.num_recs = btrc_ring_snapshot(btrc_rings[i], recs, &rhdr.lost);
+		if (fwrite(&rhdr, sizeof(rhdr), 1, f) != 1 ||
+		    (rhdr.num_recs &&
+		     fwrite(recs, sizeof(struct mv_btrc_rec), rhdr.num_recs, f) != rhdr.num_recs)) {
+			err = -EIO;
+			goto dump_exit;
+		}
+	}
+
+dump_exit:
+	if (err)
+		pr_err("[%s] failed to write %s\n", __func__, file);
+	fclose(f);
+	kfree(recs);
+	return err;
+}
@@ -96,10 +96,16 @@
 
 #include "std_internal.h"
 
+#ifdef MVCONF_SPINLOCK_MCS
+__thread struct spin_mcs_node spin_mcs_node;
+#endif
+
 spinlock_t * spin_lock_create(void)
 {
 	spinlock_t *lock = kmalloc(sizeof(spinlock_t), GFP_KERNEL);
 
+	if (!lock)
+		return NULL;
 	spin_lock_init(lock);
 	return (spinlock_t *)lock;
 }
@@ -494,7 +494,7 @@ static int iomem_mmap_iounmap(struct mem_mmap *mmapm, const char *name)
 
 static int iomem_shmem_ioinit(struct mem_shm *shm, char *name, int index, u32 size)
 {
-	memcpy(shm->dev_name, name, sizeof(shm->dev_name));
+	strncpy(shm->dev_name, name, sizeof(shm->dev_name) - 1);
 	if (!size)
 		size = sysconf(_SC_PAGE_SIZE);
 	shm->size = size;
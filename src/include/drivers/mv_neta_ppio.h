@@ -99,6 +99,7 @@
 
 #include "mv_std.h"
 #include "mv_net.h"
+#include "lib/mv_gso.h"
 
 
 /** @addtogroup grp_neta_io Packet Processor: I/O
@@ -456,6 +457,41 @@ static inline void neta_ppio_outq_desc_set_pkt_len(struct neta_ppio_desc *desc,
 	NETA_TXD_SET_PKT_SIZE(desc, len);
 }
 
+/**
+ * Fill outq descriptors from a software GSO result.
+ * The descriptors may be sent as-is by neta_ppio_send_sg(), using the 'seg_frags'
+ * array returned by mv_gso_segment() as the neta_ppio_sg_pkts 'frags' array.
+ * Cookies for releasing the payload buffers are left to the caller.
+ *
+ * @param[out]	descs		An array of at least info->num_frags descriptors.
+ * @param[in]	frags		Fragments returned by mv_gso_segment().
+ * @param[in]	info		Segmentation info returned by mv_gso_segment().
+ * @param[in]	gen_l4_chk	Set to '1' if the frame was segmented with MV_GSO_L4_CSUM_HW.
+ *
+ */
+static inline void neta_ppio_outq_desc_set_gso(struct neta_ppio_desc *descs, struct mv_gso_frag *frags,
+					       struct mv_gso_info *info, int gen_l4_chk)
+{
+	enum neta_outq_l3_type l3_type = (info->l3_type == MV_GSO_L3_IPV4) ?
+					 NETA_OUTQ_L3_TYPE_IPV4 : NETA_OUTQ_L3_TYPE_IPV6;
+	enum neta_outq_l4_type l4_type = (info->l4_type == MV_GSO_L4_TCP) ?
+					 NETA_OUTQ_L4_TYPE_TCP : NETA_OUTQ_L4_TYPE_UDP;
+	u32 first_last;
+	u16 i;
+
+	for (i = 0; i < info->num_frags; i++) {
+		first_last = ((frags[i].flags & MV_GSO_FRAG_FIRST) ? NETA_TXD_F_DESC_MASK : 0) |
+			     ((frags[i].flags & MV_GSO_FRAG_LAST) ? NETA_TXD_L_DESC_MASK : 0);
+		neta_ppio_outq_desc_reset(&descs[i]);
+		neta_ppio_outq_desc_set_phys_addr(&descs[i], frags[i].paddr);
+		neta_ppio_outq_desc_set_pkt_offset(&descs[i], 0);
+		neta_ppio_outq_desc_set_pkt_len(&descs[i], frags[i].len);
+		neta_ppio_outq_desc_set_proto_info(&descs[i], l3_type, l4_type, info->l3_offset,
+						   info->l4_offset, 0, gen_l4_chk);
+		NETA_TXD_SET_FIRST_LAST(&descs[i], first_last);
+	}
+}
+
 /******** RXQ  ********/
 
 /**
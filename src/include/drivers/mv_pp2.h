@@ -218,6 +218,10 @@ struct pp2_init_params {
 	u32			res_maps_auto_detect_map;
 	/** user defined parser fields */
 	struct pp2_parse_udfs	prs_udfs;
+	/** Run over the PPv2 emulator instead of the HW (single packet processor, no Linux
+	 * netdevs; requires a build with --enable-pp2-emu). Meant for driver and application tests.
+	 */
+	int			emulate;
 	/* TODO FUTURE struct pp2_parse_params	prs_params; */
 };
 
@@ -199,6 +199,116 @@ int pp2_bpool_put_buff(struct pp2_hif *hif, struct pp2_bpool *pool, struct pp2_b
  */
 int pp2_bpool_put_buffs(struct pp2_hif *hif, struct buff_release_entry buff_entry[], u16 *num);
 
+/****************************************************************************
+ *	Per-HIF buffer cache
+ ****************************************************************************/
+
+struct pp2_bpool_cache;
+
+/**
+ * bpool cache parameters
+ *
+ * Buffers put to the cache are handed back by the following gets without accessing the BM.
+ * An empty cache is filled from the BM with up to 'low_wm' buffers; a cache holding 'high_wm'
+ * buffers is spilled to the BM (in one release burst) down to 'low_wm' buffers.
+ */
+struct pp2_bpool_cache_params {
+	u16	low_wm;		/**< Low watermark; must be lower than 'high_wm' */
+	u16	high_wm;	/**< High watermark, i.e. the cache size; up to PP2_MAX_NUM_PUT_BUFFS */
+};
+
+/**
+ * bpool cache statistics
+ */
+struct pp2_bpool_cache_stats {
+	u64	gets;		/**< Buffers requested */
+	u64	hits;		/**< Buffers served without accessing the BM */
+	u64	empty;		/**< Gets failed as both the cache and the BM were empty */
+	u64	puts;		/**< Buffers put */
+	u64	fills;		/**< Fills from the BM */
+	u64	filled_buffs;	/**< Buffers got from the BM */
+	u64	spills;		/**< Release bursts to the BM */
+	u64	spilled_buffs;	/**< Buffers released to the BM */
+};
+
+/**
+ * Create a buffer cache for a bpool, to be used by a single HIF
+ *
+ * @param[in]	hif	A hif handle; the cache may only be used from this hif's thread.
+ * @param[in]	pool	A bpool handle.
+ * @param[in]	params	Cache parameters.
+ * @param[out]	cache	A pointer to opaque cache handle of type 'struct pp2_bpool_cache *'.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int pp2_bpool_cache_create(struct pp2_hif *hif, struct pp2_bpool *pool, struct pp2_bpool_cache_params *params,
+			   struct pp2_bpool_cache **cache);
+
+/**
+ * Destroy a bpool cache; the cached buffers are released to the bpool
+ *
+ * @param[in]	cache	A cache handle.
+ */
+void pp2_bpool_cache_destroy(struct pp2_bpool_cache *cache);
+
+/**
+ * Get a buffer through a bpool cache
+ *
+ * @param[in]	cache	A cache handle.
+ * @param[out]	buff	A pointer to structure that contains the returned buffer parameters.
+ *
+ * @retval	0 on success
+ * @retval	-ENOBUFS if both the cache and the bpool are empty
+ */
+int pp2_bpool_cache_get_buff(struct pp2_bpool_cache *cache, struct pp2_buff_inf *buff);
+
+/**
+ * Put a buffer through a bpool cache
+ *
+ * @param[in]	cache	A cache handle.
+ * @param[in]	buff	A pointer to structure that contains the buffer parameters.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int pp2_bpool_cache_put_buff(struct pp2_bpool_cache *cache, struct pp2_buff_inf *buff);
+
+/**
+ * Release all the cached buffers to the bpool
+ *
+ * Should be called before the bpool buffers are counted or flushed (e.g. on shutdown).
+ *
+ * @param[in]	cache	A cache handle.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int pp2_bpool_cache_flush(struct pp2_bpool_cache *cache);
+
+/**
+ * Get the number of buffers held by a bpool cache
+ *
+ * @param[in]	cache		A cache handle.
+ * @param[out]	num_buffs	Number of cached buffers.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int pp2_bpool_cache_get_num_buffs(struct pp2_bpool_cache *cache, u32 *num_buffs);
+
+/**
+ * Get bpool cache statistics
+ *
+ * @param[in]	cache	A cache handle.
+ * @param[out]	stats	Cache statistics.
+ * @param[in]	reset	Reset the statistics after reading them.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int pp2_bpool_cache_get_stats(struct pp2_bpool_cache *cache, struct pp2_bpool_cache_stats *stats, int reset);
+
 /****************************************************************************
  *	Run-time Control API
  ****************************************************************************/
@@ -345,6 +345,42 @@ int pp2_cls_tbl_remove_rule(struct pp2_cls_tbl		*tbl,
  */
 int pp2_cls_plcr_init(struct pp2_cls_plcr_params *params, struct pp2_cls_plcr **plcr);
 
+/**
+ * Classifier policer HW programming
+ *
+ * The HW credits 'update_tokens' tokens (bytes or packets) to the committed
+ * bucket every 'update_period_ns', with a rate and burst resolution that
+ * depends on the token type; so the enforced rate may differ from the
+ * requested CIR. It is also limited to CBS per update, as the committed bucket
+ * clips the excess tokens.
+ */
+struct pp2_cls_plcr_hw_info {
+	u8	token_type;		/**< token update type (0: finest resolution) */
+	u16	token_value;		/**< token update value */
+	u64	update_period_ns;	/**< token update period */
+	u32	update_tokens;		/**< tokens credited per update */
+	u64	rate;			/**< enforced rate in bytes/sec or pps */
+	u32	cir;			/**< enforced CIR, in Kbps or pps */
+	u32	cbs;			/**< programmed CBS, in the units of the params */
+	u32	ebs;			/**< programmed EBS, in the units of the params */
+	s32	rate_err_ppm;		/**< enforced vs. requested CIR, in ppm */
+};
+
+/**
+ * Get the HW programming of a classifier policer
+ *
+ * Computes what pp2_cls_plcr_init() would program for the given parameters,
+ * without accessing the HW. Together with mv_plcr (lib/mv_policer.h) it allows
+ * modeling the HW policer in software.
+ *
+ * @param[in]	params	A pointer to the classifier policer parameters
+ * @param[out]	info	A pointer to the HW programming
+ *
+ * @retval		0 on success
+ * @retval		error-code otherwise (invalid parameters)
+ */
+int pp2_cls_plcr_get_hw_info(const struct pp2_cls_plcr_params *params, struct pp2_cls_plcr_hw_info *info);
+
 /**
  * Deinit a classifier policer object
  *
@@ -119,6 +119,17 @@ struct pp2_hif_params {
 	const char	*match;
 	u32		 out_size; /**< TX-Aggregation q_size */
 	struct mv_sys_dma_mem_region *mem;
+	/** The hif is used by a single thread only; its aggregation queue is
+	 * then never locked, even when the driver is built with MVCONF_PP2_LOCK.
+	 */
+	int		 exclusive;
+	/** Minimal number of physical TXQ descriptors reserved at once per
+	 * TXQ (0 for the default, 64). Larger chunks save HW reservation
+	 * round-trips on the send path, but descriptors reserved by one hif
+	 * can't be used by the others; keep chunk * number of hifs sending to
+	 * a TXQ below the TXQ size.
+	 */
+	u16		 txq_rsrv_chunk;
 };
 
 /**
@@ -99,6 +99,7 @@
 
 #include "mv_std.h"
 #include "env/mv_sys_event.h"
+#include "lib/mv_gso.h"
 
 #include "mv_pp2.h"
 #include "mv_pp2_hif.h"
@@ -123,6 +124,7 @@ struct pp2_cls_early_drop;
 #define PP2_PPIO_MAX_NUM_TCS		32 /**< Max. number of TCs per ppio. */
 #define PP2_PPIO_MAX_NUM_INQS		32 /**< Max. number of inqs per ppio. */
 #define PP2_PPIO_MAX_NUM_OUTQS		8 /**< Max. number of outqs per ppio. */
+#define PP2_PPIO_RSS_TBL_SIZE		32 /**< Number of lines of an RSS indirection table. */
 #define PP2_PPIO_TC_CLUSTER_MAX_POOLS	2 /**< Max. number of bpools per TC per mem_id. */
 #define PP2_PPIO_TC_MAX_POOLS		\
 	(PP2_PPIO_TC_CLUSTER_MAX_POOLS * MV_SYS_DMA_MAX_NUM_MEM_ID) /**< Max. number of bpools per TC. */
@@ -779,6 +781,53 @@ static inline void pp2_ppio_outq_desc_set_pkt_len(struct pp2_ppio_desc *desc, u1
 	desc->cmds[1] = (desc->cmds[1] & ~TXD_BYTE_COUNT_MASK) | (len << 16 & TXD_BYTE_COUNT_MASK);
 }
 
+/**
+ * Get the packet length from an outq packet descriptor.
+ *
+ * @param[in]	desc	A pointer to a packet descriptor structure.
+ *
+ * @retval	packet length, as set by pp2_ppio_outq_desc_set_pkt_len()
+ */
+static inline u16 pp2_ppio_outq_desc_get_pkt_len(struct pp2_ppio_desc *desc)
+{
+	return (desc->cmds[1] & TXD_BYTE_COUNT_MASK) >> 16;
+}
+
+/**
+ * Fill outq descriptors from a software GSO result.
+ * The descriptors may be sent as-is by pp2_ppio_send_sg(), using the 'seg_frags'
+ * array returned by mv_gso_segment() as the pp2_ppio_sg_pkts 'frags' array.
+ * Cookies/pools for releasing the payload buffers are left to the caller.
+ *
+ * @param[out]	descs		An array of at least info->num_frags descriptors.
+ * @param[in]	frags		Fragments returned by mv_gso_segment().
+ * @param[in]	info		Segmentation info returned by mv_gso_segment().
+ * @param[in]	gen_l4_chk	Set to '1' if the frame was segmented with MV_GSO_L4_CSUM_HW.
+ *
+ */
+static inline void pp2_ppio_outq_desc_set_gso(struct pp2_ppio_desc *descs, struct mv_gso_frag *frags,
+					      struct mv_gso_info *info, int gen_l4_chk)
+{
+	enum pp2_outq_l3_type l3_type = (info->l3_type == MV_GSO_L3_IPV4) ?
+					PP2_OUTQ_L3_TYPE_IPV4 : PP2_OUTQ_L3_TYPE_IPV6;
+	enum pp2_outq_l4_type l4_type = (info->l4_type == MV_GSO_L4_TCP) ?
+					PP2_OUTQ_L4_TYPE_TCP : PP2_OUTQ_L4_TYPE_UDP;
+	u32 first_last;
+	u16 i;
+
+	for (i = 0; i < info->num_frags; i++) {
+		first_last = ((frags[i].flags & MV_GSO_FRAG_FIRST) ? TXD_FIRST : 0) |
+			     ((frags[i].flags & MV_GSO_FRAG_LAST) ? TXD_LAST : 0);
+		pp2_ppio_outq_desc_reset(&descs[i]);
+		pp2_ppio_outq_desc_set_phys_addr(&descs[i], frags[i].paddr);
+		pp2_ppio_outq_desc_set_pkt_offset(&descs[i], 0);
+		pp2_ppio_outq_desc_set_pkt_len(&descs[i], frags[i].len);
+		pp2_ppio_outq_desc_set_proto_info(&descs[i], l3_type, l4_type, info->l3_offset,
+						  info->l4_offset, 0, gen_l4_chk);
+		DM_TXD_SET_FIRST_LAST(&descs[i], first_last);
+	}
+}
+
 /******** RXQ  ********/
 
 /* TODO: Timestamp, L4IChk */
@@ -1116,6 +1165,65 @@ int pp2_ppio_recv(struct pp2_ppio	*ppio,
 		  struct pp2_ppio_desc	*descs,
 		  u16			*num);
 
+/**
+ * Peek at received packets on a ppio, without copying their descriptors.
+ *
+ * Returns a pointer to the received descriptors inside the in-Q ring; they may
+ * be accessed with the pp2_ppio_inq_desc_get_xxx() accessors until they are
+ * handed back to the HW with pp2_ppio_recv_release(). The returned descriptors
+ * are contiguous, so fewer than available may be returned when the ring wraps
+ * around; the next peek (after the release) continues from the ring start.
+ * Peeking again without a release returns the same descriptors.
+ *
+ * @param[in]		ppio	A pointer to a PP-IO object.
+ * @param[in]		tc	traffic class on which to receive frames
+ * @param[in]		qid	in-Q id on which to receive the frames.
+ * @param[out]		descs	A pointer to the first received descriptor.
+ * @param[in,out]	num	input: Max number of frames to peek at;
+ *				output: number of frames available at 'descs'.
+ *
+ * @retval	0 on success
+ * @retval	error-code otherwise (not supported on big-endian hosts)
+ */
+int pp2_ppio_recv_peek(struct pp2_ppio		 *ppio,
+		       u8			  tc,
+		       u8			  qid,
+		       struct pp2_ppio_desc	**descs,
+		       u16			 *num);
+
+/**
+ * Release descriptors obtained by pp2_ppio_recv_peek().
+ *
+ * Advances the in-Q ring and returns the descriptors to the HW; they must not
+ * be accessed anymore.
+ *
+ * @param[in]		ppio	A pointer to a PP-IO object.
+ * @param[in]		tc	traffic class of the in-Q.
+ * @param[in]		qid	in-Q id.
+ * @param[in]		num	Number of descriptors to release; at most the
+ *				number returned by the last peek.
+ *
+ * @retval	0 on success
+ * @retval	error-code otherwise
+ */
+int pp2_ppio_recv_release(struct pp2_ppio *ppio, u8 tc, u8 qid, u16 num);
+
+/**
+ * Get the number of received descriptors waiting in an in-Q.
+ *
+ * Reads the in-Q occupancy from the HW; intended for monitoring, not for the
+ * receive path itself.
+ *
+ * @param[in]		ppio	A pointer to a PP-IO object.
+ * @param[in]		tc	traffic class of the in-Q.
+ * @param[in]		qid	in-Q id.
+ * @param[out]		num	Number of descriptors occupied by received frames.
+ *
+ * @retval	0 on success
+ * @retval	error-code otherwise
+ */
+int pp2_ppio_get_num_inq_descs(struct pp2_ppio *ppio, u8 tc, u8 qid, u16 *num);
+
 /**
  * Get in-Q statistics
  *
@@ -1299,6 +1407,43 @@ int pp2_ppio_set_mc_promisc(struct pp2_ppio *ppio, int en);
  */
 int pp2_ppio_get_mc_promisc(struct pp2_ppio *ppio, int *en);
 
+/**
+ * Set the in-Q of an RSS indirection table line
+ *
+ * The hash of a received packet selects one of PP2_PPIO_RSS_TBL_SIZE lines,
+ * which holds the in-Q of the TC the packet is queued on. The table is
+ * initially spread evenly over the in-Qs of the TC; this allows moving a line
+ * (and so all the flows hashed to it) to another in-Q at run time, e.g. by
+ * the mv_rss_bal rebalancer.
+ *
+ * Note: the RSS tables are allocated per number of in-Qs, so the change
+ * applies to all the TCs (of all the ppios) with the same number of in-Qs.
+ *
+ * @param[in]		ppio	A pointer to a PP-IO object.
+ * @param[in]		tc	traffic class.
+ * @param[in]		line	RSS table line (0 .. PP2_PPIO_RSS_TBL_SIZE - 1).
+ * @param[in]		qid	in-Q id.
+ *
+ * @retval	0 on success
+ * @retval	-EPERM if RSS is not used by the TC
+ * @retval	error-code otherwise
+ */
+int pp2_ppio_set_rss_entry(struct pp2_ppio *ppio, u8 tc, u8 line, u8 qid);
+
+/**
+ * Get the in-Q of an RSS indirection table line
+ *
+ * @param[in]		ppio	A pointer to a PP-IO object.
+ * @param[in]		tc	traffic class.
+ * @param[in]		line	RSS table line (0 .. PP2_PPIO_RSS_TBL_SIZE - 1).
+ * @param[out]		qid	in-Q id.
+ *
+ * @retval	0 on success
+ * @retval	-EPERM if RSS is not used by the TC
+ * @retval	error-code otherwise
+ */
+int pp2_ppio_get_rss_entry(struct pp2_ppio *ppio, u8 tc, u8 line, u8 *qid);
+
 /**
  * Add ppio Ethernet MAC address
  *
@@ -1414,6 +1559,60 @@ int pp2_ppio_get_link_state(struct pp2_ppio *ppio, int *en);
  */
 int pp2_ppio_get_link_info(struct pp2_ppio *ppio, struct pp2_ppio_link_info *link_info);
 
+/**
+ * ppio link change notification parameters
+ */
+struct pp2_ppio_link_event_params {
+	u32	debounce_ms;	/**< Time the link must hold a new state before it is reported;
+				 * shorter flaps are filtered out. 0 - report every change.
+				 */
+	void	(*cb)(void *arg, struct pp2_ppio *ppio, int link_up); /**< Called on a link change */
+	void	*arg;		/**< Argument passed to 'cb' */
+};
+
+/**
+ * Register for link change notifications
+ *
+ * Link changes are reported through 'params->cb', from pp2_ppio_link_event_process().
+ * If the port has a Linux netdev, the link changes are received on a file descriptor
+ * that becomes readable on a change, so pp2_ppio_link_event_process() needs to be called
+ * only then (and when its 'timeout' expires); otherwise the link is sampled on each call.
+ *
+ * @param[in]		ppio	A pointer to a PP-IO object.
+ * @param[in]		params	Notification parameters.
+ * @param[out]		fd	File descriptor to wait on (e.g. with poll()); -1 if
+ *				pp2_ppio_link_event_process() must be called periodically.
+ *
+ * @retval	0 on success
+ * @retval	error-code otherwise
+ */
+int pp2_ppio_link_event_register(struct pp2_ppio *ppio, struct pp2_ppio_link_event_params *params, int *fd);
+
+/**
+ * Process link change notifications
+ *
+ * Non-blocking; invokes the registered callback if the link changed (and held the new
+ * state for the debounce period).
+ *
+ * @param[in]		ppio	A pointer to a PP-IO object.
+ * @param[out]		timeout	Time (in msec) after which this function should be called again
+ *				even if the file descriptor is not readable; -1 if not needed.
+ *
+ * @retval	0 on success
+ * @retval	error-code otherwise
+ */
+int pp2_ppio_link_event_process(struct pp2_ppio *ppio, int *timeout);
+
+/**
+ * Deregister from link change notifications
+ *
+ * @param[in]		ppio	A pointer to a PP-IO object.
+ *
+ * @retval	0 on success
+ * @retval	error-code otherwise
+ */
+int pp2_ppio_link_event_deregister(struct pp2_ppio *ppio);
+
 /**
  * Set outq state
  *
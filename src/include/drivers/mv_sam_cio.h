@@ -316,6 +316,32 @@ int sam_cio_deq(struct sam_cio *cio, struct sam_cio_op_result *results, u16 *num
  */
 int sam_cio_enq_ipsec(struct sam_cio *cio, struct sam_cio_ipsec_params *requests, u16 *num);
 
+/**
+ * Software anti-replay pre-check of a burst of inbound IPsec requests
+ *
+ * Meant to be called just before sam_cio_enq_ipsec() so that replayed and
+ * out-of-window packets never reach the engine. Only sessions created with
+ * "replay_win_size" are checked; the window itself is updated on dequeue,
+ * after the packet was authenticated, and a packet that fails there is
+ * returned with SAM_CIO_ERR_ANTIREPLAY status.
+ *
+ * The check does not take locks: a session with a software window must be
+ * used by one thread at a time.
+ *
+ * @param[in,out] requests	- array of requests; rejected requests are removed and
+ *				  the remaining ones keep their order.
+ * @param[in,out] num		- input: number of requests;
+ *				  output: number of requests that passed the check.
+ * @param[out]	  rejected	- array (of at least *num entries) filled with the
+ *				  cookies of the rejected requests.
+ * @param[out]	  num_rejected	- number of rejected requests.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int sam_cio_ipsec_replay_check(struct sam_cio_ipsec_params *requests, u16 *num,
+			       void **rejected, u16 *num_rejected);
+
 int sam_cio_enq_ssltls(struct sam_cio *cio, struct sam_cio_ssltls_params *requests, u16 *num);
 
 /**
@@ -395,6 +421,20 @@ int sam_cio_delete_event(struct sam_cio *cio, struct mv_sys_event *ev);
  */
 int sam_cio_set_event(struct sam_cio *cio, struct mv_sys_event *ev, int en);
 
+/**
+ * Set crypto IO event coalescing.
+ *
+ * The new values take effect the next time the event is enabled.
+ *
+ * @param[in]	cio        - crypto IO instance handler.
+ * @param[in]	pkt_coal   - number of results to trigger the event.
+ * @param[in]	usec_coal  - max time in usecs from the first result to the event.
+ *
+ * @retval      0          - success.
+ * @retval      Negative   - failure.
+ */
+int sam_cio_set_event_coal(struct sam_cio *cio, u32 pkt_coal, u32 usec_coal);
+
 int sam_cio_enable(struct sam_cio *cio);
 int sam_cio_disable(struct sam_cio *cio);
 
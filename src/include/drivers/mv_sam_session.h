@@ -253,6 +253,10 @@ struct sam_session_ipsec_params {
 	struct sam_sa_ipsec_natt natt;		/**< NAT-Traversal parameters */
 	u64 seq;				/**< Initial sequence number */
 	u32 spi;				/**< SPI value */
+	u32 replay_win_size;			/**< Inbound only: software anti-replay window size in bits
+						 *   (64, 128, ... 4096); 0 - disabled.
+						 *   See sam_cio_ipsec_replay_check().
+						 */
 };
 
 /** SSL/TLS/DTLS session parameters */
@@ -106,7 +106,7 @@
 
 #define __iomem
 
-#if __WORDSIZE == 64
+#if defined(__aarch64__)
 #define dsb(opt)	({ asm volatile("dsb " #opt : : : "memory"); })
 #define mb()		dsb(sy)
 #define rmb()		dsb(ld)
@@ -117,7 +117,7 @@
 #define smp_rmb()	dmb(ishld)
 #define smp_wmb()	dmb(ishst)
 #define cpu_relax()    ({ asm volatile("yield" : : : "memory"); })
-#else
+#elif defined(__arm__)
 #define dmb(opt)	({ asm volatile("dmb " #opt : : : "memory"); })
 #define rmb()		dmb(sy)
 #define wmb()		dmb(sy)
@@ -127,15 +127,34 @@
 #define barrier()	({ asm volatile("" : : : "memory"); })
 #define cpu_relax()	barrier()
 
+#else
+/* Portable fallback for non-ARM hosts (e.g. running the PPv2 emulator) */
+#define mb()		__sync_synchronize()
+#define rmb()		mb()
+#define wmb()		mb()
+#define __iormb()	rmb()
+#define __iowmb()	wmb()
+#define smp_mb()	mb()
+#define smp_rmb()	mb()
+#define smp_wmb()	mb()
+
+#define barrier()	({ asm volatile("" : : : "memory"); })
+#define cpu_relax()	barrier()
+
 #endif
 
+#if defined(__aarch64__) || defined(__arm__)
 #define dccivac(_p)	({ __asm__ __volatile__("dc civac, %0\n\t" : : "r" (_p) : "memory"); })
+#else
+/* DMA is cache coherent on the hosts of the portable fallback */
+#define dccivac(_p)	({ (void)(_p); })
+#endif
 
 /*
  * Generic IO read/write.  These perform native-endian accesses.
 */
 
-#if __WORDSIZE == 64
+#if defined(__aarch64__)
 static inline u8 __raw_mv_readb(const volatile void __iomem *addr)
 {
 	u8 val;
@@ -188,7 +207,7 @@ static inline void __raw_mv_writeq(u64 val, volatile void __iomem *addr)
 	asm volatile("str %0, [%1]" : : "r" (val), "r" (addr));
 }
 
-#else
+#elif defined(__arm__)
 static inline u8 __raw_mv_readb(const volatile void __iomem *addr)
 {
 	u8 val;
@@ -236,6 +255,46 @@ static inline void __raw_mv_writel(u32 val, volatile void __iomem *addr)
 	asm volatile("str %1, %0"
 		     : : "Qo" (*(u32 *)addr), "r" (val));
 }
+#else
+static inline u8 __raw_mv_readb(const volatile void __iomem *addr)
+{
+	return *(const volatile u8 *)addr;
+}
+
+static inline u16 __raw_mv_readw(const volatile void __iomem *addr)
+{
+	return *(const volatile u16 *)addr;
+}
+
+static inline u32 __raw_mv_readl(const volatile void __iomem *addr)
+{
+	return *(const volatile u32 *)addr;
+}
+
+static inline u64 __raw_mv_readq(const volatile void __iomem *addr)
+{
+	return *(const volatile u64 *)addr;
+}
+
+static inline void __raw_mv_writeb(u8 val, volatile void __iomem *addr)
+{
+	*(volatile u8 *)addr = val;
+}
+
+static inline void __raw_mv_writew(u16 val, volatile void __iomem *addr)
+{
+	*(volatile u16 *)addr = val;
+}
+
+static inline void __raw_mv_writel(u32 val, volatile void __iomem *addr)
+{
+	*(volatile u32 *)addr = val;
+}
+
+static inline void __raw_mv_writeq(u64 val, volatile void __iomem *addr)
+{
+	*(volatile u64 *)addr = val;
+}
 #endif
 
 /*
@@ -0,0 +1,352 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#ifndef __MV_BTRACE_H__
+#define __MV_BTRACE_H__
+
+#include <time.h>
+
+#include "mv_types.h"
+#include "mv_compiler.h"
+
+/**
+ * Binary trace ring
+ *
+ * Low overhead alternative to the LTTng tracepoints (see env/trace) meant to stay
+ * compiled in production builds (--enable-btrace). Every thread records fixed-size
+ * binary records into its own lock-free ring; a record is just a timestamp,
+ * a tracepoint id and up to MV_BTRC_MAX_ARGS raw u64 arguments - no string
+ * formatting in the data-path. Recording is gated by a per-category runtime mask.
+ * The rings operate as a flight recorder (oldest records are overwritten) and are
+ * written to a file by mv_btrc_dump(); the file is decoded off-line by
+ * the musdk_btrace_decode tool (text or Chrome trace JSON).
+ */
+
+#define MV_BTRC_MAGIC		0x5442564d	/* "MVBT" */
+#define MV_BTRC_VERSION		1
+#define MV_BTRC_MAX_ARGS	4
+#define MV_BTRC_NAME_MAX	32
+#define MV_BTRC_MAX_TPS		256
+#define MV_BTRC_MAX_RINGS	64
+#define MV_BTRC_DEF_RING_SIZE	4096		/* records per thread */
+
+/**
+ * Trace categories. Each category is enabled/disabled at runtime by
+ * mv_btrc_enable(); up to 32 categories are supported.
+ */
+enum mv_btrc_cat {
+	MV_BTRC_CAT_GIE = 0,
+	MV_BTRC_CAT_SAM,
+	MV_BTRC_CAT_PP2,
+	MV_BTRC_CAT_APP,
+	MV_BTRC_CAT_LAST
+};
+
+#define MV_BTRC_CAT_ALL		0xffffffff
+
+/**
+ * Tracepoint types; BEGIN/END pairs on the same thread (and same arg0) form a
+ * duration event in the decoded output.
+ */
+enum mv_btrc_type {
+	MV_BTRC_TYPE_INSTANT = 0,
+	MV_BTRC_TYPE_BEGIN,
+	MV_BTRC_TYPE_END
+};
+
+/**
+ * Built-in tracepoint ids. Applications may register their own tracepoints
+ * starting from MV_BTRC_ID_APP_FIRST.
+ */
+enum mv_btrc_id {
+	MV_BTRC_ID_GIE_DMA = 0,		/* src, dst, size */
+	MV_BTRC_ID_GIE_QE_COPY,		/* qes, src_qid, src_tail, dst_qid */
+	MV_BTRC_ID_GIE_QE_PRODUCE,	/* qes, src_qid, src_head, dst_qid */
+	MV_BTRC_ID_SAM_ENQ_START,	/* cio, requested */
+	MV_BTRC_ID_SAM_ENQ_END,		/* cio, enqueued */
+	MV_BTRC_ID_SAM_DEQ_START,	/* cio, requested */
+	MV_BTRC_ID_SAM_DEQ_END,		/* cio, dequeued, ready */
+	MV_BTRC_ID_BUILTIN_LAST,
+
+	MV_BTRC_ID_APP_FIRST = 64
+};
+
+/**
+ * Trace record - 48 bytes
+ */
+struct mv_btrc_rec {
+	u64	ts;				/**< timestamp in ticks (see mv_btrc_file_hdr.ts_freq) */
+	u32	seq;				/**< low 32 bits of the ring write index */
+	u16	id;				/**< tracepoint id */
+	u16	rsvd;
+	u64	args[MV_BTRC_MAX_ARGS];		/**< raw arguments */
+};
+
+/**
+ * Per-thread trace ring. Single writer (the owning thread); readers snapshot it
+ * using the seq field to detect records overwritten while copying.
+ */
+struct mv_btrc_ring {
+	u64	head;		/**< total number of records written */
+	u32	size;		/**< number of records; power of 2 */
+	u32	tid;		/**< owning thread id */
+	struct mv_btrc_rec recs[];
+};
+
+/**
+ * Tracepoint description, stored in the dump file for the decoder.
+ */
+struct mv_btrc_tp {
+	u16	id;
+	u8	cat;
+	u8	type;				/**< enum mv_btrc_type */
+	u32	nargs;
+	char	name[MV_BTRC_NAME_MAX];
+	char	arg_names[MV_BTRC_MAX_ARGS][16];
+};
+
+/**
+ * Dump file layout:
+ *	struct mv_btrc_file_hdr
+ *	struct mv_btrc_tp	* num_tps
+ *	for each ring: struct mv_btrc_ring_hdr followed by 'num_recs' records,
+ *	oldest first.
+ */
+struct mv_btrc_file_hdr {
+	u32	magic;
+	u32	version;
+	u64	ts_freq;			/**< timestamp ticks per second */
+	u32	num_tps;
+	u32	num_rings;
+	u32	cat_mask;			/**< categories enabled at dump time */
+	u32	rsvd;
+};
+
+struct mv_btrc_ring_hdr {
+	u32	tid;
+	u32	num_recs;
+	u64	lost;				/**< records overwritten before the dump */
+};
+
+extern u32 mv_btrc_cat_mask;
+extern u32 mv_btrc_gen;
+extern __thread struct mv_btrc_ring *mv_btrc_local_ring;
+extern __thread u32 mv_btrc_local_gen;
+
+/**
+ * Initialize the binary trace facility
+ *
+ * Must be called before any tracepoint is recorded. Registers the built-in
+ * tracepoints. Categories are initially disabled.
+ *
+ * @param[in]	ring_size - number of records in each per-thread ring (rounded up to
+ *			    a power of 2); 0 selects MV_BTRC_DEF_RING_SIZE.
+ *
+ * @retval	0         - success
+ * @retval	Negative  - failure
+ */
+int mv_btrc_init(u32 ring_size);
+
+/**
+ * Release all trace rings
+ *
+ * Must not run concurrently with tracepoint recording. The rings cached by the
+ * threads are invalidated, so the threads attach new rings when tracing is
+ * initialized and enabled again.
+ */
+void mv_btrc_deinit(void);
+
+/**
+ * Register an application tracepoint
+ *
+ * @param[in]	tp	  - tracepoint description; tp->id must be in range
+ *			    [MV_BTRC_ID_APP_FIRST, MV_BTRC_MAX_TPS).
+ *
+ * @retval	0         - success
+ * @retval	Negative  - failure
+ */
+int mv_btrc_register(struct mv_btrc_tp *tp);
+
+/**
+ * Enable/disable trace categories at runtime
+ *
+ * @param[in]	cat_mask  - bitmap of categories (BIT(enum mv_btrc_cat)).
+ * @param[in]	en	  - 1 to enable, 0 to disable.
+ */
+void mv_btrc_enable(u32 cat_mask, int en);
+
+/**
+ * Write a snapshot of all trace rings to a file
+ *
+ * May be called while other threads keep recording; records overwritten during
+ * the copy are dropped from the snapshot.
+ *
+ * @param[in]	file	  - output file name.
+ *
+ * @retval	0         - success
+ * @retval	Negative  - failure
+ */
+int mv_btrc_dump(const char *file);
+
+/**
+ * Allocate and attach the calling thread's trace ring (slow path of mv_btrc()).
+ *
+ * @retval	pointer to the ring, NULL on failure
+ */
+struct mv_btrc_ring *mv_btrc_ring_attach(void);
+
+/**
+ * Read the trace timestamp counter
+ */
+static inline u64 mv_btrc_ts(void)
+{
+#if defined(__aarch64__)
+	u64 ts;
+
+	asm volatile("mrs %0, cntvct_el0" : "=r" (ts));
+	return ts;
+#else
+	struct timespec tv;
+
+	clock_gettime(CLOCK_MONOTONIC, &tv);
+	return (u64)tv.tv_sec * 1000000000ULL + tv.tv_nsec;
+#endif
+}
+
+/**
+ * Record a tracepoint into the calling thread's ring
+ *
+ * @param[in]	cat	  - category (enum mv_btrc_cat).
+ * @param[in]	id	  - tracepoint id.
+ * @param[in]	a0..a3	  - tracepoint arguments.
+ */
+static inline void mv_btrc_record(u32 cat, u16 id, u64 a0, u64 a1, u64 a2, u64 a3)
+{
+	struct mv_btrc_ring *ring;
+	struct mv_btrc_rec *rec;
+	u64 head;
+
+	if (likely(!(__atomic_load_n(&mv_btrc_cat_mask, __ATOMIC_RELAXED) & (1U << cat))))
+		return;
+
+	ring = mv_btrc_local_ring;
+	/* a ring cached before the last mv_btrc_deinit() was freed */
+	if (unlikely(!ring || mv_btrc_local_gen != __atomic_load_n(&mv_btrc_gen, __ATOMIC_ACQUIRE))) {
+		ring = mv_btrc_ring_attach();
+		if (!ring)
+			return;
+	}
+
+	head = ring->head;
+	rec = &ring->recs[head & (ring->size - 1)];
+	__atomic_store_n(&rec->seq, (u32)head, __ATOMIC_RELAXED);
+	rec->ts = mv_btrc_ts();
+	rec->id = id;
+	rec->args[0] = a0;
+	rec->args[1] = a1;
+	rec->args[2] = a2;
+	rec->args[3] = a3;
+	__atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+#ifdef MVCONF_BTRACE
+#define mv_btrc(cat, id, a0, a1, a2, a3)	\
+	mv_btrc_record(cat, id, (u64)(a0), (u64)(a1), (u64)(a2), (u64)(a3))
+#else
+#define mv_btrc(cat, id, a0, a1, a2, a3)
+#endif /* MVCONF_BTRACE */
+
+#endif /* __MV_BTRACE_H__ */
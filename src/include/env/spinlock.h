@@ -98,29 +98,226 @@
 #define __SPINLOCK_H__
 
 #ifndef __KERNEL__
+#include <string.h>
+#include "env/mv_autogen_comp_flags.h"
+#include "env/mv_types.h"
 #include "env/mv_debug.h"
 
 #ifndef spinlock_t
 
+/*
+ * Three lock flavours are available, selected at build time (configure
+ * --enable-spinlock=<tas|ticket|mcs>, recorded in mv_autogen_comp_flags.h as
+ * the spinlock_t layout differs between them):
+ *  - tas (default):   test-and-set on a byte. Cheapest uncontended, but
+ *                     unfair; under contention waiters may starve.
+ *  - ticket:          FIFO order; all waiters spin on the same line.
+ *  - mcs:             queued lock; FIFO order and only the queue head spins on
+ *                     the lock word, the others spin on their own (per-thread)
+ *                     queue node. Recommended when many cores share a lock.
+ *
+ * With MVCONF_SPINLOCK_STAT (--enable-spinlock-stat) every lock counts its
+ * acquisitions, contended acquisitions and wait loop iterations; see
+ * spin_lock_get_stats(). The counters are updated while holding the lock.
+ */
+
+#if defined(__aarch64__) || defined(__arm__)
+#define spin_relax()	({ asm volatile("yield" : : : "memory"); })
+#else
+#define spin_relax()	({ asm volatile("" : : : "memory"); })
+#endif
+
+/**
+ * spinlock statistics
+ */
+struct spin_lock_stats {
+	u64	acquired;	/**< number of successful spin_lock()/spin_trylock() */
+	u64	contended;	/**< acquisitions that had to wait */
+	u64	spins;		/**< total wait loop iterations */
+};
+
+#ifdef MVCONF_SPINLOCK_STAT
+#define SPIN_LOCK_STAT_FIELDS	struct spin_lock_stats stats;
+#define spin_lock_stat_inc(_lock, _spins)			\
+	do {							\
+		(_lock)->stats.acquired++;			\
+		(_lock)->stats.contended += !!(_spins);		\
+		(_lock)->stats.spins += (_spins);		\
+	} while (0)
+#else
+#define SPIN_LOCK_STAT_FIELDS
+#define spin_lock_stat_inc(_lock, _spins)	do { (void)(_spins); } while (0)
+#endif /* MVCONF_SPINLOCK_STAT */
+
+#if defined(MVCONF_SPINLOCK_TICKET)
+
+typedef struct  spinlock {
+	union {
+		u32	val;
+		struct {
+			u16	owner;	/* ticket being served */
+			u16	next;	/* next ticket to hand out */
+		} tickets;
+	};
+	SPIN_LOCK_STAT_FIELDS
+} spinlock_t;
+
+static inline void spin_lock_init(spinlock_t *spinlock)
+{
+	memset(spinlock, 0, sizeof(*spinlock));
+}
+
+static inline void spin_lock(spinlock_t *spinlock)
+{
+	u16 ticket = __atomic_fetch_add(&spinlock->tickets.next, 1, __ATOMIC_RELAXED);
+	u64 spins = 0;
+
+	while (__atomic_load_n(&spinlock->tickets.owner, __ATOMIC_ACQUIRE) != ticket) {
+		spin_relax();
+		spins++;
+	}
+	spin_lock_stat_inc(spinlock, spins);
+}
+
+static inline int spin_trylock(spinlock_t *spinlock)
+{
+	u32 old = __atomic_load_n(&spinlock->val, __ATOMIC_RELAXED);
+	u32 new;
+
+	if ((old & 0xffff) != (old >> 16))
+		return 0;
+	/* both halves equal: take the next ticket, which is also the owner one */
+	new = old + (1 << 16);
+	if (!__atomic_compare_exchange_n(&spinlock->val, &old, new, 0,
+					 __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+		return 0;
+	spin_lock_stat_inc(spinlock, 0);
+	return 1;
+}
+
+static inline void spin_unlock(spinlock_t *spinlock)
+{
+	/* only the holder writes 'owner' */
+	__atomic_store_n(&spinlock->tickets.owner, spinlock->tickets.owner + 1, __ATOMIC_RELEASE);
+}
+
+#elif defined(MVCONF_SPINLOCK_MCS)
+
+struct spin_mcs_node {
+	struct spin_mcs_node	*next;
+	u32			 wait;
+};
+
+/* A thread needs its queue node only while waiting inside spin_lock(), so one
+ * node per thread is enough, regardless of how many locks it holds.
+ */
+extern __thread struct spin_mcs_node spin_mcs_node;
+
+typedef struct  spinlock {
+	u32			 locked;
+	struct spin_mcs_node	*tail;	/* last waiter, NULL if none */
+	SPIN_LOCK_STAT_FIELDS
+} spinlock_t;
+
+static inline void spin_lock_init(spinlock_t *spinlock)
+{
+	memset(spinlock, 0, sizeof(*spinlock));
+}
+
+static inline int __spin_lock_take(spinlock_t *spinlock)
+{
+	u32 unlocked = 0;
+
+	return __atomic_compare_exchange_n(&spinlock->locked, &unlocked, 1, 0,
+					   __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+static inline void spin_lock(spinlock_t *spinlock)
+{
+	struct spin_mcs_node *node, *prev, *next, *expected;
+	u64 spins = 0;
+
+	/* fast path: free lock and nobody queued */
+	if (!__atomic_load_n(&spinlock->tail, __ATOMIC_RELAXED) && __spin_lock_take(spinlock)) {
+		spin_lock_stat_inc(spinlock, spins);
+		return;
+	}
+
+	node = &spin_mcs_node;
+	node->next = NULL;
+	node->wait = 1;
+	prev = __atomic_exchange_n(&spinlock->tail, node, __ATOMIC_ACQ_REL);
+	if (prev) {
+		__atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+		while (__atomic_load_n(&node->wait, __ATOMIC_ACQUIRE)) {
+			spin_relax();
+			spins++;
+		}
+	}
+
+	/* queue head: wait for the owner to release */
+	while (!__spin_lock_take(spinlock)) {
+		while (__atomic_load_n(&spinlock->locked, __ATOMIC_RELAXED)) {
+			spin_relax();
+			spins++;
+		}
+	}
+
+	/* leave the queue and wake up the next waiter */
+	expected = node;
+	if (!__atomic_compare_exchange_n(&spinlock->tail, &expected, NULL, 0,
+					 __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+		while (!(next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE)))
+			spin_relax();
+		__atomic_store_n(&next->wait, 0, __ATOMIC_RELEASE);
+	}
+	spin_lock_stat_inc(spinlock, spins);
+}
+
+static inline int spin_trylock(spinlock_t *spinlock)
+{
+	if (__atomic_load_n(&spinlock->locked, __ATOMIC_RELAXED) || !__spin_lock_take(spinlock))
+		return 0;
+	spin_lock_stat_inc(spinlock, 0);
+	return 1;
+}
+
+static inline void spin_unlock(spinlock_t *spinlock)
+{
+	__atomic_store_n(&spinlock->locked, 0, __ATOMIC_RELEASE);
+}
+
+#else /* test-and-set */
+
 typedef struct  spinlock {
 	char lock;
+	SPIN_LOCK_STAT_FIELDS
 } spinlock_t;
 
 static inline void spin_lock_init(spinlock_t *spinlock)
 {
 	__atomic_clear((&spinlock->lock), __ATOMIC_RELAXED);
+#ifdef MVCONF_SPINLOCK_STAT
+	memset(&spinlock->stats, 0, sizeof(spinlock->stats));
+#endif
 }
 
 static inline void spin_lock(spinlock_t *spinlock)
 {
+	u64 spins = 0;
+
 	while (__atomic_test_and_set((&spinlock->lock), __ATOMIC_ACQUIRE))
 		while (__atomic_load_n((&spinlock->lock), __ATOMIC_RELAXED))
-			;
+			spins++;
+	spin_lock_stat_inc(spinlock, spins);
 }
 
 static inline int spin_trylock(spinlock_t *spinlock)
 {
-	return (__atomic_test_and_set((&spinlock->lock), __ATOMIC_ACQUIRE) == 0);
+	if (__atomic_test_and_set((&spinlock->lock), __ATOMIC_ACQUIRE))
+		return 0;
+	spin_lock_stat_inc(spinlock, 0);
+	return 1;
 }
 
 static inline void spin_unlock(spinlock_t *spinlock)
@@ -128,6 +325,29 @@ static inline void spin_unlock(spinlock_t *spinlock)
 	__atomic_clear((&spinlock->lock), __ATOMIC_RELEASE);
 }
 
+#endif /* MVCONF_SPINLOCK_TICKET / MVCONF_SPINLOCK_MCS */
+
+/**
+ * Get the lock statistics
+ *
+ * Should be called while holding the lock (or when it is idle) to get a
+ * consistent snapshot.
+ *
+ * @param[in]	spinlock	A lock.
+ * @param[out]	stats		Statistics; all zero unless MVCONF_SPINLOCK_STAT is set.
+ * @param[in]	reset		Clear the counters after reading.
+ */
+static inline void spin_lock_get_stats(spinlock_t *spinlock, struct spin_lock_stats *stats, int reset)
+{
+#ifdef MVCONF_SPINLOCK_STAT
+	*stats = spinlock->stats;
+	if (reset)
+		memset(&spinlock->stats, 0, sizeof(spinlock->stats));
+#else
+	memset(stats, 0, sizeof(*stats));
+#endif
+}
+
 #define spin_lock_irqsave(_lock, _flags)\
 	do {				\
 		local_irq_save(_flags);	\
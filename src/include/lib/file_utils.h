@@ -109,6 +109,8 @@ int write_buf_to_file(char *file_name, char *buff, u32 size);
 /**
  * Read a file to buffer
  *
+ * The content is NUL terminated, so at most size - 1 bytes are read.
+ *
  * @param[in]	file_name	path to file.
  * @param[in]	size		size of buffer to read.
  * @param[out]	buff		pointer to buffer to read the file
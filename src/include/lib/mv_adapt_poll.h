@@ -0,0 +1,261 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#ifndef __MV_ADAPT_POLL_H__
+#define __MV_ADAPT_POLL_H__
+
+#include "mv_std.h"
+#include "env/mv_sys_event.h"
+
+/**
+ * Adaptive interrupt/poll hybrid
+ *
+ * Tracks the load of a queue that is polled by a data path thread and moves
+ * it between three modes:
+ *	- BUSY:  load above 'high_pps'; the queue is busy-polled and never sleeps
+ *		 until the load drops below 'low_pps' (hysteresis);
+ *	- POLL:  moderate load; the queue is polled and goes to sleep after
+ *		 'idle_polls' consecutive empty polls, once it stayed at least
+ *		 'min_poll_usecs' in POLL mode (hysteresis against flapping);
+ *	- SLEEP: the thread waits on the queue system event (mv_sys_event).
+ *
+ * When going to sleep the interrupt coalescing is adapted to the last observed
+ * rate: the packet threshold is the number of packets expected within
+ * 'max_usec_coal', so that a busy wakeup is served in one burst while a single
+ * packet still gets through after 'max_usec_coal' at most.
+ *
+ * The component drives any queue through its set_event/set_coal callbacks, e.g.
+ * sam_cio_set_event()/sam_cio_set_event_coal() for SAM rings or
+ * pp2_ppio_rx_set_event() for PPIO RX queues. Time is passed in by the caller.
+ *
+ * Usage:
+ *	for (;;) {
+ *		n = <dequeue>;
+ *		mv_apoll_update(ap, n, now_ns);
+ *		if (mv_apoll_should_sleep(&ap, 1))
+ *			mv_apoll_wait(&ap, 1, timeout_ms, now_ns);
+ *	}
+ */
+
+/** Queue modes */
+enum mv_apoll_mode {
+	MV_APOLL_MODE_POLL = 0,
+	MV_APOLL_MODE_BUSY,
+	MV_APOLL_MODE_SLEEP
+};
+
+/** Adaptive poll parameters; zero fields take the defaults */
+struct mv_apoll_params {
+	struct mv_sys_event	*ev;		/**< queue event */
+	void			*arg;		/**< callbacks argument (e.g. the cio) */
+	/** enable (1) / disable (0) the queue event; mandatory */
+	int (*set_event)(void *arg, struct mv_sys_event *ev, int en);
+	/** set the event coalescing; optional */
+	int (*set_coal)(void *arg, u32 pkt_coal, u32 usec_coal);
+	u32			 idle_polls;	/**< empty polls before sleeping (default 64) */
+	u32			 min_poll_usecs;/**< min time in POLL mode after a wakeup (default 20) */
+	u32			 low_pps;	/**< leave BUSY below this rate (default 250K) */
+	u32			 high_pps;	/**< enter BUSY above this rate (default 500K) */
+	u32			 sample_usecs;	/**< rate sampling period (default 50) */
+	u32			 max_usec_coal;	/**< max event latency (default 100) */
+	u32			 max_pkt_coal;	/**< max event packet threshold (default 64) */
+};
+
+/** Adaptive poll statistics */
+struct mv_apoll_stats {
+	u64	polls;		/**< calls to mv_apoll_update() */
+	u64	empty_polls;	/**< polls that returned no packets */
+	u64	pkts;		/**< packets reported */
+	u64	sleeps;		/**< times the queue was armed */
+	u64	busy_entries;	/**< times the queue entered BUSY mode */
+	u64	sleep_ns;	/**< time spent in SLEEP mode */
+};
+
+struct mv_apoll;
+
+/**
+ * Create an adaptive poll instance for a queue
+ *
+ * The queue event must be disabled; the instance starts in POLL mode.
+ *
+ * @param[in]	params	- parameters.
+ * @param[out]	ap	- address of place to save the instance handle.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int mv_apoll_create(struct mv_apoll_params *params, struct mv_apoll **ap);
+
+/**
+ * Destroy an adaptive poll instance; the queue event is disabled if armed
+ *
+ * @param[in]	ap	- instance handle.
+ */
+void mv_apoll_destroy(struct mv_apoll *ap);
+
+/**
+ * Report the result of a poll of the queue
+ *
+ * @param[in]	ap	- instance handle.
+ * @param[in]	pkts	- number of packets received by the poll.
+ * @param[in]	now_ns	- current time in nsec.
+ */
+void mv_apoll_update(struct mv_apoll *ap, u32 pkts, u64 now_ns);
+
+/**
+ * Check whether a thread polling the given queues may go to sleep
+ *
+ * @param[in]	ap	- array of instance handles.
+ * @param[in]	num	- number of instances.
+ *
+ * @retval	1 if all the queues are idle, 0 otherwise
+ */
+int mv_apoll_should_sleep(struct mv_apoll **ap, int num);
+
+/**
+ * Arm the events of the queues: set the adaptive coalescing and enable them
+ *
+ * @param[in]	ap	- array of instance handles.
+ * @param[in]	num	- number of instances.
+ * @param[in]	now_ns	- current time in nsec.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int mv_apoll_arm(struct mv_apoll **ap, int num, u64 now_ns);
+
+/**
+ * Disarm the events of the queues after a wakeup and go back to POLL mode
+ *
+ * @param[in]	ap	- array of instance handles.
+ * @param[in]	num	- number of instances.
+ * @param[in]	now_ns	- current time in nsec.
+ */
+void mv_apoll_disarm(struct mv_apoll **ap, int num, u64 now_ns);
+
+/**
+ * Arm the queues, wait on their events (mv_sys_event_poll()) and disarm them
+ *
+ * @param[in]	ap	   - array of instance handles (up to 64).
+ * @param[in]	num	   - number of instances.
+ * @param[in]	timeout_ms - wait timeout in msec; -1 means no timeout.
+ * @param[in]	now_ns	   - current time in nsec; the wakeup time is read
+ *			     from CLOCK_MONOTONIC.
+ *
+ * @retval	>0 number of queues with events, 0 on timeout
+ * @retval	<0 on failure
+ */
+int mv_apoll_wait(struct mv_apoll **ap, int num, int timeout_ms, u64 now_ns);
+
+/**
+ * Get the current mode of a queue
+ *
+ * @param[in]	ap	- instance handle.
+ *
+ * @retval	enum mv_apoll_mode
+ */
+enum mv_apoll_mode mv_apoll_get_mode(struct mv_apoll *ap);
+
+/**
+ * Get the statistics of a queue
+ *
+ * @param[in]	ap	- instance handle.
+ * @param[out]	stats	- statistics.
+ * @param[in]	reset	- 1 - reset the counters after reading.
+ */
+void mv_apoll_get_stats(struct mv_apoll *ap, struct mv_apoll_stats *stats, int reset);
+
+#endif /* __MV_ADAPT_POLL_H__ */
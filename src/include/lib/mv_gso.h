@@ -0,0 +1,220 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#ifndef __MV_GSO_H__
+#define __MV_GSO_H__
+
+#include "mv_std.h"
+
+/**
+ * Software GSO (generic segmentation offload)
+ *
+ * Splits one large TCP or UDP frame, given as a chain of DMA buffers, into
+ * a batch of MSS-sized frames suitable for the send_sg APIs (pp2_ppio_send_sg(),
+ * neta_ppio_send_sg()). The payload is never copied: every output segment is
+ * a fragment holding a patched copy of the headers (written into a caller
+ * provided DMA area) followed by fragments pointing into the original buffers.
+ *
+ * Per segment the helper fixes the IPv4 total length / ID / header checksum,
+ * the IPv6 payload length, the TCP sequence number and flags (FIN/PSH only on
+ * the last segment, CWR only on the first) or the UDP length. Checksums are
+ * updated incrementally from a template computed once per call; the L4
+ * checksum may be left for the HW (MV_GSO_L4_CSUM_HW).
+ *
+ * UDP frames are segmented into independent datagrams of 'mss' payload bytes
+ * (as UDP_SEGMENT does), not into IP fragments.
+ */
+
+#define MV_GSO_MAX_HDR_LEN	192	/**< max L2+L3+L4 header length */
+#define MV_GSO_MAX_SEG_FRAGS	16	/**< max fragments per segment, incl. header */
+#define MV_GSO_HDR_ALIGN	64	/**< alignment of each header copy in the header area */
+
+#define MV_GSO_FRAG_FIRST	0x2	/**< first fragment of a segment */
+#define MV_GSO_FRAG_LAST	0x1	/**< last fragment of a segment */
+
+enum mv_gso_l3_type {
+	MV_GSO_L3_IPV4 = 0,
+	MV_GSO_L3_IPV6
+};
+
+enum mv_gso_l4_type {
+	MV_GSO_L4_TCP = 0,
+	MV_GSO_L4_UDP
+};
+
+enum mv_gso_l4_csum {
+	MV_GSO_L4_CSUM_SW = 0,	/**< calculate the L4 checksum of every segment in SW */
+	MV_GSO_L4_CSUM_HW	/**< leave the L4 checksum to the HW (set gen_l4_chk in the descriptor) */
+};
+
+/** DMA buffer */
+struct mv_gso_buf {
+	void		*vaddr;
+	dma_addr_t	 paddr;
+	u32		 len;
+};
+
+/** Segmentation parameters */
+struct mv_gso_params {
+	u16			 mss;		/**< max L4 payload bytes per segment */
+	u8			 l3_offset;	/**< IP header offset in the first input buffer */
+	u8			 max_frags;	/**< max fragments per segment incl. the header one;
+						 *   0 means MV_GSO_MAX_SEG_FRAGS
+						 */
+	enum mv_gso_l4_csum	 l4_csum;
+	struct mv_gso_buf	 hdr_area;	/**< DMA area for the per-segment headers; needs
+						 *   num_segs * mv_gso_hdr_stride(hdr_len) bytes
+						 */
+};
+
+/** Output fragment; maps 1:1 to a send_sg descriptor */
+struct mv_gso_frag {
+	void		*vaddr;
+	dma_addr_t	 paddr;
+	u16		 len;
+	u8		 flags;		/**< MV_GSO_FRAG_FIRST/MV_GSO_FRAG_LAST */
+	u8		 rsvd;
+};
+
+/** Segmentation result info */
+struct mv_gso_info {
+	u8	l3_type;		/**< enum mv_gso_l3_type */
+	u8	l4_type;		/**< enum mv_gso_l4_type */
+	u8	l3_offset;
+	u8	l4_offset;
+	u16	hdr_len;		/**< L2+L3+L4 header length */
+	u16	num_segs;		/**< number of output segments */
+	u16	num_frags;		/**< number of output fragments */
+};
+
+/**
+ * Header area stride needed per segment
+ *
+ * @param[in]	hdr_len	  - L2+L3+L4 header length.
+ *
+ * @retval	number of bytes of the header area used by each segment
+ */
+static inline u32 mv_gso_hdr_stride(u16 hdr_len)
+{
+	return (hdr_len + MV_GSO_HDR_ALIGN - 1) & ~(MV_GSO_HDR_ALIGN - 1);
+}
+
+/**
+ * Segment a TCP/UDP frame
+ *
+ * The first input buffer must hold the complete L2/L3/L4 headers. IPv4 (with
+ * options, non-fragmented) and IPv6 (without extension headers) are supported.
+ *
+ * @param[in]	params	  - segmentation parameters.
+ * @param[in]	in	  - input buffer chain; in[0] starts with the L2 header.
+ * @param[in]	num_in	  - number of input buffers.
+ * @param[out]	frags	  - output fragments, grouped per segment.
+ * @param[in]	max_out	  - size of the 'frags' array.
+ * @param[out]	seg_frags - number of fragments of every segment; may be used as
+ *			    the 'frags' array of pp2_ppio_sg_pkts/neta_ppio_sg_pkts.
+ * @param[in]	max_segs  - size of the 'seg_frags' array.
+ * @param[out]	info	  - segmentation result info.
+ *
+ * @retval	0         - success
+ * @retval	-EINVAL   - unsupported or malformed frame
+ * @retval	-ENOSPC   - output arrays or header area too small
+ * @retval	-E2BIG    - a segment needs more than 'max_frags' fragments
+ */
+int mv_gso_segment(struct mv_gso_params *params, struct mv_gso_buf *in, u16 num_in,
+		   struct mv_gso_frag *frags, u16 max_out, u8 *seg_frags, u16 max_segs,
+		   struct mv_gso_info *info);
+
+#endif /* __MV_GSO_H__ */
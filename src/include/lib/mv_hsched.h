@@ -0,0 +1,250 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#ifndef __MV_HSCHED_H__
+#define __MV_HSCHED_H__
+
+#include "mv_std.h"
+
+/**
+ * Hierarchical software QoS scheduler
+ *
+ * A four level scheduler meant to sit in front of pp2_ppio_send():
+ *	port -> subscriber -> traffic class -> queue
+ *
+ * - port:	   token bucket shaper.
+ * - subscriber:   token bucket shaper; subscribers with pending traffic are
+ *		   served by byte based deficit round robin, weighted per subscriber.
+ * - traffic class: strict priority (TC0 is the highest), optional token bucket
+ *		   shaper per TC; a shaped-out TC lets lower TCs send.
+ * - queue:	   byte based weighted round robin (DRR) inside a TC.
+ *
+ * Packets are opaque to the scheduler: only a 64 bit cookie and the length
+ * are stored (e.g. the buffer cookie, or an index into an application
+ * descriptor array). Classification (subscriber/tc/queue) is done by the caller.
+ * All memory is allocated at creation time. The scheduler is not thread-safe;
+ * use one instance per TX thread.
+ *
+ * Typical use per TX loop iteration:
+ *	mv_hsched_enqueue(sched, pkts, &num);			 // classified burst
+ *	mv_hsched_dequeue(sched, now_ns, out, &num);		 // shaped burst
+ *	... build pp2 descriptors from out[] and pp2_ppio_send() ...
+ */
+
+#define MV_HSCHED_MAX_TCS	8
+#define MV_HSCHED_MAX_QUEUES	4	/**< per traffic class */
+#define MV_HSCHED_QUANTUM	1536	/**< DRR quantum (bytes) of weight 1 */
+
+/** Packet handle */
+struct mv_hsched_pkt {
+	u64	cookie;		/**< application packet handle */
+	u32	len;		/**< packet length in bytes */
+	u32	sub;		/**< subscriber index; set by the caller on enqueue */
+	u8	tc;		/**< traffic class; set by the caller on enqueue */
+	u8	queue;		/**< queue inside the TC; set by the caller on enqueue */
+	u16	rsvd;
+};
+
+/** Scheduler parameters */
+struct mv_hsched_params {
+	u32	num_subs;		/**< number of subscribers */
+	u8	num_tcs;		/**< traffic classes per subscriber (<= MV_HSCHED_MAX_TCS) */
+	u8	num_queues;		/**< queues per traffic class (<= MV_HSCHED_MAX_QUEUES) */
+	u16	qsize;			/**< packets per queue; rounded up to a power of 2 */
+	u64	port_rate;		/**< port rate in bytes/sec; 0 for unlimited */
+	u32	port_burst;		/**< port burst size in bytes */
+	u32	frame_overhead;		/**< bytes accounted per packet on top of 'len'
+					 *   (e.g. 24 for preamble, IFG and CRC)
+					 */
+};
+
+/** Subscriber parameters */
+struct mv_hsched_sub_params {
+	u64	rate;					/**< bytes/sec; 0 for unlimited */
+	u32	burst;					/**< bytes */
+	u32	weight;					/**< WRR weight among subscribers (>= 1) */
+	u64	tc_rate[MV_HSCHED_MAX_TCS];		/**< bytes/sec; 0 for unlimited */
+	u32	tc_burst[MV_HSCHED_MAX_TCS];		/**< bytes */
+	u8	q_weight[MV_HSCHED_MAX_TCS][MV_HSCHED_MAX_QUEUES]; /**< WRR weights (0 is taken as 1) */
+};
+
+/** Queue statistics */
+struct mv_hsched_queue_stats {
+	u64	pkts;		/**< packets dequeued */
+	u64	bytes;		/**< bytes dequeued */
+	u64	drops;		/**< packets dropped on enqueue (queue full) */
+	u16	occupancy;	/**< packets currently queued */
+};
+
+struct mv_hsched;
+
+/**
+ * Create a scheduler
+ *
+ * All subscribers are created unshaped with weight 1 and all queue weights 1.
+ *
+ * @param[in]	params	  - scheduler parameters.
+ * @param[out]	sched	  - address of place to save the scheduler handle.
+ *
+ * @retval	0         - success
+ * @retval	Negative  - failure
+ */
+int mv_hsched_create(struct mv_hsched_params *params, struct mv_hsched **sched);
+
+/**
+ * Destroy a scheduler; queued packets are discarded.
+ *
+ * @param[in]	sched	  - scheduler handle.
+ */
+void mv_hsched_destroy(struct mv_hsched *sched);
+
+/**
+ * Configure a subscriber
+ *
+ * @param[in]	sched	  - scheduler handle.
+ * @param[in]	sub	  - subscriber index.
+ * @param[in]	params	  - subscriber parameters.
+ *
+ * @retval	0         - success
+ * @retval	Negative  - failure
+ */
+int mv_hsched_sub_config(struct mv_hsched *sched, u32 sub, struct mv_hsched_sub_params *params);
+
+/**
+ * Enqueue a burst of classified packets
+ *
+ * Packets whose queue is full, or with an invalid classification, are not
+ * enqueued; they are moved to the head of the 'pkts' array (in their original
+ * order) for the caller to free.
+ *
+ * @param[in]		sched	- scheduler handle.
+ * @param[in,out]	pkts	- packets to enqueue; on return the not-enqueued ones
+ *				  are at pkts[0 .. (original num - *num - 1)].
+ * @param[in,out]	num	- input: number of packets; output: number enqueued.
+ *
+ * @retval	0         - success
+ */
+int mv_hsched_enqueue(struct mv_hsched *sched, struct mv_hsched_pkt *pkts, u16 *num);
+
+/**
+ * Dequeue a burst of packets according to the hierarchy
+ *
+ * @param[in]		sched	- scheduler handle.
+ * @param[in]		now_ns	- current time in nanoseconds (monotonic).
+ * @param[out]		pkts	- dequeued packets (cookie, len, sub, tc, queue).
+ * @param[in,out]	num	- input: max packets; output: number dequeued.
+ *
+ * @retval	0         - success
+ */
+int mv_hsched_dequeue(struct mv_hsched *sched, u64 now_ns, struct mv_hsched_pkt *pkts, u16 *num);
+
+/**
+ * Get queue statistics
+ *
+ * @param[in]	sched	  - scheduler handle.
+ * @param[in]	sub	  - subscriber index.
+ * @param[in]	tc	  - traffic class.
+ * @param[in]	queue	  - queue index.
+ * @param[out]	stats	  - statistics.
+ * @param[in]	reset	  - reset the counters after reading.
+ *
+ * @retval	0         - success
+ * @retval	Negative  - failure
+ */
+int mv_hsched_queue_get_stats(struct mv_hsched *sched, u32 sub, u8 tc, u8 queue,
+			      struct mv_hsched_queue_stats *stats, int reset);
+
+#endif /* __MV_HSCHED_H__ */
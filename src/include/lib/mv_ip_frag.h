@@ -0,0 +1,282 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#ifndef __MV_IP_FRAG_H__
+#define __MV_IP_FRAG_H__
+
+#include "mv_std.h"
+#include "lib/mv_gso.h"
+
+/**
+ * IPv4/IPv6 fragmentation and reassembly
+ *
+ * Fragmentation is zero-copy and works like the GSO helper (lib/mv_gso.h):
+ * every output fragment is a header copy written into a caller provided DMA
+ * area followed by S/G pieces of the original payload, ready for the send_sg
+ * APIs.
+ *
+ * Reassembly keeps the received fragments in place, identified by an
+ * application cookie (e.g. the buffer cookie of a pp2/neta/giu pool). Memory is
+ * bounded: the flow table and the per-flow fragment slots are allocated at
+ * creation time. Buffers that must be released (duplicates, overlaps, timed
+ * out or evicted flows) are queued on a "death row" that the application
+ * drains in batches into its buffer pools (mv_ip_reass_death_row_get()).
+ *
+ * Overlap policy: an exact duplicate fragment is dropped; any other overlap
+ * drops the whole datagram (RFC 5722 for IPv6, applied to IPv4 as well).
+ */
+
+#define MV_IP_REASS_MAX_FRAGS		16	/**< max fragments per datagram */
+#define MV_IP_REASS_BUCKET_ENTRIES	4	/**< flow table associativity */
+
+/** Fragmentation parameters */
+struct mv_ip_frag_params {
+	u16			 mtu;		/**< max L3 packet length of a fragment */
+	u8			 l3_offset;	/**< IP header offset in the first input buffer */
+	u8			 max_frags;	/**< max S/G pieces per fragment incl. the header one;
+						 *   0 means MV_GSO_MAX_SEG_FRAGS
+						 */
+	u32			 ip6_id;	/**< IPv6 fragment header identification */
+	struct mv_gso_buf	 hdr_area;	/**< DMA area for the per-fragment headers; needs
+						 *   num_pkts * mv_gso_hdr_stride(hdr_len + 8) bytes
+						 */
+};
+
+/**
+ * Fragment an IPv4/IPv6 packet
+ *
+ * The first input buffer must hold the L2 and IP headers (IPv6 extension
+ * headers are not supported). Packets that fit the MTU produce a single
+ * packet. IPv4 options without the 'copied' flag are only kept in the first
+ * fragment.
+ *
+ * @param[in]	params	  - fragmentation parameters.
+ * @param[in]	in	  - input buffer chain; in[0] starts with the L2 header.
+ * @param[in]	num_in	  - number of input buffers.
+ * @param[out]	frags	  - output S/G pieces, grouped per fragment packet.
+ * @param[in]	max_out	  - size of the 'frags' array.
+ * @param[out]	pkt_frags - number of S/G pieces of every fragment packet; may be used
+ *			    as the 'frags' array of pp2_ppio_sg_pkts/neta_ppio_sg_pkts.
+ * @param[in]	max_pkts  - size of the 'pkt_frags' array.
+ * @param[out]	num_pkts  - number of fragment packets.
+ *
+ * @retval	0         - success
+ * @retval	-EMSGSIZE - IPv4 packet with DF set exceeds the MTU
+ * @retval	-EINVAL   - unsupported or malformed packet
+ * @retval	-ENOSPC   - output arrays or header area too small
+ * @retval	-E2BIG    - a fragment needs more than 'max_frags' S/G pieces
+ */
+int mv_ip_fragment(struct mv_ip_frag_params *params, struct mv_gso_buf *in, u16 num_in,
+		   struct mv_gso_frag *frags, u16 max_out, u8 *pkt_frags, u16 max_pkts, u16 *num_pkts);
+
+/** Reassembly table parameters */
+struct mv_ip_reass_params {
+	u32	max_flows;		/**< max datagrams under reassembly */
+	u32	timeout_ms;		/**< reassembly timeout from the first fragment */
+	u32	death_row_size;		/**< max buffers pending release */
+};
+
+/** Reassembled datagram */
+struct mv_ip_reass_pkt {
+	u16	num_frags;
+	u32	len;			/**< total packet length (L2 header included) */
+	struct {
+		void	*cookie;	/**< application buffer cookie */
+		u8	*vaddr;		/**< data start; the first one starts at the L2 header */
+		u16	 len;
+	} frags[MV_IP_REASS_MAX_FRAGS];
+};
+
+/** Reassembly statistics */
+struct mv_ip_reass_stats {
+	u64	frags;			/**< fragments received */
+	u64	reassembled;		/**< datagrams completed */
+	u64	timeouts;		/**< datagrams dropped on timeout */
+	u64	overlaps;		/**< datagrams dropped on overlap */
+	u64	duplicates;		/**< duplicate fragments dropped */
+	u64	no_flow;		/**< fragments dropped since the table was full */
+	u64	errors;			/**< malformed / too many fragments */
+};
+
+struct mv_ip_reass;
+
+/**
+ * Create a reassembly table
+ *
+ * @param[in]	params	  - table parameters.
+ * @param[out]	reass	  - address of place to save the table handle.
+ *
+ * @retval	0         - success
+ * @retval	Negative  - failure
+ */
+int mv_ip_reass_create(struct mv_ip_reass_params *params, struct mv_ip_reass **reass);
+
+/**
+ * Destroy a reassembly table
+ *
+ * Buffers still held by the table are not released; call
+ * mv_ip_reass_expire(reass, ~0ULL) and drain the death row before calling this API.
+ *
+ * @param[in]	reass	  - table handle.
+ */
+void mv_ip_reass_destroy(struct mv_ip_reass *reass);
+
+/**
+ * Process a received IP fragment
+ *
+ * Non-fragmented packets are returned as-is (single-fragment datagram).
+ * On success the table owns the buffer until it is returned in 'pkt' or on the
+ * death row. On failure the buffer is left to the caller.
+ *
+ * @param[in]	reass	  - table handle.
+ * @param[in]	cookie	  - application buffer cookie.
+ * @param[in]	data	  - packet start (L2 header).
+ * @param[in]	len	  - packet length.
+ * @param[in]	l3_offset - IP header offset.
+ * @param[in]	now_ms	  - current time in msec.
+ * @param[out]	pkt	  - reassembled datagram, valid when 1 is returned.
+ *
+ * @retval	1         - datagram completed, returned in 'pkt'
+ * @retval	0         - fragment queued (or dropped to the death row)
+ * @retval	-ENOBUFS  - death row full; drain it and retry
+ * @retval	-EINVAL   - malformed packet
+ */
+int mv_ip_reass_process(struct mv_ip_reass *reass, void *cookie, u8 *data, u16 len, u8 l3_offset,
+			u64 now_ms, struct mv_ip_reass_pkt *pkt);
+
+/**
+ * Drop the datagrams whose reassembly timed out
+ *
+ * @param[in]	reass	  - table handle.
+ * @param[in]	now_ms	  - current time in msec.
+ *
+ * @retval	number of datagrams dropped
+ */
+int mv_ip_reass_expire(struct mv_ip_reass *reass, u64 now_ms);
+
+/**
+ * Drain the death row
+ *
+ * @param[in]	reass	  - table handle.
+ * @param[out]	cookies	  - buffer cookies to be released by the application.
+ * @param[in]	max	  - size of the 'cookies' array.
+ *
+ * @retval	number of cookies returned
+ */
+u32 mv_ip_reass_death_row_get(struct mv_ip_reass *reass, void **cookies, u32 max);
+
+/**
+ * Copy a reassembled datagram into a linear buffer
+ *
+ * @param[in]	pkt	  - reassembled datagram.
+ * @param[out]	buf	  - destination buffer.
+ * @param[in]	size	  - destination buffer size.
+ *
+ * @retval	number of bytes copied
+ * @retval	-ENOSPC   - destination buffer too small
+ */
+int mv_ip_reass_linearize(struct mv_ip_reass_pkt *pkt, u8 *buf, u32 size);
+
+/**
+ * Get reassembly statistics
+ *
+ * @param[in]	reass	  - table handle.
+ * @param[out]	stats	  - statistics.
+ * @param[in]	reset	  - reset the statistics after reading.
+ */
+void mv_ip_reass_get_stats(struct mv_ip_reass *reass, struct mv_ip_reass_stats *stats, int reset);
+
+#endif /* __MV_IP_FRAG_H__ */
@@ -0,0 +1,317 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#ifndef __MV_JSON_H__
+#define __MV_JSON_H__
+
+#include "mv_std.h"
+
+/**
+ * Single-pass JSON tokenizer
+ *
+ * The input is split once into a flat array of tokens (in document order);
+ * the values are then read with typed getters that look members up by key
+ * inside their own object, so the result does not depend on the order of the
+ * keys or on one key being a substring of another.
+ *
+ * An object member is stored as a key token (MV_JSON_T_STRING) followed by
+ * the tokens of its value. Every token records the index of the token that
+ * follows its sub-tree, so siblings are walked without visiting their
+ * children.
+ *
+ * The parser accepts the JSON flavour produced by json_print_to_buffer():
+ *	- the comma between members/elements is optional and a trailing comma
+ *	  is allowed;
+ *	- numbers may be written in hex ("0x..."); bare words (true, false, null)
+ *	  are kept as primitives;
+ *	- a buffer that does not start with '{' or '[' is a fragment (e.g. a probe
+ *	  string): the text before its first key is skipped, and its members form
+ *	  an implicit root object that ends at the end of the buffer, at a NUL
+ *	  character or at an unmatched closing bracket.
+ * String escapes are skipped over but not decoded.
+ */
+
+#define MV_JSON_MAX_DEPTH	32	/**< max nesting of objects/arrays */
+#define MV_JSON_ROOT		0	/**< index of the root token */
+
+enum mv_json_type {
+	MV_JSON_T_NONE = 0,
+	MV_JSON_T_OBJECT,
+	MV_JSON_T_ARRAY,
+	MV_JSON_T_STRING,
+	MV_JSON_T_PRIMITIVE
+};
+
+struct mv_json_tok {
+	enum mv_json_type	type;
+	u32			start;	/**< offset of the first char (strings: after the quote) */
+	u32			len;	/**< length (strings: without the quotes) */
+	u32			size;	/**< number of members/elements of an object/array */
+	u32			skip;	/**< index of the first token after this sub-tree */
+};
+
+struct mv_json {
+	const char		*buf;
+	u32			 len;
+	struct mv_json_tok	*toks;
+	u32			 num_toks;
+	u32			 max_toks;
+	int			 alloced;	/**< toks were allocated by mv_json_init() */
+	/* parse error, if any */
+	const char		*err_msg;
+	u32			 err_line;
+	u32			 err_col;
+};
+
+/**
+ * Tokenize a JSON buffer into a caller provided token array
+ *
+ * With 'toks' set to NULL only the number of tokens is counted (into
+ * json->num_toks).
+ *
+ * @param[out]	json		- parser context.
+ * @param[in]	buf		- JSON text; need not be NUL terminated.
+ * @param[in]	len		- length of 'buf'; parsing stops earlier at a NUL char.
+ * @param[in]	toks		- token array, or NULL.
+ * @param[in]	max_toks	- size of 'toks'.
+ *
+ * @retval	0 on success
+ * @retval	-ENOMEM if 'toks' is too small
+ * @retval	-EINVAL on a syntax error (see json->err_msg, err_line and err_col)
+ */
+int mv_json_parse(struct mv_json *json, const char *buf, u32 len, struct mv_json_tok *toks, u32 max_toks);
+
+/**
+ * Tokenize a NUL terminated JSON buffer into an allocated token array
+ *
+ * The buffer must stay valid (and unchanged) until mv_json_deinit().
+ *
+ * @param[out]	json		- parser context.
+ * @param[in]	buf		- JSON text.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure; syntax errors are reported with their position
+ */
+int mv_json_init(struct mv_json *json, const char *buf);
+
+/**
+ * Release the token array allocated by mv_json_init()
+ *
+ * @param[in]	json		- parser context.
+ */
+void mv_json_deinit(struct mv_json *json);
+
+/**
+ * Find a direct member of an object
+ *
+ * @param[in]	json		- parser context.
+ * @param[in]	obj		- index of the object token.
+ * @param[in]	key		- member name.
+ *
+ * @retval	index of the member value token
+ * @retval	-ENOENT if there is no such member
+ * @retval	-EINVAL if 'obj' is not an object
+ */
+int mv_json_find(const struct mv_json *json, int obj, const char *key);
+
+/**
+ * Find the next member of an object with a given (repeated) key
+ *
+ * @param[in]	json		- parser context.
+ * @param[in]	obj		- index of the object token.
+ * @param[in]	key		- member name.
+ * @param[in]	prev		- value token returned by the previous call, or -1
+ *				  to start from the first member.
+ *
+ * @retval	index of the member value token
+ * @retval	-ENOENT if there are no more such members
+ * @retval	-EINVAL if 'obj' is not an object
+ */
+int mv_json_find_next(const struct mv_json *json, int obj, const char *key, int prev);
+
+/**
+ * Find a member by key anywhere below a token (depth first, document order)
+ *
+ * Used to locate a named section (e.g. "gpio-0:1") whose position in the
+ * hierarchy is not fixed.
+ *
+ * @param[in]	json		- parser context.
+ * @param[in]	tok		- index of the token to search below.
+ * @param[in]	key		- member name.
+ *
+ * @retval	index of the member value token
+ * @retval	-ENOENT if not found
+ */
+int mv_json_lookup(const struct mv_json *json, int tok, const char *key);
+
+/**
+ * Find the next member with a given (repeated) key anywhere below a token
+ *
+ * The search resumes after the sub-tree of 'prev', so the sections NMP writes
+ * once per object (e.g. one "pool-info" per bpool) are walked in order.
+ *
+ * @param[in]	json		- parser context.
+ * @param[in]	tok		- index of the token to search below.
+ * @param[in]	key		- member name.
+ * @param[in]	prev		- value token returned by the previous call, or -1
+ *				  to start from the first token.
+ *
+ * @retval	index of the member value token
+ * @retval	-ENOENT if there are no more such members
+ */
+int mv_json_lookup_next(const struct mv_json *json, int tok, const char *key, int prev);
+
+/**
+ * Read an unsigned number (decimal or 0x-prefixed hex; true/false read as 1/0)
+ *
+ * @retval	0 on success
+ * @retval	-EINVAL if the token is not a number
+ * @retval	-ERANGE if the number does not fit in 64 bits
+ */
+int mv_json_get_u64(const struct mv_json *json, int tok, u64 *val);
+
+/**
+ * Copy a string value (NUL terminated)
+ *
+ * @retval	0 on success
+ * @retval	-EINVAL if the token is not a string
+ * @retval	-ENOSPC if the string (and its NUL) does not fit in 'size' bytes
+ */
+int mv_json_get_str(const struct mv_json *json, int tok, char *str, u32 size);
+
+/**
+ * Read a MAC address string ("xx:xx:xx:xx:xx:xx")
+ *
+ * @retval	0 on success
+ * @retval	-EINVAL if the token is not a MAC address string
+ */
+int mv_json_get_mac(const struct mv_json *json, int tok, u8 mac[6]);
+
+/**
+ * Typed getters of object members
+ *
+ * A missing member returns -ENOENT and leaves the output untouched, so that
+ * optional members keep their defaults; an invalid value is reported (with its
+ * key and position) and returns the getter's error.
+ */
+int mv_json_obj_get_u64(const struct mv_json *json, int obj, const char *key, u64 *val);
+int mv_json_obj_get_str(const struct mv_json *json, int obj, const char *key, char *str, u32 size);
+int mv_json_obj_get_mac(const struct mv_json *json, int obj, const char *key, u8 mac[6]);
+
+/**
+ * Read a number member into an integer variable of any type
+ *
+ * Fails with -ERANGE, and leaves '_p' untouched, if the value does not fit
+ * in the variable.
+ */
+#define mv_json_obj_get_num(json, obj, key, _p)					\
+({										\
+	u64	__v;								\
+	int	__rc = mv_json_obj_get_u64(json, obj, key, &__v);		\
+										\
+	if (!__rc) {								\
+		if ((u64)(typeof(_p))__v != __v || ((typeof(_p))__v + 0) < 0) {	\
+			pr_err("JSON '%s': value %llu out of range\n",		\
+			       key, (unsigned long long)__v);			\
+			__rc = -ERANGE;						\
+		} else {							\
+			(_p) = (typeof(_p))__v;					\
+		}								\
+	}									\
+	__rc;									\
+})
+
+#endif /* __MV_JSON_H__ */
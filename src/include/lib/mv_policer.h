@@ -0,0 +1,193 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#ifndef __MV_POLICER_H__
+#define __MV_POLICER_H__
+
+#include "mv_std.h"
+
+/**
+ * Software token-bucket policer
+ *
+ * Implements the single rate (srTCM, RFC 2697) and two rate (trTCM, RFC 2698)
+ * three color markers, color blind or color aware, in units of bytes or
+ * packets (a packet is metered with len = 1).
+ *
+ * By default the buckets are refilled continuously. With 'update_period_ns'
+ * set, the tokens are credited in discrete updates every period, the way the
+ * PPv2 policer does; configured from pp2_cls_plcr_get_hw_info() the policer
+ * then models the rate the HW actually enforces, and may serve as a fallback
+ * for flows beyond the number of HW policers.
+ *
+ * The policer is not thread safe; time is passed in by the caller.
+ */
+
+/** Policer modes */
+enum mv_plcr_mode {
+	MV_PLCR_MODE_SRTCM = 0,	/**< single rate: CIR, CBS and EBS */
+	MV_PLCR_MODE_TRTCM	/**< two rates: CIR, CBS, PIR and PBS */
+};
+
+/** Packet colors */
+enum mv_plcr_color {
+	MV_PLCR_COLOR_GREEN = 0,
+	MV_PLCR_COLOR_YELLOW,
+	MV_PLCR_COLOR_RED,
+	MV_PLCR_COLOR_NUM
+};
+
+/** Policer parameters; rates are in tokens (bytes or packets) per second */
+struct mv_plcr_params {
+	enum mv_plcr_mode	mode;
+	int			color_aware;	/**< take the input color into account */
+	u64			cir;		/**< committed rate */
+	u64			pir;		/**< peak rate (trTCM); at least 'cir' */
+	u32			cbs;		/**< committed bucket size, tokens */
+	u32			ebs;		/**< excess (srTCM) / peak (trTCM) bucket size, tokens */
+	u64			update_period_ns; /**< discrete token updates period;
+						   * 0 - continuous refill
+						   */
+};
+
+/** Policer statistics, per color */
+struct mv_plcr_stats {
+	u64	pkts[MV_PLCR_COLOR_NUM];
+	u64	tokens[MV_PLCR_COLOR_NUM];	/**< metered length */
+};
+
+struct mv_plcr;
+
+/**
+ * Create a policer; its buckets start full
+ *
+ * @param[in]	params	- parameters.
+ * @param[in]	now_ns	- current time in nsec.
+ * @param[out]	plcr	- address of place to save the policer handle.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int mv_plcr_create(struct mv_plcr_params *params, u64 now_ns, struct mv_plcr **plcr);
+
+/**
+ * Destroy a policer
+ *
+ * @param[in]	plcr	- policer handle.
+ */
+void mv_plcr_destroy(struct mv_plcr *plcr);
+
+/**
+ * Meter a packet
+ *
+ * @param[in]	plcr	- policer handle.
+ * @param[in]	len	- packet length in tokens (bytes, or 1 for packets).
+ * @param[in]	color	- input color; ignored in color blind mode.
+ * @param[in]	now_ns	- current time in nsec; must not go backwards.
+ *
+ * @retval	the packet color
+ */
+enum mv_plcr_color mv_plcr_meter(struct mv_plcr *plcr, u32 len, enum mv_plcr_color color, u64 now_ns);
+
+/**
+ * Get the policer statistics
+ *
+ * @param[in]	plcr	- policer handle.
+ * @param[out]	stats	- statistics.
+ * @param[in]	reset	- 1 - reset the counters after reading.
+ */
+void mv_plcr_get_stats(struct mv_plcr *plcr, struct mv_plcr_stats *stats, int reset);
+
+#endif /* __MV_POLICER_H__ */
@@ -0,0 +1,213 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#ifndef __MV_REPLAY_WIN_H__
+#define __MV_REPLAY_WIN_H__
+
+#include "mv_std.h"
+
+/**
+ * Sliding window anti-replay check (RFC 4303 section 3.4.3 and appendix A)
+ *
+ * The window is a bitmap of the last 'size' sequence numbers below the highest
+ * one accepted so far ("top"). A received sequence number is first checked
+ * (mv_replay_win_check()) before the packet is authenticated; the window is
+ * only updated (mv_replay_win_commit()) once the packet passed authentication,
+ * so forged packets cannot move it.
+ *
+ * With extended sequence numbers (ESN) only the low 32 bits are carried in the
+ * packet; the high 32 bits are inferred from the window position as described
+ * in RFC 4303 appendix A2.2.
+ *
+ * A window is not thread safe; it must be used by a single thread at a time.
+ */
+
+#define MV_REPLAY_WIN_MIN_SIZE		64	/**< min window size (bits) */
+#define MV_REPLAY_WIN_MAX_SIZE		4096	/**< max window size (bits) */
+
+/** Anti-replay statistics */
+struct mv_replay_win_stats {
+	u64	accepted;	/**< sequence numbers committed */
+	u64	duplicates;	/**< rejected: already received */
+	u64	too_old;	/**< rejected: left of the window, or 0 */
+};
+
+struct mv_replay_win;
+
+/**
+ * Create an anti-replay window
+ *
+ * @param[in]	size	- window size in bits; power of 2 between
+ *			  MV_REPLAY_WIN_MIN_SIZE and MV_REPLAY_WIN_MAX_SIZE.
+ * @param[in]	seq	- highest sequence number already received (0 for a new SA).
+ * @param[in]	esn	- 1 - extended (64 bits) sequence numbers, 0 - 32 bits.
+ * @param[out]	win	- address of place to save the window handle.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int mv_replay_win_create(u32 size, u64 seq, int esn, struct mv_replay_win **win);
+
+/**
+ * Destroy an anti-replay window
+ *
+ * @param[in]	win	- window handle; may be NULL.
+ */
+void mv_replay_win_destroy(struct mv_replay_win *win);
+
+/**
+ * Check a received sequence number without updating the window
+ *
+ * @param[in]	win	- window handle.
+ * @param[in]	seq_lo	- sequence number field of the packet (host order).
+ * @param[out]	seq	- full (ESN inferred) sequence number to pass to
+ *			  mv_replay_win_commit(); may be NULL.
+ *
+ * @retval	0	  - sequence number may be accepted
+ * @retval	-EEXIST	  - duplicate
+ * @retval	-ERANGE	  - left of the window (or 0)
+ */
+int mv_replay_win_check(struct mv_replay_win *win, u32 seq_lo, u64 *seq);
+
+/**
+ * Check a burst of received sequence numbers without updating the window
+ *
+ * Duplicates inside the burst itself are not detected here; the second one
+ * fails on commit.
+ *
+ * @param[in]	win	- window handle.
+ * @param[in]	seq_lo	- array of sequence number fields (host order).
+ * @param[out]	seq	- array of full sequence numbers; rejected entries are set to 0.
+ * @param[in]	num	- number of entries.
+ *
+ * @retval	number of entries that passed the check
+ */
+u16 mv_replay_win_check_burst(struct mv_replay_win *win, const u32 *seq_lo, u64 *seq, u16 num);
+
+/**
+ * Commit an authenticated sequence number to the window
+ *
+ * The number is checked again since another packet with the same sequence
+ * number may have been committed after the pre-check.
+ *
+ * @param[in]	win	- window handle.
+ * @param[in]	seq	- full sequence number returned by the check functions.
+ *
+ * @retval	0	  - accepted; the window was updated
+ * @retval	-EEXIST	  - duplicate
+ * @retval	-ERANGE	  - left of the window (or 0)
+ */
+int mv_replay_win_commit(struct mv_replay_win *win, u64 seq);
+
+/**
+ * Get the highest accepted sequence number
+ *
+ * @param[in]	win	- window handle.
+ *
+ * @retval	full (64 bits) sequence number
+ */
+u64 mv_replay_win_top(struct mv_replay_win *win);
+
+/**
+ * Get the window statistics
+ *
+ * @param[in]	win	- window handle.
+ * @param[out]	stats	- statistics.
+ * @param[in]	reset	- 1 - reset the counters after reading.
+ */
+void mv_replay_win_get_stats(struct mv_replay_win *win, struct mv_replay_win_stats *stats, int reset);
+
+#endif /* __MV_REPLAY_WIN_H__ */
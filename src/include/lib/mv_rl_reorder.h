@@ -0,0 +1,238 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#ifndef __MV_RL_REORDER_H__
+#define __MV_RL_REORDER_H__
+
+#include "mv_std.h"
+
+/**
+ * Hit-count driven incremental rule reordering
+ *
+ * Keeps the rules of a first-match table (the first valid slot that matches
+ * wins) ordered by traffic within each priority, so that the rules that see
+ * most of the packets are checked first. Rules of different priorities are
+ * never reordered relative to each other: a rule always stays after all the
+ * rules of higher priority (lower 'prio' value) and before all the rules of
+ * lower priority. The rules of the same priority must not depend on their
+ * relative order, i.e. they never match the same packet, or have the same
+ * action.
+ *
+ * The hits of every rule are fed in by the caller (e.g. from the hardware
+ * hit counters). On every maintenance call the rule scores decay
+ * exponentially (score -= score >> 'decay_shift') and the new hits are added,
+ * and then at most 'max_moves' rules are moved. A rule passes a colder one
+ * only if its score is higher by more than 1 / 2^'hyst_shift', so that rules
+ * with a similar load do not swap back and forth.
+ *
+ * Every move is make-before-break: the rule is written into a free slot
+ * first and only then its old slot is cleared, so a lookup done at any point
+ * finds the rule either in its old or in its new slot. Moving a rule ahead
+ * of another one needs a free slot inside the range of its priority. When
+ * there is none, the nearest free slot after the range is brought in by
+ * moving the first rule of each lower priority on the way to the end of its
+ * own range. Without any free slot after the range the priority is left as
+ * is (and counted as blocked).
+ *
+ * The table is accessed through the write/clear callbacks only.
+ */
+
+/** Reorder parameters */
+struct mv_rl_reorder_params {
+	u32	num_slots;	/**< table size */
+	u32	max_rules;	/**< rule ids are 0 .. max_rules - 1 */
+	u32	max_moves;	/**< rule moves per maintenance call (default 4) */
+	u32	decay_shift;	/**< score decay per maintenance call (default 3, i.e. 1/8) */
+	u32	hyst_shift;	/**< reorder hysteresis (default 2, i.e. 1/4) */
+	void	*arg;		/**< callbacks argument */
+	/** program 'rule' into the (free) 'slot'; mandatory */
+	int (*write)(void *arg, u32 slot, u32 rule);
+	/** invalidate 'slot'; mandatory */
+	int (*clear)(void *arg, u32 slot);
+};
+
+/** Reorder statistics */
+struct mv_rl_reorder_stats {
+	u64	runs;		/**< maintenance calls */
+	u64	moves;		/**< rule moves (one write and one clear each) */
+	u64	blocked;	/**< priorities left unordered for lack of a free slot */
+	u64	errors;		/**< failed callbacks */
+};
+
+struct mv_rl_reorder;
+
+/**
+ * Create a reorder instance; the table must be empty
+ *
+ * @param[in]	params	- parameters.
+ * @param[out]	rr	- address of place to save the instance handle.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int mv_rl_reorder_create(struct mv_rl_reorder_params *params, struct mv_rl_reorder **rr);
+
+/**
+ * Destroy a reorder instance; the table is left as is
+ *
+ * @param[in]	rr	- instance handle.
+ */
+void mv_rl_reorder_destroy(struct mv_rl_reorder *rr);
+
+/**
+ * Add a rule after the rules of the same priority
+ *
+ * @param[in]	rr	- instance handle.
+ * @param[in]	rule	- rule id.
+ * @param[in]	prio	- rule priority; 0 is the highest.
+ *
+ * @retval	0 on success
+ * @retval	-ENOSPC if there is no free slot in the range of the priority
+ * @retval	<0 on other failures
+ */
+int mv_rl_reorder_add(struct mv_rl_reorder *rr, u32 rule, u32 prio);
+
+/**
+ * Remove a rule
+ *
+ * @param[in]	rr	- instance handle.
+ * @param[in]	rule	- rule id.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int mv_rl_reorder_remove(struct mv_rl_reorder *rr, u32 rule);
+
+/**
+ * Report the hits of a rule since the last report
+ *
+ * @param[in]	rr	- instance handle.
+ * @param[in]	rule	- rule id.
+ * @param[in]	hits	- number of hits.
+ */
+void mv_rl_reorder_hit(struct mv_rl_reorder *rr, u32 rule, u32 hits);
+
+/**
+ * Maintenance call: decay the scores and move at most 'max_moves' rules
+ *
+ * @param[in]	rr	- instance handle.
+ *
+ * @retval	>=0 number of moved rules
+ * @retval	<0 on callback failure; the table is still consistent
+ */
+int mv_rl_reorder_run(struct mv_rl_reorder *rr);
+
+/**
+ * Get the slot of a rule
+ *
+ * @param[in]	rr	- instance handle.
+ * @param[in]	rule	- rule id.
+ *
+ * @retval	>=0 slot of the rule
+ * @retval	<0 if the rule does not exist
+ */
+int mv_rl_reorder_get_slot(struct mv_rl_reorder *rr, u32 rule);
+
+/**
+ * Get the statistics
+ *
+ * @param[in]	rr	- instance handle.
+ * @param[out]	stats	- statistics.
+ * @param[in]	reset	- 1 - reset the counters after reading.
+ */
+void mv_rl_reorder_get_stats(struct mv_rl_reorder *rr, struct mv_rl_reorder_stats *stats, int reset);
+
+#endif /* __MV_RL_REORDER_H__ */
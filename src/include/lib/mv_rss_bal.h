@@ -0,0 +1,221 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#ifndef __MV_RSS_BAL_H__
+#define __MV_RSS_BAL_H__
+
+#include "mv_std.h"
+
+/**
+ * RSS indirection table rebalancer
+ *
+ * RSS spreads the flows over the queues through an indirection table of
+ * 'buckets' (the hash selects a bucket, the bucket holds a queue). A static,
+ * evenly spread table balances the number of buckets, not the load: with a
+ * skewed (e.g. Zipf) flow distribution a few heavy buckets saturate their
+ * queue while the others sit idle.
+ *
+ * The rebalancer is fed periodically with the packet counters of the queues
+ * (and, when available, of the buckets). It keeps an EWMA of the rate of
+ * every queue and an estimate of the rate of every bucket, and when the most
+ * loaded queue exceeds the mean by 'imbalance_pct' it moves single buckets
+ * from the hottest to the coolest queue through the set_entry callback (e.g.
+ * pp2_ppio_set_rss_entry()).
+ *
+ * Moving a bucket may reorder the packets of its flows, so the moves are
+ * limited:
+ *	- at most 'max_moves' buckets every 'min_interval_usecs';
+ *	- a bucket stays at least 'hold_usecs' on a queue before moving again;
+ *	- a move must lower the load of the hottest queue by at least
+ *	  'min_gain_pct' of the mean queue load (hysteresis).
+ *
+ * Without per-bucket counters (the PPv2 does not count per RSS line) the
+ * bucket rates are estimated: the load of a queue is shared among its buckets
+ * in proportion to their previous estimates (evenly at first), and the rate
+ * of a moved bucket is measured from the change of the load of its old and
+ * new queues on the next update. The skew is thus learnt through the moves
+ * themselves; to keep the measure unambiguous a queue takes part in at most
+ * one move per update in that mode. Since the traffic changes, the learnt
+ * estimates slowly drift back to the even share.
+ */
+
+#define MV_RSS_BAL_MAX_QUEUES	32	/**< max number of queues */
+#define MV_RSS_BAL_MAX_BUCKETS	256	/**< max size of the indirection table */
+
+/** Rebalancer parameters; zero fields take the defaults */
+struct mv_rss_bal_params {
+	u32		 num_queues;		/**< number of queues */
+	u32		 num_buckets;		/**< indirection table size */
+	const u8	*tbl;			/**< initial bucket->queue map;
+						 * NULL: bucket % num_queues
+						 */
+	void		*arg;			/**< set_entry argument (e.g. the ppio) */
+	/** move a bucket to a queue; mandatory */
+	int (*set_entry)(void *arg, u32 bucket, u32 queue);
+	u32		 imbalance_pct;		/**< rebalance above mean + pct (default 20) */
+	u32		 min_gain_pct;		/**< min gain of a move, pct of the mean (default 5) */
+	u32		 max_moves;		/**< max moves per interval (default 2) */
+	u32		 min_interval_usecs;	/**< min time between rebalances (default 100000) */
+	u32		 hold_usecs;		/**< min time between moves of a bucket (default 1000000) */
+	u32		 ewma_shift;		/**< queue rate EWMA weight is 1/2^shift (default 2) */
+};
+
+/** Rebalancer statistics */
+struct mv_rss_bal_stats {
+	u64	updates;	/**< calls to mv_rss_bal_update() */
+	u64	rebalances;	/**< updates that moved buckets */
+	u64	moves;		/**< buckets moved */
+	u64	move_errs;	/**< set_entry failures */
+	u32	imbalance_pct;	/**< last max queue load, in pct of the mean */
+};
+
+struct mv_rss_bal;
+
+/**
+ * Create a rebalancer instance for an indirection table
+ *
+ * @param[in]	params	- parameters.
+ * @param[out]	bal	- address of place to save the instance handle.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int mv_rss_bal_create(struct mv_rss_bal_params *params, struct mv_rss_bal **bal);
+
+/**
+ * Destroy a rebalancer instance; the indirection table is left as is
+ *
+ * @param[in]	bal	- instance handle.
+ */
+void mv_rss_bal_destroy(struct mv_rss_bal *bal);
+
+/**
+ * Sample the counters and rebalance the table if needed
+ *
+ * Call periodically (e.g. every 10-100 msec) from a control thread.
+ *
+ * @param[in]	bal		- instance handle.
+ * @param[in]	queue_cnt	- free running packet counters of the queues
+ *				  (e.g. pp2_ppio_inq_statistics.enq_desc).
+ * @param[in]	bucket_cnt	- free running packet counters of the buckets,
+ *				  or NULL if not available.
+ * @param[in]	now_ns		- current time in nsec.
+ *
+ * @retval	number of buckets moved
+ * @retval	<0 on failure
+ */
+int mv_rss_bal_update(struct mv_rss_bal *bal, const u64 *queue_cnt, const u64 *bucket_cnt, u64 now_ns);
+
+/**
+ * Get the queue of a bucket
+ *
+ * @param[in]	bal	- instance handle.
+ * @param[in]	bucket	- bucket index.
+ *
+ * @retval	queue index
+ */
+u32 mv_rss_bal_get_queue(struct mv_rss_bal *bal, u32 bucket);
+
+/**
+ * Get the rebalancer statistics
+ *
+ * @param[in]	bal	- instance handle.
+ * @param[out]	stats	- statistics.
+ * @param[in]	reset	- 1 - reset the counters after reading.
+ */
+void mv_rss_bal_get_stats(struct mv_rss_bal *bal, struct mv_rss_bal_stats *stats, int reset);
+
+#endif /* __MV_RSS_BAL_H__ */
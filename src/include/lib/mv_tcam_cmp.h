@@ -0,0 +1,245 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#ifndef __MV_TCAM_CMP_H__
+#define __MV_TCAM_CMP_H__
+
+#include "mv_std.h"
+
+/**
+ * TCAM rule compiler
+ *
+ * A TCAM entry matches a key/mask pair per field, so a port range or an
+ * address range that is not aligned to a power of two has to be expanded into
+ * several entries. Expanding every range of a rule separately multiplies the
+ * entry count of the rule by the expansion of each of its fields, which
+ * exhausts the C2 TCAM quickly with ACLs that match port ranges.
+ *
+ * The compiler takes a rule made of ANDed predicates (exact values, prefixes,
+ * ranges and raw key/mask pairs) over up to MV_TCAM_MAX_FIELDS fields of up to
+ * 64 bits, and emits the key/mask entries that match it:
+ *	- The predicates of a field are intersected: exact values, prefixes and
+ *	  ranges into a single range, then with the key/mask predicates.
+ *	- The range is expanded into the minimal set of prefixes.
+ *	- The terms of the field are minimized: pairs of terms with the same
+ *	  mask that differ in a single bit are merged, and terms contained in
+ *	  other terms are dropped, until no more reduction is possible.
+ *	- The rule entries are the cross product of the terms of its fields.
+ *
+ * The entry count of a rule or a policy can be estimated without building
+ * the entries, to check beforehand whether it fits the TCAM.
+ *
+ * The compiled entries are programmed field by field, e.g. as the key/mask
+ * strings of a pp2_cls_tbl_rule of a PP2_CLS_TBL_MASKABLE table.
+ */
+
+/** Maximum number of fields of a rule */
+#define MV_TCAM_MAX_FIELDS	8
+/** Maximum width of a field, in bits */
+#define MV_TCAM_MAX_FIELD_WIDTH	64
+
+/** Predicate types */
+enum mv_tcam_pred_type {
+	MV_TCAM_PRED_EXACT = 0,		/**< field == value */
+	MV_TCAM_PRED_PREFIX,		/**< the 'len' MSBs of the field match value */
+	MV_TCAM_PRED_RANGE,		/**< lo <= field <= hi */
+	MV_TCAM_PRED_MASK		/**< (field & mask) == (value & mask) */
+};
+
+/** A predicate on a field */
+struct mv_tcam_pred {
+	u8			field;	/**< field index */
+	enum mv_tcam_pred_type	type;
+	union {
+		u64 value;
+		struct {
+			u64	value;
+			u8	len;
+		} prefix;
+		struct {
+			u64	lo;
+			u64	hi;
+		} range;
+		struct {
+			u64	value;
+			u64	mask;
+		} mask;
+	} u;
+};
+
+/** A rule: the AND of its predicates; fields without predicates are wildcards */
+struct mv_tcam_rule {
+	u8			 num_fields;
+	u8			 widths[MV_TCAM_MAX_FIELDS];	/**< field widths, in bits */
+	u16			 num_preds;
+	struct mv_tcam_pred	*preds;
+};
+
+/** A compiled TCAM entry */
+struct mv_tcam_entry {
+	u64	key[MV_TCAM_MAX_FIELDS];
+	u64	mask[MV_TCAM_MAX_FIELDS];
+};
+
+/** Entry count estimate */
+struct mv_tcam_estimate {
+	u64	entries;	/**< entries of the compiled rule(s) */
+	u64	prefix_entries;	/**< entries of a plain range to prefix expansion */
+};
+
+/**
+ * Estimate the number of entries of a rule
+ *
+ * @param[in]	rule	- the rule.
+ * @param[out]	est	- the estimate.
+ *
+ * @retval	0 on success
+ * @retval	<0 on invalid rule
+ */
+int mv_tcam_rule_estimate(const struct mv_tcam_rule *rule, struct mv_tcam_estimate *est);
+
+/**
+ * Compile a rule into TCAM entries
+ *
+ * A rule that can never match (e.g. two disjoint ranges of the same field)
+ * compiles into zero entries.
+ *
+ * @param[in]		rule	- the rule.
+ * @param[out]		entries	- array of entries.
+ * @param[in,out]	num	- input: size of 'entries'; output: number of entries
+ *				  (also set when 'entries' is too small).
+ *
+ * @retval	0 on success
+ * @retval	-ENOSPC if 'entries' is too small
+ * @retval	<0 on invalid rule
+ */
+int mv_tcam_rule_compile(const struct mv_tcam_rule *rule, struct mv_tcam_entry *entries, u32 *num);
+
+/**
+ * Estimate the number of entries of a policy and check it fits a TCAM
+ *
+ * @param[in]	rules		- array of rules.
+ * @param[in]	num_rules	- number of rules.
+ * @param[in]	capacity	- number of free TCAM entries; 0 - do not check.
+ * @param[out]	est		- the total estimate of the rules.
+ *
+ * @retval	0 if the policy fits
+ * @retval	-ENOSPC if it does not fit
+ * @retval	<0 on invalid rule
+ */
+int mv_tcam_policy_estimate(const struct mv_tcam_rule *rules, u32 num_rules, u32 capacity,
+			    struct mv_tcam_estimate *est);
+
+/**
+ * Match field values against a compiled entry
+ *
+ * @param[in]	entry		- the entry.
+ * @param[in]	num_fields	- number of fields.
+ * @param[in]	values		- array of 'num_fields' field values.
+ *
+ * @retval	1 on match, 0 otherwise
+ */
+static inline int mv_tcam_entry_match(const struct mv_tcam_entry *entry, u8 num_fields, const u64 *values)
+{
+	u8 i;
+
+	for (i = 0; i < num_fields; i++)
+		if ((values[i] ^ entry->key[i]) & entry->mask[i])
+			return 0;
+	return 1;
+}
+
+#endif /* __MV_TCAM_CMP_H__ */
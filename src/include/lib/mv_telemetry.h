@@ -0,0 +1,347 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#ifndef __MV_TELEMETRY_H__
+#define __MV_TELEMETRY_H__
+
+#include "mv_std.h"
+
+/** Location and prefix of the shared-memory files backing the telemetry segments */
+#define MV_TLM_SHM_DIR		"/dev/shm/"
+#define MV_TLM_SHM_PREFIX	"musdk-tlm-"
+
+#define MV_TLM_NAME_MAX		32
+#define MV_TLM_MAGIC		0x4d544c4d /* "MTLM" */
+#define MV_TLM_VERSION		1
+
+/** Size of a single telemetry record; each record sits in its own cache line */
+#define MV_TLM_REC_SIZE		64
+
+/**
+ * Telemetry queue direction
+ */
+enum mv_tlm_q_dir {
+	MV_TLM_Q_DIR_RX = 0,	/**< Ingress queue */
+	MV_TLM_Q_DIR_TX,	/**< Egress queue */
+};
+
+/**
+ * Per-queue telemetry record.
+ *
+ * Each record has a single writer (the data-path thread owning the queue) and
+ * any number of readers in other processes. The writer updates the counters
+ * with relaxed atomic stores, so readers never see torn values and no lock or
+ * read-modify-write instruction is required on the data path. The occupancy
+ * is a plain sample, so it may be stored by another (e.g. control) thread.
+ */
+struct mv_tlm_queue {
+	u64	pkts;		/**< number of packets handled by the queue */
+	u64	bytes;		/**< number of bytes handled by the queue */
+	u64	drops;		/**< number of packets dropped on the queue */
+	u32	occupancy;	/**< last sampled ring occupancy (in descriptors) */
+	u32	size;		/**< ring size (in descriptors) */
+	u8	in_use;		/**< record was registered by the writer */
+	u8	dir;		/**< queue direction, see 'enum mv_tlm_q_dir' */
+	u8	port;		/**< port index (application defined) */
+	u8	tc;		/**< traffic class */
+	u8	qid;		/**< queue index within the tc */
+	u8	thread;		/**< id of the data-path thread owning the queue */
+	u8	reserved[18];
+} __attribute__((aligned(MV_TLM_REC_SIZE)));
+
+/**
+ * Per-bpool telemetry record
+ */
+struct mv_tlm_bpool {
+	u32	fill;		/**< last sampled number of buffers in the pool */
+	u32	size;		/**< total number of buffers allocated to the pool */
+	u32	buff_len;	/**< buffer length */
+	u8	in_use;		/**< record was registered by the writer */
+	u8	pp_id;		/**< packet processor id */
+	u8	pool_id;	/**< pool id */
+	u8	reserved[49];
+} __attribute__((aligned(MV_TLM_REC_SIZE)));
+
+/**
+ * Telemetry segment header. Located at the start of the shared-memory segment,
+ * followed by 'num_queues' queue records and 'num_bpools' bpool records.
+ */
+struct mv_tlm_hdr {
+	u32	magic;		/**< MV_TLM_MAGIC; written last, once the segment is initialized */
+	u16	version;	/**< MV_TLM_VERSION */
+	u16	rec_size;	/**< MV_TLM_REC_SIZE */
+	u32	num_queues;	/**< number of queue records */
+	u32	num_bpools;	/**< number of bpool records */
+	u32	pid;		/**< pid of the writer process */
+	char	name[MV_TLM_NAME_MAX];	/**< segment name */
+	u8	reserved[12];
+} __attribute__((aligned(MV_TLM_REC_SIZE)));
+
+struct mv_tlm;
+
+/**
+ * Telemetry segment parameters
+ */
+struct mv_tlm_params {
+	const char	*name;		/**< segment name; the file MV_TLM_SHM_DIR MV_TLM_SHM_PREFIX<name> is created */
+	u32		 num_queues;	/**< number of queue records */
+	u32		 num_bpools;	/**< number of bpool records */
+};
+
+/**
+ * Create a telemetry segment (writer side)
+ *
+ * The segment is created in a named shared-memory file, so that a monitoring
+ * process can sample it by calling mv_tlm_attach() without interacting with
+ * the data-path threads.
+ *
+ * @param[in]	params	A pointer to the segment parameters.
+ * @param[out]	tlm	A pointer to the created telemetry object.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int mv_tlm_create(struct mv_tlm_params *params, struct mv_tlm **tlm);
+
+/**
+ * Destroy a telemetry segment (writer side)
+ *
+ * The shared-memory file is removed; readers already attached keep their mapping.
+ *
+ * @param[in]	tlm	A pointer to a telemetry object created by mv_tlm_create().
+ */
+void mv_tlm_destroy(struct mv_tlm *tlm);
+
+/**
+ * Attach to an existing telemetry segment (reader side)
+ *
+ * The segment is mapped read-only.
+ *
+ * @param[in]	name	Segment name as passed to mv_tlm_create().
+ * @param[out]	tlm	A pointer to the telemetry object.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int mv_tlm_attach(const char *name, struct mv_tlm **tlm);
+
+/**
+ * Detach from a telemetry segment (reader side)
+ *
+ * @param[in]	tlm	A pointer to a telemetry object returned by mv_tlm_attach().
+ */
+void mv_tlm_detach(struct mv_tlm *tlm);
+
+/**
+ * Get the segment header
+ *
+ * @param[in]	tlm	A pointer to a telemetry object.
+ *
+ * @retval	A pointer to the segment header
+ */
+struct mv_tlm_hdr *mv_tlm_get_hdr(struct mv_tlm *tlm);
+
+/**
+ * Get a queue record
+ *
+ * @param[in]	tlm	A pointer to a telemetry object.
+ * @param[in]	idx	Queue record index.
+ *
+ * @retval	A pointer to the queue record, or NULL if out of range
+ */
+struct mv_tlm_queue *mv_tlm_get_queue(struct mv_tlm *tlm, u32 idx);
+
+/**
+ * Get a bpool record
+ *
+ * @param[in]	tlm	A pointer to a telemetry object.
+ * @param[in]	idx	Bpool record index.
+ *
+ * @retval	A pointer to the bpool record, or NULL if out of range
+ */
+struct mv_tlm_bpool *mv_tlm_get_bpool(struct mv_tlm *tlm, u32 idx);
+
+/**
+ * Register a queue record (writer side, control path)
+ *
+ * @param[in]	q	A pointer to the queue record.
+ * @param[in]	dir	Queue direction.
+ * @param[in]	port	Port index.
+ * @param[in]	tc	Traffic class.
+ * @param[in]	qid	Queue index within the tc.
+ * @param[in]	thread	Id of the owning data-path thread.
+ * @param[in]	size	Ring size.
+ */
+void mv_tlm_queue_register(struct mv_tlm_queue *q, enum mv_tlm_q_dir dir, u8 port, u8 tc, u8 qid,
+			   u8 thread, u32 size);
+
+/**
+ * Register a bpool record (writer side, control path)
+ *
+ * @param[in]	bp	A pointer to the bpool record.
+ * @param[in]	pp_id	Packet processor id.
+ * @param[in]	pool_id	Pool id.
+ * @param[in]	size	Total number of buffers.
+ * @param[in]	buff_len Buffer length.
+ */
+void mv_tlm_bpool_register(struct mv_tlm_bpool *bp, u8 pp_id, u8 pool_id, u32 size, u32 buff_len);
+
+/**
+ * Account a burst of packets on a queue (writer side, data path)
+ *
+ * Must only be called by the thread owning the record.
+ *
+ * @param[in]	q	A pointer to the queue record.
+ * @param[in]	pkts	Number of packets.
+ * @param[in]	bytes	Number of bytes.
+ */
+static inline void mv_tlm_queue_inc(struct mv_tlm_queue *q, u32 pkts, u32 bytes)
+{
+	__atomic_store_n(&q->pkts, q->pkts + pkts, __ATOMIC_RELAXED);
+	__atomic_store_n(&q->bytes, q->bytes + bytes, __ATOMIC_RELAXED);
+}
+
+/**
+ * Account dropped packets on a queue (writer side, data path)
+ *
+ * @param[in]	q	A pointer to the queue record.
+ * @param[in]	drops	Number of dropped packets.
+ */
+static inline void mv_tlm_queue_inc_drops(struct mv_tlm_queue *q, u32 drops)
+{
+	__atomic_store_n(&q->drops, q->drops + drops, __ATOMIC_RELAXED);
+}
+
+/**
+ * Update the ring occupancy of a queue (writer side)
+ *
+ * Unlike the counters, may be called by a thread that does not own the record.
+ *
+ * @param[in]	q		A pointer to the queue record.
+ * @param[in]	occupancy	Number of descriptors currently in the ring.
+ */
+static inline void mv_tlm_queue_set_occupancy(struct mv_tlm_queue *q, u32 occupancy)
+{
+	__atomic_store_n(&q->occupancy, occupancy, __ATOMIC_RELAXED);
+}
+
+/**
+ * Update the fill level of a bpool (writer side)
+ *
+ * @param[in]	bp	A pointer to the bpool record.
+ * @param[in]	fill	Number of buffers currently in the pool.
+ */
+static inline void mv_tlm_bpool_set_fill(struct mv_tlm_bpool *bp, u32 fill)
+{
+	__atomic_store_n(&bp->fill, fill, __ATOMIC_RELAXED);
+}
+
+/**
+ * Take a consistent-per-field snapshot of a queue record (reader side)
+ *
+ * @param[in]	q	A pointer to the queue record in the segment.
+ * @param[out]	snap	A pointer to a local copy to fill.
+ */
+static inline void mv_tlm_queue_read(struct mv_tlm_queue *q, struct mv_tlm_queue *snap)
+{
+	*snap = *q;
+	snap->pkts = __atomic_load_n(&q->pkts, __ATOMIC_RELAXED);
+	snap->bytes = __atomic_load_n(&q->bytes, __ATOMIC_RELAXED);
+	snap->drops = __atomic_load_n(&q->drops, __ATOMIC_RELAXED);
+	snap->occupancy = __atomic_load_n(&q->occupancy, __ATOMIC_RELAXED);
+}
+
+#endif /* __MV_TELEMETRY_H__ */
@@ -0,0 +1,221 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#ifndef __MV_UDF_CALC_H__
+#define __MV_UDF_CALC_H__
+
+#include "mv_std.h"
+#include "drivers/mv_net.h"
+
+/**
+ * Parser UDF (user-defined-field) offset calculator
+ *
+ * A PPv2 UDF is configured as an L2 parser entry (pp2_parse_udf_params)
+ * that matches the ethertype seen by the L2 lookup and sets the UDF to a
+ * fixed offset from that ethertype; the classifier then extracts up to four
+ * bytes from there (a MV_NET_UDF key field). The L2 lookup is reached after
+ * the MAC, DSA and VLAN lookups, so its ethertype is the one that follows the
+ * last VLAN tag (at most three tags). Everything beyond it is not walked by
+ * the parser for the UDF, so a field is reachable only at a non-negative
+ * offset from that ethertype, within the range of the parser UDF offset.
+ *
+ * The calculator takes a packet layout, given as the path of protocol headers
+ * from the outer Ethernet header, and a field in one of the headers. It
+ * checks the path against the header graph (which header may follow which),
+ * and computes the ethertype to match and the offset of the field:
+ *	- A field inside the L2 headers is rejected (-ENOTSUP).
+ *	- An offset over MV_UDF_MAX_OFFSET is rejected (-ERANGE).
+ *	- Variable length headers (IPv4/TCP options, IPv6 extension headers,
+ *	  GRE optional fields) between the ethertype and the field make the
+ *	  offset valid only for packets with the given header lengths; they are
+ *	  counted in mv_udf_cfg.var_hdrs.
+ *
+ * In the stack view used here, each L2 header ends with the type of the next
+ * header: MV_UDF_HDR_ETH is DA, SA and type (14 bytes), and a VLAN tag is the
+ * TCI and the type of the next header (4 bytes).
+ *
+ * A computed config maps to pp2_parse_udf_params as is (match_proto,
+ * match_field, match_key, match_mask, offset); 'size' is the size of the
+ * matching MV_NET_UDF classifier field (mv_net_udf.size).
+ */
+
+/** Maximum number of UDFs (PP2_MAX_UDFS_SUPPORTED) */
+#define MV_UDF_MAX_NUM		3
+/** Maximum UDF offset from the ethertype (parser SRAM UDF offset field) */
+#define MV_UDF_MAX_OFFSET	255
+/** Maximum UDF field size in bytes */
+#define MV_UDF_MAX_SIZE		4
+/** Maximum number of VLAN tags walked by the parser */
+#define MV_UDF_MAX_L2_TAGS	3
+/** Maximum number of headers of a path */
+#define MV_UDF_MAX_HDRS		16
+
+/** Header types */
+enum mv_udf_hdr_type {
+	MV_UDF_HDR_ETH = 0,	/**< Ethernet; the outer one, or inner (after VXLAN, GRE or MPLS) */
+	MV_UDF_HDR_DSA,		/**< Marvell DSA (4 bytes) or EDSA (8 bytes) tag; after the outer Ethernet */
+	MV_UDF_HDR_VLAN,	/**< 802.1Q C-tag */
+	MV_UDF_HDR_QINQ,	/**< 802.1ad S-tag */
+	MV_UDF_HDR_PPPOE,	/**< PPPoE session and PPP protocol (8 bytes) */
+	MV_UDF_HDR_MPLS,	/**< MPLS label */
+	MV_UDF_HDR_IP4,		/**< IPv4; 20 - 60 bytes */
+	MV_UDF_HDR_IP6,		/**< IPv6 incl. extension headers; 40 bytes and up */
+	MV_UDF_HDR_UDP,		/**< UDP */
+	MV_UDF_HDR_TCP,		/**< TCP; 20 - 60 bytes */
+	MV_UDF_HDR_GRE,		/**< GRE; 4 - 16 bytes */
+	MV_UDF_HDR_VXLAN,	/**< VXLAN (8 bytes) */
+	MV_UDF_HDR_RAW,		/**< opaque header or payload; 'len' is mandatory */
+	MV_UDF_HDR_LAST
+};
+
+/** Header of a path */
+struct mv_udf_hdr {
+	enum mv_udf_hdr_type	type;
+	u16			len;	/**< header length; 0 for the minimal (or fixed) length */
+	u16			etype;	/**< ethertype of a RAW header that follows the L2 headers */
+};
+
+/** UDF field request */
+struct mv_udf_field {
+	const struct mv_udf_hdr	*path;		/**< headers, from the outer Ethernet header */
+	u8			num_hdrs;	/**< number of headers of the path */
+	u8			hdr;		/**< index of the header of the field */
+	u16			offs;		/**< field offset in the header */
+	u8			size;		/**< field size; 1 - MV_UDF_MAX_SIZE bytes */
+};
+
+/** UDF config */
+struct mv_udf_cfg {
+	enum mv_net_proto		match_proto;	/**< MV_NET_PROTO_ETH */
+	union mv_net_proto_fields	match_field;	/**< MV_NET_ETH_F_TYPE */
+	u8				match_key[MV_ETH_ETYPE_LEN];	/**< ethertype, network order */
+	u8				match_mask[MV_ETH_ETYPE_LEN];
+	u8				offset;		/**< field offset from the ethertype (incl.) */
+	u8				size;		/**< field size */
+	u16				pkt_offs;	/**< field offset from the start of the frame */
+	u8				l2_tags;	/**< VLAN tags before the ethertype */
+	u8				var_hdrs;	/**< variable length headers before the field */
+};
+
+/**
+ * Compute the UDF config of a field
+ *
+ * @param[in]	field	- field request.
+ * @param[out]	cfg	- UDF config.
+ *
+ * @retval	0 on success
+ * @retval	-EINVAL on an invalid request or path
+ * @retval	-ENOTSUP if the parser does not reach the field
+ * @retval	-ERANGE if the field offset is over MV_UDF_MAX_OFFSET
+ */
+int mv_udf_calc(const struct mv_udf_field *field, struct mv_udf_cfg *cfg);
+
+/**
+ * Check that a set of UDF configs can be used together
+ *
+ * The parser applies the UDF of the first L2 entry that matches the packet
+ * ethertype only, so the UDFs of a set must match different ethertypes.
+ *
+ * @param[in]	cfgs	- UDF configs, in the order of pp2_parse_udfs.
+ * @param[in]	num	- number of UDF configs.
+ *
+ * @retval	0 on success
+ * @retval	-EINVAL on too many configs
+ * @retval	-EEXIST if a UDF is shadowed by a previous one
+ */
+int mv_udf_calc_check(const struct mv_udf_cfg *cfgs, u32 num);
+
+#endif /* __MV_UDF_CALC_H__ */
@@ -0,0 +1,243 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#ifndef __MV_WRED_H__
+#define __MV_WRED_H__
+
+#include "mv_std.h"
+#include "lib/mv_policer.h"
+
+/**
+ * Weighted RED (random early detection)
+ *
+ * Keeps an EWMA of the queue depth seen by the arriving packets and drops
+ * them with a probability that depends on the average and on the packet color
+ * (e.g. as marked by mv_plcr): no drops below 'min_th', a linear rise up to
+ * 'max_p_pct' at 'max_th' and drops of all packets above it. In gentle mode
+ * the probability rises linearly from 'max_p_pct' to 100% between 'max_th' and
+ * 2 * 'max_th' instead. The drops are spread evenly using the RED count of
+ * packets since the last drop.
+ *
+ * Usage as a software AQM ahead of a software queue:
+ *	if (mv_wred_drop(wred, mv_ring_count(ring), color))
+ *		<free the packet>;
+ *	else
+ *		mv_ring_enqueue_burst(ring, &pkt, 1);
+ *
+ * The PPv2 early-drop (pp2_cls_early_drop_params) only supports a static
+ * threshold on the in-Q occupancy. mv_wred_sim() replays a recorded occupancy
+ * trace (e.g. sampled in-Q fill levels) through the WRED model and recommends
+ * the static threshold that drops the same share of that trace.
+ */
+
+#define MV_WRED_PROB_SHIFT	16
+#define MV_WRED_PROB_ONE	(1 << MV_WRED_PROB_SHIFT)	/**< probability 1 in fixed point */
+
+/** Per-color drop curve */
+struct mv_wred_curve {
+	u32	min_th;		/**< no drops below this average depth */
+	u32	max_th;		/**< all drops (or gentle rise) above this average depth */
+	u32	max_p_pct;	/**< drop probability at 'max_th', in percent */
+};
+
+/** WRED parameters */
+struct mv_wred_params {
+	struct mv_wred_curve	curve[MV_PLCR_COLOR_NUM];	/**< curves, indexed by color;
+								 * a zero curve drops nothing
+								 */
+	u32			wq_shift;	/**< EWMA weight is 1/2^wq_shift (default 9) */
+	int			gentle;		/**< gentle RED above 'max_th' */
+	u32			seed;		/**< random seed (0 - default) */
+};
+
+/** WRED statistics */
+struct mv_wred_stats {
+	u64	pkts[MV_PLCR_COLOR_NUM];
+	u64	drops[MV_PLCR_COLOR_NUM];
+};
+
+/** Result of a trace replay (see mv_wred_sim()) */
+struct mv_wred_sim_result {
+	u32	samples;	/**< trace samples */
+	u32	drop_ppm;	/**< expected WRED drop share of the samples, in ppm */
+	u32	avg_depth;	/**< mean of the WRED average depth */
+	u32	max_depth;	/**< max sampled depth */
+	u32	thresh;		/**< recommended static drop threshold */
+	u32	thresh_drop_ppm; /**< drop share of the samples at 'thresh', in ppm */
+};
+
+struct mv_wred;
+
+/**
+ * Create a WRED instance
+ *
+ * @param[in]	params	- parameters.
+ * @param[out]	wred	- address of place to save the instance handle.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int mv_wred_create(struct mv_wred_params *params, struct mv_wred **wred);
+
+/**
+ * Destroy a WRED instance
+ *
+ * @param[in]	wred	- instance handle.
+ */
+void mv_wred_destroy(struct mv_wred *wred);
+
+/**
+ * Decide whether to drop an arriving packet
+ *
+ * @param[in]	wred	- instance handle.
+ * @param[in]	depth	- current queue depth (packets, descriptors or bytes).
+ * @param[in]	color	- packet color.
+ *
+ * @retval	1 if the packet should be dropped, 0 otherwise
+ */
+int mv_wred_drop(struct mv_wred *wred, u32 depth, enum mv_plcr_color color);
+
+/**
+ * Get the drop probability of a color at an average depth (the drop curve)
+ *
+ * @param[in]	wred	- instance handle.
+ * @param[in]	avg	- average depth, in 1/256 units.
+ * @param[in]	color	- packet color.
+ *
+ * @retval	drop probability, in 1/MV_WRED_PROB_ONE units
+ */
+u32 mv_wred_prob(struct mv_wred *wred, u32 avg, enum mv_plcr_color color);
+
+/**
+ * Get the current average depth
+ *
+ * @param[in]	wred	- instance handle.
+ *
+ * @retval	average depth, in 1/256 units
+ */
+u32 mv_wred_get_avg(struct mv_wred *wred);
+
+/**
+ * Get the WRED statistics
+ *
+ * @param[in]	wred	- instance handle.
+ * @param[out]	stats	- statistics.
+ * @param[in]	reset	- 1 - reset the counters after reading.
+ */
+void mv_wred_get_stats(struct mv_wred *wred, struct mv_wred_stats *stats, int reset);
+
+/**
+ * Replay an occupancy trace through a WRED model and recommend a static threshold
+ *
+ * Every sample is taken as an arrival that sees the sampled depth. The WRED
+ * average and expected drops are computed over the trace (the state of
+ * 'params' is not changed); the recommended threshold is the lowest one whose
+ * tail drops do not exceed the WRED drops, clamped to the [min_th, max_th]
+ * range of the green curve.
+ *
+ * @param[in]	params	- WRED parameters to emulate.
+ * @param[in]	depth	- trace of sampled depths.
+ * @param[in]	color	- colors of the samples, or NULL for all green.
+ * @param[in]	num	- number of samples.
+ * @param[out]	res	- replay result.
+ *
+ * @retval	0 on success
+ * @retval	<0 on failure
+ */
+int mv_wred_sim(struct mv_wred_params *params, const u32 *depth, const u8 *color, u32 num,
+		struct mv_wred_sim_result *res);
+
+#endif /* __MV_WRED_H__ */
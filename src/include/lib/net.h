@@ -152,6 +152,29 @@ struct mv_udphdr {
 	u16	chksum;   /**< UDP header and data checksum (0 if not used) */
 } __packed;
 
+/** TCP header */
+struct mv_tcphdr {
+	u16	src_port;	/**< Source port */
+	u16	dst_port;	/**< Destination port */
+	u32	seq;		/**< Sequence number */
+	u32	ack_seq;	/**< Acknowledgment number */
+	u8	doff;		/**< Data offset in words (4 MSBits) */
+	u8	flags;		/**< TCP flags */
+	u16	window;		/**< Window size */
+	u16	chksum;		/**< Header, data and pseudo-header checksum */
+	u16	urg_ptr;	/**< Urgent pointer */
+} __packed;
+
+#define MV_TCP_HDR_LEN_MIN	20
+#define MV_TCP_FLAG_FIN		0x01
+#define MV_TCP_FLAG_SYN		0x02
+#define MV_TCP_FLAG_RST		0x04
+#define MV_TCP_FLAG_PSH		0x08
+#define MV_TCP_FLAG_ACK		0x10
+#define MV_TCP_FLAG_URG		0x20
+#define MV_TCP_FLAG_ECE		0x40
+#define MV_TCP_FLAG_CWR		0x80
+
 union mv_ip_addr {
 	u32 ip4;	/* IPv4 Address */
 	u32 ip6[4];	/* IPv6 Address */
@@ -0,0 +1,309 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include "std_internal.h"
+
+#include "lib/mv_adapt_poll.h"
+
+#define APOLL_NSEC_PER_USEC	1000ULL
+#define APOLL_NSEC_PER_SEC	1000000000ULL
+#define APOLL_MAX_WAIT_EVENTS	64
+
+#define APOLL_DEF_IDLE_POLLS	64
+#define APOLL_DEF_MIN_POLL_USECS	20
+#define APOLL_DEF_LOW_PPS	250000
+#define APOLL_DEF_HIGH_PPS	500000
+#define APOLL_DEF_SAMPLE_USECS	50
+#define APOLL_DEF_USEC_COAL	100
+#define APOLL_DEF_PKT_COAL	64
+
+struct mv_apoll {
+	struct mv_apoll_params	params;
+	enum mv_apoll_mode	mode;
+	u64			now_ns;		/* time of the last update */
+	u64			poll_start_ns;	/* entry time into POLL mode */
+	u32			empty_polls;
+	u64			sample_start_ns;
+	u32			sample_pkts;
+	u64			rate;		/* EWMA of the rate in pps */
+	u64			sleep_start_ns;
+	u32			pkt_coal;
+	u32			usec_coal;
+	struct mv_apoll_stats	stats;
+};
+
+int mv_apoll_create(struct mv_apoll_params *params, struct mv_apoll **ap)
+{
+	struct mv_apoll *a;
+
+	if (!params->set_event) {
+		pr_err("[%s] set_event callback is mandatory\n", __func__);
+		return -EINVAL;
+	}
+
+	a = kcalloc(1, sizeof(*a), GFP_KERNEL);
+	if (!a)
+		return -ENOMEM;
+
+	a->params = *params;
+	if (!a->params.idle_polls)
+		a->params.idle_polls = APOLL_DEF_IDLE_POLLS;
+	if (!a->params.min_poll_usecs)
+		a->params.min_poll_usecs = APOLL_DEF_MIN_POLL_USECS;
+	if (!a->params.low_pps)
+		a->params.low_pps = APOLL_DEF_LOW_PPS;
+	if (!a->params.high_pps)
+		a->params.high_pps = APOLL_DEF_HIGH_PPS;
+	if (!a->params.sample_usecs)
+		a->params.sample_usecs = APOLL_DEF_SAMPLE_USECS;
+	if (!a->params.max_usec_coal)
+		a->params.max_usec_coal = APOLL_DEF_USEC_COAL;
+	if (!a->params.max_pkt_coal)
+		a->params.max_pkt_coal = APOLL_DEF_PKT_COAL;
+	if (a->params.low_pps > a->params.high_pps) {
+		pr_err("[%s] low_pps %u is above high_pps %u\n", __func__, a->params.low_pps, a->params.high_pps);
+		kfree(a);
+		return -EINVAL;
+	}
+
+	a->mode = MV_APOLL_MODE_POLL;
+	*ap = a;
+	return 0;
+}
+
+void mv_apoll_destroy(struct mv_apoll *ap)
+{
+	if (ap->mode == MV_APOLL_MODE_SLEEP)
+		ap->params.set_event(ap->params.arg, ap->params.ev, 0);
+	kfree(ap);
+}
+
+void mv_apoll_update(struct mv_apoll *ap, u32 pkts, u64 now_ns)
+{
+	u64 dt, inst;
+
+	ap->now_ns = now_ns;
+	ap->stats.polls++;
+	ap->stats.pkts += pkts;
+	if (pkts) {
+		ap->empty_polls = 0;
+	} else {
+		ap->empty_polls++;
+		ap->stats.empty_polls++;
+	}
+
+	ap->sample_pkts += pkts;
+	dt = now_ns - ap->sample_start_ns;
+	if (dt < ap->params.sample_usecs * APOLL_NSEC_PER_USEC)
+		return;
+
+	inst = ap->sample_pkts * APOLL_NSEC_PER_SEC / dt;
+	ap->rate = (3 * ap->rate + inst) / 4;
+	ap->sample_start_ns = now_ns;
+	ap->sample_pkts = 0;
+
+	if (ap->mode == MV_APOLL_MODE_POLL && ap->rate > ap->params.high_pps) {
+		ap->mode = MV_APOLL_MODE_BUSY;
+		ap->stats.busy_entries++;
+	} else if (ap->mode == MV_APOLL_MODE_BUSY && ap->rate < ap->params.low_pps) {
+		ap->mode = MV_APOLL_MODE_POLL;
+	}
+}
+
+static inline int apoll_is_idle(struct mv_apoll *ap)
+{
+	return ap->mode == MV_APOLL_MODE_POLL && ap->empty_polls >= ap->params.idle_polls &&
+	       ap->now_ns - ap->poll_start_ns >= ap->params.min_poll_usecs * APOLL_NSEC_PER_USEC;
+}
+
+int mv_apoll_should_sleep(struct mv_apoll **ap, int num)
+{
+	int i;
+
+	for (i = 0; i < num; i++)
+		if (!apoll_is_idle(ap[i]))
+			return 0;
+	return 1;
+}
+
+/* Packets expected within the latency budget, so that a wakeup is served in one burst */
+static void apoll_coal_update(struct mv_apoll *ap)
+{
+	u32 pkt_coal, usec_coal = ap->params.max_usec_coal;
+
+	pkt_coal = (u32)min(ap->rate * usec_coal / 1000000, (u64)ap->params.max_pkt_coal);
+	if (!pkt_coal)
+		pkt_coal = 1;
+	if (pkt_coal == ap->pkt_coal && usec_coal == ap->usec_coal)
+		return;
+	if (ap->params.set_coal && ap->params.set_coal(ap->params.arg, pkt_coal, usec_coal))
+		return;
+	ap->pkt_coal = pkt_coal;
+	ap->usec_coal = usec_coal;
+}
+
+int mv_apoll_arm(struct mv_apoll **ap, int num, u64 now_ns)
+{
+	int i, err;
+
+	for (i = 0; i < num; i++) {
+		apoll_coal_update(ap[i]);
+		err = ap[i]->params.set_event(ap[i]->params.arg, ap[i]->params.ev, 1);
+		if (err) {
+			pr_err("[%s] can't enable event %d\n", __func__, i);
+			mv_apoll_disarm(ap, i, now_ns);
+			return err;
+		}
+		ap[i]->mode = MV_APOLL_MODE_SLEEP;
+		ap[i]->sleep_start_ns = now_ns;
+		ap[i]->stats.sleeps++;
+	}
+	return 0;
+}
+
+void mv_apoll_disarm(struct mv_apoll **ap, int num, u64 now_ns)
+{
+	struct mv_apoll *a;
+	int i;
+
+	for (i = 0; i < num; i++) {
+		a = ap[i];
+		if (a->mode != MV_APOLL_MODE_SLEEP)
+			continue;
+		a->params.set_event(a->params.arg, a->params.ev, 0);
+		a->stats.sleep_ns += now_ns - a->sleep_start_ns;
+		/* the queue must be found idle again before the next sleep */
+		a->mode = MV_APOLL_MODE_POLL;
+		a->empty_polls = 0;
+		a->now_ns = now_ns;
+		a->poll_start_ns = now_ns;
+	}
+}
+
+int mv_apoll_wait(struct mv_apoll **ap, int num, int timeout_ms, u64 now_ns)
+{
+	struct mv_sys_event *evs[APOLL_MAX_WAIT_EVENTS];
+	struct timespec ts;
+	int i, ret;
+
+	if (num > APOLL_MAX_WAIT_EVENTS)
+		return -EINVAL;
+
+	for (i = 0; i < num; i++)
+		evs[i] = ap[i]->params.ev;
+
+	ret = mv_apoll_arm(ap, num, now_ns);
+	if (ret)
+		return ret;
+
+	ret = mv_sys_event_poll(evs, num, timeout_ms);
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	mv_apoll_disarm(ap, num, (u64)ts.tv_sec * APOLL_NSEC_PER_SEC + ts.tv_nsec);
+	return ret;
+}
+
+enum mv_apoll_mode mv_apoll_get_mode(struct mv_apoll *ap)
+{
+	return ap->mode;
+}
+
+void mv_apoll_get_stats(struct mv_apoll *ap, struct mv_apoll_stats *stats, int reset)
+{
+	*stats = ap->stats;
+	if (reset)
+		memset(&ap->stats, 0, sizeof(ap->stats));
+}
@@ -143,13 +143,14 @@ int read_file_to_buf(char *file_name, char *buff, u32 size)
 		return -EINVAL;
 	}
 
-	/* Read file */
-	s = read(fd, buff, size);
+	/* Read file, leaving room for the NUL terminator */
+	s = read(fd, buff, size - 1);
 	if (s == -1) {
 		pr_err("error %d\n", errno);
 		close(fd);
 		return -EINVAL;
 	}
+	buff[s] = 0;
 	close(fd);
 	return 0;
 }
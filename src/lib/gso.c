@@ -0,0 +1,433 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include "std_internal.h"
+#include "lib/net.h"
+
+#include "lib/mv_gso.h"
+
+#define GSO_IP4_MF_OFFS_MASK	0x3fff	/* MF flag + fragment offset */
+
+struct gso_tmpl {
+	u8	hdr[MV_GSO_MAX_HDR_LEN];
+	u32	ip_base;	/* IPv4 header sum w/o total_len, id and checksum */
+	u32	l4_base;	/* pseudo-header + L4 header sum w/o the per-segment fields */
+	u32	seq;		/* TCP sequence number, host order */
+};
+
+static inline u16 gso_get16(const void *p)
+{
+	u16 v;
+
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline void gso_put16(void *p, u16 v)
+{
+	memcpy(p, &v, sizeof(v));
+}
+
+static inline u16 gso_fold(u64 sum)
+{
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return (u16)sum;
+}
+
+/* One's complement sum of a buffer, in network byte order layout, of any
+ * alignment and length. The result is only meaningful when the buffer
+ * starts at an even offset of the summed block; use gso_swab16() otherwise.
+ */
+static u16 gso_csum_partial(const u8 *p, u32 len)
+{
+	u64 acc = 0;
+	u32 w32;
+	u16 w16;
+
+	while (len >= 8) {
+		memcpy(&w32, p, sizeof(w32));
+		acc += w32;
+		memcpy(&w32, p + 4, sizeof(w32));
+		acc += w32;
+		p += 8;
+		len -= 8;
+	}
+	while (len >= 2) {
+		acc += gso_get16(p);
+		p += 2;
+		len -= 2;
+	}
+	if (len) {
+		u8 tail[2] = {*p, 0};
+
+		memcpy(&w16, tail, sizeof(w16));
+		acc += w16;
+	}
+	return gso_fold(acc);
+}
+
+static inline u16 gso_swab16(u16 v)
+{
+	return (u16)((v << 8) | (v >> 8));
+}
+
+static int gso_parse(struct mv_gso_params *params, struct mv_gso_buf *first, struct mv_gso_info *info)
+{
+	u8 *l3 = (u8 *)first->vaddr + params->l3_offset;
+	u8 proto;
+	u16 l4_hdr_len;
+
+	if (params->l3_offset + sizeof(struct mv_ipv4hdr) > first->len)
+		return -EINVAL;
+
+	switch (l3[0] >> 4) {
+	case MV_IP_VER_4: {
+		struct mv_ipv4hdr *iph = (struct mv_ipv4hdr *)l3;
+
+		if ((l3[0] & 0xf) < MV_IPV4_HL_MIN ||
+		    (ntohs(gso_get16(&iph->frag_offset)) & GSO_IP4_MF_OFFS_MASK))
+			return -EINVAL;
+		info->l3_type = MV_GSO_L3_IPV4;
+		info->l4_offset = params->l3_offset + (l3[0] & 0xf) * 4;
+		proto = iph->proto;
+		break;
+	}
+	case MV_IP_VER_6:
+		if (params->l3_offset + sizeof(struct mv_ipv6hdr) > first->len)
+			return -EINVAL;
+		info->l3_type = MV_GSO_L3_IPV6;
+		info->l4_offset = params->l3_offset + sizeof(struct mv_ipv6hdr);
+		proto = ((struct mv_ipv6hdr *)l3)->next_header;
+		break;
+	default:
+		return -EINVAL;
+	}
+	info->l3_offset = params->l3_offset;
+
+	if (proto == IPPROTO_TCP) {
+		if (info->l4_offset + MV_TCP_HDR_LEN_MIN > first->len)
+			return -EINVAL;
+		info->l4_type = MV_GSO_L4_TCP;
+		l4_hdr_len = (((struct mv_tcphdr *)((u8 *)first->vaddr + info->l4_offset))->doff >> 4) * 4;
+		if (l4_hdr_len < MV_TCP_HDR_LEN_MIN)
+			return -EINVAL;
+	} else if (proto == IPPROTO_UDP) {
+		if (info->l4_offset + sizeof(struct mv_udphdr) > first->len)
+			return -EINVAL;
+		info->l4_type = MV_GSO_L4_UDP;
+		l4_hdr_len = sizeof(struct mv_udphdr);
+	} else {
+		return -EINVAL;
+	}
+
+	info->hdr_len = info->l4_offset + l4_hdr_len;
+	if (info->hdr_len > first->len || info->hdr_len > MV_GSO_MAX_HDR_LEN)
+		return -EINVAL;
+
+	return 0;
+}
+
+/* Build the header template and the partial sums of all the fields that do
+ * not change between segments.
+ */
+static void gso_tmpl_build(struct mv_gso_params *params, struct mv_gso_buf *first,
+			   struct mv_gso_info *info, struct gso_tmpl *tmpl)
+{
+	u8 *l3 = tmpl->hdr + info->l3_offset;
+	u8 *l4 = tmpl->hdr + info->l4_offset;
+	u16 l4_hdr_len = info->hdr_len - info->l4_offset;
+	u64 sum;
+
+	memcpy(tmpl->hdr, first->vaddr, info->hdr_len);
+	tmpl->ip_base = 0;
+
+	if (info->l3_type == MV_GSO_L3_IPV4) {
+		struct mv_ipv4hdr *iph = (struct mv_ipv4hdr *)l3;
+
+		gso_put16(&iph->total_len, 0);
+		gso_put16(&iph->id, 0);
+		gso_put16(&iph->chksum, 0);
+		tmpl->ip_base = gso_csum_partial(l3, info->l4_offset - info->l3_offset);
+		/* restore the original ID; it is the base of the per-segment IDs */
+		memcpy(&iph->id, &((struct mv_ipv4hdr *)((u8 *)first->vaddr + info->l3_offset))->id, 2);
+		sum = gso_csum_partial(iph->src_addr, 2 * MV_IPV4ADDR_LEN);
+	} else {
+		struct mv_ipv6hdr *ip6h = (struct mv_ipv6hdr *)l3;
+
+		sum = gso_csum_partial(ip6h->src_addr, 2 * MV_IPV6ADDR_LEN);
+	}
+	sum += htons(info->l4_type == MV_GSO_L4_TCP ? IPPROTO_TCP : IPPROTO_UDP);
+
+	if (info->l4_type == MV_GSO_L4_TCP) {
+		struct mv_tcphdr *th = (struct mv_tcphdr *)l4;
+		u32 seq;
+
+		memcpy(&seq, &th->seq, sizeof(seq));
+		tmpl->seq = ntohl(seq);
+		gso_put16(&th->chksum, 0);
+		/* sum w/o the sequence number and the data offset/flags word */
+		sum += gso_csum_partial(l4, l4_hdr_len);
+		sum += (u16)~gso_get16(&th->seq);
+		sum += (u16)~gso_get16((u8 *)&th->seq + 2);
+		sum += (u16)~gso_get16(&th->doff);
+	} else {
+		struct mv_udphdr *uh = (struct mv_udphdr *)l4;
+
+		gso_put16(&uh->length, 0);
+		gso_put16(&uh->chksum, 0);
+		sum += gso_csum_partial(l4, l4_hdr_len);
+	}
+	tmpl->l4_base = gso_fold(sum);
+}
+
+/* Patch the header copy of segment 'seg' (of 'num_segs') carrying 'pay_len' payload
+ * bytes at payload offset 'pay_offs'. Returns the partial L4 sum of the header
+ * fields that were patched (including the pseudo-header length).
+ */
+static u32 gso_hdr_patch(struct mv_gso_info *info, struct gso_tmpl *tmpl, u8 *hdr,
+			 u16 seg, u16 num_segs, u32 pay_offs, u16 pay_len)
+{
+	u8 *l3 = hdr + info->l3_offset;
+	u8 *l4 = hdr + info->l4_offset;
+	u16 l4_len = info->hdr_len - info->l4_offset + pay_len;
+	u32 sum = htons(l4_len);
+
+	memcpy(hdr, tmpl->hdr, info->hdr_len);
+
+	if (info->l3_type == MV_GSO_L3_IPV4) {
+		struct mv_ipv4hdr *iph = (struct mv_ipv4hdr *)l3;
+		u16 tot_len = htons(info->hdr_len - info->l3_offset + pay_len);
+		u16 id = htons(ntohs(gso_get16(&iph->id)) + seg);
+
+		gso_put16(&iph->total_len, tot_len);
+		gso_put16(&iph->id, id);
+		gso_put16(&iph->chksum, ~gso_fold((u64)tmpl->ip_base + tot_len + id));
+	} else {
+		struct mv_ipv6hdr *ip6h = (struct mv_ipv6hdr *)l3;
+
+		gso_put16(&ip6h->pl_len, htons(info->hdr_len - info->l3_offset -
+					       sizeof(struct mv_ipv6hdr) + pay_len));
+	}
+
+	if (info->l4_type == MV_GSO_L4_TCP) {
+		struct mv_tcphdr *th = (struct mv_tcphdr *)l4;
+		u32 seq = htonl(tmpl->seq + pay_offs);
+
+		memcpy(&th->seq, &seq, sizeof(seq));
+		if (seg != num_segs - 1)
+			th->flags &= ~(MV_TCP_FLAG_FIN | MV_TCP_FLAG_PSH);
+		if (seg)
+			th->flags &= ~MV_TCP_FLAG_CWR;
+		sum += gso_get16(&th->seq) + gso_get16((u8 *)&th->seq + 2) + gso_get16(&th->doff);
+	} else {
+		struct mv_udphdr *uh = (struct mv_udphdr *)l4;
+
+		gso_put16(&uh->length, htons(l4_len));
+		sum += htons(l4_len);
+	}
+	return sum;
+}
+
+static void gso_l4_csum_set(struct mv_gso_info *info, u8 *hdr, u16 csum)
+{
+	u8 *l4 = hdr + info->l4_offset;
+
+	if (info->l4_type == MV_GSO_L4_TCP)
+		gso_put16(&((struct mv_tcphdr *)l4)->chksum, csum);
+	else
+		gso_put16(&((struct mv_udphdr *)l4)->chksum, csum);
+}
+
+int mv_gso_segment(struct mv_gso_params *params, struct mv_gso_buf *in, u16 num_in,
+		   struct mv_gso_frag *frags, u16 max_out, u8 *seg_frags, u16 max_segs,
+		   struct mv_gso_info *info)
+{
+	struct gso_tmpl tmpl;
+	struct mv_gso_frag *frag;
+	u32 payload = 0, pay_offs = 0, off, stride, take, csum;
+	u16 seg, num_segs, pay_len, left, seg_nfrags, nfrags = 0, b = 0;
+	u8 max_frags = params->max_frags ? params->max_frags : MV_GSO_MAX_SEG_FRAGS;
+	u8 *hdr;
+	int err;
+
+	if (unlikely(!num_in || !params->mss || max_frags < 2))
+		return -EINVAL;
+
+	err = gso_parse(params, &in[0], info);
+	if (unlikely(err))
+		return err;
+	if (unlikely((u32)info->hdr_len + params->mss > 0xffff))
+		return -EINVAL;
+
+	for (b = 0; b < num_in; b++)
+		payload += in[b].len;
+	payload -= info->hdr_len;
+	if (unlikely(!payload))
+		return -EINVAL;
+
+	num_segs = (payload + params->mss - 1) / params->mss;
+	stride = mv_gso_hdr_stride(info->hdr_len);
+	if (unlikely(num_segs > max_segs || (u64)num_segs * stride > params->hdr_area.len))
+		return -ENOSPC;
+
+	gso_tmpl_build(params, &in[0], info, &tmpl);
+
+	b = 0;
+	off = info->hdr_len;
+	for (seg = 0; seg < num_segs; seg++) {
+		pay_len = min((u32)params->mss, payload - pay_offs);
+		hdr = (u8 *)params->hdr_area.vaddr + seg * stride;
+		csum = gso_hdr_patch(info, &tmpl, hdr, seg, num_segs, pay_offs, pay_len);
+
+		if (unlikely(nfrags >= max_out))
+			return -ENOSPC;
+		frag = &frags[nfrags++];
+		frag->vaddr = hdr;
+		frag->paddr = params->hdr_area.paddr + seg * stride;
+		frag->len = info->hdr_len;
+		frag->flags = MV_GSO_FRAG_FIRST;
+		seg_nfrags = 1;
+
+		left = pay_len;
+		while (left) {
+			if (off == in[b].len) {
+				b++;
+				off = 0;
+				continue;
+			}
+			if (unlikely(seg_nfrags == max_frags))
+				return -E2BIG;
+			if (unlikely(nfrags >= max_out))
+				return -ENOSPC;
+
+			take = min(in[b].len - off, (u32)left);
+			frag = &frags[nfrags++];
+			frag->vaddr = (u8 *)in[b].vaddr + off;
+			frag->paddr = in[b].paddr + off;
+			frag->len = take;
+			frag->flags = 0;
+			seg_nfrags++;
+
+			if (params->l4_csum == MV_GSO_L4_CSUM_SW) {
+				u16 psum = gso_csum_partial(frag->vaddr, take);
+
+				/* fragment starting at an odd payload offset */
+				csum += ((pay_len - left) & 1) ? gso_swab16(psum) : psum;
+			}
+			off += take;
+			left -= take;
+		}
+		frag->flags |= MV_GSO_FRAG_LAST;
+		seg_frags[seg] = seg_nfrags;
+
+		if (params->l4_csum == MV_GSO_L4_CSUM_SW) {
+			csum = (u16)~gso_fold((u64)tmpl.l4_base + csum);
+			/* UDP: a calculated checksum of 0 is transmitted as all ones */
+			if (!csum && info->l4_type == MV_GSO_L4_UDP)
+				csum = 0xffff;
+			gso_l4_csum_set(info, hdr, csum);
+		} else {
+			gso_l4_csum_set(info, hdr, 0);
+		}
+
+		pay_offs += pay_len;
+	}
+
+	info->num_segs = num_segs;
+	info->num_frags = nfrags;
+	return 0;
+}
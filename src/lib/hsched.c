@@ -0,0 +1,484 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include "std_internal.h"
+
+#include "lib/mv_hsched.h"
+
+#define HSCHED_NSEC_PER_SEC	1000000000ULL
+
+/* Token bucket; tokens are kept in bytes << 32 to allow sub-byte per nsec rates */
+struct hsched_tb {
+	u64	tokens;
+	u64	size;
+	u64	rate;		/* (bytes << 32) per nsec; 0 means unlimited */
+	u64	max_dt;		/* nsec needed to fill an empty bucket */
+	u64	last_ns;
+};
+
+struct hsched_qent {
+	u64	cookie;
+	u32	len;
+};
+
+struct hsched_queue {
+	struct hsched_qent	*ents;
+	u32			 head;
+	u32			 tail;
+	u32			 deficit;
+	u32			 quantum;
+	u64			 pkts;
+	u64			 bytes;
+	u64			 drops;
+};
+
+struct hsched_tc {
+	struct hsched_tb	tb;
+	u8			q_mask;		/* queues with pending packets */
+	u8			rr;		/* DRR current queue */
+	u8			credited;	/* current queue got its quantum */
+};
+
+struct hsched_sub {
+	struct hsched_tb	tb;
+	u32			deficit;
+	u32			quantum;
+	u8			tc_mask;	/* TCs with pending packets */
+	u8			active;
+	struct hsched_tc	tcs[MV_HSCHED_MAX_TCS];
+};
+
+struct mv_hsched {
+	struct mv_hsched_params	 params;
+	u32			 qmask;
+	struct hsched_tb	 port_tb;
+	struct hsched_sub	*subs;
+	struct hsched_queue	*queues;
+	struct hsched_qent	*ents;
+	u32			*active;	/* ring of active subscribers */
+	u32			 act_head;
+	u32			 act_cnt;
+	u8			 credited;	/* head subscriber got its quantum */
+};
+
+static int hsched_tb_init(struct hsched_tb *tb, u64 rate, u32 burst)
+{
+	memset(tb, 0, sizeof(*tb));
+	if (!rate)
+		return 0;
+	if (!burst)
+		return -EINVAL;
+
+	tb->size = (u64)burst << 32;
+	tb->tokens = tb->size;
+	tb->rate = ((rate / HSCHED_NSEC_PER_SEC) << 32) + ((rate % HSCHED_NSEC_PER_SEC) << 32) / HSCHED_NSEC_PER_SEC;
+	if (!tb->rate)
+		tb->rate = 1;
+	tb->max_dt = tb->size / tb->rate + 1;
+	return 0;
+}
+
+static inline void hsched_tb_refill(struct hsched_tb *tb, u64 now_ns)
+{
+	u64 dt = now_ns - tb->last_ns;
+
+	if (!dt)
+		return;
+	tb->last_ns = now_ns;
+	if (dt >= tb->max_dt) {
+		tb->tokens = tb->size;
+		return;
+	}
+	tb->tokens += dt * tb->rate;
+	if (tb->tokens > tb->size)
+		tb->tokens = tb->size;
+}
+
+/* Check the bucket allows 'len' bytes; unlimited buckets always do */
+static inline int hsched_tb_check(struct hsched_tb *tb, u64 now_ns, u32 len)
+{
+	if (!tb->rate)
+		return 1;
+	hsched_tb_refill(tb, now_ns);
+	return tb->tokens >= ((u64)len << 32);
+}
+
+static inline void hsched_tb_consume(struct hsched_tb *tb, u32 len)
+{
+	if (tb->rate)
+		tb->tokens -= (u64)len << 32;
+}
+
+static inline struct hsched_queue *hsched_queue_get(struct mv_hsched *sched, u32 sub, u8 tc, u8 queue)
+{
+	return &sched->queues[(sub * sched->params.num_tcs + tc) * sched->params.num_queues + queue];
+}
+
+int mv_hsched_sub_config(struct mv_hsched *sched, u32 sub, struct mv_hsched_sub_params *params)
+{
+	struct hsched_sub *s;
+	struct hsched_queue *q;
+	u8 tc, i;
+
+	if (sub >= sched->params.num_subs) {
+		pr_err("[%s] invalid subscriber %u\n", __func__, sub);
+		return -EINVAL;
+	}
+	s = &sched->subs[sub];
+
+	if (hsched_tb_init(&s->tb, params->rate, params->burst)) {
+		pr_err("[%s] subscriber %u: burst must be set with rate\n", __func__, sub);
+		return -EINVAL;
+	}
+	s->quantum = (params->weight ? params->weight : 1) * MV_HSCHED_QUANTUM;
+
+	for (tc = 0; tc < sched->params.num_tcs; tc++) {
+		if (hsched_tb_init(&s->tcs[tc].tb, params->tc_rate[tc], params->tc_burst[tc])) {
+			pr_err("[%s] subscriber %u tc %u: burst must be set with rate\n", __func__, sub, tc);
+			return -EINVAL;
+		}
+		for (i = 0; i < sched->params.num_queues; i++) {
+			q = hsched_queue_get(sched, sub, tc, i);
+			q->quantum = (params->q_weight[tc][i] ? params->q_weight[tc][i] : 1) * MV_HSCHED_QUANTUM;
+		}
+	}
+	return 0;
+}
+
+int mv_hsched_create(struct mv_hsched_params *params, struct mv_hsched **sched)
+{
+	struct mv_hsched *s;
+	struct mv_hsched_sub_params sub_params;
+	u32 i, qsize, num_queues;
+
+	if (!params->num_subs || !params->num_tcs || params->num_tcs > MV_HSCHED_MAX_TCS ||
+	    !params->num_queues || params->num_queues > MV_HSCHED_MAX_QUEUES || params->qsize < 2) {
+		pr_err("[%s] invalid params\n", __func__);
+		return -EINVAL;
+	}
+
+	s = kcalloc(1, sizeof(*s), GFP_KERNEL);
+	if (!s)
+		return -ENOMEM;
+
+	for (qsize = 2; qsize < params->qsize; qsize <<= 1)
+		;
+	s->params = *params;
+	s->params.qsize = qsize;
+	s->qmask = qsize - 1;
+	num_queues = params->num_subs * params->num_tcs * params->num_queues;
+
+	s->subs = kcalloc(params->num_subs, sizeof(struct hsched_sub), GFP_KERNEL);
+	s->queues = kcalloc(num_queues, sizeof(struct hsched_queue), GFP_KERNEL);
+	s->ents = kcalloc((size_t)num_queues * qsize, sizeof(struct hsched_qent), GFP_KERNEL);
+	s->active = kcalloc(params->num_subs, sizeof(u32), GFP_KERNEL);
+	if (!s->subs || !s->queues || !s->ents || !s->active) {
+		pr_err("[%s] no mem for %u queues\n", __func__, num_queues);
+		mv_hsched_destroy(s);
+		return -ENOMEM;
+	}
+
+	if (hsched_tb_init(&s->port_tb, params->port_rate, params->port_burst)) {
+		pr_err("[%s] port burst must be set with rate\n", __func__);
+		mv_hsched_destroy(s);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < num_queues; i++)
+		s->queues[i].ents = &s->ents[(size_t)i * qsize];
+
+	memset(&sub_params, 0, sizeof(sub_params));
+	for (i = 0; i < params->num_subs; i++)
+		mv_hsched_sub_config(s, i, &sub_params);
+
+	*sched = s;
+	return 0;
+}
+
+void mv_hsched_destroy(struct mv_hsched *sched)
+{
+	kfree(sched->subs);
+	kfree(sched->queues);
+	kfree(sched->ents);
+	kfree(sched->active);
+	kfree(sched);
+}
+
+int mv_hsched_enqueue(struct mv_hsched *sched, struct mv_hsched_pkt *pkts, u16 *num)
+{
+	struct mv_hsched_pkt *pkt;
+	struct hsched_queue *q;
+	struct hsched_sub *sub;
+	struct hsched_qent *ent;
+	u16 i, drops = 0;
+
+	for (i = 0; i < *num; i++) {
+		pkt = &pkts[i];
+		if (unlikely(pkt->sub >= sched->params.num_subs || pkt->tc >= sched->params.num_tcs ||
+			     pkt->queue >= sched->params.num_queues)) {
+			pkts[drops++] = *pkt;
+			continue;
+		}
+		q = hsched_queue_get(sched, pkt->sub, pkt->tc, pkt->queue);
+		if (unlikely(q->tail - q->head == sched->params.qsize)) {
+			q->drops++;
+			pkts[drops++] = *pkt;
+			continue;
+		}
+		ent = &q->ents[q->tail++ & sched->qmask];
+		ent->cookie = pkt->cookie;
+		ent->len = pkt->len;
+
+		sub = &sched->subs[pkt->sub];
+		sub->tcs[pkt->tc].q_mask |= BIT(pkt->queue);
+		sub->tc_mask |= BIT(pkt->tc);
+		if (!sub->active) {
+			sub->active = 1;
+			sched->active[(sched->act_head + sched->act_cnt++) % sched->params.num_subs] = pkt->sub;
+		}
+	}
+	*num -= drops;
+	return 0;
+}
+
+/* DRR selection of the next queue inside a TC; the TC must have pending packets */
+static inline u8 hsched_tc_pick(struct mv_hsched *sched, u32 sub, u8 tc_idx, struct hsched_tc *tc)
+{
+	struct hsched_queue *q;
+
+	for (;;) {
+		if (tc->q_mask & BIT(tc->rr)) {
+			q = hsched_queue_get(sched, sub, tc_idx, tc->rr);
+			if (!tc->credited) {
+				q->deficit += q->quantum;
+				tc->credited = 1;
+			}
+			if (q->deficit >= q->ents[q->head & sched->qmask].len)
+				return tc->rr;
+		}
+		tc->rr = (tc->rr + 1 == sched->params.num_queues) ? 0 : tc->rr + 1;
+		tc->credited = 0;
+	}
+}
+
+static inline void hsched_sub_rotate(struct mv_hsched *sched, u32 sid, int remove)
+{
+	sched->act_head = (sched->act_head + 1 == sched->params.num_subs) ? 0 : sched->act_head + 1;
+	sched->act_cnt--;
+	if (remove)
+		sched->subs[sid].active = 0;
+	else
+		sched->active[(sched->act_head + sched->act_cnt++) % sched->params.num_subs] = sid;
+	sched->credited = 0;
+}
+
+int mv_hsched_dequeue(struct mv_hsched *sched, u64 now_ns, struct mv_hsched_pkt *pkts, u16 *num)
+{
+	u32 overhead = sched->params.frame_overhead;
+	u32 sid, idle_visits = 0, len = 0;
+	struct hsched_sub *sub;
+	struct hsched_tc *tc = NULL;
+	struct hsched_queue *q = NULL;
+	struct hsched_qent *ent;
+	u16 n = 0;
+	u8 t, qi = 0, tc_mask;
+	int sent, shaped, port_blocked = 0;
+
+	while (n < *num && sched->act_cnt) {
+		sid = sched->active[sched->act_head];
+		sub = &sched->subs[sid];
+		if (!sched->credited) {
+			sub->deficit += sub->quantum;
+			sched->credited = 1;
+		}
+
+		sent = 0;
+		shaped = 0;
+		while (n < *num) {
+			/* highest priority TC that is not shaped out */
+			for (tc_mask = sub->tc_mask; tc_mask; tc_mask &= ~BIT(t)) {
+				t = __builtin_ctz(tc_mask);
+				tc = &sub->tcs[t];
+				qi = hsched_tc_pick(sched, sid, t, tc);
+				q = hsched_queue_get(sched, sid, t, qi);
+				len = q->ents[q->head & sched->qmask].len + overhead;
+				if (hsched_tb_check(&tc->tb, now_ns, len))
+					break;
+			}
+			if (!tc_mask || !hsched_tb_check(&sub->tb, now_ns, len)) {
+				shaped = 1;
+				break;
+			}
+			if (sub->deficit < len)
+				break;
+			if (!hsched_tb_check(&sched->port_tb, now_ns, len)) {
+				port_blocked = 1;
+				break;
+			}
+
+			ent = &q->ents[q->head++ & sched->qmask];
+			pkts[n].cookie = ent->cookie;
+			pkts[n].len = ent->len;
+			pkts[n].sub = sid;
+			pkts[n].tc = t;
+			pkts[n].queue = qi;
+			n++;
+			sent++;
+
+			hsched_tb_consume(&tc->tb, len);
+			hsched_tb_consume(&sub->tb, len);
+			hsched_tb_consume(&sched->port_tb, len);
+			sub->deficit -= len;
+			q->deficit -= ent->len;
+			q->pkts++;
+			q->bytes += ent->len;
+
+			if (q->head == q->tail) {
+				q->deficit = 0;
+				tc->q_mask &= ~BIT(qi);
+				tc->credited = 0;
+				if (!tc->q_mask)
+					sub->tc_mask &= ~BIT(t);
+			}
+			if (!sub->tc_mask)
+				break;
+		}
+
+		if (!sub->tc_mask) {
+			sub->deficit = 0;
+			hsched_sub_rotate(sched, sid, 1);
+			idle_visits = 0;
+			continue;
+		}
+		if (port_blocked || n == *num)
+			break;
+
+		/* turn is over: out of deficit or shaped out; a shaped out
+		 * subscriber must not bank credit while it waits for tokens
+		 */
+		if (shaped && sub->deficit > sub->quantum)
+			sub->deficit = sub->quantum;
+		hsched_sub_rotate(sched, sid, 0);
+		/* a subscriber out of deficit gets credit on its next visit, so
+		 * only a full round of shaped out subscribers ends the dequeue
+		 */
+		if (sent)
+			idle_visits = 0;
+		else if (shaped && ++idle_visits >= sched->act_cnt)
+			break;
+	}
+
+	*num = n;
+	return 0;
+}
+
+int mv_hsched_queue_get_stats(struct mv_hsched *sched, u32 sub, u8 tc, u8 queue,
+			      struct mv_hsched_queue_stats *stats, int reset)
+{
+	struct hsched_queue *q;
+
+	if (sub >= sched->params.num_subs || tc >= sched->params.num_tcs || queue >= sched->params.num_queues)
+		return -EINVAL;
+
+	q = hsched_queue_get(sched, sub, tc, queue);
+	stats->pkts = q->pkts;
+	stats->bytes = q->bytes;
+	stats->drops = q->drops;
+	stats->occupancy = q->tail - q->head;
+	if (reset)
+		q->pkts = q->bytes = q->drops = 0;
+	return 0;
+}
@@ -0,0 +1,810 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include "std_internal.h"
+#include "lib/net.h"
+
+#include "lib/mv_ip_frag.h"
+
+#define IP_FRAG_IP4_DF			0x4000
+#define IP_FRAG_IP4_MF			0x2000
+#define IP_FRAG_IP4_OFFS_MASK		0x1fff
+#define IP_FRAG_IP6_HDR_LEN		40
+#define IP_FRAG_IP6_FHDR_LEN		8
+#define IP_FRAG_IP6_NH_HOP		0
+#define IP_FRAG_IP6_NH_ROUTING		43
+#define IP_FRAG_IP6_NH_FRAG		44
+#define IP_FRAG_IP6_NH_DSTOPTS		60
+#define IP_FRAG_IP6_M			0x0001
+#define IP_FRAG_IP6_OFFS_MASK		0xfff8
+#define IP_FRAG_IP4_OPT_EOL		0
+#define IP_FRAG_IP4_OPT_NOP		1
+#define IP_FRAG_IP4_OPT_COPIED		0x80
+#define IP_FRAG_MAX_DGRAM_LEN		0xffff
+
+/* IPv6 fragment extension header */
+struct ip_frag_ip6_fhdr {
+	u8	next_header;
+	u8	rsvd;
+	u16	offs_m;
+	u32	id;
+} __packed;
+
+struct ip_reass_key {
+	u32	src[4];
+	u32	dst[4];
+	u32	id;
+	u8	ver;
+	u8	proto;
+	u16	rsvd;
+};
+
+struct ip_reass_frag {
+	void	*cookie;
+	u8	*data;		/* buffer start (L2 header) */
+	u16	 hdr_len;	/* data to payload; meaningful for the first fragment only */
+	u16	 offs;		/* payload offset in the datagram */
+	u16	 len;		/* payload length */
+};
+
+struct ip_reass_flow {
+	struct ip_reass_key	 key;
+	struct ip_reass_flow	*lru_prev;
+	struct ip_reass_flow	*lru_next;
+	u64			 start_ms;
+	u32			 total_len;	/* 0 until the last fragment arrives */
+	u32			 rcv_len;
+	u16			 num_frags;
+	u8			 in_use;
+	u8			 l3_offset;	/* of the first fragment */
+	u16			 fh_offset;	/* IPv6: fragment header offset in the first fragment */
+	u16			 nh_offset;	/* IPv6: offset of the next-header field pointing at it */
+	struct ip_reass_frag	 frags[MV_IP_REASS_MAX_FRAGS];
+};
+
+struct mv_ip_reass {
+	struct mv_ip_reass_params	 params;
+	struct ip_reass_flow		*flows;
+	u32				 num_buckets;
+	u32				 num_flows;
+	struct ip_reass_flow		*lru_head;
+	struct ip_reass_flow		*lru_tail;
+	void				**death_row;
+	u32				 dr_cnt;
+	struct mv_ip_reass_stats	 stats;
+};
+
+static inline u16 ip_frag_get16(const void *p)
+{
+	u16 v;
+
+	memcpy(&v, p, sizeof(v));
+	return ntohs(v);
+}
+
+static inline void ip_frag_put16(void *p, u16 v)
+{
+	v = htons(v);
+	memcpy(p, &v, sizeof(v));
+}
+
+/* IPv4 header checksum of a header of any alignment */
+static u16 ip_frag_ip4_csum(u8 *iph, u16 len)
+{
+	u32 sum = 0;
+	u16 i;
+
+	ip_frag_put16(iph + offsetof(struct mv_ipv4hdr, chksum), 0);
+	for (i = 0; i < len; i += 2)
+		sum += ip_frag_get16(iph + i);
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return (u16)~sum;
+}
+
+/* Build the options of the non-first fragments: only the options with
+ * the 'copied' flag set, padded to 4 bytes. Returns the options length.
+ */
+static u16 ip_frag_ip4_copied_opts(const u8 *opts, u16 len, u8 *out)
+{
+	u16 i = 0, o = 0, olen;
+
+	while (i < len) {
+		if (opts[i] == IP_FRAG_IP4_OPT_EOL)
+			break;
+		if (opts[i] == IP_FRAG_IP4_OPT_NOP) {
+			i++;
+			continue;
+		}
+		if (i + 1 >= len || opts[i + 1] < 2 || i + opts[i + 1] > len)
+			break;
+		olen = opts[i + 1];
+		if (opts[i] & IP_FRAG_IP4_OPT_COPIED) {
+			memcpy(out + o, opts + i, olen);
+			o += olen;
+		}
+		i += olen;
+	}
+	while (o & 3)
+		out[o++] = IP_FRAG_IP4_OPT_EOL;
+	return o;
+}
+
+int mv_ip_fragment(struct mv_ip_frag_params *params, struct mv_gso_buf *in, u16 num_in,
+		   struct mv_gso_frag *frags, u16 max_out, u8 *pkt_frags, u16 max_pkts, u16 *num_pkts)
+{
+	u8 *l3 = (u8 *)in[0].vaddr + params->l3_offset;
+	u8 tmpl[2][MV_GSO_MAX_HDR_LEN];	/* [0] first fragment header, [1] the others */
+	u16 hdr_len[2], l3_hdr_len[2], chunk[2];
+	u8 max_frags = params->max_frags ? params->max_frags : MV_GSO_MAX_SEG_FRAGS;
+	u32 l3_len = 0, pay_len, pay_offs = 0, off, take, stride, left;
+	u16 pkt, nfrags = 0, npieces, base_offs = 0, b, t;
+	int is_ip4, last_mf = 0;
+	struct mv_gso_frag *frag;
+	u8 *hdr;
+
+	if (unlikely(!num_in || params->l3_offset + sizeof(struct mv_ipv4hdr) > in[0].len))
+		return -EINVAL;
+
+	for (b = 0; b < num_in; b++)
+		l3_len += in[b].len;
+	l3_len -= params->l3_offset;
+
+	is_ip4 = ((l3[0] >> 4) == MV_IP_VER_4);
+	if (is_ip4) {
+		u16 fo = ip_frag_get16(l3 + offsetof(struct mv_ipv4hdr, frag_offset));
+
+		l3_hdr_len[0] = (l3[0] & 0xf) * 4;
+		if (l3_hdr_len[0] < sizeof(struct mv_ipv4hdr))
+			return -EINVAL;
+		if (l3_len > params->mtu && (fo & IP_FRAG_IP4_DF))
+			return -EMSGSIZE;
+		/* re-fragmenting a fragment keeps its offset and MF flag */
+		base_offs = (fo & IP_FRAG_IP4_OFFS_MASK) * 8;
+		last_mf = !!(fo & IP_FRAG_IP4_MF);
+	} else if ((l3[0] >> 4) == MV_IP_VER_6) {
+		u8 nh = ((struct mv_ipv6hdr *)l3)->next_header;
+
+		if (nh == IP_FRAG_IP6_NH_HOP || nh == IP_FRAG_IP6_NH_ROUTING ||
+		    nh == IP_FRAG_IP6_NH_FRAG || nh == IP_FRAG_IP6_NH_DSTOPTS)
+			return -EINVAL;
+		l3_hdr_len[0] = IP_FRAG_IP6_HDR_LEN;
+	} else {
+		return -EINVAL;
+	}
+	hdr_len[0] = params->l3_offset + l3_hdr_len[0];
+	if (hdr_len[0] > in[0].len || hdr_len[0] + IP_FRAG_IP6_FHDR_LEN > MV_GSO_MAX_HDR_LEN ||
+	    l3_len <= l3_hdr_len[0])
+		return -EINVAL;
+	pay_len = l3_len - l3_hdr_len[0];
+
+	/* Fits the MTU: pass the chain through as a single packet */
+	if (l3_len <= params->mtu) {
+		if (num_in > max_frags)
+			return -E2BIG;
+		if (num_in > max_out || !max_pkts)
+			return -ENOSPC;
+		for (b = 0; b < num_in; b++) {
+			frags[b].vaddr = in[b].vaddr;
+			frags[b].paddr = in[b].paddr;
+			frags[b].len = in[b].len;
+			frags[b].flags = (b == 0 ? MV_GSO_FRAG_FIRST : 0) | (b == num_in - 1 ? MV_GSO_FRAG_LAST : 0);
+		}
+		pkt_frags[0] = num_in;
+		*num_pkts = 1;
+		return 0;
+	}
+
+	/* Build the header templates */
+	memcpy(tmpl[0], in[0].vaddr, hdr_len[0]);
+	if (is_ip4) {
+		memcpy(tmpl[1], in[0].vaddr, params->l3_offset + sizeof(struct mv_ipv4hdr));
+		l3_hdr_len[1] = sizeof(struct mv_ipv4hdr) +
+				ip_frag_ip4_copied_opts(l3 + sizeof(struct mv_ipv4hdr),
+							l3_hdr_len[0] - sizeof(struct mv_ipv4hdr),
+							tmpl[1] + params->l3_offset + sizeof(struct mv_ipv4hdr));
+		tmpl[1][params->l3_offset] = (MV_IP_VER_4 << 4) | (l3_hdr_len[1] / 4);
+		hdr_len[1] = params->l3_offset + l3_hdr_len[1];
+	} else {
+		struct ip_frag_ip6_fhdr *fh = (struct ip_frag_ip6_fhdr *)(tmpl[0] + hdr_len[0]);
+		u32 id = htonl(params->ip6_id);
+
+		fh->next_header = ((struct mv_ipv6hdr *)l3)->next_header;
+		fh->rsvd = 0;
+		memcpy(&fh->id, &id, sizeof(id));
+		((struct mv_ipv6hdr *)(tmpl[0] + params->l3_offset))->next_header = IP_FRAG_IP6_NH_FRAG;
+		l3_hdr_len[0] += IP_FRAG_IP6_FHDR_LEN;
+		hdr_len[0] += IP_FRAG_IP6_FHDR_LEN;
+		memcpy(tmpl[1], tmpl[0], hdr_len[0]);
+		l3_hdr_len[1] = l3_hdr_len[0];
+		hdr_len[1] = hdr_len[0];
+	}
+
+	for (t = 0; t < 2; t++) {
+		if (params->mtu < l3_hdr_len[t] + 8)
+			return -EINVAL;
+		chunk[t] = (params->mtu - l3_hdr_len[t]) & ~7;
+	}
+	stride = mv_gso_hdr_stride(max(hdr_len[0], hdr_len[1]));
+
+	b = 0;
+	off = params->l3_offset + (is_ip4 ? l3_hdr_len[0] : IP_FRAG_IP6_HDR_LEN);
+	for (pkt = 0; pay_offs < pay_len; pkt++) {
+		t = pkt ? 1 : 0;
+		left = min((u32)chunk[t], pay_len - pay_offs);
+
+		if (unlikely(pkt >= max_pkts || (u64)(pkt + 1) * stride > params->hdr_area.len ||
+			     nfrags >= max_out))
+			return -ENOSPC;
+		if (unlikely(base_offs + pay_offs + left > IP_FRAG_MAX_DGRAM_LEN))
+			return -EINVAL;
+
+		hdr = (u8 *)params->hdr_area.vaddr + pkt * stride;
+		memcpy(hdr, tmpl[t], hdr_len[t]);
+		l3 = hdr + params->l3_offset;
+		if (is_ip4) {
+			u16 fo = ((base_offs + pay_offs) / 8) |
+				 ((pay_offs + left < pay_len || last_mf) ? IP_FRAG_IP4_MF : 0);
+
+			ip_frag_put16(l3 + offsetof(struct mv_ipv4hdr, total_len), l3_hdr_len[t] + left);
+			ip_frag_put16(l3 + offsetof(struct mv_ipv4hdr, frag_offset), fo);
+			ip_frag_put16(l3 + offsetof(struct mv_ipv4hdr, chksum), ip_frag_ip4_csum(l3, l3_hdr_len[t]));
+		} else {
+			u16 fo = pay_offs | ((pay_offs + left < pay_len) ? IP_FRAG_IP6_M : 0);
+
+			ip_frag_put16(l3 + offsetof(struct mv_ipv6hdr, pl_len), IP_FRAG_IP6_FHDR_LEN + left);
+			ip_frag_put16(l3 + IP_FRAG_IP6_HDR_LEN + offsetof(struct ip_frag_ip6_fhdr, offs_m), fo);
+		}
+
+		frag = &frags[nfrags++];
+		frag->vaddr = hdr;
+		frag->paddr = params->hdr_area.paddr + pkt * stride;
+		frag->len = hdr_len[t];
+		frag->flags = MV_GSO_FRAG_FIRST;
+		npieces = 1;
+
+		pay_offs += left;
+		while (left) {
+			if (off == in[b].len) {
+				b++;
+				off = 0;
+				continue;
+			}
+			if (unlikely(npieces == max_frags))
+				return -E2BIG;
+			if (unlikely(nfrags >= max_out))
+				return -ENOSPC;
+			take = min(in[b].len - off, left);
+			frag = &frags[nfrags++];
+			frag->vaddr = (u8 *)in[b].vaddr + off;
+			frag->paddr = in[b].paddr + off;
+			frag->len = take;
+			frag->flags = 0;
+			npieces++;
+			off += take;
+			left -= take;
+		}
+		frag->flags |= MV_GSO_FRAG_LAST;
+		pkt_frags[pkt] = npieces;
+	}
+
+	*num_pkts = pkt;
+	return 0;
+}
+
+/*
+ * Reassembly
+ */
+
+static inline u32 ip_reass_hash(struct ip_reass_key *key)
+{
+	u32 h = key->id * 0x9e3779b1;
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		h ^= key->src[i];
+		h *= 0x85ebca6b;
+		h ^= key->dst[i];
+		h *= 0xc2b2ae35;
+		h ^= h >> 15;
+	}
+	h ^= key->proto;
+	return h ^ (h >> 16);
+}
+
+static void ip_reass_death_row_add(struct mv_ip_reass *reass, void *cookie)
+{
+	/* room is guaranteed by mv_ip_reass_process() */
+	reass->death_row[reass->dr_cnt++] = cookie;
+}
+
+static void ip_reass_flow_free(struct mv_ip_reass *reass, struct ip_reass_flow *flow, int drop)
+{
+	u16 i;
+
+	if (drop)
+		for (i = 0; i < flow->num_frags; i++)
+			ip_reass_death_row_add(reass, flow->frags[i].cookie);
+
+	if (flow->lru_prev)
+		flow->lru_prev->lru_next = flow->lru_next;
+	else
+		reass->lru_head = flow->lru_next;
+	if (flow->lru_next)
+		flow->lru_next->lru_prev = flow->lru_prev;
+	else
+		reass->lru_tail = flow->lru_prev;
+
+	flow->in_use = 0;
+	flow->num_frags = 0;
+	reass->num_flows--;
+}
+
+int mv_ip_reass_create(struct mv_ip_reass_params *params, struct mv_ip_reass **reass)
+{
+	struct mv_ip_reass *r;
+	u32 num_buckets;
+
+	if (!params->max_flows || !params->timeout_ms ||
+	    params->death_row_size < MV_IP_REASS_MAX_FRAGS + 1) {
+		pr_err("[%s] invalid params (death row must hold at least %d entries)\n",
+		       __func__, MV_IP_REASS_MAX_FRAGS + 1);
+		return -EINVAL;
+	}
+
+	r = kcalloc(1, sizeof(*r), GFP_KERNEL);
+	if (!r)
+		return -ENOMEM;
+
+	/* twice the flows over the buckets to keep the associativity misses low */
+	for (num_buckets = 1; num_buckets * MV_IP_REASS_BUCKET_ENTRIES < 2 * params->max_flows; num_buckets <<= 1)
+		;
+	r->params = *params;
+	r->num_buckets = num_buckets;
+	r->flows = kcalloc(num_buckets * MV_IP_REASS_BUCKET_ENTRIES, sizeof(struct ip_reass_flow), GFP_KERNEL);
+	r->death_row = kcalloc(params->death_row_size, sizeof(void *), GFP_KERNEL);
+	if (!r->flows || !r->death_row) {
+		pr_err("[%s] no mem for %u flows\n", __func__, params->max_flows);
+		mv_ip_reass_destroy(r);
+		return -ENOMEM;
+	}
+
+	*reass = r;
+	return 0;
+}
+
+void mv_ip_reass_destroy(struct mv_ip_reass *reass)
+{
+	kfree(reass->flows);
+	kfree(reass->death_row);
+	kfree(reass);
+}
+
+/* Expire timed out flows, keeping 'reserve' death row entries free */
+static int ip_reass_expire(struct mv_ip_reass *reass, u64 now_ms, u32 reserve)
+{
+	struct ip_reass_flow *flow;
+	int cnt = 0;
+
+	while ((flow = reass->lru_head) &&
+	       now_ms >= flow->start_ms + reass->params.timeout_ms &&
+	       reass->dr_cnt + flow->num_frags + reserve <= reass->params.death_row_size) {
+		ip_reass_flow_free(reass, flow, 1);
+		reass->stats.timeouts++;
+		cnt++;
+	}
+	return cnt;
+}
+
+int mv_ip_reass_expire(struct mv_ip_reass *reass, u64 now_ms)
+{
+	return ip_reass_expire(reass, now_ms, 0);
+}
+
+u32 mv_ip_reass_death_row_get(struct mv_ip_reass *reass, void **cookies, u32 max)
+{
+	u32 cnt = min(max, reass->dr_cnt);
+
+	/* return the most recent ones; order is irrelevant for buffer release */
+	reass->dr_cnt -= cnt;
+	memcpy(cookies, &reass->death_row[reass->dr_cnt], cnt * sizeof(void *));
+	return cnt;
+}
+
+int mv_ip_reass_linearize(struct mv_ip_reass_pkt *pkt, u8 *buf, u32 size)
+{
+	u32 len = 0;
+	u16 i;
+
+	if (pkt->len > size)
+		return -ENOSPC;
+	for (i = 0; i < pkt->num_frags; i++) {
+		memcpy(buf + len, pkt->frags[i].vaddr, pkt->frags[i].len);
+		len += pkt->frags[i].len;
+	}
+	return len;
+}
+
+void mv_ip_reass_get_stats(struct mv_ip_reass *reass, struct mv_ip_reass_stats *stats, int reset)
+{
+	*stats = reass->stats;
+	if (reset)
+		memset(&reass->stats, 0, sizeof(reass->stats));
+}
+
+/* Parse an IP packet. Returns 1 for a fragment, 0 for a complete packet,
+ * negative on error. On success 'frag' holds the payload description.
+ */
+static int ip_reass_parse(u8 *data, u16 len, u8 l3_offset, struct ip_reass_key *key,
+			  struct ip_reass_frag *frag, int *more, u16 *fh_offset, u16 *nh_offset)
+{
+	u8 *l3 = data + l3_offset;
+	u16 l3_len, hlen, fo;
+
+	if (l3_offset + sizeof(struct mv_ipv4hdr) > len)
+		return -EINVAL;
+
+	memset(key, 0, sizeof(*key));
+	if ((l3[0] >> 4) == MV_IP_VER_4) {
+		struct mv_ipv4hdr *iph = (struct mv_ipv4hdr *)l3;
+
+		hlen = (l3[0] & 0xf) * 4;
+		l3_len = ip_frag_get16(&iph->total_len);
+		if (hlen < sizeof(struct mv_ipv4hdr) || l3_len < hlen || l3_offset + l3_len > len)
+			return -EINVAL;
+		fo = ip_frag_get16(&iph->frag_offset);
+		frag->data = data;
+		frag->hdr_len = l3_offset + hlen;
+		frag->offs = (fo & IP_FRAG_IP4_OFFS_MASK) * 8;
+		frag->len = l3_len - hlen;
+		*more = !!(fo & IP_FRAG_IP4_MF);
+		if (!*more && !frag->offs)
+			return 0;
+
+		key->ver = MV_IP_VER_4;
+		key->proto = iph->proto;
+		key->id = ip_frag_get16(&iph->id);
+		memcpy(key->src, iph->src_addr, MV_IPV4ADDR_LEN);
+		memcpy(key->dst, iph->dst_addr, MV_IPV4ADDR_LEN);
+	} else if ((l3[0] >> 4) == MV_IP_VER_6) {
+		struct mv_ipv6hdr *ip6h = (struct mv_ipv6hdr *)l3;
+		struct ip_frag_ip6_fhdr *fh;
+		u16 nh_off = offsetof(struct mv_ipv6hdr, next_header);
+		u8 nh = ip6h->next_header;
+
+		if (l3_offset + IP_FRAG_IP6_HDR_LEN > len)
+			return -EINVAL;
+		l3_len = IP_FRAG_IP6_HDR_LEN + ip_frag_get16(&ip6h->pl_len);
+		if (l3_offset + l3_len > len)
+			return -EINVAL;
+
+		/* skip the unfragmentable extension headers */
+		hlen = IP_FRAG_IP6_HDR_LEN;
+		while (nh == IP_FRAG_IP6_NH_HOP || nh == IP_FRAG_IP6_NH_ROUTING || nh == IP_FRAG_IP6_NH_DSTOPTS) {
+			if (hlen + 8 > l3_len)
+				return -EINVAL;
+			nh = l3[hlen];
+			nh_off = hlen;
+			hlen += (l3[hlen + 1] + 1) * 8;
+		}
+		frag->data = data;
+		if (nh != IP_FRAG_IP6_NH_FRAG) {
+			frag->hdr_len = l3_offset + hlen;
+			frag->offs = 0;
+			frag->len = l3_len - hlen;
+			return 0;
+		}
+		if (hlen + IP_FRAG_IP6_FHDR_LEN > l3_len)
+			return -EINVAL;
+
+		fh = (struct ip_frag_ip6_fhdr *)(l3 + hlen);
+		fo = ip_frag_get16(&fh->offs_m);
+		*fh_offset = l3_offset + hlen;
+		*nh_offset = l3_offset + nh_off;
+		frag->hdr_len = l3_offset + hlen + IP_FRAG_IP6_FHDR_LEN;
+		frag->offs = fo & IP_FRAG_IP6_OFFS_MASK;
+		frag->len = l3_len - hlen - IP_FRAG_IP6_FHDR_LEN;
+		*more = !!(fo & IP_FRAG_IP6_M);
+
+		key->ver = MV_IP_VER_6;
+		key->proto = fh->next_header;
+		memcpy(&key->id, &fh->id, sizeof(key->id));
+		memcpy(key->src, ip6h->src_addr, MV_IPV6ADDR_LEN);
+		memcpy(key->dst, ip6h->dst_addr, MV_IPV6ADDR_LEN);
+	} else {
+		return -EINVAL;
+	}
+
+	/* all fragments but the last must carry a multiple of 8 bytes */
+	if ((*more && (frag->len & 7)) || !frag->len ||
+	    (u32)frag->offs + frag->len > IP_FRAG_MAX_DGRAM_LEN)
+		return -EINVAL;
+	return 1;
+}
+
+static struct ip_reass_flow *ip_reass_flow_get(struct mv_ip_reass *reass, struct ip_reass_key *key, u64 now_ms)
+{
+	struct ip_reass_flow *bucket, *flow, *free_flow = NULL;
+	u32 i;
+
+	bucket = &reass->flows[(ip_reass_hash(key) & (reass->num_buckets - 1)) * MV_IP_REASS_BUCKET_ENTRIES];
+	for (i = 0; i < MV_IP_REASS_BUCKET_ENTRIES; i++) {
+		flow = &bucket[i];
+		if (!flow->in_use) {
+			if (!free_flow)
+				free_flow = flow;
+			continue;
+		}
+		if (!memcmp(&flow->key, key, sizeof(*key)))
+			return flow;
+	}
+
+	if (!free_flow || reass->num_flows >= reass->params.max_flows)
+		return NULL;
+
+	flow = free_flow;
+	flow->key = *key;
+	flow->start_ms = now_ms;
+	flow->total_len = 0;
+	flow->rcv_len = 0;
+	flow->num_frags = 0;
+	flow->in_use = 1;
+	flow->lru_next = NULL;
+	flow->lru_prev = reass->lru_tail;
+	if (reass->lru_tail)
+		reass->lru_tail->lru_next = flow;
+	else
+		reass->lru_head = flow;
+	reass->lru_tail = flow;
+	reass->num_flows++;
+	return flow;
+}
+
+/* Header part of the first fragment that the reassembled datagram's IPv4 total_len
+ * or IPv6 pl_len field counts on top of the payload
+ */
+static inline u16 ip_reass_len_hdr(u8 ver, const struct ip_reass_frag *first, u8 l3_offset)
+{
+	if (ver == MV_IP_VER_4)
+		return first->hdr_len - l3_offset;
+	return first->hdr_len - l3_offset - IP_FRAG_IP6_HDR_LEN - IP_FRAG_IP6_FHDR_LEN;
+}
+
+static void ip_reass_complete(struct mv_ip_reass *reass, struct ip_reass_flow *flow, struct mv_ip_reass_pkt *pkt)
+{
+	struct ip_reass_frag *first = &flow->frags[0];
+	u8 *data = first->data;
+	u8 *l3 = data + flow->l3_offset;
+	u16 i, hdr_len = first->hdr_len;
+
+	if (flow->key.ver == MV_IP_VER_4) {
+		ip_frag_put16(l3 + offsetof(struct mv_ipv4hdr, total_len), hdr_len - flow->l3_offset + flow->total_len);
+		ip_frag_put16(l3 + offsetof(struct mv_ipv4hdr, frag_offset), 0);
+		ip_frag_put16(l3 + offsetof(struct mv_ipv4hdr, chksum),
+			      ip_frag_ip4_csum(l3, hdr_len - flow->l3_offset));
+	} else {
+		/* drop the fragment header: unlink it and slide the headers over it */
+		data[flow->nh_offset] = ((struct ip_frag_ip6_fhdr *)(data + flow->fh_offset))->next_header;
+		memmove(data + IP_FRAG_IP6_FHDR_LEN, data, flow->fh_offset);
+		data += IP_FRAG_IP6_FHDR_LEN;
+		hdr_len -= IP_FRAG_IP6_FHDR_LEN;
+		l3 = data + flow->l3_offset;
+		ip_frag_put16(l3 + offsetof(struct mv_ipv6hdr, pl_len),
+			      hdr_len - flow->l3_offset - IP_FRAG_IP6_HDR_LEN + flow->total_len);
+	}
+
+	pkt->num_frags = flow->num_frags;
+	pkt->frags[0].cookie = first->cookie;
+	pkt->frags[0].vaddr = data;
+	pkt->frags[0].len = hdr_len + first->len;
+	pkt->len = pkt->frags[0].len;
+	for (i = 1; i < flow->num_frags; i++) {
+		pkt->frags[i].cookie = flow->frags[i].cookie;
+		pkt->frags[i].vaddr = flow->frags[i].data + flow->frags[i].hdr_len;
+		pkt->frags[i].len = flow->frags[i].len;
+		pkt->len += flow->frags[i].len;
+	}
+
+	ip_reass_flow_free(reass, flow, 0);
+	reass->stats.reassembled++;
+}
+
+int mv_ip_reass_process(struct mv_ip_reass *reass, void *cookie, u8 *data, u16 len, u8 l3_offset,
+			u64 now_ms, struct mv_ip_reass_pkt *pkt)
+{
+	struct ip_reass_key key;
+	struct ip_reass_frag frag, *prev, *next;
+	struct ip_reass_flow *flow;
+	u16 fh_offset = 0, nh_offset = 0, pos;
+	int more = 0, ret;
+	u32 end;
+
+	if (unlikely(reass->dr_cnt + MV_IP_REASS_MAX_FRAGS + 1 > reass->params.death_row_size))
+		return -ENOBUFS;
+
+	ret = ip_reass_parse(data, len, l3_offset, &key, &frag, &more, &fh_offset, &nh_offset);
+	if (unlikely(ret < 0)) {
+		reass->stats.errors++;
+		return ret;
+	}
+	if (!ret) {
+		pkt->num_frags = 1;
+		pkt->frags[0].cookie = cookie;
+		pkt->frags[0].vaddr = data;
+		pkt->frags[0].len = frag.hdr_len + frag.len;
+		pkt->len = pkt->frags[0].len;
+		return 1;
+	}
+	frag.cookie = cookie;
+	reass->stats.frags++;
+
+	ip_reass_expire(reass, now_ms, MV_IP_REASS_MAX_FRAGS + 1);
+
+	flow = ip_reass_flow_get(reass, &key, now_ms);
+	if (unlikely(!flow)) {
+		reass->stats.no_flow++;
+		ip_reass_death_row_add(reass, cookie);
+		return 0;
+	}
+
+	end = (u32)frag.offs + frag.len;
+	if (!more) {
+		/* last fragment: the datagram length becomes known */
+		if ((flow->total_len && flow->total_len != end) ||
+		    (flow->num_frags && flow->frags[flow->num_frags - 1].offs +
+					flow->frags[flow->num_frags - 1].len > end)) {
+			reass->stats.errors++;
+			goto drop_flow;
+		}
+		flow->total_len = end;
+	} else if (flow->total_len && end > flow->total_len) {
+		reass->stats.errors++;
+		goto drop_flow;
+	}
+
+	/* the headers plus the payload must fit the 16-bit length field of the datagram */
+	if (flow->total_len && (!frag.offs || (flow->num_frags && !flow->frags[0].offs))) {
+		u16 len_hdr = !frag.offs ? ip_reass_len_hdr(key.ver, &frag, l3_offset) :
+					   ip_reass_len_hdr(key.ver, &flow->frags[0], flow->l3_offset);
+
+		if ((u32)len_hdr + flow->total_len > IP_FRAG_MAX_DGRAM_LEN) {
+			reass->stats.errors++;
+			goto drop_flow;
+		}
+	}
+
+	/* find the insertion point; fragments are kept sorted by offset */
+	for (pos = 0; pos < flow->num_frags && flow->frags[pos].offs < frag.offs; pos++)
+		;
+	next = (pos < flow->num_frags) ? &flow->frags[pos] : NULL;
+	prev = pos ? &flow->frags[pos - 1] : NULL;
+
+	if (next && next->offs == frag.offs && next->len == frag.len) {
+		reass->stats.duplicates++;
+		ip_reass_death_row_add(reass, cookie);
+		return 0;
+	}
+	if ((prev && (u32)prev->offs + prev->len > frag.offs) || (next && end > next->offs)) {
+		reass->stats.overlaps++;
+		goto drop_flow;
+	}
+	if (flow->num_frags == MV_IP_REASS_MAX_FRAGS) {
+		reass->stats.errors++;
+		goto drop_flow;
+	}
+
+	memmove(&flow->frags[pos + 1], &flow->frags[pos], (flow->num_frags - pos) * sizeof(frag));
+	flow->frags[pos] = frag;
+	flow->num_frags++;
+	flow->rcv_len += frag.len;
+	if (!frag.offs) {
+		flow->l3_offset = l3_offset;
+		flow->fh_offset = fh_offset;
+		flow->nh_offset = nh_offset;
+	}
+
+	/* fragments never overlap, so the byte count proves full coverage */
+	if (flow->total_len && flow->rcv_len == flow->total_len) {
+		ip_reass_complete(reass, flow, pkt);
+		return 1;
+	}
+	return 0;
+
+drop_flow:
+	ip_reass_flow_free(reass, flow, 1);
+	ip_reass_death_row_add(reass, cookie);
+	return 0;
+}
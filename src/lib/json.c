@@ -0,0 +1,594 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include "std_internal.h"
+
+#include "lib/mv_json.h"
+
+struct json_parser {
+	struct mv_json	*json;
+	const char	*buf;
+	u32		 len;
+	u32		 pos;
+	u32		 depth;
+};
+
+static int json_error(struct json_parser *p, const char *msg)
+{
+	struct mv_json	*json = p->json;
+	u32		 i;
+
+	json->err_msg = msg;
+	json->err_line = 1;
+	json->err_col = 1;
+	for (i = 0; i < p->pos && i < p->len; i++) {
+		if (p->buf[i] == '\n') {
+			json->err_line++;
+			json->err_col = 1;
+		} else {
+			json->err_col++;
+		}
+	}
+	return -EINVAL;
+}
+
+static inline int json_end(struct json_parser *p)
+{
+	return p->pos >= p->len || !p->buf[p->pos];
+}
+
+static inline void json_skip_ws(struct json_parser *p)
+{
+	while (!json_end(p) &&
+	       (p->buf[p->pos] == ' ' || p->buf[p->pos] == '\t' ||
+		p->buf[p->pos] == '\n' || p->buf[p->pos] == '\r'))
+		p->pos++;
+}
+
+static inline int json_is_primitive_char(char c)
+{
+	return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+	       c == '+' || c == '-' || c == '.' || c == '_';
+}
+
+/* Returns the index of a new token, or <0 if the token array is full */
+static int json_tok_alloc(struct json_parser *p, enum mv_json_type type, u32 start)
+{
+	struct mv_json		*json = p->json;
+	struct mv_json_tok	*tok;
+
+	if (!json->toks)
+		return json->num_toks++;
+	if (json->num_toks == json->max_toks)
+		return -ENOMEM;
+
+	tok = &json->toks[json->num_toks];
+	tok->type = type;
+	tok->start = start;
+	tok->len = 0;
+	tok->size = 0;
+	tok->skip = json->num_toks + 1;
+	return json->num_toks++;
+}
+
+static void json_tok_close(struct json_parser *p, int idx, u32 end)
+{
+	struct mv_json_tok *tok;
+
+	if (!p->json->toks)
+		return;
+	tok = &p->json->toks[idx];
+	tok->len = end - tok->start;
+	tok->skip = p->json->num_toks;
+}
+
+static int json_parse_string(struct json_parser *p)
+{
+	u32	start = ++p->pos;
+	int	idx;
+
+	while (!json_end(p) && p->buf[p->pos] != '"') {
+		if ((unsigned char)p->buf[p->pos] < ' ')
+			return json_error(p, "control character in string");
+		if (p->buf[p->pos] == '\\') {
+			p->pos++;
+			if (json_end(p))
+				break;
+		}
+		p->pos++;
+	}
+	if (json_end(p))
+		return json_error(p, "unterminated string");
+
+	idx = json_tok_alloc(p, MV_JSON_T_STRING, start);
+	if (idx < 0)
+		return idx;
+	json_tok_close(p, idx, p->pos);
+	p->pos++;
+	return 0;
+}
+
+static int json_parse_primitive(struct json_parser *p)
+{
+	u32	start = p->pos;
+	int	idx;
+
+	while (!json_end(p) && json_is_primitive_char(p->buf[p->pos]))
+		p->pos++;
+	if (p->pos == start)
+		return json_error(p, "unexpected character");
+
+	idx = json_tok_alloc(p, MV_JSON_T_PRIMITIVE, start);
+	if (idx < 0)
+		return idx;
+	json_tok_close(p, idx, p->pos);
+	return 0;
+}
+
+static int json_parse_value(struct json_parser *p);
+
+/*
+ * Parse the members/elements of an object/array up to 'close'. With 'close'
+ * set to 0 (the implicit root object of a fragment), parsing ends at the end
+ * of the buffer or at an unmatched closing bracket.
+ */
+static int json_parse_members(struct json_parser *p, int idx, enum mv_json_type type, char close)
+{
+	u32	size = 0;
+	int	rc;
+
+	while (1) {
+		json_skip_ws(p);
+		if (json_end(p)) {
+			if (close)
+				return json_error(p, type == MV_JSON_T_OBJECT ?
+						  "unterminated object" : "unterminated array");
+			break;
+		}
+		if (p->buf[p->pos] == close)
+			break;
+		if (!close && (p->buf[p->pos] == '}' || p->buf[p->pos] == ']'))
+			break;
+
+		if (type == MV_JSON_T_OBJECT) {
+			if (p->buf[p->pos] != '"')
+				return json_error(p, "expected a key");
+			rc = json_parse_string(p);
+			if (rc)
+				return rc;
+			if (p->json->toks)
+				p->json->toks[p->json->num_toks - 1].size = 1;
+			json_skip_ws(p);
+			if (json_end(p) || p->buf[p->pos] != ':')
+				return json_error(p, "expected ':'");
+			p->pos++;
+		}
+		rc = json_parse_value(p);
+		if (rc)
+			return rc;
+		size++;
+
+		/* the separator is optional, a trailing one is allowed */
+		json_skip_ws(p);
+		if (!json_end(p) && p->buf[p->pos] == ',')
+			p->pos++;
+	}
+
+	if (p->json->toks)
+		p->json->toks[idx].size = size;
+	return 0;
+}
+
+static int json_parse_container(struct json_parser *p, enum mv_json_type type, char close)
+{
+	int	idx, rc;
+	u32	start = p->pos;
+
+	if (++p->depth > MV_JSON_MAX_DEPTH)
+		return json_error(p, "nesting too deep");
+
+	idx = json_tok_alloc(p, type, start);
+	if (idx < 0)
+		return idx;
+	p->pos++;
+	rc = json_parse_members(p, idx, type, close);
+	if (rc)
+		return rc;
+	p->pos++;
+	json_tok_close(p, idx, p->pos);
+	p->depth--;
+	return 0;
+}
+
+static int json_parse_value(struct json_parser *p)
+{
+	json_skip_ws(p);
+	if (json_end(p))
+		return json_error(p, "expected a value");
+
+	switch (p->buf[p->pos]) {
+	case '{':
+		return json_parse_container(p, MV_JSON_T_OBJECT, '}');
+	case '[':
+		return json_parse_container(p, MV_JSON_T_ARRAY, ']');
+	case '"':
+		return json_parse_string(p);
+	default:
+		return json_parse_primitive(p);
+	}
+}
+
+int mv_json_parse(struct mv_json *json, const char *buf, u32 len, struct mv_json_tok *toks, u32 max_toks)
+{
+	struct json_parser	p;
+	int			idx, rc;
+
+	memset(json, 0, sizeof(*json));
+	json->buf = buf;
+	json->len = len;
+	json->toks = toks;
+	json->max_toks = max_toks;
+
+	memset(&p, 0, sizeof(p));
+	p.json = json;
+	p.buf = buf;
+	p.len = len;
+
+	json_skip_ws(&p);
+	if (!json_end(&p) && (buf[p.pos] == '{' || buf[p.pos] == '[')) {
+		rc = json_parse_value(&p);
+		if (rc)
+			return rc;
+		json_skip_ws(&p);
+		if (!json_end(&p))
+			return json_error(&p, "unexpected data after the root value");
+	} else {
+		/* fragment: the members form an implicit root object. A fragment is
+		 * usually cut out of a larger document, so whatever precedes the
+		 * first key (the tail of the previous section) is skipped.
+		 */
+		while (!json_end(&p) && buf[p.pos] != '"')
+			p.pos++;
+		idx = json_tok_alloc(&p, MV_JSON_T_OBJECT, p.pos);
+		if (idx < 0)
+			return idx;
+		rc = json_parse_members(&p, idx, MV_JSON_T_OBJECT, 0);
+		if (rc)
+			return rc;
+		json_tok_close(&p, idx, p.pos);
+	}
+	json->len = p.pos;
+	return 0;
+}
+
+int mv_json_init(struct mv_json *json, const char *buf)
+{
+	struct mv_json_tok	*toks;
+	u32			 len = strlen(buf);
+	int			 rc;
+
+	/* count the tokens first, so the array is allocated once */
+	rc = mv_json_parse(json, buf, len, NULL, 0);
+	if (!rc) {
+		toks = kcalloc(1, json->num_toks * sizeof(struct mv_json_tok), GFP_KERNEL);
+		if (!toks)
+			return -ENOMEM;
+		rc = mv_json_parse(json, buf, len, toks, json->num_toks);
+		if (rc) {
+			kfree(toks);
+			json->toks = NULL;
+			return rc;
+		}
+		json->alloced = 1;
+		return 0;
+	}
+	pr_err("JSON: %s at line %u, col %u\n", json->err_msg, json->err_line, json->err_col);
+	return rc;
+}
+
+void mv_json_deinit(struct mv_json *json)
+{
+	if (json->alloced)
+		kfree(json->toks);
+	json->toks = NULL;
+	json->num_toks = 0;
+	json->alloced = 0;
+}
+
+static inline int json_tok_eq(const struct mv_json *json, int tok, const char *str)
+{
+	const struct mv_json_tok *t = &json->toks[tok];
+
+	return t->type == MV_JSON_T_STRING && strlen(str) == t->len &&
+	       !strncmp(&json->buf[t->start], str, t->len);
+}
+
+static inline int json_valid_tok(const struct mv_json *json, int tok)
+{
+	return json->toks && tok >= 0 && (u32)tok < json->num_toks;
+}
+
+int mv_json_find_next(const struct mv_json *json, int obj, const char *key, int prev)
+{
+	u32 i, end;
+
+	if (!json_valid_tok(json, obj) || json->toks[obj].type != MV_JSON_T_OBJECT)
+		return -EINVAL;
+
+	end = json->toks[obj].skip;
+	i = obj + 1;
+	if (prev > obj && (u32)prev < end)
+		i = json->toks[prev].skip;
+	while (i + 1 < end) {
+		/* 'i' is a key, 'i + 1' its value */
+		if (json_tok_eq(json, i, key))
+			return i + 1;
+		i = json->toks[i + 1].skip;
+	}
+	return -ENOENT;
+}
+
+int mv_json_find(const struct mv_json *json, int obj, const char *key)
+{
+	return mv_json_find_next(json, obj, key, -1);
+}
+
+int mv_json_lookup_next(const struct mv_json *json, int tok, const char *key, int prev)
+{
+	u32 i, end;
+
+	if (!json_valid_tok(json, tok))
+		return -ENOENT;
+
+	/* keys are the string tokens with a value (size 1) */
+	end = json->toks[tok].skip;
+	i = tok + 1;
+	if (prev > tok && (u32)prev < end)
+		i = json->toks[prev].skip;
+	for (; i + 1 < end; i++)
+		if (json->toks[i].size == 1 && json->toks[i].type == MV_JSON_T_STRING && json_tok_eq(json, i, key))
+			return i + 1;
+	return -ENOENT;
+}
+
+int mv_json_lookup(const struct mv_json *json, int tok, const char *key)
+{
+	return mv_json_lookup_next(json, tok, key, -1);
+}
+
+int mv_json_get_u64(const struct mv_json *json, int tok, u64 *val)
+{
+	const struct mv_json_tok	*t;
+	const char			*s;
+	u64				 v = 0;
+	u32				 i = 0, base = 10, digit;
+
+	if (!json_valid_tok(json, tok))
+		return -EINVAL;
+	t = &json->toks[tok];
+	if (t->type != MV_JSON_T_PRIMITIVE || !t->len)
+		return -EINVAL;
+	s = &json->buf[t->start];
+
+	if (t->len == 4 && !strncmp(s, "true", 4)) {
+		*val = 1;
+		return 0;
+	}
+	if (t->len == 5 && !strncmp(s, "false", 5)) {
+		*val = 0;
+		return 0;
+	}
+
+	if (t->len > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+		base = 16;
+		i = 2;
+	}
+	for (; i < t->len; i++) {
+		if (s[i] >= '0' && s[i] <= '9')
+			digit = s[i] - '0';
+		else if (base == 16 && s[i] >= 'a' && s[i] <= 'f')
+			digit = s[i] - 'a' + 10;
+		else if (base == 16 && s[i] >= 'A' && s[i] <= 'F')
+			digit = s[i] - 'A' + 10;
+		else
+			return -EINVAL;
+		if (v > (~0ULL - digit) / base)
+			return -ERANGE;
+		v = v * base + digit;
+	}
+	*val = v;
+	return 0;
+}
+
+int mv_json_get_str(const struct mv_json *json, int tok, char *str, u32 size)
+{
+	const struct mv_json_tok *t;
+
+	if (!json_valid_tok(json, tok))
+		return -EINVAL;
+	t = &json->toks[tok];
+	if (t->type != MV_JSON_T_STRING)
+		return -EINVAL;
+	if (t->len >= size)
+		return -ENOSPC;
+	memcpy(str, &json->buf[t->start], t->len);
+	str[t->len] = 0;
+	return 0;
+}
+
+static inline int json_hex_digit(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+int mv_json_get_mac(const struct mv_json *json, int tok, u8 mac[6])
+{
+	const struct mv_json_tok	*t;
+	const char			*s;
+	u8				 tmp[6];
+	int				 i, hi, lo;
+
+	if (!json_valid_tok(json, tok))
+		return -EINVAL;
+	t = &json->toks[tok];
+	if (t->type != MV_JSON_T_STRING || t->len != 17)
+		return -EINVAL;
+	s = &json->buf[t->start];
+
+	for (i = 0; i < 6; i++) {
+		hi = json_hex_digit(s[i * 3]);
+		lo = json_hex_digit(s[i * 3 + 1]);
+		if (hi < 0 || lo < 0 || (i < 5 && s[i * 3 + 2] != ':'))
+			return -EINVAL;
+		tmp[i] = (hi << 4) | lo;
+	}
+	memcpy(mac, tmp, sizeof(tmp));
+	return 0;
+}
+
+static void json_report(const struct mv_json *json, int tok, const char *key, int rc)
+{
+	u32 i, line = 1;
+
+	for (i = 0; i < json->toks[tok].start; i++)
+		if (json->buf[i] == '\n')
+			line++;
+	pr_err("JSON '%s' (line %u): %s\n", key, line,
+	       rc == -ERANGE ? "value out of range" :
+	       rc == -ENOSPC ? "string too long" : "invalid value");
+}
+
+int mv_json_obj_get_u64(const struct mv_json *json, int obj, const char *key, u64 *val)
+{
+	int tok = mv_json_find(json, obj, key), rc;
+
+	if (tok < 0)
+		return tok;
+	rc = mv_json_get_u64(json, tok, val);
+	if (rc)
+		json_report(json, tok, key, rc);
+	return rc;
+}
+
+int mv_json_obj_get_str(const struct mv_json *json, int obj, const char *key, char *str, u32 size)
+{
+	int tok = mv_json_find(json, obj, key), rc;
+
+	if (tok < 0)
+		return tok;
+	rc = mv_json_get_str(json, tok, str, size);
+	if (rc)
+		json_report(json, tok, key, rc);
+	return rc;
+}
+
+int mv_json_obj_get_mac(const struct mv_json *json, int obj, const char *key, u8 mac[6])
+{
+	int tok = mv_json_find(json, obj, key), rc;
+
+	if (tok < 0)
+		return tok;
+	rc = mv_json_get_mac(json, tok, mac);
+	if (rc)
+		json_report(json, tok, key, rc);
+	return rc;
+}
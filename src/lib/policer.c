@@ -0,0 +1,249 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include "std_internal.h"
+
+#include "lib/mv_policer.h"
+
+/* the buckets count tokens in units of 1/PLCR_SCALE, so that the refill of
+ * 'rate' tokens/sec over 'dt' nsec is exactly rate * dt
+ */
+#define PLCR_SCALE	1000000000ULL
+
+struct mv_plcr {
+	struct mv_plcr_params	params;
+	u64			tc;		/* committed bucket */
+	u64			te;		/* excess (srTCM) / peak (trTCM) bucket */
+	u64			cbs;		/* scaled bucket sizes */
+	u64			ebs;
+	u64			fill_c_ns;	/* time to fill the buckets from empty */
+	u64			fill_e_ns;
+	u64			last_ns;
+	struct mv_plcr_stats	stats;
+};
+
+static inline u64 plcr_credit(u64 bucket, u64 size, u64 rate, u64 dt, u64 fill_ns)
+{
+	if (dt >= fill_ns)
+		return size;
+	bucket += rate * dt;
+	return min(bucket, size);
+}
+
+static void plcr_refill(struct mv_plcr *plcr, u64 now_ns)
+{
+	struct mv_plcr_params	*params = &plcr->params;
+	u64			 dt;
+
+	if (now_ns <= plcr->last_ns)
+		return;
+	if (params->update_period_ns)
+		dt = (now_ns / params->update_period_ns - plcr->last_ns / params->update_period_ns) *
+		     params->update_period_ns;
+	else
+		dt = now_ns - plcr->last_ns;
+	plcr->last_ns = now_ns;
+	if (!dt)
+		return;
+
+	if (params->mode == MV_PLCR_MODE_TRTCM) {
+		plcr->tc = plcr_credit(plcr->tc, plcr->cbs, params->cir, dt, plcr->fill_c_ns);
+		plcr->te = plcr_credit(plcr->te, plcr->ebs, params->pir, dt, plcr->fill_e_ns);
+		return;
+	}
+
+	/* srTCM: the committed bucket overflows into the excess one */
+	if (dt >= plcr->fill_e_ns) {
+		plcr->tc = plcr->cbs;
+		plcr->te = plcr->ebs;
+		return;
+	}
+	plcr->tc += params->cir * dt;
+	if (plcr->tc > plcr->cbs) {
+		plcr->te = min(plcr->te + plcr->tc - plcr->cbs, plcr->ebs);
+		plcr->tc = plcr->cbs;
+	}
+}
+
+int mv_plcr_create(struct mv_plcr_params *params, u64 now_ns, struct mv_plcr **plcr)
+{
+	struct mv_plcr *p;
+
+	if (!params->cir || (params->mode == MV_PLCR_MODE_TRTCM && params->pir < params->cir)) {
+		pr_err("[%s] invalid rates (cir %llu, pir %llu)\n", __func__,
+		       (unsigned long long)params->cir, (unsigned long long)params->pir);
+		return -EINVAL;
+	}
+	if (params->mode != MV_PLCR_MODE_SRTCM && params->mode != MV_PLCR_MODE_TRTCM) {
+		pr_err("[%s] invalid mode %d\n", __func__, params->mode);
+		return -EINVAL;
+	}
+	if (!params->cbs) {
+		pr_err("[%s] committed bucket size must not be 0\n", __func__);
+		return -EINVAL;
+	}
+
+	p = kcalloc(1, sizeof(*p), GFP_KERNEL);
+	if (!p)
+		return -ENOMEM;
+
+	p->params = *params;
+	p->cbs = params->cbs * PLCR_SCALE;
+	p->ebs = params->ebs * PLCR_SCALE;
+	p->tc = p->cbs;
+	p->te = p->ebs;
+	if (params->mode == MV_PLCR_MODE_TRTCM) {
+		p->fill_c_ns = params->cbs * PLCR_SCALE / params->cir + 1;
+		p->fill_e_ns = params->ebs * PLCR_SCALE / params->pir + 1;
+	} else {
+		p->fill_c_ns = params->cbs * PLCR_SCALE / params->cir + 1;
+		p->fill_e_ns = ((u64)params->cbs + params->ebs) * PLCR_SCALE / params->cir + 1;
+	}
+	p->last_ns = now_ns;
+
+	*plcr = p;
+	return 0;
+}
+
+void mv_plcr_destroy(struct mv_plcr *plcr)
+{
+	kfree(plcr);
+}
+
+enum mv_plcr_color mv_plcr_meter(struct mv_plcr *plcr, u32 len, enum mv_plcr_color color, u64 now_ns)
+{
+	u64 tokens = len * PLCR_SCALE;
+
+	plcr_refill(plcr, now_ns);
+
+	if (!plcr->params.color_aware)
+		color = MV_PLCR_COLOR_GREEN;
+
+	if (color == MV_PLCR_COLOR_RED) {
+		/* pre-colored red is never promoted */
+	} else if (plcr->params.mode == MV_PLCR_MODE_TRTCM) {
+		if (plcr->te < tokens) {
+			color = MV_PLCR_COLOR_RED;
+		} else if (color == MV_PLCR_COLOR_YELLOW || plcr->tc < tokens) {
+			color = MV_PLCR_COLOR_YELLOW;
+			plcr->te -= tokens;
+		} else {
+			plcr->te -= tokens;
+			plcr->tc -= tokens;
+		}
+	} else {
+		if (color == MV_PLCR_COLOR_GREEN && plcr->tc >= tokens) {
+			plcr->tc -= tokens;
+		} else if (plcr->te >= tokens) {
+			color = MV_PLCR_COLOR_YELLOW;
+			plcr->te -= tokens;
+		} else {
+			color = MV_PLCR_COLOR_RED;
+		}
+	}
+
+	plcr->stats.pkts[color]++;
+	plcr->stats.tokens[color] += len;
+	return color;
+}
+
+void mv_plcr_get_stats(struct mv_plcr *plcr, struct mv_plcr_stats *stats, int reset)
+{
+	if (stats)
+		*stats = plcr->stats;
+	if (reset)
+		memset(&plcr->stats, 0, sizeof(plcr->stats));
+}
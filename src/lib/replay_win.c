@@ -0,0 +1,249 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include "std_internal.h"
+
+#include "lib/mv_replay_win.h"
+
+#define REPLAY_WIN_BIT(seq)	(1ULL << ((seq) & 63))
+
+/* The bitmap is twice the window size so that whole words can be cleared when
+ * the window slides without losing bits that are still inside the window.
+ */
+struct mv_replay_win {
+	u64				 top;
+	u32				 size;
+	u32				 word_mask;
+	int				 esn;
+	struct mv_replay_win_stats	 stats;
+	u64				 bmap[];
+};
+
+int mv_replay_win_create(u32 size, u64 seq, int esn, struct mv_replay_win **win)
+{
+	struct mv_replay_win *w;
+	u32 num_words;
+
+	if (size < MV_REPLAY_WIN_MIN_SIZE || size > MV_REPLAY_WIN_MAX_SIZE || (size & (size - 1))) {
+		pr_err("[%s] unsupported window size %u\n", __func__, size);
+		return -EINVAL;
+	}
+	if (!esn && seq > 0xffffffffULL) {
+		pr_err("[%s] sequence number 0x%llx needs ESN\n", __func__, (unsigned long long)seq);
+		return -EINVAL;
+	}
+
+	num_words = 2 * size / 64;
+	w = kcalloc(1, sizeof(*w) + num_words * sizeof(u64), GFP_KERNEL);
+	if (!w)
+		return -ENOMEM;
+
+	w->top = seq;
+	w->size = size;
+	w->word_mask = num_words - 1;
+	w->esn = esn;
+	*win = w;
+	return 0;
+}
+
+void mv_replay_win_destroy(struct mv_replay_win *win)
+{
+	kfree(win);
+}
+
+/* RFC 4303 appendix A2.2: infer the high 32 bits of an ESN */
+static inline u64 replay_win_seq_infer(struct mv_replay_win *win, u32 seq_lo)
+{
+	u32 tl = lower_32_bits(win->top);
+	u32 th = upper_32_bits(win->top);
+
+	if (!win->esn)
+		return seq_lo;
+
+	if (tl >= win->size - 1) {
+		/* window within one sequence number subspace */
+		if (seq_lo < tl - win->size + 1)
+			th++;
+	} else if (seq_lo >= tl - win->size + 1) {
+		/* window spans two subspaces and seq_lo is in the lower one */
+		if (!th)
+			return 0;
+		th--;
+	}
+	return ((u64)th << 32) | seq_lo;
+}
+
+static inline int replay_win_bit_test(struct mv_replay_win *win, u64 seq)
+{
+	return !!(win->bmap[(seq >> 6) & win->word_mask] & REPLAY_WIN_BIT(seq));
+}
+
+static inline int replay_win_verify(struct mv_replay_win *win, u64 seq)
+{
+	if (seq > win->top)
+		return 0;
+	if (unlikely(!seq || win->top - seq >= win->size)) {
+		win->stats.too_old++;
+		return -ERANGE;
+	}
+	if (replay_win_bit_test(win, seq)) {
+		win->stats.duplicates++;
+		return -EEXIST;
+	}
+	return 0;
+}
+
+int mv_replay_win_check(struct mv_replay_win *win, u32 seq_lo, u64 *seq)
+{
+	u64 full = replay_win_seq_infer(win, seq_lo);
+	int err;
+
+	err = replay_win_verify(win, full);
+	if (seq)
+		*seq = err ? 0 : full;
+	return err;
+}
+
+u16 mv_replay_win_check_burst(struct mv_replay_win *win, const u32 *seq_lo, u64 *seq, u16 num)
+{
+	u16 i, passed = 0;
+
+	for (i = 0; i < num; i++) {
+		seq[i] = replay_win_seq_infer(win, seq_lo[i]);
+		if (replay_win_verify(win, seq[i]))
+			seq[i] = 0;
+		else
+			passed++;
+	}
+	return passed;
+}
+
+int mv_replay_win_commit(struct mv_replay_win *win, u64 seq)
+{
+	u64 blk, last_blk;
+	int err;
+
+	err = replay_win_verify(win, seq);
+	if (err)
+		return err;
+
+	if (seq > win->top) {
+		/* slide: clear the words of the blocks after the old top */
+		blk = win->top >> 6;
+		last_blk = seq >> 6;
+		if (last_blk - blk > win->word_mask)
+			memset(win->bmap, 0, (win->word_mask + 1) * sizeof(u64));
+		else
+			while (blk < last_blk)
+				win->bmap[++blk & win->word_mask] = 0;
+		win->top = seq;
+	}
+	win->bmap[(seq >> 6) & win->word_mask] |= REPLAY_WIN_BIT(seq);
+	win->stats.accepted++;
+	return 0;
+}
+
+u64 mv_replay_win_top(struct mv_replay_win *win)
+{
+	return win->top;
+}
+
+void mv_replay_win_get_stats(struct mv_replay_win *win, struct mv_replay_win_stats *stats, int reset)
+{
+	*stats = win->stats;
+	if (reset)
+		memset(&win->stats, 0, sizeof(win->stats));
+}
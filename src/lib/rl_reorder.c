@@ -0,0 +1,463 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include "std_internal.h"
+
+#include "lib/mv_rl_reorder.h"
+
+#define RL_REORDER_DEF_MAX_MOVES	4
+#define RL_REORDER_DEF_DECAY_SHIFT	3
+#define RL_REORDER_DEF_HYST_SHIFT	2
+#define RL_REORDER_MAX_SHIFT		32
+
+#define RL_REORDER_SLOT_FREE		0xffffffff
+/* Duplicate of a moved rule, left behind by a failed clear */
+#define RL_REORDER_SLOT_STALE		BIT(31)
+
+struct rl_reorder_rule {
+	u32	slot;		/* RL_REORDER_SLOT_FREE if the rule does not exist */
+	u32	prio;
+	u64	score;
+	u64	hits;		/* hits since the last maintenance call */
+};
+
+struct mv_rl_reorder {
+	struct mv_rl_reorder_params	 params;
+	u32				*slots;		/* rule of each slot */
+	u32				*order;		/* rules in slot order */
+	struct rl_reorder_rule		*rules;
+	struct mv_rl_reorder_stats	 stats;
+};
+
+static inline u32 rl_reorder_slot_rule(struct mv_rl_reorder *rr, u32 slot)
+{
+	return rr->slots[slot] & ~RL_REORDER_SLOT_STALE;
+}
+
+/* The slots a rule of priority 'prio' may use: [*lo, *hi] */
+static void rl_reorder_region(struct mv_rl_reorder *rr, u32 prio, int *lo, int *hi)
+{
+	u32 s, p;
+
+	*lo = 0;
+	*hi = rr->params.num_slots - 1;
+	for (s = 0; s < rr->params.num_slots; s++) {
+		if (rr->slots[s] == RL_REORDER_SLOT_FREE)
+			continue;
+		p = rr->rules[rl_reorder_slot_rule(rr, s)].prio;
+		if (p < prio)
+			*lo = s + 1;
+		else if (p > prio && (int)s <= *hi)
+			*hi = s - 1;
+	}
+}
+
+static int rl_reorder_move(struct mv_rl_reorder *rr, u32 rule, u32 to)
+{
+	u32 from = rr->rules[rule].slot;
+	int err;
+
+	err = rr->params.write(rr->params.arg, to, rule);
+	if (err) {
+		rr->stats.errors++;
+		return err;
+	}
+	rr->slots[to] = rule;
+	rr->rules[rule].slot = to;
+	rr->stats.moves++;
+
+	err = rr->params.clear(rr->params.arg, from);
+	if (err) {
+		/* Same rule in both slots: lookups are still correct, clear it later */
+		rr->slots[from] = rule | RL_REORDER_SLOT_STALE;
+		rr->stats.errors++;
+		return err;
+	}
+	rr->slots[from] = RL_REORDER_SLOT_FREE;
+	return 0;
+}
+
+int mv_rl_reorder_create(struct mv_rl_reorder_params *params, struct mv_rl_reorder **rr)
+{
+	struct mv_rl_reorder *r;
+	u32 i;
+
+	if (!params->num_slots || !params->max_rules || params->max_rules >= RL_REORDER_SLOT_STALE ||
+	    !params->write || !params->clear ||
+	    params->decay_shift >= RL_REORDER_MAX_SHIFT || params->hyst_shift >= RL_REORDER_MAX_SHIFT) {
+		pr_err("[%s] invalid parameters\n", __func__);
+		return -EINVAL;
+	}
+
+	r = kcalloc(1, sizeof(*r), GFP_KERNEL);
+	if (!r)
+		return -ENOMEM;
+	r->slots = kcalloc(params->num_slots, sizeof(*r->slots), GFP_KERNEL);
+	r->order = kcalloc(params->num_slots, sizeof(*r->order), GFP_KERNEL);
+	r->rules = kcalloc(params->max_rules, sizeof(*r->rules), GFP_KERNEL);
+	if (!r->slots || !r->order || !r->rules) {
+		mv_rl_reorder_destroy(r);
+		return -ENOMEM;
+	}
+
+	r->params = *params;
+	if (!r->params.max_moves)
+		r->params.max_moves = RL_REORDER_DEF_MAX_MOVES;
+	if (!r->params.decay_shift)
+		r->params.decay_shift = RL_REORDER_DEF_DECAY_SHIFT;
+	if (!r->params.hyst_shift)
+		r->params.hyst_shift = RL_REORDER_DEF_HYST_SHIFT;
+	for (i = 0; i < params->num_slots; i++)
+		r->slots[i] = RL_REORDER_SLOT_FREE;
+	for (i = 0; i < params->max_rules; i++)
+		r->rules[i].slot = RL_REORDER_SLOT_FREE;
+
+	*rr = r;
+	return 0;
+}
+
+void mv_rl_reorder_destroy(struct mv_rl_reorder *rr)
+{
+	kfree(rr->rules);
+	kfree(rr->order);
+	kfree(rr->slots);
+	kfree(rr);
+}
+
+void mv_rl_reorder_hit(struct mv_rl_reorder *rr, u32 rule, u32 hits)
+{
+	if (rule < rr->params.max_rules)
+		rr->rules[rule].hits += hits;
+}
+
+/* Whether rule 'a' should be checked before rule 'b' */
+static inline int rl_reorder_hotter(struct mv_rl_reorder *rr, u32 a, u32 b)
+{
+	u64 sb = rr->rules[b].score;
+
+	return rr->rules[a].score > sb + (sb >> rr->params.hyst_shift);
+}
+
+/*
+ * Bring a free slot to 'hi' + 1: the nearest free slot after it is filled by
+ * the first rule of the priority just before it, which frees a slot one
+ * priority closer, and so on.
+ *
+ * Returns the number of moves, -ENOSPC if there is no free slot to bring,
+ * -EBUSY if the moves are over the budget.
+ */
+static int rl_reorder_pull_free(struct mv_rl_reorder *rr, int hi, u32 budget)
+{
+	int f, s, moves = 0;
+	u32 prio;
+	int err;
+
+	for (f = hi + 1; f < (int)rr->params.num_slots; f++) {
+		if (rr->slots[f] == RL_REORDER_SLOT_FREE)
+			break;
+		if (rr->slots[f] & RL_REORDER_SLOT_STALE)
+			return -ENOSPC;
+	}
+	if (f == (int)rr->params.num_slots)
+		return -ENOSPC;
+
+	while (f > hi + 1) {
+		if (!budget--)
+			return moves ? moves : -EBUSY;
+		prio = rr->rules[rr->slots[f - 1]].prio;
+		for (s = f - 1; s > hi + 1; s--)
+			if (rr->rules[rr->slots[s - 1]].prio != prio)
+				break;
+		err = rl_reorder_move(rr, rr->slots[s], f);
+		if (err)
+			return err;
+		moves++;
+		f = s;
+	}
+	return moves;
+}
+
+int mv_rl_reorder_add(struct mv_rl_reorder *rr, u32 rule, u32 prio)
+{
+	int lo, hi, s, last = -1;
+	int err;
+
+	if (rule >= rr->params.max_rules || rr->rules[rule].slot != RL_REORDER_SLOT_FREE) {
+		pr_err("[%s] invalid or existing rule %u\n", __func__, rule);
+		return -EINVAL;
+	}
+
+	rl_reorder_region(rr, prio, &lo, &hi);
+	/* The first free slot after the rules of the same priority, else any free slot */
+	for (s = lo; s <= hi; s++)
+		if (rr->slots[s] != RL_REORDER_SLOT_FREE && rr->rules[rl_reorder_slot_rule(rr, s)].prio == prio)
+			last = s;
+	for (s = last + 1; s <= hi; s++)
+		if (s >= lo && rr->slots[s] == RL_REORDER_SLOT_FREE)
+			break;
+	if (s > hi)
+		for (s = lo; s <= hi; s++)
+			if (rr->slots[s] == RL_REORDER_SLOT_FREE)
+				break;
+	if (s > hi) {
+		/* Make room by moving the lower priorities */
+		err = rl_reorder_pull_free(rr, hi, ~0);
+		if (err < 0)
+			return err;
+		s = hi + 1;
+	}
+
+	err = rr->params.write(rr->params.arg, s, rule);
+	if (err) {
+		rr->stats.errors++;
+		return err;
+	}
+	rr->slots[s] = rule;
+	rr->rules[rule].slot = s;
+	rr->rules[rule].prio = prio;
+	rr->rules[rule].score = 0;
+	rr->rules[rule].hits = 0;
+	return 0;
+}
+
+int mv_rl_reorder_remove(struct mv_rl_reorder *rr, u32 rule)
+{
+	u32 slot;
+	int err;
+
+	if (rule >= rr->params.max_rules || rr->rules[rule].slot == RL_REORDER_SLOT_FREE)
+		return -EINVAL;
+
+	slot = rr->rules[rule].slot;
+	err = rr->params.clear(rr->params.arg, slot);
+	if (err) {
+		rr->stats.errors++;
+		return err;
+	}
+	rr->slots[slot] = RL_REORDER_SLOT_FREE;
+	rr->rules[rule].slot = RL_REORDER_SLOT_FREE;
+	return 0;
+}
+
+/*
+ * Make one step towards having the hottest rule of positions [k, end) of the
+ * order at position 'k' ([first, end) are the positions of its priority).
+ *
+ * Returns the number of moves, 0 if the position is in order, -ENOSPC if
+ * there is no free slot, -EBUSY if the moves are over the budget.
+ */
+static int rl_reorder_position(struct mv_rl_reorder *rr, u32 first, u32 k, u32 end, u32 budget)
+{
+	u32 best = k, x = rr->order[k], t, i;
+	int lo, hi, s, f;
+	int err;
+
+	for (i = k + 1; i < end; i++)
+		if (rr->rules[rr->order[i]].score > rr->rules[rr->order[best]].score)
+			best = i;
+	t = rr->order[best];
+	if (best == k || !rl_reorder_hotter(rr, t, x))
+		return 0;
+	if (!budget)
+		return -EBUSY;
+
+	rl_reorder_region(rr, rr->rules[x].prio, &lo, &hi);
+	s = rr->rules[x].slot;
+
+	/* A free slot between the previous rule and 'x': move 't' there */
+	f = (k > first) ? (int)rr->rules[rr->order[k - 1]].slot + 1 : lo;
+	for (; f < s; f++)
+		if (rr->slots[f] == RL_REORDER_SLOT_FREE)
+			break;
+	if (f < s) {
+		err = rl_reorder_move(rr, t, f);
+		return err ? err : 1;
+	}
+
+	/* Else move 'x' to a free slot after it; 't' takes its slot on the next step */
+	for (f = s + 1; f <= hi; f++)
+		if (rr->slots[f] == RL_REORDER_SLOT_FREE)
+			break;
+	if (f > hi)
+		return rl_reorder_pull_free(rr, hi, budget);
+	err = rl_reorder_move(rr, x, f);
+	return err ? err : 1;
+}
+
+static u32 rl_reorder_build_order(struct mv_rl_reorder *rr)
+{
+	u32 i, n = 0;
+
+	for (i = 0; i < rr->params.num_slots; i++)
+		if (rr->slots[i] != RL_REORDER_SLOT_FREE && !(rr->slots[i] & RL_REORDER_SLOT_STALE))
+			rr->order[n++] = rr->slots[i];
+	return n;
+}
+
+int mv_rl_reorder_run(struct mv_rl_reorder *rr)
+{
+	struct rl_reorder_rule *r;
+	u32 i, n, k, first, end, moves = 0;
+	int ret;
+
+	rr->stats.runs++;
+
+	/* Retry the clears that failed */
+	for (i = 0; i < rr->params.num_slots; i++) {
+		if (rr->slots[i] == RL_REORDER_SLOT_FREE || !(rr->slots[i] & RL_REORDER_SLOT_STALE))
+			continue;
+		if (rr->params.clear(rr->params.arg, i))
+			rr->stats.errors++;
+		else
+			rr->slots[i] = RL_REORDER_SLOT_FREE;
+	}
+
+	for (i = 0; i < rr->params.max_rules; i++) {
+		r = &rr->rules[i];
+		if (r->slot == RL_REORDER_SLOT_FREE)
+			continue;
+		r->score -= r->score >> rr->params.decay_shift;
+		r->score += r->hits;
+		r->hits = 0;
+	}
+
+	/*
+	 * The rules of a priority are contiguous in the order, and stay at the
+	 * same positions of the order when they are moved within their range.
+	 */
+	n = rl_reorder_build_order(rr);
+	for (first = 0; first < n; first = end) {
+		for (end = first + 1; end < n; end++)
+			if (rr->rules[rr->order[end]].prio != rr->rules[rr->order[first]].prio)
+				break;
+
+		k = first;
+		while (k + 1 < end) {
+			ret = rl_reorder_position(rr, first, k, end, rr->params.max_moves - moves);
+			if (ret == -ENOSPC) {
+				rr->stats.blocked++;
+				break;
+			}
+			if (ret == -EBUSY)
+				return moves;
+			if (ret < 0)
+				return ret;
+			if (!ret) {
+				k++;
+				continue;
+			}
+			/* Check the same position again */
+			moves += ret;
+			rl_reorder_build_order(rr);
+		}
+	}
+
+	return moves;
+}
+
+int mv_rl_reorder_get_slot(struct mv_rl_reorder *rr, u32 rule)
+{
+	if (rule >= rr->params.max_rules || rr->rules[rule].slot == RL_REORDER_SLOT_FREE)
+		return -ENOENT;
+	return rr->rules[rule].slot;
+}
+
+void mv_rl_reorder_get_stats(struct mv_rl_reorder *rr, struct mv_rl_reorder_stats *stats, int reset)
+{
+	*stats = rr->stats;
+	if (reset)
+		memset(&rr->stats, 0, sizeof(rr->stats));
+}
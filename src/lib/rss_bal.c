@@ -0,0 +1,410 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include "std_internal.h"
+
+#include "lib/mv_rss_bal.h"
+
+#define RSS_BAL_NSEC_PER_USEC		1000ULL
+#define RSS_BAL_USEC_PER_SEC		1000000ULL
+
+#define RSS_BAL_DEF_IMBALANCE_PCT	20
+#define RSS_BAL_DEF_MIN_GAIN_PCT	5
+#define RSS_BAL_DEF_MAX_MOVES		2
+#define RSS_BAL_DEF_MIN_INTERVAL_USECS	100000
+#define RSS_BAL_DEF_HOLD_USECS		1000000
+#define RSS_BAL_DEF_EWMA_SHIFT		2
+/* estimates drift toward the even share by 1/2^shift per update */
+#define RSS_BAL_EST_DECAY_SHIFT		6
+
+/* A move of the last update, measured on the next one */
+struct rss_bal_move {
+	u32	bucket;
+	u32	from;
+	u32	to;
+	u64	from_rate;	/* rates of the queues before the move */
+	u64	to_rate;
+};
+
+struct mv_rss_bal {
+	struct mv_rss_bal_params params;
+	u8			map[MV_RSS_BAL_MAX_BUCKETS];
+	u64			est[MV_RSS_BAL_MAX_BUCKETS];	/* bucket rate estimates (pps) */
+	u64			hold_ns[MV_RSS_BAL_MAX_BUCKETS];	/* no move before this time */
+	u64			bucket_cnt[MV_RSS_BAL_MAX_BUCKETS];
+	u64			queue_cnt[MV_RSS_BAL_MAX_QUEUES];
+	u64			rate[MV_RSS_BAL_MAX_QUEUES];	/* last sampled rate (pps) */
+	u64			load[MV_RSS_BAL_MAX_QUEUES];	/* EWMA of the rate (pps) */
+	u64			last_ns;
+	u64			rebal_ns;
+	int			sampled;	/* counters were read once */
+	int			loaded;		/* rates were computed once */
+	u32			num_pending;
+	struct rss_bal_move	pending[MV_RSS_BAL_MAX_QUEUES / 2];
+	struct mv_rss_bal_stats	stats;
+};
+
+static inline u64 rss_bal_ewma(u64 avg, u64 val, u32 shift)
+{
+	if (val >= avg)
+		return avg + ((val - avg) >> shift);
+	return avg - ((avg - val) >> shift);
+}
+
+static inline u64 rss_bal_rate(u64 cnt, u64 usecs)
+{
+	return cnt * RSS_BAL_USEC_PER_SEC / usecs;
+}
+
+/* Measure the buckets moved by the last update and share the queue loads among the others */
+static void rss_bal_estimate(struct mv_rss_bal *bal)
+{
+	u8	fixed[MV_RSS_BAL_MAX_BUCKETS];
+	u64	sum_fixed, sum_free, remain;
+	u32	nfree, b, q, i;
+	s64	gain, loss;
+
+	memset(fixed, 0, bal->params.num_buckets);
+	for (i = 0; i < bal->num_pending; i++) {
+		struct rss_bal_move *m = &bal->pending[i];
+
+		gain = (s64)bal->rate[m->to] - (s64)m->to_rate;
+		loss = (s64)m->from_rate - (s64)bal->rate[m->from];
+		gain = (gain + loss) / 2;
+		if (gain < 0)
+			gain = 0;
+		bal->est[m->bucket] = min((u64)gain, bal->load[m->to]);
+		fixed[m->bucket] = 1;
+	}
+	bal->num_pending = 0;
+
+	for (q = 0; q < bal->params.num_queues; q++) {
+		sum_fixed = sum_free = 0;
+		nfree = 0;
+		for (b = 0; b < bal->params.num_buckets; b++) {
+			if (bal->map[b] != q)
+				continue;
+			if (fixed[b]) {
+				sum_fixed += bal->est[b];
+			} else {
+				sum_free += bal->est[b];
+				nfree++;
+			}
+		}
+		if (!nfree)
+			continue;
+		remain = (bal->load[q] > sum_fixed) ? bal->load[q] - sum_fixed : 0;
+		for (b = 0; b < bal->params.num_buckets; b++) {
+			if (bal->map[b] != q || fixed[b])
+				continue;
+			if (sum_free)
+				bal->est[b] = rss_bal_ewma(bal->est[b] * remain / sum_free, remain / nfree,
+							   RSS_BAL_EST_DECAY_SHIFT);
+			else
+				bal->est[b] = remain / nfree;
+		}
+	}
+}
+
+/* Pick the bucket of 'from' whose move to 'to' lowers the max load the most */
+static int rss_bal_pick(struct mv_rss_bal *bal, u32 from, u32 to, u64 now_ns, u64 *gain)
+{
+	u64	diff = bal->load[from] - bal->load[to];
+	u64	e, g, best_gain = 0;
+	int	b, best = -1;
+
+	for (b = 0; b < bal->params.num_buckets; b++) {
+		if (bal->map[b] != from || now_ns < bal->hold_ns[b])
+			continue;
+		e = bal->est[b];
+		/* the bucket must not make 'to' the new hottest queue */
+		if (!e || e >= diff)
+			continue;
+		g = min(e, diff - e);
+		if (g > best_gain) {
+			best_gain = g;
+			best = b;
+		}
+	}
+	*gain = best_gain;
+	return best;
+}
+
+static int rss_bal_rebalance(struct mv_rss_bal *bal, int estimate, u64 mean, u64 now_ns)
+{
+	struct mv_rss_bal_params	*params = &bal->params;
+	u8				 busy[MV_RSS_BAL_MAX_QUEUES];
+	u64				 gain;
+	u32				 q, hot, cool, moves = 0;
+	int				 b, rc = 0;
+
+	memset(busy, 0, params->num_queues);
+	while (moves < params->max_moves) {
+		hot = cool = params->num_queues;
+		for (q = 0; q < params->num_queues; q++) {
+			if (busy[q])
+				continue;
+			if (hot == params->num_queues || bal->load[q] > bal->load[hot])
+				hot = q;
+			if (cool == params->num_queues || bal->load[q] < bal->load[cool])
+				cool = q;
+		}
+		if (hot == cool || hot == params->num_queues)
+			break;
+		if (bal->load[hot] * 100 <= mean * (100 + params->imbalance_pct))
+			break;
+
+		b = rss_bal_pick(bal, hot, cool, now_ns, &gain);
+		if (b < 0 || gain * 100 < mean * params->min_gain_pct)
+			break;
+
+		rc = params->set_entry(params->arg, b, cool);
+		if (rc) {
+			pr_err("[%s] failed to move bucket %d to queue %u (%d)\n", __func__, b, cool, rc);
+			bal->stats.move_errs++;
+			break;
+		}
+		pr_debug("[%s] bucket %d: queue %u -> %u (%llu pps)\n", __func__, b, hot, cool,
+			 (unsigned long long)bal->est[b]);
+
+		if (estimate) {
+			struct rss_bal_move *m = &bal->pending[bal->num_pending++];
+
+			m->bucket = b;
+			m->from = hot;
+			m->to = cool;
+			m->from_rate = bal->rate[hot];
+			m->to_rate = bal->rate[cool];
+			/* one move per queue, so that it can be measured */
+			busy[hot] = busy[cool] = 1;
+		}
+		bal->map[b] = cool;
+		bal->load[hot] -= bal->est[b];
+		bal->load[cool] += bal->est[b];
+		bal->hold_ns[b] = now_ns + (u64)params->hold_usecs * RSS_BAL_NSEC_PER_USEC;
+		moves++;
+	}
+
+	if (moves) {
+		bal->stats.rebalances++;
+		bal->stats.moves += moves;
+		bal->rebal_ns = now_ns;
+	}
+	return moves ? (int)moves : rc;
+}
+
+int mv_rss_bal_create(struct mv_rss_bal_params *params, struct mv_rss_bal **bal)
+{
+	struct mv_rss_bal	*r;
+	u32			 b;
+
+	if (!params->set_entry) {
+		pr_err("[%s] set_entry callback is mandatory\n", __func__);
+		return -EINVAL;
+	}
+	if (params->num_queues < 2 || params->num_queues > MV_RSS_BAL_MAX_QUEUES ||
+	    !params->num_buckets || params->num_buckets > MV_RSS_BAL_MAX_BUCKETS) {
+		pr_err("[%s] invalid number of queues (%u) or buckets (%u)\n", __func__,
+		       params->num_queues, params->num_buckets);
+		return -EINVAL;
+	}
+	if (params->tbl) {
+		for (b = 0; b < params->num_buckets; b++)
+			if (params->tbl[b] >= params->num_queues) {
+				pr_err("[%s] bucket %u: invalid queue %u\n", __func__, b, params->tbl[b]);
+				return -EINVAL;
+			}
+	}
+
+	r = kcalloc(1, sizeof(*r), GFP_KERNEL);
+	if (!r)
+		return -ENOMEM;
+
+	r->params = *params;
+	r->params.tbl = NULL;
+	if (!r->params.imbalance_pct)
+		r->params.imbalance_pct = RSS_BAL_DEF_IMBALANCE_PCT;
+	if (!r->params.min_gain_pct)
+		r->params.min_gain_pct = RSS_BAL_DEF_MIN_GAIN_PCT;
+	if (!r->params.max_moves)
+		r->params.max_moves = RSS_BAL_DEF_MAX_MOVES;
+	if (r->params.max_moves > MV_RSS_BAL_MAX_QUEUES / 2)
+		r->params.max_moves = MV_RSS_BAL_MAX_QUEUES / 2;
+	if (!r->params.min_interval_usecs)
+		r->params.min_interval_usecs = RSS_BAL_DEF_MIN_INTERVAL_USECS;
+	if (!r->params.hold_usecs)
+		r->params.hold_usecs = RSS_BAL_DEF_HOLD_USECS;
+	if (!r->params.ewma_shift)
+		r->params.ewma_shift = RSS_BAL_DEF_EWMA_SHIFT;
+
+	for (b = 0; b < params->num_buckets; b++)
+		r->map[b] = params->tbl ? params->tbl[b] : b % params->num_queues;
+
+	*bal = r;
+	return 0;
+}
+
+void mv_rss_bal_destroy(struct mv_rss_bal *bal)
+{
+	kfree(bal);
+}
+
+int mv_rss_bal_update(struct mv_rss_bal *bal, const u64 *queue_cnt, const u64 *bucket_cnt, u64 now_ns)
+{
+	struct mv_rss_bal_params	*params = &bal->params;
+	u64				 usecs, rate, sum = 0, mean, peak = 0;
+	u32				 q, b;
+
+	if (!bal->sampled || now_ns < bal->last_ns + RSS_BAL_NSEC_PER_USEC) {
+		if (!bal->sampled) {
+			memcpy(bal->queue_cnt, queue_cnt, params->num_queues * sizeof(u64));
+			if (bucket_cnt)
+				memcpy(bal->bucket_cnt, bucket_cnt, params->num_buckets * sizeof(u64));
+			bal->last_ns = bal->rebal_ns = now_ns;
+			bal->sampled = 1;
+		}
+		return 0;
+	}
+	usecs = (now_ns - bal->last_ns) / RSS_BAL_NSEC_PER_USEC;
+	bal->last_ns = now_ns;
+	bal->stats.updates++;
+
+	for (q = 0; q < params->num_queues; q++) {
+		bal->rate[q] = rss_bal_rate(queue_cnt[q] - bal->queue_cnt[q], usecs);
+		bal->queue_cnt[q] = queue_cnt[q];
+		bal->load[q] = bal->loaded ? rss_bal_ewma(bal->load[q], bal->rate[q], params->ewma_shift) :
+					     bal->rate[q];
+		sum += bal->load[q];
+		peak = max(peak, bal->load[q]);
+	}
+
+	if (bucket_cnt) {
+		for (b = 0; b < params->num_buckets; b++) {
+			rate = rss_bal_rate(bucket_cnt[b] - bal->bucket_cnt[b], usecs);
+			bal->bucket_cnt[b] = bucket_cnt[b];
+			bal->est[b] = bal->loaded ? rss_bal_ewma(bal->est[b], rate, params->ewma_shift) : rate;
+		}
+		bal->num_pending = 0;
+	} else {
+		rss_bal_estimate(bal);
+	}
+	bal->loaded = 1;
+
+	mean = sum / params->num_queues;
+	bal->stats.imbalance_pct = mean ? (u32)(peak * 100 / mean) : 100;
+
+	if (!mean || now_ns < bal->rebal_ns + (u64)params->min_interval_usecs * RSS_BAL_NSEC_PER_USEC)
+		return 0;
+
+	return rss_bal_rebalance(bal, !bucket_cnt, mean, now_ns);
+}
+
+u32 mv_rss_bal_get_queue(struct mv_rss_bal *bal, u32 bucket)
+{
+	return bal->map[bucket];
+}
+
+void mv_rss_bal_get_stats(struct mv_rss_bal *bal, struct mv_rss_bal_stats *stats, int reset)
+{
+	if (stats)
+		*stats = bal->stats;
+	if (reset) {
+		bal->stats.updates = 0;
+		bal->stats.rebalances = 0;
+		bal->stats.moves = 0;
+		bal->stats.move_errs = 0;
+	}
+}
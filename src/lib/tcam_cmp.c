@@ -0,0 +1,400 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include "std_internal.h"
+
+#include "lib/mv_tcam_cmp.h"
+
+/* A range of a field of width w is covered by at most 2w - 2 prefixes */
+#define TCAM_MAX_TERMS		(2 * MV_TCAM_MAX_FIELD_WIDTH)
+
+struct tcam_terms {
+	u32	num;
+	u32	num_prefix;	/* terms before minimization */
+	u64	val[TCAM_MAX_TERMS];
+	u64	mask[TCAM_MAX_TERMS];
+};
+
+static inline u64 tcam_width_mask(u8 width)
+{
+	return (width == 64) ? ~0ULL : ((1ULL << width) - 1);
+}
+
+static int tcam_rule_check(const struct mv_tcam_rule *rule)
+{
+	u16 i;
+
+	if (!rule->num_fields || rule->num_fields > MV_TCAM_MAX_FIELDS) {
+		pr_err("[%s] invalid number of fields %u\n", __func__, rule->num_fields);
+		return -EINVAL;
+	}
+	for (i = 0; i < rule->num_fields; i++)
+		if (!rule->widths[i] || rule->widths[i] > MV_TCAM_MAX_FIELD_WIDTH) {
+			pr_err("[%s] invalid width %u of field %u\n", __func__, rule->widths[i], i);
+			return -EINVAL;
+		}
+	if (rule->num_preds && !rule->preds)
+		return -EINVAL;
+	return 0;
+}
+
+static void tcam_range_to_prefixes(u64 lo, u64 hi, u8 width, struct tcam_terms *t)
+{
+	u64 wmask = tcam_width_mask(width);
+	u64 size;	/* block size - 1 */
+	int k;
+
+	for (;;) {
+		/* The largest block aligned at 'lo' that ends at 'hi' at most */
+		k = lo ? __builtin_ctzll(lo) : width;
+		if (k > width)
+			k = width;
+		size = tcam_width_mask(k);
+		while (k && hi - lo < size)
+			size = tcam_width_mask(--k);
+
+		t->val[t->num] = lo;
+		t->mask[t->num] = wmask & ~size;
+		t->num++;
+		if (hi - lo == size)
+			break;
+		lo += size + 1;
+	}
+}
+
+static void tcam_terms_intersect(struct tcam_terms *t, u64 val, u64 mask)
+{
+	u32 i, n = 0;
+
+	val &= mask;
+	for (i = 0; i < t->num; i++) {
+		if ((t->val[i] ^ val) & t->mask[i] & mask)
+			continue;
+		t->val[n] = t->val[i] | val;
+		t->mask[n] = t->mask[i] | mask;
+		n++;
+	}
+	t->num = n;
+}
+
+static void tcam_terms_remove(struct tcam_terms *t, u32 i)
+{
+	t->num--;
+	t->val[i] = t->val[t->num];
+	t->mask[i] = t->mask[t->num];
+}
+
+/* Whether term j is contained in term i */
+static inline int tcam_term_covers(struct tcam_terms *t, u32 i, u32 j)
+{
+	return !(t->mask[i] & ~t->mask[j]) && !((t->val[i] ^ t->val[j]) & t->mask[i]);
+}
+
+static void tcam_terms_minimize(struct tcam_terms *t)
+{
+	u32 i, j;
+	u64 diff;
+	int changed;
+
+	do {
+		changed = 0;
+		for (i = 0; i < t->num; i++) {
+			for (j = i + 1; j < t->num; j++) {
+				if (tcam_term_covers(t, i, j)) {
+					tcam_terms_remove(t, j--);
+					changed = 1;
+					continue;
+				}
+				if (tcam_term_covers(t, j, i)) {
+					t->val[i] = t->val[j];
+					t->mask[i] = t->mask[j];
+					tcam_terms_remove(t, j--);
+					changed = 1;
+					continue;
+				}
+				diff = t->val[i] ^ t->val[j];
+				if (t->mask[i] == t->mask[j] && !(diff & (diff - 1))) {
+					/* Both halves of a term */
+					t->mask[i] &= ~diff;
+					t->val[i] &= t->mask[i];
+					tcam_terms_remove(t, j--);
+					changed = 1;
+				}
+			}
+		}
+	} while (changed);
+}
+
+static int tcam_field_compile(const struct mv_tcam_rule *rule, u8 field, struct tcam_terms *t)
+{
+	const struct mv_tcam_pred *pred;
+	u8 width = rule->widths[field];
+	u64 wmask = tcam_width_mask(width);
+	u64 lo = 0, hi = wmask, plo, phi;
+	u16 i;
+
+	t->num = 0;
+	for (i = 0; i < rule->num_preds; i++) {
+		pred = &rule->preds[i];
+		if (pred->field >= rule->num_fields) {
+			pr_err("[%s] invalid field %u of predicate %u\n", __func__, pred->field, i);
+			return -EINVAL;
+		}
+		if (pred->field != field)
+			continue;
+
+		switch (pred->type) {
+		case MV_TCAM_PRED_EXACT:
+			plo = pred->u.value;
+			phi = pred->u.value;
+			break;
+		case MV_TCAM_PRED_PREFIX:
+			if (pred->u.prefix.len > width) {
+				pr_err("[%s] prefix length %u over field width %u\n", __func__,
+				       pred->u.prefix.len, width);
+				return -EINVAL;
+			}
+			phi = tcam_width_mask(width - pred->u.prefix.len);
+			plo = pred->u.prefix.value & ~phi;
+			phi |= pred->u.prefix.value;
+			break;
+		case MV_TCAM_PRED_RANGE:
+			plo = pred->u.range.lo;
+			phi = pred->u.range.hi;
+			if (plo > phi) {
+				pr_err("[%s] empty range of predicate %u\n", __func__, i);
+				return -EINVAL;
+			}
+			break;
+		case MV_TCAM_PRED_MASK:
+			if ((pred->u.mask.value | pred->u.mask.mask) & ~wmask) {
+				pr_err("[%s] key/mask of predicate %u over field width %u\n", __func__, i, width);
+				return -EINVAL;
+			}
+			continue;
+		default:
+			pr_err("[%s] invalid type %d of predicate %u\n", __func__, pred->type, i);
+			return -EINVAL;
+		}
+		if ((plo | phi) & ~wmask) {
+			pr_err("[%s] value of predicate %u over field width %u\n", __func__, i, width);
+			return -EINVAL;
+		}
+		lo = max(lo, plo);
+		hi = min(hi, phi);
+	}
+
+	if (lo <= hi)
+		tcam_range_to_prefixes(lo, hi, width, t);
+
+	for (i = 0; i < rule->num_preds && t->num; i++) {
+		pred = &rule->preds[i];
+		if (pred->field == field && pred->type == MV_TCAM_PRED_MASK)
+			tcam_terms_intersect(t, pred->u.mask.value, pred->u.mask.mask);
+	}
+	t->num_prefix = t->num;
+
+	tcam_terms_minimize(t);
+	return 0;
+}
+
+static int tcam_rule_terms(const struct mv_tcam_rule *rule, struct tcam_terms *terms,
+			   struct mv_tcam_estimate *est)
+{
+	u8 i;
+	int err;
+
+	err = tcam_rule_check(rule);
+	if (err)
+		return err;
+
+	est->entries = 1;
+	est->prefix_entries = 1;
+	for (i = 0; i < rule->num_fields; i++) {
+		err = tcam_field_compile(rule, i, &terms[i]);
+		if (err)
+			return err;
+		/* At most 128^8, no overflow */
+		est->entries *= terms[i].num;
+		est->prefix_entries *= terms[i].num_prefix;
+	}
+	return 0;
+}
+
+int mv_tcam_rule_estimate(const struct mv_tcam_rule *rule, struct mv_tcam_estimate *est)
+{
+	struct tcam_terms *terms;
+	int err;
+
+	terms = kcalloc(MV_TCAM_MAX_FIELDS, sizeof(*terms), GFP_KERNEL);
+	if (!terms)
+		return -ENOMEM;
+	err = tcam_rule_terms(rule, terms, est);
+	kfree(terms);
+	return err;
+}
+
+int mv_tcam_rule_compile(const struct mv_tcam_rule *rule, struct mv_tcam_entry *entries, u32 *num)
+{
+	struct mv_tcam_estimate est;
+	struct tcam_terms *terms;
+	u32 idx[MV_TCAM_MAX_FIELDS];
+	u32 n;
+	u8 i;
+	int err;
+
+	terms = kcalloc(MV_TCAM_MAX_FIELDS, sizeof(*terms), GFP_KERNEL);
+	if (!terms)
+		return -ENOMEM;
+	err = tcam_rule_terms(rule, terms, &est);
+	if (err)
+		goto out;
+
+	if (est.entries > *num) {
+		*num = (est.entries > (u32)~0) ? (u32)~0 : (u32)est.entries;
+		err = -ENOSPC;
+		goto out;
+	}
+	*num = (u32)est.entries;
+
+	/* Cross product of the terms, the last field changing fastest */
+	memset(idx, 0, sizeof(idx));
+	for (n = 0; n < *num; n++) {
+		memset(&entries[n], 0, sizeof(entries[n]));
+		for (i = 0; i < rule->num_fields; i++) {
+			entries[n].key[i] = terms[i].val[idx[i]];
+			entries[n].mask[i] = terms[i].mask[idx[i]];
+		}
+		for (i = rule->num_fields; i-- > 0;) {
+			if (++idx[i] < terms[i].num)
+				break;
+			idx[i] = 0;
+		}
+	}
+out:
+	kfree(terms);
+	return err;
+}
+
+int mv_tcam_policy_estimate(const struct mv_tcam_rule *rules, u32 num_rules, u32 capacity,
+			    struct mv_tcam_estimate *est)
+{
+	struct mv_tcam_estimate rule_est;
+	struct tcam_terms *terms;
+	u32 i;
+	int err = 0;
+
+	terms = kcalloc(MV_TCAM_MAX_FIELDS, sizeof(*terms), GFP_KERNEL);
+	if (!terms)
+		return -ENOMEM;
+
+	est->entries = 0;
+	est->prefix_entries = 0;
+	for (i = 0; i < num_rules; i++) {
+		err = tcam_rule_terms(&rules[i], terms, &rule_est);
+		if (err) {
+			pr_err("[%s] invalid rule %u\n", __func__, i);
+			goto out;
+		}
+		est->entries += rule_est.entries;
+		est->prefix_entries += rule_est.prefix_entries;
+	}
+	if (capacity && est->entries > capacity)
+		err = -ENOSPC;
+out:
+	kfree(terms);
+	return err;
+}
@@ -0,0 +1,323 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include "std_internal.h"
+#include <sys/stat.h>
+
+#include "lib/mv_telemetry.h"
+
+struct mv_tlm {
+	char			 file_name[sizeof(MV_TLM_SHM_DIR) + sizeof(MV_TLM_SHM_PREFIX) + MV_TLM_NAME_MAX];
+	int			 owner;
+	size_t			 size;
+	struct mv_tlm_hdr	*hdr;
+	struct mv_tlm_queue	*queues;
+	struct mv_tlm_bpool	*bpools;
+};
+
+static size_t tlm_seg_size(u32 num_queues, u32 num_bpools)
+{
+	return sizeof(struct mv_tlm_hdr) +
+	       num_queues * sizeof(struct mv_tlm_queue) +
+	       num_bpools * sizeof(struct mv_tlm_bpool);
+}
+
+static int tlm_set_file_name(struct mv_tlm *tlm, const char *name)
+{
+	if (!name || !name[0] || strlen(name) >= MV_TLM_NAME_MAX || strchr(name, '/')) {
+		pr_err("[%s] invalid telemetry name!\n", __func__);
+		return -EINVAL;
+	}
+	snprintf(tlm->file_name, sizeof(tlm->file_name), "%s%s%s", MV_TLM_SHM_DIR, MV_TLM_SHM_PREFIX, name);
+	return 0;
+}
+
+static void tlm_set_records(struct mv_tlm *tlm)
+{
+	tlm->queues = (struct mv_tlm_queue *)(tlm->hdr + 1);
+	tlm->bpools = (struct mv_tlm_bpool *)(tlm->queues + tlm->hdr->num_queues);
+}
+
+int mv_tlm_create(struct mv_tlm_params *params, struct mv_tlm **tlm)
+{
+	struct mv_tlm	*ltlm;
+	void		*va;
+	int		 fd, err;
+
+	BUILD_BUG_ON(sizeof(struct mv_tlm_queue) != MV_TLM_REC_SIZE);
+	BUILD_BUG_ON(sizeof(struct mv_tlm_bpool) != MV_TLM_REC_SIZE);
+	BUILD_BUG_ON(sizeof(struct mv_tlm_hdr) != MV_TLM_REC_SIZE);
+
+	if (!params || !tlm)
+		return -EINVAL;
+
+	ltlm = kcalloc(1, sizeof(struct mv_tlm), GFP_KERNEL);
+	if (!ltlm) {
+		pr_err("[%s] no mem for telemetry obj!\n", __func__);
+		return -ENOMEM;
+	}
+
+	err = tlm_set_file_name(ltlm, params->name);
+	if (err)
+		goto tlm_create_err;
+
+	ltlm->size = tlm_seg_size(params->num_queues, params->num_bpools);
+
+	fd = open(ltlm->file_name, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+	if (fd < 0) {
+		pr_err("[%s] failed to create %s (%d)!\n", __func__, ltlm->file_name, errno);
+		err = -EIO;
+		goto tlm_create_err;
+	}
+	if (ftruncate(fd, ltlm->size)) {
+		pr_err("[%s] failed to size %s (%d)!\n", __func__, ltlm->file_name, errno);
+		close(fd);
+		unlink(ltlm->file_name);
+		err = -EIO;
+		goto tlm_create_err;
+	}
+	va = mmap(NULL, ltlm->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (va == MAP_FAILED) {
+		pr_err("[%s] failed to map %s (%d)!\n", __func__, ltlm->file_name, errno);
+		unlink(ltlm->file_name);
+		err = -ENOMEM;
+		goto tlm_create_err;
+	}
+
+	memset(va, 0, ltlm->size);
+	ltlm->owner = 1;
+	ltlm->hdr = va;
+	ltlm->hdr->version = MV_TLM_VERSION;
+	ltlm->hdr->rec_size = MV_TLM_REC_SIZE;
+	ltlm->hdr->num_queues = params->num_queues;
+	ltlm->hdr->num_bpools = params->num_bpools;
+	ltlm->hdr->pid = getpid();
+	snprintf(ltlm->hdr->name, sizeof(ltlm->hdr->name), "%s", params->name);
+	tlm_set_records(ltlm);
+	/* Publish the segment only after the header is complete */
+	__atomic_store_n(&ltlm->hdr->magic, MV_TLM_MAGIC, __ATOMIC_RELEASE);
+
+	pr_debug("[%s] telemetry %s: %u queues, %u bpools, %zu bytes\n", __func__,
+		 ltlm->file_name, params->num_queues, params->num_bpools, ltlm->size);
+
+	*tlm = ltlm;
+	return 0;
+
+tlm_create_err:
+	kfree(ltlm);
+	return err;
+}
+
+void mv_tlm_destroy(struct mv_tlm *tlm)
+{
+	if (!tlm)
+		return;
+
+	if (tlm->owner)
+		unlink(tlm->file_name);
+	munmap(tlm->hdr, tlm->size);
+	kfree(tlm);
+}
+
+int mv_tlm_attach(const char *name, struct mv_tlm **tlm)
+{
+	struct mv_tlm		*ltlm;
+	struct mv_tlm_hdr	*hdr;
+	struct stat		 st;
+	void			*va;
+	int			 fd, err;
+
+	if (!tlm)
+		return -EINVAL;
+
+	ltlm = kcalloc(1, sizeof(struct mv_tlm), GFP_KERNEL);
+	if (!ltlm) {
+		pr_err("[%s] no mem for telemetry obj!\n", __func__);
+		return -ENOMEM;
+	}
+
+	err = tlm_set_file_name(ltlm, name);
+	if (err)
+		goto tlm_attach_err;
+
+	fd = open(ltlm->file_name, O_RDONLY);
+	if (fd < 0) {
+		pr_err("[%s] failed to open %s (%d)!\n", __func__, ltlm->file_name, errno);
+		err = -ENOENT;
+		goto tlm_attach_err;
+	}
+	if (fstat(fd, &st) || st.st_size < sizeof(struct mv_tlm_hdr)) {
+		pr_err("[%s] invalid telemetry file %s!\n", __func__, ltlm->file_name);
+		close(fd);
+		err = -EINVAL;
+		goto tlm_attach_err;
+	}
+	ltlm->size = st.st_size;
+	va = mmap(NULL, ltlm->size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (va == MAP_FAILED) {
+		pr_err("[%s] failed to map %s (%d)!\n", __func__, ltlm->file_name, errno);
+		err = -ENOMEM;
+		goto tlm_attach_err;
+	}
+
+	hdr = va;
+	if (__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != MV_TLM_MAGIC ||
+	    hdr->version != MV_TLM_VERSION ||
+	    hdr->rec_size != MV_TLM_REC_SIZE ||
+	    tlm_seg_size(hdr->num_queues, hdr->num_bpools) > ltlm->size) {
+		pr_err("[%s] telemetry %s is not initialized or incompatible!\n", __func__, ltlm->file_name);
+		munmap(va, ltlm->size);
+		err = -EINVAL;
+		goto tlm_attach_err;
+	}
+
+	ltlm->hdr = hdr;
+	tlm_set_records(ltlm);
+
+	*tlm = ltlm;
+	return 0;
+
+tlm_attach_err:
+	kfree(ltlm);
+	return err;
+}
+
+void mv_tlm_detach(struct mv_tlm *tlm)
+{
+	mv_tlm_destroy(tlm);
+}
+
+struct mv_tlm_hdr *mv_tlm_get_hdr(struct mv_tlm *tlm)
+{
+	return tlm->hdr;
+}
+
+struct mv_tlm_queue *mv_tlm_get_queue(struct mv_tlm *tlm, u32 idx)
+{
+	if (unlikely(idx >= tlm->hdr->num_queues))
+		return NULL;
+	return &tlm->queues[idx];
+}
+
+struct mv_tlm_bpool *mv_tlm_get_bpool(struct mv_tlm *tlm, u32 idx)
+{
+	if (unlikely(idx >= tlm->hdr->num_bpools))
+		return NULL;
+	return &tlm->bpools[idx];
+}
+
+void mv_tlm_queue_register(struct mv_tlm_queue *q, enum mv_tlm_q_dir dir, u8 port, u8 tc, u8 qid,
+			   u8 thread, u32 size)
+{
+	q->dir = dir;
+	q->port = port;
+	q->tc = tc;
+	q->qid = qid;
+	q->thread = thread;
+	q->size = size;
+	__atomic_store_n(&q->in_use, 1, __ATOMIC_RELEASE);
+}
+
+void mv_tlm_bpool_register(struct mv_tlm_bpool *bp, u8 pp_id, u8 pool_id, u32 size, u32 buff_len)
+{
+	bp->pp_id = pp_id;
+	bp->pool_id = pool_id;
+	bp->size = size;
+	bp->buff_len = buff_len;
+	__atomic_store_n(&bp->in_use, 1, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,300 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include "std_internal.h"
+
+#include "lib/mv_udf_calc.h"
+
+#define UDF_ETYPE_IP4		0x0800
+#define UDF_ETYPE_IP6		0x86DD
+#define UDF_ETYPE_MPLS		0x8847
+#define UDF_ETYPE_PPPOE		0x8864
+
+#define UDF_HDR_BIT(type)	BIT(MV_UDF_HDR_ ## type)
+#define UDF_NEXT_L3		(UDF_HDR_BIT(PPPOE) | UDF_HDR_BIT(MPLS) | UDF_HDR_BIT(IP4) | \
+				 UDF_HDR_BIT(IP6) | UDF_HDR_BIT(RAW))
+#define UDF_NEXT_IP		(UDF_HDR_BIT(IP4) | UDF_HDR_BIT(IP6) | UDF_HDR_BIT(UDP) | \
+				 UDF_HDR_BIT(TCP) | UDF_HDR_BIT(GRE) | UDF_HDR_BIT(RAW))
+
+struct udf_hdr_info {
+	const char	*name;
+	u16		min_len;
+	u16		max_len;
+	u16		align;
+	u16		etype;	/* ethertype after the L2 headers; 0 if it can't follow them */
+	int		l2;	/* an outer one is walked before the L2 lookup */
+	int		var;	/* variable length */
+	u32		next;	/* headers that may follow */
+};
+
+static const struct udf_hdr_info udf_hdrs[MV_UDF_HDR_LAST] = {
+	[MV_UDF_HDR_ETH] = {"eth", MV_ETH_HLEN, MV_ETH_HLEN, 1, 0, 1, 0,
+			    UDF_HDR_BIT(DSA) | UDF_HDR_BIT(VLAN) | UDF_HDR_BIT(QINQ) | UDF_NEXT_L3},
+	[MV_UDF_HDR_DSA] = {"dsa", 4, 8, 4, 0, 1, 0,
+			    UDF_HDR_BIT(VLAN) | UDF_HDR_BIT(QINQ) | UDF_NEXT_L3},
+	[MV_UDF_HDR_VLAN] = {"vlan", MV_VLAN_TAG_LEN, MV_VLAN_TAG_LEN, 1, 0, 1, 0,
+			     UDF_HDR_BIT(VLAN) | UDF_NEXT_L3},
+	[MV_UDF_HDR_QINQ] = {"qinq", MV_VLAN_TAG_LEN, MV_VLAN_TAG_LEN, 1, 0, 1, 0,
+			     UDF_HDR_BIT(VLAN) | UDF_HDR_BIT(QINQ) | UDF_NEXT_L3},
+	[MV_UDF_HDR_PPPOE] = {"pppoe", 8, 8, 1, UDF_ETYPE_PPPOE, 0, 0,
+			      UDF_HDR_BIT(IP4) | UDF_HDR_BIT(IP6)},
+	[MV_UDF_HDR_MPLS] = {"mpls", 4, 4, 1, UDF_ETYPE_MPLS, 0, 0,
+			     UDF_HDR_BIT(MPLS) | UDF_HDR_BIT(IP4) | UDF_HDR_BIT(IP6) |
+			     UDF_HDR_BIT(ETH) | UDF_HDR_BIT(RAW)},
+	[MV_UDF_HDR_IP4] = {"ipv4", 20, 60, 4, UDF_ETYPE_IP4, 0, 1, UDF_NEXT_IP},
+	[MV_UDF_HDR_IP6] = {"ipv6", 40, 0xffff, 8, UDF_ETYPE_IP6, 0, 1, UDF_NEXT_IP},
+	[MV_UDF_HDR_UDP] = {"udp", 8, 8, 1, 0, 0, 0,
+			    UDF_HDR_BIT(VXLAN) | UDF_HDR_BIT(MPLS) | UDF_HDR_BIT(RAW)},
+	[MV_UDF_HDR_TCP] = {"tcp", 20, 60, 4, 0, 0, 1, UDF_HDR_BIT(RAW)},
+	[MV_UDF_HDR_GRE] = {"gre", 4, 16, 4, 0, 0, 1,
+			    UDF_HDR_BIT(IP4) | UDF_HDR_BIT(IP6) | UDF_HDR_BIT(ETH) |
+			    UDF_HDR_BIT(MPLS) | UDF_HDR_BIT(RAW)},
+	[MV_UDF_HDR_VXLAN] = {"vxlan", 8, 8, 1, 0, 0, 0, UDF_HDR_BIT(ETH)},
+	[MV_UDF_HDR_RAW] = {"raw", 1, 0xffff, 1, 0, 0, 0, UDF_HDR_BIT(RAW)},
+};
+
+static int udf_path_check(const struct mv_udf_field *field, u16 *lens)
+{
+	const struct mv_udf_hdr *hdr;
+	const struct udf_hdr_info *info;
+	enum mv_udf_hdr_type prev = MV_UDF_HDR_LAST;
+	u8 i;
+
+	if (!field->path || !field->num_hdrs || field->num_hdrs > MV_UDF_MAX_HDRS) {
+		pr_err("[%s] invalid path\n", __func__);
+		return -EINVAL;
+	}
+	if (field->path[0].type != MV_UDF_HDR_ETH) {
+		pr_err("[%s] path doesn't start with an Ethernet header\n", __func__);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < field->num_hdrs; i++) {
+		hdr = &field->path[i];
+		if (hdr->type >= MV_UDF_HDR_LAST) {
+			pr_err("[%s] invalid type %d of header %u\n", __func__, hdr->type, i);
+			return -EINVAL;
+		}
+		info = &udf_hdrs[hdr->type];
+		if (prev != MV_UDF_HDR_LAST && !(udf_hdrs[prev].next & BIT(hdr->type))) {
+			pr_err("[%s] %s can't follow %s (header %u)\n", __func__,
+			       info->name, udf_hdrs[prev].name, i);
+			return -EINVAL;
+		}
+		/* a DSA tag sits right after the outer SA only */
+		if (hdr->type == MV_UDF_HDR_DSA && i != 1) {
+			pr_err("[%s] dsa tag not after the outer Ethernet header\n", __func__);
+			return -EINVAL;
+		}
+
+		lens[i] = hdr->len ? hdr->len : info->min_len;
+		if (hdr->type == MV_UDF_HDR_RAW && !hdr->len) {
+			pr_err("[%s] no length of raw header %u\n", __func__, i);
+			return -EINVAL;
+		}
+		if (lens[i] < info->min_len || lens[i] > info->max_len || lens[i] % info->align) {
+			pr_err("[%s] invalid length %u of %s header %u\n", __func__, lens[i], info->name, i);
+			return -EINVAL;
+		}
+		prev = hdr->type;
+	}
+
+	return 0;
+}
+
+int mv_udf_calc(const struct mv_udf_field *field, struct mv_udf_cfg *cfg)
+{
+	u16 lens[MV_UDF_MAX_HDRS];
+	const struct mv_udf_hdr *l3;
+	u32 pos, anchor, field_pos;
+	u16 etype;
+	u8 tags = 0, var = 0;
+	u8 i, l2_end;
+	int err;
+
+	if (!field || !cfg)
+		return -EINVAL;
+
+	err = udf_path_check(field, lens);
+	if (err)
+		return err;
+
+	if (field->hdr >= field->num_hdrs || !field->size || field->size > MV_UDF_MAX_SIZE ||
+	    field->offs + field->size > lens[field->hdr]) {
+		pr_err("[%s] invalid field (header %u offs %u size %u)\n", __func__,
+		       field->hdr, field->offs, field->size);
+		return -EINVAL;
+	}
+
+	/* Walk the outer L2 headers, as the MAC, DSA and VLAN lookups do; the
+	 * L2 lookup ethertype is the last two bytes of the last of them.
+	 */
+	pos = 0;
+	for (i = 0; i < field->num_hdrs && udf_hdrs[field->path[i].type].l2; i++) {
+		if (field->path[i].type == MV_UDF_HDR_VLAN || field->path[i].type == MV_UDF_HDR_QINQ)
+			tags++;
+		pos += lens[i];
+	}
+	l2_end = i;
+	anchor = pos - MV_ETH_ETYPE_LEN;
+
+	if (tags > MV_UDF_MAX_L2_TAGS) {
+		pr_err("[%s] %u VLAN tags, the parser walks up to %u\n", __func__, tags, MV_UDF_MAX_L2_TAGS);
+		return -ENOTSUP;
+	}
+	if (l2_end == field->num_hdrs || field->hdr < l2_end) {
+		pr_err("[%s] field not after the L2 headers\n", __func__);
+		return -ENOTSUP;
+	}
+
+	l3 = &field->path[l2_end];
+	etype = (l3->type == MV_UDF_HDR_RAW) ? l3->etype : udf_hdrs[l3->type].etype;
+	if (!etype) {
+		pr_err("[%s] no ethertype for %s after the L2 headers\n", __func__, udf_hdrs[l3->type].name);
+		return -EINVAL;
+	}
+
+	for (i = l2_end; i < field->hdr; i++) {
+		if (udf_hdrs[field->path[i].type].var)
+			var++;
+		pos += lens[i];
+	}
+	field_pos = pos + field->offs;
+
+	if (field_pos - anchor > MV_UDF_MAX_OFFSET) {
+		pr_err("[%s] field offset %u over %u\n", __func__, field_pos - anchor, MV_UDF_MAX_OFFSET);
+		return -ERANGE;
+	}
+
+	memset(cfg, 0, sizeof(*cfg));
+	cfg->match_proto = MV_NET_PROTO_ETH;
+	cfg->match_field.eth = MV_NET_ETH_F_TYPE;
+	cfg->match_key[0] = etype >> 8;
+	cfg->match_key[1] = etype & 0xff;
+	cfg->match_mask[0] = 0xff;
+	cfg->match_mask[1] = 0xff;
+	cfg->offset = field_pos - anchor;
+	cfg->size = field->size;
+	cfg->pkt_offs = field_pos;
+	cfg->l2_tags = tags;
+	cfg->var_hdrs = var;
+
+	return 0;
+}
+
+int mv_udf_calc_check(const struct mv_udf_cfg *cfgs, u32 num)
+{
+	u32 i, j, k;
+
+	if (num > MV_UDF_MAX_NUM || (num && !cfgs)) {
+		pr_err("[%s] invalid number of UDFs %u\n", __func__, num);
+		return -EINVAL;
+	}
+
+	for (i = 1; i < num; i++)
+		for (j = 0; j < i; j++) {
+			for (k = 0; k < MV_ETH_ETYPE_LEN; k++)
+				if ((cfgs[i].match_key[k] ^ cfgs[j].match_key[k]) &
+				    cfgs[i].match_mask[k] & cfgs[j].match_mask[k])
+					break;
+			if (k == MV_ETH_ETYPE_LEN) {
+				pr_err("[%s] UDF %u is shadowed by UDF %u\n", __func__, i, j);
+				return -EEXIST;
+			}
+		}
+
+	return 0;
+}
@@ -0,0 +1,322 @@
+/*******************************************************************************
+ * Copyright (C) Marvell International Ltd. and its affiliates
+ *
+ * This software file (the "File") is owned and distributed by Marvell
+ * International Ltd. and/or its affiliates ("Marvell") under the following
+ * alternative licensing terms.  Once you have made an election to distribute the
+ * File under one of the following license alternatives, please (i) delete this
+ * introductory statement regarding license alternatives, (ii) delete the three
+ * license alternatives that you have not elected to use and (iii) preserve the
+ * Marvell copyright notice above.
+ *
+ ********************************************************************************
+ * Marvell Commercial License Option
+ *
+ * If you received this File from Marvell and you have entered into a commercial
+ * license agreement (a "Commercial License") with Marvell, the File is licensed
+ * to you under the terms of the applicable Commercial License.
+ *
+ ********************************************************************************
+ * Marvell GPL License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the General
+ * Public License Version 2, June 1991 (the "GPL License"), a copy of which is
+ * available along with the File in the license.txt file or by writing to the Free
+ * Software Foundation, Inc., or on the worldwide web at http://www.gnu.org/licenses/gpl.txt.
+ *
+ * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE ARE EXPRESSLY
+ * DISCLAIMED.  The GPL License provides additional details about this warranty
+ * disclaimer.
+ *
+ ********************************************************************************
+ * Marvell GNU General Public License FreeRTOS Exception
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File in accordance with the terms and conditions of the Lesser
+ * General Public License Version 2.1 plus the following FreeRTOS exception.
+ * An independent module is a module which is not derived from or based on
+ * FreeRTOS.
+ * Clause 1:
+ * Linking FreeRTOS statically or dynamically with other modules is making a
+ * combined work based on FreeRTOS. Thus, the terms and conditions of the GNU
+ * General Public License cover the whole combination.
+ * As a special exception, the copyright holder of FreeRTOS gives you permission
+ * to link FreeRTOS with independent modules that communicate with FreeRTOS solely
+ * through the FreeRTOS API interface, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting combined work
+ * under terms of your choice, provided that:
+ * 1. Every copy of the combined work is accompanied by a written statement that
+ * details to the recipient the version of FreeRTOS used and an offer by yourself
+ * to provide the FreeRTOS source code (including any modifications you may have
+ * made) should the recipient request it.
+ * 2. The combined work is not itself an RTOS, scheduler, kernel or related
+ * product.
+ * 3. The independent modules add significant and primary functionality to
+ * FreeRTOS and do not merely extend the existing functionality already present in
+ * FreeRTOS.
+ * Clause 2:
+ * FreeRTOS may not be used for any competitive or comparative purpose, including
+ * the publication of any form of run time or compile time metric, without the
+ * express permission of Real Time Engineers Ltd. (this is the norm within the
+ * industry and is intended to ensure information accuracy).
+ *
+ ********************************************************************************
+ * Marvell BSD License Option
+ *
+ * If you received this File from Marvell, you may opt to use, redistribute and/or
+ * modify this File under the following licensing terms.
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *	* Redistributions of source code must retain the above copyright notice,
+ *	  this list of conditions and the following disclaimer.
+ *
+ *	* Redistributions in binary form must reproduce the above copyright
+ *	  notice, this list of conditions and the following disclaimer in the
+ *	  documentation and/or other materials provided with the distribution.
+ *
+ *	* Neither the name of Marvell nor the names of its contributors may be
+ *	  used to endorse or promote products derived from this software without
+ *	  specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *******************************************************************************/
+
+#include "std_internal.h"
+
+#include "lib/mv_wred.h"
+
+#define WRED_DEF_WQ_SHIFT	9
+#define WRED_MAX_WQ_SHIFT	16
+#define WRED_DEF_SEED		0x2545f491
+/* the average depth is kept in 1/WRED_AVG_ONE units */
+#define WRED_AVG_SHIFT		8
+#define WRED_MAX_DEPTH		(~0U >> WRED_AVG_SHIFT)
+
+struct wred_curve {
+	u32	min;		/* in 1/WRED_AVG_ONE units */
+	u32	max;
+	u32	max_p;		/* in 1/MV_WRED_PROB_ONE units */
+};
+
+struct mv_wred {
+	struct wred_curve	curve[MV_PLCR_COLOR_NUM];
+	u32			wq_shift;
+	int			gentle;
+	u32			avg;
+	int			count[MV_PLCR_COLOR_NUM];	/* packets since the last drop */
+	u32			rnd;
+	struct mv_wred_stats	stats;
+};
+
+static int wred_init(struct mv_wred *wred, struct mv_wred_params *params)
+{
+	int i;
+
+	for (i = 0; i < MV_PLCR_COLOR_NUM; i++) {
+		struct mv_wred_curve *c = &params->curve[i];
+
+		if (c->max_th < c->min_th || c->max_p_pct > 100 ||
+		    (c->max_th && c->max_th == c->min_th) ||
+		    c->max_th > (~0U >> (WRED_AVG_SHIFT + 1))) {
+			pr_err("[%s] invalid curve %d (min %u, max %u, max_p %u%%)\n", __func__,
+			       i, c->min_th, c->max_th, c->max_p_pct);
+			return -EINVAL;
+		}
+		wred->curve[i].min = c->min_th << WRED_AVG_SHIFT;
+		wred->curve[i].max = c->max_th << WRED_AVG_SHIFT;
+		wred->curve[i].max_p = c->max_p_pct * MV_WRED_PROB_ONE / 100;
+		wred->count[i] = -1;
+	}
+	if (params->wq_shift > WRED_MAX_WQ_SHIFT) {
+		pr_err("[%s] invalid wq_shift %u (max %u)\n", __func__,
+		       params->wq_shift, WRED_MAX_WQ_SHIFT);
+		return -EINVAL;
+	}
+	wred->wq_shift = params->wq_shift ? params->wq_shift : WRED_DEF_WQ_SHIFT;
+	wred->gentle = params->gentle;
+	wred->rnd = params->seed ? params->seed : WRED_DEF_SEED;
+	return 0;
+}
+
+static inline void wred_update_avg(struct mv_wred *wred, u32 depth)
+{
+	s64 diff;
+
+	depth = min(depth, (u32)WRED_MAX_DEPTH);
+	diff = ((s64)depth << WRED_AVG_SHIFT) - wred->avg;
+
+	/* round toward the sample so that the average does reach it */
+	if (diff > 0)
+		wred->avg += (diff + (1 << wred->wq_shift) - 1) >> wred->wq_shift;
+	else
+		wred->avg -= (-diff + (1 << wred->wq_shift) - 1) >> wred->wq_shift;
+}
+
+static inline u32 wred_rand(struct mv_wred *wred)
+{
+	/* xorshift32 */
+	wred->rnd ^= wred->rnd << 13;
+	wred->rnd ^= wred->rnd >> 17;
+	wred->rnd ^= wred->rnd << 5;
+	return wred->rnd >> (32 - MV_WRED_PROB_SHIFT);
+}
+
+u32 mv_wred_prob(struct mv_wred *wred, u32 avg, enum mv_plcr_color color)
+{
+	struct wred_curve *c = &wred->curve[color];
+
+	if (!c->max || avg < c->min)
+		return 0;
+	if (avg < c->max)
+		return (u64)c->max_p * (avg - c->min) / (c->max - c->min);
+	if (wred->gentle && avg < 2 * c->max)
+		return c->max_p + (u64)(MV_WRED_PROB_ONE - c->max_p) * (avg - c->max) / c->max;
+	return MV_WRED_PROB_ONE;
+}
+
+int mv_wred_drop(struct mv_wred *wred, u32 depth, enum mv_plcr_color color)
+{
+	u32 pb, pa;
+	u64 cpb;
+
+	if (unlikely(color >= MV_PLCR_COLOR_NUM))
+		color = MV_PLCR_COLOR_RED;
+	wred->stats.pkts[color]++;
+	wred_update_avg(wred, depth);
+
+	pb = mv_wred_prob(wred, wred->avg, color);
+	if (!pb) {
+		wred->count[color] = -1;
+		return 0;
+	}
+	if (pb < MV_WRED_PROB_ONE) {
+		/* pa = pb / (1 - count * pb): spread the drops evenly between
+		 * 1 and 1/pb packets apart instead of geometrically
+		 */
+		wred->count[color]++;
+		cpb = (u64)wred->count[color] * pb;
+		if (cpb < MV_WRED_PROB_ONE) {
+			pa = ((u64)pb << MV_WRED_PROB_SHIFT) / (MV_WRED_PROB_ONE - cpb);
+			if (wred_rand(wred) >= pa)
+				return 0;
+		}
+	}
+	wred->count[color] = 0;
+	wred->stats.drops[color]++;
+	return 1;
+}
+
+u32 mv_wred_get_avg(struct mv_wred *wred)
+{
+	return wred->avg;
+}
+
+void mv_wred_get_stats(struct mv_wred *wred, struct mv_wred_stats *stats, int reset)
+{
+	*stats = wred->stats;
+	if (reset)
+		memset(&wred->stats, 0, sizeof(wred->stats));
+}
+
+int mv_wred_create(struct mv_wred_params *params, struct mv_wred **wred)
+{
+	struct mv_wred	*w;
+	int		 err;
+
+	w = kcalloc(1, sizeof(*w), GFP_KERNEL);
+	if (!w)
+		return -ENOMEM;
+
+	err = wred_init(w, params);
+	if (err) {
+		kfree(w);
+		return err;
+	}
+
+	*wred = w;
+	return 0;
+}
+
+void mv_wred_destroy(struct mv_wred *wred)
+{
+	kfree(wred);
+}
+
+static u32 wred_count_above(const u32 *depth, u32 num, u32 thresh)
+{
+	u32 i, cnt = 0;
+
+	for (i = 0; i < num; i++)
+		if (depth[i] >= thresh)
+			cnt++;
+	return cnt;
+}
+
+int mv_wred_sim(struct mv_wred_params *params, const u32 *depth, const u8 *color, u32 num,
+		struct mv_wred_sim_result *res)
+{
+	struct mv_wred	 w;
+	u64		 drops = 0, avg_sum = 0;
+	u32		 i, lo, hi, mid, max_drops, max_depth = 0;
+	int		 err;
+
+	if (!num || !depth) {
+		pr_err("[%s] empty trace\n", __func__);
+		return -EINVAL;
+	}
+	memset(&w, 0, sizeof(w));
+	err = wred_init(&w, params);
+	if (err)
+		return err;
+
+	/* expected drops: the count spreading does not change the mean much, so
+	 * the plain curve probability keeps the replay deterministic
+	 */
+	for (i = 0; i < num; i++) {
+		enum mv_plcr_color c = color ? color[i] : MV_PLCR_COLOR_GREEN;
+
+		if (c >= MV_PLCR_COLOR_NUM)
+			c = MV_PLCR_COLOR_RED;
+		wred_update_avg(&w, depth[i]);
+		drops += mv_wred_prob(&w, w.avg, c);
+		avg_sum += w.avg;
+		max_depth = max(max_depth, depth[i]);
+	}
+	max_drops = drops >> MV_WRED_PROB_SHIFT;
+
+	/* lowest threshold whose tail drops do not exceed the WRED drops */
+	lo = 0;
+	hi = max_depth + 1;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (wred_count_above(depth, num, mid) <= max_drops)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+	if (params->curve[MV_PLCR_COLOR_GREEN].max_th) {
+		lo = max(lo, params->curve[MV_PLCR_COLOR_GREEN].min_th);
+		lo = min(lo, params->curve[MV_PLCR_COLOR_GREEN].max_th);
+	}
+
+	res->samples = num;
+	res->drop_ppm = (drops * 1000000 >> MV_WRED_PROB_SHIFT) / num;
+	res->avg_depth = (avg_sum / num) >> WRED_AVG_SHIFT;
+	res->max_depth = max_depth;
+	res->thresh = lo;
+	res->thresh_drop_ppm = (u64)wred_count_above(depth, num, lo) * 1000000 / num;
+	return 0;
+}
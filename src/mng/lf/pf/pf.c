@@ -1193,14 +1193,23 @@ static int nmnicpf_link_state_get(struct nmnicpf *nmnicpf, int *link_state)
 		/* PPIO is not initialized (yet), just return */
 		return -ENODEV;
 
-	/* check PP2 link */
-	err = pp2_ppio_get_link_state(pdesc->ppio, &ppio_link);
-	if (err) {
-		pr_err("Link check error (pp_id: %d)\n", pdesc->pp_id);
-		return -EFAULT;
-	}
+	if (nmnicpf->pp2_link_evt) {
+		/* PP2 link changes update the link mask once pending */
+		err = nmnicpf_pp2_link_event_process(nmnicpf, pdesc->ppio);
+		if (err) {
+			pr_err("Link event error (pp_id: %d)\n", pdesc->pp_id);
+			return -EFAULT;
+		}
+	} else {
+		/* check PP2 link */
+		err = pp2_ppio_get_link_state(pdesc->ppio, &ppio_link);
+		if (err) {
+			pr_err("Link check error (pp_id: %d)\n", pdesc->pp_id);
+			return -EFAULT;
+		}
 
-	nmnicpf->link_up_mask |= (ppio_link) ? LINK_UP_MASK_LOCAL_PP2 : 0;
+		nmnicpf->link_up_mask |= (ppio_link) ? LINK_UP_MASK_LOCAL_PP2 : 0;
+	}
 
 	*link_state = ((nmnicpf->link_up_mask & LINK_UP_MASK_W_PP2) == LINK_UP_MASK_W_PP2);
 
@@ -96,6 +96,9 @@
 
 #define log_fmt(fmt, ...) "pf_pp2#%d: " fmt, nmnicpf->pf_id, ##__VA_ARGS__
 
+#include <poll.h>
+#include <time.h>
+
 #include "std_internal.h"
 
 #include "mng/lf/lf_mng.h"
@@ -107,6 +110,8 @@
 
 /* Maximum size of port name */
 #define NMP_PPIO_NAME_MAX			20
+/* Time the PP2 link must hold a new state before it is reported to the host */
+#define NMP_PPIO_LINK_DEBOUNCE_MS		50
 
 
 static int nmnicpf_pp2_find_free_cls_table(struct nmnicpf *nmnicpf)
@@ -442,6 +447,87 @@ init_bpools_err:
 	return err;
 }
 
+static void nmnicpf_pp2_link_change_cb(void *arg, struct pp2_ppio *ppio, int link_up)
+{
+	struct nmnicpf *nmnicpf = (struct nmnicpf *)arg;
+
+	pr_debug("PP2 link changed to %d\n", link_up);
+	if (link_up)
+		nmnicpf->link_up_mask |= LINK_UP_MASK_LOCAL_PP2;
+	else
+		nmnicpf->link_up_mask &= ~LINK_UP_MASK_LOCAL_PP2;
+}
+
+/* Get the PP2 link changes notified instead of polling the link state */
+static int nmnicpf_pp2_link_event_init(struct nmnicpf *nmnicpf, struct pp2_ppio *ppio)
+{
+	struct pp2_ppio_link_event_params params;
+	int err, fd, link;
+
+	err = pp2_ppio_get_link_state(ppio, &link);
+	if (err) {
+		pr_err("PP-IO link state get failed (error: %d)!\n", err);
+		return err;
+	}
+	nmnicpf_pp2_link_change_cb(nmnicpf, ppio, link);
+
+	nmnicpf->pp2_link_evt_fd = -1;
+	nmnicpf->pp2_link_evt_expiry = 0;
+	params.debounce_ms = NMP_PPIO_LINK_DEBOUNCE_MS;
+	params.cb = nmnicpf_pp2_link_change_cb;
+	params.arg = nmnicpf;
+	err = pp2_ppio_link_event_register(ppio, &params, &fd);
+	if (err) {
+		/* Not fatal: the link state is polled instead */
+		pr_warn("PP-IO link notification not available (error: %d)\n", err);
+		return 0;
+	}
+	nmnicpf->pp2_link_evt_fd = fd;
+	nmnicpf->pp2_link_evt = 1;
+	return 0;
+}
+
+static u64 nmnicpf_pp2_now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Process the PP2 link events, only when the notification fd is readable or
+ * the timeout returned by the previous processing (debounce) has expired.
+ * Without an fd, the events are processed on every call.
+ */
+int nmnicpf_pp2_link_event_process(struct nmnicpf *nmnicpf, struct pp2_ppio *ppio)
+{
+	struct pollfd pfd;
+	u64 now;
+	int err, timeout;
+
+	now = nmnicpf_pp2_now_ms();
+	if (nmnicpf->pp2_link_evt_fd >= 0 &&
+	    !(nmnicpf->pp2_link_evt_expiry && now >= nmnicpf->pp2_link_evt_expiry)) {
+		pfd.fd = nmnicpf->pp2_link_evt_fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		err = poll(&pfd, 1, 0);
+		if (err < 0 && errno != EINTR) {
+			pr_err("PP2 link event poll failed (errno: %d)\n", errno);
+			return -errno;
+		}
+		if (err <= 0)
+			/* Nothing pending */
+			return 0;
+	}
+
+	err = pp2_ppio_link_event_process(ppio, &timeout);
+	if (err)
+		return err;
+	nmnicpf->pp2_link_evt_expiry = (timeout < 0) ? 0 : now + timeout;
+	return 0;
+}
+
 int nmnicpf_pp2_init_ppio(struct nmnicpf *nmnicpf)
 {
 	struct pp2_ppio_params		 port_params;
@@ -517,7 +603,7 @@ int nmnicpf_pp2_init_ppio(struct nmnicpf *nmnicpf)
 		return -EIO;
 	}
 
-	return 0;
+	return nmnicpf_pp2_link_event_init(nmnicpf, pdesc->ppio);
 }
 
 int nmnicpf_pp2_accumulate_statistics(struct nmnicpf *nmnicpf,
@@ -113,6 +113,7 @@ int nmnicpf_pp2_accumulate_statistics(struct nmnicpf *nmnicpf,
 				      struct pp2_ppio_statistics *stats,
 				      int    reset);
 void nmnicpf_pp2_get_mac_addr(struct nmnicpf *nmnicpf, u8 *mac_addr);
+int nmnicpf_pp2_link_event_process(struct nmnicpf *nmnicpf, struct pp2_ppio *ppio);
 
 int nmnicpf_pp2_cls_table_init(struct nmnicpf *nmnicpf,
 			       void *msg,
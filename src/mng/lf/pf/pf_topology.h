@@ -218,6 +218,9 @@ struct nmnicpf {
 #define LINK_UP_MASK_W_PP2	(LINK_UP_MASK | LINK_UP_MASK_LOCAL_PP2)
 	u8				 link_up_mask;
 	int				 last_link_state;
+	int				 pp2_link_evt;	/* PP2 link changes are notified */
+	int				 pp2_link_evt_fd; /* readable on PP2 link events; -1 if none */
+	u64				 pp2_link_evt_expiry; /* ms; link events to be processed; 0 if none */
 	u8				 plat_bar_indx;
 	struct msix_table_entry		*msix_table_base;
 	struct sys_iomem		*sys_iomem;	/* musdk iomem handle. */
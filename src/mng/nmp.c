@@ -103,6 +103,7 @@
 #include "lf/lf_mng.h"
 #include "lf/pf/pf.h"
 #include "config.h"
+#include "lib/mv_json.h"
 
 
 #define SCHED_MAX_MNG_ELEMENTS		10
@@ -198,16 +199,164 @@ int nmp_set_scheduling_event(struct mv_sys_event *ev, int en)
 	return lf_mng_set_scheduling_event(ev, en);
 }
 
+/* Read an optional number member: a missing one keeps its default, a malformed one fails */
+#define nmp_cfg_get_num(json, obj, key, _p)					\
+({										\
+	int __rc = mv_json_obj_get_num(json, obj, key, _p);			\
+	(__rc == -ENOENT) ? 0 : __rc;						\
+})
+
+static int nmp_read_cfg_lcl_bpools(struct mv_json *json, int sec, u8 num_bpools,
+				   struct nmp_lf_bpool_params *bpools_params)
+{
+	char	tmp_buf[NMP_MAX_BUF_STR_LEN];
+	int	bp_sec;
+	u32	k;
+
+	for (k = 0; k < num_bpools; k++) {
+		snprintf(tmp_buf, sizeof(tmp_buf), "lcl_bpools_params-%d", k);
+		bp_sec = mv_json_find(json, sec, tmp_buf);
+		if (bp_sec < 0) {
+			pr_err("'%s' not found\n", tmp_buf);
+			return -EINVAL;
+		}
+
+		if (nmp_cfg_get_num(json, bp_sec, "max_num_buffs", bpools_params[k].max_num_buffs))
+			return -EINVAL;
+		if (!bpools_params[k].max_num_buffs) {
+			pr_err("missing max_num_buffs!\n");
+			return -EINVAL;
+		}
+
+		if (nmp_cfg_get_num(json, bp_sec, "buff_size", bpools_params[k].buff_size))
+			return -EINVAL;
+		if (!bpools_params[k].buff_size) {
+			pr_err("missing buff_size!\n");
+			return -EINVAL;
+		}
+	}
+	return 0;
+}
+
+/* Read the parameters common to nicpf and nicvf sections */
+#define nmp_read_cfg_nic(json, sec, nic, name)					\
+({										\
+	int __rc = -EINVAL;							\
+										\
+	if (mv_json_obj_get_str(json, sec, "match", (nic)->match, NMP_MAX_BUF_STR_LEN))	\
+		pr_err("'match' not found\n");					\
+	else if (nmp_cfg_get_num(json, sec, "keep_alive_thresh", (nic)->keep_alive_thresh) ||	\
+		 nmp_cfg_get_num(json, sec, "pci_en", (nic)->pci_en) ||		\
+		 nmp_cfg_get_num(json, sec, "sg_en", (nic)->sg_en) ||		\
+		 nmp_cfg_get_num(json, sec, "lcl_egress_qs_size", (nic)->lcl_egress_qs_size) ||	\
+		 nmp_cfg_get_num(json, sec, "lcl_ingress_qs_size", (nic)->lcl_ingress_qs_size) ||	\
+		 nmp_cfg_get_num(json, sec, "lcl_egress_num_qs", (nic)->lcl_egress_num_qs) ||	\
+		 nmp_cfg_get_num(json, sec, "lcl_ingress_num_qs", (nic)->lcl_ingress_num_qs) ||	\
+		 nmp_cfg_get_num(json, sec, "dflt_pkt_offset", (nic)->dflt_pkt_offset) ||	\
+		 nmp_cfg_get_num(json, sec, "max_num_tcs", (nic)->max_num_tcs) ||	\
+		 nmp_cfg_get_num(json, sec, "lcl_num_bpools", (nic)->lcl_num_bpools))	\
+		pr_err("%s: invalid parameter\n", name);			\
+	else if (nmp_range_validate((nic)->pci_en, 0, 1) != 0)			\
+		pr_err("pci_en not in range!\n");				\
+	else if (!(nic)->lcl_egress_qs_size)					\
+		pr_err("missing lcl_egress_qs_size!\n");			\
+	else if (!(nic)->lcl_ingress_qs_size)					\
+		pr_err("missing lcl_ingress_qs_size!\n");			\
+	else if (nmp_range_validate((nic)->lcl_egress_num_qs, 1, NMP_LF_TC_MAX_NUM_QS) != 0)	\
+		pr_err("lcl_egress_num_qs out of range!\n");			\
+	else if (nmp_range_validate((nic)->lcl_ingress_num_qs, 1, NMP_LF_TC_MAX_NUM_QS) != 0)	\
+		pr_err("lcl_ingress_num_qs out of range!\n");			\
+	else if (nmp_range_validate((nic)->dflt_pkt_offset, 0, 1024) != 0)	\
+		pr_err("missing dflt_pkt_offset!\n");				\
+	else if (nmp_range_validate((nic)->max_num_tcs, 0, NMP_LF_MAX_NUM_TCS) != 0)	\
+		pr_err("missing max_num_tcs!\n");				\
+	else if (nmp_range_validate((nic)->lcl_num_bpools, 0, NMP_LF_MAX_NUM_LCL_BPOOLS) != 0)	\
+		pr_err("missing lcl_num_bpools!\n");				\
+	else									\
+		__rc = nmp_read_cfg_lcl_bpools(json, sec, (nic)->lcl_num_bpools,	\
+					       (nic)->lcl_bpools_params);	\
+	__rc;									\
+})
+
+static int nmp_read_cfg_pp2_port(struct mv_json *json, int sec, struct nmp_lf_nicpf_pp2_port_params *pp2_port)
+{
+	char	tmp_buf[NMP_MAX_BUF_STR_LEN];
+	int	port_sec, bp_sec;
+	u32	k;
+
+	port_sec = mv_json_find(json, sec, "port-params-pp2-port");
+	if (port_sec < 0) {
+		pr_err("'port-params-pp2-port' not found\n");
+		return -EINVAL;
+	}
+
+	if (mv_json_obj_get_str(json, port_sec, "match", pp2_port->match, NMP_MAX_BUF_STR_LEN)) {
+		pr_err("'pp2 match' not found\n");
+		return -EINVAL;
+	}
+
+	if (nmp_cfg_get_num(json, port_sec, "lcl_num_bpools", pp2_port->lcl_num_bpools) ||
+	    nmp_range_validate(pp2_port->lcl_num_bpools, 1, NMP_LF_MAX_NUM_LCL_BPOOLS) != 0)
+		return -EINVAL;
+
+	for (k = 0; k < pp2_port->lcl_num_bpools; k++) {
+		struct nmp_lf_bpool_params *lcl_bpools_params = &pp2_port->lcl_bpools_params[k];
+
+		snprintf(tmp_buf, sizeof(tmp_buf), "lcl_bpools_params-%d", k);
+		bp_sec = mv_json_find(json, port_sec, tmp_buf);
+		if (bp_sec < 0) {
+			pr_err("'%s' not found\n", tmp_buf);
+			return -EINVAL;
+		}
+
+		if (nmp_cfg_get_num(json, bp_sec, "max_num_buffs", lcl_bpools_params->max_num_buffs) ||
+		    nmp_cfg_get_num(json, bp_sec, "buff_size", lcl_bpools_params->buff_size) ||
+		    nmp_range_validate(lcl_bpools_params->buff_size, 0, 4096) != 0)
+			return -EINVAL;
+	}
+	return 0;
+}
+
+static int nmp_read_cfg_dma_engines(struct mv_json *json, int sec, const char *type,
+				    struct nmp_giu_eng_type_params *eng_type_params)
+{
+	char	tmp_buf[NMP_MAX_BUF_STR_LEN];
+	u32	i;
+
+	eng_type_params->num_dma_engines = GIU_MAX_ENG_PER_TYPE;
+	snprintf(tmp_buf, sizeof(tmp_buf), "num-%s", type);
+	if (nmp_cfg_get_num(json, sec, tmp_buf, eng_type_params->num_dma_engines) ||
+	    nmp_range_validate(eng_type_params->num_dma_engines, 0, GIU_MAX_ENG_PER_TYPE) != 0) {
+		pr_err("missing %s!\n", tmp_buf);
+		return -EINVAL;
+	}
+	for (i = 0; i < eng_type_params->num_dma_engines; i++) {
+		snprintf(tmp_buf, sizeof(tmp_buf), "%s-%d", type, i);
+		if (mv_json_obj_get_str(json, sec, tmp_buf, eng_type_params->engine_name[i],
+					sizeof(eng_type_params->engine_name[i]))) {
+			pr_err("'dma_engines' section: '%s' engine not found\n", tmp_buf);
+			return -EINVAL;
+		}
+		if (strncmp(eng_type_params->engine_name[i], "dmax2-", strlen("dmax2-"))) {
+			pr_err("dma engine name should start with 'dmax2-'\n");
+			return -EINVAL;
+		}
+	}
+	return 0;
+}
+
 int nmp_read_cfg_file(char *cfg_file, struct nmp_params *params)
 {
-	u32				 i, j, k, rc;
+	u32				 i, j;
+	int				 rc;
 	char				 buff[SER_MAX_FILE_SIZE];
-	char				*sec = NULL;
+	struct mv_json			 json;
+	int				 sec, cont_sec, lf_sec, nic_sec;
 	char				 tmp_buf[NMP_MAX_BUF_STR_LEN];
 	char				 pp2_name[NMP_MAX_BUF_STR_LEN], giu_name[NMP_MAX_NUM_LFS][NMP_MAX_BUF_STR_LEN];
+	struct nmp_container_params	*cont;
 	struct nmp_lf_nicpf_params	*pf;
 	struct nmp_lf_nicvf_params	*vf;
-	struct nmp_giu_eng_type_params	*eng_type_params;
 
 	/* cfg-file must be provided, read the nmp-config from this location. */
 	rc = read_file_to_buf(cfg_file, buff, SER_MAX_FILE_SIZE);
@@ -216,192 +365,119 @@ int nmp_read_cfg_file(char *cfg_file, struct nmp_params *params)
 		return rc;
 	}
 
-	/* Check if there are nmp-params */
-	sec = strstr(buff, "nmp_params");
-	if (!sec) {
-		pr_err("nmp_params section not found!\n");
-		return -EINVAL;
+	rc = mv_json_init(&json, buff);
+	if (rc) {
+		pr_err("nmp config-file (%s) is malformed!\n", cfg_file);
+		return rc;
 	}
 
 	memset(params, 0, sizeof(struct nmp_params));
 
+	/* Check if there are nmp-params */
+	sec = mv_json_find(&json, MV_JSON_ROOT, "nmp_params");
+	if (sec < 0) {
+		pr_err("nmp_params section not found!\n");
+		rc = -EINVAL;
+		goto read_cfg_exit0;
+	}
+
 	/* Check if pp2 is enabled */
-	json_buffer_to_input(sec, "pp2_en", params->pp2_en);
-	if (nmp_range_validate(params->pp2_en, 0, 1) != 0) {
+	if (nmp_cfg_get_num(&json, sec, "pp2_en", params->pp2_en) ||
+	    nmp_range_validate(params->pp2_en, 0, 1) != 0) {
 		pr_err("pp2_en not in tange!\n");
-		return -EINVAL;
+		rc = -EINVAL;
+		goto read_cfg_exit0;
 	}
 
 	/* if pp2 enabled, set the pp2_params*/
 	if (params->pp2_en) {
-		if (strstr(sec, "pp2_params")) {
-			sec = strstr(sec, "pp2_params");
-			json_buffer_to_input(sec, "bm_pool_reserved_map",
-				params->pp2_params.bm_pool_reserved_map);
-			if (nmp_range_validate(params->pp2_params.bm_pool_reserved_map,
-				0,
-				((1 << PP2_BPOOL_NUM_POOLS) - 1))) {
-				pr_err("bm_pool_reserved_map not in range!\n");
-				rc = -EINVAL;
-				goto read_cfg_exit1;
-			}
+		int pp2_sec = mv_json_find(&json, sec, "pp2_params");
+
+		if (pp2_sec >= 0 &&
+		    (nmp_cfg_get_num(&json, pp2_sec, "bm_pool_reserved_map",
+				     params->pp2_params.bm_pool_reserved_map) ||
+		     nmp_range_validate(params->pp2_params.bm_pool_reserved_map,
+					0, ((1 << PP2_BPOOL_NUM_POOLS) - 1)))) {
+			pr_err("bm_pool_reserved_map not in range!\n");
+			rc = -EINVAL;
+			goto read_cfg_exit0;
 		}
 	}
 
 	/* Read number of containers */
-	json_buffer_to_input(sec, "num_containers", params->num_containers);
-	if (nmp_range_validate(params->num_containers, 1, NMP_MAX_NUM_CONTAINERS)) {
+	if (nmp_cfg_get_num(&json, sec, "num_containers", params->num_containers) ||
+	    nmp_range_validate(params->num_containers, 1, NMP_MAX_NUM_CONTAINERS)) {
 		pr_err("num_containers not in range!\n");
 		rc = -EINVAL;
-		goto read_cfg_exit1;
+		goto read_cfg_exit0;
 	}
 
 	params->containers_params = kcalloc(1, sizeof(struct nmp_container_params) *
 					    params->num_containers, GFP_KERNEL);
 	if (params->containers_params == NULL) {
 		rc = -ENOMEM;
-		goto read_cfg_exit1;
+		goto read_cfg_exit0;
 	}
 
 	for (i = 0; i < params->num_containers; i++) {
-		memset(tmp_buf, 0, sizeof(tmp_buf));
+		cont = &params->containers_params[i];
+
 		snprintf(tmp_buf, sizeof(tmp_buf), "containers_params-%d", i);
-		sec = strstr(sec, tmp_buf);
-		if (!sec) {
-			pr_err("'containers_params' not found\n");
+		cont_sec = mv_json_find(&json, sec, tmp_buf);
+		if (cont_sec < 0) {
+			pr_err("'%s' not found\n", tmp_buf);
 			rc = -EINVAL;
-			goto read_cfg_exit1;
+			goto read_cfg_exit2;
 		}
 		/* Read number of lfs */
-		json_buffer_to_input(sec, "num_lfs", params->containers_params[i].num_lfs);
-		if (nmp_range_validate(params->containers_params[i].num_lfs, 1, NMP_MAX_NUM_LFS) != 0) {
+		if (nmp_cfg_get_num(&json, cont_sec, "num_lfs", cont->num_lfs) ||
+		    nmp_range_validate(cont->num_lfs, 1, NMP_MAX_NUM_LFS) != 0) {
 			pr_err("num_lfs not in range!\n");
 			rc = -EINVAL;
-			goto read_cfg_exit1;
+			goto read_cfg_exit2;
 		}
 
-		params->containers_params[i].lfs_params = kcalloc(1, sizeof(struct nmp_lf_params) *
-								params->containers_params[i].num_lfs, GFP_KERNEL);
-		if (params->containers_params[i].lfs_params == NULL) {
+		cont->lfs_params = kcalloc(1, sizeof(struct nmp_lf_params) * cont->num_lfs, GFP_KERNEL);
+		if (cont->lfs_params == NULL) {
 			rc = -ENOMEM;
 			goto read_cfg_exit2;
 		}
 
-		for (j = 0; j < params->containers_params[i].num_lfs; j++) {
-			memset(tmp_buf, 0, sizeof(tmp_buf));
+		for (j = 0; j < cont->num_lfs; j++) {
 			snprintf(tmp_buf, sizeof(tmp_buf), "lf_params-%d", j);
-			sec = strstr(sec, tmp_buf);
-			if (!sec) {
-				pr_err("'lf_params-%d' not found\n", j);
+			lf_sec = mv_json_find(&json, cont_sec, tmp_buf);
+			if (lf_sec < 0) {
+				pr_err("'%s' not found\n", tmp_buf);
 				rc = -EINVAL;
 				goto read_cfg_exit2;
 			}
 
 			/* Read lf type*/
-			json_buffer_to_input(sec, "lf_type", params->containers_params[i].lfs_params[j].type);
-			if (nmp_range_validate(params->containers_params[i].lfs_params[j].type,
+			if (nmp_cfg_get_num(&json, lf_sec, "lf_type", cont->lfs_params[j].type) ||
+			    nmp_range_validate(cont->lfs_params[j].type,
 					       NMP_LF_T_NIC_NONE, NMP_LF_T_NIC_LAST - 1) != 0) {
 				pr_err("lf_type not in range!\n");
 				rc = -EINVAL;
 				goto read_cfg_exit2;
 			}
 
-			if (params->containers_params[i].lfs_params[j].type == NMP_LF_T_NIC_PF) {
+			if (cont->lfs_params[j].type == NMP_LF_T_NIC_PF) {
 				/* Read nicpf*/
-				pf = (struct nmp_lf_nicpf_params *)
-				     &params->containers_params[i].lfs_params[j].u.nicpf;
-
-				pf->match = &giu_name[j][0];
-				json_buffer_to_input_str(sec, "match", pf->match);
-
-				json_buffer_to_input(sec, "keep_alive_thresh", pf->keep_alive_thresh);
-
-				json_buffer_to_input(sec, "pci_en", pf->pci_en);
-				if (nmp_range_validate(pf->pci_en, 0, 1) != 0) {
-					pr_err("pci_en not in range!\n");
-					rc = -EINVAL;
-					goto read_cfg_exit2;
-				}
-
-				json_buffer_to_input(sec, "sg_en", pf->sg_en);
-
-				json_buffer_to_input(sec, "lcl_egress_qs_size", pf->lcl_egress_qs_size);
-				if (!pf->lcl_egress_qs_size) {
-					pr_err("missing lcl_egress_qs_size!\n");
-					rc = -EINVAL;
-					goto read_cfg_exit2;
-				}
-
-				json_buffer_to_input(sec, "lcl_ingress_qs_size", pf->lcl_ingress_qs_size);
-				if (!pf->lcl_ingress_qs_size) {
-					pr_err("missing lcl_ingress_qs_size!\n");
-					rc = -EINVAL;
-					goto read_cfg_exit2;
-				}
-
-				json_buffer_to_input(sec, "lcl_egress_num_qs", pf->lcl_egress_num_qs);
-				if (nmp_range_validate(pf->lcl_egress_num_qs, 1, NMP_LF_TC_MAX_NUM_QS) != 0) {
-					pr_err("lcl_egress_num_qs out of range!\n");
-					rc = -EINVAL;
-					goto read_cfg_exit2;
-				}
-
-				json_buffer_to_input(sec, "lcl_ingress_num_qs", pf->lcl_ingress_num_qs);
-				if (nmp_range_validate(pf->lcl_ingress_num_qs, 1, NMP_LF_TC_MAX_NUM_QS) != 0) {
-					pr_err("lcl_ingress_num_qs out of range!\n");
-					rc = -EINVAL;
-					goto read_cfg_exit2;
-				}
-
-				json_buffer_to_input(sec, "dflt_pkt_offset", pf->dflt_pkt_offset);
-				if (nmp_range_validate(pf->dflt_pkt_offset, 0, 1024) != 0) {
-					pr_err("missing dflt_pkt_offset!\n");
-					rc = -EINVAL;
-					goto read_cfg_exit2;
-				}
-
-				json_buffer_to_input(sec, "max_num_tcs", pf->max_num_tcs);
-				if (nmp_range_validate(pf->max_num_tcs, 0, NMP_LF_MAX_NUM_TCS) != 0) {
-					pr_err("missing max_num_tcs!\n");
+				pf = &cont->lfs_params[j].u.nicpf;
+				nic_sec = mv_json_find(&json, lf_sec, "nicpf");
+				if (nic_sec < 0) {
+					pr_err("'nicpf' section not found\n");
 					rc = -EINVAL;
 					goto read_cfg_exit2;
 				}
 
-				json_buffer_to_input(sec, "lcl_num_bpools", pf->lcl_num_bpools);
-				if (nmp_range_validate(pf->lcl_num_bpools, 0, NMP_LF_MAX_NUM_LCL_BPOOLS) != 0) {
-					pr_err("missing lcl_num_bpools!\n");
-					rc = -EINVAL;
+				pf->match = &giu_name[j][0];
+				rc = nmp_read_cfg_nic(&json, nic_sec, pf, "nicpf");
+				if (rc)
 					goto read_cfg_exit2;
-				}
 
-				for (k = 0; k < pf->lcl_num_bpools; k++) {
-					memset(tmp_buf, 0, sizeof(tmp_buf));
-					snprintf(tmp_buf, sizeof(tmp_buf), "lcl_bpools_params-%d", k);
-					sec = strstr(sec, tmp_buf);
-					if (!sec) {
-						pr_err("'lcl_bpools_params' not found\n");
-						rc = -EINVAL;
-						goto read_cfg_exit2;
-					}
-
-					json_buffer_to_input(sec, "max_num_buffs",
-							     pf->lcl_bpools_params[k].max_num_buffs);
-					if (!pf->lcl_bpools_params[k].max_num_buffs) {
-						pr_err("missing max_num_buffs!\n");
-						rc = -EINVAL;
-						goto read_cfg_exit2;
-					}
-
-					json_buffer_to_input(sec, "buff_size", pf->lcl_bpools_params[k].buff_size);
-					if (!pf->lcl_bpools_params[k].buff_size) {
-						pr_err("missing buff_size!\n");
-						rc = -EINVAL;
-						goto read_cfg_exit2;
-					}
-				}
-
-				json_buffer_to_input(sec, "nicpf_type", pf->type);
-				if (nmp_range_validate(pf->type, NMP_LF_NICPF_T_NONE,
+				if (nmp_cfg_get_num(&json, nic_sec, "nicpf_type", pf->type) ||
+				    nmp_range_validate(pf->type, NMP_LF_NICPF_T_NONE,
 						       NMP_LF_NICPF_T_LAST - 1) != 0) {
 					pr_err("nicpf_type not in range!\n");
 					rc = -EINVAL;
@@ -411,240 +487,60 @@ int nmp_read_cfg_file(char *cfg_file, struct nmp_params *params)
 				if (pf->type != NMP_LF_NICPF_T_PP2_PORT)
 					continue;
 
-				sec = strstr(sec, "port-params-pp2-port");
-				if (!sec) {
-					pr_err("'port-params-pp2-port' not found\n");
-					return -EINVAL;
-				}
-
 				pf->port_params.pp2_port.match = pp2_name;
-				json_buffer_to_input_str(sec, "match", pf->port_params.pp2_port.match);
-				if (!pf->port_params.pp2_port.match) {
-					pr_err("'pp2 match' not found\n");
-					return -EINVAL;
-				}
-
-				json_buffer_to_input(sec, "lcl_num_bpools", pf->port_params.pp2_port.lcl_num_bpools);
-				if (nmp_range_validate(pf->port_params.pp2_port.lcl_num_bpools,
-						       1, NMP_LF_MAX_NUM_LCL_BPOOLS) != 0)
-					return -EINVAL;
-
-				for (k = 0; k < pf->port_params.pp2_port.lcl_num_bpools; k++) {
-					struct nmp_lf_bpool_params *lcl_bpools_params =
-						&pf->port_params.pp2_port.lcl_bpools_params[k];
-
-					memset(tmp_buf, 0, sizeof(tmp_buf));
-					snprintf(tmp_buf, sizeof(tmp_buf), "lcl_bpools_params-%d", k);
-					sec = strstr(sec, tmp_buf);
-					if (!sec) {
-						pr_err("'lcl_bpools_params' not found\n");
-						return -EINVAL;
-					}
-
-					json_buffer_to_input(sec, "max_num_buffs",
-							lcl_bpools_params->max_num_buffs);
-					if (nmp_range_validate(pf->port_params.pp2_port.lcl_num_bpools,
-							       0, 4096) != 0) {
-						return -EINVAL;
-					}
-
-					json_buffer_to_input(sec, "buff_size", lcl_bpools_params->buff_size);
-					if (nmp_range_validate(lcl_bpools_params->buff_size, 0, 4096) != 0)
-						return -EINVAL;
-				}
-			} else if (params->containers_params[i].lfs_params[j].type == NMP_LF_T_NIC_VF) {
-				/* Read nicvf*/
-				vf = (struct nmp_lf_nicvf_params *)
-				     &params->containers_params[i].lfs_params[j].u.nicvf;
-
-				vf->match = &giu_name[j][0];
-				json_buffer_to_input_str(sec, "match", vf->match);
-
-				json_buffer_to_input(sec, "keep_alive_thresh", vf->keep_alive_thresh);
-
-				json_buffer_to_input(sec, "pci_en", vf->pci_en);
-				if (nmp_range_validate(vf->pci_en, 0, 1) != 0) {
-					pr_err("pci_en not in range!\n");
-					rc = -EINVAL;
-					goto read_cfg_exit2;
-				}
-
-				json_buffer_to_input(sec, "sg_en", vf->sg_en);
-
-				json_buffer_to_input(sec, "lcl_egress_qs_size", vf->lcl_egress_qs_size);
-				if (!vf->lcl_egress_qs_size) {
-					pr_err("missing lcl_egress_qs_size!\n");
-					rc = -EINVAL;
-					goto read_cfg_exit2;
-				}
-
-				json_buffer_to_input(sec, "lcl_ingress_qs_size", vf->lcl_ingress_qs_size);
-				if (!vf->lcl_ingress_qs_size) {
-					pr_err("missing lcl_ingress_qs_size!\n");
-					rc = -EINVAL;
-					goto read_cfg_exit2;
-				}
-
-				json_buffer_to_input(sec, "lcl_egress_num_qs", vf->lcl_egress_num_qs);
-				if (nmp_range_validate(vf->lcl_egress_num_qs, 1, NMP_LF_TC_MAX_NUM_QS) != 0) {
-					pr_err("lcl_egress_num_qs out of range!\n");
-					rc = -EINVAL;
-					goto read_cfg_exit2;
-				}
-
-				json_buffer_to_input(sec, "lcl_ingress_num_qs", vf->lcl_ingress_num_qs);
-				if (nmp_range_validate(vf->lcl_ingress_num_qs, 1, NMP_LF_TC_MAX_NUM_QS) != 0) {
-					pr_err("lcl_ingress_num_qs out of range!\n");
-					rc = -EINVAL;
+				rc = nmp_read_cfg_pp2_port(&json, nic_sec, &pf->port_params.pp2_port);
+				if (rc)
 					goto read_cfg_exit2;
-				}
-
-				json_buffer_to_input(sec, "dflt_pkt_offset", vf->dflt_pkt_offset);
-				if (nmp_range_validate(vf->dflt_pkt_offset, 0, 1024) != 0) {
-					pr_err("missing dflt_pkt_offset!\n");
-					rc = -EINVAL;
-					goto read_cfg_exit2;
-				}
-
-				json_buffer_to_input(sec, "max_num_tcs", vf->max_num_tcs);
-				if (nmp_range_validate(vf->max_num_tcs, 0, NMP_LF_MAX_NUM_TCS) != 0) {
-					pr_err("missing max_num_tcs!\n");
+			} else if (cont->lfs_params[j].type == NMP_LF_T_NIC_VF) {
+				/* Read nicvf*/
+				vf = &cont->lfs_params[j].u.nicvf;
+				nic_sec = mv_json_find(&json, lf_sec, "nicvf");
+				if (nic_sec < 0) {
+					pr_err("'nicvf' section not found\n");
 					rc = -EINVAL;
 					goto read_cfg_exit2;
 				}
 
-				json_buffer_to_input(sec, "lcl_num_bpools", vf->lcl_num_bpools);
-				if (nmp_range_validate(vf->lcl_num_bpools, 0, NMP_LF_MAX_NUM_LCL_BPOOLS) != 0) {
-					pr_err("missing lcl_num_bpools!\n");
-					rc = -EINVAL;
+				vf->match = &giu_name[j][0];
+				rc = nmp_read_cfg_nic(&json, nic_sec, vf, "nicvf");
+				if (rc)
 					goto read_cfg_exit2;
-				}
-
-				for (k = 0; k < vf->lcl_num_bpools; k++) {
-					memset(tmp_buf, 0, sizeof(tmp_buf));
-					snprintf(tmp_buf, sizeof(tmp_buf), "lcl_bpools_params-%d", k);
-					sec = strstr(sec, tmp_buf);
-					if (!sec) {
-						pr_err("'lcl_bpools_params' not found\n");
-						rc = -EINVAL;
-						goto read_cfg_exit2;
-					}
-
-					json_buffer_to_input(sec, "max_num_buffs",
-							     vf->lcl_bpools_params[k].max_num_buffs);
-					if (!vf->lcl_bpools_params[k].max_num_buffs) {
-						pr_err("missing max_num_buffs!\n");
-						rc = -EINVAL;
-						goto read_cfg_exit2;
-					}
-
-					json_buffer_to_input(sec, "buff_size", vf->lcl_bpools_params[k].buff_size);
-					if (!vf->lcl_bpools_params[k].buff_size) {
-						pr_err("missing buff_size!\n");
-						rc = -EINVAL;
-						goto read_cfg_exit2;
-					}
-				}
 			}
 		}
 
-		json_buffer_to_input(sec, "guest_id", params->containers_params[i].guest_id);
-		if (nmp_range_validate(params->containers_params[i].guest_id, 0, 10) != 0) {
+		if (nmp_cfg_get_num(&json, cont_sec, "guest_id", cont->guest_id) ||
+		    nmp_range_validate(cont->guest_id, 0, 10) != 0) {
 			rc = -EINVAL;
 			goto read_cfg_exit2;
 		}
 	}
 
 	/* Check if the optional section 'dma_engine' exists */
-	sec = strstr(sec, "dma_engines");
-	if (!sec) {
+	sec = mv_json_find(&json, sec, "dma_engines");
+	if (sec < 0) {
 		pr_err("'dma_engines' section must be set\n");
 		rc = -EINVAL;
 		goto read_cfg_exit2;
 	}
-	/* MNG */
-	eng_type_params = &params->giu_eng_params.eng_type_params[GIU_ENG_MNG];
-	eng_type_params->num_dma_engines = GIU_MAX_ENG_PER_TYPE;
-	json_buffer_to_input(sec, "num-mng", eng_type_params->num_dma_engines);
-	if (nmp_range_validate(eng_type_params->num_dma_engines, 0, GIU_MAX_ENG_PER_TYPE) != 0) {
-		pr_err("missing num-mng!\n");
-		rc = -EINVAL;
-		goto read_cfg_exit2;
-	}
-	for (i = 0; i < eng_type_params->num_dma_engines; i++) {
-		memset(tmp_buf, 0, sizeof(tmp_buf));
-		snprintf(tmp_buf, sizeof(tmp_buf), "mng-%d", i);
-		json_buffer_to_input_str(sec, tmp_buf, eng_type_params->engine_name[i]);
-		if (eng_type_params->engine_name[i][0] == 0) {
-			pr_err("'dma_engines' section: '%s' engine not found\n", tmp_buf);
-			rc = -EINVAL;
-			goto read_cfg_exit2;
-		}
-		if (!strstr(eng_type_params->engine_name[i], "dmax2-")) {
-			pr_err("dma engine name should start with 'dmax2-'\n");
-			rc = -EINVAL;
-			goto read_cfg_exit2;
-		}
-	}
-
-	/* IN */
-	eng_type_params = &params->giu_eng_params.eng_type_params[GIU_ENG_IN];
-	eng_type_params->num_dma_engines = GIU_MAX_ENG_PER_TYPE;
-	json_buffer_to_input(sec, "num-in", eng_type_params->num_dma_engines);
-	if (nmp_range_validate(eng_type_params->num_dma_engines, 0, GIU_MAX_ENG_PER_TYPE) != 0) {
-		pr_err("missing num-mng!\n");
-		rc = -EINVAL;
-		goto read_cfg_exit2;
-	}
-	for (i = 0; i < eng_type_params->num_dma_engines; i++) {
-		memset(tmp_buf, 0, sizeof(tmp_buf));
-		snprintf(tmp_buf, sizeof(tmp_buf), "in-%d", i);
-		json_buffer_to_input_str(sec, tmp_buf, eng_type_params->engine_name[i]);
-		if (eng_type_params->engine_name[i][0] == 0) {
-			pr_err("'dma_engines' section: '%s' engine not found\n", tmp_buf);
-			rc = -EINVAL;
-			goto read_cfg_exit2;
-		}
-		if (!strstr(eng_type_params->engine_name[i], "dmax2-")) {
-			pr_err("dma engine name should start with 'dmax2-'\n");
-			rc = -EINVAL;
-			goto read_cfg_exit2;
-		}
-	}
-
-	/* OUT */
-	eng_type_params = &params->giu_eng_params.eng_type_params[GIU_ENG_OUT];
-	eng_type_params->num_dma_engines = GIU_MAX_ENG_PER_TYPE;
-	json_buffer_to_input(sec, "num-out", eng_type_params->num_dma_engines);
-	if (nmp_range_validate(eng_type_params->num_dma_engines, 0, GIU_MAX_ENG_PER_TYPE) != 0) {
-		pr_err("missing num-mng!\n");
-		rc = -EINVAL;
+	rc = nmp_read_cfg_dma_engines(&json, sec, "mng", &params->giu_eng_params.eng_type_params[GIU_ENG_MNG]);
+	if (!rc)
+		rc = nmp_read_cfg_dma_engines(&json, sec, "in", &params->giu_eng_params.eng_type_params[GIU_ENG_IN]);
+	if (!rc)
+		rc = nmp_read_cfg_dma_engines(&json, sec, "out",
+					      &params->giu_eng_params.eng_type_params[GIU_ENG_OUT]);
+	if (rc)
 		goto read_cfg_exit2;
-	}
-	for (i = 0; i < eng_type_params->num_dma_engines; i++) {
-		memset(tmp_buf, 0, sizeof(tmp_buf));
-		snprintf(tmp_buf, sizeof(tmp_buf), "out-%d", i);
-		json_buffer_to_input_str(sec, tmp_buf, eng_type_params->engine_name[i]);
-		if (eng_type_params->engine_name[i][0] == 0) {
-			pr_err("'dma_engines' section: '%s' engine not found\n", tmp_buf);
-			rc = -EINVAL;
-			goto read_cfg_exit2;
-		}
-		if (!strstr(eng_type_params->engine_name[i], "dmax2-")) {
-			pr_err("dma engine name should start with 'dmax2-'\n");
-			rc = -EINVAL;
-			goto read_cfg_exit2;
-		}
-	}
 
 	params->giu_eng_params.num_giu_engines = 3;
 
+	mv_json_deinit(&json);
 	return 0;
 read_cfg_exit2:
 	for (i = 0; i < params->num_containers; i++)
 		kfree(params->containers_params[i].lfs_params);
-read_cfg_exit1:
 	kfree(params->containers_params);
+read_cfg_exit0:
+	mv_json_deinit(&json);
 	return rc;
 }
 
@@ -98,6 +98,7 @@
 #include "env/mv_autogen_comp_flags.h"
 #include "dev_mng.h"
 #include "lf/mng_cmd_desc.h"
+#include "lib/mv_json.h"
 
 #include "nmp_guest.h"
 
@@ -148,50 +149,89 @@ static int nmp_guest_wait_for_guest_file(struct nmp_guest *guest)
 	return 0;
 }
 
+/* Read a queue section ("cmd-queue"/"notify-queue") of the custom-info */
+static int nmp_guest_probe_queue(struct mv_json *json, int sec, const char *name,
+				 phys_addr_t paddr, uintptr_t va, struct nmp_guest_queue *q)
+{
+	u32	base_offs, cons_offs, prod_offs;
+	int	q_sec;
+
+	q_sec = mv_json_find(json, sec, name);
+	if (q_sec < 0) {
+		pr_err("%s section not found\n", name);
+		return -EINVAL;
+	}
+
+	if (mv_json_obj_get_num(json, q_sec, "base-poffset", base_offs) ||
+	    mv_json_obj_get_num(json, q_sec, "cons-poffset", cons_offs) ||
+	    mv_json_obj_get_num(json, q_sec, "prod-poffset", prod_offs) ||
+	    mv_json_obj_get_num(json, q_sec, "len", q->len)) {
+		pr_err("%s: invalid parameters\n", name);
+		return -EINVAL;
+	}
+
+	q->base_addr_phys = (void *)(uintptr_t)(paddr + base_offs);
+	q->base_addr_virt = (struct cmd_desc *)(va + base_offs);
+	q->cons_phys = (void *)(uintptr_t)(paddr + cons_offs);
+	q->cons_virt = (u32 *)(va + cons_offs);
+	q->prod_phys = (void *)(uintptr_t)(paddr + prod_offs);
+	q->prod_virt = (u32 *)(va + prod_offs);
+	return 0;
+}
+
 static int nmp_guest_probe(struct nmp_guest *guest)
 {
-	char				*sec = NULL;
+	struct mv_json			 json;
+	int				 sec, rc;
 	struct sys_iomem_params		 iomem_params;
 	struct sys_iomem		*sys_iomem;
 	char				 dev_name[FILE_MAX_LINE_CHARS];
 	uintptr_t			 va;
-	phys_addr_t			 paddr;
+	phys_addr_t			 paddr = 0;
 	size_t				 reg_size = 0;
-	u32				 poffset = 0;
-	char				*tmp_buff;
 
-	tmp_buff = kcalloc(1, strlen(guest->prb_str), GFP_KERNEL);
-	if (tmp_buff == NULL)
-		return -ENOMEM;
-
-	memcpy(tmp_buff, guest->prb_str, strlen(guest->prb_str));
+	rc = mv_json_init(&json, guest->prb_str);
+	if (rc)
+		return rc;
 
-	sec = strstr(tmp_buff, "dma-info");
-	if (!sec) {
+	rc = -EINVAL;
+	sec = mv_json_find(&json, MV_JSON_ROOT, "dma-info");
+	if (sec < 0) {
 		pr_err("'dma-info' not found\n");
-		return -EINVAL;
+		goto probe_exit;
 	}
 
-	memset(dev_name, 0, FILE_MAX_LINE_CHARS);
 	/* get the master DMA device name */
-	json_buffer_to_input_str(sec, "file_name", dev_name);
-	if (dev_name[0] == 0) {
+	if (mv_json_obj_get_str(&json, sec, "file_name", dev_name, sizeof(dev_name))) {
 		pr_err("'file_name' not found\n");
-		return -EINVAL;
+		goto probe_exit;
 	}
 
 	/* get the master DMA region size */
-	json_buffer_to_input(sec, "region_size", reg_size);
+	mv_json_obj_get_num(&json, sec, "region_size", reg_size);
 	if (reg_size == 0) {
 		pr_err("reg_size is 0\n");
-		return -EINVAL;
+		goto probe_exit;
 	}
 
 	/* get the master DMA physical address */
-	json_buffer_to_input(sec, "phys_addr", paddr);
+	mv_json_obj_get_num(&json, sec, "phys_addr", paddr);
 	if (!paddr) {
 		pr_err("'phys_addr' not found\n");
-		return -EINVAL;
+		goto probe_exit;
+	}
+
+	/* Search for the custom-info section */
+	sec = mv_json_find(&json, MV_JSON_ROOT, "custom-info");
+	if (sec < 0) {
+		pr_err("custom-info section not found\n");
+		goto probe_exit;
+	}
+
+	if (mv_json_obj_get_num(&json, sec, "lf-master-id", guest->lf_master_id) ||
+	    mv_json_obj_get_num(&json, sec, "max-msg-len", guest->max_msg_len)) {
+		pr_err("custom-info: invalid parameters\n");
+		goto probe_exit;
 	}
 
 	iomem_params.type = SYS_IOMEM_T_SHMEM;
@@ -201,7 +241,7 @@ static int nmp_guest_probe(struct nmp_guest *guest)
 
 	if (sys_iomem_init(&iomem_params, &sys_iomem)) {
 		pr_err("sys_iomem_init error\n");
-		return -EINVAL;
+		goto probe_exit;
 	}
 
 	/* Map the iomem physical address */
@@ -209,52 +249,13 @@ static int nmp_guest_probe(struct nmp_guest *guest)
 			  (void **)&va)) {
 		pr_err("sys_iomem_map error\n");
 		sys_iomem_deinit(sys_iomem);
-		return -EINVAL;
+		goto probe_exit;
 	}
 
-	/* Search for the custom-info section */
-	sec = strstr(sec, "custom-info");
-	if (!sec) {
-		pr_err("custom-info section not found\n");
-		return -EINVAL;
-	}
-
-	json_buffer_to_input(sec, "lf-master-id", guest->lf_master_id);
-	json_buffer_to_input(sec, "max-msg-len", guest->max_msg_len);
-
-	sec = strstr(sec, "cmd-queue");
-	if (!sec) {
-		pr_err("cmd-queue section not found\n");
-		return -EINVAL;
-	}
-
-	json_buffer_to_input(sec, "base-poffset", poffset);
-	guest->cmd_queue.base_addr_phys = (void *)(uintptr_t)(paddr + poffset);
-	guest->cmd_queue.base_addr_virt = (struct cmd_desc *)(va + poffset);
-	json_buffer_to_input(sec, "cons-poffset", poffset);
-	guest->cmd_queue.cons_phys = (void *)(uintptr_t)(paddr + poffset);
-	guest->cmd_queue.cons_virt = (u32 *)(va + poffset);
-	json_buffer_to_input(sec, "prod-poffset", poffset);
-	guest->cmd_queue.prod_phys = (void *)(uintptr_t)(paddr + poffset);
-	guest->cmd_queue.prod_virt = (u32 *)(va + poffset);
-	json_buffer_to_input(sec, "len", guest->cmd_queue.len);
-
-	sec = strstr(sec, "notify-queue");
-	if (!sec) {
-		pr_err("cmd-queue section not found\n");
-		return -EINVAL;
-	}
-
-	json_buffer_to_input(sec, "base-poffset", poffset);
-	guest->notify_queue.base_addr_phys = (void *)(uintptr_t)(paddr + poffset);
-	guest->notify_queue.base_addr_virt = (struct cmd_desc *)(va + poffset);
-	json_buffer_to_input(sec, "cons-poffset", poffset);
-	guest->notify_queue.cons_phys = (void *)(uintptr_t)(paddr + poffset);
-	guest->notify_queue.cons_virt = (u32 *)(va + poffset);
-	json_buffer_to_input(sec, "prod-poffset", poffset);
-	guest->notify_queue.prod_phys = (void *)(uintptr_t)(paddr + poffset);
-	guest->notify_queue.prod_virt = (u32 *)(va + poffset);
-	json_buffer_to_input(sec, "len", guest->notify_queue.len);
+	if (nmp_guest_probe_queue(&json, sec, "cmd-queue", paddr, va, &guest->cmd_queue) ||
+	    nmp_guest_probe_queue(&json, sec, "notify-queue", paddr, va, &guest->notify_queue))
+		goto probe_exit;
+	rc = 0;
 
 	pr_debug("NMP-GUEST CMD Queue Params:\n");
 	pr_debug("\tdesc_ring_base phys %p\n", guest->cmd_queue.base_addr_phys);
@@ -274,7 +275,9 @@ static int nmp_guest_probe(struct nmp_guest *guest)
 	pr_debug("\tprod_addr virt %p\n", guest->notify_queue.prod_virt);
 	pr_debug("\tlen 0x%x\n", guest->notify_queue.len);
 
-	return 0;
+probe_exit:
+	mv_json_deinit(&json);
+	return rc;
 }
 
 static void check_ka_state(struct nmp_guest *guest)
@@ -422,25 +425,21 @@ fail:
 
 static int skip_str_relation_info(char *prb_str)
 {
-	char	*lbuff, *sec = NULL;
-	int	 skip_size = 0;
-
-	lbuff = kcalloc(1, SER_MAX_FILE_SIZE, GFP_KERNEL);
-	if (lbuff == NULL)
-		return -ENOMEM;
-
-	memcpy(lbuff, prb_str, SER_MAX_FILE_SIZE);
-
-	sec = strstr(lbuff, "sizeof-relations-info");
-	if (!sec) {
-		pr_err("'relations-info' not found\n");
-		kfree(lbuff);
-		return -EINVAL;
+	struct mv_json	json;
+	int		sec, rc;
+	int		skip_size = 0;
+
+	rc = mv_json_init(&json, prb_str);
+	if (rc)
+		return rc;
+
+	sec = mv_json_find(&json, MV_JSON_ROOT, "relations-info");
+	if (sec < 0 || mv_json_obj_get_num(&json, sec, "sizeof-relations-info", skip_size)) {
+		pr_err("'sizeof-relations-info' not found\n");
+		skip_size = -EINVAL;
 	}
 
-	json_buffer_to_input(sec, "sizeof-relations-info", skip_size);
-
-	kfree(lbuff);
+	mv_json_deinit(&json);
 	return skip_size;
 }
 
@@ -666,31 +665,135 @@ int nmp_guest_get_probe_str(struct nmp_guest *guest, char **prb_str)
 	return 0;
 }
 
+/* Read a string member (e.g. "bpool-x") whose key is repeated in 'sec': the
+ * occurrence wanted is the first one after token 'after' and before token
+ * 'before' (when 'before' is valid).
+ */
+static int nmp_guest_get_str_between(struct mv_json *json, int sec, const char *key,
+				     int after, int before, char *str, u32 size)
+{
+	int tok = mv_json_find_next(json, sec, key, after);
+
+	if (tok < 0 || (before >= 0 && tok > before))
+		return -ENOENT;
+	return mv_json_get_str(json, tok, str, size);
+}
+
+/* Read the pp2 ports (and their bpools) listed in the PF relations-info section */
+static int nmp_guest_get_pp2_relations_info(struct mv_json *json, int sec, struct nmp_guest_module_info *pp2_info)
+{
+	struct nmp_guest_port_info	*port_info;
+	char				 tmp_buf[NMP_MAX_BUF_STR_LEN];
+	int				 port_tok, next_port_tok, nb_tok;
+	u64				 num_bpools;
+	u32				 i, j;
+
+	if (mv_json_obj_get_num(json, sec, "num_pp2_ports", pp2_info->num_ports) == -ERANGE)
+		return -EINVAL;
+	pr_debug("num_ports: %d\n", pp2_info->num_ports);
+
+	if (pp2_info->num_ports == 0)
+		return 0;
+
+	pp2_info->port_info = kcalloc(1, sizeof(struct nmp_guest_port_info) * pp2_info->num_ports, GFP_KERNEL);
+	if (pp2_info->port_info == NULL)
+		return -ENOMEM;
+
+	/* "num_pp2_bpools" and "bpool-x" are repeated for every port; each port's
+	 * ones lie between its "ppio-x" member and the next port's one.
+	 */
+	next_port_tok = mv_json_find(json, sec, "ppio-0");
+	for (i = 0; i < pp2_info->num_ports; i++) {
+		port_info = &pp2_info->port_info[i];
+		port_tok = next_port_tok;
+		if (port_tok < 0 || mv_json_get_str(json, port_tok, port_info->port_name, sizeof(port_info->port_name))) {
+			pr_err("'ppio-%d' missing or invalid\n", i);
+			goto pp2_rel_info_err;
+		}
+		pr_debug("port: %d, ppio_name %s\n", i, port_info->port_name);
+
+		snprintf(tmp_buf, sizeof(tmp_buf), "ppio-%d", i + 1);
+		next_port_tok = mv_json_find(json, sec, tmp_buf);
+
+		nb_tok = mv_json_find_next(json, sec, "num_pp2_bpools", port_tok);
+		if (nb_tok < 0 || (next_port_tok >= 0 && nb_tok > next_port_tok) ||
+		    mv_json_get_u64(json, nb_tok, &num_bpools) || num_bpools > UINT8_MAX) {
+			pr_err("'num_pp2_bpools' of ppio-%d missing or invalid\n", i);
+			goto pp2_rel_info_err;
+		}
+		port_info->num_bpools = num_bpools;
+		pr_debug("port: %d, num_pools %d\n", i, port_info->num_bpools);
+
+		port_info->bpool_info = kcalloc(1, sizeof(struct nmp_guest_bpool_info) *
+						port_info->num_bpools, GFP_KERNEL);
+		if (port_info->bpool_info == NULL)
+			goto pp2_rel_info_err;
+
+		for (j = 0; j < port_info->num_bpools; j++) {
+			snprintf(tmp_buf, sizeof(tmp_buf), "bpool-%d", j);
+			if (nmp_guest_get_str_between(json, sec, tmp_buf, nb_tok, next_port_tok,
+						      port_info->bpool_info[j].bpool_name,
+						      sizeof(port_info->bpool_info[j].bpool_name))) {
+				pr_err("'%s' of ppio-%d missing or invalid\n", tmp_buf, i);
+				goto pp2_rel_info_err;
+			}
+			pr_debug("port: %d, pool name %s\n", i, port_info->bpool_info[j].bpool_name);
+		}
+	}
+	return 0;
+
+pp2_rel_info_err:
+	for (i = 0; i < pp2_info->num_ports; i++)
+		kfree(pp2_info->port_info[i].bpool_info);
+	kfree(pp2_info->port_info);
+	pp2_info->port_info = NULL;
+	return -EINVAL;
+}
+
+/* Register a GIU object (gpio/bpool) of an LF, so that its events are routed to the LF */
+static int nmp_guest_add_giu_object(struct nmp_guest *guest, const char *match, u8 lf_type, u8 lf_id)
+{
+	struct nmp_guest_giu_object *obj;
+
+	if (guest->total_giu_object_count >= ARRAY_SIZE(guest->giu_object)) {
+		pr_err("too many GIU objects\n");
+		return -ENOSPC;
+	}
+
+	obj = &guest->giu_object[guest->total_giu_object_count++];
+	strcpy(obj->match, match);
+	obj->lf_type = lf_type;
+	obj->lf_id = lf_id;
+	return 0;
+}
+
 int nmp_guest_get_relations_info(struct nmp_guest *guest, struct nmp_guest_info *guest_info)
 {
-	u32	 i, j, k, lf_type = -1, lf_id = -1;
-	char	*sec = NULL;
-	int	 rc;
-	char	*lbuff;
-	char	 tmp_buf[NMP_MAX_BUF_STR_LEN];
+	struct mv_json		 json;
+	u32			 j, k;
+	u8			 lf_type, lf_id;
+	int			 sec, rel_sec, rc;
+	char			 tmp_buf[NMP_MAX_BUF_STR_LEN];
 	struct nmp_guest_port_info *giu_info = NULL;
-	struct nmp_guest_module_info *pp2_info = &guest_info->ports_info;
 
 	memset(guest_info, 0, sizeof(struct nmp_guest_info));
 
-	lbuff = kcalloc(1, SER_MAX_FILE_SIZE, GFP_KERNEL);
-	if (lbuff == NULL)
-		return -ENOMEM;
-
-	memcpy(lbuff, guest->prb_str, SER_MAX_FILE_SIZE);
+	rc = mv_json_init(&json, guest->prb_str);
+	if (rc)
+		return rc;
 
-	sec = strstr(lbuff, "relations-info");
-	if (!sec) {
+	sec = mv_json_find(&json, MV_JSON_ROOT, "relations-info");
+	if (sec < 0) {
 		pr_err("'relations-info' not found\n");
-		return -EINVAL;
+		rc = -EINVAL;
+		goto rel_info_exit1;
 	}
 
-	json_buffer_to_input(sec, "num-relations-info", guest_info->num_giu_ports);
+	if (mv_json_obj_get_num(&json, sec, "num-relations-info", guest_info->num_giu_ports)) {
+		pr_err("'num-relations-info' missing or invalid\n");
+		rc = -EINVAL;
+		goto rel_info_exit1;
+	}
 
 	guest_info->giu_info = kcalloc(1, sizeof(struct nmp_guest_port_info) * guest_info->num_giu_ports, GFP_KERNEL);
 	if (guest_info->giu_info == NULL) {
@@ -699,34 +802,37 @@ int nmp_guest_get_relations_info(struct nmp_guest *guest, struct nmp_guest_info
 	}
 
 	for (k = 0; k < guest_info->num_giu_ports; k++) {
-		memset(tmp_buf, 0, sizeof(tmp_buf));
 		snprintf(tmp_buf, sizeof(tmp_buf), "relations-info-%d", k);
-		sec = strstr(sec, tmp_buf);
-		if (!sec) {
+		rel_sec = mv_json_find(&json, sec, tmp_buf);
+		if (rel_sec < 0) {
 			pr_err("%s not found\n", tmp_buf);
 			rc = -EINVAL;
 			goto rel_info_exit2;
 		}
 
-		json_buffer_to_input(sec, "lf_type", lf_type);
-		json_buffer_to_input(sec, "lf_id", lf_id);
-		if ((lf_type == -1) || (lf_id == -1)) {
+		if (mv_json_obj_get_num(&json, rel_sec, "lf_type", lf_type) ||
+		    mv_json_obj_get_num(&json, rel_sec, "lf_id", lf_id)) {
 			pr_err("both 'lf_type' and 'lf_id' must exist\n");
 			rc = -EINVAL;
 			goto rel_info_exit2;
 		}
 
 		giu_info = &guest_info->giu_info[k];
-		memset(tmp_buf, 0, sizeof(tmp_buf));
-		snprintf(tmp_buf, sizeof(tmp_buf), "giu-gpio");
-		json_buffer_to_input_str(sec, tmp_buf, giu_info->port_name);
+		if (mv_json_obj_get_str(&json, rel_sec, "giu-gpio", giu_info->port_name, sizeof(giu_info->port_name))) {
+			pr_err("%s: 'giu-gpio' missing or invalid\n", tmp_buf);
+			rc = -EINVAL;
+			goto rel_info_exit2;
+		}
 		pr_debug("giu-port: gpio_name %s\n", giu_info->port_name);
 
-		strcpy(guest->giu_object[guest->total_giu_object_count].match, giu_info->port_name);
-		guest->giu_object[guest->total_giu_object_count].lf_type = lf_type;
-		guest->giu_object[guest->total_giu_object_count++].lf_id = lf_id;
+		rc = nmp_guest_add_giu_object(guest, giu_info->port_name, lf_type, lf_id);
+		if (rc)
+			goto rel_info_exit2;
 
-		json_buffer_to_input(sec, "num_bpools", giu_info->num_bpools);
+		if (mv_json_obj_get_num(&json, rel_sec, "num_bpools", giu_info->num_bpools) == -ERANGE) {
+			rc = -EINVAL;
+			goto rel_info_exit2;
+		}
 		pr_debug("giu-port: num_pools %d\n", giu_info->num_bpools);
 
 		giu_info->bpool_info = kcalloc(1, sizeof(struct nmp_guest_bpool_info) *
@@ -736,70 +842,39 @@ int nmp_guest_get_relations_info(struct nmp_guest *guest, struct nmp_guest_info
 			goto rel_info_exit2;
 		}
 		for (j = 0; j < giu_info->num_bpools; j++) {
-			memset(tmp_buf, 0, sizeof(tmp_buf));
 			snprintf(tmp_buf, sizeof(tmp_buf), "giu-bpool-%d", j);
-			json_buffer_to_input_str(sec, tmp_buf, giu_info->bpool_info[j].bpool_name);
+			if (mv_json_obj_get_str(&json, rel_sec, tmp_buf, giu_info->bpool_info[j].bpool_name,
+						sizeof(giu_info->bpool_info[j].bpool_name))) {
+				pr_err("relations-info-%d: '%s' missing or invalid\n", k, tmp_buf);
+				rc = -EINVAL;
+				goto rel_info_exit2;
+			}
 			pr_debug("giu-port: pool name %s\n", giu_info->bpool_info[j].bpool_name);
-			strcpy(guest->giu_object[guest->total_giu_object_count].match,
-						 giu_info->bpool_info[j].bpool_name);
-			guest->giu_object[guest->total_giu_object_count].lf_type = lf_type;
-			guest->giu_object[guest->total_giu_object_count++].lf_id = lf_id;
+			rc = nmp_guest_add_giu_object(guest, giu_info->bpool_info[j].bpool_name, lf_type, lf_id);
+			if (rc)
+				goto rel_info_exit2;
 		}
 
 		/* The section below only relevant for PF */
 		if (k != 0)
 			continue;
 
-		json_buffer_to_input(sec, "num_pp2_ports", pp2_info->num_ports);
-		pr_debug("num_ports: %d\n", pp2_info->num_ports);
-
-		if (pp2_info->num_ports == 0)
-			continue;
-
-		pp2_info->port_info = kcalloc(1, sizeof(struct nmp_guest_port_info) * pp2_info->num_ports, GFP_KERNEL);
-		if (pp2_info->port_info == NULL) {
-			rc = -ENOMEM;
+		rc = nmp_guest_get_pp2_relations_info(&json, rel_sec, &guest_info->ports_info);
+		if (rc)
 			goto rel_info_exit2;
-		}
-
-		for (i = 0; i < pp2_info->num_ports; i++) {
-			memset(tmp_buf, 0, sizeof(tmp_buf));
-			snprintf(tmp_buf, sizeof(tmp_buf), "ppio-%d", i);
-			json_buffer_to_input_str(sec, tmp_buf, pp2_info->port_info[i].port_name);
-			pr_debug("port: %d, ppio_name %s\n", i, pp2_info->port_info[i].port_name);
-
-			json_buffer_to_input(sec, "num_pp2_bpools", pp2_info->port_info[i].num_bpools);
-			pr_debug("port: %d, num_pools %d\n", i, pp2_info->port_info[i].num_bpools);
-
-			pp2_info->port_info[i].bpool_info = kcalloc(1, sizeof(struct nmp_guest_bpool_info) *
-								    pp2_info->port_info[i].num_bpools, GFP_KERNEL);
-			if (pp2_info->port_info[i].bpool_info == NULL) {
-				rc = -ENOMEM;
-				goto rel_info_exit3;
-			}
-			for (j = 0; j < pp2_info->port_info[i].num_bpools; j++) {
-				memset(tmp_buf, 0, sizeof(tmp_buf));
-				snprintf(tmp_buf, sizeof(tmp_buf), "bpool-%d", j);
-				json_buffer_to_input_str(sec, tmp_buf,
-							 pp2_info->port_info[i].bpool_info[j].bpool_name);
-				pr_debug("port: %d, pool name %s\n", i,
-					 pp2_info->port_info[i].bpool_info[j].bpool_name);
-			}
-		}
 	}
 
-	kfree(lbuff);
+	mv_json_deinit(&json);
 
 	return 0;
 
-rel_info_exit3:
-	kfree(pp2_info->port_info);
 rel_info_exit2:
 	for (k = 0; k < guest_info->num_giu_ports; k++)
-		kfree(giu_info[k].bpool_info);
+		kfree(guest_info->giu_info[k].bpool_info);
 	kfree(guest_info->giu_info);
+	guest_info->giu_info = NULL;
 rel_info_exit1:
-	kfree(lbuff);
+	mv_json_deinit(&json);
 	return rc;
 }
 
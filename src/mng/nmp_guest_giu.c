@@ -105,6 +105,11 @@ static int nmp_guest_find_lf_from_match(struct nmp_guest *guest, char *match, u8
 {
 	int i;
 
+	if (!guest) {
+		pr_err("no nmp-guest (giu match '%s')\n", match);
+		return -ENODEV;
+	}
+
 	for (i = 0; i < guest->total_giu_object_count; i++)
 		if (strcmp(match, guest->giu_object[i].match) == 0) {
 			*lf_type = guest->giu_object[i].lf_type;